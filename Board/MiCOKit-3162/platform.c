@@ -290,6 +290,7 @@ const mico_logic_partition_t mico_partitions[] =
     .partition_length          =     0x4000,    //16k bytes
     .partition_options         = PAR_OPT_READ_EN | PAR_OPT_WRITE_DIS,
   },
+#ifndef MICO_APPLICATION_SLOT_B
   [MICO_PARTITION_APPLICATION] =
   {
     .partition_owner           = MICO_FLASH_EMBEDDED,
@@ -298,6 +299,18 @@ const mico_logic_partition_t mico_partitions[] =
     .partition_length          =    0x54000,   //336k bytes
     .partition_options         = PAR_OPT_READ_EN | PAR_OPT_WRITE_DIS,
   },
+#else
+  /* Linked to run from the OTA storage (ROM at 0x08060000, VECT_TAB_OFFSET 0x60200),
+     the bootloader boots it there. Slots swap, so OTA writes the slot not running. */
+  [MICO_PARTITION_APPLICATION] =
+  {
+    .partition_owner           = MICO_FLASH_EMBEDDED,
+    .partition_description     = "Application",
+    .partition_start_addr      = 0x08060000,
+    .partition_length          = 0x60000, //384k bytes
+    .partition_options         = PAR_OPT_READ_EN | PAR_OPT_WRITE_DIS,
+  },
+#endif
   [MICO_PARTITION_RF_FIRMWARE] =
   {
     .partition_owner           = MICO_FLASH_EMBEDDED,
@@ -306,6 +319,7 @@ const mico_logic_partition_t mico_partitions[] =
     .partition_length          = 0x40000,  //256k bytes
     .partition_options         = PAR_OPT_READ_EN | PAR_OPT_WRITE_DIS,
   },
+#ifndef MICO_APPLICATION_SLOT_B
   [MICO_PARTITION_OTA_TEMP] =
   {
     .partition_owner           = MICO_FLASH_EMBEDDED,
@@ -314,6 +328,16 @@ const mico_logic_partition_t mico_partitions[] =
     .partition_length          = 0x60000, //384k bytes
     .partition_options         = PAR_OPT_READ_EN | PAR_OPT_WRITE_EN,
   },
+#else
+  [MICO_PARTITION_OTA_TEMP] =
+  {
+    .partition_owner           = MICO_FLASH_EMBEDDED,
+    .partition_description     = "OTA Storage",
+    .partition_start_addr      = 0x0800C000,
+    .partition_length          =    0x54000,   //336k bytes
+    .partition_options         = PAR_OPT_READ_EN | PAR_OPT_WRITE_EN,
+  },
+#endif
   [MICO_PARTITION_PARAMETER_1] =
   {
     .partition_owner           = MICO_FLASH_EMBEDDED,
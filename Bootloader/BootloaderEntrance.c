@@ -41,6 +41,7 @@
 
 extern void Main_Menu(void);
 extern OSStatus update(void);
+extern mico_partition_t update_boot_partition( void );
 
 #ifdef SIZE_OPTIMIZE
 char menu[] =
@@ -136,9 +137,9 @@ int main(void)
 #endif
   
   if( MicoShouldEnterBootloader() == false )
-    bootloader_start_app( (MicoFlashGetInfo(MICO_PARTITION_APPLICATION))->partition_start_addr );
+    bootloader_start_app( (MicoFlashGetInfo(update_boot_partition()))->partition_start_addr );
   else if( MicoShouldEnterMFGMode() == true )
-    bootloader_start_app( (MicoFlashGetInfo(MICO_PARTITION_APPLICATION))->partition_start_addr );
+    bootloader_start_app( (MicoFlashGetInfo(update_boot_partition()))->partition_start_addr );
   else if( MicoShouldEnterATEMode() ){
     partition = MicoFlashGetInfo( MICO_PARTITION_ATE );
     if (partition->partition_owner != MICO_FLASH_NONE) {
@@ -34,6 +34,10 @@
 #include "platform.h"
 #include "platform_config.h"
 #include "CheckSumUtils.h"
+#include "ota_image.h"
+#ifdef MICO_OTA_SHA256
+#include "sha.h"
+#endif
 
 typedef int Log_Status;					
 #define Log_NotExist				    (1)
@@ -48,53 +52,18 @@ typedef int Log_Status;
 #define SizePerRW 4096   /* Bootloader need 2xSizePerRW RAM heap size to operate, 
                             but it can boost the setup. */
 
+#define OTA_STAGE_ALIGN 0x1000  /* Erase unit of OTA temporary storage, a delta image is 
+                                   decoded after itself at this alignment */
+
 static uint8_t data[SizePerRW];
 static uint8_t newData[SizePerRW];
 uint8_t paraSaveInRam[16*1024];
 
+static mico_partition_t boot_partition = MICO_PARTITION_APPLICATION;
+
 #define update_log(M, ...) custom_log("UPDATE", M, ##__VA_ARGS__)
 #define update_log_trace() custom_log_trace("UPDATE")
 
-static OSStatus checkcrc(uint16_t crc_in, int partition_type, int total_len)
-{
-    uint16_t crc = 0;
-    mico_logic_partition_t* part;
-    int len;
-    OSStatus err = kNoErr;
-    uint32_t update_data_offset = 0x0;
-    CRC16_Context contex;
-
-    CRC16_Init( &contex );
-    
-    if (crc_in == 0xFFFF)
-        goto exit;
-
-    part = MicoFlashGetInfo((mico_partition_t)partition_type);
-    if (part == NULL)
-        goto exit;
-
-    while(total_len > 0){
-      if( SizePerRW < total_len ){
-        len = SizePerRW;
-      } else {
-        len = total_len;
-      }
-      err = MicoFlashRead( MICO_PARTITION_OTA_TEMP, &update_data_offset, data , len);
-      require_noerr(err, exit);
-
-      total_len -= len;
-
-      CRC16_Update( &contex, data, len );
-    }
-
-  CRC16_Final( &contex, &crc );
-    if (crc == crc_in)
-        err = kNoErr;
-exit:
-    update_log("CRC check return %d, got crc %x, calcuated crc %x", err, crc_in, crc);
-    return err;
-}
-
 Log_Status updateLogCheck(boot_table_t *updateLog, mico_partition_t *dest_partition_type)
 {
   uint32_t i;
@@ -124,22 +93,342 @@ Log_Status updateLogCheck(boot_table_t *updateLog, mico_partition_t *dest_partit
   if( updateLog->length > MicoFlashGetInfo(*dest_partition_type)->partition_length )
     return Log_dataLengthOverFlow;
 
-  if (checkcrc(updateLog->crc, *dest_partition_type, updateLog->length) != kNoErr)
-    return Log_CRCERROR;
-  
+  /* CRC is checked while the image is copied */
   return Log_NeedUpdate;
 }
 
 
+/* Digests of the bytes copied by _update_copy */
+typedef struct {
+  CRC16_Context   crc;
+#ifdef MICO_OTA_SHA256
+  SHA256Context   sha;
+  uint32_t        sha_length;     // Bytes before the trailer, only they are hashed
+#endif
+} update_digest_t;
+
+/* Copy length bytes and read them back to compare, dest must be erased. The bytes
+   are hashed to digest on the way, so verifying the image takes no extra pass */
+static OSStatus _update_copy( mico_partition_t src, uint32_t src_offset, mico_partition_t dest, uint32_t length,
+                              update_digest_t *digest )
+{
+  OSStatus err = kNoErr;
+  uint32_t dest_offset = 0x0;
+  uint32_t copyLength;
+
+  while( length > 0 ){
+    copyLength = ( length < SizePerRW )? length : SizePerRW;
+    err = MicoFlashRead( src, &src_offset, data , copyLength);
+    require_noerr(err, exit);
+    err = MicoFlashWrite( dest, &dest_offset, data, copyLength);
+    require_noerr(err, exit);
+    dest_offset -= copyLength;
+    err = MicoFlashRead( dest, &dest_offset, newData , copyLength);
+    require_noerr(err, exit);
+    err = memcmp(data, newData, copyLength);
+    require_noerr_action(err, exit, err = kWriteErr); 
+    if( digest ){
+      CRC16_Update( &digest->crc, data, copyLength );
+#ifdef MICO_OTA_SHA256
+      if( dest_offset - copyLength < digest->sha_length )
+        SHA256Input( &digest->sha, data, Min( copyLength, digest->sha_length - ( dest_offset - copyLength ) ) );
+#endif
+    }
+    length -= copyLength;
+  }
+
+exit:
+  return err;
+}
+
+/* Copy a raw image from OTA storage and verify it in the same pass: CRC16 against the boot
+   table, and SHA-256 against the image trailer if it has one and MICO_OTA_SHA256 is defined */
+static OSStatus _update_copy_verified( const boot_table_t *updateLog, mico_partition_t dest )
+{
+  OSStatus err = kNoErr;
+  update_digest_t digest;
+  uint16_t crc;
+#ifdef MICO_OTA_SHA256
+  ota_image_trailer_t trailer;
+  uint32_t trailer_offset;
+  uint8_t sha[SHA256HashSize];
+#endif
+
+  CRC16_Init( &digest.crc );
+#ifdef MICO_OTA_SHA256
+  SHA256Reset( &digest.sha );
+  digest.sha_length = 0;
+  if( updateLog->length >= sizeof(ota_image_trailer_t) ){
+    trailer_offset = updateLog->length - sizeof(ota_image_trailer_t);
+    err = MicoFlashRead( MICO_PARTITION_OTA_TEMP, &trailer_offset, (uint8_t *)&trailer, sizeof(ota_image_trailer_t) );
+    require_noerr(err, exit);
+    if( trailer.magic == OTA_IMAGE_TRAILER_MAGIC )
+      digest.sha_length = updateLog->length - sizeof(ota_image_trailer_t);
+  }
+#endif
+
+  err = _update_copy( MICO_PARTITION_OTA_TEMP, 0x0, dest, updateLog->length, &digest );
+  require_noerr(err, exit);
+
+  CRC16_Final( &digest.crc, &crc );
+  if( updateLog->crc != 0xFFFF && crc != updateLog->crc ){
+    update_log("CRC error, got crc %x, calcuated crc %x", updateLog->crc, crc);
+    err = kChecksumErr;
+    goto exit;
+  }
+
+#ifdef MICO_OTA_SHA256
+  if( digest.sha_length ){
+    SHA256Result( &digest.sha, sha );
+    require_action( memcmp( sha, trailer.sha256, SHA256HashSize ) == 0, exit,
+                    update_log("SHA-256 error"); err = kChecksumErr );
+  }
+#endif
+
+exit:
+  return err;
+}
+
+static OSStatus _update_check_crc( mico_partition_t partition, uint32_t offset, uint32_t length, uint16_t crc_in )
+{
+  OSStatus err;
+  uint16_t crc;
+
+  err = ota_image_crc( partition, offset, length, data, SizePerRW, &crc );
+  require_noerr(err, exit);
+  if( crc != crc_in ){
+    update_log("CRC error, got crc %x, calcuated crc %x", crc_in, crc);
+    err = kChecksumErr;
+  }
+
+exit:
+  return err;
+}
+
+/* Write a compressed or delta image to dest partition */
+static OSStatus _update_from_image( ota_image_header_t *header, mico_partition_t dest )
+{
+  OSStatus err = kNoErr;
+  mico_logic_partition_t *ota_partition_info = MicoFlashGetInfo( MICO_PARTITION_OTA_TEMP );
+  mico_logic_partition_t *dest_partition_info = MicoFlashGetInfo( dest );
+  uint32_t stage_offset;
+
+  require_action( header->raw_length <= dest_partition_info->partition_length, exit, err = kSizeErr );
+
+  if( header->format == OTA_IMAGE_LZ ){
+    update_log("Decompress %d bytes to %d bytes", header->data_length, header->raw_length);
+    err = MicoFlashDisableSecurity( dest, 0x0, dest_partition_info->partition_length );
+    require_noerr(err, exit);
+    err = MicoFlashErase( dest, 0x0, dest_partition_info->partition_length );
+    require_noerr(err, exit);
+    err = ota_image_decode( header, MICO_PARTITION_OTA_TEMP, dest, 0x0, MICO_PARTITION_NONE, data, newData, SizePerRW );
+    require_noerr(err, exit);
+    err = _update_check_crc( dest, 0x0, header->raw_length, header->raw_crc );
+    require_noerr(err, exit);
+    goto exit;
+  }
+
+  /* The old firmware is still needed while the patch is applied, and flash sectors
+     of the application can be larger than RAM. So the new firmware is decoded to the
+     free space after the patch first, then copied. */
+  stage_offset = ( header->header_length + header->data_length + OTA_STAGE_ALIGN - 1 ) & ~( OTA_STAGE_ALIGN - 1 );
+  require_action( stage_offset + header->raw_length <= ota_partition_info->partition_length, exit, err = kNoSpaceErr );
+
+  /* Decoded before power was lost, the old firmware may be partly overwritten */
+  if( _update_check_crc( MICO_PARTITION_OTA_TEMP, stage_offset, header->raw_length, header->raw_crc ) != kNoErr ){
+    err = _update_check_crc( dest, 0x0, header->old_length, header->old_crc );
+    require_noerr_action(err, exit, update_log("Patch does not match current firmware"); err = kVersionErr);
+
+    update_log("Apply %d bytes patch, to %d bytes", header->data_length, header->raw_length);
+    err = MicoFlashDisableSecurity( MICO_PARTITION_OTA_TEMP, 0x0, ota_partition_info->partition_length );
+    require_noerr(err, exit);
+    err = MicoFlashErase( MICO_PARTITION_OTA_TEMP, stage_offset, header->raw_length );
+    require_noerr(err, exit);
+    err = ota_image_decode( header, MICO_PARTITION_OTA_TEMP, MICO_PARTITION_OTA_TEMP, stage_offset, dest, data, newData, SizePerRW );
+    require_noerr(err, exit);
+    err = _update_check_crc( MICO_PARTITION_OTA_TEMP, stage_offset, header->raw_length, header->raw_crc );
+    require_noerr(err, exit);
+  }
+
+  err = MicoFlashDisableSecurity( dest, 0x0, dest_partition_info->partition_length );
+  require_noerr(err, exit);
+  err = MicoFlashErase( dest, 0x0, dest_partition_info->partition_length );
+  require_noerr(err, exit);
+  err = _update_copy( MICO_PARTITION_OTA_TEMP, stage_offset, dest, header->raw_length, NULL );
+  require_noerr(err, exit);
+
+exit:
+  return err;
+}
+
+/* Rewrite the boot table at the head of PARAMETER_1, the rest of the partition is kept */
+static OSStatus _update_save_boot_table( const boot_table_t *table )
+{
+  OSStatus err = kNoErr;
+  uint32_t para_offset = 0x0;
+  mico_logic_partition_t *para_partition_info = MicoFlashGetInfo( MICO_PARTITION_PARAMETER_1 );
+
+  err = MicoFlashDisableSecurity( MICO_PARTITION_PARAMETER_1, 0x0, para_partition_info->partition_length );
+  require_noerr(err, exit);
+  err = MicoFlashRead( MICO_PARTITION_PARAMETER_1, &para_offset, paraSaveInRam, para_partition_info->partition_length );
+  require_noerr(err, exit);
+  memcpy(paraSaveInRam, table, sizeof(boot_table_t));
+  err = MicoFlashErase( MICO_PARTITION_PARAMETER_1, 0x0, para_partition_info->partition_length );
+  require_noerr(err, exit);
+  para_offset = 0x0;
+  err = MicoFlashWrite( MICO_PARTITION_PARAMETER_1, &para_offset, paraSaveInRam, para_partition_info->partition_length );
+  require_noerr(err, exit);
+
+exit:
+  return err;
+}
+
+/* Application slots: when OTA storage is on the embedded flash too, an image linked
+ * to run from there is booted where it was downloaded instead of being copied. The
+ * new slot is booted on trial, the application confirms it once it has run without
+ * a system monitor failure, otherwise the other slot is booted again after
+ * BOOT_TRIAL_BOOTS boots. An image linked for the application partition still takes
+ * the copy path.
+ */
+static mico_partition_t _update_slot_partition( uint8_t slot )
+{
+  return ( slot == BOOT_SLOT_B )? MICO_PARTITION_OTA_TEMP : MICO_PARTITION_APPLICATION;
+}
+
+static uint8_t _update_partition_slot( mico_partition_t partition )
+{
+  return ( partition == MICO_PARTITION_OTA_TEMP )? BOOT_SLOT_B : BOOT_SLOT_A;
+}
+
+static mico_partition_t _update_slot_other( mico_partition_t partition )
+{
+  return ( partition == MICO_PARTITION_OTA_TEMP )? MICO_PARTITION_APPLICATION : MICO_PARTITION_OTA_TEMP;
+}
+
+/* The image in partition is linked to run from it: its reset vector points inside */
+static bool _update_slot_runnable( mico_partition_t partition )
+{
+  mico_logic_partition_t *partition_info = MicoFlashGetInfo( partition );
+  uint32_t vector[2];
+  uint32_t offset = 0x0;
+
+  if( partition_info->partition_owner != MICO_FLASH_EMBEDDED )
+    return false;
+
+  /* Same as startApplication, the vector table may follow a 0x200 bytes header */
+  if( MicoFlashRead( partition, &offset, (uint8_t *)vector, sizeof(vector) ) != kNoErr )
+    return false;
+  if( ( vector[0] & 0x2FFE0000 ) != 0x20000000 ){
+    offset = 0x200;
+    if( MicoFlashRead( partition, &offset, (uint8_t *)vector, sizeof(vector) ) != kNoErr )
+      return false;
+  }
+  if( ( vector[0] & 0x2FFE0000 ) != 0x20000000 )
+    return false;
+
+  return ( vector[1] >= partition_info->partition_start_addr &&
+           vector[1] < partition_info->partition_start_addr + partition_info->partition_length );
+}
+
+/* Choose the slot to boot from the boot table, returns kNotHandledErr if slots are not
+   used and the table is left to the copy path */
+static OSStatus _update_slots( boot_table_t *updateLog )
+{
+  OSStatus err = kNotHandledErr;
+  mico_partition_t src;
+  mico_logic_partition_t *src_info;
+  ota_image_header_t imageHeader;
+  uint32_t trial_offset = offsetof( boot_table_t, trial );
+
+  boot_partition = MICO_PARTITION_APPLICATION;
+  if( MicoFlashGetInfo( MICO_PARTITION_APPLICATION )->partition_owner != MICO_FLASH_EMBEDDED ||
+      MicoFlashGetInfo( MICO_PARTITION_OTA_TEMP )->partition_owner != MICO_FLASH_EMBEDDED )
+    goto exit;
+
+  if( updateLog->upgrade_type == BOOT_UPGRADE ){
+    /* An application running in slot B downloads to the application partition */
+    if( updateLog->start_address == MicoFlashGetInfo( MICO_PARTITION_OTA_TEMP )->partition_start_addr )
+      src = MICO_PARTITION_OTA_TEMP;
+    else if( updateLog->start_address == MicoFlashGetInfo( MICO_PARTITION_APPLICATION )->partition_start_addr )
+      src = MICO_PARTITION_APPLICATION;
+    else
+      goto exit;
+    src_info = MicoFlashGetInfo( src );
+
+    if( updateLog->type == 'A' && updateLog->length <= src_info->partition_length &&
+        ota_image_read_header( src, &imageHeader ) != kNoErr && _update_slot_runnable( src ) == true &&
+        ( updateLog->crc == 0xFFFF || _update_check_crc( src, 0x0, updateLog->length, updateLog->crc ) == kNoErr ) ){
+      update_log("Boot %s on trial", src_info->partition_description);
+      updateLog->upgrade_type = BOOT_UPGRADE_TRIAL;
+      updateLog->slot = _update_partition_slot( src );
+      updateLog->trial = ( ( 1 << BOOT_TRIAL_BOOTS ) - 1 ) >> 1; // This is the first trial boot
+      boot_partition = src;
+      err = _update_save_boot_table( updateLog );
+      require_noerr(err, exit);
+      goto exit;
+    }
+
+    /* Copied from OTA storage as before, the application partition is never a source */
+    if( src == MICO_PARTITION_OTA_TEMP )
+      goto exit;
+
+    update_log("Image in %s can not be booted, stay in %s", src_info->partition_description,
+               MicoFlashGetInfo( MICO_PARTITION_OTA_TEMP )->partition_description);
+    memset(updateLog, 0xff, sizeof(boot_table_t));
+    updateLog->upgrade_type = BOOT_UPGRADE_CONFIRMED;
+    updateLog->slot = BOOT_SLOT_B;
+    boot_partition = MICO_PARTITION_OTA_TEMP;
+    err = _update_save_boot_table( updateLog );
+    require_noerr(err, exit);
+  }
+  else if( updateLog->upgrade_type == BOOT_UPGRADE_TRIAL ){
+    src = _update_slot_partition( updateLog->slot );
+    if( updateLog->trial != 0 ){
+      /* Clearing a bit needs no erase */
+      updateLog->trial &= updateLog->trial - 1;
+      update_log("Trial boot %s, trial %02x", MicoFlashGetInfo( src )->partition_description, updateLog->trial);
+      boot_partition = src;
+      err = MicoFlashDisableSecurity( MICO_PARTITION_PARAMETER_1, 0x0, sizeof(boot_table_t) );
+      require_noerr(err, exit);
+      err = MicoFlashWrite( MICO_PARTITION_PARAMETER_1, &trial_offset, &updateLog->trial, 1 );
+      require_noerr(err, exit);
+    }
+    else{
+      src = _update_slot_other( src );
+      update_log("Trial is not confirmed, roll back to %s", MicoFlashGetInfo( src )->partition_description);
+      memset(updateLog, 0xff, sizeof(boot_table_t));
+      updateLog->upgrade_type = BOOT_UPGRADE_CONFIRMED;
+      updateLog->slot = _update_partition_slot( src );
+      boot_partition = src;
+      err = _update_save_boot_table( updateLog );
+      require_noerr(err, exit);
+    }
+  }
+  else if( updateLog->slot == BOOT_SLOT_A || updateLog->slot == BOOT_SLOT_B ){
+    boot_partition = _update_slot_partition( updateLog->slot );
+    err = kNoErr;
+  }
+
+exit:
+  if( boot_partition != MICO_PARTITION_APPLICATION && _update_slot_runnable( boot_partition ) == false )
+    boot_partition = MICO_PARTITION_APPLICATION;
+  return err;
+}
+
+/* Partition of the application to start after update() */
+mico_partition_t update_boot_partition( void )
+{
+  return boot_partition;
+}
+
 OSStatus update(void)
 {
   boot_table_t updateLog;
   uint32_t i, j, size;
   uint32_t update_data_offset = 0x0;
-  uint32_t dest_offset;
   uint32_t boot_table_offset = 0x0;
-  uint32_t para_offset = 0x0;
-  uint32_t copyLength;
+  ota_image_header_t imageHeader;
+  OSStatus image_err = kNoErr;
   //uint8_t *paraSaveInRam = NULL;
   mico_logic_partition_t *ota_partition_info, *dest_partition_info, *para_partition_info;
   mico_partition_t dest_partition;
@@ -161,8 +450,17 @@ OSStatus update(void)
   err = MicoFlashRead( MICO_PARTITION_PARAMETER_1, &boot_table_offset, (uint8_t *)&updateLog, sizeof(boot_table_t));
   require_noerr(err, exit);
 
+  /* Slots choose the application to boot, OTA storage may hold one of them */
+  err = _update_slots( &updateLog );
+  if( err != kNotHandledErr )
+    goto exit;
+  err = kNoErr;
+
   /*Not a correct record*/
   if(updateLogCheck( &updateLog, &dest_partition) != Log_NeedUpdate){
+    /* A partial download is resumed by the application, keep it */
+    if( updateLog.upgrade_type == BOOT_UPGRADE_DOWNLOAD )
+      goto exit;
     size = ( ota_partition_info->partition_length )/SizePerRW;
     for(i = 0; i <= size; i++){
       if( i==size ){
@@ -194,54 +492,42 @@ OSStatus update(void)
   update_log("Write OTA data to partition: %s, length %d", 
     dest_partition_info->partition_description, updateLog.length);
   
-  dest_offset = 0x0;
-  update_data_offset = 0x0;
-  
-  err = MicoFlashDisableSecurity( dest_partition, 0x0, dest_partition_info->partition_length );
-  require_noerr(err, exit);
-  err = MicoFlashErase( dest_partition, 0x0, dest_partition_info->partition_length );
-  require_noerr(err, exit);
-  size = (updateLog.length)/SizePerRW;
-  
-  for(i = 0; i <= size; i++){
-    if( i == size ){
-      if( (updateLog.length)%SizePerRW )
-        copyLength = (updateLog.length)%SizePerRW;
-      else
-        break;
-    }else{
-      copyLength = SizePerRW;
+  if( ota_image_read_header( MICO_PARTITION_OTA_TEMP, &imageHeader ) == kNoErr ){
+    err = _update_from_image( &imageHeader, dest_partition );
+    /* The patch is for another firmware, it will never apply */
+    if( err == kVersionErr ){
+      image_err = err;
+      goto clear;
     }
-    err = MicoFlashRead( MICO_PARTITION_OTA_TEMP, &update_data_offset, data , copyLength);
     require_noerr(err, exit);
-    err = MicoFlashWrite( dest_partition, &dest_offset, data, copyLength);
+  }
+  else{
+    err = MicoFlashDisableSecurity( dest_partition, 0x0, dest_partition_info->partition_length );
     require_noerr(err, exit);
-    dest_offset -= copyLength;
-    err = MicoFlashRead( dest_partition, &dest_offset, newData , copyLength);
+    err = MicoFlashErase( dest_partition, 0x0, dest_partition_info->partition_length );
     require_noerr(err, exit);
-    err = memcmp(data, newData, copyLength);
-    require_noerr_action(err, exit, err = kWriteErr); 
- }
+    err = _update_copy_verified( &updateLog, dest_partition );
+    /* The image in OTA storage is corrupted, copying it again will not help */
+    if( err == kChecksumErr ){
+      image_err = err;
+      goto clear;
+    }
+    require_noerr(err, exit);
+  }
 
+clear:
   update_log("Update start to clear data...");
     
-  para_offset = 0x0;
-  err = MicoFlashDisableSecurity( MICO_PARTITION_PARAMETER_1, 0x0, para_partition_info->partition_length );
-  require_noerr(err, exit);
-  err = MicoFlashRead( MICO_PARTITION_PARAMETER_1, &para_offset, paraSaveInRam, para_partition_info->partition_length );
-  require_noerr(err, exit);
-  memset(paraSaveInRam, 0xff, sizeof(boot_table_t));
-  err = MicoFlashErase( MICO_PARTITION_PARAMETER_1, 0x0, para_partition_info->partition_length );
+  memset(&updateLog, 0xff, sizeof(boot_table_t));
+  err = _update_save_boot_table( &updateLog );
   require_noerr(err, exit);
-  para_offset = 0x0;
-  err = MicoFlashWrite( MICO_PARTITION_PARAMETER_1, &para_offset, paraSaveInRam, para_partition_info->partition_length );
-  require_noerr(err, exit);
-  
+
 
   err = MicoFlashDisableSecurity( MICO_PARTITION_OTA_TEMP, 0x0, ota_partition_info->partition_length );
   require_noerr(err, exit);  
   err = MicoFlashErase( MICO_PARTITION_OTA_TEMP, 0x0, ota_partition_info->partition_length );
   require_noerr(err, exit);
+  require_noerr_action(image_err, exit, err = image_err);
   update_log("Update success");
   
 exit:
@@ -60,6 +60,7 @@ char ERROR_STR [] = "\n\r*** ERROR: %s\n\r";    /* ERROR message string in code
 extern char menu[];
 extern void getline (char *line, int n);          /* input line               */
 extern void startApplication( uint32_t app_addr );
+extern mico_partition_t update_boot_partition( void );
 
 /* Private function prototypes -----------------------------------------------*/
 void SerialDownload(mico_flash_t flash, uint32_t flashdestination, int32_t maxRecvSize);
@@ -368,7 +369,7 @@ void Main_Menu(void)
     /***************** Command: Excute the application *************************/
     else if(strcmp(cmdname, "BOOT") == 0 || strcmp(cmdname, "6") == 0)	{
       printf ("\n\rBooting.......\n\r");
-      partition = MicoFlashGetInfo( MICO_PARTITION_APPLICATION );
+      partition = MicoFlashGetInfo( update_boot_partition() );
       bootloader_start_app( partition->partition_start_addr );
     }
     
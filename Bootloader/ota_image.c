@@ -0,0 +1,320 @@
+/**
+******************************************************************************
+* @file    ota_image.c
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   This file provides functions to decode compressed and delta OTA
+*          images in a fixed RAM budget.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#ifndef OTA_PACK_HOST
+#include "mico.h"
+#endif
+#include "ota_image.h"
+#include "CheckSumUtils.h"
+
+typedef struct {
+  const ota_image_header_t *header;
+
+  /* Token stream, read through inBuffer */
+  mico_partition_t  in_partition;
+  uint32_t          in_offset;      // Next flash offset to read
+  uint32_t          in_left;        // Bytes not read from flash
+  uint8_t           *in_buffer;
+  uint32_t          in_pos;
+  uint32_t          in_len;
+
+  /* Decoded firmware, written through outBuffer */
+  mico_partition_t  out_partition;
+  uint32_t          out_offset;     // Flash offset of the first decoded byte
+  uint32_t          out_flushed;    // Bytes written to flash
+  uint8_t           *out_buffer;
+  uint32_t          out_fill;       // Bytes in out_buffer
+
+  mico_partition_t  old_partition;
+  uint32_t          old_next;       // Where the next old copy is relative to
+
+  uint32_t          buffer_length;
+} ota_decoder_t;
+
+OSStatus ota_image_read_header( mico_partition_t inPartition, ota_image_header_t *outHeader )
+{
+  OSStatus err;
+  uint32_t offset = 0;
+
+  err = MicoFlashRead( inPartition, &offset, (uint8_t *)outHeader, sizeof(ota_image_header_t) );
+  require_noerr( err, exit );
+
+  require_action_quiet( outHeader->magic == OTA_IMAGE_MAGIC, exit, err = kFormatErr );
+  require_action( outHeader->version == OTA_IMAGE_VERSION, exit, err = kVersionErr );
+  require_action( outHeader->format == OTA_IMAGE_LZ || outHeader->format == OTA_IMAGE_DELTA, exit, err = kFormatErr );
+  require_action( outHeader->header_length >= sizeof(ota_image_header_t), exit, err = kFormatErr );
+
+exit:
+  return err;
+}
+
+OSStatus ota_image_crc( mico_partition_t inPartition, uint32_t inOffset, uint32_t inLength,
+                        uint8_t *buffer, uint32_t bufferLength, uint16_t *outCrc )
+{
+  OSStatus err = kNoErr;
+  CRC16_Context contex;
+  uint32_t len;
+
+  CRC16_Init( &contex );
+  while( inLength > 0 ){
+    len = ( inLength < bufferLength )? inLength : bufferLength;
+    err = MicoFlashRead( inPartition, &inOffset, buffer, len );
+    require_noerr( err, exit );
+    CRC16_Update( &contex, buffer, len );
+    inLength -= len;
+  }
+  CRC16_Final( &contex, outCrc );
+
+exit:
+  return err;
+}
+
+static OSStatus _get_byte( ota_decoder_t *dec, uint8_t *outByte )
+{
+  OSStatus err = kNoErr;
+
+  if( dec->in_pos == dec->in_len ){
+    require_action( dec->in_left > 0, exit, err = kUnderrunErr );
+    dec->in_len = ( dec->in_left < dec->buffer_length )? dec->in_left : dec->buffer_length;
+    err = MicoFlashRead( dec->in_partition, &dec->in_offset, dec->in_buffer, dec->in_len );
+    require_noerr( err, exit );
+    dec->in_left -= dec->in_len;
+    dec->in_pos = 0;
+  }
+  *outByte = dec->in_buffer[dec->in_pos++];
+
+exit:
+  return err;
+}
+
+static OSStatus _get_varint( ota_decoder_t *dec, uint32_t *outValue )
+{
+  OSStatus err;
+  uint8_t byte;
+  int shift = 0;
+
+  *outValue = 0;
+  do {
+    require_action( shift < 32, exit, err = kMalformedErr );
+    err = _get_byte( dec, &byte );
+    require_noerr( err, exit );
+    *outValue |= (uint32_t)( byte & 0x7F ) << shift;
+    shift += 7;
+  } while( byte & 0x80 );
+
+exit:
+  return err;
+}
+
+static OSStatus _flush( ota_decoder_t *dec )
+{
+  OSStatus err = kNoErr;
+  uint32_t offset = dec->out_offset + dec->out_flushed;
+
+  if( dec->out_fill == 0 )
+    goto exit;
+
+  err = MicoFlashWrite( dec->out_partition, &offset, dec->out_buffer, dec->out_fill );
+  require_noerr( err, exit );
+  dec->out_flushed += dec->out_fill;
+  dec->out_fill = 0;
+
+exit:
+  return err;
+}
+
+/* Room left in out_buffer, flush it first if it is full */
+static OSStatus _out_room( ota_decoder_t *dec, uint32_t *outRoom )
+{
+  OSStatus err = kNoErr;
+
+  if( dec->out_fill == dec->buffer_length ){
+    err = _flush( dec );
+    require_noerr( err, exit );
+  }
+  *outRoom = dec->buffer_length - dec->out_fill;
+
+exit:
+  return err;
+}
+
+static OSStatus _copy_literal( ota_decoder_t *dec, uint32_t len )
+{
+  OSStatus err = kNoErr;
+  uint32_t room, n;
+
+  while( len > 0 ){
+    err = _out_room( dec, &room );
+    require_noerr( err, exit );
+
+    /* Take bytes from the input buffer in blocks */
+    if( dec->in_pos == dec->in_len ){
+      err = _get_byte( dec, &dec->out_buffer[dec->out_fill++] );
+      require_noerr( err, exit );
+      len--;
+      continue;
+    }
+    n = dec->in_len - dec->in_pos;
+    if( n > room ) n = room;
+    if( n > len ) n = len;
+    memcpy( dec->out_buffer + dec->out_fill, dec->in_buffer + dec->in_pos, n );
+    dec->in_pos += n;
+    dec->out_fill += n;
+    len -= n;
+  }
+
+exit:
+  return err;
+}
+
+static OSStatus _copy_match( ota_decoder_t *dec, uint32_t dist, uint32_t len )
+{
+  OSStatus err = kNoErr;
+  uint32_t room, n, from, offset;
+
+  require_action( dist > 0 && dist <= dec->out_flushed + dec->out_fill, exit, err = kMalformedErr );
+
+  while( len > 0 ){
+    err = _out_room( dec, &room );
+    require_noerr( err, exit );
+
+    from = dec->out_flushed + dec->out_fill - dist;
+    if( from < dec->out_flushed ){
+      /* Older output is already in flash */
+      n = dec->out_flushed - from;
+      if( n > room ) n = room;
+      if( n > len ) n = len;
+      offset = dec->out_offset + from;
+      err = MicoFlashRead( dec->out_partition, &offset, dec->out_buffer + dec->out_fill, n );
+      require_noerr( err, exit );
+      dec->out_fill += n;
+      len -= n;
+    }
+    else{
+      /* Copy byte by byte, the match can overlap the bytes it produces */
+      from -= dec->out_flushed;
+      for( n = 0; n < len && n < room; n++ )
+        dec->out_buffer[dec->out_fill++] = dec->out_buffer[from + n];
+      len -= n;
+    }
+  }
+
+exit:
+  return err;
+}
+
+static OSStatus _copy_old( ota_decoder_t *dec, uint32_t from, uint32_t len )
+{
+  OSStatus err = kNoErr;
+  uint32_t room, n;
+
+  require_action( from <= dec->header->old_length && len <= dec->header->old_length - from, exit, err = kMalformedErr );
+
+  while( len > 0 ){
+    err = _out_room( dec, &room );
+    require_noerr( err, exit );
+    n = ( len < room )? len : room;
+    err = MicoFlashRead( dec->old_partition, &from, dec->out_buffer + dec->out_fill, n );
+    require_noerr( err, exit );
+    dec->out_fill += n;
+    len -= n;
+  }
+  dec->old_next = from;
+
+exit:
+  return err;
+}
+
+OSStatus ota_image_decode( const ota_image_header_t *inHeader, mico_partition_t inPartition,
+                           mico_partition_t outPartition, uint32_t outOffset,
+                           mico_partition_t oldPartition,
+                           uint8_t *inBuffer, uint8_t *outBuffer, uint32_t bufferLength )
+{
+  OSStatus err = kNoErr;
+  ota_decoder_t dec;
+  uint8_t token;
+  uint32_t len, value;
+
+  memset( &dec, 0x0, sizeof(ota_decoder_t) );
+  dec.header = inHeader;
+  dec.in_partition = inPartition;
+  dec.in_offset = inHeader->header_length;
+  dec.in_left = inHeader->data_length;
+  dec.in_buffer = inBuffer;
+  dec.out_partition = outPartition;
+  dec.out_offset = outOffset;
+  dec.out_buffer = outBuffer;
+  dec.old_partition = oldPartition;
+  dec.buffer_length = bufferLength;
+
+  while( dec.out_flushed + dec.out_fill < inHeader->raw_length ){
+    err = _get_byte( &dec, &token );
+    require_noerr( err, exit );
+
+    if( ( token & OTA_TOKEN_MATCH ) == 0 ){
+      len = token + 1;
+      require_action( len <= inHeader->raw_length - dec.out_flushed - dec.out_fill, exit, err = kMalformedErr );
+      err = _copy_literal( &dec, len );
+      require_noerr( err, exit );
+      continue;
+    }
+
+    len = ( token & OTA_TOKEN_LEN_MASK ) + OTA_TOKEN_MIN_MATCH;
+    if( ( token & OTA_TOKEN_LEN_MASK ) == OTA_TOKEN_LEN_MASK ){
+      err = _get_varint( &dec, &value );
+      require_noerr( err, exit );
+      len += value;
+    }
+    require_action( len >= OTA_TOKEN_MIN_MATCH && len <= inHeader->raw_length - dec.out_flushed - dec.out_fill, exit, err = kMalformedErr );
+
+    err = _get_varint( &dec, &value );
+    require_noerr( err, exit );
+
+    if( ( token & OTA_TOKEN_OLD ) == OTA_TOKEN_MATCH ){
+      err = _copy_match( &dec, value, len );
+      require_noerr( err, exit );
+    }
+    else{
+      require_action( inHeader->format == OTA_IMAGE_DELTA, exit, err = kMalformedErr );
+      /* Zigzag decode, the offset moves back or forth from the last old copy */
+      value = ( value & 1 )? dec.old_next - ( value >> 1 ) - 1 : dec.old_next + ( value >> 1 );
+      err = _copy_old( &dec, value, len );
+      require_noerr( err, exit );
+    }
+  }
+
+  err = _flush( &dec );
+  require_noerr( err, exit );
+
+exit:
+  return err;
+}
@@ -0,0 +1,125 @@
+/**
+******************************************************************************
+* @file    ota_image.h
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   This file provides the format and decoder of compressed and delta
+*          OTA images.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#ifndef __OTA_IMAGE_H__
+#define __OTA_IMAGE_H__
+
+#include "Common.h"
+
+#ifdef OTA_PACK_HOST
+/* Built into the host packer tool, flash is simulated in RAM */
+typedef int mico_partition_t;
+#define MICO_PARTITION_NONE   (-1)
+OSStatus MicoFlashWrite( mico_partition_t inPartition, volatile uint32_t* off_set, uint8_t* inBuffer ,uint32_t inBufferLength);
+OSStatus MicoFlashRead( mico_partition_t inPartition, volatile uint32_t* off_set, uint8_t* outBuffer, uint32_t inBufferLength);
+#define require_noerr( ERR, LABEL )               do { if( (ERR) != 0 ) goto LABEL; } while( 0 )
+#define require_action( X, LABEL, ACTION )        do { if( !(X) ) { ACTION; goto LABEL; } } while( 0 )
+#define require_action_quiet( X, LABEL, ACTION )  require_action( X, LABEL, ACTION )
+#else
+#include "MicoDriverFlash.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* An OTA image is either a raw firmware, or starts with ota_image_header_t:
+ *
+ * OTA_IMAGE_LZ:    the firmware compressed by LZ77, decoded straight into the
+ *                  destination partition.
+ * OTA_IMAGE_DELTA: the same LZ77 stream, which can also copy from the firmware
+ *                  currently in the destination partition.
+ *
+ * The stream after the header is a list of tokens:
+ *   0LLLLLLL                    L+1 literal bytes follow
+ *   10LLLLLL [len] dist         copy L+3 bytes from dist bytes back in the output
+ *   11LLLLLL [len] delta        copy L+3 bytes from the old firmware at
+ *                               (end of last old copy + delta), OTA_IMAGE_DELTA only
+ * If L is 63, [len] is added to the length. [len] and dist are unsigned LEB128
+ * varints, delta is a zigzag encoded LEB128 varint. A copy from the output can
+ * be any distance back, so the decoder needs no window in RAM: older output is
+ * read back from flash.
+ */
+#define OTA_IMAGE_MAGIC             0x41544F4D    // "MOTA"
+#define OTA_IMAGE_VERSION           1
+
+#define OTA_IMAGE_LZ                'L'
+#define OTA_IMAGE_DELTA             'D'
+
+#define OTA_TOKEN_MATCH             0x80
+#define OTA_TOKEN_OLD               0xC0
+#define OTA_TOKEN_LITERAL_MAX       128
+#define OTA_TOKEN_LEN_MASK          0x3F
+#define OTA_TOKEN_MIN_MATCH         3
+
+typedef struct _ota_image_header_t {
+  uint32_t magic;
+  uint8_t  format;        // OTA_IMAGE_LZ or OTA_IMAGE_DELTA
+  uint8_t  version;
+  uint16_t header_length; // Tokens start here
+  uint32_t data_length;   // Length of the tokens
+  uint32_t raw_length;    // Length of the decoded firmware
+  uint32_t old_length;    // OTA_IMAGE_DELTA: length of the firmware it applies to
+  uint16_t raw_crc;       // CRC16 of the decoded firmware
+  uint16_t old_crc;       // OTA_IMAGE_DELTA: CRC16 of the firmware it applies to
+} ota_image_header_t;
+
+/* A raw image can end with ota_image_trailer_t. A bootloader built with MICO_OTA_SHA256
+   checks the SHA-256 of the bytes before the trailer while the image is copied. The
+   trailer is copied with the image, after the end of the firmware. */
+#define OTA_IMAGE_TRAILER_MAGIC     0x4148534D    // "MSHA"
+
+typedef struct _ota_image_trailer_t {
+  uint8_t  sha256[32];
+  uint32_t magic;
+} ota_image_trailer_t;
+
+/* Read the header at the start of inPartition, returns kFormatErr for a raw image */
+OSStatus ota_image_read_header( mico_partition_t inPartition, ota_image_header_t *outHeader );
+
+/* Decode the tokens in inPartition to outPartition at outOffset. For OTA_IMAGE_DELTA,
+   oldPartition holds the old firmware, it must not overlap the output. inBuffer and
+   outBuffer are work buffers of bufferLength bytes. */
+OSStatus ota_image_decode( const ota_image_header_t *inHeader, mico_partition_t inPartition,
+                           mico_partition_t outPartition, uint32_t outOffset,
+                           mico_partition_t oldPartition,
+                           uint8_t *inBuffer, uint8_t *outBuffer, uint32_t bufferLength );
+
+/* CRC16 of inLength bytes at inOffset in inPartition, read through buffer */
+OSStatus ota_image_crc( mico_partition_t inPartition, uint32_t inOffset, uint32_t inLength,
+                        uint8_t *buffer, uint32_t bufferLength, uint16_t *outCrc );
+
+#ifdef __cplusplus
+} /*extern "C" */
+#endif
+
+#endif
@@ -0,0 +1,571 @@
+/**
+******************************************************************************
+* @file    ota-bench.c
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   Compressed and delta OTA images through the bootloader's decoder on
+*          the simulated NOR flash of ota_pack.c: round trips, damaged headers
+*          and streams, bit flips, and the size and decode time of each format.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+/* Built on the host only, best with -fsanitize=address,undefined for the bit flips:
+ *
+ *   cc -O2 -DOTA_PACK_HOST -DOTA_BENCH_MAIN -IBootloader -Iinclude -Ilibraries/utilities -IMICO/security/SHAUtils \
+ *      Bootloader/tools/ota-bench.c Bootloader/ota_image.c libraries/utilities/CheckSumUtils.c \
+ *      MICO/security/SHAUtils/sha224-256.c -o ota-bench && ./ota-bench
+ *
+ * The firmware is made up: code-like words from a small vocabulary, literal pools and string tables, like the
+ * sections of an ARM image. The new firmware of a delta moves functions, changes a few words and grows by a table.
+ */
+
+#if( defined( OTA_BENCH_MAIN ) )
+
+#include <stddef.h>
+#include <time.h>
+
+#include "ota_pack.c"
+
+#define kOTA_BenchFirmwareSize      ( 160 * 1024 )
+#define kOTA_BenchFlips             1500            // Damaged images of each format
+#define kOTA_BenchStage             0x40000         // Stage offset of a delta in OTA temp
+
+static uint32_t             gOTA_BenchSeed = 1;
+static uint8_t              gOTA_BenchIn[ DECODE_BUFFER ];
+static uint8_t              gOTA_BenchOut[ DECODE_BUFFER ];
+
+static uint32_t ota_bench_rand( void )
+{
+    gOTA_BenchSeed = gOTA_BenchSeed * 1103515245 + 12345;
+    return( gOTA_BenchSeed >> 8 );
+}
+
+//===========================================================================================================================
+//  ota_bench_firmware
+//===========================================================================================================================
+
+static void ota_bench_firmware( uint8_t *inBuf, uint32_t inLen, uint32_t inSeed )
+{
+    static const char * const   kStrings[] = { "mico_rtos_thread", "Wi-Fi connected\n", "ERROR: %s:%d\r\n", "config",
+                                               "OTA", "HTTP/1.1 200 OK\r\n", "Content-Length: ", "easylink" };
+    uint32_t                    vocabulary[ 64 ];
+    uint32_t                    pos, n, i, word = 0;
+    const char *                str;
+
+    gOTA_BenchSeed = inSeed;
+    for( i = 0; i < 64; ++i ) vocabulary[ i ] = ota_bench_rand() | ( ota_bench_rand() << 24 );
+
+    for( pos = 0; pos < inLen; pos += n )
+    {
+        n = 64 + ( ota_bench_rand() % 512 );
+        if( n > inLen - pos ) n = inLen - pos;
+        switch( ota_bench_rand() % 8 )
+        {
+            case 0:     // Literal pool
+                for( i = 0; i < n; ++i ) inBuf[ pos + i ] = (uint8_t) ota_bench_rand();
+                break;
+
+            case 1:     // String table
+                str = kStrings[ ota_bench_rand() % 8 ];
+                for( i = 0; i < n; ++i ) inBuf[ pos + i ] = (uint8_t) str[ i % ( strlen( str ) + 1 ) ];
+                break;
+
+            default:    // Code, common words with a few registers changed
+                for( i = 0; i < n; ++i )
+                {
+                    if( ( i % 4 ) == 0 ) word = vocabulary[ ota_bench_rand() % 64 ] ^ ( ota_bench_rand() % 4 );
+                    inBuf[ pos + i ] = (uint8_t)( word >> ( 8 * ( i % 4 ) ) );
+                }
+                break;
+        }
+    }
+}
+
+//===========================================================================================================================
+//  ota_bench_delta_pair
+//
+//  The old firmware and a new one made from it: a function inserted, one removed, bytes changed and a table added.
+//  inNew has room for kOTA_BenchFirmwareSize + 4096 bytes.
+//===========================================================================================================================
+
+static uint32_t ota_bench_delta_pair( uint8_t *inOld, uint8_t *inNew )
+{
+    uint32_t        len, i;
+
+    ota_bench_firmware( inOld, kOTA_BenchFirmwareSize, 7 );
+    len = 0;
+    memcpy( inNew, inOld, 16000 );
+    len += 16000;
+    ota_bench_firmware( inNew + len, 700, 11 );
+    len += 700;
+    memcpy( inNew + len, inOld + 16000, 64000 );
+    len += 64000;
+    memcpy( inNew + len, inOld + 81000, kOTA_BenchFirmwareSize - 81000 );
+    len += kOTA_BenchFirmwareSize - 81000;
+    for( i = 0; i < 40; ++i ) inNew[ ota_bench_rand() % len ] ^= (uint8_t)( 1 + ota_bench_rand() % 255 );
+    ota_bench_firmware( inNew + len, 3000, 13 );
+    len += 3000;
+    return( len );
+}
+
+//===========================================================================================================================
+//  ota_bench_pack
+//===========================================================================================================================
+
+static void ota_bench_pack( uint8_t inFormat, const uint8_t *inNew, uint32_t inNewLen, const uint8_t *inOld,
+                            uint32_t inOldLen, out_buffer_t *outImage )
+{
+    ota_image_header_t      header;
+
+    memset( &header, 0, sizeof( header ) );
+    header.format = inFormat;
+    pack( inNew, inNewLen, inOld, inOldLen, &header, outImage );
+}
+
+//===========================================================================================================================
+//  ota_bench_decode
+//
+//  Decodes an image on the simulated flash as update() does: an LZ image straight into an application partition of
+//  inAppSize bytes, a delta to the stage in OTA temp with inOld in the application partition. kNoErr if the output is
+//  accepted by its CRC and is inExpected, kIntegrityErr if it is accepted and is not.
+//===========================================================================================================================
+
+static OSStatus ota_bench_decode( const out_buffer_t *inImage, const uint8_t *inOld, uint32_t inOldLen,
+                                  const uint8_t *inExpected, uint32_t inAppSize )
+{
+    OSStatus                err;
+    ota_image_header_t      header;
+    mico_partition_t        out, old;
+    uint32_t                offset;
+    uint16_t                crc;
+
+    sim_flash_length[ SIM_OTA_TEMP ] = kOTA_BenchStage + inAppSize;
+    sim_flash_length[ SIM_APPLICATION ] = inAppSize;
+    sim_flash[ SIM_OTA_TEMP ] = malloc( sim_flash_length[ SIM_OTA_TEMP ] );
+    sim_flash[ SIM_APPLICATION ] = malloc( inAppSize + 1 );
+    require_action( sim_flash[ SIM_OTA_TEMP ] && sim_flash[ SIM_APPLICATION ], exit, err = kNoMemoryErr );
+    require_action( inImage->length <= kOTA_BenchStage && inOldLen <= inAppSize, exit, err = kSizeErr );
+    memset( sim_flash[ SIM_OTA_TEMP ], 0xFF, sim_flash_length[ SIM_OTA_TEMP ] );
+    memset( sim_flash[ SIM_APPLICATION ], 0xFF, inAppSize );
+    memcpy( sim_flash[ SIM_OTA_TEMP ], inImage->data, inImage->length );
+    if( inOld ) memcpy( sim_flash[ SIM_APPLICATION ], inOld, inOldLen );
+
+    err = ota_image_read_header( SIM_OTA_TEMP, &header );
+    require_noerr( err, exit );
+    if( header.format == OTA_IMAGE_LZ )
+    {
+        out     = SIM_APPLICATION;
+        offset  = 0;
+        old     = MICO_PARTITION_NONE;
+    }
+    else
+    {
+        out     = SIM_OTA_TEMP;
+        offset  = kOTA_BenchStage;
+        old     = SIM_APPLICATION;
+    }
+    err = ota_image_decode( &header, SIM_OTA_TEMP, out, offset, old, gOTA_BenchIn, gOTA_BenchOut, DECODE_BUFFER );
+    require_noerr( err, exit );
+
+    err = ota_image_crc( out, offset, header.raw_length, gOTA_BenchIn, DECODE_BUFFER, &crc );
+    require_noerr( err, exit );
+    require_action( crc == header.raw_crc, exit, err = kChecksumErr );
+    require_action( memcmp( sim_flash[ out ] + offset, inExpected, header.raw_length ) == 0, exit, err = kIntegrityErr );
+
+exit:
+    free( sim_flash[ SIM_OTA_TEMP ] );
+    free( sim_flash[ SIM_APPLICATION ] );
+    sim_flash[ SIM_OTA_TEMP ] = NULL;
+    sim_flash[ SIM_APPLICATION ] = NULL;
+    return( err );
+}
+
+//===========================================================================================================================
+//  ota_lz_test
+//===========================================================================================================================
+
+static OSStatus ota_lz_test( void )
+{
+    OSStatus                err = kNoErr;
+    static const uint32_t   kLengths[] = { 0, 1, 3, 130, DECODE_BUFFER - 1, DECODE_BUFFER, DECODE_BUFFER + 1, 100000 };
+    out_buffer_t            image = { NULL, 0, 0 };
+    uint8_t *               data;
+    size_t                  i;
+
+    data = malloc( 100000 );
+    require_action( data, exit, err = kNoMemoryErr );
+
+    for( i = 0; i < sizeof( kLengths ) / sizeof( kLengths[ 0 ] ); ++i )
+    {
+        ota_bench_firmware( data, kLengths[ i ], (uint32_t) i + 1 );
+        ota_bench_pack( OTA_IMAGE_LZ, data, kLengths[ i ], NULL, 0, &image );
+        err = ota_bench_decode( &image, NULL, 0, data, kLengths[ i ] + 1 );
+        require_noerr( err, exit );
+        require_action( verify( &image, (ota_image_header_t *) image.data, data, NULL, DEFAULT_OTA_SIZE ) == 0, exit,
+            err = kIntegrityErr );
+        free( image.data );
+        image.data = NULL;
+    }
+
+    // Erased flash is one long match over its own output, noise is literals only
+
+    memset( data, 0xFF, 100000 );
+    ota_bench_pack( OTA_IMAGE_LZ, data, 100000, NULL, 0, &image );
+    require_action( image.length < sizeof( ota_image_header_t ) + 16, exit, err = kSizeErr );
+    err = ota_bench_decode( &image, NULL, 0, data, 100000 );
+    require_noerr( err, exit );
+    free( image.data );
+
+    for( i = 0; i < 100000; ++i ) data[ i ] = (uint8_t) ota_bench_rand();
+    ota_bench_pack( OTA_IMAGE_LZ, data, 100000, NULL, 0, &image );
+    require_action( image.length <= sizeof( ota_image_header_t ) + 100000 + 100000 / OTA_TOKEN_LITERAL_MAX + 1, exit,
+        err = kSizeErr );
+    err = ota_bench_decode( &image, NULL, 0, data, 100000 );
+    require_noerr( err, exit );
+    free( image.data );
+
+    // The application partition is a byte too small
+
+    ota_bench_firmware( data, 100000, 9 );
+    ota_bench_pack( OTA_IMAGE_LZ, data, 100000, NULL, 0, &image );
+    err = ota_bench_decode( &image, NULL, 0, data, 99999 );
+    require_action( err == kRangeErr, exit, err = kResponseErr );
+    err = kNoErr;
+
+exit:
+    free( image.data );
+    free( data );
+    return( err );
+}
+
+//===========================================================================================================================
+//  ota_delta_test
+//===========================================================================================================================
+
+static OSStatus ota_delta_test( void )
+{
+    OSStatus                err;
+    out_buffer_t            delta = { NULL, 0, 0 };
+    out_buffer_t            lz = { NULL, 0, 0 };
+    uint8_t *               old;
+    uint8_t *               new;
+    uint32_t                len;
+
+    old = malloc( kOTA_BenchFirmwareSize );
+    new = malloc( kOTA_BenchFirmwareSize + 4096 );
+    require_action( old && new, exit, err = kNoMemoryErr );
+    len = ota_bench_delta_pair( old, new );
+
+    ota_bench_pack( OTA_IMAGE_DELTA, new, len, old, kOTA_BenchFirmwareSize, &delta );
+    err = ota_bench_decode( &delta, old, kOTA_BenchFirmwareSize, new, len );
+    require_noerr( err, exit );
+    require_action( verify( &delta, (ota_image_header_t *) delta.data, new, old, DEFAULT_OTA_SIZE ) == 0, exit,
+        err = kIntegrityErr );
+
+    // Most of it is copied from the old firmware
+
+    ota_bench_pack( OTA_IMAGE_LZ, new, len, NULL, 0, &lz );
+    require_action( delta.length * 4 < lz.length, exit, err = kSizeErr );
+
+    // Applied to another firmware, the output fails the CRC or a copy is out of range
+
+    old[ 20000 ] ^= 0x5A;
+    err = ota_bench_decode( &delta, old, kOTA_BenchFirmwareSize, new, len );
+    require_action( err == kChecksumErr, exit, err = kResponseErr );
+    old[ 20000 ] ^= 0x5A;
+    err = ota_bench_decode( &delta, old, 40000, new, len );
+    require_action( err == kChecksumErr, exit, err = kResponseErr );
+
+    // Old copies are malformed in an LZ image
+
+    delta.data[ offsetof( ota_image_header_t, format ) ] = OTA_IMAGE_LZ;
+    err = ota_bench_decode( &delta, NULL, 0, new, len );
+    require_action( err == kMalformedErr, exit, err = kResponseErr );
+    err = kNoErr;
+
+exit:
+    free( delta.data );
+    free( lz.data );
+    free( old );
+    free( new );
+    return( err );
+}
+
+//===========================================================================================================================
+//  ota_stream_test
+//
+//  Hand made headers and tokens: damaged ones are rejected before anything out of range is read or written.
+//===========================================================================================================================
+
+static OSStatus ota_bench_stream( uint8_t inFormat, const uint8_t *inTokens, uint32_t inLen, uint32_t inRawLen,
+                                  uint32_t inOldLen, uint16_t inCrc, out_buffer_t *outImage )
+{
+    ota_image_header_t      header;
+
+    memset( &header, 0, sizeof( header ) );
+    header.magic            = OTA_IMAGE_MAGIC;
+    header.version          = OTA_IMAGE_VERSION;
+    header.format           = inFormat;
+    header.header_length    = sizeof( header );
+    header.data_length      = inLen;
+    header.raw_length       = inRawLen;
+    header.old_length       = inOldLen;
+    header.raw_crc          = inCrc;
+    outImage->length = sizeof( header ) + inLen;
+    outImage->data = malloc( outImage->length );
+    if( !outImage->data ) return( kNoMemoryErr );
+    memcpy( outImage->data, &header, sizeof( header ) );
+    memcpy( outImage->data + sizeof( header ), inTokens, inLen );
+    return( kNoErr );
+}
+
+static OSStatus ota_stream_test( void )
+{
+    OSStatus                err;
+    // "abc", "abca" from 3 back, "opq" from the old firmware at 0 + 5
+    static const uint8_t    kGood[]         = { 2, 'a', 'b', 'c', OTA_TOKEN_MATCH | 1, 3, OTA_TOKEN_OLD, 10 };
+    static const uint8_t    kFarMatch[]     = { 2, 'a', 'b', 'c', OTA_TOKEN_MATCH, 4 };
+    static const uint8_t    kZeroMatch[]    = { 2, 'a', 'b', 'c', OTA_TOKEN_MATCH, 0 };
+    static const uint8_t    kLongVarint[]   = { 0, 'a', OTA_TOKEN_MATCH | OTA_TOKEN_LEN_MASK, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 1, 1 };
+    static const uint8_t    kLongMatch[]    = { 0, 'a', OTA_TOKEN_MATCH | 10, 1 };
+    static const uint8_t    kLongLiteral[]  = { 9, 'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h', 'i', 'j' };
+    static const uint8_t    kFarOld[]       = { OTA_TOKEN_OLD, 16 };
+    static const uint8_t    kBackOld[]      = { OTA_TOKEN_OLD, 1 };
+    static const uint8_t    kOld[]          = { 'x', 'y', 'z', 'm', 'n', 'o', 'p', 'q' };
+    static const uint8_t    kExpected[]     = { 'a', 'b', 'c', 'a', 'b', 'c', 'a', 'o', 'p', 'q' };
+    static const struct { const uint8_t *tokens; uint32_t len; uint32_t raw; OSStatus err; } kCases[] =
+    {
+        { kGood,        sizeof( kGood ),        10, kNoErr },
+        { kGood,        sizeof( kGood ) - 1,    10, kUnderrunErr },     // data_length cut in a varint
+        { kGood,        4,                      10, kUnderrunErr },     // cut after a token
+        { kGood,        sizeof( kGood ),        11, kUnderrunErr },     // raw_length too long
+        { kGood,        sizeof( kGood ),        9,  kMalformedErr },    // raw_length too short
+        { kFarMatch,    sizeof( kFarMatch ),    6,  kMalformedErr },    // before the first byte
+        { kZeroMatch,   sizeof( kZeroMatch ),   6,  kMalformedErr },
+        { kLongVarint,  sizeof( kLongVarint ),  70, kMalformedErr },    // more than 32 bits
+        { kLongMatch,   sizeof( kLongMatch ),   5,  kMalformedErr },    // longer than the firmware
+        { kLongLiteral, sizeof( kLongLiteral ), 5,  kMalformedErr },
+        { kFarOld,      sizeof( kFarOld ),      3,  kMalformedErr },    // after the old firmware
+        { kBackOld,     sizeof( kBackOld ),     3,  kMalformedErr },    // before it
+    };
+    ota_image_header_t      header;
+    out_buffer_t            image = { NULL, 0, 0 };
+    size_t                  i;
+
+    for( i = 0; i < sizeof( kCases ) / sizeof( kCases[ 0 ] ); ++i )
+    {
+        err = ota_bench_stream( OTA_IMAGE_DELTA, kCases[ i ].tokens, kCases[ i ].len, kCases[ i ].raw, sizeof( kOld ),
+            crc16( kExpected, sizeof( kExpected ) ), &image );
+        require_noerr( err, exit );
+        err = ota_bench_decode( &image, kOld, sizeof( kOld ), kExpected, 128 );
+        require_action( err == kCases[ i ].err, exit, err = kResponseErr );
+        free( image.data );
+        image.data = NULL;
+    }
+
+    // Headers of another magic, version, format or length
+
+    err = ota_bench_stream( OTA_IMAGE_LZ, kGood, 4, 3, 0, crc16( kExpected, 3 ), &image );
+    require_noerr( err, exit );
+    sim_flash[ SIM_OTA_TEMP ] = image.data;
+    sim_flash_length[ SIM_OTA_TEMP ] = image.length;
+    err = ota_image_read_header( SIM_OTA_TEMP, &header );
+    require_noerr( err, exit );
+
+    image.data[ 0 ] ^= 1;
+    err = ota_image_read_header( SIM_OTA_TEMP, &header );
+    require_action( err == kFormatErr, exit, err = kResponseErr );
+    image.data[ 0 ] ^= 1;
+    image.data[ offsetof( ota_image_header_t, version ) ] = OTA_IMAGE_VERSION + 1;
+    err = ota_image_read_header( SIM_OTA_TEMP, &header );
+    require_action( err == kVersionErr, exit, err = kResponseErr );
+    image.data[ offsetof( ota_image_header_t, version ) ] = OTA_IMAGE_VERSION;
+    image.data[ offsetof( ota_image_header_t, format ) ] = 'X';
+    err = ota_image_read_header( SIM_OTA_TEMP, &header );
+    require_action( err == kFormatErr, exit, err = kResponseErr );
+    image.data[ offsetof( ota_image_header_t, format ) ] = OTA_IMAGE_LZ;
+    image.data[ offsetof( ota_image_header_t, header_length ) ] = sizeof( header ) - 1;
+    err = ota_image_read_header( SIM_OTA_TEMP, &header );
+    require_action( err == kFormatErr, exit, err = kResponseErr );
+    image.data[ offsetof( ota_image_header_t, header_length ) ] = sizeof( header );
+    sim_flash_length[ SIM_OTA_TEMP ] = sizeof( header ) - 1;
+    err = ota_image_read_header( SIM_OTA_TEMP, &header );
+    require_action( err == kRangeErr, exit, err = kResponseErr );
+    sim_flash_length[ SIM_OTA_TEMP ] = image.length;
+
+    // NOR flash: the decoder writes every byte once, to erased flash only
+
+    sim_flash[ SIM_APPLICATION ] = calloc( 1, 3 );
+    sim_flash_length[ SIM_APPLICATION ] = 3;
+    require_action( sim_flash[ SIM_APPLICATION ], exit, err = kNoMemoryErr );
+    err = ota_image_read_header( SIM_OTA_TEMP, &header );
+    require_noerr( err, exit );
+    err = ota_image_decode( &header, SIM_OTA_TEMP, SIM_APPLICATION, 0, MICO_PARTITION_NONE, gOTA_BenchIn, gOTA_BenchOut,
+        DECODE_BUFFER );
+    require_action( err == kWriteErr, exit, err = kResponseErr );
+    memset( sim_flash[ SIM_APPLICATION ], 0xFF, 3 );
+    err = ota_image_decode( &header, SIM_OTA_TEMP, SIM_APPLICATION, 0, MICO_PARTITION_NONE, gOTA_BenchIn, gOTA_BenchOut,
+        DECODE_BUFFER );
+    require_noerr( err, exit );
+    require_action( memcmp( sim_flash[ SIM_APPLICATION ], kExpected, 3 ) == 0, exit, err = kIntegrityErr );
+
+exit:
+    free( sim_flash[ SIM_APPLICATION ] );
+    sim_flash[ SIM_APPLICATION ] = NULL;
+    sim_flash[ SIM_OTA_TEMP ] = NULL;
+    free( image.data );
+    return( err );
+}
+
+//===========================================================================================================================
+//  ota_flip_test
+//
+//  Bit flips in the tokens of an LZ and a delta image. A damaged image is never accepted with other firmware than it
+//  was made from: the decoder rejects it, the output fails the CRC, or the flip did not change the output. Flash is
+//  still written once per byte, in range.
+//===========================================================================================================================
+
+static OSStatus ota_flip_test( int inPrint )
+{
+    OSStatus                err;
+    out_buffer_t            image[ 2 ] = { { NULL, 0, 0 }, { NULL, 0, 0 } };
+    uint8_t *               saved = NULL;
+    uint8_t *               old;
+    uint8_t *               new;
+    uint32_t                len, pos;
+    int                     counts[ 2 ][ 3 ];
+    int                     f, i, n;
+
+    old = malloc( kOTA_BenchFirmwareSize );
+    new = malloc( kOTA_BenchFirmwareSize + 4096 );
+    require_action( old && new, exit, err = kNoMemoryErr );
+    len = ota_bench_delta_pair( old, new );
+    ota_bench_pack( OTA_IMAGE_LZ, new, len, NULL, 0, &image[ 0 ] );
+    ota_bench_pack( OTA_IMAGE_DELTA, new, len, old, kOTA_BenchFirmwareSize, &image[ 1 ] );
+    memset( counts, 0, sizeof( counts ) );
+
+    gOTA_BenchSeed = 1;
+    for( f = 0; f < 2; ++f )
+    {
+        saved = malloc( image[ f ].length );
+        require_action( saved, exit, err = kNoMemoryErr );
+        memcpy( saved, image[ f ].data, image[ f ].length );
+        for( i = 0; i < kOTA_BenchFlips; ++i )
+        {
+            for( n = 1 + ( ota_bench_rand() % 4 ); n > 0; --n )
+            {
+                pos = sizeof( ota_image_header_t ) + ( ota_bench_rand() % ( image[ f ].length - sizeof( ota_image_header_t ) ) );
+                image[ f ].data[ pos ] ^= (uint8_t)( 1 << ( ota_bench_rand() % 8 ) );
+            }
+            err = ota_bench_decode( &image[ f ], f ? old : NULL, f ? kOTA_BenchFirmwareSize : 0, new, len + 1 );
+            require_action( err != kIntegrityErr && err != kWriteErr && err != kNoMemoryErr && err != kSizeErr, exit, );
+            counts[ f ][ ( err == kNoErr ) ? 2 : ( err == kChecksumErr ) ? 1 : 0 ]++;
+            memcpy( image[ f ].data, saved, image[ f ].length );
+        }
+        free( saved );
+        saved = NULL;
+    }
+    err = kNoErr;
+
+    if( inPrint )
+    {
+        for( f = 0; f < 2; ++f )
+        {
+            printf( "%-5s %d bit flipped images: %4d rejected, %4d failed the CRC, %4d same firmware\n",
+                f ? "delta" : "lz", kOTA_BenchFlips, counts[ f ][ 0 ], counts[ f ][ 1 ], counts[ f ][ 2 ] );
+        }
+    }
+
+exit:
+    free( saved );
+    free( image[ 0 ].data );
+    free( image[ 1 ].data );
+    free( old );
+    free( new );
+    return( err );
+}
+
+//===========================================================================================================================
+//  ota_bench
+//===========================================================================================================================
+
+static double ota_bench_ms( const out_buffer_t *inImage, const uint8_t *inOld, const uint8_t *inNew, uint32_t inLen )
+{
+    struct timespec     t0, t1;
+    int                 i;
+
+    clock_gettime( CLOCK_MONOTONIC, &t0 );
+    for( i = 0; i < 10; ++i ) ota_bench_decode( inImage, inOld, inOld ? kOTA_BenchFirmwareSize : 0, inNew, inLen );
+    clock_gettime( CLOCK_MONOTONIC, &t1 );
+    return( ( ( t1.tv_sec - t0.tv_sec ) * 1e3 + ( t1.tv_nsec - t0.tv_nsec ) / 1e6 ) / 10 );
+}
+
+OSStatus    ota_bench( int print )
+{
+    OSStatus                err;
+    out_buffer_t            lz = { NULL, 0, 0 };
+    out_buffer_t            delta = { NULL, 0, 0 };
+    uint8_t *               old = NULL;
+    uint8_t *               new = NULL;
+    uint32_t                len;
+
+    err = ota_lz_test();
+    require_noerr( err, exit );
+    err = ota_delta_test();
+    require_noerr( err, exit );
+    err = ota_stream_test();
+    require_noerr( err, exit );
+    err = ota_flip_test( print );
+    require_noerr( err, exit );
+    if( !print ) goto exit;
+
+    // Sizes, and decode times with the 4 KB buffers of Update_for_OTA.c, including the setup of the simulated flash
+
+    old = malloc( kOTA_BenchFirmwareSize );
+    new = malloc( kOTA_BenchFirmwareSize + 4096 );
+    require_action( old && new, exit, err = kNoMemoryErr );
+    len = ota_bench_delta_pair( old, new );
+    ota_bench_pack( OTA_IMAGE_LZ, new, len, NULL, 0, &lz );
+    ota_bench_pack( OTA_IMAGE_DELTA, new, len, old, kOTA_BenchFirmwareSize, &delta );
+    printf( "lz    %u -> %6u bytes (%5.1f%%), decoded in %6.2f ms\n", len, lz.length, 100.0 * lz.length / len,
+        ota_bench_ms( &lz, NULL, new, len ) );
+    printf( "delta %u -> %6u bytes (%5.1f%%), decoded in %6.2f ms\n", len, delta.length, 100.0 * delta.length / len,
+        ota_bench_ms( &delta, old, new, len ) );
+
+exit:
+    free( lz.data );
+    free( delta.data );
+    free( old );
+    free( new );
+    printf( "%s: %s\n", __FUNCTION__, !err ? "PASSED" : "FAILED" );
+    return( err );
+}
+
+int main( void )
+{
+    return( ota_bench( 1 ) ? 1 : 0 );
+}
+
+#endif // OTA_BENCH_MAIN
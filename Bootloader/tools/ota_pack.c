@@ -0,0 +1,544 @@
+/**
+******************************************************************************
+* @file    ota_pack.c
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   Host tool to create compressed and delta OTA images, see ota_image.h.
+*          Every image is decoded again by the bootloader's decoder on a
+*          simulated flash before it is saved. It also adds the SHA-256
+*          trailer to a raw image.
+*
+*          Build: gcc -O2 -DOTA_PACK_HOST -I.. -I../../include -I../../libraries/utilities
+*                 -I../../MICO/security/SHAUtils -o ota_pack ota_pack.c ../ota_image.c
+*                 ../../libraries/utilities/CheckSumUtils.c ../../MICO/security/SHAUtils/sha224-256.c
+*
+*          Usage: ota_pack [-s ota_size] lz <new.bin> <out.bin>
+*                 ota_pack [-s ota_size] delta <old.bin> <new.bin> <out.bin>
+*
+*          ota-bench.c includes it for the encoder and the simulated flash.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#include "ota_image.h"
+#include "CheckSumUtils.h"
+#include "sha.h"
+
+#define HASH_BITS           16
+#define HASH_SIZE           ( 1 << HASH_BITS )
+#define CHAIN_DEPTH         64
+#define MIN_MATCH           4
+#define NO_POS              0xFFFFFFFF
+
+#define DEFAULT_OTA_SIZE    0x74000   // MICO_PARTITION_OTA_TEMP of MiCOKit-3288
+#define STAGE_ALIGN         0x1000    // OTA_STAGE_ALIGN in Update_for_OTA.c
+#define DECODE_BUFFER       4096      // SizePerRW in Update_for_OTA.c
+
+typedef struct {
+  const uint8_t *data;
+  uint32_t      length;
+  uint32_t      *head;
+  uint32_t      *prev;
+} match_index_t;
+
+typedef struct {
+  uint8_t       *data;
+  uint32_t      length;
+  uint32_t      size;
+} out_buffer_t;
+
+/******************************************************
+ *               Simulated flash
+ ******************************************************/
+
+enum {
+  SIM_OTA_TEMP,
+  SIM_APPLICATION,
+  SIM_PARTITION_MAX,
+};
+
+static uint8_t  *sim_flash[SIM_PARTITION_MAX];
+static uint32_t sim_flash_length[SIM_PARTITION_MAX];
+
+OSStatus MicoFlashRead( mico_partition_t inPartition, volatile uint32_t* off_set, uint8_t* outBuffer, uint32_t inBufferLength )
+{
+  if( inPartition < 0 || inPartition >= SIM_PARTITION_MAX ||
+      *off_set > sim_flash_length[inPartition] || inBufferLength > sim_flash_length[inPartition] - *off_set )
+    return kRangeErr;
+  memcpy( outBuffer, sim_flash[inPartition] + *off_set, inBufferLength );
+  *off_set += inBufferLength;
+  return kNoErr;
+}
+
+OSStatus MicoFlashWrite( mico_partition_t inPartition, volatile uint32_t* off_set, uint8_t* inBuffer, uint32_t inBufferLength )
+{
+  uint32_t i;
+
+  if( inPartition < 0 || inPartition >= SIM_PARTITION_MAX ||
+      *off_set > sim_flash_length[inPartition] || inBufferLength > sim_flash_length[inPartition] - *off_set )
+    return kRangeErr;
+  /* NOR flash can only clear bits, the area must be erased first */
+  for( i = 0; i < inBufferLength; i++ ){
+    if( sim_flash[inPartition][*off_set + i] != 0xFF )
+      return kWriteErr;
+    sim_flash[inPartition][*off_set + i] = inBuffer[i];
+  }
+  *off_set += inBufferLength;
+  return kNoErr;
+}
+
+/******************************************************
+ *               Encoder
+ ******************************************************/
+
+static uint32_t hash4( const uint8_t *p )
+{
+  uint32_t v = p[0] | ( p[1] << 8 ) | ( p[2] << 16 ) | ( (uint32_t)p[3] << 24 );
+  return ( v * 2654435761u ) >> ( 32 - HASH_BITS );
+}
+
+static void index_init( match_index_t *index, const uint8_t *data, uint32_t length )
+{
+  index->data = data;
+  index->length = length;
+  index->head = malloc( HASH_SIZE * sizeof(uint32_t) );
+  index->prev = malloc( ( length + 1 ) * sizeof(uint32_t) );
+  if( index->head == NULL || index->prev == NULL ){
+    fprintf( stderr, "Out of memory\n" );
+    exit( 1 );
+  }
+  memset( index->head, 0xFF, HASH_SIZE * sizeof(uint32_t) );
+}
+
+static void index_insert( match_index_t *index, uint32_t pos )
+{
+  uint32_t h;
+
+  if( pos + MIN_MATCH > index->length )
+    return;
+  h = hash4( index->data + pos );
+  index->prev[pos] = index->head[h];
+  index->head[h] = pos;
+}
+
+static void index_free( match_index_t *index )
+{
+  free( index->head );
+  free( index->prev );
+}
+
+static uint32_t match_length( const uint8_t *a, const uint8_t *b, uint32_t max )
+{
+  uint32_t len = 0;
+  while( len < max && a[len] == b[len] ) len++;
+  return len;
+}
+
+static uint32_t varint_size( uint32_t value )
+{
+  uint32_t size = 1;
+  while( value >= 0x80 ){
+    value >>= 7;
+    size++;
+  }
+  return size;
+}
+
+static uint32_t zigzag( uint32_t from, uint32_t expected )
+{
+  return ( from >= expected )? ( from - expected ) << 1 : ( ( expected - from - 1 ) << 1 ) | 1;
+}
+
+static uint32_t token_cost( uint32_t len, uint32_t arg )
+{
+  uint32_t cost = 1 + varint_size( arg );
+  if( len - OTA_TOKEN_MIN_MATCH >= OTA_TOKEN_LEN_MASK )
+    cost += varint_size( len - OTA_TOKEN_MIN_MATCH - OTA_TOKEN_LEN_MASK );
+  return cost;
+}
+
+typedef struct {
+  uint32_t len;
+  uint32_t from;
+  bool     old;
+  int32_t  gain;   // Bytes saved over literals
+} match_t;
+
+static void consider( match_t *best, uint32_t len, uint32_t from, bool old, uint32_t arg )
+{
+  int32_t gain;
+
+  if( len < OTA_TOKEN_MIN_MATCH )
+    return;
+  gain = (int32_t)len - (int32_t)token_cost( len, arg );
+  if( gain > best->gain ){
+    best->len = len;
+    best->from = from;
+    best->old = old;
+    best->gain = gain;
+  }
+}
+
+static void find_match( match_index_t *new_index, match_index_t *old_index, uint32_t pos, uint32_t old_next, match_t *best )
+{
+  const uint8_t *cur = new_index->data + pos;
+  uint32_t max = new_index->length - pos;
+  uint32_t candidate, depth, len, h;
+
+  memset( best, 0x0, sizeof(match_t) );
+
+  if( old_index ){
+    /* Firmware changes keep most code in order, try where the last copy ended */
+    if( old_next < old_index->length ){
+      len = match_length( cur, old_index->data + old_next, Min( max, old_index->length - old_next ) );
+      consider( best, len, old_next, true, zigzag( old_next, old_next ) );
+    }
+    if( max >= MIN_MATCH ){
+      h = hash4( cur );
+      for( candidate = old_index->head[h], depth = 0; candidate != NO_POS && depth < CHAIN_DEPTH; candidate = old_index->prev[candidate], depth++ ){
+        len = match_length( cur, old_index->data + candidate, Min( max, old_index->length - candidate ) );
+        consider( best, len, candidate, true, zigzag( candidate, old_next ) );
+      }
+    }
+  }
+
+  if( max >= MIN_MATCH ){
+    h = hash4( cur );
+    for( candidate = new_index->head[h], depth = 0; candidate != NO_POS && depth < CHAIN_DEPTH; candidate = new_index->prev[candidate], depth++ ){
+      /* Matches can overlap the bytes they produce */
+      len = match_length( cur, new_index->data + candidate, max );
+      consider( best, len, candidate, false, pos - candidate );
+    }
+  }
+}
+
+static void out_byte( out_buffer_t *out, uint8_t byte )
+{
+  if( out->length == out->size ){
+    out->size = out->size ? out->size * 2 : 4096;
+    out->data = realloc( out->data, out->size );
+    if( out->data == NULL ){
+      fprintf( stderr, "Out of memory\n" );
+      exit( 1 );
+    }
+  }
+  out->data[out->length++] = byte;
+}
+
+static void out_varint( out_buffer_t *out, uint32_t value )
+{
+  while( value >= 0x80 ){
+    out_byte( out, ( value & 0x7F ) | 0x80 );
+    value >>= 7;
+  }
+  out_byte( out, value );
+}
+
+static void out_literals( out_buffer_t *out, const uint8_t *data, uint32_t len )
+{
+  uint32_t n;
+
+  while( len > 0 ){
+    n = Min( len, OTA_TOKEN_LITERAL_MAX );
+    out_byte( out, n - 1 );
+    while( n-- ){
+      out_byte( out, *data++ );
+      len--;
+    }
+  }
+}
+
+static void out_match( out_buffer_t *out, uint8_t type, uint32_t len, uint32_t arg )
+{
+  len -= OTA_TOKEN_MIN_MATCH;
+  if( len >= OTA_TOKEN_LEN_MASK ){
+    out_byte( out, type | OTA_TOKEN_LEN_MASK );
+    out_varint( out, len - OTA_TOKEN_LEN_MASK );
+  }
+  else
+    out_byte( out, type | len );
+  out_varint( out, arg );
+}
+
+static void encode( const uint8_t *new_data, uint32_t new_length, const uint8_t *old_data, uint32_t old_length, out_buffer_t *out )
+{
+  match_index_t new_index, old_index;
+  match_t match, next;
+  uint32_t pos = 0, literal = 0, old_next = 0, i;
+
+  index_init( &new_index, new_data, new_length );
+  if( old_data ){
+    index_init( &old_index, old_data, old_length );
+    for( i = old_length; i-- > 0; )
+      index_insert( &old_index, i );
+  }
+
+  while( pos < new_length ){
+    find_match( &new_index, old_data ? &old_index : NULL, pos, old_next, &match );
+
+    /* Lazy matching: a better match at the next byte is worth one literal */
+    if( match.gain > 0 && pos + 1 < new_length ){
+      index_insert( &new_index, pos );
+      find_match( &new_index, old_data ? &old_index : NULL, pos + 1, old_next, &next );
+      if( next.gain > match.gain + 1 ){
+        pos++;
+        continue;
+      }
+    }
+    else if( match.gain <= 0 ){
+      index_insert( &new_index, pos );
+      pos++;
+      continue;
+    }
+
+    out_literals( out, new_data + literal, pos - literal );
+    if( match.old ){
+      out_match( out, OTA_TOKEN_OLD, match.len, zigzag( match.from, old_next ) );
+      old_next = match.from + match.len;
+    }
+    else
+      out_match( out, OTA_TOKEN_MATCH, match.len, pos - match.from );
+
+    for( i = pos + 1; i < pos + match.len; i++ )
+      index_insert( &new_index, i );
+    pos += match.len;
+    literal = pos;
+  }
+  out_literals( out, new_data + literal, pos - literal );
+
+  index_free( &new_index );
+  if( old_data )
+    index_free( &old_index );
+}
+
+static uint16_t crc16( const uint8_t *data, uint32_t length )
+{
+  CRC16_Context contex;
+  uint16_t crc;
+
+  CRC16_Init( &contex );
+  CRC16_Update( &contex, data, length );
+  CRC16_Final( &contex, &crc );
+  return crc;
+}
+
+/* Encode new_data, against old_data for a delta, header first */
+static void pack( const uint8_t *new_data, uint32_t new_length, const uint8_t *old_data, uint32_t old_length,
+                  ota_image_header_t *header, out_buffer_t *image )
+{
+  memset( image, 0x0, sizeof(out_buffer_t) );
+  image->length = sizeof(ota_image_header_t);
+  image->size = image->length;
+  image->data = calloc( 1, image->size );
+  encode( new_data, new_length, old_data, old_length, image );
+
+  header->magic = OTA_IMAGE_MAGIC;
+  header->version = OTA_IMAGE_VERSION;
+  header->header_length = sizeof(ota_image_header_t);
+  header->data_length = image->length - sizeof(ota_image_header_t);
+  header->raw_length = new_length;
+  header->raw_crc = crc16( new_data, new_length );
+  if( old_data ){
+    header->old_length = old_length;
+    header->old_crc = crc16( old_data, old_length );
+  }
+  memcpy( image->data, header, sizeof(ota_image_header_t) );
+}
+
+/******************************************************
+ *               Verify
+ ******************************************************/
+
+static int verify( const out_buffer_t *image, const ota_image_header_t *header,
+                   const uint8_t *new_data, const uint8_t *old_data, uint32_t ota_size )
+{
+  static uint8_t in_buffer[DECODE_BUFFER], out_buffer[DECODE_BUFFER];
+  uint32_t stage_offset = 0, app_size;
+  uint16_t crc;
+  OSStatus err;
+  int ret = -1;
+
+  app_size = Max( header->raw_length, header->old_length );
+  sim_flash_length[SIM_OTA_TEMP] = Max( ota_size, image->length );
+  sim_flash_length[SIM_APPLICATION] = app_size;
+  sim_flash[SIM_OTA_TEMP] = malloc( sim_flash_length[SIM_OTA_TEMP] );
+  sim_flash[SIM_APPLICATION] = malloc( app_size + 1 );
+  if( sim_flash[SIM_OTA_TEMP] == NULL || sim_flash[SIM_APPLICATION] == NULL ){
+    fprintf( stderr, "Out of memory\n" );
+    exit( 1 );
+  }
+  memset( sim_flash[SIM_OTA_TEMP], 0xFF, sim_flash_length[SIM_OTA_TEMP] );
+  memset( sim_flash[SIM_APPLICATION], 0xFF, app_size );
+  memcpy( sim_flash[SIM_OTA_TEMP], image->data, image->length );
+
+  if( header->format == OTA_IMAGE_LZ ){
+    err = ota_image_decode( header, SIM_OTA_TEMP, SIM_APPLICATION, 0, MICO_PARTITION_NONE, in_buffer, out_buffer, DECODE_BUFFER );
+  }
+  else{
+    stage_offset = ( image->length + STAGE_ALIGN - 1 ) & ~( STAGE_ALIGN - 1 );
+    if( stage_offset + header->raw_length > ota_size ){
+      fprintf( stderr, "Decoded firmware does not fit after the patch in %u bytes of OTA storage\n", ota_size );
+      goto exit;
+    }
+    memcpy( sim_flash[SIM_APPLICATION], old_data, header->old_length );
+    err = ota_image_decode( header, SIM_OTA_TEMP, SIM_OTA_TEMP, stage_offset, SIM_APPLICATION, in_buffer, out_buffer, DECODE_BUFFER );
+  }
+  if( err != kNoErr ){
+    fprintf( stderr, "Decoder failed with err = %d\n", err );
+    goto exit;
+  }
+
+  if( header->format == OTA_IMAGE_LZ )
+    err = ota_image_crc( SIM_APPLICATION, 0, header->raw_length, in_buffer, DECODE_BUFFER, &crc );
+  else
+    err = ota_image_crc( SIM_OTA_TEMP, stage_offset, header->raw_length, in_buffer, DECODE_BUFFER, &crc );
+  if( err != kNoErr || crc != header->raw_crc ||
+      memcmp( header->format == OTA_IMAGE_LZ ? sim_flash[SIM_APPLICATION] : sim_flash[SIM_OTA_TEMP] + stage_offset,
+              new_data, header->raw_length ) != 0 ){
+    fprintf( stderr, "Decoded firmware does not match\n" );
+    goto exit;
+  }
+  ret = 0;
+
+exit:
+  free( sim_flash[SIM_OTA_TEMP] );
+  free( sim_flash[SIM_APPLICATION] );
+  return ret;
+}
+
+#if !defined( OTA_BENCH_MAIN )
+/******************************************************
+ *               Main
+ ******************************************************/
+
+static uint8_t *read_file( const char *name, uint32_t *outLength )
+{
+  FILE *fp = fopen( name, "rb" );
+  uint8_t *data;
+  long length;
+
+  if( fp == NULL ){
+    fprintf( stderr, "Cannot open %s\n", name );
+    exit( 1 );
+  }
+  fseek( fp, 0, SEEK_END );
+  length = ftell( fp );
+  fseek( fp, 0, SEEK_SET );
+  data = malloc( length + 1 );
+  if( data == NULL || fread( data, 1, length, fp ) != (size_t)length ){
+    fprintf( stderr, "Cannot read %s\n", name );
+    exit( 1 );
+  }
+  fclose( fp );
+  *outLength = length;
+  return data;
+}
+
+/* Raw image with ota_image_trailer_t, checked by a bootloader built with MICO_OTA_SHA256 */
+static int add_trailer( const char *in_name, const char *out_name )
+{
+  ota_image_trailer_t trailer;
+  SHA256Context sha;
+  uint8_t *data;
+  uint32_t length;
+  FILE *fp;
+
+  data = read_file( in_name, &length );
+  SHA256Reset( &sha );
+  SHA256Input( &sha, data, length );
+  SHA256Result( &sha, trailer.sha256 );
+  trailer.magic = OTA_IMAGE_TRAILER_MAGIC;
+
+  fp = fopen( out_name, "wb" );
+  if( fp == NULL || fwrite( data, 1, length, fp ) != length ||
+      fwrite( &trailer, 1, sizeof(trailer), fp ) != sizeof(trailer) ){
+    fprintf( stderr, "Cannot write %s\n", out_name );
+    return 1;
+  }
+  fclose( fp );
+
+  printf( "%s: %u bytes with SHA-256 trailer\n", out_name, length + (uint32_t)sizeof(trailer) );
+  free( data );
+  return 0;
+}
+
+static void usage( void )
+{
+  fprintf( stderr, "Usage: ota_pack [-s ota_size] lz <new.bin> <out.bin>\n"
+                   "       ota_pack [-s ota_size] delta <old.bin> <new.bin> <out.bin>\n"
+                   "       ota_pack sha <new.bin> <out.bin>\n" );
+  exit( 1 );
+}
+
+int main( int argc, char *argv[] )
+{
+  ota_image_header_t header;
+  out_buffer_t image;
+  uint8_t *new_data, *old_data = NULL;
+  uint32_t new_length, old_length = 0, ota_size = DEFAULT_OTA_SIZE;
+  const char *out_name;
+  FILE *fp;
+  int arg = 1;
+
+  if( argc > 2 && strcmp( argv[1], "-s" ) == 0 ){
+    ota_size = strtoul( argv[2], NULL, 0 );
+    arg = 3;
+  }
+
+  memset( &header, 0x0, sizeof(header) );
+  if( argc - arg == 3 && strcmp( argv[arg], "sha" ) == 0 )
+    return add_trailer( argv[arg + 1], argv[arg + 2] );
+  else if( argc - arg == 3 && strcmp( argv[arg], "lz" ) == 0 ){
+    header.format = OTA_IMAGE_LZ;
+    new_data = read_file( argv[arg + 1], &new_length );
+    out_name = argv[arg + 2];
+  }
+  else if( argc - arg == 4 && strcmp( argv[arg], "delta" ) == 0 ){
+    header.format = OTA_IMAGE_DELTA;
+    old_data = read_file( argv[arg + 1], &old_length );
+    new_data = read_file( argv[arg + 2], &new_length );
+    out_name = argv[arg + 3];
+  }
+  else
+    usage();
+
+  pack( new_data, new_length, old_data, old_length, &header, &image );
+  if( verify( &image, &header, new_data, old_data, ota_size ) != 0 )
+    return 1;
+
+  fp = fopen( out_name, "wb" );
+  if( fp == NULL || fwrite( image.data, 1, image.length, fp ) != image.length ){
+    fprintf( stderr, "Cannot write %s\n", out_name );
+    return 1;
+  }
+  fclose( fp );
+
+  printf( "%s: %u bytes -> %u bytes (%.1f%%), verified\n", out_name, new_length, image.length,
+          new_length ? 100.0 * image.length / new_length : 0.0 );
+  free( image.data );
+  free( new_data );
+  free( old_data );
+  return 0;
+}
+#endif // !OTA_BENCH_MAIN
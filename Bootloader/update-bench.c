@@ -0,0 +1,373 @@
+/**
+******************************************************************************
+* @file    update-bench.c
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   update() of Update_for_OTA.c on a simulated flash: application
+*          slots with trial boots and rollback, and the verified copy from OTA
+*          storage with the bytes of OTA storage it reads.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+/* Built on the host only, the partitions are the RAM flash below, programmed like NOR. MICO/system/host holds the
+ * stub platform headers, add -DMICO_OTA_SHA256 -IMICO/security/SHAUtils MICO/security/SHAUtils/sha224-256.c for the
+ * SHA-256 trailer:
+ *
+ *   cc -O2 -DDEBUG=0 -DBOOTLOADER -DUPDATE_BENCH_MAIN -IMICO/system/host -Iinclude -Iinclude/MicoDrivers -IMICO/system \
+ *      -IBootloader -Ilibraries/utilities Bootloader/update-bench.c Bootloader/Update_for_OTA.c Bootloader/ota_image.c \
+ *      libraries/utilities/CheckSumUtils.c -o update-bench && ./update-bench
+ */
+
+#include "mico.h"
+#include "CheckSumUtils.h"
+#include "ota_image.h"
+#ifdef MICO_OTA_SHA256
+#include "sha.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if( defined( UPDATE_BENCH_MAIN ) )
+
+extern OSStatus update(void);
+extern mico_partition_t update_boot_partition( void );
+
+#define kUpdate_BenchFlashBase      0x08000000
+#define kUpdate_BenchKVData         0x20        // kv data after the boot table in PARAMETER_1
+#define kUpdate_BenchKVLength       100
+
+#define A                           MICO_PARTITION_APPLICATION
+#define B                           MICO_PARTITION_OTA_TEMP
+
+//===========================================================================================================================
+//  Flash on the host
+//===========================================================================================================================
+
+static uint8_t                  gUpdate_BenchFlash[ 0x100000 ];
+static mico_logic_partition_t   gUpdate_BenchPartitions[ MICO_PARTITION_MAX ] =
+{
+    [ MICO_PARTITION_BOOTLOADER ]   = { MICO_FLASH_EMBEDDED, "Bootloader",  0x08000000, 0x4000,  0 },
+    [ MICO_PARTITION_APPLICATION ]  = { MICO_FLASH_EMBEDDED, "Application", 0x0800C000, 0x54000, 0 },
+    [ MICO_PARTITION_ATE ]          = { MICO_FLASH_NONE,     "ATE",         0,          0,       0 },
+    [ MICO_PARTITION_OTA_TEMP ]     = { MICO_FLASH_EMBEDDED, "OTA Storage", 0x08060000, 0x60000, 0 },
+    [ MICO_PARTITION_RF_FIRMWARE ]  = { MICO_FLASH_EMBEDDED, "RF",          0x080C0000, 0x40000, 0 },
+    [ MICO_PARTITION_PARAMETER_1 ]  = { MICO_FLASH_EMBEDDED, "PARAMETER1",  0x08004000, 0x4000,  0 },
+    [ MICO_PARTITION_PARAMETER_2 ]  = { MICO_FLASH_EMBEDDED, "PARAMETER2",  0x08008000, 0x4000,  0 },
+};
+static mico_logic_partition_t   gUpdate_BenchNone = { MICO_FLASH_NONE, "None", 0, 0, 0 };
+static int                      gUpdate_BenchParaErases;
+static uint32_t                 gUpdate_BenchOTARead;
+
+static uint8_t * update_bench_at( mico_partition_t inPartition, uint32_t inOffset, uint32_t inLength )
+{
+    if( inPartition < 0 || inPartition >= MICO_PARTITION_MAX ) return( NULL );
+    if( inOffset > gUpdate_BenchPartitions[ inPartition ].partition_length ) return( NULL );
+    if( inLength > gUpdate_BenchPartitions[ inPartition ].partition_length - inOffset ) return( NULL );
+    return( &gUpdate_BenchFlash[ gUpdate_BenchPartitions[ inPartition ].partition_start_addr - kUpdate_BenchFlashBase + inOffset ] );
+}
+
+mico_logic_partition_t* MicoFlashGetInfo( mico_partition_t inPartition )
+{
+    if( inPartition < 0 || inPartition >= MICO_PARTITION_MAX ) return( &gUpdate_BenchNone );
+    return( &gUpdate_BenchPartitions[ inPartition ] );
+}
+
+OSStatus MicoFlashDisableSecurity( mico_partition_t partition, uint32_t off_set, uint32_t size )
+{
+    return( update_bench_at( partition, off_set, size ) ? kNoErr : kRangeErr );
+}
+
+OSStatus MicoFlashErase( mico_partition_t inPartition, uint32_t off_set, uint32_t size )
+{
+    uint8_t * const     flash = update_bench_at( inPartition, off_set, size );
+
+    if( !flash ) return( kRangeErr );
+    if( inPartition == MICO_PARTITION_PARAMETER_1 ) gUpdate_BenchParaErases++;
+    memset( flash, 0xFF, size );
+    return( kNoErr );
+}
+
+OSStatus MicoFlashWrite( mico_partition_t inPartition, volatile uint32_t* off_set, uint8_t* inBuffer, uint32_t inBufferLength )
+{
+    uint8_t * const     flash = update_bench_at( inPartition, *off_set, inBufferLength );
+    uint32_t            i;
+
+    if( !flash ) return( kRangeErr );
+    for( i = 0; i < inBufferLength; ++i ) flash[ i ] &= inBuffer[ i ];
+    *off_set += inBufferLength;
+    return( kNoErr );
+}
+
+OSStatus MicoFlashRead( mico_partition_t inPartition, volatile uint32_t* off_set, uint8_t* outBuffer, uint32_t inBufferLength )
+{
+    uint8_t * const     flash = update_bench_at( inPartition, *off_set, inBufferLength );
+
+    if( !flash ) return( kRangeErr );
+    if( inPartition == MICO_PARTITION_OTA_TEMP ) gUpdate_BenchOTARead += inBufferLength;
+    memcpy( outBuffer, flash, inBufferLength );
+    *off_set += inBufferLength;
+    return( kNoErr );
+}
+
+//===========================================================================================================================
+//  Images and boot table
+//===========================================================================================================================
+
+// An image of inLength bytes in inPartition, linked to run from inLink: the vector table has a stack pointer in RAM
+// and a reset vector inside the link partition. Returns its CRC16.
+
+static uint16_t update_bench_image( mico_partition_t inPartition, mico_partition_t inLink, uint32_t inLength,
+                                    unsigned int inSeed )
+{
+    uint8_t * const     image = update_bench_at( inPartition, 0, inLength );
+    uint32_t const      vector[ 2 ] = { 0x20010000, gUpdate_BenchPartitions[ inLink ].partition_start_addr + 0x101 };
+    CRC16_Context       crc16;
+    uint16_t            crc;
+    uint32_t            i;
+
+    memset( image, 0xFF, gUpdate_BenchPartitions[ inPartition ].partition_length );
+    for( i = 0; i < inLength; ++i ) image[ i ] = (uint8_t) rand_r( &inSeed );
+    memcpy( image, vector, sizeof( vector ) );
+
+    CRC16_Init( &crc16 );
+    CRC16_Update( &crc16, image, inLength );
+    CRC16_Final( &crc16, &crc );
+    return( crc );
+}
+
+static boot_table_t * update_bench_table( void )
+{
+    return( (boot_table_t *) update_bench_at( MICO_PARTITION_PARAMETER_1, 0, sizeof( boot_table_t ) ) );
+}
+
+// The record the application saves after a download, through the kv preamble: erased, then programmed.
+
+static void update_bench_request( mico_partition_t inPartition, uint32_t inLength, uint16_t inCrc )
+{
+    boot_table_t        table;
+
+    memset( &table, 0, sizeof( table ) );
+    table.start_address = gUpdate_BenchPartitions[ inPartition ].partition_start_addr;
+    table.length        = inLength;
+    table.type          = 'A';
+    table.upgrade_type  = BOOT_UPGRADE;
+    table.crc           = inCrc;
+    memset( update_bench_table(), 0xFF, sizeof( table ) );
+    memcpy( update_bench_table(), &table, sizeof( table ) );
+}
+
+static mico_partition_t update_bench_boot( void )
+{
+    update();
+    return( update_boot_partition() );
+}
+
+//===========================================================================================================================
+//  update_slot_test
+//===========================================================================================================================
+
+static OSStatus update_slot_test( void )
+{
+    OSStatus            err = kNoErr;
+    boot_table_t *      table = update_bench_table();
+    uint16_t            crc;
+    int                 i;
+
+    update_bench_image( A, A, 200000, 1 );
+
+    // No record, the application partition
+
+    require_action( update_bench_boot() == A, exit, err = kResponseErr );
+
+    // An image linked for slot B is booted where it was downloaded, on trial, and rolled back when it is not
+    // confirmed. Trial boots clear a bit in place, only the first and the rollback erase the parameters.
+
+    crc = update_bench_image( B, B, 250000, 2 );
+    update_bench_request( B, 250000, crc );
+    gUpdate_BenchParaErases = 0;
+    require_action( update_bench_boot() == B && table->upgrade_type == BOOT_UPGRADE_TRIAL && table->slot == BOOT_SLOT_B &&
+        table->trial == 0x03, exit, err = kResponseErr );
+    require_action( update_bench_boot() == B && table->trial == 0x02, exit, err = kResponseErr );
+    require_action( update_bench_boot() == B && table->trial == 0x00, exit, err = kResponseErr );
+    require_action( gUpdate_BenchParaErases == 1, exit, err = kResponseErr );
+    require_action( update_bench_boot() == A && table->upgrade_type == BOOT_UPGRADE_CONFIRMED && table->slot == BOOT_SLOT_A,
+        exit, err = kResponseErr );
+    require_action( update_bench_boot() == A && gUpdate_BenchParaErases == 2, exit, err = kResponseErr );
+    require_action( *update_bench_at( B, 0, 1 ) != 0xFF, exit, err = kResponseErr );   // The old slot is kept
+
+    // Confirmed by the application, in place
+
+    update_bench_request( B, 250000, crc );
+    require_action( update_bench_boot() == B, exit, err = kResponseErr );
+    table->upgrade_type &= BOOT_UPGRADE_CONFIRMED;
+    for( i = 0; i < 5; ++i )
+    {
+        require_action( update_bench_boot() == B && table->slot == BOOT_SLOT_B, exit, err = kResponseErr );
+    }
+
+    // Running slot B, an image linked for the application partition downloaded there, not confirmed
+
+    crc = update_bench_image( A, A, 300000, 3 );
+    update_bench_request( A, 300000, crc );
+    require_action( update_bench_boot() == A && table->slot == BOOT_SLOT_A && table->upgrade_type == BOOT_UPGRADE_TRIAL,
+        exit, err = kResponseErr );
+    require_action( update_bench_boot() == A, exit, err = kResponseErr );
+    require_action( update_bench_boot() == A, exit, err = kResponseErr );
+    require_action( update_bench_boot() == B && table->slot == BOOT_SLOT_B, exit, err = kResponseErr );
+
+    // Running slot B, the image in the application partition is linked for B or fails its CRC: stay in B
+
+    crc = update_bench_image( A, B, 300000, 4 );
+    update_bench_request( A, 300000, crc );
+    require_action( update_bench_boot() == B && table->slot == BOOT_SLOT_B && table->upgrade_type == BOOT_UPGRADE_CONFIRMED,
+        exit, err = kResponseErr );
+    crc = update_bench_image( A, A, 300000, 5 );
+    update_bench_request( A, 300000, crc ^ 1 );
+    require_action( update_bench_boot() == B && table->slot == BOOT_SLOT_B, exit, err = kResponseErr );
+
+    // Slot B erased by hand while it is the active one
+
+    memset( table, 0xFF, sizeof( boot_table_t ) );
+    table->upgrade_type = BOOT_UPGRADE_CONFIRMED;
+    table->slot = BOOT_SLOT_B;
+    memset( update_bench_at( B, 0, 0x1000 ), 0xFF, 0x1000 );
+    require_action( update_bench_boot() == A, exit, err = kResponseErr );
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  update_copy_test
+//===========================================================================================================================
+
+static OSStatus update_copy_test( int inPrint )
+{
+    OSStatus            err = kNoErr;
+    boot_table_t *      table = update_bench_table();
+    uint8_t *           copy;
+    uint16_t            crc;
+    int                 pass;
+#ifdef MICO_OTA_SHA256
+    ota_image_trailer_t trailer;
+    SHA256Context       sha;
+    CRC16_Context       crc16;
+#endif
+
+    copy = malloc( 220000 );
+    require_action( copy, exit, err = kNoMemoryErr );
+    update_bench_image( A, A, 200000, 6 );
+    memset( table, 0xFF, sizeof( boot_table_t ) );
+    require_action( update_bench_boot() == A, exit, err = kResponseErr );
+
+    // A legacy image linked for the application partition is copied there, then the record and OTA storage are
+    // cleared. OTA storage is read once for the copy, the read-back compares with the destination.
+
+    for( pass = 0; pass < 2; ++pass )
+    {
+        crc = update_bench_image( B, A, 220000, 7 + pass );
+        memcpy( copy, update_bench_at( B, 0, 220000 ), 220000 );
+        update_bench_request( B, 220000, pass ? 0xFFFF : crc );   // 0xFFFF: the CRC is not known
+        gUpdate_BenchOTARead = 0;
+        require_action( update_bench_boot() == A, exit, err = kResponseErr );
+        require_action( memcmp( update_bench_at( A, 0, 220000 ), copy, 220000 ) == 0, exit, err = kIntegrityErr );
+        require_action( table->upgrade_type == 0xFF && *update_bench_at( B, 0, 1 ) == 0xFF, exit, err = kResponseErr );
+        require_action( gUpdate_BenchOTARead < 220000 + 0x1000, exit, err = kSizeErr );
+    }
+    if( inPrint ) printf( "OTA storage read %u bytes to copy a %u bytes image\n", gUpdate_BenchOTARead, 220000 );
+
+    // A corrupted image is copied once, then dropped
+
+    crc = update_bench_image( B, A, 220000, 9 );
+    update_bench_request( B, 220000, crc ^ 1 );
+    require_action( update() == kChecksumErr, exit, err = kResponseErr );
+    require_action( table->upgrade_type == 0xFF && *update_bench_at( B, 0, 1 ) == 0xFF, exit, err = kResponseErr );
+    require_action( update() == kNoErr, exit, err = kResponseErr );
+
+#ifdef MICO_OTA_SHA256
+    // The SHA-256 trailer, also checked when the CRC is not known
+
+    crc = update_bench_image( B, A, 220000, 10 );
+    SHA256Reset( &sha );
+    SHA256Input( &sha, update_bench_at( B, 0, 220000 ), 220000 );
+    SHA256Result( &sha, trailer.sha256 );
+    trailer.magic = OTA_IMAGE_TRAILER_MAGIC;
+    memcpy( update_bench_at( B, 220000, sizeof( trailer ) ), &trailer, sizeof( trailer ) );
+    CRC16_Init( &crc16 );
+    CRC16_Update( &crc16, update_bench_at( B, 0, 220000 + sizeof( trailer ) ), 220000 + sizeof( trailer ) );
+    CRC16_Final( &crc16, &crc );
+    update_bench_request( B, 220000 + sizeof( trailer ), crc );
+    require_action( update() == kNoErr && table->upgrade_type == 0xFF, exit, err = kResponseErr );
+
+    update_bench_image( B, A, 220000, 11 );
+    trailer.sha256[ 3 ] ^= 1;
+    memcpy( update_bench_at( B, 220000, sizeof( trailer ) ), &trailer, sizeof( trailer ) );
+    update_bench_request( B, 220000 + sizeof( trailer ), 0xFFFF );
+    require_action( update() == kChecksumErr && table->upgrade_type == 0xFF, exit, err = kResponseErr );
+    if( inPrint ) printf( "SHA-256 trailer checked\n" );
+#endif
+
+exit:
+    free( copy );
+    return( err );
+}
+
+//===========================================================================================================================
+//  update_bench
+//===========================================================================================================================
+
+OSStatus    update_bench( int print )
+{
+    OSStatus            err;
+    uint8_t *           kv = update_bench_at( MICO_PARTITION_PARAMETER_1, kUpdate_BenchKVData, kUpdate_BenchKVLength );
+    int                 i;
+
+    memset( gUpdate_BenchFlash, 0xFF, sizeof( gUpdate_BenchFlash ) );
+    memset( kv, 0x5A, kUpdate_BenchKVLength );
+
+    err = update_slot_test();
+    require_noerr( err, exit );
+    err = update_copy_test( print );
+    require_noerr( err, exit );
+
+    // The boot table is rewritten, the kv data after it is kept
+
+    for( i = 0; i < kUpdate_BenchKVLength; ++i )
+    {
+        require_action( kv[ i ] == 0x5A, exit, err = kIntegrityErr );
+    }
+
+exit:
+    printf( "%s: %s\n", __FUNCTION__, !err ? "PASSED" : "FAILED" );
+    return( err );
+}
+
+int main( void )
+{
+    return( update_bench( 1 ) ? 1 : 0 );
+}
+
+#endif // UPDATE_BENCH_MAIN
@@ -43,6 +43,8 @@ SOFTWARE.
 
 #define http_client_log(M, ...) custom_log("HTTP", M, ##__VA_ARGS__)
 
+#define HTTP_CLIENT_HEADER_BUFFER_SIZE  1024
+
 static OSStatus onReceivedData(struct _HTTPHeader_t * httpHeader, 
                                uint32_t pos, 
                                uint8_t *data, 
@@ -156,8 +158,8 @@ void start_http_get( )
   char content_length[20]={0};
   char *httpRequest = (char*)malloc(256);
 
-  /*HTTPHeaderCreateWithCallback set some callback functions */
-  HTTPHeader_t *httpHeader = HTTPHeaderCreateWithCallback(onReceivedData, NULL, NULL);
+  /*HTTPHeaderCreateWithBuffer set some callback functions, web servers may respond with long headers */
+  HTTPHeader_t *httpHeader = HTTPHeaderCreateWithBuffer(NULL, HTTP_CLIENT_HEADER_BUFFER_SIZE, onReceivedData, NULL, NULL);
   require_action( httpHeader, EXIT, err = kNoMemoryErr );
   
   /*get free memory*/
@@ -93,16 +93,15 @@ void localTcpClient_thread(void *inFd)
   fd_set writeSet;
   struct timeval_t t;
   int eventFd = -1;
-  mico_queue_t queue;
-  socket_msg_t *msg;
-  int sent_len, errno;
+  int client = -1;
+  int errno;
 
   inDataBuffer = malloc(wlanBufferLen);
   require_action(inDataBuffer, exit, err = kNoMemoryErr);
 
-  err = socket_queue_create(context, &queue);
-  require_noerr( err, exit );
-  eventFd = mico_create_event_fd(queue);
+  client = spp_client_attach(context, clientFd);
+  require_action( client >= 0, exit, err = kNoResourcesErr );
+  eventFd = spp_client_event_fd(context, client);
   if (eventFd < 0) {
     server_log("create event fd error");
     goto exit_with_queue;
@@ -124,22 +123,14 @@ void localTcpClient_thread(void *inFd)
         FD_SET(clientFd, &writeSet );
         t.tv_usec = 100*1000; // max wait 100ms.
         select(1, NULL, &writeSet, NULL, &t);
-        if((FD_ISSET( clientFd, &writeSet )) &&
-            (kNoErr == mico_rtos_pop_from_queue( &queue, &msg, 0))) {
-           sent_len = write(clientFd, msg->data, msg->len);
-           if (sent_len <= 0) {
-              len = sizeof(errno);
-              getsockopt(clientFd, SOL_SOCKET, SO_ERROR, &errno, &len);
-              socket_msg_free(msg);
-              server_log("write error, fd: %d, errno %d", clientFd, errno );
-              if (errno != ENOMEM) {
-                  goto exit_with_queue;
-              }
-           } else {
-                  socket_msg_free(msg);
-              }
-           }
+        if (FD_ISSET( clientFd, &writeSet )) {
+           err = spp_client_send(context, client);
+           require_noerr( err, exit_with_queue );
+        } else {
+           /* Not writable yet, try again on next loop */
+           mico_rtos_set_semaphore( &context->appStatus.clients[client].data_sem );
         }
+    }
 
     /*Read data from tcp clients and process these data using HA protocol */ 
     if (FD_ISSET(clientFd, &readfds)) {
@@ -156,7 +147,7 @@ exit_with_queue:
     if (eventFd >= 0) {
         mico_delete_event_fd(eventFd);
     }
-    socket_queue_delete(context, &queue);
+    spp_client_detach(context, client);
 exit:
     SocketClose(&clientFd);
     if(inDataBuffer) free(inDataBuffer);
@@ -34,8 +34,7 @@ extern "C" {
 
 /*User provided configurations*/
 #define CONFIGURATION_VERSION               0x00000002 // if default configuration is changed, update this number
-#define MAX_QUEUE_NUM                       6  // 1 remote client, 5 local server
-#define MAX_QUEUE_LENGTH                    8  // each queue max 8 msg
+#define MAX_CLIENT_NUM                      6  // 1 remote client, 5 local server
 #define LOCAL_PORT                          8080
 #define DEAFULT_REMOTE_SERVER               "192.168.2.254"
 #define DEFAULT_REMOTE_SERVER_PORT          8080
@@ -43,6 +42,19 @@ extern "C" {
 #define UART_ONE_PACKAGE_LENGTH             1024
 #define wlanBufferLen                       1024
 #define UART_BUFFER_LENGTH                  2048
+#define UART_FANOUT_BUFFER_LENGTH           4096 // UART data shared by all clients, must be a power of 2
+
+/* What to do when a client cannot take UART data as fast as it comes */
+#define SPP_SLOW_CLIENT_DROP                0  // The client loses its oldest data
+#define SPP_SLOW_CLIENT_BLOCK               1  // Stop reading UART until the client catches up, drop after SPP_SLOW_CLIENT_TIMEOUT
+#define SPP_SLOW_CLIENT_POLICY              SPP_SLOW_CLIENT_DROP
+#define SPP_SLOW_CLIENT_TIMEOUT             1000
+
+/* Collect small UART reads into one TCP segment, it is sent when any limit is reached */
+#define SPP_COALESCE_MAX_BYTES              1460 // Bytes waiting, one TCP segment
+#define SPP_COALESCE_MAX_LATENCY            20   // ms after the first byte waiting, 0 sends every UART read at once
+#define SPP_COALESCE_DELIMITER              '\n' // Send at once when received, comment out to disable
+#define SPP_COALESCE_LATENCY_BUCKETS        8
 
 #define LOCAL_TCP_SERVER_LOOPBACK_PORT      1000
 #define REMOTE_TCP_CLIENT_LOOPBACK_PORT     1002
@@ -63,11 +75,27 @@ extern "C" {
   #define STACK_SIZE_REMOTE_TCP_CLIENT_THREAD   0x260
 #endif
 
-typedef struct _socket_msg {
-  int ref;
-  int len;
-  uint8_t data[1];
-} socket_msg_t;
+/*A TCP client reading UART data from the fan-out buffer*/
+typedef struct _spp_client {
+  bool              used;
+  int               fd;
+  uint32_t          cursor;       // Next byte to send, counts like uart_fanout_tail
+  uint32_t          sending;      // Bytes after cursor being sent, they are not overwritten
+  uint32_t          sent;
+  uint32_t          max_lag;
+  uint32_t          dropped;
+  mico_semaphore_t  data_sem;     // Set when there is new data
+} spp_client_t;
+
+/*UART data coalescing statistics*/
+typedef struct _spp_coalesce_stats {
+  uint32_t          uart_reads;
+  uint32_t          flushes;
+  uint32_t          on_size;
+  uint32_t          on_delimiter;
+  uint32_t          on_latency;
+  uint32_t          latency[SPP_COALESCE_LATENCY_BUCKETS]; // Added latency histogram, see spp_latency_bounds
+} spp_coalesce_stats_t;
 
 /*Application's configuration stores in flash*/
 typedef struct
@@ -88,9 +116,15 @@ typedef struct
 
 /*Running status*/
 typedef struct  {
-  /*Local clients port list*/
-  mico_queue_t*   socket_out_queue[MAX_QUEUE_NUM];
-  mico_mutex_t    queue_mtx;
+  /*UART data fan-out, every client sends from uart_fanout_buffer at its own cursor*/
+  uint8_t*          uart_fanout_buffer;
+  uint32_t          uart_fanout_tail;
+  uint32_t          uart_fanout_flush;      // Clients send data up to here, coalesced data is after it
+  uint32_t          uart_fanout_flush_time; // When the first byte after uart_fanout_flush arrived
+  spp_coalesce_stats_t coalesce_stats;
+  spp_client_t      clients[MAX_CLIENT_NUM];
+  mico_mutex_t      clients_mtx;
+  mico_semaphore_t  space_sem;    // Set when a client has sent data
 } current_app_status_t;
 
 typedef struct _app_context_t
@@ -63,10 +63,8 @@ void remoteTcpClient_thread(void *inContext)
   int remoteTcpClient_fd = -1;
   uint8_t *inDataBuffer = NULL;
   int eventFd = -1;
-  mico_queue_t queue;
-  socket_msg_t *msg;
+  int client = -1;
   LinkStatusTypeDef wifi_link;
-  int sent_len, errno;
   
   mico_rtos_init_semaphore(&_wifiConnected_sem, 1);
   
@@ -100,12 +98,11 @@ void remoteTcpClient_thread(void *inContext)
       client_log("Remote server connected at port: %d, fd: %d",  context->appConfig->remoteServerPort,
                  remoteTcpClient_fd);
       
-      err = socket_queue_create(context, &queue);
-      require_noerr( err, exit );
-      eventFd = mico_create_event_fd(queue);
+      client = spp_client_attach(context, remoteTcpClient_fd);
+      require_action( client >= 0, ReConnWithDelay, err = kNoResourcesErr );
+      eventFd = spp_client_event_fd(context, client);
       if (eventFd < 0) {
         client_log("create event fd error");
-        socket_queue_delete(context, &queue);
         goto ReConnWithDelay;
       }
     }else{
@@ -121,22 +118,16 @@ void remoteTcpClient_thread(void *inContext)
         FD_SET(remoteTcpClient_fd, &writeSet );
         t.tv_usec = 100*1000; // max wait 100ms.
         select(1, NULL, &writeSet, NULL, &t);
-        if ((FD_ISSET(remoteTcpClient_fd, &writeSet )) && 
-            (kNoErr == mico_rtos_pop_from_queue( &queue, &msg, 0))) {
-           sent_len = write(remoteTcpClient_fd, msg->data, msg->len);
-           if (sent_len <= 0) {
-            len = sizeof(errno);
-            getsockopt(remoteTcpClient_fd, SOL_SOCKET, SO_ERROR, &errno, &len);
-      
-            socket_msg_free(msg);
-            if (errno != ENOMEM) {
-                client_log("write error, fd: %d, errno %d", remoteTcpClient_fd,errno );
-                goto ReConnWithDelay;
-            }
-           } else {
-                    socket_msg_free(msg);
-                }
-            }
+        if (FD_ISSET(remoteTcpClient_fd, &writeSet )) {
+           err = spp_client_send(context, client);
+           if (err != kNoErr) {
+              client_log("write error, fd: %d", remoteTcpClient_fd );
+              goto ReConnWithDelay;
+           }
+        } else {
+           /* Not writable yet, try again on next loop */
+           mico_rtos_set_semaphore( &context->appStatus.clients[client].data_sem );
+        }
       }
       /*recv wlan data using remote client fd*/
       if (FD_ISSET(remoteTcpClient_fd, &readfds)) {
@@ -155,7 +146,10 @@ void remoteTcpClient_thread(void *inContext)
         if (eventFd >= 0) {
           mico_delete_event_fd(eventFd);
           eventFd = -1;
-          socket_queue_delete(context, &queue);
+        }
+        if (client >= 0) {
+          spp_client_detach(context, client);
+          client = -1;
         }
         if(remoteTcpClient_fd != -1){
           SocketClose(&remoteTcpClient_fd);
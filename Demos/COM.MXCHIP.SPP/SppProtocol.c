@@ -24,28 +24,49 @@
 #include "SppProtocol.h"
 #include "SocketUtils.h"
 #include "debug.h"
+#ifdef MICO_CLI_ENABLE
+#include "mico_cli.h"
+#endif
 
-#define MAX_SOCK_MSG_LEN (10*1024)
-int sockmsg_len = 0;
 #define spp_log(M, ...) custom_log("SPP", M, ##__VA_ARGS__)
 #define spp_log_trace() custom_log_trace("SPP")
 
-void socket_msg_take(socket_msg_t*msg);
-void socket_msg_free(socket_msg_t*msg);
+#define FANOUT_MASK         ( UART_FANOUT_BUFFER_LENGTH - 1 )
 
+#ifdef MICO_CLI_ENABLE
+static app_context_t *spp_context = NULL;
+static void spp_client_Command(char *pcWriteBuffer, int xWriteBufferLen, int argc, char **argv);
+static void spp_coalesce_Command(char *pcWriteBuffer, int xWriteBufferLen, int argc, char **argv);
+
+static const struct cli_command spp_clis[] = {
+  {"sppclient", "Show UART data sent, lag and dropped for every SPP client", spp_client_Command},
+  {"sppbatch", "Show UART data coalescing statistics, [-c] to clear", spp_coalesce_Command},
+};
+#endif
 
 OSStatus sppProtocolInit(app_context_t * const inContext)
 {
-  int i;
+  OSStatus err = kNoErr;
   
   spp_log_trace();
-  (void)inContext;
 
-  for(i=0; i < MAX_QUEUE_NUM; i++) {
-    inContext->appStatus.socket_out_queue[i] = NULL;
-  }
-  mico_rtos_init_mutex(&inContext->appStatus.queue_mtx);
-  return kNoErr;
+  memset( inContext->appStatus.clients, 0x0, sizeof(inContext->appStatus.clients) );
+  inContext->appStatus.uart_fanout_tail = 0;
+  inContext->appStatus.uart_fanout_flush = 0;
+  memset( &inContext->appStatus.coalesce_stats, 0x0, sizeof(spp_coalesce_stats_t) );
+  inContext->appStatus.uart_fanout_buffer = malloc( UART_FANOUT_BUFFER_LENGTH );
+  require_action( inContext->appStatus.uart_fanout_buffer, exit, err = kNoMemoryErr );
+
+  mico_rtos_init_mutex(&inContext->appStatus.clients_mtx);
+  mico_rtos_init_semaphore(&inContext->appStatus.space_sem, 1);
+
+#ifdef MICO_CLI_ENABLE
+  spp_context = inContext;
+  cli_register_commands( spp_clis, sizeof(spp_clis)/sizeof(struct cli_command) );
+#endif
+
+exit:
+  return err;
 }
 
 OSStatus sppWlanCommandProcess(unsigned char *inBuf, int *inBufLen, int inSocketFd, app_context_t * const inContext)
@@ -61,111 +82,310 @@ OSStatus sppWlanCommandProcess(unsigned char *inBuf, int *inBufLen, int inSocket
   return err;
 }
 
+/* Make room for inLen bytes at the tail, by waiting for or dropping data of slow clients.
+   Bytes a client is sending are never dropped. Must be called with clients_mtx locked, 
+   it is unlocked while waiting. */
+static void _spp_fanout_make_room( app_context_t * const inContext, uint32_t inLen )
+{
+  current_app_status_t *status = &inContext->appStatus;
+  spp_client_t *client;
+  uint32_t used, drop;
+  int i;
+#if SPP_SLOW_CLIENT_POLICY == SPP_SLOW_CLIENT_BLOCK
+  uint32_t start = mico_get_time();
+#endif
+
+  while(1) {
+    drop = 0;
+    for(i=0; i < MAX_CLIENT_NUM; i++) {
+      client = &status->clients[i];
+      if( client->used == false ) continue;
+      used = status->uart_fanout_tail - client->cursor;
+      if( used + inLen <= UART_FANOUT_BUFFER_LENGTH ) continue;
+
+#if SPP_SLOW_CLIENT_POLICY == SPP_SLOW_CLIENT_BLOCK
+      if( mico_get_time() - start < SPP_SLOW_CLIENT_TIMEOUT ){
+        drop = 1;
+        continue;
+      }
+#endif
+      /* Bytes being sent cannot be dropped, wait for the send to complete */
+      if( client->sending ){
+        drop = 1;
+        continue;
+      }
+      client->cursor += used + inLen - UART_FANOUT_BUFFER_LENGTH;
+      client->dropped += used + inLen - UART_FANOUT_BUFFER_LENGTH;
+    }
+
+    if( drop == 0 ) return;
+
+    mico_rtos_unlock_mutex(&status->clients_mtx);
+    mico_rtos_get_semaphore(&status->space_sem, 10);
+    mico_rtos_lock_mutex(&status->clients_mtx);
+  }
+}
+
+/* Get the free part of the fan-out buffer at the tail, UART data can be received into it
+   and passed to sppUartCommandProcess without a copy */
+uint8_t* sppUartBufferGet(app_context_t * const inContext, int *outLen)
+{
+  current_app_status_t *status = &inContext->appStatus;
+  uint32_t offset = status->uart_fanout_tail & FANOUT_MASK;
+
+  *outLen = MIN( UART_FANOUT_BUFFER_LENGTH - offset, UART_ONE_PACKAGE_LENGTH );
+
+  mico_rtos_lock_mutex(&status->clients_mtx);
+  _spp_fanout_make_room( inContext, *outLen );
+  mico_rtos_unlock_mutex(&status->clients_mtx);
+
+  return status->uart_fanout_buffer + offset;
+}
+
+/* Upper bounds in ms of the added latency histogram buckets, the last one takes the rest */
+static const uint32_t spp_latency_bounds[SPP_COALESCE_LATENCY_BUCKETS - 1] = {0, 1, 2, 5, 10, 20, 50};
+
+/* Let clients send all coalesced data. Must be called with clients_mtx locked. */
+static void _spp_fanout_flush( app_context_t * const inContext )
+{
+  current_app_status_t *status = &inContext->appStatus;
+  uint32_t latency = mico_get_time() - status->uart_fanout_flush_time;
+  int i;
+
+  for(i=0; i < SPP_COALESCE_LATENCY_BUCKETS - 1; i++) {
+    if( latency <= spp_latency_bounds[i] ) break;
+  }
+  status->coalesce_stats.latency[i]++;
+  status->coalesce_stats.flushes++;
+
+  status->uart_fanout_flush = status->uart_fanout_tail;
+  for(i=0; i < MAX_CLIENT_NUM; i++) {
+    if( status->clients[i].used == false ) continue;
+    mico_rtos_set_semaphore( &status->clients[i].data_sem );
+  }
+}
+
+uint32_t sppUartFlushTimeout(app_context_t * const inContext)
+{
+  current_app_status_t *status = &inContext->appStatus;
+  uint32_t waited, timeout = MICO_WAIT_FOREVER;
+
+  mico_rtos_lock_mutex(&status->clients_mtx);
+  if( status->uart_fanout_flush != status->uart_fanout_tail ){
+    waited = mico_get_time() - status->uart_fanout_flush_time;
+    if( waited >= SPP_COALESCE_MAX_LATENCY ){
+      status->coalesce_stats.on_latency++;
+      _spp_fanout_flush( inContext );
+    }
+    else
+      timeout = SPP_COALESCE_MAX_LATENCY - waited;
+  }
+  mico_rtos_unlock_mutex(&status->clients_mtx);
+
+  return timeout;
+}
+
 OSStatus sppUartCommandProcess(uint8_t *inBuf, int inLen, app_context_t * const inContext)
 {
   spp_log_trace();
   OSStatus err = kNoErr;
-  int i;
-  mico_queue_t* p_queue=NULL;
-  socket_msg_t *real_msg;
+  current_app_status_t *status = &inContext->appStatus;
+  uint8_t *tail;
+  uint32_t lag;
+  int i, len;
+  bool delimiter;
 
-  for(i=0; i < MAX_QUEUE_NUM; i++) {
-    p_queue = inContext->appStatus.socket_out_queue[i];
-    if(p_queue  != NULL ){
-      break;
+  require_action( status->uart_fanout_buffer, exit, err = kNotInitializedErr );
+
+  while( inLen > 0 ){
+    /* Data not received by sppUartBufferGet is copied to the buffer */
+    tail = sppUartBufferGet( inContext, &len );
+    len = MIN( len, inLen );
+    if( inBuf != tail )
+      memcpy( tail, inBuf, len );
+    inBuf += len;
+    inLen -= len;
+
+#ifdef SPP_COALESCE_DELIMITER
+    delimiter = ( memchr( tail, SPP_COALESCE_DELIMITER, len ) != NULL );
+#else
+    delimiter = false;
+#endif
+
+    mico_rtos_lock_mutex(&status->clients_mtx);
+    if( status->uart_fanout_flush == status->uart_fanout_tail )
+      status->uart_fanout_flush_time = mico_get_time();
+    status->uart_fanout_tail += len;
+    status->coalesce_stats.uart_reads++;
+    for(i=0; i < MAX_CLIENT_NUM; i++) {
+      if( status->clients[i].used == false ) continue;
+      lag = status->uart_fanout_tail - status->clients[i].cursor;
+      if( lag > status->clients[i].max_lag )
+        status->clients[i].max_lag = lag;
     }
-  }
-  if (p_queue == NULL)
-    return kNoErr;
-  
-  if (MAX_SOCK_MSG_LEN < sockmsg_len)
-    return kNoMemoryErr;
-  real_msg = (socket_msg_t*)malloc(sizeof(socket_msg_t) - 1 + inLen);
-
-  if (real_msg == NULL)
-    return kNoMemoryErr;
-  sockmsg_len += (sizeof(socket_msg_t) - 1 + inLen);
-  real_msg->len = inLen;
-  memcpy(real_msg->data, inBuf, inLen);
-  real_msg->ref = 0;
-  
-  mico_rtos_lock_mutex(&inContext->appStatus.queue_mtx);
-  socket_msg_take(real_msg);
-  for(i=0; i < MAX_QUEUE_NUM; i++) {
-    p_queue = inContext->appStatus.socket_out_queue[i];
-    if(p_queue  != NULL ){
-      socket_msg_take(real_msg);
-      if (kNoErr != mico_rtos_push_to_queue(p_queue, &real_msg, 0)) {
-        socket_msg_free(real_msg);
+
+    if( status->uart_fanout_tail - status->uart_fanout_flush >= SPP_COALESCE_MAX_BYTES ){
+      status->coalesce_stats.on_size++;
+      _spp_fanout_flush( inContext );
     }
+    else if( delimiter ){
+      status->coalesce_stats.on_delimiter++;
+      _spp_fanout_flush( inContext );
+    }
+    else if( mico_get_time() - status->uart_fanout_flush_time >= SPP_COALESCE_MAX_LATENCY ){
+      status->coalesce_stats.on_latency++;
+      _spp_fanout_flush( inContext );
+    }
+    mico_rtos_unlock_mutex(&status->clients_mtx);
   }
-  }        
-  socket_msg_free(real_msg);
-  mico_rtos_unlock_mutex(&inContext->appStatus.queue_mtx);
+
+exit:
   return err;
 }
 
-void socket_msg_take(socket_msg_t*msg)
+int spp_client_attach(app_context_t * const inContext, int fd)
 {
-    msg->ref++;
+  current_app_status_t *status = &inContext->appStatus;
+  spp_client_t *client;
+  int i;
+
+  mico_rtos_lock_mutex(&status->clients_mtx);
+  for(i=0; i < MAX_CLIENT_NUM; i++) {
+    if( status->clients[i].used == false )
+      break;
+  }
+  if( i == MAX_CLIENT_NUM || status->uart_fanout_buffer == NULL ){
+    mico_rtos_unlock_mutex(&status->clients_mtx);
+    return -1;
+  }
+
+  client = &status->clients[i];
+  memset( client, 0x0, sizeof(spp_client_t) );
+  if( mico_rtos_init_semaphore( &client->data_sem, 1 ) != kNoErr ){
+    mico_rtos_unlock_mutex(&status->clients_mtx);
+    return -1;
+  }
+  /* A new client gets UART data received from now on */
+  client->cursor = status->uart_fanout_flush;
+  client->fd = fd;
+  client->used = true;
+  mico_rtos_unlock_mutex(&status->clients_mtx);
+
+  return i;
 }
 
-void socket_msg_free(socket_msg_t*msg)
+int spp_client_event_fd(app_context_t * const inContext, int client)
 {
-    msg->ref--;
-    if (msg->ref == 0) {
-        sockmsg_len -= (sizeof(socket_msg_t) - 1 + msg->len);
-        free(msg);
-    
-    }
+  return mico_create_event_fd( inContext->appStatus.clients[client].data_sem );
 }
 
-int socket_queue_create(app_context_t * const inContext, mico_queue_t *queue)
+void spp_client_detach(app_context_t * const inContext, int client)
 {
-    OSStatus err;
-    int i;
-    mico_queue_t *p_queue;
-    
-    err = mico_rtos_init_queue(queue, "sockqueue", sizeof(int), MAX_QUEUE_LENGTH);
-    if (err != kNoErr)
-        return -1;
-    mico_rtos_lock_mutex(&inContext->appStatus.queue_mtx);
-    for(i=0; i < MAX_QUEUE_NUM; i++) {
-        p_queue = inContext->appStatus.socket_out_queue[i];
-        if(p_queue == NULL ){
-            inContext->appStatus.socket_out_queue[i] = queue;
-            mico_rtos_unlock_mutex(&inContext->appStatus.queue_mtx);
-            return 0;
-        }
-    }        
-    mico_rtos_unlock_mutex(&inContext->appStatus.queue_mtx);
-    mico_rtos_deinit_queue(queue);
-    return -1;
+  current_app_status_t *status = &inContext->appStatus;
+
+  mico_rtos_lock_mutex(&status->clients_mtx);
+  spp_log("Client fd: %d sent %u bytes, max lag %u, dropped %u", status->clients[client].fd,
+          status->clients[client].sent, status->clients[client].max_lag, status->clients[client].dropped);
+  status->clients[client].used = false;
+  mico_rtos_deinit_semaphore( &status->clients[client].data_sem );
+  mico_rtos_unlock_mutex(&status->clients_mtx);
+
+  mico_rtos_set_semaphore( &status->space_sem );
 }
 
-int socket_queue_delete(app_context_t * const inContext, mico_queue_t *queue)
+/* Send UART data to the client straight from the fan-out buffer. Returns kNoErr if the 
+   socket is still usable */
+OSStatus spp_client_send(app_context_t * const inContext, int client)
 {
-    int i;
-    socket_msg_t *msg;
-    int ret = -1;
-
-    mico_rtos_lock_mutex(&inContext->appStatus.queue_mtx);
-    // remove queue
-    for(i=0; i < MAX_QUEUE_NUM; i++) {
-        if (queue == inContext->appStatus.socket_out_queue[i]) {
-            inContext->appStatus.socket_out_queue[i] = NULL;
-            ret = 0;
-        }
+  current_app_status_t *status = &inContext->appStatus;
+  spp_client_t *p_client = &status->clients[client];
+  uint32_t offset, len;
+  int sent_len, opt_len, errno;
+  int part;
+
+  /* All data up to the flush point is sent now, the pending event is not needed */
+  mico_rtos_get_semaphore( &p_client->data_sem, 0 );
+
+  /* Data may wrap around the buffer end, it is sent in two parts */
+  for( part = 0; part < 2; part++ ){
+    mico_rtos_lock_mutex(&status->clients_mtx);
+    offset = p_client->cursor & FANOUT_MASK;
+    len = MIN( status->uart_fanout_flush - p_client->cursor, UART_FANOUT_BUFFER_LENGTH - offset );
+    p_client->sending = len;
+    mico_rtos_unlock_mutex(&status->clients_mtx);
+
+    if( len == 0 )
+      return kNoErr;
+
+    sent_len = write( p_client->fd, status->uart_fanout_buffer + offset, len );
+
+    mico_rtos_lock_mutex(&status->clients_mtx);
+    p_client->sending = 0;
+    if( sent_len > 0 ){
+      p_client->cursor += sent_len;
+      p_client->sent += sent_len;
     }
-    mico_rtos_unlock_mutex(&inContext->appStatus.queue_mtx);
-    // free queue buffer
-    while(kNoErr == mico_rtos_pop_from_queue( queue, &msg, 0)) {
-        socket_msg_free(msg);
+    mico_rtos_unlock_mutex(&status->clients_mtx);
+    mico_rtos_set_semaphore( &status->space_sem );
+
+    if( sent_len <= 0 ){
+      opt_len = sizeof(errno);
+      getsockopt(p_client->fd, SOL_SOCKET, SO_ERROR, &errno, &opt_len);
+      spp_log("write error, fd: %d, errno %d", p_client->fd, errno );
+      if( errno != ENOMEM )
+        return kConnectionErr;
+      break;
     }
+  }
+
+  /* Wake up the client again for the data left */
+  if( status->uart_fanout_flush != p_client->cursor )
+    mico_rtos_set_semaphore( &p_client->data_sem );
+  return kNoErr;
+}
 
-    // deinit queue
-    mico_rtos_deinit_queue(queue);
-    
-    return ret;
+#ifdef MICO_CLI_ENABLE
+static void spp_client_Command(char *pcWriteBuffer, int xWriteBufferLen, int argc, char **argv)
+{
+  current_app_status_t *status;
+  spp_client_t *client;
+  int i;
+
+  if( spp_context == NULL ) return;
+  status = &spp_context->appStatus;
+
+  cmd_printf("UART received %u bytes, fan-out buffer %d bytes\r\n", status->uart_fanout_tail, UART_FANOUT_BUFFER_LENGTH);
+  mico_rtos_lock_mutex(&status->clients_mtx);
+  for(i=0; i < MAX_CLIENT_NUM; i++) {
+    client = &status->clients[i];
+    if( client->used == false ) continue;
+    cmd_printf("Client %d fd: %d, sent %u, lag %u, max lag %u, dropped %u\r\n", i, client->fd, client->sent,
+               status->uart_fanout_tail - client->cursor, client->max_lag, client->dropped);
+  }
+  mico_rtos_unlock_mutex(&status->clients_mtx);
 }
 
+static void spp_coalesce_Command(char *pcWriteBuffer, int xWriteBufferLen, int argc, char **argv)
+{
+  current_app_status_t *status;
+  spp_coalesce_stats_t stats;
+  int i;
+
+  if( spp_context == NULL ) return;
+  status = &spp_context->appStatus;
+
+  mico_rtos_lock_mutex(&status->clients_mtx);
+  stats = status->coalesce_stats;
+  if( argc == 2 && strcmp( argv[1], "-c" ) == 0 )
+    memset( &status->coalesce_stats, 0x0, sizeof(spp_coalesce_stats_t) );
+  mico_rtos_unlock_mutex(&status->clients_mtx);
+
+  cmd_printf("Limits: %d bytes, %d ms\r\n", SPP_COALESCE_MAX_BYTES, SPP_COALESCE_MAX_LATENCY);
+  cmd_printf("UART reads %u, segments %u, saved %u\r\n", stats.uart_reads, stats.flushes, stats.uart_reads - stats.flushes);
+  cmd_printf("Sent on size %u, delimiter %u, latency %u\r\n", stats.on_size, stats.on_delimiter, stats.on_latency);
+  cmd_printf("Added latency:\r\n");
+  for(i=0; i < SPP_COALESCE_LATENCY_BUCKETS - 1; i++)
+    cmd_printf("  <= %3u ms: %u\r\n", spp_latency_bounds[i], stats.latency[i]);
+  cmd_printf("   > %3u ms: %u\r\n", spp_latency_bounds[i - 1], stats.latency[i]);
+}
+#endif
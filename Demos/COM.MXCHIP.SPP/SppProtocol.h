@@ -32,9 +32,12 @@ OSStatus sppUartCommandProcess(uint8_t *inBuf, int inLen, app_context_t * const
 
 
 void set_network_state(int state, int on);
-int socket_queue_create(app_context_t * const inContext, mico_queue_t *queue);
-int socket_queue_delete(app_context_t * const inContext, mico_queue_t *queue);
-void socket_msg_free(socket_msg_t*msg);
-void socket_msg_take(socket_msg_t*msg);
+uint8_t* sppUartBufferGet(app_context_t * const inContext, int *outLen);
+uint32_t sppUartFlushTimeout(app_context_t * const inContext);
+
+int spp_client_attach(app_context_t * const inContext, int fd);
+int spp_client_event_fd(app_context_t * const inContext, int client);
+OSStatus spp_client_send(app_context_t * const inContext, int client);
+void spp_client_detach(app_context_t * const inContext, int client);
 
 #endif
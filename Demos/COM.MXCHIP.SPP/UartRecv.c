@@ -25,52 +25,46 @@
 #define uart_recv_log(M, ...) custom_log("UART RECV", M, ##__VA_ARGS__)
 #define uart_recv_log_trace() custom_log_trace("UART RECV")
 
-static size_t _uart_get_one_packet(uint8_t* buf, int maxlen);
+static size_t _uart_get_one_packet(uint8_t* buf, int maxlen, uint32_t timeout);
 
 void uartRecv_thread(void *inContext)
 {
   uart_recv_log_trace();
   app_context_t *Context = inContext;
-  int recvlen;
+  int recvlen, bufferlen;
   uint8_t *inDataBuffer;
   
-  inDataBuffer = malloc(UART_ONE_PACKAGE_LENGTH);
-  require(inDataBuffer, exit);
-  
   while(1) {
-    recvlen = _uart_get_one_packet(inDataBuffer, UART_ONE_PACKAGE_LENGTH);
+    /* Receive UART data directly into the buffer shared by all TCP clients */
+    inDataBuffer = sppUartBufferGet(Context, &bufferlen);
+    /* Wait no longer than the coalesced data may be delayed */
+    recvlen = _uart_get_one_packet(inDataBuffer, bufferlen, sppUartFlushTimeout(Context));
     if (recvlen <= 0)
       continue; 
     sppUartCommandProcess(inDataBuffer, recvlen, Context);
   }
-  
-exit:
-  if(inDataBuffer) free(inDataBuffer);
-  mico_rtos_delete_thread(NULL);
 }
 
-/* Packet format: BB 00 CMD(2B) Status(2B) datalen(2B) data(x) checksum(2B)
-* copy to buf, return len = datalen+10
+/* Wait up to timeout for UART data, and return all data received so far
 */
-size_t _uart_get_one_packet(uint8_t* inBuf, int inBufLen)
+size_t _uart_get_one_packet(uint8_t* inBuf, int inBufLen, uint32_t timeout)
 {
   uart_recv_log_trace();
 
   int datalen;
   
-  while(1) {
-    if( MicoUartRecv( UART_FOR_APP, inBuf, inBufLen, UART_RECV_TIMEOUT) == kNoErr){
-      return inBufLen;
-    }
-   else{
-     datalen = MicoUartGetLengthInBuffer( UART_FOR_APP );
-     if(datalen){
-       MicoUartRecv(UART_FOR_APP, inBuf, datalen, UART_RECV_TIMEOUT);
-       return datalen;
-     }
-   }
+  datalen = MicoUartGetLengthInBuffer( UART_FOR_APP );
+  if( datalen == 0 ){
+    /* Sleep until the first byte arrives instead of polling an idle UART */
+    if( MicoUartRecv( UART_FOR_APP, inBuf, 1, timeout ) != kNoErr )
+      return 0;
+    datalen = MIN( (int)MicoUartGetLengthInBuffer( UART_FOR_APP ), inBufLen - 1 );
+    if( datalen )
+      MicoUartRecv( UART_FOR_APP, inBuf + 1, datalen, UART_RECV_TIMEOUT );
+    return datalen + 1;
   }
-  
-}
-
 
+  datalen = MIN( datalen, inBufLen );
+  MicoUartRecv( UART_FOR_APP, inBuf, datalen, UART_RECV_TIMEOUT );
+  return datalen;
+}
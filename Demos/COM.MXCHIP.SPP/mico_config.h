@@ -78,3 +78,8 @@
 #define MICO_CONFIG_SERVER_ENABLE 
 #define MICO_CONFIG_SERVER_PORT    8000
 
+/* Serve all config clients from one thread with select(), saves a thread stack
+ * for every connected client. */
+//#define MICO_CONFIG_SERVER_MULTIPLEX
+//#define MICO_CONFIG_SERVER_MAX_CLIENTS  5
+
@@ -205,6 +205,7 @@ OSStatus _LocalConfigRespondInComingMessage(int fd, ECS_HTTPHeader_t* inHeader,
   const char * json_str;
   uint8_t *httpResponse = NULL;
   size_t httpResponseLen = 0;
+  SocketIOVec_t httpVec[2];
   json_object* report = NULL;
   char err_msg[32] = {0};
   char *bonjour_txt_record = NULL;
@@ -230,10 +231,15 @@ OSStatus _LocalConfigRespondInComingMessage(int fd, ECS_HTTPHeader_t* inHeader,
       fogcloud_config_log("get device state success!");
       json_str = (char*)json_object_to_json_string(report);
       //config_log("json_str=%s", json_str);
-      err = ECS_CreateSimpleHTTPMessage( ECS_kMIMEType_JSON, (uint8_t*)json_str, strlen(json_str),
-                                        &httpResponse, &httpResponseLen );
+      err = ECS_CreateSimpleHTTPMessageNoCopy( ECS_kMIMEType_JSON, strlen(json_str),
+                                              &httpResponse, &httpResponseLen );
+      require_noerr( err, exit );
       require( httpResponse, exit );
-      err = SocketSend( fd, httpResponse, httpResponseLen );
+      httpVec[0].buf = httpResponse;
+      httpVec[0].len = httpResponseLen;
+      httpVec[1].buf = (const uint8_t *)json_str;
+      httpVec[1].len = strlen(json_str);
+      err = SocketSendv( fd, httpVec, 2 );
       SocketClose(&fd);
     }
     goto exit;
@@ -302,11 +308,15 @@ OSStatus _LocalConfigRespondInComingMessage(int fd, ECS_HTTPHeader_t* inHeader,
                              json_object_new_string(inContext->appConfig->fogcloudConfig.deviceId));
       json_str = (char*)json_object_to_json_string(report);
       //config_log("json_str=%s", json_str);
-      err = ECS_CreateSimpleHTTPMessage( ECS_kMIMEType_JSON, (uint8_t*)json_str, strlen(json_str),
-                                        &httpResponse, &httpResponseLen );
+      err = ECS_CreateSimpleHTTPMessageNoCopy( ECS_kMIMEType_JSON, strlen(json_str),
+                                              &httpResponse, &httpResponseLen );
       require_noerr( err, exit );
       require( httpResponse, exit );
-      err = SocketSend( fd, httpResponse, httpResponseLen );
+      httpVec[0].buf = httpResponse;
+      httpVec[0].len = httpResponseLen;
+      httpVec[1].buf = (const uint8_t *)json_str;
+      httpVec[1].len = strlen(json_str);
+      err = SocketSendv( fd, httpVec, 2 );
       SocketClose(&fd);
     }
     goto exit;
@@ -326,10 +336,15 @@ OSStatus _LocalConfigRespondInComingMessage(int fd, ECS_HTTPHeader_t* inHeader,
                              json_object_new_string(inContext->appConfig->fogcloudConfig.deviceId));
       json_str = (char*)json_object_to_json_string(report);
       //config_log("json_str=%s", json_str);
-      err = ECS_CreateSimpleHTTPMessage( ECS_kMIMEType_JSON, (uint8_t*)json_str, strlen(json_str),
-                                        &httpResponse, &httpResponseLen );
+      err = ECS_CreateSimpleHTTPMessageNoCopy( ECS_kMIMEType_JSON, strlen(json_str),
+                                              &httpResponse, &httpResponseLen );
+      require_noerr( err, exit );
       require( httpResponse, exit );
-      err = SocketSend( fd, httpResponse, httpResponseLen );
+      httpVec[0].buf = httpResponse;
+      httpVec[0].len = httpResponseLen;
+      httpVec[1].buf = (const uint8_t *)json_str;
+      httpVec[1].len = strlen(json_str);
+      err = SocketSendv( fd, httpVec, 2 );
       SocketClose(&fd);
     }
     goto exit;
@@ -309,6 +309,7 @@ OSStatus fogCloudDevFirmwareUpdate(app_context_t* const inContext,
   uint32_t updateStartAddress = 0;
   uint32_t readLength = 0;
   uint32_t i = 0, size = 0;
+  uint32_t rom_file_size = 0;
   uint32_t romStringLen = 0;
   
   // crc16
@@ -344,6 +345,17 @@ OSStatus fogCloudDevFirmwareUpdate(app_context_t* const inContext,
   inContext->appStatus.fogcloudStatus.isOTAInProgress = true;
   OTAWillStart(inContext);
   
+  //get rom data straight from an http file url, resumed if interrupted, md5 and crc16 are checked on the way
+  if(0 == strncmp(easyCloudContext.service_status.bin_file, "http://", strlen("http://"))){
+    err = http_ota(easyCloudContext.service_status.bin_file, easyCloudContext.service_status.bin_md5,
+                   &rom_file_size, &ota_crc);
+    require_noerr_action( err, exit_with_error, 
+                         cloud_if_log("ERROR: http_ota failed! err=%d", err) );
+    easyCloudContext.service_status.bin_file_size = rom_file_size;
+    cloud_if_log("OTA data in flash md5 check success, crc16=%d.", ota_crc);
+    goto update_rom_version;
+  }
+  
   //get rom data
   err = FogCloudGetRomData(&easyCloudContext, ota_flash_params);
   require_noerr_action( err, exit_with_error, 
@@ -405,6 +417,7 @@ OSStatus fogCloudDevFirmwareUpdate(app_context_t* const inContext,
   }
   //----------------------------------------------------------------------------
   
+update_rom_version:
   //update rom version in flash
   cloud_if_log("fogCloudDevFirmwareUpdate: return rom version && file size.");
   mico_rtos_lock_mutex(&inContext->mico_context->flashContentInRam_mutex);
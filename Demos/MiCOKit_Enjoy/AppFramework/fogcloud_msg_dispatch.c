@@ -38,6 +38,62 @@ typedef struct _mico_notify_thread_data_t{
 
 static mico_notify_thread_data_t g_notify_thread_data;
 
+// notify in TLV, set by the last request
+static bool g_notify_tlv = false;
+
+
+// read or write properties in TLV, values are sent to the request sub-topic,
+// err codes and status to "tlv/err"
+static OSStatus _fogcloud_msg_dispatch_tlv(app_context_t* context, struct mico_service_t service_table[],
+                                           mico_fogcloud_msg_t *cloud_msg, const char *response_sub_topic,
+                                           bool is_write, int* ret_status)
+{
+  OSStatus err = kUnknownErr;
+  OSStatus send_err = kNoErr;
+  uint8_t *response_buf = NULL;
+  mico_prop_tlv_buf_t response;
+  mico_prop_tlv_buf_t response_err;
+  
+  response_buf = (uint8_t*)malloc(2 * MICO_PROP_TLV_BUF_SIZE);
+  require_action( response_buf, exit, err = kNoMemoryErr );
+  response.buf = response_buf;
+  response.size = MICO_PROP_TLV_BUF_SIZE;
+  response.len = 0;
+  response_err.buf = response_buf + MICO_PROP_TLV_BUF_SIZE;
+  response_err.size = MICO_PROP_TLV_BUF_SIZE;
+  response_err.len = 0;
+  
+  if(is_write){
+    err = mico_write_properties_tlv(service_table, cloud_msg->data, cloud_msg->data_len,
+                                    &response, &response_err);
+  }
+  else{
+    err = mico_read_properties_tlv(service_table, cloud_msg->data, cloud_msg->data_len,
+                                   &response, &response_err);
+  }
+  
+  // send read or write ok value
+  if(0 != response.len){
+    send_err = MiCOFogCloudMsgSend(context, response_sub_topic, response.buf, response.len);
+  }
+  // send err code
+  if(0 != response_err.len){
+    send_err = MiCOFogCloudMsgSend(context, FOGCLOUD_MSG_TOPIC_OUT_TLV_ERROR, 
+                                   response_err.buf, response_err.len);
+  }
+  require_noerr( err, exit );
+  err = send_err;
+  
+  // return process result
+  *ret_status = is_write ? MSG_PROP_WROTE : MSG_PROP_READ;
+  
+exit:
+  if(NULL != response_buf){
+    free(response_buf);
+  }
+  return err;
+}
+
 
 // handle cloud msg here, for example: send to USART or echo to cloud
 OSStatus mico_fogcloud_msg_dispatch(app_context_t* context, struct mico_service_t  service_table[],
@@ -90,6 +146,7 @@ OSStatus mico_fogcloud_msg_dispatch(app_context_t* context, struct mico_service_
     // from /read
     msg_dispatch_log("Recv read cmd: %.*s, data[%d]: %s",
                      recv_sub_topic_len, recv_sub_topic_ptr, cloud_msg->data_len, cloud_msg->data);
+    g_notify_tlv = false;
    
     // parse input json data
     recv_json_object = json_tokener_parse((const char*)(cloud_msg->data));
@@ -151,10 +208,12 @@ OSStatus mico_fogcloud_msg_dispatch(app_context_t* context, struct mico_service_
     msg_dispatch_log("Recv write cmd: %.*s, data[%d]: %s",
                      recv_sub_topic_len, recv_sub_topic_ptr,
                      cloud_msg->data_len, cloud_msg->data);
+    g_notify_tlv = false;
     
-    // parse input json data
-    recv_json_object = json_tokener_parse((const char*)(cloud_msg->data));
-    if (NULL == recv_json_object){  // input json format error, response to sub-topic "err" with error code
+    // write properties as the json data is parsed, return "write/err" sub-obj in response_json_obj
+    err = mico_write_properties_str(service_table, (const char*)(cloud_msg->data), cloud_msg->data_len,
+                                    &response_json_obj);
+    if (kFormatErr == err){  // input json format error, response to sub-topic "err" with error code
       response_err_obj = json_object_new_object();
       require( response_err_obj, exit );
       json_object_object_add(response_err_obj, MICO_PROP_KEY_RESP_STATUS, json_object_new_int(MICO_PROP_CODE_DATA_FORMAT_ERR));
@@ -164,10 +223,6 @@ OSStatus mico_fogcloud_msg_dispatch(app_context_t* context, struct mico_service_
                                 (unsigned char*)response_json_string, strlen(response_json_string));
       goto exit;
     }
-    //msg_dispatch_log("Recv write object=%s", json_object_to_json_string(recv_json_object));
-        
-    // write properties, return "write/err" sub-obj in response_json_obj
-    response_json_obj = mico_write_properties(service_table, recv_json_object);
     
     // send reponse for write data
     if(NULL == response_json_obj){  // write failed
@@ -197,6 +252,18 @@ OSStatus mico_fogcloud_msg_dispatch(app_context_t* context, struct mico_service_
       *ret_status = MSG_PROP_WROTE;
     }
   }
+  else if( (0 == strncmp((char*)FOGCLOUD_MSG_TOPIC_IN_TLV_READ, recv_sub_topic_ptr, strlen((char*)FOGCLOUD_MSG_TOPIC_IN_TLV_READ))) ||
+           (0 == strncmp((char*)FOGCLOUD_MSG_TOPIC_IN_TLV_WRITE, recv_sub_topic_ptr, strlen((char*)FOGCLOUD_MSG_TOPIC_IN_TLV_WRITE))) ){
+    // from /tlv/read or /tlv/write
+    msg_dispatch_log("Recv TLV cmd: %.*s, data[%d]",
+                     recv_sub_topic_len, recv_sub_topic_ptr, cloud_msg->data_len);
+    g_notify_tlv = true;
+    
+    err = _fogcloud_msg_dispatch_tlv(context, service_table, cloud_msg, response_sub_topic,
+                                     (0 == strncmp((char*)FOGCLOUD_MSG_TOPIC_IN_TLV_WRITE, recv_sub_topic_ptr,
+                                                   strlen((char*)FOGCLOUD_MSG_TOPIC_IN_TLV_WRITE))),
+                                     ret_status);
+  }
   else{
     // unknown topic, ignore msg
     err = kUnsupportedErr;
@@ -222,6 +289,38 @@ exit:
 }
 
 
+OSStatus  _properties_notify_tlv(app_context_t * const inContext, struct mico_service_t service_table[])
+{
+  OSStatus err = kUnknownErr;
+  mico_prop_tlv_buf_t notify = {NULL, 0, 0};
+  
+  require_action(inContext, exit, err = kParamErr);
+  
+  notify.buf = (uint8_t*)malloc(MICO_PROP_TLV_BUF_SIZE);
+  require_action(notify.buf, exit, err = kNoMemoryErr);
+  notify.size = MICO_PROP_TLV_BUF_SIZE;
+  notify.len = 0;
+  
+  // properties update check
+  err = mico_properties_notify_check_tlv(inContext, service_table, &notify);
+  require_noerr(err, exit);
+  
+  // send notify message to cloud
+  if(0 != notify.len){
+    // notify to topic: <device_id>/out/tlv/read
+    err = MiCOFogCloudMsgSend(inContext, FOGCLOUD_MSG_TOPIC_OUT_TLV_NOTIFY, notify.buf, notify.len);
+  }
+  
+exit:
+  if(kNoErr != err){
+    msg_dispatch_log("ERROR: _properties_notify_tlv error, err = %d", err);
+  }
+  if(NULL != notify.buf){
+    free(notify.buf);
+  }
+  return err;
+}
+
 OSStatus  _properties_notify(app_context_t * const inContext, struct mico_service_t service_table[])
 {
   OSStatus err = kUnknownErr;
@@ -275,7 +374,12 @@ void notify_thread(void* arg)
   
   while(1){
     if(p_notify_thread_data->context->appStatus.fogcloudStatus.isCloudConnected){
-      err = _properties_notify(p_notify_thread_data->context, p_notify_thread_data->p_service_table);
+      if(g_notify_tlv){
+        err = _properties_notify_tlv(p_notify_thread_data->context, p_notify_thread_data->p_service_table);
+      }
+      else{
+        err = _properties_notify(p_notify_thread_data->context, p_notify_thread_data->p_service_table);
+      }
       if(kNoErr != err){
         msg_dispatch_log("ERROR: properties notify failed! err = %d", err);
       }
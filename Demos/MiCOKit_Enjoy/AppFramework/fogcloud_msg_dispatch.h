@@ -40,6 +40,14 @@
 #define FOGCLOUD_MSG_TOPIC_OUT_NOTIFY    "read"
 #define FOGCLOUD_MSG_TOPIC_OUT_ERROR     "err"
 
+// TLV messages (see properties.c), notify is sent in TLV after a TLV request,
+// and in json again after a json request
+#define FOGCLOUD_MSG_TOPIC_IN_TLV_READ   "/tlv/read"
+#define FOGCLOUD_MSG_TOPIC_IN_TLV_WRITE  "/tlv/write"
+
+#define FOGCLOUD_MSG_TOPIC_OUT_TLV_NOTIFY  "tlv/read"
+#define FOGCLOUD_MSG_TOPIC_OUT_TLV_ERROR   "tlv/err"
+
 // msg handle result
 #define MSG_PROP_UNPROCESSED             0
 #define MSG_PROP_READ                    1
@@ -0,0 +1,568 @@
+/**
+******************************************************************************
+* @file    properties-bench.c
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   TLV property read, write and notify, tested against the expected
+*          items, and their bytes and time next to the JSON messages.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+/* Built on the host, MICO/system/host holds the stub platform headers, MICOKIT_3288 picks the product of
+ * User/user_config.h:
+ *
+ *   D=Demos/MiCOKit_Enjoy
+ *   U=libraries/utilities
+ *   J=$U/json_c
+ *   cc -O2 -DDEBUG=0 -DPROPERTIES_BENCH_MAIN -DMICOKIT_3288 -IMICO/system/host -Iinclude -IMICO/system -Iinclude/FogCloud \
+ *      -I$D/AppFramework -I$D/User -I$U -I$J $D/AppFramework/properties-bench.c $D/AppFramework/properties.c \
+ *      $U/TLVUtils.c $U/StringUtils.c $J/arraylist.c $J/debug.c $J/json_arena.c $J/json_object.c $J/json_sax.c \
+ *      $J/json_tokener.c $J/json_util.c $J/linkhash.c $J/printbuf.c -o properties-bench && ./properties-bench
+ *
+ * The bytes are the payload of one MQTT message: the JSON text as json_object_to_json_string() makes it, or the TLV
+ * items. A read or write answers with two messages, the values and the err object, both are counted. Each notify
+ * has light and temperature, or infrared and humidity changed. Light holds a 2 bytes value, the others 1 byte values,
+ * so the TLV notify is 7 or 6 bytes.
+ *
+ * On the target properties_bench() can be called from a test command with the properties of the application, results
+ * are then from mico_get_time().
+ */
+
+#include "mico.h"
+#include "MiCOAppDefine.h"
+#include "json_c/json.h"
+#include "TLVUtils.h"
+#include "properties.h"
+
+#include <stdio.h>
+
+#if( defined( PROPERTIES_BENCH_MAIN ) )
+    #include <time.h>
+    static uint64_t properties_bench_ticks( void )
+    {
+        struct timespec     ts;
+
+        clock_gettime( CLOCK_MONOTONIC, &ts );
+        return( ( (uint64_t) ts.tv_sec * 1000000000 ) + ts.tv_nsec );
+    }
+    #define kProp_BenchScale            1
+#else
+    #define properties_bench_ticks()    ( (uint64_t) mico_get_time() )
+    #define kProp_BenchScale            1000000
+#endif
+
+#define kProp_BenchLoops            20000
+
+// An item with a 4 bytes little endian code
+#define kProp_BenchCode( ID, CODE ) ( ID ), 4, (uint8_t)( (uint32_t)( CODE ) ), (uint8_t)( (uint32_t)( CODE ) >> 8 ), \
+                                    (uint8_t)( (uint32_t)( CODE ) >> 16 ), (uint8_t)( (uint32_t)( CODE ) >> 24 )
+
+// Sensors 0 to 4: light, ir, off, t and h
+static int                  gProp_BenchSensors[ 5 ];
+static int                  gProp_BenchInts[ 8 ];
+static float                gProp_BenchFloat;
+static bool                 gProp_BenchBool;
+static char                 gProp_BenchStrings[ 2 ][ 32 ];
+static uint32_t             gProp_BenchLens[ 16 ];
+static bool                 gProp_BenchEventOn = true;
+static bool                 gProp_BenchEventOff = false;
+static uint8_t              gProp_BenchOut[ MICO_PROP_TLV_BUF_SIZE ];
+static uint8_t              gProp_BenchErr[ MICO_PROP_TLV_BUF_SIZE ];
+static mico_prop_tlv_buf_t  gProp_BenchOutBuf = { gProp_BenchOut, sizeof( gProp_BenchOut ), 0 };
+static mico_prop_tlv_buf_t  gProp_BenchErrBuf = { gProp_BenchErr, sizeof( gProp_BenchErr ), 0 };
+static app_context_t        gProp_BenchContext;
+
+static int properties_bench_set( struct mico_prop_t *prop, void *arg, void *val, uint32_t val_len )
+{
+    return( 0 );
+}
+
+static int properties_bench_set_fail( struct mico_prop_t *prop, void *arg, void *val, uint32_t val_len )
+{
+    return( -1 );
+}
+
+static int properties_bench_get( struct mico_prop_t *prop, void *arg, void *val, uint32_t *val_len )
+{
+    *( (int *) val ) = gProp_BenchSensors[ (intptr_t) arg ];
+    *val_len = sizeof( int );
+    return( 0 );
+}
+
+static int properties_bench_check( struct mico_prop_t *prop, void *arg, void *val, uint32_t *val_len )
+{
+    int     value = gProp_BenchSensors[ (intptr_t) arg ];
+
+    if( value == *( (int *) prop->value ) ) return( 0 );
+    *( (int *) val ) = value;
+    *val_len = sizeof( int );
+    return( 1 );
+}
+
+#define kProp_BenchRW               ( MICO_PROP_PERMS_RO | MICO_PROP_PERMS_WO )
+#define kProp_BenchRE               ( MICO_PROP_PERMS_RO | MICO_PROP_PERMS_EV )
+
+#define kProp_BenchString( TYPE, I, PERMS ) \
+    { .type = TYPE, .value = gProp_BenchStrings[ I ], .value_len = &gProp_BenchLens[ I ], \
+      .format = MICO_PROP_TYPE_STRING, .perms = PERMS, .set = properties_bench_set, .maxStringLen = 31 }
+#define kProp_BenchSensor( TYPE, I, PERMS, CHECK, EVENT ) \
+    { .type = TYPE, .value = &gProp_BenchInts[ I ], .value_len = &gProp_BenchLens[ 8 + I ], \
+      .format = MICO_PROP_TYPE_INT, .perms = PERMS, .get = properties_bench_get, .notify_check = CHECK, \
+      .arg = (void *)(intptr_t)( I ), .event = EVENT }
+
+// iid:  1 dev_info: 2 name, 3 manufacturer
+//       4 rgb_led:  5 switch, 6 hue, 7 saturation
+//       8 adc:      9 light, 10 infrared, 11 off
+//      12 th:      13 temperature, 14 humidity, 15 read only
+
+static struct mico_service_t    gProp_BenchServices[] =
+{
+    { .type = "dev_info", .properties = {
+        kProp_BenchString( "name", 0, kProp_BenchRW ),
+        kProp_BenchString( "manufacturer", 1, MICO_PROP_PERMS_RO ),
+        { .type = NULL } } },
+    { .type = "rgb_led", .properties = {
+        { .type = "switch", .value = &gProp_BenchBool, .value_len = &gProp_BenchLens[ 2 ], .format = MICO_PROP_TYPE_BOOL,
+          .perms = kProp_BenchRW, .set = properties_bench_set },
+        { .type = "hue", .value = &gProp_BenchInts[ 5 ], .value_len = &gProp_BenchLens[ 3 ], .format = MICO_PROP_TYPE_INT,
+          .perms = kProp_BenchRW, .set = properties_bench_set },
+        { .type = "saturation", .value = &gProp_BenchFloat, .value_len = &gProp_BenchLens[ 4 ], .format = MICO_PROP_TYPE_FLOAT,
+          .perms = kProp_BenchRW, .set = properties_bench_set_fail },
+        { .type = NULL } } },
+    { .type = "adc", .properties = {
+        kProp_BenchSensor( "light", 0, kProp_BenchRE, properties_bench_check, &gProp_BenchEventOn ),
+        kProp_BenchSensor( "infrared", 1, kProp_BenchRE, properties_bench_check, &gProp_BenchEventOn ),
+        kProp_BenchSensor( "off", 2, kProp_BenchRE, properties_bench_check, &gProp_BenchEventOff ),
+        { .type = NULL } } },
+    { .type = "th", .properties = {
+        kProp_BenchSensor( "temperature", 3, kProp_BenchRE, properties_bench_check, &gProp_BenchEventOn ),
+        kProp_BenchSensor( "humidity", 4, kProp_BenchRE, properties_bench_check, &gProp_BenchEventOn ),
+        { .type = "read only", .value = &gProp_BenchInts[ 6 ], .value_len = &gProp_BenchLens[ 5 ],
+          .format = MICO_PROP_TYPE_INT, .perms = MICO_PROP_PERMS_RO },
+        { .type = NULL } } },
+    { .type = NULL }
+};
+
+#if( defined( PROPERTIES_BENCH_MAIN ) )
+// One thread on the host, the dirty bits need no lock
+
+OSStatus mico_rtos_init_mutex( mico_mutex_t *mutex )
+{
+    *mutex = (mico_mutex_t) &gProp_BenchContext;
+    return( kNoErr );
+}
+
+OSStatus mico_rtos_lock_mutex( mico_mutex_t *mutex )
+{
+    return( kNoErr );
+}
+
+OSStatus mico_rtos_unlock_mutex( mico_mutex_t *mutex )
+{
+    return( kNoErr );
+}
+#endif
+
+//===========================================================================================================================
+//  properties_bench_expect
+//===========================================================================================================================
+
+static OSStatus properties_bench_expect( const mico_prop_tlv_buf_t *inBuf, const uint8_t *inItems, size_t inLen )
+{
+    OSStatus        err;
+
+    require_action( inBuf->len == inLen, exit, err = kSizeErr );
+    require_action( memcmp( inBuf->buf, inItems, inLen ) == 0, exit, err = kMismatchErr );
+    err = kNoErr;
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  properties_tlv_utils_test
+//===========================================================================================================================
+
+static OSStatus properties_tlv_utils_test( void )
+{
+    OSStatus            err;
+    static uint8_t      value[ 600 ], items[ 1000 ], back[ 600 ];
+    uint8_t *           ptr = items;
+    const uint8_t *     next;
+    uint8_t             id;
+    size_t              len;
+    int                 i;
+
+    for( i = 0; i < 600; ++i ) value[ i ] = (uint8_t)( i * 7 );
+
+    // 600 bytes take 3 items: 255, 255 and 90 bytes, a 255 bytes value an empty item after it
+
+    err = TLVAdd( &ptr, items + sizeof( items ), 9, value, 600 );
+    require_noerr( err, exit );
+    require_action( ptr == items + 606, exit, err = kSizeErr );
+    err = TLVAdd( &ptr, items + sizeof( items ), 10, value, 255 );
+    require_noerr( err, exit );
+    require_action( ptr == items + 606 + 259, exit, err = kSizeErr );
+    err = TLVAdd( &ptr, items + sizeof( items ), 11, value, 0 );
+    require_noerr( err, exit );
+
+    // The capacity is checked before anything is written, a length that would wrap included
+
+    ptr = back;
+    err = TLVAdd( &ptr, back + 258, 9, value, 255 );
+    require_action( err == kNoSpaceErr && ptr == back, exit, err = kResponseErr );
+    err = TLVAdd( &ptr, back + 259, 9, value, 255 );
+    require_action( err == kNoErr && ptr == back + 259, exit, err = kResponseErr );
+    ptr = back;
+    err = TLVAdd( &ptr, back + sizeof( back ), 9, value, ( ( (size_t) -1 ) / 257 ) * 255 + 9 );   // 10 bytes with the headers
+    require_action( err == kNoSpaceErr && ptr == back, exit, err = kResponseErr );
+
+    // The items are joined back, into a buffer as long as the value only
+
+    err = TLVGetNextJoined( items, items + 867, &id, NULL, 0, &len, &next );
+    require_noerr( err, exit );
+    require_action( id == 9 && len == 600 && next == items + 606, exit, err = kMismatchErr );
+    err = TLVGetNextJoined( items, items + 867, &id, back, 599, &len, &next );
+    require_action( err == kNoSpaceErr, exit, err = kResponseErr );
+    err = TLVGetNextJoined( items, items + 867, &id, back, 600, &len, &next );
+    require_noerr( err, exit );
+    require_action( memcmp( back, value, 600 ) == 0, exit, err = kMismatchErr );
+    err = TLVGetNextJoined( next, items + 867, &id, back, 255, &len, &next );
+    require_noerr( err, exit );
+    require_action( id == 10 && len == 255 && next == items + 867 - 2, exit, err = kMismatchErr );
+    err = TLVGetNextJoined( next, items + 867, &id, back, 0, &len, &next );
+    require_action( err == kNoErr && id == 11 && len == 0, exit, err = kMismatchErr );
+    err = TLVGetNextJoined( next, items + 867, &id, NULL, 0, &len, &next );
+    require_action( err == kNotFoundErr, exit, err = kResponseErr );
+    err = TLVGetNextJoined( items, items + 300, &id, NULL, 0, &len, &next );
+    require_action( err == kUnderrunErr, exit, err = kResponseErr );
+    err = kNoErr;
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  properties_read_test
+//===========================================================================================================================
+
+static OSStatus properties_read_test( void )
+{
+    OSStatus                err;
+    static const uint8_t    kService[]      = { 1, 0 };
+    static const uint8_t    kNames[]        = { 2, 3, 'd', 'e', 'v', 3, 6, 'm', 'x', 'c', 'h', 'i', 'p' };
+    static const uint8_t    kMixed[]        = { 9, 0, 13, 0, 99, 0, 0, 0, 11, 0 };
+    static const uint8_t    kMixedValues[]  = { 9, 4, 0xA0, 0x86, 0x01, 0x00, 13, 2, 0xD4, 0xFE, 11, 1, 0 };
+    static const uint8_t    kMixedErr[]     = { kProp_BenchCode( 99, MICO_PROP_CODE_NOT_FOUND ),
+                                                kProp_BenchCode( 0, MICO_PROP_CODE_NOT_FOUND ),
+                                                kProp_BenchCode( 0, MICO_PROP_CODE_READ_PARTIAL_FAILED ) };
+    static const uint8_t    kSuccess[]      = { kProp_BenchCode( 0, MICO_PROP_CODE_READ_SUCCESS ) };
+    static const uint8_t    kFormat[]       = { kProp_BenchCode( 0, MICO_PROP_CODE_DATA_FORMAT_ERR ) };
+    static const uint8_t    kMeta[]         = { kProp_BenchCode( 0, MICO_PROP_CODE_NOT_SUPPORTED ) };
+
+    // A service reads all of its properties
+
+    err = mico_read_properties_tlv( gProp_BenchServices, kService, sizeof( kService ), &gProp_BenchOutBuf, &gProp_BenchErrBuf );
+    require_noerr( err, exit );
+    err = properties_bench_expect( &gProp_BenchOutBuf, kNames, sizeof( kNames ) );
+    require_noerr( err, exit );
+    err = properties_bench_expect( &gProp_BenchErrBuf, kSuccess, sizeof( kSuccess ) );
+    require_noerr( err, exit );
+
+    // Values take the shortest int, a missing iid gets its code
+
+    gProp_BenchSensors[ 0 ] = 100000;
+    gProp_BenchSensors[ 3 ] = -300;
+    err = mico_read_properties_tlv( gProp_BenchServices, kMixed, sizeof( kMixed ), &gProp_BenchOutBuf, &gProp_BenchErrBuf );
+    require_noerr( err, exit );
+    err = properties_bench_expect( &gProp_BenchOutBuf, kMixedValues, sizeof( kMixedValues ) );
+    require_noerr( err, exit );
+    err = properties_bench_expect( &gProp_BenchErrBuf, kMixedErr, sizeof( kMixedErr ) );
+    require_noerr( err, exit );
+
+    // A truncated request reads nothing, an empty one asks for the meta data table, which is JSON only
+
+    err = mico_read_properties_tlv( gProp_BenchServices, kMixed, 3, &gProp_BenchOutBuf, &gProp_BenchErrBuf );
+    require_action( err == kFormatErr && gProp_BenchOutBuf.len == 0, exit, err = kResponseErr );
+    err = properties_bench_expect( &gProp_BenchErrBuf, kFormat, sizeof( kFormat ) );
+    require_noerr( err, exit );
+    err = mico_read_properties_tlv( gProp_BenchServices, kMixed, 0, &gProp_BenchOutBuf, &gProp_BenchErrBuf );
+    require_action( err == kNoErr && gProp_BenchOutBuf.len == 0, exit, err = kResponseErr );
+    err = properties_bench_expect( &gProp_BenchErrBuf, kMeta, sizeof( kMeta ) );
+    require_noerr( err, exit );
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  properties_write_test
+//===========================================================================================================================
+
+static OSStatus properties_write_test( void )
+{
+    OSStatus                err;
+    static const uint8_t    kWrite[]        = { 2, 7, 'n', 'e', 'w', 'n', 'a', 'm', 'e', 5, 1, 1, 6, 1, 0xFE,
+                                                7, 4, 0x00, 0x00, 0xC0, 0x3F };
+    static const uint8_t    kWritten[]      = { 2, 7, 'n', 'e', 'w', 'n', 'a', 'm', 'e', 5, 1, 1, 6, 1, 0xFE };
+    static const uint8_t    kWrittenErr[]   = { kProp_BenchCode( 7, MICO_PROP_CODE_WRITE_FAILED ),
+                                                kProp_BenchCode( 0, MICO_PROP_CODE_WRITE_PARTIAL_FAILED ) };
+    static const uint8_t    kBad[]          = { 6, 3, 1, 2, 3, 3, 1, 'x', 15, 1, 1, 99, 1, 1, 6, 2, 0x00, 0x80 };
+    static const uint8_t    kBadWritten[]   = { 6, 2, 0x00, 0x80 };
+    static const uint8_t    kBadErr[]       = { kProp_BenchCode( 6, MICO_PROP_CODE_DATA_FORMAT_ERR ),
+                                                kProp_BenchCode( 3, MICO_PROP_CODE_NOT_WRITABLE ),
+                                                kProp_BenchCode( 15, MICO_PROP_CODE_NOT_WRITABLE ),
+                                                kProp_BenchCode( 99, MICO_PROP_CODE_NOT_FOUND ),
+                                                kProp_BenchCode( 0, MICO_PROP_CODE_WRITE_PARTIAL_FAILED ) };
+    static const uint8_t    kLong[]         = { 6, 4, 0x78, 0x56, 0x34, 0x12 };
+
+    // Written values are sent back, a failed set gets its code
+
+    err = mico_write_properties_tlv( gProp_BenchServices, kWrite, sizeof( kWrite ), &gProp_BenchOutBuf, &gProp_BenchErrBuf );
+    require_noerr( err, exit );
+    err = properties_bench_expect( &gProp_BenchOutBuf, kWritten, sizeof( kWritten ) );
+    require_noerr( err, exit );
+    err = properties_bench_expect( &gProp_BenchErrBuf, kWrittenErr, sizeof( kWrittenErr ) );
+    require_noerr( err, exit );
+    require_action( strcmp( gProp_BenchStrings[ 0 ], "newname" ) == 0 && gProp_BenchLens[ 0 ] == 7, exit, err = kMismatchErr );
+    require_action( gProp_BenchBool && gProp_BenchInts[ 5 ] == -2, exit, err = kMismatchErr );
+
+    // A 3 bytes int, read only and missing properties are refused, the 2 bytes int is sign extended
+
+    err = mico_write_properties_tlv( gProp_BenchServices, kBad, sizeof( kBad ), &gProp_BenchOutBuf, &gProp_BenchErrBuf );
+    require_noerr( err, exit );
+    err = properties_bench_expect( &gProp_BenchOutBuf, kBadWritten, sizeof( kBadWritten ) );
+    require_noerr( err, exit );
+    err = properties_bench_expect( &gProp_BenchErrBuf, kBadErr, sizeof( kBadErr ) );
+    require_noerr( err, exit );
+    require_action( gProp_BenchInts[ 5 ] == -32768, exit, err = kMismatchErr );
+
+    err = mico_write_properties_tlv( gProp_BenchServices, kLong, sizeof( kLong ), &gProp_BenchOutBuf, &gProp_BenchErrBuf );
+    require_noerr( err, exit );
+    require_action( gProp_BenchInts[ 5 ] == 0x12345678, exit, err = kMismatchErr );
+
+    // A truncated request writes nothing
+
+    err = mico_write_properties_tlv( gProp_BenchServices, kWrite, 5, &gProp_BenchOutBuf, &gProp_BenchErrBuf );
+    require_action( err == kFormatErr && gProp_BenchOutBuf.len == 0, exit, err = kResponseErr );
+    require_action( gProp_BenchInts[ 5 ] == 0x12345678, exit, err = kMismatchErr );
+    err = kNoErr;
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  properties_notify_test
+//===========================================================================================================================
+
+static OSStatus properties_notify_test( void )
+{
+    OSStatus                err;
+    static const uint8_t    kChanged[]  = { 10, 1, 7, 14, 1, 7 };
+    static const uint8_t    kFirst[]    = { 10, 1, 14 };
+    static const uint8_t    kRest[]     = { 14, 1, 14 };
+    uint8_t                 small[ 4 ];
+    mico_prop_tlv_buf_t     notify      = { small, sizeof( small ), 0 };
+
+    // Nothing changed since the last check, then the properties changed in iid order, not the one with events off
+
+    err = mico_properties_notify_check_tlv( &gProp_BenchContext, gProp_BenchServices, &gProp_BenchOutBuf );
+    require_noerr( err, exit );
+    err = mico_properties_notify_check_tlv( &gProp_BenchContext, gProp_BenchServices, &gProp_BenchOutBuf );
+    require_noerr( err, exit );
+    require_action( gProp_BenchOutBuf.len == 0, exit, err = kSizeErr );
+
+    gProp_BenchSensors[ 1 ] = 7;
+    gProp_BenchSensors[ 2 ] = 7;
+    gProp_BenchSensors[ 4 ] = 7;
+    err = mico_properties_notify_check_tlv( &gProp_BenchContext, gProp_BenchServices, &gProp_BenchOutBuf );
+    require_noerr( err, exit );
+    err = properties_bench_expect( &gProp_BenchOutBuf, kChanged, sizeof( kChanged ) );
+    require_noerr( err, exit );
+
+    // A property that does not fit is sent by the next check
+
+    gProp_BenchSensors[ 1 ] = 14;
+    gProp_BenchSensors[ 4 ] = 14;
+    err = mico_properties_notify_check_tlv( &gProp_BenchContext, gProp_BenchServices, &notify );
+    require_noerr( err, exit );
+    err = properties_bench_expect( &notify, kFirst, sizeof( kFirst ) );
+    require_noerr( err, exit );
+    err = mico_properties_notify_check_tlv( &gProp_BenchContext, gProp_BenchServices, &gProp_BenchOutBuf );
+    require_noerr( err, exit );
+    err = properties_bench_expect( &gProp_BenchOutBuf, kRest, sizeof( kRest ) );
+    require_noerr( err, exit );
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  properties_bench_report
+//===========================================================================================================================
+
+static void properties_bench_report( const char *inMode, size_t inJsonBytes, uint64_t inJsonTicks, size_t inTlvBytes,
+                                     uint64_t inTlvTicks )
+{
+    printf( "%-28s json %6.1f bytes %9.0f ns, tlv %6.1f bytes %9.0f ns\n", inMode,
+        (double) inJsonBytes / kProp_BenchLoops, ( (double) inJsonTicks * kProp_BenchScale ) / kProp_BenchLoops,
+        (double) inTlvBytes / kProp_BenchLoops, ( (double) inTlvTicks * kProp_BenchScale ) / kProp_BenchLoops );
+}
+
+// The bytes of the values and err objects of a JSON answer
+
+static size_t properties_bench_json_bytes( json_object *inAnswer, const char *inKey )
+{
+    return( strlen( json_object_to_json_string( json_object_object_get( inAnswer, inKey ) ) ) +
+            strlen( json_object_to_json_string( json_object_object_get( inAnswer, MICO_PROP_KEY_RESP_ERROR ) ) ) );
+}
+
+//===========================================================================================================================
+//  properties_bench
+//===========================================================================================================================
+
+OSStatus    properties_bench( int print )
+{
+    OSStatus                err;
+    static const char       kJsonRead[]     = "{\"1\":1,\"4\":4,\"8\":8,\"12\":12}";
+    static const uint8_t    kTlvRead[]      = { 1, 0, 4, 0, 8, 0, 12, 0 };
+    static const char       kJsonWrite[]    = "{\"5\":true,\"6\":120}";
+    static const uint8_t    kTlvWrite[]     = { 5, 1, 1, 6, 1, 120 };
+    json_object *           request         = NULL;
+    json_object *           answer;
+    uint64_t                t, jsonTicks;
+    size_t                  jsonBytes, tlvBytes;
+    int                     i;
+
+    strcpy( gProp_BenchStrings[ 0 ], "dev" );
+    strcpy( gProp_BenchStrings[ 1 ], "mxchip" );
+    err = mico_properties_init( gProp_BenchServices );
+    require_noerr( err, exit );
+
+    err = properties_tlv_utils_test();
+    require_noerr( err, exit );
+    err = properties_read_test();
+    require_noerr( err, exit );
+    err = properties_write_test();
+    require_noerr( err, exit );
+    err = properties_notify_test();
+    require_noerr( err, exit );
+    if( !print ) goto exit;
+
+    // Notify of light and temperature, then of infrared and humidity
+
+    gProp_BenchSensors[ 0 ] = 312;
+    gProp_BenchSensors[ 1 ] = 27;
+    gProp_BenchSensors[ 3 ] = 25;
+    gProp_BenchSensors[ 4 ] = 61;
+    mico_properties_notify_check_tlv( &gProp_BenchContext, gProp_BenchServices, &gProp_BenchOutBuf );
+
+    jsonBytes = 0;
+    t = properties_bench_ticks();
+    for( i = 0; i < kProp_BenchLoops; ++i )
+    {
+        gProp_BenchSensors[ i & 1 ] ^= 1;
+        gProp_BenchSensors[ 3 + ( i & 1 ) ] ^= 1;
+        answer = json_object_new_object();
+        require_action( answer, exit, err = kNoMemoryErr );
+        mico_properties_notify_check( &gProp_BenchContext, gProp_BenchServices, answer );
+        jsonBytes += strlen( json_object_to_json_string( answer ) );
+        json_object_put( answer );
+    }
+    jsonTicks = properties_bench_ticks() - t;
+
+    tlvBytes = 0;
+    t = properties_bench_ticks();
+    for( i = 0; i < kProp_BenchLoops; ++i )
+    {
+        gProp_BenchSensors[ i & 1 ] ^= 1;
+        gProp_BenchSensors[ 3 + ( i & 1 ) ] ^= 1;
+        mico_properties_notify_check_tlv( &gProp_BenchContext, gProp_BenchServices, &gProp_BenchOutBuf );
+        tlvBytes += gProp_BenchOutBuf.len;
+    }
+    properties_bench_report( "notify, 2 sensors changed", jsonBytes, jsonTicks, tlvBytes, properties_bench_ticks() - t );
+
+    // Read of the 4 services
+
+    request = json_tokener_parse( kJsonRead );
+    require_action( request, exit, err = kNoMemoryErr );
+    jsonBytes = 0;
+    t = properties_bench_ticks();
+    for( i = 0; i < kProp_BenchLoops; ++i )
+    {
+        answer = mico_read_properties( gProp_BenchServices, request );
+        require_action( answer, exit, err = kNoMemoryErr );
+        jsonBytes += properties_bench_json_bytes( answer, MICO_PROP_KEY_RESP_READ );
+        json_object_put( answer );
+    }
+    jsonTicks = properties_bench_ticks() - t;
+
+    tlvBytes = 0;
+    t = properties_bench_ticks();
+    for( i = 0; i < kProp_BenchLoops; ++i )
+    {
+        mico_read_properties_tlv( gProp_BenchServices, kTlvRead, sizeof( kTlvRead ), &gProp_BenchOutBuf, &gProp_BenchErrBuf );
+        tlvBytes += gProp_BenchOutBuf.len + gProp_BenchErrBuf.len;
+    }
+    properties_bench_report( "read of 4 services", jsonBytes, jsonTicks, tlvBytes, properties_bench_ticks() - t );
+    printf( "  request %u bytes json, %u bytes tlv\n", (unsigned int)( sizeof( kJsonRead ) - 1 ), (unsigned int) sizeof( kTlvRead ) );
+
+    // Write of 2 properties
+
+    jsonBytes = 0;
+    t = properties_bench_ticks();
+    for( i = 0; i < kProp_BenchLoops; ++i )
+    {
+        answer = NULL;
+        err = mico_write_properties_str( gProp_BenchServices, kJsonWrite, -1, &answer );
+        require_noerr( err, exit );
+        jsonBytes += properties_bench_json_bytes( answer, MICO_PROP_KEY_RESP_WRITE );
+        json_object_put( answer );
+    }
+    jsonTicks = properties_bench_ticks() - t;
+
+    tlvBytes = 0;
+    t = properties_bench_ticks();
+    for( i = 0; i < kProp_BenchLoops; ++i )
+    {
+        mico_write_properties_tlv( gProp_BenchServices, kTlvWrite, sizeof( kTlvWrite ), &gProp_BenchOutBuf, &gProp_BenchErrBuf );
+        tlvBytes += gProp_BenchOutBuf.len + gProp_BenchErrBuf.len;
+    }
+    properties_bench_report( "write of 2 properties", jsonBytes, jsonTicks, tlvBytes, properties_bench_ticks() - t );
+    printf( "  request %u bytes json, %u bytes tlv\n", (unsigned int)( sizeof( kJsonWrite ) - 1 ), (unsigned int) sizeof( kTlvWrite ) );
+
+exit:
+    if( request ) json_object_put( request );
+    printf( "%s: %s\n", __FUNCTION__, !err ? "PASSED" : "FAILED" );
+    return( err );
+}
+
+#if( defined( PROPERTIES_BENCH_MAIN ) )
+int main( void )
+{
+    return( properties_bench( 1 ) ? 1 : 0 );
+}
+#endif
@@ -23,6 +23,7 @@
 #include "MiCOAppDefine.h"
 #include "json_c/json.h"
 #include "StringUtils.h"
+#include "TLVUtils.h"
 #include "properties.h"
 
 #define properties_log(M, ...) custom_log("DEV_PROPERTIES", M, ##__VA_ARGS__)
@@ -33,17 +34,39 @@
 *                          DEFINES && STRUCTURES
 ******************************************************************************/
 
-// notify list node
-typedef struct _mico_prop_notify_node_t{
-  int iid;
-  int s_idx;
-  int p_idx;
-  struct _mico_prop_notify_node_t *next;
-} mico_prop_notify_node_t;
+// iid index: iids are given in the order of service_table, the service first
+// then its properties. The index is built once so that an iid, or the iid
+// string used as json key, is found without walking the table.
+#define MICO_PROP_IID_MAX          (MAX_SERVICE_NUMBER * (1 + MAX_PROPERTY_NUMBER_PER_SERVICE))
+#define MICO_PROP_IID_STR_LEN      (4)   // up to 3 digits and '\0'
+#define MICO_PROP_DIRTY_WORDS      ((MICO_PROP_IID_MAX + 1 + 31) / 32)
 
-// notify list
-volatile bool notify_list_inited = false;
-mico_prop_notify_node_t *g_notify_list = NULL;
+// the index types must hold every iid of a full table, fails to compile when
+// MAX_SERVICE_NUMBER or MAX_PROPERTY_NUMBER_PER_SERVICE outgrow them
+typedef char mico_prop_iid_str_check[(MICO_PROP_IID_MAX < 1000) ? 1 : -1];          // iid_str
+typedef char mico_prop_iid_u8_check[(MICO_PROP_IID_MAX <= 0xFF) ? 1 : -1];          // g_service_iid, g_notify_iids
+typedef char mico_prop_idx_s8_check[((MAX_SERVICE_NUMBER <= 127) &&
+                                     (MAX_PROPERTY_NUMBER_PER_SERVICE <= 127)) ? 1 : -1];  // s_idx, p_idx
+
+typedef struct _mico_prop_index_t{
+  int8_t s_idx;
+  int8_t p_idx;                             // -1: iid is a service
+  char   iid_str[MICO_PROP_IID_STR_LEN];
+} mico_prop_index_t;
+
+static struct mico_service_t *g_index_service_table = NULL;
+static mico_prop_index_t g_iid_index[MICO_PROP_IID_MAX + 1];     // [0] not used
+static int g_iid_max = 0;                                        // last iid in table
+static uint8_t g_service_iid[MAX_SERVICE_NUMBER];                // iid of each service
+
+// properties polled by notify_check
+static uint8_t g_notify_iids[MICO_PROP_IID_MAX];
+static int g_notify_num = 0;
+
+// properties changed since the last notify check, set by notify_check or by
+// mico_property_changed, one bit per iid
+static uint32_t g_dirty_iids[MICO_PROP_DIRTY_WORDS];
+static mico_mutex_t g_dirty_mutex = NULL;
 
 
 /*******************************************************************************
@@ -57,217 +80,203 @@ int notify_check_default(struct mico_prop_t *prop, void *arg, void *val, uint32_
   return ret;
 }
 
-OSStatus FindPropertyByIID(struct mico_service_t *service_table, int iid, 
-                           int *service_index, int *property_index)
+/* build the iid index of service_table
+* input: service_table
+* return: kNoErr if succeed, kSizeErr if the table has too many services
+*/
+OSStatus mico_properties_init(struct mico_service_t *service_table)
 {
-  int s_idx = 0, p_idx = 0, tmpIID = 1;
-  *service_index = 0;
-  *property_index = 0;
-  
-  for(s_idx = 0; NULL != service_table[s_idx].type; s_idx++){
-    if( tmpIID > iid){
-      return kNotFoundErr;
-    }
-    
-    if(tmpIID == iid){
-      *service_index = s_idx;
-      return kRequestErr;  // iid is a service
-    }
-    tmpIID ++;
-    
-    for(p_idx = 0; NULL != service_table[s_idx].properties[p_idx].type; p_idx++){
-      if( tmpIID > iid){
-        return kNotFoundErr;
-      }
-      
-      if(tmpIID == iid){
-        *service_index = s_idx;
-        *property_index = p_idx;
-        return kNoErr;
-      }
-      tmpIID ++;
-    }
+  OSStatus err = kNoErr;
+  int iid = 1, s_idx = 0, p_idx = 0;
+
+  require_action(service_table, exit, err = kParamErr);
+
+  if(g_index_service_table == service_table){
+    return kNoErr;
   }
-  
-  return kNotFoundErr;
-}
 
-OSStatus getIndexByIID(struct mico_service_t *service_table, int iid, 
-                       int *service_index, int *property_index)
-{
-  int s_idx = 0, p_idx = 0, tmpIID = 1;
-  *service_index = 0;
-  *property_index = 0;
-  
+  if(NULL == g_dirty_mutex){
+    err = mico_rtos_init_mutex(&g_dirty_mutex);
+    require_noerr(err, exit);
+  }
+
+  mico_rtos_lock_mutex(&g_dirty_mutex);
+  memset(g_iid_index, 0, sizeof(g_iid_index));
+  g_notify_num = 0;
+  memset(g_dirty_iids, 0, sizeof(g_dirty_iids));
   for(s_idx = 0; NULL != service_table[s_idx].type; s_idx++){
-    if( tmpIID > iid){
-      *service_index = -1;
-      *property_index = -1;
-      return kNotFoundErr;
-    }
-    
-    if(tmpIID == iid){
-      *service_index = s_idx;
-      *property_index = -1;
-      return kNoErr;  // iid is a service
-    }
-    tmpIID ++;
-    
-    for(p_idx = 0; NULL != service_table[s_idx].properties[p_idx].type; p_idx++){
-      if( tmpIID > iid){
-        *service_index = -1;
-        *property_index = -1;
-        return kNotFoundErr;
-      }
-      
-      if(tmpIID == iid){
-        *service_index = s_idx;
-        *property_index = p_idx;
-        return kNoErr;   // iid is a property
-      }
-      tmpIID ++;
+    require_action(s_idx < MAX_SERVICE_NUMBER, unlock, err = kSizeErr);
+    g_service_iid[s_idx] = iid;
+    g_iid_index[iid].s_idx = s_idx;
+    g_iid_index[iid].p_idx = -1;
+    Int2Str((uint8_t*)g_iid_index[iid].iid_str, iid);
+    iid++;
+
+    for(p_idx = 0; (p_idx < MAX_PROPERTY_NUMBER_PER_SERVICE) && (NULL != service_table[s_idx].properties[p_idx].type); p_idx++){
+      g_iid_index[iid].s_idx = s_idx;
+      g_iid_index[iid].p_idx = p_idx;
+      Int2Str((uint8_t*)g_iid_index[iid].iid_str, iid);
+      if( MICO_PROP_PERMS_NOTIFIABLE( service_table[s_idx].properties[p_idx].perms ) &&
+         (NULL != service_table[s_idx].properties[p_idx].notify_check) ){  // polled by notify check
+           g_notify_iids[g_notify_num++] = iid;
+         }
+      iid++;
     }
   }
-  
-  return kNotFoundErr;
-}
+  g_iid_max = iid - 1;
+  g_index_service_table = service_table;
+  properties_log("iid index created: %d iids, %d polled.", g_iid_max, g_notify_num);
 
-OSStatus PropertyNotifyListAdd(int iid, int service_index, int property_index,
-                               mico_prop_notify_node_t **p_notify_list )
-{
-  OSStatus err = kNoErr;
-  mico_prop_notify_node_t *plist = *p_notify_list;
-  //mico_prop_notify_node_t *plist_next = *p_notify_list;
-  mico_prop_notify_node_t *notify = NULL;
-  
-  // create node
-  notify = (mico_prop_notify_node_t *)malloc(sizeof(mico_prop_notify_node_t)); 
-  require_action(notify, exit, err = kNoMemoryErr);
-  
-  notify->iid = iid;
-  notify->s_idx = service_index;
-  notify->p_idx = property_index;
-  notify->next = NULL;
-  
-  if(NULL == *p_notify_list){  // add to first node
-    *p_notify_list = notify;
-    properties_log("notify add: iid=%d, s_id=%d, p_id=%d.", 
-                   (*p_notify_list)->iid, (*p_notify_list)->s_idx, (*p_notify_list)->p_idx);
-    return kNoErr;  
-  }
-  else{  // add to node to the end
-    do{
-      if(plist->iid == iid){
-        plist->s_idx = service_index;
-        plist->p_idx = property_index;
-        free(notify);
-        return kNoErr;   // Nodify already exist, update index
-      }
-      else{
-        if(NULL == plist->next){  // add node to the end.
-          plist->next = notify;
-          properties_log("notify add: iid=%d, s_id=%d, p_id=%d.", 
-                         plist->next->iid, plist->next->s_idx, plist->next->p_idx);
-          return kNoErr;
-        }
-        else {
-          plist = plist->next;
-        }
-      }
-    }while(1);  // get to end
-    
-//    // add node
-//    plist->next = notify;
-//    properties_log("notify add: iid=%d, s_id=%d, p_id=%d.", 
-//                   plist->next->iid, plist->next->s_idx, plist->next->p_idx);
-  }
-  
+unlock:
+  mico_rtos_unlock_mutex(&g_dirty_mutex);
 exit:
+  if(kNoErr != err){
+    properties_log("ERROR: create iid index failed, err = %d.", err);
+  }
   return err;
 }
 
-
-OSStatus getNextNotify( mico_prop_notify_node_t *p_notify_list, 
-                       int *iid, int *s_idx, int *p_idx, 
-                       mico_prop_notify_node_t **outNextNotifyList )
+// the index entry of iid, NULL if not in table
+static const mico_prop_index_t* _property_index(struct mico_service_t *service_table, int iid)
 {
-  if(NULL == outNextNotifyList){
-    return kParamErr;
+  if(kNoErr != mico_properties_init(service_table)){
+    return NULL;
   }
-  
-  if(NULL == p_notify_list){
+  if( (iid < 1) || (iid > g_iid_max) ){
+    return NULL;
+  }
+  return &g_iid_index[iid];
+}
+
+OSStatus FindPropertyByIID(struct mico_service_t *service_table, int iid,
+                           int *service_index, int *property_index)
+{
+  const mico_prop_index_t *index = _property_index(service_table, iid);
+  *service_index = 0;
+  *property_index = 0;
+
+  if(NULL == index){
     return kNotFoundErr;
   }
-  
-  *iid = p_notify_list->iid;
-  *s_idx = p_notify_list->s_idx;
-  *p_idx = p_notify_list->p_idx;
-  *outNextNotifyList = p_notify_list->next;
-  
+
+  *service_index = index->s_idx;
+  if(-1 == index->p_idx){
+    return kRequestErr;  // iid is a service
+  }
+  *property_index = index->p_idx;
   return kNoErr;
 }
 
-OSStatus PropertyNotifyListClean(mico_prop_notify_node_t **p_notify_list )
+OSStatus getIndexByIID(struct mico_service_t *service_table, int iid,
+                       int *service_index, int *property_index)
 {
-  mico_prop_notify_node_t* temp = *p_notify_list;
-  mico_prop_notify_node_t* temp_next;
-  
-  if(NULL == *p_notify_list){
-    return kNoErr;
+  const mico_prop_index_t *index = _property_index(service_table, iid);
+
+  if(NULL == index){
+    *service_index = -1;
+    *property_index = -1;
+    return kNotFoundErr;
   }
-  
-  do{
-    temp_next = temp->next;
-    free(temp);
-    temp = temp_next;
-  }while(NULL != temp);    
-  
-  *p_notify_list = NULL;
-  
-  properties_log("notify list clean ok.");
-  
+
+  *service_index = index->s_idx;
+  *property_index = index->p_idx;   // -1 if iid is a service
   return kNoErr;
 }
 
-/* create notify list from service_table
+/* mark a property changed: it is sent by the next notify check, its notify_check
+* is not needed. For a property updated by an event instead of polling.
 * input: service_table
-* return: notify list
+*        prop, in service_table
+* return: kNoErr if succeed.
 */
-OSStatus create_notify_list(struct mico_service_t *service_table,
-                            mico_prop_notify_node_t **outNotifyList)
+OSStatus mico_property_changed(struct mico_service_t *service_table, struct mico_prop_t *prop)
 {
   OSStatus err = kNoErr;
-  int iid = 1, s_idx = 0, p_idx = 0;
-  
-  require_action(outNotifyList, exit, err = kParamErr);
-  require_action(service_table, exit, err = kParamErr);
-  
-  properties_log("create notify list...");
-  for(s_idx = 0; NULL != service_table[s_idx].type; s_idx++){
-    iid++;  // is a service, jump to next service or property
-    for(p_idx = 0; NULL != service_table[s_idx].properties[p_idx].type; p_idx++){     
-      if( MICO_PROP_PERMS_NOTIFIABLE( service_table[s_idx].properties[p_idx].perms ) &&
-         (NULL != service_table[s_idx].properties[p_idx].notify_check) ){  //must set notify_check func
-           // add to notify list
-           err = PropertyNotifyListAdd(iid, s_idx, p_idx, outNotifyList);
-           require_noerr(err, exit);
+  int s_idx = 0, p_idx = 0, iid = 0;
+
+  require_action(prop, exit, err = kParamErr);
+  err = mico_properties_init(service_table);
+  require_noerr(err, exit);
+
+  // prop is an element of service_table[s_idx].properties
+  s_idx = ((uint8_t*)prop - (uint8_t*)service_table) / sizeof(struct mico_service_t);
+  require_action( (prop >= service_table[0].properties) && (s_idx < MAX_SERVICE_NUMBER) &&
+                  (NULL != service_table[s_idx].type), exit, err = kNotFoundErr );
+  p_idx = prop - service_table[s_idx].properties;
+  require_action( (p_idx >= 0) && (p_idx < MAX_PROPERTY_NUMBER_PER_SERVICE), exit, err = kNotFoundErr );
+  iid = g_service_iid[s_idx] + 1 + p_idx;
+  require_action( (iid <= g_iid_max) && (g_iid_index[iid].s_idx == s_idx), exit, err = kNotFoundErr );
+  require_action( MICO_PROP_PERMS_NOTIFIABLE(prop->perms), exit, err = kUnsupportedErr );
+
+  mico_rtos_lock_mutex(&g_dirty_mutex);
+  g_dirty_iids[iid / 32] |= (uint32_t)1 << (iid % 32);
+  mico_rtos_unlock_mutex(&g_dirty_mutex);
+
+exit:
+  return err;
+}
+
+// poll the properties with notify_check, then take the properties changed
+static void _properties_notify_take(struct mico_service_t *service_table, uint32_t *dirty)
+{
+  int s_idx = 0;
+  int p_idx = 0;
+  int iid = 0;
+  int i = 0;
+  int ret = 0;
+
+  // poll properties, prop value && len is updated if changed
+  for(i = 0; i < g_notify_num; i++){
+    iid = g_notify_iids[i];
+    s_idx = g_iid_index[iid].s_idx;
+    p_idx = g_iid_index[iid].p_idx;
+    if((NULL != service_table[s_idx].properties[p_idx].event) &&
+       (*(service_table[s_idx].properties[p_idx].event)) ){  // prop event enable
+         ret = service_table[s_idx].properties[p_idx].notify_check(&(service_table[s_idx].properties[p_idx]),
+                                                                   service_table[s_idx].properties[p_idx].arg,
+                                                                   service_table[s_idx].properties[p_idx].value,
+                                                                   service_table[s_idx].properties[p_idx].value_len);
+         if(1 == ret){  // prop updated
+           mico_rtos_lock_mutex(&g_dirty_mutex);
+           g_dirty_iids[iid / 32] |= (uint32_t)1 << (iid % 32);
+           mico_rtos_unlock_mutex(&g_dirty_mutex);
          }
-      iid++;  // next property
-    }
+       }
   }
-  
-exit:
-  if(kNoErr != err){
-    properties_log("ERROR: create notify list failed, err = %d.", err);
-    PropertyNotifyListClean(outNotifyList);
+
+  mico_rtos_lock_mutex(&g_dirty_mutex);
+  memcpy(dirty, g_dirty_iids, sizeof(g_dirty_iids));
+  memset(g_dirty_iids, 0, sizeof(g_dirty_iids));
+  mico_rtos_unlock_mutex(&g_dirty_mutex);
+}
+
+// the next changed property after iid with event enabled, 0 if none
+static int _properties_notify_next(struct mico_service_t *service_table, const uint32_t *dirty, int iid)
+{
+  int s_idx = 0;
+  int p_idx = 0;
+
+  for(iid++; iid <= g_iid_max; iid++){
+    if(0 == dirty[iid / 32]){  // no change in these 32 iids
+      iid |= 31;
+      continue;
+    }
+    if(0 == (dirty[iid / 32] & ((uint32_t)1 << (iid % 32)))){
+      continue;
+    }
+    s_idx = g_iid_index[iid].s_idx;
+    p_idx = g_iid_index[iid].p_idx;
+    if((NULL != service_table[s_idx].properties[p_idx].event) &&
+       (*(service_table[s_idx].properties[p_idx].event)) ){  // prop event enable
+         return iid;
+       }
   }
-  properties_log("notify list create ok.");
-  return err;
+  return 0;
 }
 
 /* property notify check
-* description: check update of all properties in notify list, 
-*              if notify list is not created, create is first from service_table.
+* description: poll the properties with notify_check, then send all properties
+*              changed, in iid order. The iid index is created the first time.
 * input: mico context;
 *        service table
 * output: json object contains properties updated, like {k:v, k:v}
@@ -278,75 +287,55 @@ OSStatus mico_properties_notify_check(app_context_t * const inContext, struct mi
                                       json_object* notify_obj)
 {
   OSStatus err = kNoErr;
-  int s_idx = 0; 
+  int s_idx = 0;
   int p_idx = 0;
   int iid = 0;
-  char iid_str[16] = {0};
-  int ret = 0;
-  mico_prop_notify_node_t *_notify_list = NULL;
-  
+  uint32_t dirty[MICO_PROP_DIRTY_WORDS];
+
   require_action(inContext, exit, err = kParamErr);
   require_action(service_table, exit, err = kParamErr);
   require_action(notify_obj, exit, err = kParamErr);
-  
+
   //properties_log("properties update check...");
-  
-  // if notify list not created, create it the first time
-  if(!notify_list_inited){
-    if(NULL != g_notify_list){
-      PropertyNotifyListClean(&g_notify_list);  // clean g_notify_list  
+
+  // create iid index the first time
+  err = mico_properties_init(service_table);
+  require_noerr(err, exit);
+
+  _properties_notify_take(service_table, dirty);
+
+  // add new value of changed properties to notify json object
+  for(iid = _properties_notify_next(service_table, dirty, 0); 0 != iid;
+      iid = _properties_notify_next(service_table, dirty, iid)){
+    s_idx = g_iid_index[iid].s_idx;
+    p_idx = g_iid_index[iid].p_idx;
+    switch(service_table[s_idx].properties[p_idx].format){
+    case MICO_PROP_TYPE_INT:{
+      json_object_object_add(notify_obj, g_iid_index[iid].iid_str,
+                             json_object_new_int(*((int*)(service_table[s_idx].properties[p_idx].value))));
+      break;
+    }
+    case MICO_PROP_TYPE_FLOAT:{
+      json_object_object_add(notify_obj, g_iid_index[iid].iid_str,
+                             json_object_new_double(*((float*)service_table[s_idx].properties[p_idx].value)));
+      break;
+    }
+    case MICO_PROP_TYPE_STRING:{
+      json_object_object_add(notify_obj, g_iid_index[iid].iid_str,
+                             json_object_new_string((char*)service_table[s_idx].properties[p_idx].value));
+      break;
+    }
+    case MICO_PROP_TYPE_BOOL:{
+      json_object_object_add(notify_obj, g_iid_index[iid].iid_str,
+                             json_object_new_boolean(*((bool*)service_table[s_idx].properties[p_idx].value)));
+      break;
+    }
+    default:
+      properties_log("ERROR: prop format unsupport!");
+      break;
     }
-    err = create_notify_list(service_table, &g_notify_list);
-    require_noerr(err, exit);
-    notify_list_inited = true;
-  }
-  
-  _notify_list = g_notify_list;
-  // search notify list
-  while(getNextNotify(_notify_list, &iid, &s_idx, &p_idx, &_notify_list) == kNoErr){
-    //properties_log("notify prop check: iid=%d, s_idx=%d, p_idx=%d.", iid, s_idx, p_idx);
-    // get key string
-    memset((void*)iid_str, '\0', sizeof(iid_str));
-    Int2Str((uint8_t*)iid_str, iid);
-    
-    // add updated property to json object
-    if((NULL != service_table[s_idx].properties[p_idx].event) &&
-       (*(service_table[s_idx].properties[p_idx].event)) ){  // prop event enable
-         // do prop update check && update prop value && len
-         ret = service_table[s_idx].properties[p_idx].notify_check(&(service_table[s_idx].properties[p_idx]), 
-                                                                   service_table[s_idx].properties[p_idx].arg, 
-                                                                   service_table[s_idx].properties[p_idx].value, 
-                                                                   service_table[s_idx].properties[p_idx].value_len);
-         if(1 == ret){  // prop updated, add new value to notify json object
-           switch(service_table[s_idx].properties[p_idx].format){
-           case MICO_PROP_TYPE_INT:{
-             json_object_object_add(notify_obj, iid_str, 
-                                    json_object_new_int(*((int*)(service_table[s_idx].properties[p_idx].value))));
-             break;
-           }
-           case MICO_PROP_TYPE_FLOAT:{
-             json_object_object_add(notify_obj, iid_str, 
-                                    json_object_new_double(*((float*)service_table[s_idx].properties[p_idx].value)));
-             break;
-           }
-           case MICO_PROP_TYPE_STRING:{
-             json_object_object_add(notify_obj, iid_str, 
-                                    json_object_new_string((char*)service_table[s_idx].properties[p_idx].value));
-             break;
-           }
-           case MICO_PROP_TYPE_BOOL:{
-             json_object_object_add(notify_obj, iid_str, 
-                                    json_object_new_boolean(*((bool*)service_table[s_idx].properties[p_idx].value)));
-             break;
-           }
-           default:
-             properties_log("ERROR: prop format unsupport!");
-             break;
-           }
-         }
-       }
   }
-  
+
 exit:
   return err;
 }
@@ -459,7 +448,6 @@ OSStatus _property_read_create_response(struct mico_service_t *service_table,
   int property_index = 0;
   int iid = 0;
   int tmp_iid = 0;
-  char iid_str[16] = {0};
   const char* pProertyType = NULL;
   
   require_action( service_table, exit, err = kParamErr);
@@ -474,10 +462,7 @@ OSStatus _property_read_create_response(struct mico_service_t *service_table,
     tmp_iid = iid + 1;
     for(property_index = 0, pProertyType = service_table[service_index].properties[0].type; NULL != pProertyType;){
       // iid as response key
-      memset(iid_str, '\0', sizeof(iid_str));
-      Int2Str((uint8_t*)iid_str, tmp_iid);
-      
-      err = _property_read_create_response_by_index(service_table, iid_str, tmp_iid, 
+      err = _property_read_create_response_by_index(service_table, g_iid_index[tmp_iid].iid_str, tmp_iid, 
                                                service_index, property_index, 
                                                out_read_obj, out_err_prop_obj);
       tmp_iid++;
@@ -707,7 +692,7 @@ OSStatus add_property(json_object* properties,  struct mico_prop_t property, int
   object = json_object_new_object();
   require_action(object, exit, err = kNoResourcesErr);
   
-  // type &&iid
+  // type &&��iid
   json_object_object_add(object, "type", json_object_new_string(property.type));
   json_object_object_add(object, "iid", json_object_new_int(iid));
   
@@ -930,6 +915,45 @@ exit:
   return outJsonObj;
 }
 
+// create the "write" && "err" response of mico_write_properties
+static OSStatus _property_write_response_create(json_object **outJsonObj, json_object **out_write_obj,
+                                                json_object **out_err_obj, json_object **out_err_prop_obj)
+{
+  OSStatus err = kNoMemoryErr;
+  
+  *outJsonObj = json_object_new_object();
+  require( *outJsonObj, exit );
+  
+  *out_write_obj = json_object_new_object();
+  require( *out_write_obj, exit );
+  json_object_object_add(*outJsonObj, MICO_PROP_KEY_RESP_WRITE, *out_write_obj);
+  
+  *out_err_obj = json_object_new_object();
+  require( *out_err_obj, exit );
+  json_object_object_add(*outJsonObj, MICO_PROP_KEY_RESP_ERROR, *out_err_obj);
+  *out_err_prop_obj = json_object_new_object();
+  require( *out_err_prop_obj, exit );
+  json_object_object_add(*out_err_obj, MICO_PROP_KEY_RESP_ERROR_PROPERTIES, *out_err_prop_obj);
+  err = kNoErr;
+  
+exit:
+  return err;
+}
+
+// "status" obj for write status code
+static void _property_write_response_status(json_object *out_err_obj, json_object *out_err_prop_obj)
+{
+  if( (NULL == json_object_get_object(out_err_prop_obj)->head) ){  // no err
+    json_object_object_del(out_err_obj, MICO_PROP_KEY_RESP_ERROR_PROPERTIES);  // remove empty "properties" sub-obj
+    json_object_object_add(out_err_obj,
+                           MICO_PROP_KEY_RESP_STATUS, json_object_new_int(MICO_PROP_CODE_WRITE_SUCCESS));
+  }
+  else{
+    json_object_object_add(out_err_obj,
+                           MICO_PROP_KEY_RESP_STATUS, json_object_new_int(MICO_PROP_CODE_WRITE_PARTIAL_FAILED));
+  }
+}
+
 /* write multiple properties;
 * input:  json object of property iids to read, like {"1":100, "2":99}, 
 *   NOTE: function get iid from key string, get write data from value
@@ -957,36 +981,520 @@ json_object*  mico_write_properties(struct mico_service_t *service_table,
   require( prop_write_list_obj, exit );
   
   // create "write" && "err" sub-obj
-  outJsonObj = json_object_new_object();
-  require( outJsonObj, exit );
-  
-  out_write_obj = json_object_new_object();
-  require( out_write_obj, exit );
-  json_object_object_add(outJsonObj, MICO_PROP_KEY_RESP_WRITE, out_write_obj);
-  
-  out_err_obj = json_object_new_object();
-  require( out_err_obj, exit );
-  json_object_object_add(outJsonObj, MICO_PROP_KEY_RESP_ERROR, out_err_obj);
-  out_err_prop_obj = json_object_new_object();
-  require( out_err_prop_obj, exit );
-  json_object_object_add(out_err_obj, MICO_PROP_KEY_RESP_ERROR_PROPERTIES, out_err_prop_obj);
+  require_noerr( _property_write_response_create(&outJsonObj, &out_write_obj, &out_err_obj, &out_err_prop_obj), exit );
   
   // write for each prop
   json_object_object_foreach(prop_write_list_obj, key, val) {
     _property_write_create_response(service_table, key, val, out_write_obj, out_err_prop_obj);
   }
   
-  // "status" obj for write status code
-  if( (NULL == json_object_get_object(out_err_prop_obj)->head) ){  // no err
-    json_object_object_del(out_err_obj, MICO_PROP_KEY_RESP_ERROR_PROPERTIES);  // remove empty "properties" sub-obj
-    json_object_object_add(out_err_obj,
-                           MICO_PROP_KEY_RESP_STATUS, json_object_new_int(MICO_PROP_CODE_WRITE_SUCCESS));
+  _property_write_response_status(out_err_obj, out_err_prop_obj);
+  
+exit:
+  return outJsonObj;
+}
+
+typedef struct _property_write_sax_t {
+  struct mico_service_t *service_table;
+  json_object *out_write_obj;
+  json_object *out_err_prop_obj;
+  bool is_object;
+} property_write_sax_t;
+
+// write each member of the top object as it is parsed, a scalar value is
+// converted to json_object on the stack
+static int _property_write_sax_cb(struct json_sax *sax, const char *key, int key_len,
+                                  const struct json_sax_value *val)
+{
+  property_write_sax_t *write = (property_write_sax_t*)sax->ctx;
+  uint8_t value_arena_buf[MICO_PROP_WRITE_VALUE_ARENA_SIZE];
+  struct json_arena value_arena;
+  json_object *value = NULL;
+  char iid_str[16];
+  
+  if( 0 == sax->depth ){
+    write->is_object = (json_type_object == val->type);
+    return write->is_object ? JSON_SAX_CONTINUE : JSON_SAX_STOP;
   }
-  else{
-    json_object_object_add(out_err_obj,
-                           MICO_PROP_KEY_RESP_STATUS, json_object_new_int(MICO_PROP_CODE_WRITE_PARTIAL_FAILED));
+  if( (sax->depth > 1) || val->end ){
+    return JSON_SAX_CONTINUE;
+  }
+  
+  // iid string, a longer key is not a property
+  if( json_sax_copy_key(key, key_len, iid_str, sizeof(iid_str)) >= (int)sizeof(iid_str) ){
+    strcpy(iid_str, "0");
   }
   
+  json_arena_init(&value_arena, value_arena_buf, sizeof(value_arena_buf));
+  value = json_sax_value_to_object(sax, &value_arena, val);
+  if( (NULL == value) && (json_type_null != val->type) ){
+    value = json_sax_value_to_object(sax, NULL, val);
+  }
+  
+  _property_write_create_response(write->service_table, iid_str, value,
+                                  write->out_write_obj, write->out_err_prop_obj);
+  if(NULL != value){
+    json_object_put(value);
+  }
+  
+  if( (json_type_object == val->type) || (json_type_array == val->type) ){
+    return JSON_SAX_SKIP;
+  }
+  return JSON_SAX_CONTINUE;
+}
+
+/* write multiple properties from json text, without building its json object;
+* input:  json text of property iids to write, like {"1":100, "2":99},
+*         len is -1 if the text ends with '\0'
+* output: outJsonObj, the same response as mico_write_properties
+* return: kFormatErr if the text is not a json object, nothing is written then.
+*/
+OSStatus mico_write_properties_str(struct mico_service_t *service_table,
+                                   const char *prop_write_list_str, int len,
+                                   json_object **outJsonObj)
+{
+  OSStatus err = kUnknownErr;
+  json_object *out_err_obj = NULL;
+  struct json_sax sax;
+  property_write_sax_t write;
+  
+  require_action( service_table, exit, err = kParamErr );
+  require_action( prop_write_list_str, exit, err = kParamErr );
+  require_action( outJsonObj, exit, err = kParamErr );
+  *outJsonObj = NULL;
+  
+  // check the whole text before any property is written
+  memset(&sax, 0, sizeof(sax));
+  require_action( json_tokener_success == json_sax_parse(&sax, prop_write_list_str, len), exit, err = kFormatErr );
+  
+  memset(&write, 0, sizeof(write));
+  write.service_table = service_table;
+  err = _property_write_response_create(outJsonObj, &write.out_write_obj, &out_err_obj, &write.out_err_prop_obj);
+  require_noerr( err, exit );
+  
+  sax.default_cb = _property_write_sax_cb;
+  sax.ctx = &write;
+  json_sax_parse(&sax, prop_write_list_str, len);
+  require_action( write.is_object, exit, err = kFormatErr );
+  
+  _property_write_response_status(out_err_obj, write.out_err_prop_obj);
+  
 exit:
-  return outJsonObj;
+  if( (kNoErr != err) && (NULL != outJsonObj) && (NULL != *outJsonObj) ){
+    json_object_put(*outJsonObj);
+    *outJsonObj = NULL;
+  }
+  return err;
+}
+
+
+/*******************************************************************************
+*                          TLV MESSAGES
+* item ID is the iid, the value is:
+*   int:    1, 2 or 4 bytes little endian, the shortest that holds the value
+*   float:  4 bytes IEEE 754 little endian
+*   bool:   1 byte, 0 or 1
+*   string: the bytes without '\0', split into items of 255 bytes if longer
+* an err message has a 4 bytes little endian code for each iid failed, then
+* the status code in item MICO_PROP_TLV_ID_STATUS.
+*******************************************************************************/
+
+#define MICO_PROP_TLV_CODE_LEN      (6)   // id, len, 4 bytes code
+
+static void _property_tlv_put(uint8_t *data, uint32_t value, size_t len)
+{
+  size_t i = 0;
+  
+  for(i = 0; i < len; i++){
+    data[i] = (uint8_t)(value >> (8 * i));
+  }
+}
+
+static uint32_t _property_tlv_get(const uint8_t *data, size_t len)
+{
+  uint32_t value = 0;
+  size_t i = 0;
+  
+  for(i = 0; i < len; i++){
+    value |= (uint32_t)data[i] << (8 * i);
+  }
+  return value;
+}
+
+// add an err code, room is left for the status code
+static OSStatus _property_tlv_add_code(mico_prop_tlv_buf_t *out, uint8_t id, int code)
+{
+  uint8_t *ptr = out->buf + out->len;
+  uint8_t data[4];
+  OSStatus err = kNoErr;
+  
+  _property_tlv_put(data, (uint32_t)code, sizeof(data));
+  err = TLVAdd(&ptr, out->buf + out->size - ((MICO_PROP_TLV_ID_STATUS == id) ? 0 : MICO_PROP_TLV_CODE_LEN),
+               id, data, sizeof(data));
+  if(kNoErr == err){
+    out->len = ptr - out->buf;
+  }
+  return err;
+}
+
+// add the current value of a property, nothing is added if it does not fit
+static OSStatus _property_tlv_add_value(mico_prop_tlv_buf_t *out, int iid, struct mico_prop_t *prop)
+{
+  OSStatus err = kNoErr;
+  uint8_t *ptr = out->buf + out->len;
+  uint8_t data[4];
+  size_t len = 0;
+  int32_t int_value = 0;
+  uint32_t float_bits = 0;
+  
+  switch(prop->format){
+  case MICO_PROP_TYPE_INT:{
+    int_value = *((int*)prop->value);
+    len = ((int_value >= -128) && (int_value <= 127)) ? 1 :
+      (((int_value >= -32768) && (int_value <= 32767)) ? 2 : 4);
+    _property_tlv_put(data, (uint32_t)int_value, len);
+    err = TLVAdd(&ptr, out->buf + out->size, (uint8_t)iid, data, len);
+    break;
+  }
+  case MICO_PROP_TYPE_FLOAT:{
+    memcpy(&float_bits, prop->value, sizeof(float_bits));
+    _property_tlv_put(data, float_bits, sizeof(float_bits));
+    err = TLVAdd(&ptr, out->buf + out->size, (uint8_t)iid, data, sizeof(float_bits));
+    break;
+  }
+  case MICO_PROP_TYPE_BOOL:{
+    data[0] = *((bool*)prop->value) ? 1 : 0;
+    err = TLVAdd(&ptr, out->buf + out->size, (uint8_t)iid, data, 1);
+    break;
+  }
+  case MICO_PROP_TYPE_STRING:{
+    err = TLVAdd(&ptr, out->buf + out->size, (uint8_t)iid, prop->value, strlen((char*)prop->value));
+    break;
+  }
+  default:
+    err = kUnsupportedDataErr;
+    break;
+  }
+  
+  if(kNoErr == err){
+    out->len = ptr - out->buf;
+  }
+  return err;
+}
+
+// check a TLV request before any property is read or written
+static OSStatus _property_tlv_check(const uint8_t *src, const uint8_t *end)
+{
+  OSStatus err = kNoErr;
+  uint8_t id = 0;
+  size_t len = 0;
+  
+  do{
+    err = TLVGetNextJoined(src, end, &id, NULL, 0, &len, &src);
+  }while(kNoErr == err);
+  return (kNotFoundErr == err) && (src == end) ? kNoErr : kFormatErr;
+}
+
+// read a property into out_read, or its err code into out_err
+static OSStatus _property_read_tlv_by_index(struct mico_service_t *service_table, int iid,
+                                            int service_index, int property_index,
+                                            mico_prop_tlv_buf_t *out_read, mico_prop_tlv_buf_t *out_err)
+{
+  OSStatus err = kNoErr;
+  struct mico_prop_t *prop = &service_table[service_index].properties[property_index];
+  
+  if( !MICO_PROP_PERMS_READABLE(prop->perms) ){
+    properties_log("ERROR: property %d is not readable!", iid);
+    _property_tlv_add_code(out_err, (uint8_t)iid, MICO_PROP_CODE_NOT_READABLE);
+    return kNotReadableErr;
+  }
+  
+  // prop->get (read hardware status)
+  if(NULL != prop->get){
+    prop->get(prop, prop->arg, prop->value, prop->value_len);
+  }
+  err = _property_tlv_add_value(out_read, iid, prop);
+  if(kUnsupportedDataErr == err){
+    properties_log("ERROR: property format unsupported!");
+    _property_tlv_add_code(out_err, (uint8_t)iid, MICO_PROP_CODE_DATA_FORMAT_ERR);
+  }
+  else if(kNoErr != err){  // response full
+    _property_tlv_add_code(out_err, (uint8_t)iid, MICO_PROP_CODE_READ_FAILED);
+  }
+  return err;
+}
+
+/* read multiple properties, request and response in TLV;
+* input:  TLV items of property iids to read, the value is not used,
+*         a service iid reads all its properties
+* output: out_read, value of properties read
+*         out_err, code of properties failed and the status code
+* return: kFormatErr if the request is not TLV, nothing is read then and
+*         out_err has the status code only.
+*/
+OSStatus mico_read_properties_tlv(struct mico_service_t *service_table,
+                                  const uint8_t *prop_read_list, size_t len,
+                                  mico_prop_tlv_buf_t *out_read, mico_prop_tlv_buf_t *out_err)
+{
+  OSStatus err = kNoErr;
+  const uint8_t *src = prop_read_list;
+  const uint8_t *end = prop_read_list + len;
+  uint8_t id = 0;
+  size_t value_len = 0;
+  int service_index = 0;
+  int property_index = 0;
+  int tmp_iid = 0;
+  int status = MICO_PROP_CODE_READ_SUCCESS;
+  
+  require_action( service_table, exit, err = kParamErr );
+  require_action( prop_read_list || (0 == len), exit, err = kParamErr );
+  require_action( out_read && out_read->buf, exit, err = kParamErr );
+  require_action( out_err && (out_err->size >= MICO_PROP_TLV_CODE_LEN), exit, err = kParamErr );
+  out_read->len = 0;
+  out_err->len = 0;
+  
+  err = _property_tlv_check(src, end);
+  if(kFormatErr == err){  // status code only
+    _property_tlv_add_code(out_err, MICO_PROP_TLV_ID_STATUS, MICO_PROP_CODE_DATA_FORMAT_ERR);
+  }
+  require_noerr( err, exit );
+  
+  // the meta data table is only described in json
+  if(0 == len){
+    status = MICO_PROP_CODE_NOT_SUPPORTED;
+  }
+  
+  // read for each prop
+  while(kNoErr == TLVGetNextJoined(src, end, &id, NULL, 0, &value_len, &src)){
+    if(kNoErr != getIndexByIID(service_table, id, &service_index, &property_index)){
+      _property_tlv_add_code(out_err, id, MICO_PROP_CODE_NOT_FOUND);
+    }
+    else if( -1 == property_index){  // is a service
+      for(property_index = 0, tmp_iid = id + 1;
+          (property_index < MAX_PROPERTY_NUMBER_PER_SERVICE) &&
+          (NULL != service_table[service_index].properties[property_index].type);
+          property_index++, tmp_iid++){
+        _property_read_tlv_by_index(service_table, tmp_iid, service_index, property_index, out_read, out_err);
+      }
+    }
+    else{  // is a property
+      _property_read_tlv_by_index(service_table, id, service_index, property_index, out_read, out_err);
+    }
+  }
+  
+  // status code
+  if( (MICO_PROP_CODE_READ_SUCCESS == status) && (0 != out_err->len) ){
+    status = MICO_PROP_CODE_READ_PARTIAL_FAILED;
+  }
+  err = _property_tlv_add_code(out_err, MICO_PROP_TLV_ID_STATUS, status);
+  
+exit:
+  return err;
+}
+
+// write a property from the TLV item at src, return its value in out_write or err code in out_err
+static OSStatus _property_write_tlv(struct mico_service_t *service_table,
+                                    const uint8_t *src, const uint8_t *end,
+                                    mico_prop_tlv_buf_t *out_write, mico_prop_tlv_buf_t *out_err)
+{
+  OSStatus err = kNoErr;
+  struct mico_prop_t *prop = NULL;
+  uint8_t id = 0;
+  size_t len = 0;
+  int service_index = 0;
+  int property_index = 0;
+  int ret = 0;
+  int code = MICO_PROP_CODE_WRITE_FAILED;
+  
+  uint8_t data[4];
+  int int_value = 0;
+  uint32_t float_bits = 0;
+  float float_value = 0;
+  bool boolean_value = false;
+  char *set_string = NULL;
+  void *set_value = NULL;
+  uint32_t set_len = 0;
+  
+  TLVGetNextJoined(src, end, &id, NULL, 0, &len, NULL);
+  
+  err = FindPropertyByIID(service_table, id, &service_index, &property_index);
+  if(kNotFoundErr == err){   // property not found
+    properties_log("ERROR: property not found!");
+    code = MICO_PROP_CODE_NOT_FOUND;
+  }
+  if(kRequestErr == err){   // service can not be set
+    properties_log("ERROR: service can not be set!");
+    code = MICO_PROP_CODE_NOT_SUPPORTED;
+  }
+  require_noerr( err, exit );
+  prop = &service_table[service_index].properties[property_index];
+  
+  require_action( MICO_PROP_PERMS_WRITABLE(prop->perms), exit,
+                 err = kNotWritableErr; code = MICO_PROP_CODE_NOT_WRITABLE );
+  require_action( prop->set, exit, err = kWriteErr; code = MICO_PROP_CODE_NO_SET_FUNC );
+  
+  // decode value by property format
+  switch(prop->format){
+  case MICO_PROP_TYPE_INT:{
+    require_action( (1 == len) || (2 == len) || (4 == len), exit, err = kFormatErr );
+    TLVGetNextJoined(src, end, &id, data, sizeof(data), &len, NULL);
+    int_value = (int)_property_tlv_get(data, len);
+    if( (len < 4) && (data[len - 1] & 0x80) ){  // sign extend
+      int_value |= (int)(0xFFFFFFFFu << (8 * len));
+    }
+    set_value = &int_value;
+    set_len = sizeof(int);
+    break;
+  }
+  case MICO_PROP_TYPE_FLOAT:{
+    require_action( 4 == len, exit, err = kFormatErr );
+    TLVGetNextJoined(src, end, &id, data, sizeof(data), &len, NULL);
+    float_bits = _property_tlv_get(data, len);
+    memcpy(&float_value, &float_bits, sizeof(float_value));
+    set_value = &float_value;
+    set_len = sizeof(float);
+    break;
+  }
+  case MICO_PROP_TYPE_BOOL:{
+    require_action( 1 == len, exit, err = kFormatErr );
+    TLVGetNextJoined(src, end, &id, data, sizeof(data), &len, NULL);
+    boolean_value = (0 != data[0]);
+    set_value = &boolean_value;
+    set_len = sizeof(bool);
+    break;
+  }
+  case MICO_PROP_TYPE_STRING:{
+    set_string = (char*)malloc(len + 1);
+    require_action( set_string, exit, err = kNoMemoryErr );
+    TLVGetNextJoined(src, end, &id, (uint8_t*)set_string, len, &len, NULL);
+    set_string[len] = '\0';
+    set_value = set_string;
+    set_len = len;
+    break;
+  }
+  default:
+    properties_log("ERROR: Unsupported format!");
+    err = kFormatErr;
+    goto exit;
+  }
+  
+  // property set (hardware operation)
+  ret = prop->set(prop, prop->arg, set_value, set_len);
+  require_action( 0 == ret, exit, err = kWriteErr );
+  
+  // set ok, update property value
+  switch(prop->format){
+  case MICO_PROP_TYPE_INT:
+    *((int*)prop->value) = int_value;
+    break;
+  case MICO_PROP_TYPE_FLOAT:
+    *((float*)prop->value) = float_value;
+    break;
+  case MICO_PROP_TYPE_BOOL:
+    *((bool*)prop->value) = boolean_value;
+    break;
+  default:
+    memset((char*)(prop->value), '\0', prop->maxStringLen);
+    strncpy((char*)(prop->value), set_string, set_len);
+    *(prop->value_len) = set_len;
+    break;
+  }
+  if(kNoErr != _property_tlv_add_value(out_write, id, prop)){
+    properties_log("ERROR: write response full, iid %d not returned!", id);
+  }
+  
+exit:
+  if(kFormatErr == err){
+    code = MICO_PROP_CODE_DATA_FORMAT_ERR;
+  }
+  if(kNoErr != err){
+    _property_tlv_add_code(out_err, id, code);
+  }
+  if(NULL != set_string){
+    free(set_string);
+  }
+  return err;
+}
+
+/* write multiple properties, request and response in TLV;
+* input:  TLV items of property iids to write, with the value to write
+* output: out_write, value of properties written
+*         out_err, code of properties failed and the status code
+* return: kFormatErr if the request is not TLV, nothing is written then and
+*         out_err has the status code only.
+*/
+OSStatus mico_write_properties_tlv(struct mico_service_t *service_table,
+                                   const uint8_t *prop_write_list, size_t len,
+                                   mico_prop_tlv_buf_t *out_write, mico_prop_tlv_buf_t *out_err)
+{
+  OSStatus err = kNoErr;
+  const uint8_t *src = prop_write_list;
+  const uint8_t *end = prop_write_list + len;
+  uint8_t id = 0;
+  size_t value_len = 0;
+  const uint8_t *next = NULL;
+  
+  require_action( service_table, exit, err = kParamErr );
+  require_action( prop_write_list || (0 == len), exit, err = kParamErr );
+  require_action( out_write && out_write->buf, exit, err = kParamErr );
+  require_action( out_err && (out_err->size >= MICO_PROP_TLV_CODE_LEN), exit, err = kParamErr );
+  out_write->len = 0;
+  out_err->len = 0;
+  
+  err = _property_tlv_check(src, end);
+  if(kFormatErr == err){  // status code only
+    _property_tlv_add_code(out_err, MICO_PROP_TLV_ID_STATUS, MICO_PROP_CODE_DATA_FORMAT_ERR);
+  }
+  require_noerr( err, exit );
+  
+  // write for each prop
+  while(kNoErr == TLVGetNextJoined(src, end, &id, NULL, 0, &value_len, &next)){
+    _property_write_tlv(service_table, src, end, out_write, out_err);
+    src = next;
+  }
+  
+  // status code
+  err = _property_tlv_add_code(out_err, MICO_PROP_TLV_ID_STATUS,
+                               (0 == out_err->len) ? MICO_PROP_CODE_WRITE_SUCCESS : MICO_PROP_CODE_WRITE_PARTIAL_FAILED);
+  
+exit:
+  return err;
+}
+
+/* property notify check, like mico_properties_notify_check
+* output: notify, TLV items of properties updated, empty if no update.
+*         A property that does not fit is sent by the next check.
+* return: kNoErr if succeed.
+*/
+OSStatus mico_properties_notify_check_tlv(app_context_t * const inContext, struct mico_service_t *service_table,
+                                          mico_prop_tlv_buf_t *notify)
+{
+  OSStatus err = kNoErr;
+  int iid = 0;
+  uint32_t dirty[MICO_PROP_DIRTY_WORDS];
+  
+  require_action(inContext, exit, err = kParamErr);
+  require_action(service_table, exit, err = kParamErr);
+  require_action(notify && notify->buf, exit, err = kParamErr);
+  notify->len = 0;
+  
+  // create iid index the first time
+  err = mico_properties_init(service_table);
+  require_noerr(err, exit);
+  
+  _properties_notify_take(service_table, dirty);
+  
+  for(iid = _properties_notify_next(service_table, dirty, 0); 0 != iid;
+      iid = _properties_notify_next(service_table, dirty, iid)){
+    if( (kNoSpaceErr == _property_tlv_add_value(notify, iid,
+                                                &service_table[g_iid_index[iid].s_idx].properties[g_iid_index[iid].p_idx])) &&
+        (0 != notify->len) ){  // notify full, keep it changed
+      mico_rtos_lock_mutex(&g_dirty_mutex);
+      g_dirty_iids[iid / 32] |= (uint32_t)1 << (iid % 32);
+      mico_rtos_unlock_mutex(&g_dirty_mutex);
+    }
+  }
+  
+exit:
+  return err;
 }
@@ -34,6 +34,20 @@
 #define MAX_PROPERTY_NUMBER_PER_SERVICE        (5)
 #define MAX_SERVICE_NUMBER                     (10)
 
+// a value written by mico_write_properties_str is converted to json object in
+// a stack block of this size, or on the heap if it is longer
+#ifndef MICO_PROP_WRITE_VALUE_ARENA_SIZE
+#define MICO_PROP_WRITE_VALUE_ARENA_SIZE       (128)
+#endif
+
+// TLV messages: item ID of the status code in err message, iid starts from 1
+#define MICO_PROP_TLV_ID_STATUS                (0)
+
+// size of TLV response and notify buffers
+#ifndef MICO_PROP_TLV_BUF_SIZE
+#define MICO_PROP_TLV_BUF_SIZE                 (512)
+#endif
+
 // property value access attribute
 #define MICO_PROP_PERMS_RO                     (0x01)  // can read
 #define MICO_PROP_PERMS_WO                     (0x02)  // can write
@@ -124,10 +138,20 @@ struct mico_prop_t{
   struct mico_prop_t  properties[MAX_PROPERTY_NUMBER_PER_SERVICE];
 };
 
+// TLV message buffer
+typedef struct _mico_prop_tlv_buf_t{
+  uint8_t *buf;
+  size_t size;                               // size of buf
+  size_t len;                                // bytes of TLV items in buf
+}mico_prop_tlv_buf_t;
+
 
 /*******************************************************************************
  *                               FUNCTIONS
  ******************************************************************************/
+// build the iid index of service_table, before other functions are called
+OSStatus mico_properties_init(struct mico_service_t *service_table);
+
 // create dev_info json data
 json_object* mico_get_device_info(struct mico_service_t service_table[]);
 
@@ -137,10 +161,29 @@ json_object* mico_read_properties(struct mico_service_t *service_table,
 // write multiple properties
 json_object* mico_write_properties(struct mico_service_t *service_table,
                                    json_object *prop_write_list_obj);
+// write multiple properties from json text, len = -1 if it ends with '\0'
+OSStatus mico_write_properties_str(struct mico_service_t *service_table,
+                                   const char *prop_write_list_str, int len,
+                                   json_object **outJsonObj);
+
+// mark a property changed, it is sent by the next notify check without polling
+OSStatus mico_property_changed(struct mico_service_t *service_table, struct mico_prop_t *prop);
 
 // properties update check
 OSStatus mico_properties_notify_check(app_context_t * const inContext, 
                                       struct mico_service_t *service_table,
                                       json_object* notify_obj);
 
+// read && write multiple properties, request and response in TLV
+OSStatus mico_read_properties_tlv(struct mico_service_t *service_table,
+                                  const uint8_t *prop_read_list, size_t len,
+                                  mico_prop_tlv_buf_t *out_read, mico_prop_tlv_buf_t *out_err);
+OSStatus mico_write_properties_tlv(struct mico_service_t *service_table,
+                                   const uint8_t *prop_write_list, size_t len,
+                                   mico_prop_tlv_buf_t *out_write, mico_prop_tlv_buf_t *out_err);
+// properties update check, notify in TLV
+OSStatus mico_properties_notify_check_tlv(app_context_t * const inContext,
+                                          struct mico_service_t *service_table,
+                                          mico_prop_tlv_buf_t *notify);
+
 #endif // __MICO_DEVICE_PROPERTIES_H_
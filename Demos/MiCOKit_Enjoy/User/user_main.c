@@ -170,6 +170,10 @@ OSStatus user_main( app_context_t * const app_context )
   require_noerr_action( err, exit, user_log("ERROR: user_uartInit err = %d.", err) );
  
 #if (MICO_CLOUD_TYPE != CLOUD_DISABLED)
+  /* iid index of properties, used by msg handle && notify tasks */
+  err = mico_properties_init(service_table);
+  require_noerr_action( err, exit, user_log("ERROR: mico_properties_init err = %d.", err) );
+
   /* start fogcloud msg handle task */
   err = start_fog_msg_handler(app_context);
   require_noerr_action( err, exit, user_log("ERROR: start_fog_msg_handler err = %d.", err) );
@@ -9,14 +9,13 @@
 
 #include "mico.h"
 #include "MicoAES.h"
-#include "libemqtt.h"
 #include "custom.h"
 #include "micokit_ext.h"
 
 #define baseEvents_log(M, ...) custom_log("BaseEvents", M, ##__VA_ARGS__)
 #define baseEvents_log_trace() custom_log_trace("BaseEvents")
 
-extern mqtt_broker_handle_t broker_mqtt;
+extern OSStatus sitewhere_publish(const uint8_t *data, unsigned int len);
 //mico_Context_t *context;
 /*****************************************************/
 // Update these with values suitable for your network.
@@ -68,7 +67,7 @@ void handlePing(ArduinoCustom_ping ping, char* originator) {
   unsigned int len = 0;
   memset(buffer,0,300);
   if (len = sw_acknowledge(hardwareId, "Ping received.", buffer, sizeof(buffer), originator)) {
-    mqtt_publish(&broker_mqtt,outbound,(char*)buffer,len,0);
+    sitewhere_publish(buffer, len);
   }
 }
 
@@ -76,7 +75,7 @@ void handleMotor(ArduinoCustom_motor motor, char* originator) {
   unsigned int len = 0;
   memset(buffer,0,300);
   if (len = sw_acknowledge(hardwareId, "motor received.", buffer, sizeof(buffer), originator)) {
-    mqtt_publish(&broker_mqtt,outbound,(char*)buffer,len,0);
+    sitewhere_publish(buffer, len);
   }
 }
 
@@ -90,31 +89,22 @@ void handleSerialPrintln(ArduinoCustom_serialPrintln serialPrintln,char* origina
   snprintf(oled_show_line, OLED_DISPLAY_MAX_CHAR_PER_ROW+1, "%s",serialPrintln.message);
   OLED_ShowString(OLED_DISPLAY_COLUMN_START, OLED_DISPLAY_ROW_3, (uint8_t*)oled_show_line);
   if (len = sw_acknowledge(hardwareId, "Message sent to Serial.println().", buffer, sizeof(buffer), originator)) {
-    mqtt_publish(&broker_mqtt,outbound,(char*)buffer,len,0);
+    sitewhere_publish(buffer, len);
   }
 }
 
-device_func cmdd[50];
 /** Handle the 'testEvents' command */
 void handleTestEvents(ArduinoCustom_testData testEvents, char* originator) {
   unsigned int len = 0;
-  memset(buffer,0,300);
-
-  memset(cmdd,0,sizeof(cmdd));
-  cmdd[0].engine.temp="humidity";
-  cmdd[0].engine.value = testEvents.humidity;
-  
-  cmdd[1].engine.temp="temperature";
-  cmdd[1].engine.value = testEvents.temperature;
-  
-  cmdd[2].engine.temp="infrared";
-  cmdd[2].engine.value = testEvents.infrared;
-  
-  cmdd[3].engine.temp="light";
-  cmdd[3].engine.value = testEvents.light;
-  
-  if (len = sw_measurement(hardwareId,&cmdd[0],4,NULL, buffer, sizeof(buffer), originator)) {
-    mqtt_publish(&broker_mqtt,outbound,(char*)buffer,len,0);
+  sw_measurements_t batch;
+
+  sw_measurements_begin(&batch, hardwareId, buffer, sizeof(buffer), originator);
+  sw_measurements_add(&batch, "humidity", testEvents.humidity);
+  sw_measurements_add(&batch, "temperature", testEvents.temperature);
+  sw_measurements_add(&batch, "infrared", testEvents.infrared);
+  sw_measurements_add(&batch, "light", testEvents.light);
+  if (len = sw_measurements_end(&batch, 0)) {
+    sitewhere_publish(buffer, len);
   }
 }
 
@@ -166,30 +156,36 @@ void handleSpecificationCommand(byte* payload, unsigned int length) {
   }
 }
 
+/** Handle a registration acknowledgement */
+static void handleRegistrationAck(const sw_header_t* header, sw_reader_t* body) {
+  sw_field_t field;
+  uint64_t state = 0;
+
+  while (sw_read_field(body, &field)) {
+    if (field.tag == Device_RegistrationAck_state_tag) {
+      state = field.value;
+    }
+  }
+  if (state == Device_RegistrationAckState_NEW_REGISTRATION) {
+    baseEvents_log("Registered new device.");
+    registered = true;
+  } else if (state == Device_RegistrationAckState_ALREADY_REGISTERED) {
+    baseEvents_log("Device was already registered.");
+    registered = true;
+  } else if (state == Device_RegistrationAckState_REGISTRATION_ERROR) {
+    baseEvents_log("Error registering device.");
+  }
+}
+
+/** System commands, in command order */
+static const sw_command_t systemCommands[] = {
+  { Device_Command_REGISTER_ACK, handleRegistrationAck },
+};
+
 /** Handle a system command */
 void handleSystemCommand(byte* payload, unsigned int length) {
-  Device_Header header;
-  pb_istream_t stream = pb_istream_from_buffer(payload, length);
-  
-  // Read header to find what type of command follows.
-  if (pb_decode_delimited(&stream, Device_Header_fields, &header)) {
-    
-    // Handle a registration acknowledgement.
-    if (header.command == Device_Command_REGISTER_ACK) {
-      Device_RegistrationAck ack;
-      if (pb_decode_delimited(&stream, Device_RegistrationAck_fields, &ack)) {
-        if (ack.state == Device_RegistrationAckState_NEW_REGISTRATION) {
-          baseEvents_log("Registered new device.");
-          registered = true;
-        } else if (ack.state == Device_RegistrationAckState_ALREADY_REGISTERED) {
-          baseEvents_log("Device was already registered.");
-          registered = true;
-        } else if (ack.state == Device_RegistrationAckState_REGISTRATION_ERROR) {
-          baseEvents_log("Error registering device.");
-        }
-      }
-    }
-  } else {
+  // Read header to find what type of command follows, and call its handler.
+  if (!sw_dispatch(payload, length, systemCommands, sizeof(systemCommands) / sizeof(systemCommands[0]))) {
     baseEvents_log("Unable to decode system command.");
   }
 }
@@ -23,7 +23,6 @@
 #include "SocketUtils.h"
 #include "MicoAES.h"
 #include "MiCOAppDefine.h"
-#include "libemqtt.h"
 #include "custom.h"
 #include "sitewhere.h"
 #include "micokit_ext.h"
@@ -53,58 +52,16 @@ extern char System1[SYSTEM1_SIZE];
 /** Message buffer */
 extern uint8_t buffer[300];
 
-extern void mqtt_client(void);
-extern void handleSpecificationCommand(byte* payload, unsigned int length);
-extern void handleSystemCommand(byte* payload, unsigned int length);
+extern OSStatus sitewhere_mqtt_start(int fd);
+extern OSStatus sitewhere_mqtt_process(int fd, uint32_t timeout_ms);
+extern void sitewhere_mqtt_stop(void);
+extern OSStatus sitewhere_publish(const uint8_t *data, unsigned int len);
 extern void handleTestEvents(ArduinoCustom_testData testEvents, char* originator);
 
 uint8_t connected_to_ethernet=0;
 extern uint8_t MQTT_REGISTERED;
 extern bool registered;
 
-extern mqtt_broker_handle_t broker_mqtt;
-
-int send_packet(void* socket_info, const void* buf, unsigned int count)
-{
-  return send((int)socket_info, buf, count, 0);
-}
-
-OSStatus sppWlanCommandProcess(unsigned char *inBuf, int *inBufLen, int inSocketFd, mico_Context_t * const inContext)
-{
-  client_log_trace();
-  (void)inSocketFd;
-  (void)inContext;
-  OSStatus err = kUnknownErr;
-  
-  uint8_t *packet_buffer;
-  
-  packet_buffer = inBuf;
-  
-  client_log("Packet Header: 0x%x...\n", packet_buffer[0]);
-  if(MQTTParseMessageType(packet_buffer) == MQTT_MSG_PUBLISH)
-  {
-    uint8_t topic[255], msg[1000];
-    uint16_t len;
-    len = mqtt_parse_pub_topic(packet_buffer, topic);
-    topic[len] = '\0'; // for printf
-    len = mqtt_parse_publish_msg(packet_buffer, msg);
-    msg[len] = '\0';
-    
-    
-    if (strcmp((char*)topic, System1) == 0)
-    {
-      handleSystemCommand(msg, len);
-    }
-    else if (strcmp((char*)topic, Command1) == 0)
-    {
-      handleSpecificationCommand(msg, len);
-    }
-  }
-  
-  *inBufLen = 0;
-  return err;
-}
-
 void sitewhere_main_thread(void *inContext)
 {
   client_log_trace();
@@ -112,11 +69,9 @@ void sitewhere_main_thread(void *inContext)
   int len;
   app_context_t *app_context = inContext;
   struct sockaddr_t addr;
-  fd_set readfds;
   char ipstr[16];
-  struct timeval_t t;
   int remoteTcpClient_fd = -1;
-  uint8_t *inDataBuffer = NULL;
+  uint32_t lastEvent = 0;
   ArduinoCustom_testData testEvents;
   
   uint16_t infrared_data = 0;
@@ -126,9 +81,6 @@ void sitewhere_main_thread(void *inContext)
   
   memset(buffer,0,300);
   
-  inDataBuffer = malloc(1024);
-  require_action(inDataBuffer, exit, err = kNoMemoryErr);
-  
   while(1) {
     if(remoteTcpClient_fd == -1 ) {
       client_log("wifi check...");
@@ -150,68 +102,56 @@ void sitewhere_main_thread(void *inContext)
       require_noerr_quiet(err, ReConnWithDelay);
       client_log("Remote server connected at port: %d, fd: %d",  1883,
                  remoteTcpClient_fd);
-      broker_mqtt.socket_info =(void *)remoteTcpClient_fd;
-      broker_mqtt.send = send_packet;
-      
-      mqtt_client();
+      err = sitewhere_mqtt_start(remoteTcpClient_fd);
+      require_noerr(err, ReConnWithDelay);
       
       connected_to_ethernet =1;
       app_context->appStatus.isCloudConnected = true;
     }
     else{
-      MicoGpioOutputTrigger(MICO_SYS_LED);
+      err = sitewhere_mqtt_process(remoteTcpClient_fd, 1000);
+      if(err != kNoErr) {
+        client_log("Remote client closed, fd: %d", remoteTcpClient_fd);
+        connected_to_ethernet =0;
+        goto ReConnWithDelay;
+      }
       
-      FD_ZERO(&readfds);
-      FD_SET(remoteTcpClient_fd, &readfds);
-      t.tv_sec = 2;
-      t.tv_usec = 0;
-      select(1, &readfds, NULL, NULL, &t);
+      /* upload test data every 2s */
+      if(mico_get_time() - lastEvent < 2000)
+        goto Continue;
+      lastEvent = mico_get_time();
+      MicoGpioOutputTrigger(MICO_SYS_LED);
       
-      /*recv wlan data using remote client fd*/
-      if(MQTT_REGISTERED==1)
+      if(MQTT_REGISTERED==1 && registered)
       {
-        if (FD_ISSET(remoteTcpClient_fd, &readfds)) {
-          len = recv(remoteTcpClient_fd, inDataBuffer, 1024, 0);
-          if(len <= 0) {
-            client_log("Remote client closed, fd: %d", remoteTcpClient_fd);
-            connected_to_ethernet =0;
-            goto ReConnWithDelay;
-          }
-          client_log("recv: %d", len);
-          sppWlanCommandProcess(inDataBuffer, &len, remoteTcpClient_fd, app_context->mico_context);
+        // alert
+        if (len = sw_alert(hardwareId, clientName, "is alive", 0, buffer, sizeof(buffer), NULL)) {
+          sitewhere_publish(buffer, len);
+          client_log("Sent alert.");
+        }
+        // location
+        if (len = sw_location(hardwareId, 31.00f, 121.00f, 0.0f, 0, buffer, sizeof(buffer), NULL)) {
+          sitewhere_publish(buffer, len);
+          client_log("Sent location.");
         }
-        else{ // no message received, just upload test data every 2s.
-          if(registered){
-            // alert
-            if (len = sw_alert(hardwareId, clientName, "is alive", NULL, buffer, sizeof(buffer), NULL)) {
-              mqtt_publish(&broker_mqtt,outbound,(char*)buffer,len,0);
-              client_log("Sent alert.");
-            }
-            // location
-            if (len = sw_location(hardwareId, 31.00f, 121.00f, 0.0f, NULL, buffer, sizeof(buffer), NULL)) {
-              mqtt_publish(&broker_mqtt,outbound,(char*)buffer,len,0);
-              client_log("Sent location.");
-            }
-            
-            // upload test data
-            temp_hum_sensor_read(&temperature, &humidity);
-            infrared_reflective_read(&infrared_data);
-            light_sensor_read(&light_data);
-            if((temperature > 0) && (humidity > 0)){
-              app_context->appStatus.user_context.status.temperature = temperature;
-              app_context->appStatus.user_context.status.humidity = humidity;
-            }
-            app_context->appStatus.user_context.status.light_sensor_data = light_data;
-            app_context->appStatus.user_context.status.infrared_reflective_data = infrared_data;
-            
-            testEvents.temperature = app_context->appStatus.user_context.status.temperature;
-            testEvents.humidity = app_context->appStatus.user_context.status.humidity;
-            testEvents.infrared = app_context->appStatus.user_context.status.infrared_reflective_data;
-            testEvents.light = app_context->appStatus.user_context.status.light_sensor_data;
-            handleTestEvents(testEvents, NULL);
-            client_log("Sent test data.");
-          }
+        
+        // upload test data
+        temp_hum_sensor_read(&temperature, &humidity);
+        infrared_reflective_read(&infrared_data);
+        light_sensor_read(&light_data);
+        if((temperature > 0) && (humidity > 0)){
+          app_context->appStatus.user_context.status.temperature = temperature;
+          app_context->appStatus.user_context.status.humidity = humidity;
         }
+        app_context->appStatus.user_context.status.light_sensor_data = light_data;
+        app_context->appStatus.user_context.status.infrared_reflective_data = infrared_data;
+        
+        testEvents.temperature = app_context->appStatus.user_context.status.temperature;
+        testEvents.humidity = app_context->appStatus.user_context.status.humidity;
+        testEvents.infrared = app_context->appStatus.user_context.status.infrared_reflective_data;
+        testEvents.light = app_context->appStatus.user_context.status.light_sensor_data;
+        handleTestEvents(testEvents, NULL);
+        client_log("Sent test data.");
       }
       
     Continue:
@@ -221,14 +161,13 @@ void sitewhere_main_thread(void *inContext)
       
       app_context->appStatus.isCloudConnected = false;
       if(remoteTcpClient_fd != -1){
+        sitewhere_mqtt_stop();
         SocketClose(&remoteTcpClient_fd);
       }
       sleep(CLOUD_RETRY);
     }
   }
   
-exit:
-  if(inDataBuffer) free(inDataBuffer);
   client_log("Exit: local client exit with err = %d", err);
   mico_rtos_delete_thread(NULL);
   return;
@@ -6,23 +6,21 @@
 
 
 /****************************************************/
-#include "time.h"
 #include "MicoAES.h"
 
 #include "mico.h"
-#include "libemqtt.h"
+#include "SocketUtils.h"
+#include "mqtt_client.h"
 #include "custom.h"
 
 #define mqtt(M, ...) custom_log("MICO", M, ##__VA_ARGS__)
 #define mqtt_log_trace() custom_log_trace("MICO")
 
-mqtt_broker_handle_t broker_mqtt;
-mico_Context_t *context;
-/*****************************************************/
-void loop(void);
+#define MQTT_KEEP_ALIVE     60
+#define MQTT_MSG_SLOTS      4     // Messages queued for sending, the events are encoded in one shared buffer
 
-/** Callback function header */
-void callback(char* topic, byte* payload, unsigned int length);
+mqtt_client_t sitewhere_mqtt;
+/*****************************************************/
 
 /** Message buffer */
 extern uint8_t buffer[300];
@@ -30,15 +28,6 @@ extern uint8_t buffer[300];
 /** Keeps up with whether we have registered */
 extern bool registered;
 
-
-
-/** Timestamp for last event */
-uint32_t lastEvent = 0;
-
-/** MQTT client name */
-
-extern char* clientName;
-
 /** Unique hardware id for this device */
 extern char hardwareId[HARDWARE_ID_SIZE];
 
@@ -54,136 +43,159 @@ extern char Command1[COMMAND1_SIZE];
 /** Inbound system command topic */
 extern char System1[SYSTEM1_SIZE];
 
-#define RCVBUFSIZE 1024
-uint8_t packet_buffer[RCVBUFSIZE];
+extern void handleSpecificationCommand(byte* payload, unsigned int length);
+extern void handleSystemCommand(byte* payload, unsigned int length);
 
-int read_packet(int timeout,mqtt_broker_handle_t* broker)
-{
-  int socket_id = (int)broker->socket_info;
+static uint8_t mqtt_tx_buffer[512];
+static uint8_t mqtt_rx_buffer[1024];
 
-  if(timeout > 0)
-  {
-    fd_set readfds;
-
-    // Initialize the file descriptor set
-    FD_ZERO (&readfds);
-    FD_SET (socket_id, &readfds);
-  }
+/* A message stays here until the client is done with it */
+static uint8_t mqtt_msg[MQTT_MSG_SLOTS][sizeof(buffer)];
+static bool mqtt_msg_used[MQTT_MSG_SLOTS];
 
-  int total_bytes = 0, bytes_rcvd, packet_length;
-  memset(packet_buffer, 0, sizeof(packet_buffer));
+static uint8_t mqtt_subscriptions = 0;
+uint8_t MQTT_REGISTERED = 0;
 
-  if((bytes_rcvd = read(socket_id, (packet_buffer+total_bytes), RCVBUFSIZE)) <= 0) {
-    return -1;
-  }
-
-  total_bytes += bytes_rcvd; // Keep tally of total bytes
-  if (total_bytes < 2)
-    return -1;
-
-  // now we have the full fixed header in packet_buffer
-  // parse it for remaining length and number of bytes
-  uint16_t rem_len = mqtt_parse_rem_len(packet_buffer);
-  uint8_t rem_len_bytes = mqtt_num_rem_len_bytes(packet_buffer);
+/** Queue a message to the outbound topic, data is copied */
+OSStatus sitewhere_publish(const uint8_t *data, unsigned int len)
+{
+  OSStatus err = kNoResourcesErr;
+  int i;
 
-  //packet_length = packet_buffer[1] + 2; // Remaining length + fixed header length
-  // total packet length = remaining length + byte 1 of fixed header + remaning length part of fixed header
-  packet_length = rem_len + rem_len_bytes + 1;
+  require_action(len <= sizeof(mqtt_msg[0]), exit, err = kSizeErr);
 
-  while(total_bytes < packet_length) // Reading the packet
-  {
-    if((bytes_rcvd = read(socket_id, (packet_buffer+total_bytes), RCVBUFSIZE)) <= 0)
-      return -1;
-    total_bytes += bytes_rcvd; // Keep tally of total bytes
+  for(i = 0; i < MQTT_MSG_SLOTS; i++) {
+    if(!mqtt_msg_used[i]) break;
   }
+  require_quiet(i < MQTT_MSG_SLOTS, exit);
 
-  return packet_length;
-}
-
+  memcpy(mqtt_msg[i], data, len);
+  mqtt_msg_used[i] = true;
+  err = mqtt_client_publish(&sitewhere_mqtt, outbound, mqtt_msg[i], len, 0, false, &mqtt_msg_used[i], NULL);
+  if(err != kNoErr) mqtt_msg_used[i] = false;
 
+exit:
+  if(err != kNoErr) mqtt("Message of %d bytes dropped, err = %d", len, err);
+  return err;
+}
 
-int len = 0;
-uint8_t MQTT_REGISTERED =0;
-/** Set up processing */
-void mqtt_client()
+static void mqtt_connected(mqtt_client_t *client, uint8_t return_code, bool session_present)
 {
-    mqtt("Connected to ethernet.");
-    
-    strcpy(broker_mqtt.clientid,hardwareId);
-    mqtt_init(&broker_mqtt,hardwareId);
-
-    mqtt_connect(&broker_mqtt);
-    read_packet(10,&broker_mqtt);
-    if(MQTTParseMessageType(packet_buffer) == MQTT_MSG_CONNACK)
-    {
-        mqtt("Connected to MQTT.");
-    }
-
-  if(packet_buffer[3] == 0x00)
-  {
-        mqtt("CONNACK successed!\n");
-        mqtt_subscribe(&broker_mqtt,Command1,0);
-        read_packet(10,&broker_mqtt);
+  (void)client;
+  (void)session_present;
+  if(return_code == 0)
+    mqtt("CONNACK successed!");
+  else
+    mqtt("CONNACK failed, return code %d", return_code);
+}
 
-        if(MQTTParseMessageType(packet_buffer) != MQTT_MSG_SUBACK)
-        {
-            mqtt("SUBACK expected!\n");
-            return;
-        }
+static void mqtt_message(mqtt_client_t *client, const char *topic, uint16_t topic_len,
+                         const uint8_t *payload, uint32_t len, uint8_t qos, bool retain)
+{
+  (void)client;
+  (void)qos;
+  (void)retain;
+
+  if(topic_len == strlen(System1) && memcmp(topic, System1, topic_len) == 0)
+    handleSystemCommand((byte*)payload, len);
+  else if(topic_len == strlen(Command1) && memcmp(topic, Command1, topic_len) == 0)
+    handleSpecificationCommand((byte*)payload, len);
+}
 
+static void mqtt_published(mqtt_client_t *client, uint16_t packet_id, void *arg, OSStatus err)
+{
+  (void)client;
+  (void)packet_id;
+  (void)err;
+  *(bool *)arg = false;
+}
 
-        mqtt_subscribe(&broker_mqtt,System1,0);
-        read_packet(10,&broker_mqtt);
+/* Both topics subscribed: register the device */
+static void mqtt_subscribed(mqtt_client_t *client, uint16_t packet_id, uint8_t return_code)
+{
+  unsigned int len;
 
-        if(MQTTParseMessageType(packet_buffer) != MQTT_MSG_SUBACK)
-        {
-            mqtt("SUBACK expected!\n");
-            return;
-        }
+  (void)client;
+  (void)packet_id;
+  if(return_code == 0x80) {
+    mqtt("SUBACK failed!");
+    return;
+  }
+  if(++mqtt_subscriptions < 2) return;
 
-        mqtt("subscirbe successed");
+  mqtt("subscirbe successed");
+  if((len = sw_register(hardwareId, specificationToken, buffer, sizeof(buffer), NULL)) != 0) {
+    if(sitewhere_publish(buffer, len) == kNoErr) {
+      MQTT_REGISTERED = 1;
+      mqtt("Sent registration.");
+    }
+  }
+}
 
-        if (len = sw_register(hardwareId, specificationToken, buffer, sizeof(buffer), NULL))
-        {
-            mqtt_publish(&broker_mqtt,outbound,(char*)buffer,len,0);
-            MQTT_REGISTERED =1;
-            mqtt("Sent registration.");
+/** Start a session on a connected socket, run it with sitewhere_mqtt_process() */
+OSStatus sitewhere_mqtt_start(int fd)
+{
+  OSStatus err;
+  mqtt_client_config_t config;
+  int opt = 1;
+
+  memset(&config, 0, sizeof(config));
+  config.client_id = hardwareId;
+  config.keep_alive = MQTT_KEEP_ALIVE;
+  config.clean_session = true;
+  config.tx_buf = mqtt_tx_buffer;
+  config.tx_size = sizeof(mqtt_tx_buffer);
+  config.rx_buf = mqtt_rx_buffer;
+  config.rx_size = sizeof(mqtt_rx_buffer);
+  config.callbacks.connected = mqtt_connected;
+  config.callbacks.message = mqtt_message;
+  config.callbacks.published = mqtt_published;
+  config.callbacks.subscribed = mqtt_subscribed;
+
+  memset(mqtt_msg_used, 0, sizeof(mqtt_msg_used));
+  mqtt_subscriptions = 0;
+  MQTT_REGISTERED = 0;
+
+  err = mqtt_client_init(&sitewhere_mqtt, &config);
+  require_noerr(err, exit);
+
+  setsockopt(fd, SOL_SOCKET, SO_BLOCKMODE, &opt, sizeof(opt));
+
+  // Sent after CONNACK
+  err = mqtt_client_subscribe(&sitewhere_mqtt, Command1, 0, NULL);
+  require_noerr(err, exit);
+  err = mqtt_client_subscribe(&sitewhere_mqtt, System1, 0, NULL);
+  require_noerr(err, exit);
+
+  err = mqtt_client_connect(&sitewhere_mqtt, fd);
+  require_noerr(err, exit);
+  mqtt("Connecting to MQTT.");
+
+exit:
+  return err;
+}
 
-        }
+/** Wait up to timeout_ms for the socket and run the client, an error ends the connection */
+OSStatus sitewhere_mqtt_process(int fd, uint32_t timeout_ms)
+{
+  fd_set readfds, writefds;
+  struct timeval_t t;
+
+  FD_ZERO(&readfds);
+  FD_ZERO(&writefds);
+  FD_SET(fd, &readfds);
+  if(mqtt_client_want_write(&sitewhere_mqtt))
+    FD_SET(fd, &writefds);
+  t.tv_sec = timeout_ms / 1000;
+  t.tv_usec = ( timeout_ms % 1000 ) * 1000;
+  select(fd + 1, &readfds, &writefds, NULL, &t);
+
+  return mqtt_client_process(&sitewhere_mqtt);
+}
 
-  }
-  else
-  {
-      mqtt("CONNACK failed!\n");
-  }
+/** Forget the session after the socket is closed */
+void sitewhere_mqtt_stop(void)
+{
+  mqtt_client_close(&sitewhere_mqtt);
+  MQTT_REGISTERED = 0;
 }
-uint32_t now_event;
-uint8_t MICO_report[15];
-
-
-
-///** Main MQTT processing loop */
-//void mqtt_loop_thread(void *inContext)
-//{
-//  /** Only send events after registered and at most every five seconds */
-//    while(1)
-//    {
-//            if (registered){
-//                memset(buffer,0,300);
-//                unsigned int len = 0;
-//
-//                // alert
-//                if (len = sw_alert(hardwareId, clientName, "is alive", NULL, buffer, sizeof(buffer), NULL)) {
-//                    mqtt_publish(&broker_mqtt,outbound,(char*)buffer,len,0);
-//                    mqtt("Sent alert.");
-//                }
-//                // location
-//                if (len = sw_location(hardwareId, 31.05f, 121.76f, 0.0f, NULL, buffer, sizeof(buffer), NULL)) {
-//                  mqtt_publish(&broker_mqtt,outbound,(char*)buffer,len,0);
-//                  mqtt("Sent location.");
-//                }
-//                
-//                sleep(15);
-//            }
-//    }
-//}
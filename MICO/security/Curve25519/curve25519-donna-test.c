@@ -50,18 +50,105 @@
 	Copyright (C) 2012-2013 Apple Inc. All Rights Reserved.
 */
 
-#include "CommonServices.h"
+/*
+	Runs on the target, or on the host. The reference is the portable 64-bit limb version built a second time with 
+	its function renamed; MICO/system/host holds the stub platform headers. Add -DCURVE25519_BASE_TABLE=1 to test the 
+	fixed-base table of the 32-bit version as well:
+	
+	cc -O2 -DCURVE25519_64_BIT=0 -DCURVE25519_32_BIT=0 -Dcurve25519_donna=curve25519_donna_ref \
+		-c MICO/security/Curve25519/curve25519-donna.c -o curve25519-ref.o
+	cc -O2 -DDEBUG=0 -DCURVE25519_64_BIT=0 -DCURVE25519_TEST_MAIN -DCURVE25519_TEST_REFERENCE \
+		-IMICO/system/host -Iinclude -IMICO/security/Curve25519 \
+		MICO/security/Curve25519/curve25519-donna-test.c MICO/security/Curve25519/curve25519-donna.c \
+		curve25519-ref.o -o curve25519-test && ./curve25519-test
+*/
+
+#include "Common.h"
 #include "curve25519-donna.h"
-#include "DebugServices.h"
-#include "StringUtils.h"
+#include "Debug.h"
+
+#if( defined( CURVE25519_TEST_MAIN ) )
+	#include <time.h>
+#endif
 
 //===========================================================================================================================
 //	Internals
 //===========================================================================================================================
 
 OSStatus	curve25519_test( int print );
+OSStatus	curve25519_equivalence_test( int print );
+OSStatus	curve25519_bench( void );
 int			curve25519_djb_test( int print );
 
+#if( CURVE25519_TEST_REFERENCE )
+void		curve25519_donna_ref( unsigned char *outKey, const unsigned char *inSecret, const unsigned char *inBasePoint );
+#endif
+
+#define countof( X )		( sizeof( X ) / sizeof( ( X )[ 0 ] ) )
+
+//===========================================================================================================================
+//	curve25519_hex
+//===========================================================================================================================
+
+static OSStatus	curve25519_hex( const char *inHex, uint8_t outData[ 32 ] )
+{
+	OSStatus		err;
+	size_t			i;
+	int				hi, lo;
+	
+	require_action( strlen( inHex ) == 64, exit, err = kSizeErr );
+	for( i = 0; i < 32; ++i )
+	{
+		hi = inHex[ 2 * i ];
+		lo = inHex[ 2 * i + 1 ];
+		require_action( isxdigit( hi ) && isxdigit( lo ), exit, err = kMalformedErr );
+		hi = isdigit( hi ) ? ( hi - '0' ) : ( tolower( hi ) - 'a' + 10 );
+		lo = isdigit( lo ) ? ( lo - '0' ) : ( tolower( lo ) - 'a' + 10 );
+		outData[ i ] = (uint8_t)( ( hi << 4 ) | lo );
+	}
+	err = kNoErr;
+	
+exit:
+	return( err );
+}
+
+//===========================================================================================================================
+//	curve25519_ticks_ms
+//===========================================================================================================================
+
+static double	curve25519_ticks_ms( void )
+{
+#if( defined( CURVE25519_TEST_MAIN ) )
+	struct timespec		ts;
+	
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return( ( ts.tv_sec * 1000.0 ) + ( ts.tv_nsec / 1000000.0 ) );
+#else
+	return( (double) mico_get_time() );
+#endif
+}
+
+//===========================================================================================================================
+//	curve25519_random
+//
+//	Fixed xorshift sequence so a failure can be repeated.
+//===========================================================================================================================
+
+static void	curve25519_random( uint32_t *ioState, uint8_t outData[ 32 ] )
+{
+	size_t		i;
+	uint32_t	x = *ioState;
+	
+	for( i = 0; i < 32; ++i )
+	{
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		outData[ i ] = (uint8_t)( x >> 24 );
+	}
+	*ioState = x;
+}
+
 //===========================================================================================================================
 //	Test Vectors
 //===========================================================================================================================
@@ -162,24 +249,21 @@ OSStatus	curve25519_test( int print )
 {
 	OSStatus			err;
 	uint8_t				e[ 32 ], k[ 32 ], ek[ 32 ], ek2[ 32 ];
-	size_t				i, j, len;
-	CFAbsoluteTime		t = 0;
+	size_t				i, j;
+	double				t = 0;
 	
 	for( i = 0; i < countof( kCurve25519TestVectors ); ++i )
 	{
 		const curve25519_test_vector * const 	tv = &kCurve25519TestVectors[ i ];
 		
-		err = HexToData( tv->e, kSizeCString, kHexToData_NoFlags, e, sizeof( e ), &len, NULL, NULL );
+		err = curve25519_hex( tv->e, e );
 		require_noerr( err, exit );
-		require_action( len == 32, exit, err = kSizeErr );
 		
-		err = HexToData( tv->k, kSizeCString, kHexToData_NoFlags, k, sizeof( k ), &len, NULL, NULL );
+		err = curve25519_hex( tv->k, k );
 		require_noerr( err, exit );
-		require_action( len == 32, exit, err = kSizeErr );
 		
-		err = HexToData( tv->ek, kSizeCString, kHexToData_NoFlags, ek, sizeof( ek ), &len, NULL, NULL );
+		err = curve25519_hex( tv->ek, ek );
 		require_noerr( err, exit );
-		require_action( len == 32, exit, err = kSizeErr );
 		
 		memset( ek2, 0, sizeof( ek2 ) );
 		curve25519_donna( ek2, e, k );
@@ -187,22 +271,114 @@ OSStatus	curve25519_test( int print )
 		
 		if( print )
 		{
-			for( j = 0; j < 32; ++j ) printf( "%02x", e[ j ] );  printf( " " );
-			for( j = 0; j < 32; ++j ) printf( "%02x", k[ j ] );  printf( " " );
-			for( j = 0; j < 32; ++j ) printf( "%02x", ek[ j ] ); printf( "\n" );
+			for( j = 0; j < 32; ++j ) { printf( "%02x", e[ j ] ); }
+			printf( " " );
+			for( j = 0; j < 32; ++j ) { printf( "%02x", k[ j ] ); }
+			printf( " " );
+			for( j = 0; j < 32; ++j ) { printf( "%02x", ek[ j ] ); }
+			printf( "\n" );
 		}
 	}
 	
-	t = CFAbsoluteTimeGetCurrent();
+	t = curve25519_ticks_ms();
 	err = curve25519_djb_test( print );
 	require_noerr( err, exit );
-	t = CFAbsoluteTimeGetCurrent() - t;
+	t = ( curve25519_ticks_ms() - t ) / 1000.0;
+	
+	err = curve25519_equivalence_test( print );
+	require_noerr( err, exit );
 	
 exit:
-	FPrintF( stdout, "%###s: %s (%f seconds)\n", __ROUTINE__, !err ? "PASSED" : "FAILED", t );
+	printf( "%s: %s (%f seconds)\n", __FUNCTION__, !err ? "PASSED" : "FAILED", t );
 	return( err );
 }
 
+//===========================================================================================================================
+//	curve25519_equivalence_test
+//
+//	With CURVE25519_BASE_TABLE, the base point goes through the precomputed table of the 32-bit version, and through 
+//	the ladder when it's given as 9 + p, which is 9 as well. Both must match each other and the reference.
+//===========================================================================================================================
+
+static const uint8_t		kCurve25519BasePointPlusP[ 32 ] =
+{
+	0xf6, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
+	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x7f
+};
+
+OSStatus	curve25519_equivalence_test( int print )
+{
+	OSStatus		err;
+	uint32_t		state = 0x25519;
+	uint8_t			e[ 32 ], k[ 32 ], ek[ 32 ], ek2[ 32 ];
+	size_t			i;
+	
+	for( i = 0; i < 1000; ++i )
+	{
+		curve25519_random( &state, e );
+		curve25519_random( &state, k );
+		
+		curve25519_donna( ek, e, NULL );
+		curve25519_donna( ek2, e, kCurve25519BasePointPlusP );
+		require_action( memcmp( ek, ek2, 32 ) == 0, exit, err = kMismatchErr );
+		
+	#if( CURVE25519_TEST_REFERENCE )
+		curve25519_donna_ref( ek2, e, NULL );
+		require_action( memcmp( ek, ek2, 32 ) == 0, exit, err = kMismatchErr );
+		
+		curve25519_donna( ek, e, k );
+		curve25519_donna_ref( ek2, e, k );
+		require_action( memcmp( ek, ek2, 32 ) == 0, exit, err = kMismatchErr );
+	#endif
+	}
+	err = kNoErr;
+	
+exit:
+	if( print || err ) printf( "%s: %s after %u keys\n", __FUNCTION__, !err ? "PASSED" : "FAILED", (unsigned int) i );
+	return( err );
+}
+
+//===========================================================================================================================
+//	curve25519_bench
+//===========================================================================================================================
+
+OSStatus	curve25519_bench( void )
+{
+	uint32_t		state = 0x25519;
+	uint8_t			e[ 32 ], k[ 32 ], ek[ 32 ];
+	double			t;
+	int				i, n = 200;
+	
+	curve25519_random( &state, e );
+	curve25519_random( &state, k );
+	
+	t = curve25519_ticks_ms();
+	for( i = 0; i < n; ++i ) { curve25519_donna( ek, e, k ); e[ 0 ] ^= ek[ 0 ]; }
+	printf( "shared secret (ladder):       %8.1f us\n", ( ( curve25519_ticks_ms() - t ) * 1000.0 ) / n );
+	
+	t = curve25519_ticks_ms();
+	for( i = 0; i < n; ++i ) { curve25519_donna( ek, e, NULL ); e[ 0 ] ^= ek[ 0 ]; }
+	printf( "public key (base point):      %8.1f us\n", ( ( curve25519_ticks_ms() - t ) * 1000.0 ) / n );
+	
+#if( CURVE25519_TEST_REFERENCE )
+	t = curve25519_ticks_ms();
+	for( i = 0; i < n; ++i ) { curve25519_donna_ref( ek, e, k ); e[ 0 ] ^= ek[ 0 ]; }
+	printf( "reference, any point:         %8.1f us\n", ( ( curve25519_ticks_ms() - t ) * 1000.0 ) / n );
+#endif
+	return( kNoErr );
+}
+
+#if( defined( CURVE25519_TEST_MAIN ) )
+int	main( void )
+{
+	OSStatus		err;
+	
+	err = curve25519_test( 0 );
+	if( !err ) curve25519_bench();
+	return( err ? 1 : 0 );
+}
+#endif
+
 //===========================================================================================================================
 //	curve25519_djb_test
 //
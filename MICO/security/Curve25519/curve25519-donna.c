@@ -80,10 +80,23 @@
 	#endif
 #endif
 
-// Conditionally include the 64-bit version if we're building for a 64-bit platform.
+// CURVE25519_32_BIT
+
+#if( !defined( CURVE25519_32_BIT ) )
+	#if( CURVE25519_64_BIT )
+		#define	CURVE25519_32_BIT		0
+	#else
+		#define	CURVE25519_32_BIT		1
+	#endif
+#endif
+
+// Conditionally include the 64-bit version if we're building for a 64-bit platform and the 32-bit limb version for 
+// 32-bit platforms. The portable version below is used when both are turned off.
 
 #if( CURVE25519_64_BIT )
 	#include "curve25519-donna-c64.c"
+#elif( CURVE25519_32_BIT )
+	#include "curve25519-donna-c32.c"
 #else
 
 // 32-bit/portable version...
@@ -827,6 +840,6 @@ curve25519_donna(u8 *mypublic, const u8 *secret, const u8 *basepoint) {
   fcontract(mypublic, z);
 }
 
-#endif // !CURVE25519_64_BIT
+#endif // !CURVE25519_64_BIT && !CURVE25519_32_BIT
 
 
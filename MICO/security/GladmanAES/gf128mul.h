@@ -134,19 +134,25 @@ Issue Date: 11/01/2011
 
 /*  Table sizes for GF(128) Multiply.  Normally larger tables give 
     higher speed but cache loading might change this. Normally only 
-    one table size (or none at all) will be specified here
+    one table size (or none at all) will be specified here.
+    The table is held in each GCM context, so it can be chosen per 
+    build with GF_TABLES_SIZE (65536, 8192, 4096, 256 or 0 bytes) to
+    trade RAM for GHASH speed. 4096 is used if it is not given.
 */
-#if 0
-#  define TABLES_64K
+#if !defined( GF_TABLES_SIZE )
+#  define GF_TABLES_SIZE 4096
 #endif
-#if 0
+
+#if GF_TABLES_SIZE == 65536
+#  define TABLES_64K
+#elif GF_TABLES_SIZE == 8192
 #  define TABLES_8K
-#endif
-#if 1
+#elif GF_TABLES_SIZE == 4096
 #  define TABLES_4K
-#endif
-#if 0
+#elif GF_TABLES_SIZE == 256
 #  define TABLES_256
+#elif GF_TABLES_SIZE != 0
+#  error GF_TABLES_SIZE must be 65536, 8192, 4096, 256 or 0
 #endif
 
 /* END OF USER DEFINABLE OPTIONS */
@@ -183,7 +189,7 @@ typedef gf_t    gf_t64k_a[16][256];
 typedef gf_t    (*gf_t64k_t)[256];
 
 void init_64k_table(const gf_t g, gf_t64k_t t);
-void gf_mul_64k(gf_t a, const gf_t64k_t t, void *r);
+void gf_mul_64k(gf_t a, const gf_t64k_t t, gf_t r);
 
 /* types and calls for 8k table driven field multiplier        */
 
@@ -155,7 +155,8 @@ int hkdfExpand(SHAversion whichSha, const uint8_t prk[ ], int prk_len,
 {
   int hash_len, N;
   unsigned char T[USHAMaxHashSize];
-  int Tlen, where, i;
+  int Tlen, where, i, ret;
+  HMACKeyContext key;
 
   if (info == 0) {
     info = (const unsigned char *)"";
@@ -172,16 +173,20 @@ int hkdfExpand(SHAversion whichSha, const uint8_t prk[ ], int prk_len,
   if ((okm_len % hash_len) != 0) N++;
   if (N > 255) return shaBadParam;
 
+  /* the pads of prk are hashed once for all of T(1)..T(N) */
+  ret = hmacSetKey(&key, whichSha, prk, prk_len);
+  if (ret != shaSuccess) return ret;
+
   Tlen = 0;
   where = 0;
   for (i = 1; i <= N; i++) {
     HMACContext context;
     unsigned char c = i;
-    int ret = hmacReset(&context, whichSha, prk, prk_len) ||
-              hmacInput(&context, T, Tlen) ||
-              hmacInput(&context, info, info_len) ||
-              hmacInput(&context, &c, 1) ||
-              hmacResult(&context, T);
+    ret = hmacResetWithKey(&context, &key) ||
+          hmacInput(&context, T, Tlen) ||
+          hmacInput(&context, info, info_len) ||
+          hmacInput(&context, &c, 1) ||
+          hmacResult(&context, T);
     if (ret != shaSuccess) return ret;
     memcpy(okm + where, T,
            (i != N) ? hash_len : (okm_len - where));
@@ -223,13 +228,16 @@ int hkdfReset(HKDFContext *context, enum SHAversion whichSha,
 
   context->whichSha = whichSha;
   context->hashSize = USHAHashSize(whichSha);
+  context->Computed = 0;
+  context->Corrupted = shaSuccess;
   if (salt == 0) {
     salt = nullSalt;
     salt_len = context->hashSize;
     memset(nullSalt, '\0', salt_len);
   }
 
-  return hmacReset(&context->hmacContext, whichSha, salt, salt_len);
+  return context->Corrupted =
+    hmacReset(&context->hmacContext, whichSha, salt, salt_len);
 }
 
 /*
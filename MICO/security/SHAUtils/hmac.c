@@ -54,44 +54,40 @@ int hmac(SHAversion whichSha,
 }
 
 /*
- *  hmacReset
+ *  hmacKeyPads
  *
  *  Description:
- *      This function will initialize the hmacContext in preparation
- *      for computing a new HMAC message digest.
+ *      This helper function will fill the inner and outer pads
+ *      with the key, hashing the key first if it is longer than
+ *      the block size.
  *
  *  Parameters:
- *      context: [in/out]
- *          The context to reset.
  *      whichSha: [in]
  *          One of SHA1, SHA224, SHA256, SHA384, SHA512
  *      key[ ]: [in]
  *          The secret shared key.
  *      key_len: [in]
  *          The length of the secret shared key.
+ *      k_ipad[ ]: [out]
+ *          The key XORd with ipad, block size octets.
+ *      k_opad[ ]: [out]
+ *          The key XORd with opad, block size octets.
  *
  *  Returns:
  *      sha Error Code.
  *
  */
-int hmacReset(HMACContext *context, enum SHAversion whichSha,
-    const unsigned char *key, int key_len)
+static int hmacKeyPads(enum SHAversion whichSha,
+    const unsigned char *key, int key_len,
+    unsigned char k_ipad[ ], unsigned char k_opad[ ])
 {
-  int i, blocksize, hashsize, ret;
-
-  /* inner padding - key XORd with ipad */
-  unsigned char k_ipad[USHA_Max_Message_Block_Size];
+  int i, blocksize, hashsize;
 
   /* temporary buffer when keylen > blocksize */
   unsigned char tempkey[USHAMaxHashSize];
 
-  if (!context) return shaNull;
-  context->Computed = 0;
-  context->Corrupted = shaSuccess;
-
-  blocksize = context->blockSize = USHABlockSize(whichSha);
-  hashsize = context->hashSize = USHAHashSize(whichSha);
-  context->whichSha = whichSha;
+  blocksize = USHABlockSize(whichSha);
+  hashsize = USHAHashSize(whichSha);
 
   /*
    * If key is longer than the hash blocksize,
@@ -122,22 +118,151 @@ int hmacReset(HMACContext *context, enum SHAversion whichSha,
   /* store key into the pads, XOR'd with ipad and opad values */
   for (i = 0; i < key_len; i++) {
     k_ipad[i] = key[i] ^ 0x36;
-    context->k_opad[i] = key[i] ^ 0x5c;
+    k_opad[i] = key[i] ^ 0x5c;
   }
   /* remaining pad bytes are '\0' XOR'd with ipad and opad values */
   for ( ; i < blocksize; i++) {
     k_ipad[i] = 0x36;
-    context->k_opad[i] = 0x5c;
+    k_opad[i] = 0x5c;
   }
 
+  return shaSuccess;
+}
+
+/*
+ *  hmacReset
+ *
+ *  Description:
+ *      This function will initialize the hmacContext in preparation
+ *      for computing a new HMAC message digest.
+ *
+ *  Parameters:
+ *      context: [in/out]
+ *          The context to reset.
+ *      whichSha: [in]
+ *          One of SHA1, SHA224, SHA256, SHA384, SHA512
+ *      key[ ]: [in]
+ *          The secret shared key.
+ *      key_len: [in]
+ *          The length of the secret shared key.
+ *
+ *  Returns:
+ *      sha Error Code.
+ *
+ */
+int hmacReset(HMACContext *context, enum SHAversion whichSha,
+    const unsigned char *key, int key_len)
+{
+  int ret;
+
+  /* inner padding - key XORd with ipad */
+  unsigned char k_ipad[USHA_Max_Message_Block_Size];
+
+  if (!context) return shaNull;
+  context->Computed = 0;
+  context->Corrupted = shaSuccess;
+  context->keyContext = 0;
+
+  context->blockSize = USHABlockSize(whichSha);
+  context->hashSize = USHAHashSize(whichSha);
+  context->whichSha = whichSha;
+
+  ret = hmacKeyPads(whichSha, key, key_len, k_ipad, context->k_opad);
+  if (ret != shaSuccess) return context->Corrupted = ret;
+
   /* perform inner hash */
   /* init context for 1st pass */
   ret = USHAReset(&context->shaContext, whichSha) ||
         /* and start with inner pad */
-        USHAInput(&context->shaContext, k_ipad, blocksize);
+        USHAInput(&context->shaContext, k_ipad, context->blockSize);
   return context->Corrupted = ret;
 }
 
+/*
+ *  hmacSetKey
+ *
+ *  Description:
+ *      This function will hash the inner and outer pads of a key
+ *      once, so that hmacResetWithKey() can start each message
+ *      authenticated with it from these states instead of hashing
+ *      the pads again.
+ *
+ *  Parameters:
+ *      keyContext: [out]
+ *          The key context to set.
+ *      whichSha: [in]
+ *          One of SHA1, SHA224, SHA256, SHA384, SHA512
+ *      key[ ]: [in]
+ *          The secret shared key.
+ *      key_len: [in]
+ *          The length of the secret shared key.
+ *
+ *  Returns:
+ *      sha Error Code.
+ *
+ */
+int hmacSetKey(HMACKeyContext *keyContext, enum SHAversion whichSha,
+    const unsigned char *key, int key_len)
+{
+  int ret;
+
+  /* inner and outer padding - key XORd with ipad and opad */
+  unsigned char k_ipad[USHA_Max_Message_Block_Size];
+  unsigned char k_opad[USHA_Max_Message_Block_Size];
+
+  if (!keyContext) return shaNull;
+
+  keyContext->blockSize = USHABlockSize(whichSha);
+  keyContext->hashSize = USHAHashSize(whichSha);
+  keyContext->whichSha = whichSha;
+
+  ret = hmacKeyPads(whichSha, key, key_len, k_ipad, k_opad);
+  if (ret != shaSuccess) return keyContext->Corrupted = ret;
+
+  ret = USHAReset(&keyContext->ipadContext, whichSha) ||
+        USHAInput(&keyContext->ipadContext, k_ipad,
+                  keyContext->blockSize) ||
+        USHAReset(&keyContext->opadContext, whichSha) ||
+        USHAInput(&keyContext->opadContext, k_opad,
+                  keyContext->blockSize);
+  return keyContext->Corrupted = ret;
+}
+
+/*
+ *  hmacResetWithKey
+ *
+ *  Description:
+ *      This function will initialize the hmacContext in preparation
+ *      for computing a new HMAC message digest with a key set by
+ *      hmacSetKey().
+ *
+ *  Parameters:
+ *      context: [in/out]
+ *          The context to reset.
+ *      keyContext: [in]
+ *          The key context, it must not change until hmacResult().
+ *
+ *  Returns:
+ *      sha Error Code.
+ *
+ */
+int hmacResetWithKey(HMACContext *context,
+    const HMACKeyContext *keyContext)
+{
+  if (!context) return shaNull;
+  if (!keyContext) return shaNull;
+  context->Computed = 0;
+  context->keyContext = keyContext;
+
+  context->blockSize = keyContext->blockSize;
+  context->hashSize = keyContext->hashSize;
+  context->whichSha = keyContext->whichSha;
+
+  /* continue the 1st pass after the inner pad */
+  context->shaContext = keyContext->ipadContext;
+  return context->Corrupted = keyContext->Corrupted;
+}
+
 /*
  *  hmacInput
  *
@@ -227,6 +352,18 @@ int hmacResult(HMACContext *context, uint8_t *digest)
 
   /* finish up 1st pass */
   /* (Use digest here as a temporary buffer.) */
+  if (context->keyContext) {
+    ret = USHAResult(&context->shaContext, digest);
+    if (ret == shaSuccess) {
+      /* perform outer SHA from the state after the outer pad */
+      context->shaContext = context->keyContext->opadContext;
+      ret = USHAInput(&context->shaContext, digest, context->hashSize) ||
+            USHAResult(&context->shaContext, digest);
+    }
+    context->Computed = 1;
+    return context->Corrupted = ret;
+  }
+
   ret =
     USHAResult(&context->shaContext, digest) ||
 
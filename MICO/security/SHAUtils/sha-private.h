@@ -25,5 +25,42 @@
 
 #define SHA_Parity(x, y, z)  ((x) ^ (y) ^ (z))
 
+/*
+ * SHA-1 and SHA-256 unroll their 80 and 64 rounds and keep a 16 word
+ * message schedule.  Define SHA_UNROLL_ROUNDS to 0 for the smaller
+ * round loops of the reference code.
+ */
+#ifndef SHA_UNROLL_ROUNDS
+#define SHA_UNROLL_ROUNDS 1
+#endif
+
+/*
+ * Big-endian 32-bit loads of the message words.  When the compiler
+ * has a byte swap and the target is little-endian, word aligned
+ * blocks are read a word at a time: SHA_WORD_ALIGNED() tells if a
+ * block can use SHA_GET32_WORD().  Other blocks use byte loads.
+ */
+#define SHA_GET32_BYTES(p)                                 \
+  (((uint32_t)(p)[0] << 24) | ((uint32_t)(p)[1] << 16) |   \
+   ((uint32_t)(p)[2] << 8) | ((uint32_t)(p)[3]))
+
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && \
+    (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+#define SHA_BSWAP32(x)       __builtin_bswap32(x)
+#elif defined(__ICCARM__) && defined(__LITTLE_ENDIAN__) && __LITTLE_ENDIAN__
+#include <intrinsics.h>
+#define SHA_BSWAP32(x)       __REV(x)
+#elif defined(__CC_ARM) && !defined(__BIG_ENDIAN)
+#define SHA_BSWAP32(x)       __rev(x)
+#endif
+
+#ifdef SHA_BSWAP32
+#define SHA_WORD_ALIGNED(p)  ((((uintptr_t)(p)) & 3) == 0)
+#define SHA_GET32_WORD(p)    SHA_BSWAP32(*(const uint32_t *)(const void *)(p))
+#else
+#define SHA_WORD_ALIGNED(p)  0
+#define SHA_GET32_WORD(p)    SHA_GET32_BYTES(p)
+#endif
+
 #endif /* _SHA_PRIVATE__H */
 
@@ -133,9 +133,10 @@ typedef struct SHA1Context {
     uint32_t Length_High;               /* Message length in bits */
     uint32_t Length_Low;                /* Message length in bits */
 
-    int_least16_t Message_Block_Index;  /* Message_Block array index */
-                                        /* 512-bit message blocks */
+                                        /* 512-bit message blocks, */
+                                        /* word aligned */
     uint8_t Message_Block[SHA1_Message_Block_Size];
+    int_least16_t Message_Block_Index;  /* Message_Block array index */
 
     int Computed;                   /* Is the hash computed? */
     int Corrupted;                  /* Cumulative corruption code */
@@ -151,9 +152,10 @@ typedef struct SHA256Context {
     uint32_t Length_High;               /* Message length in bits */
     uint32_t Length_Low;                /* Message length in bits */
 
-    int_least16_t Message_Block_Index;  /* Message_Block array index */
-                                        /* 512-bit message blocks */
+                                        /* 512-bit message blocks, */
+                                        /* word aligned */
     uint8_t Message_Block[SHA256_Message_Block_Size];
+    int_least16_t Message_Block_Index;  /* Message_Block array index */
 
     int Computed;                   /* Is the hash computed? */
     int Corrupted;                  /* Cumulative corruption code */
@@ -206,6 +208,21 @@ typedef struct USHAContext {
 
 } USHAContext;
 
+/*
+ *  This structure will hold the inner and outer SHA states of an
+ *  HMAC key, after hashing the key XORd with ipad and opad.  It
+ *  is set once by hmacSetKey() and used by hmacResetWithKey() for
+ *  every message authenticated with that key.
+ */
+typedef struct HMACKeyContext {
+    SHAversion whichSha;        /* which SHA is being used */
+    int hashSize;               /* hash size of SHA being used */
+    int blockSize;              /* block size of SHA being used */
+    USHAContext ipadContext;    /* SHA context after the inner pad */
+    USHAContext opadContext;    /* SHA context after the outer pad */
+    int Corrupted;              /* Cumulative corruption code */
+} HMACKeyContext;
+
 /*
  *  This structure will hold context information for the HMAC
  *  keyed-hashing operation.
@@ -217,6 +234,8 @@ typedef struct HMACContext {
     USHAContext shaContext;     /* SHA context */
     unsigned char k_opad[USHA_Max_Message_Block_Size];
                         /* outer padding - key XORd with opad */
+    const HMACKeyContext *keyContext;
+                        /* precomputed key, used instead of k_opad */
     int Computed;               /* Is the MAC computed? */
     int Corrupted;              /* Cumulative corruption code */
 
@@ -328,6 +347,16 @@ extern int hmacFinalBits(HMACContext *context, uint8_t bits,
 extern int hmacResult(HMACContext *context,
                       uint8_t digest[USHAMaxHashSize]);
 
+/*
+ * HMAC with the pad states of the key computed once.
+ * The key context must stay valid until hmacResult().
+ */
+extern int hmacSetKey(HMACKeyContext *keyContext,
+                      enum SHAversion whichSha,
+                      const unsigned char *key, int key_len);
+extern int hmacResetWithKey(HMACContext *context,
+                            const HMACKeyContext *keyContext);
+
 /*
  * HKDF HMAC-based Extract-and-Expand Key Derivation Function,
  * RFC 5869, for all SHAs.
@@ -38,6 +38,7 @@
 
 #include "sha.h"
 #include "sha-private.h"
+#include <string.h>
 
 /*
  *  Define the SHA1 circular left shift macro
@@ -58,7 +59,8 @@ static uint32_t addTemp;
                                         : (context)->Corrupted )
 
 /* Local Function Prototypes */
-static void SHA1ProcessMessageBlock(SHA1Context *context);
+static void SHA1ProcessMessageBlock(SHA1Context *context,
+    const uint8_t *block);
 static void SHA1Finalize(SHA1Context *context, uint8_t Pad_Byte);
 static void SHA1PadMessage(SHA1Context *context, uint8_t Pad_Byte);
 
@@ -120,21 +122,36 @@ int SHA1Reset(SHA1Context *context)
 int SHA1Input(SHA1Context *context,
     const uint8_t *message_array, unsigned length)
 {
+  unsigned n;
+
   if (!context) return shaNull;
   if (!length) return shaSuccess;
   if (!message_array) return shaNull;
   if (context->Computed) return context->Corrupted = shaStateError;
   if (context->Corrupted) return context->Corrupted;
 
-  while (length--) {
-    context->Message_Block[context->Message_Block_Index++] =
-      *message_array;
-
-    if ((SHA1AddLength(context, 8) == shaSuccess) &&
-      (context->Message_Block_Index == SHA1_Message_Block_Size))
-      SHA1ProcessMessageBlock(context);
-
-    message_array++;
+  while (length) {
+    if ((context->Message_Block_Index == 0) &&
+        (length >= SHA1_Message_Block_Size)) {
+      /* Whole blocks are hashed in place, without the copy */
+      if (SHA1AddLength(context, 8 * SHA1_Message_Block_Size)
+          != shaSuccess)
+        break;
+      SHA1ProcessMessageBlock(context, message_array);
+      n = SHA1_Message_Block_Size;
+    } else {
+      n = SHA1_Message_Block_Size - context->Message_Block_Index;
+      if (n > length) n = length;
+      if (SHA1AddLength(context, 8 * n) != shaSuccess)
+        break;
+      memcpy(&context->Message_Block[context->Message_Block_Index],
+             message_array, n);
+      context->Message_Block_Index += n;
+      if (context->Message_Block_Index == SHA1_Message_Block_Size)
+        SHA1ProcessMessageBlock(context, context->Message_Block);
+    }
+    message_array += n;
+    length -= n;
   }
 
   return context->Corrupted;
@@ -244,11 +261,14 @@ unsigned char * SHA1Direct(const uint8_t *message_array, unsigned length,
  *
  * Description:
  *   This helper function will process the next 512 bits of the
- *   message stored in the Message_Block array.
+ *   message, stored in the Message_Block array or read straight
+ *   from the caller's buffer by SHA1Input().
  *
  * Parameters:
  *   context: [in/out]
  *     The SHA context to update.
+ *   block[ ]: [in]
+ *     The 64 octets of the message block.
  *
  * Returns:
  *   Nothing.
@@ -258,7 +278,35 @@ unsigned char * SHA1Direct(const uint8_t *message_array, unsigned length,
  *   single character names, were used because those were the
  *   names used in the Secure Hash Standard.
  */
-static void SHA1ProcessMessageBlock(SHA1Context *context)
+#if SHA_UNROLL_ROUNDS
+/*
+ * The message schedule is kept in 16 words: W[t] replaces W[t-16].
+ * The word buffers rotate through the macro arguments instead of
+ * being moved at each round.
+ */
+#define SHA1_W(t)                                                \
+  ((t) < 16 ? W[(t) & 15] :                                      \
+   (W[(t) & 15] = SHA1_ROTL(1, W[((t) - 3) & 15] ^               \
+                  W[((t) - 8) & 15] ^ W[((t) - 14) & 15] ^ W[(t) & 15])))
+
+#define SHA1_ROUND(a, b, c, d, e, f, k, t)                       \
+  do {                                                           \
+    e += SHA1_ROTL(5, a) + f(b, c, d) + (k) + SHA1_W(t);         \
+    b = SHA1_ROTL(30, b);                                        \
+  } while (0)
+
+#define SHA1_ROUNDS5(f, k, t)                                    \
+  do {                                                           \
+    SHA1_ROUND(A, B, C, D, E, f, k, (t) + 0);                    \
+    SHA1_ROUND(E, A, B, C, D, f, k, (t) + 1);                    \
+    SHA1_ROUND(D, E, A, B, C, f, k, (t) + 2);                    \
+    SHA1_ROUND(C, D, E, A, B, f, k, (t) + 3);                    \
+    SHA1_ROUND(B, C, D, E, A, f, k, (t) + 4);                    \
+  } while (0)
+#endif /* SHA_UNROLL_ROUNDS */
+
+static void SHA1ProcessMessageBlock(SHA1Context *context,
+    const uint8_t *block)
 {
   /* Constants defined in FIPS 180-3, section 4.2.1 */
   const uint32_t K[4] = {
@@ -266,22 +314,29 @@ static void SHA1ProcessMessageBlock(SHA1Context *context)
   };
 
   int        t;               /* Loop counter */
+#if SHA_UNROLL_ROUNDS
+  uint32_t   W[16];           /* Word sequence */
+#else /* !SHA_UNROLL_ROUNDS */
   uint32_t   temp;            /* Temporary word value */
   uint32_t   W[80];           /* Word sequence */
+#endif /* SHA_UNROLL_ROUNDS */
   uint32_t   A, B, C, D, E;   /* Word buffers */
 
   /*
    * Initialize the first 16 words in the array W
    */
-  for (t = 0; t < 16; t++) {
-    W[t]  = ((uint32_t)context->Message_Block[t * 4]) << 24;
-    W[t] |= ((uint32_t)context->Message_Block[t * 4 + 1]) << 16;
-    W[t] |= ((uint32_t)context->Message_Block[t * 4 + 2]) << 8;
-    W[t] |= ((uint32_t)context->Message_Block[t * 4 + 3]);
+  if (SHA_WORD_ALIGNED(block)) {
+    for (t = 0; t < 16; t++)
+      W[t] = SHA_GET32_WORD(block + t * 4);
+  } else {
+    for (t = 0; t < 16; t++)
+      W[t] = SHA_GET32_BYTES(block + t * 4);
   }
 
+#if !SHA_UNROLL_ROUNDS
   for (t = 16; t < 80; t++)
     W[t] = SHA1_ROTL(1, W[t-3] ^ W[t-8] ^ W[t-14] ^ W[t-16]);
+#endif /* !SHA_UNROLL_ROUNDS */
 
   A = context->Intermediate_Hash[0];
   B = context->Intermediate_Hash[1];
@@ -289,6 +344,24 @@ static void SHA1ProcessMessageBlock(SHA1Context *context)
   D = context->Intermediate_Hash[3];
   E = context->Intermediate_Hash[4];
 
+#if SHA_UNROLL_ROUNDS
+  SHA1_ROUNDS5(SHA_Ch, K[0], 0);
+  SHA1_ROUNDS5(SHA_Ch, K[0], 5);
+  SHA1_ROUNDS5(SHA_Ch, K[0], 10);
+  SHA1_ROUNDS5(SHA_Ch, K[0], 15);
+  SHA1_ROUNDS5(SHA_Parity, K[1], 20);
+  SHA1_ROUNDS5(SHA_Parity, K[1], 25);
+  SHA1_ROUNDS5(SHA_Parity, K[1], 30);
+  SHA1_ROUNDS5(SHA_Parity, K[1], 35);
+  SHA1_ROUNDS5(SHA_Maj, K[2], 40);
+  SHA1_ROUNDS5(SHA_Maj, K[2], 45);
+  SHA1_ROUNDS5(SHA_Maj, K[2], 50);
+  SHA1_ROUNDS5(SHA_Maj, K[2], 55);
+  SHA1_ROUNDS5(SHA_Parity, K[3], 60);
+  SHA1_ROUNDS5(SHA_Parity, K[3], 65);
+  SHA1_ROUNDS5(SHA_Parity, K[3], 70);
+  SHA1_ROUNDS5(SHA_Parity, K[3], 75);
+#else /* !SHA_UNROLL_ROUNDS */
   for (t = 0; t < 20; t++) {
     temp = SHA1_ROTL(5,A) + SHA_Ch(B, C, D) + E + W[t] + K[0];
     E = D;
@@ -324,6 +397,7 @@ static void SHA1ProcessMessageBlock(SHA1Context *context)
     B = A;
     A = temp;
   }
+#endif /* SHA_UNROLL_ROUNDS */
 
   context->Intermediate_Hash[0] += A;
   context->Intermediate_Hash[1] += B;
@@ -401,7 +475,7 @@ static void SHA1PadMessage(SHA1Context *context, uint8_t Pad_Byte)
     while (context->Message_Block_Index < SHA1_Message_Block_Size)
       context->Message_Block[context->Message_Block_Index++] = 0;
 
-    SHA1ProcessMessageBlock(context);
+    SHA1ProcessMessageBlock(context, context->Message_Block);
   } else
     context->Message_Block[context->Message_Block_Index++] = Pad_Byte;
 
@@ -420,6 +494,6 @@ static void SHA1PadMessage(SHA1Context *context, uint8_t Pad_Byte)
   context->Message_Block[62] = (uint8_t) (context->Length_Low >> 8);
   context->Message_Block[63] = (uint8_t) (context->Length_Low);
 
-  SHA1ProcessMessageBlock(context);
+  SHA1ProcessMessageBlock(context, context->Message_Block);
 }
 
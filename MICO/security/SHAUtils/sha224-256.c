@@ -42,6 +42,7 @@
 
 #include "sha.h"
 #include "sha-private.h"
+#include <string.h>
 
 /* Define the SHA shift, rotate left, and rotate right macros */
 #define SHA256_SHR(bits,word)      ((word) >> (bits))
@@ -73,7 +74,8 @@ static uint32_t addTemp;
 
 /* Local Function Prototypes */
 static int SHA224_256Reset(SHA256Context *context, uint32_t *H0);
-static void SHA224_256ProcessMessageBlock(SHA256Context *context);
+static void SHA224_256ProcessMessageBlock(SHA256Context *context,
+  const uint8_t *block);
 static void SHA224_256Finalize(SHA256Context *context,
   uint8_t Pad_Byte);
 static void SHA224_256PadMessage(SHA256Context *context,
@@ -229,21 +231,36 @@ int SHA256Reset(SHA256Context *context)
 int SHA256Input(SHA256Context *context, const uint8_t *message_array,
     unsigned int length)
 {
+  unsigned int n;
+
   if (!context) return shaNull;
   if (!length) return shaSuccess;
   if (!message_array) return shaNull;
   if (context->Computed) return context->Corrupted = shaStateError;
   if (context->Corrupted) return context->Corrupted;
 
-  while (length--) {
-    context->Message_Block[context->Message_Block_Index++] =
-            *message_array;
-
-    if ((SHA224_256AddLength(context, 8) == shaSuccess) &&
-      (context->Message_Block_Index == SHA256_Message_Block_Size))
-      SHA224_256ProcessMessageBlock(context);
-
-    message_array++;
+  while (length) {
+    if ((context->Message_Block_Index == 0) &&
+        (length >= SHA256_Message_Block_Size)) {
+      /* Whole blocks are hashed in place, without the copy */
+      if (SHA224_256AddLength(context, 8 * SHA256_Message_Block_Size)
+          != shaSuccess)
+        break;
+      SHA224_256ProcessMessageBlock(context, message_array);
+      n = SHA256_Message_Block_Size;
+    } else {
+      n = SHA256_Message_Block_Size - context->Message_Block_Index;
+      if (n > length) n = length;
+      if (SHA224_256AddLength(context, 8 * n) != shaSuccess)
+        break;
+      memcpy(&context->Message_Block[context->Message_Block_Index],
+             message_array, n);
+      context->Message_Block_Index += n;
+      if (context->Message_Block_Index == SHA256_Message_Block_Size)
+        SHA224_256ProcessMessageBlock(context, context->Message_Block);
+    }
+    message_array += n;
+    length -= n;
   }
 
   return context->Corrupted;
@@ -366,11 +383,14 @@ static int SHA224_256Reset(SHA256Context *context, uint32_t *H0)
  *
  * Description:
  *   This helper function will process the next 512 bits of the
- *   message stored in the Message_Block array.
+ *   message, stored in the Message_Block array or read straight
+ *   from the caller's buffer by SHA256Input().
  *
  * Parameters:
  *   context: [in/out]
  *     The SHA context to update.
+ *   block[ ]: [in]
+ *     The 64 octets of the message block.
  *
  * Returns:
  *   Nothing.
@@ -380,7 +400,39 @@ static int SHA224_256Reset(SHA256Context *context, uint32_t *H0)
  *   single character names, were used because those were the
  *   names used in the Secure Hash Standard.
  */
-static void SHA224_256ProcessMessageBlock(SHA256Context *context)
+#if SHA_UNROLL_ROUNDS
+/*
+ * The message schedule is kept in 16 words: W[t] replaces W[t-16].
+ * The word buffers rotate through the macro arguments instead of
+ * being moved at each round.
+ */
+#define SHA256_W(t)                                              \
+  ((t) < 16 ? W[(t) & 15] :                                      \
+   (W[(t) & 15] += SHA256_sigma1(W[((t) - 2) & 15]) +            \
+                   W[((t) - 7) & 15] + SHA256_sigma0(W[((t) - 15) & 15])))
+
+#define SHA256_ROUND(a, b, c, d, e, f, g, h, t)                  \
+  do {                                                           \
+    h += SHA256_SIGMA1(e) + SHA_Ch(e, f, g) + K[t] + SHA256_W(t);\
+    d += h;                                                      \
+    h += SHA256_SIGMA0(a) + SHA_Maj(a, b, c);                    \
+  } while (0)
+
+#define SHA256_ROUNDS8(t)                                        \
+  do {                                                           \
+    SHA256_ROUND(A, B, C, D, E, F, G, H, (t) + 0);               \
+    SHA256_ROUND(H, A, B, C, D, E, F, G, (t) + 1);               \
+    SHA256_ROUND(G, H, A, B, C, D, E, F, (t) + 2);               \
+    SHA256_ROUND(F, G, H, A, B, C, D, E, (t) + 3);               \
+    SHA256_ROUND(E, F, G, H, A, B, C, D, (t) + 4);               \
+    SHA256_ROUND(D, E, F, G, H, A, B, C, (t) + 5);               \
+    SHA256_ROUND(C, D, E, F, G, H, A, B, (t) + 6);               \
+    SHA256_ROUND(B, C, D, E, F, G, H, A, (t) + 7);               \
+  } while (0)
+#endif /* SHA_UNROLL_ROUNDS */
+
+static void SHA224_256ProcessMessageBlock(SHA256Context *context,
+  const uint8_t *block)
 {
   /* Constants defined in FIPS 180-3, section 4.2.2 */
   static const uint32_t K[64] = {
@@ -398,22 +450,31 @@ static void SHA224_256ProcessMessageBlock(SHA256Context *context)
       0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
       0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
   };
-  int        t, t4;                   /* Loop counter */
+#if SHA_UNROLL_ROUNDS
+  int        t;                       /* Loop counter */
+  uint32_t   W[16];                   /* Word sequence */
+#else /* !SHA_UNROLL_ROUNDS */
+  int        t;                       /* Loop counter */
   uint32_t   temp1, temp2;            /* Temporary word value */
   uint32_t   W[64];                   /* Word sequence */
+#endif /* SHA_UNROLL_ROUNDS */
   uint32_t   A, B, C, D, E, F, G, H;  /* Word buffers */
 
   /*
    * Initialize the first 16 words in the array W
    */
-  for (t = t4 = 0; t < 16; t++, t4 += 4)
-    W[t] = (((uint32_t)context->Message_Block[t4]) << 24) |
-           (((uint32_t)context->Message_Block[t4 + 1]) << 16) |
-           (((uint32_t)context->Message_Block[t4 + 2]) << 8) |
-           (((uint32_t)context->Message_Block[t4 + 3]));
+  if (SHA_WORD_ALIGNED(block)) {
+    for (t = 0; t < 16; t++)
+      W[t] = SHA_GET32_WORD(block + t * 4);
+  } else {
+    for (t = 0; t < 16; t++)
+      W[t] = SHA_GET32_BYTES(block + t * 4);
+  }
+#if !SHA_UNROLL_ROUNDS
   for (t = 16; t < 64; t++)
     W[t] = SHA256_sigma1(W[t-2]) + W[t-7] +
         SHA256_sigma0(W[t-15]) + W[t-16];
+#endif /* !SHA_UNROLL_ROUNDS */
 
   A = context->Intermediate_Hash[0];
   B = context->Intermediate_Hash[1];
@@ -424,6 +485,16 @@ static void SHA224_256ProcessMessageBlock(SHA256Context *context)
   G = context->Intermediate_Hash[6];
   H = context->Intermediate_Hash[7];
 
+#if SHA_UNROLL_ROUNDS
+  SHA256_ROUNDS8(0);
+  SHA256_ROUNDS8(8);
+  SHA256_ROUNDS8(16);
+  SHA256_ROUNDS8(24);
+  SHA256_ROUNDS8(32);
+  SHA256_ROUNDS8(40);
+  SHA256_ROUNDS8(48);
+  SHA256_ROUNDS8(56);
+#else /* !SHA_UNROLL_ROUNDS */
   for (t = 0; t < 64; t++) {
     temp1 = H + SHA256_SIGMA1(E) + SHA_Ch(E,F,G) + K[t] + W[t];
     temp2 = SHA256_SIGMA0(A) + SHA_Maj(A,B,C);
@@ -436,6 +507,7 @@ static void SHA224_256ProcessMessageBlock(SHA256Context *context)
     B = A;
     A = temp1 + temp2;
   }
+#endif /* SHA_UNROLL_ROUNDS */
 
   context->Intermediate_Hash[0] += A;
   context->Intermediate_Hash[1] += B;
@@ -517,7 +589,7 @@ static void SHA224_256PadMessage(SHA256Context *context,
     context->Message_Block[context->Message_Block_Index++] = Pad_Byte;
     while (context->Message_Block_Index < SHA256_Message_Block_Size)
       context->Message_Block[context->Message_Block_Index++] = 0;
-    SHA224_256ProcessMessageBlock(context);
+    SHA224_256ProcessMessageBlock(context, context->Message_Block);
   } else
     context->Message_Block[context->Message_Block_Index++] = Pad_Byte;
 
@@ -536,7 +608,7 @@ static void SHA224_256PadMessage(SHA256Context *context,
   context->Message_Block[62] = (uint8_t)(context->Length_Low >> 8);
   context->Message_Block[63] = (uint8_t)(context->Length_Low);
 
-  SHA224_256ProcessMessageBlock(context);
+  SHA224_256ProcessMessageBlock(context, context->Message_Block);
 }
 
 /*
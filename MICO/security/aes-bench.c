@@ -0,0 +1,375 @@
+/**
+******************************************************************************
+* @file    aes-bench.c
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   Known answer tests and throughput of the AESUtils CTR and GCM modes.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+/* Built on the host with the Gladman backend, once per GHASH table size. The
+ * stubs in MICO/system/host stand for the platform headers and forward
+ * External/GladmanAES to MICO/security/GladmanAES:
+ *
+ *   for t in 0 256 4096 8192 65536; do
+ *     cc -O2 -DDEBUG=0 -DAES_BENCH_MAIN -DAES_UTILS_USE_GLADMAN_AES=1 -DAES_UTILS_HAS_GLADMAN_GCM=1 \
+ *        -DGF_TABLES_SIZE=$t -IMICO/system/host -Iinclude -Ilibraries/utilities -IMICO/security/GladmanAES \
+ *        MICO/security/aes-bench.c libraries/utilities/AESUtils.c libraries/utilities/SecurityUtils.c \
+ *        MICO/security/GladmanAES/aes*.c MICO/security/GladmanAES/g*.c -o aes-bench && ./aes-bench
+ *   done
+ *
+ * On the target aes_bench() can be called from a test command, results are
+ * then in ns per byte from mico_get_time() instead of cycles per byte.
+ */
+
+#include "Common.h"
+#include "AESUtils.h"
+
+#include <stdio.h>
+
+#if( defined( __i386__ ) || defined( __x86_64__ ) )
+    #include <x86intrin.h>
+    #define aes_bench_ticks()       ( (uint64_t) __rdtsc() )
+    #define kAES_BenchUnit          "cycles/byte"
+    #define kAES_BenchScale         1
+#elif( defined( AES_BENCH_MAIN ) )
+    #include <time.h>
+    static uint64_t aes_bench_ticks( void )
+    {
+        struct timespec     ts;
+
+        clock_gettime( CLOCK_MONOTONIC, &ts );
+        return( ( (uint64_t) ts.tv_sec * 1000000000 ) + ts.tv_nsec );
+    }
+    #define kAES_BenchUnit          "ns/byte"
+    #define kAES_BenchScale         1
+#else
+    #define aes_bench_ticks()       ( (uint64_t) mico_get_time() )
+    #define kAES_BenchUnit          "ns/byte"
+    #define kAES_BenchScale         1000000
+#endif
+
+#define kAES_BenchBufSize           8192
+
+//===========================================================================================================================
+//  Test vectors
+//===========================================================================================================================
+
+// NIST SP 800-38A F.5.1, CTR-AES128.Encrypt.
+
+static const uint8_t        kAES_CTR_Key[ 16 ] =
+{
+    0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+static const uint8_t        kAES_CTR_Counter[ 16 ] =
+{
+    0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff
+};
+static const uint8_t        kAES_CTR_Plaintext[ 64 ] =
+{
+    0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+    0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+    0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+    0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10
+};
+static const uint8_t        kAES_CTR_Ciphertext[ 64 ] =
+{
+    0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26, 0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce,
+    0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff, 0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff,
+    0x5a, 0xe4, 0xdf, 0x3e, 0xdb, 0xd5, 0xd3, 0x5e, 0x5b, 0x4f, 0x09, 0x02, 0x0d, 0xb0, 0x3e, 0xab,
+    0x1e, 0x03, 0x1d, 0xda, 0x2f, 0xbe, 0x03, 0xd1, 0x79, 0x21, 0x70, 0xa0, 0xf3, 0x00, 0x9c, 0xee
+};
+
+#if( AES_UTILS_HAS_GCM )
+// Key 00..0f, 16 byte nonce 10..1f, AAD a0..b3, plaintext 00..63. Computed with OpenSSL as there is no NIST vector
+// with the 16 byte nonce used by AES_GCM_InitMessage.
+
+static const uint8_t        kAES_GCM_Ciphertext[ 100 ] =
+{
+    0xc5, 0x9f, 0xf5, 0xb5, 0x79, 0xb7, 0x22, 0x8f, 0xde, 0x11, 0xc9, 0x89, 0xad, 0x22, 0x21, 0xd8,
+    0xe5, 0xec, 0x32, 0x8c, 0x79, 0x13, 0xb1, 0xef, 0xb1, 0x9f, 0x9d, 0x8d, 0x5f, 0x5e, 0x6d, 0xff,
+    0x03, 0x05, 0x49, 0x24, 0xc5, 0x3c, 0x52, 0x69, 0xc4, 0xac, 0xc6, 0xf4, 0x57, 0xc1, 0x27, 0xd5,
+    0x04, 0x56, 0xc7, 0x4d, 0x48, 0x1d, 0xfb, 0x23, 0xba, 0x4e, 0x62, 0x1d, 0x58, 0x32, 0xd0, 0xc4,
+    0xbb, 0x52, 0xcf, 0x96, 0x20, 0x7a, 0xaf, 0x4b, 0xb7, 0xcf, 0x5c, 0x57, 0x51, 0xe5, 0xce, 0x2b,
+    0xe4, 0xdd, 0x8f, 0x61, 0xaa, 0xbc, 0x73, 0x85, 0xcc, 0x32, 0x3d, 0x67, 0x96, 0xf4, 0xfc, 0x27,
+    0xfb, 0x62, 0x4d, 0x1c
+};
+static const uint8_t        kAES_GCM_Tag[ 16 ] =
+{
+    0x97, 0x51, 0x87, 0x34, 0xbb, 0xcf, 0x03, 0xd5, 0x59, 0xb7, 0xd8, 0x99, 0xa2, 0x38, 0xb5, 0xed
+};
+#endif
+
+static uint8_t      gAES_BenchSrc[ kAES_BenchBufSize + 4 ];
+static uint8_t      gAES_BenchDst[ kAES_BenchBufSize + 4 ];
+static uint8_t      gAES_BenchRef[ kAES_BenchBufSize + 4 ];
+
+//===========================================================================================================================
+//  aes_ctr_reference
+//
+//  One counter block per AES call and a byte XOR, like AES_CTR_Update before the bulk path. Used as the reference for
+//  split and unaligned updates and as the baseline of the benchmark.
+//===========================================================================================================================
+
+static OSStatus aes_ctr_reference( AES_ECB_Context *inECB, uint8_t inCounter[ 16 ], const uint8_t *inSrc, size_t inLen,
+    uint8_t *inDst )
+{
+    OSStatus        err;
+    uint8_t         key[ 16 ];
+    size_t          i, n;
+    int             j;
+
+    while( inLen > 0 )
+    {
+        err = AES_ECB_Update( inECB, inCounter, 16, key );
+        require_noerr( err, exit );
+        for( j = 15; ( j >= 0 ) && ( ++inCounter[ j ] == 0 ); --j ) {}
+
+        n = ( inLen < 16 ) ? inLen : 16;
+        for( i = 0; i < n; ++i )
+        {
+            inDst[ i ] = inSrc[ i ] ^ key[ i ];
+        }
+        inSrc += n;
+        inDst += n;
+        inLen -= n;
+    }
+    err = kNoErr;
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  aes_ctr_test
+//===========================================================================================================================
+
+static OSStatus aes_ctr_test( void )
+{
+    OSStatus            err;
+    AES_CTR_Context     ctx;
+    AES_ECB_Context     ecb;
+    uint8_t             counter[ 16 ];
+    size_t              i, len, chunk, off;
+
+    err = AES_ECB_Init( &ecb, kAES_ECB_Mode_Encrypt, kAES_CTR_Key );
+    require_noerr( err, exit );
+
+    // Known answer, in one update and in chunks of every size.
+
+    for( chunk = 1; chunk <= sizeof( kAES_CTR_Plaintext ); ++chunk )
+    {
+        err = AES_CTR_Init( &ctx, kAES_CTR_Key, kAES_CTR_Counter );
+        require_noerr( err, exit );
+        for( off = 0; off < sizeof( kAES_CTR_Plaintext ); off += len )
+        {
+            len = Min( chunk, sizeof( kAES_CTR_Plaintext ) - off );
+            err = AES_CTR_Update( &ctx, &kAES_CTR_Plaintext[ off ], len, &gAES_BenchDst[ off ] );
+            require_noerr( err, exit );
+        }
+        AES_CTR_Final( &ctx );
+        require_action( memcmp( gAES_BenchDst, kAES_CTR_Ciphertext, sizeof( kAES_CTR_Ciphertext ) ) == 0, exit,
+            err = kMismatchErr );
+    }
+
+    // Same as the reference for every length and alignment, in place and not, with a counter that carries.
+
+    for( i = 0; i < sizeof( gAES_BenchSrc ); ++i ) gAES_BenchSrc[ i ] = (uint8_t)( i * 7 );
+    for( off = 0; off < 4; ++off )
+    {
+        for( len = 0; len <= 300; ++len )
+        {
+            memset( counter, 0xFF, sizeof( counter ) );
+            counter[ 0 ] = (uint8_t) len;
+            err = AES_CTR_Init( &ctx, kAES_CTR_Key, counter );
+            require_noerr( err, exit );
+            err = aes_ctr_reference( &ecb, counter, &gAES_BenchSrc[ off ], len, gAES_BenchRef );
+            require_noerr( err, exit );
+
+            if( len & 1 )
+            {
+                memcpy( &gAES_BenchDst[ 3 - off ], &gAES_BenchSrc[ off ], len );
+                err = AES_CTR_Update( &ctx, &gAES_BenchDst[ 3 - off ], len, &gAES_BenchDst[ 3 - off ] );
+            }
+            else
+            {
+                err = AES_CTR_Update( &ctx, &gAES_BenchSrc[ off ], len, &gAES_BenchDst[ 3 - off ] );
+            }
+            require_noerr( err, exit );
+            require_action( memcmp( &gAES_BenchDst[ 3 - off ], gAES_BenchRef, len ) == 0, exit, err = kMismatchErr );
+            require_action( memcmp( ctx.ctr, counter, sizeof( counter ) ) == 0, exit, err = kMismatchErr );
+            AES_CTR_Final( &ctx );
+        }
+    }
+
+exit:
+    AES_ECB_Final( &ecb );
+    return( err );
+}
+
+#if( AES_UTILS_HAS_GCM )
+//===========================================================================================================================
+//  aes_gcm_test
+//===========================================================================================================================
+
+static OSStatus aes_gcm_test( void )
+{
+    OSStatus            err;
+    AES_GCM_Context     ctx;
+    uint8_t             key[ 16 ], nonce[ 16 ], aad[ 20 ], tag[ 16 ];
+    size_t              i;
+
+    for( i = 0; i < sizeof( key ); ++i )    key[ i ]   = (uint8_t) i;
+    for( i = 0; i < sizeof( nonce ); ++i )  nonce[ i ] = (uint8_t)( 0x10 + i );
+    for( i = 0; i < sizeof( aad ); ++i )    aad[ i ]   = (uint8_t)( 0xA0 + i );
+    for( i = 0; i < sizeof( kAES_GCM_Ciphertext ); ++i ) gAES_BenchSrc[ i ] = (uint8_t) i;
+
+    err = AES_GCM_Init( &ctx, key, kAES_CGM_Nonce_None );
+    require_noerr( err, exit );
+    err = AES_GCM_InitMessage( &ctx, nonce );
+    require_noerr( err, exit );
+    err = AES_GCM_AddAAD( &ctx, aad, sizeof( aad ) );
+    require_noerr( err, exit );
+    err = AES_GCM_Encrypt( &ctx, gAES_BenchSrc, 37, gAES_BenchDst );
+    require_noerr( err, exit );
+    err = AES_GCM_Encrypt( &ctx, &gAES_BenchSrc[ 37 ], sizeof( kAES_GCM_Ciphertext ) - 37, &gAES_BenchDst[ 37 ] );
+    require_noerr( err, exit );
+    err = AES_GCM_FinalizeMessage( &ctx, tag );
+    require_noerr( err, exit );
+    require_action( memcmp( gAES_BenchDst, kAES_GCM_Ciphertext, sizeof( kAES_GCM_Ciphertext ) ) == 0, exit,
+        err = kMismatchErr );
+    require_action( memcmp( tag, kAES_GCM_Tag, sizeof( tag ) ) == 0, exit, err = kMismatchErr );
+
+    err = AES_GCM_InitMessage( &ctx, nonce );
+    require_noerr( err, exit );
+    err = AES_GCM_AddAAD( &ctx, aad, sizeof( aad ) );
+    require_noerr( err, exit );
+    err = AES_GCM_Decrypt( &ctx, kAES_GCM_Ciphertext, sizeof( kAES_GCM_Ciphertext ), gAES_BenchDst );
+    require_noerr( err, exit );
+    err = AES_GCM_VerifyMessage( &ctx, kAES_GCM_Tag );
+    require_noerr( err, exit );
+    require_action( memcmp( gAES_BenchDst, gAES_BenchSrc, sizeof( kAES_GCM_Ciphertext ) ) == 0, exit,
+        err = kMismatchErr );
+
+exit:
+    AES_GCM_Final( &ctx );
+    return( err );
+}
+#endif
+
+//===========================================================================================================================
+//  aes_bench_report
+//===========================================================================================================================
+
+static void aes_bench_report( const char *inMode, size_t inLen, uint64_t inTicks, size_t inBytes )
+{
+    printf( "%-24s %5u bytes: %8.2f %s\n", inMode, (unsigned int) inLen,
+        ( (double) inTicks * kAES_BenchScale ) / (double) inBytes, kAES_BenchUnit );
+}
+
+//===========================================================================================================================
+//  aes_bench
+//===========================================================================================================================
+
+OSStatus    aes_bench( int print )
+{
+    static const size_t     kLengths[] = { 16, 64, 256, 1024, kAES_BenchBufSize };
+    OSStatus                err;
+    AES_CTR_Context         ctx;
+    AES_ECB_Context         ecb;
+    uint8_t                 counter[ 16 ];
+    uint64_t                t;
+    size_t                  i, n, total, loops;
+#if( AES_UTILS_HAS_GCM )
+    AES_GCM_Context         gcm;
+    uint8_t                 tag[ 16 ];
+#endif
+
+    err = aes_ctr_test();
+    require_noerr( err, exit );
+#if( AES_UTILS_HAS_GCM )
+    err = aes_gcm_test();
+    require_noerr( err, exit );
+#endif
+    if( !print ) goto exit;
+
+    err = AES_ECB_Init( &ecb, kAES_ECB_Mode_Encrypt, kAES_CTR_Key );
+    require_noerr( err, exit );
+    err = AES_CTR_Init( &ctx, kAES_CTR_Key, kAES_CTR_Counter );
+    require_noerr( err, exit );
+    memcpy( counter, kAES_CTR_Counter, sizeof( counter ) );
+#if( AES_UTILS_HAS_GCM )
+    err = AES_GCM_Init( &gcm, kAES_CTR_Key, kAES_CTR_Counter );
+    require_noerr( err, exit );
+    printf( "GHASH table: %d bytes per GCM context\n", GF_TABLES_SIZE );
+#endif
+
+    for( i = 0; i < sizeof( kLengths ) / sizeof( kLengths[ 0 ] ); ++i )
+    {
+        n     = kLengths[ i ];
+        loops = ( 1024 * 1024 ) / n;
+        total = loops * n;
+
+        t = aes_bench_ticks();
+        for( n = 0; n < loops; ++n ) aes_ctr_reference( &ecb, counter, gAES_BenchSrc, kLengths[ i ], gAES_BenchDst );
+        aes_bench_report( "CTR, one block per call", kLengths[ i ], aes_bench_ticks() - t, total );
+
+        t = aes_bench_ticks();
+        for( n = 0; n < loops; ++n ) AES_CTR_Update( &ctx, gAES_BenchSrc, kLengths[ i ], gAES_BenchDst );
+        aes_bench_report( "CTR, AES_CTR_Update", kLengths[ i ], aes_bench_ticks() - t, total );
+
+        t = aes_bench_ticks();
+        for( n = 0; n < loops; ++n ) AES_CTR_Update( &ctx, &gAES_BenchSrc[ 1 ], kLengths[ i ], &gAES_BenchDst[ 1 ] );
+        aes_bench_report( "CTR, unaligned", kLengths[ i ], aes_bench_ticks() - t, total );
+
+    #if( AES_UTILS_HAS_GCM )
+        t = aes_bench_ticks();
+        for( n = 0; n < loops; ++n )
+        {
+            AES_GCM_InitMessage( &gcm, kAES_CGM_Nonce_Auto );
+            AES_GCM_Encrypt( &gcm, gAES_BenchSrc, kLengths[ i ], gAES_BenchDst );
+            AES_GCM_FinalizeMessage( &gcm, tag );
+        }
+        aes_bench_report( "GCM, message", kLengths[ i ], aes_bench_ticks() - t, total );
+    #endif
+    }
+
+    AES_ECB_Final( &ecb );
+    AES_CTR_Final( &ctx );
+#if( AES_UTILS_HAS_GCM )
+    AES_GCM_Final( &gcm );
+#endif
+
+exit:
+    printf( "%s: %s\n", __FUNCTION__, !err ? "PASSED" : "FAILED" );
+    return( err );
+}
+
+#if( defined( AES_BENCH_MAIN ) )
+int main( void )
+{
+    return( aes_bench( 1 ) ? 1 : 0 );
+}
+#endif
@@ -0,0 +1,539 @@
+/**
+******************************************************************************
+* @file    sha-bench.c
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   Known answer tests and throughput of the SHAUtils hashes, HMAC and HKDF.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+/* Built on the host, once with the unrolled rounds and once with the round loops, MICO/system/host holds the stub
+ * platform headers:
+ *
+ *   for u in 1 0; do
+ *     cc -O2 -DDEBUG=0 -DSHA_BENCH_MAIN -DSHA_UNROLL_ROUNDS=$u -IMICO/system/host -Iinclude -IMICO/security/SHAUtils \
+ *        MICO/security/sha-bench.c MICO/security/SHAUtils/{sha1,sha224-256,sha384-512,usha,hmac,hkdf}.c \
+ *        -o sha-bench && ./sha-bench
+ *   done
+ *
+ * On the target sha_bench() can be called from a test command, results are then in ns from mico_get_time()
+ * instead of cycles.
+ */
+
+#include "Common.h"
+#include "Debug.h"
+#include "sha.h"
+
+#include <stdio.h>
+
+#if( defined( __i386__ ) || defined( __x86_64__ ) )
+    #include <x86intrin.h>
+    #define sha_bench_ticks()       ( (uint64_t) __rdtsc() )
+    #define kSHA_BenchUnit          "cycles"
+    #define kSHA_BenchScale         1
+#elif( defined( SHA_BENCH_MAIN ) )
+    #include <time.h>
+    static uint64_t sha_bench_ticks( void )
+    {
+        struct timespec     ts;
+
+        clock_gettime( CLOCK_MONOTONIC, &ts );
+        return( ( (uint64_t) ts.tv_sec * 1000000000 ) + ts.tv_nsec );
+    }
+    #define kSHA_BenchUnit          "ns"
+    #define kSHA_BenchScale         1
+#else
+    #define sha_bench_ticks()       ( (uint64_t) mico_get_time() )
+    #define kSHA_BenchUnit          "ns"
+    #define kSHA_BenchScale         1000000
+#endif
+
+#define kSHA_BenchBufSize           8192
+
+//===========================================================================================================================
+//  Test vectors
+//===========================================================================================================================
+
+typedef struct
+{
+    SHAversion          sha;
+    const char *        message;
+    int                 repeat;
+    const char *        digest;
+
+}   sha_vector_t;
+
+// FIPS 180-2 appendices: "abc", the 448-bit message and one million 'a'.
+
+static const sha_vector_t       kSHA_Vectors[] =
+{
+    { SHA1,   "abc", 1, "a9993e364706816aba3e25717850c26c9cd0d89d" },
+    { SHA1,   "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1,
+              "84983e441c3bd26ebaae4aa1f95129e5e54670f1" },
+    { SHA1,   "a", 1000000, "34aa973cd4c4daa4f61eeb2bdbad27316534016f" },
+    { SHA224, "abc", 1, "23097d223405d8228642a477bda255b32aadbce4bda0b3f7e36c9da7" },
+    { SHA224, "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1,
+              "75388b16512776cc5dba5da1fd890150b0c6455cb4f58b1952522525" },
+    { SHA224, "a", 1000000, "20794655980c91d8bbb4c1ea97618a4bf03f42581948b2ee4ee7ad67" },
+    { SHA256, "abc", 1, "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+    { SHA256, "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1,
+              "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" },
+    { SHA256, "a", 1000000, "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" },
+    { SHA384, "abc", 1, "cb00753f45a35e8bb5a03d699ac65007272c32ab0eded1631a8b605a43ff5bed"
+                        "8086072ba1e7cc2358baeca134c825a7" },
+    { SHA384, "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1,
+              "3391fdddfc8dc7393707a65b1b4709397cf8b1d162af05abfe8f450de5f36bc6"
+              "b0455a8520bc4e6f5fe95b1fe3c8452b" },
+    { SHA384, "a", 1000000, "9d0e1809716474cb086e834e310a4a1ced149e9c00f248527972cec5704c2a5b"
+                            "07b8b3dc38ecc4ebae97ddd87f3d8985" },
+    { SHA512, "abc", 1, "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a"
+                        "2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f" },
+    { SHA512, "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1,
+              "204a8fc6dda82f0a0ced7beb8e08a41657c16ef468b228a8279be331a703c335"
+              "96fd15c13b1b07f9aa1d3bea57789ca031ad85c7a71dd70354ec631238ca3445" },
+    { SHA512, "a", 1000000, "e718483d0ce769644e2e42c7bc15b4638e1f98b13b2044285632a803afa973eb"
+                            "de0ff244877ea60a4cb0432ce577c31beb009c5c2c49aa2e4eadb217ad8cc09b" },
+};
+
+// RFC 2202 and RFC 4231 test cases 2 ("Jefe") and 6 (key longer than the block, 0xaa repeated key_len times).
+
+typedef struct
+{
+    SHAversion          sha;
+    int                 key_len;
+    const char *        message;
+    const char *        mac;
+
+}   sha_hmac_vector_t;
+
+static const sha_hmac_vector_t  kSHA_HMACVectors[] =
+{
+    { SHA1,   0,   "what do ya want for nothing?", "effcdf6ae5eb2fa2d27416d5f184df9c259a7c79" },
+    { SHA224, 0,   "what do ya want for nothing?", "a30e01098bc6dbbf45690f3a7e9e6d0f8bbea2a39e6148008fd05e44" },
+    { SHA256, 0,   "what do ya want for nothing?",
+                   "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843" },
+    { SHA384, 0,   "what do ya want for nothing?",
+                   "af45d2e376484031617f78d2b58a6b1b9c7ef464f5a01b47e42ec3736322445e"
+                   "8e2240ca5e69e2c78b3239ecfab21649" },
+    { SHA512, 0,   "what do ya want for nothing?",
+                   "164b7a7bfcf819e2e395fbe73b56e0a387bd64222e831fd610270cd7ea250554"
+                   "9758bf75c05a994a6d034f65f8f0e6fdcaeab1a34d4a6b4b636e070a38bce737" },
+    { SHA1,   80,  "Test Using Larger Than Block-Size Key - Hash Key First",
+                   "aa4ae5e15272d00e95705637ce8a3b55ed402112" },
+    { SHA224, 131, "Test Using Larger Than Block-Size Key - Hash Key First",
+                   "95e9a0db962095adaebe9b2d6f0dbce2d499f112f2d2b7273fa6870e" },
+    { SHA256, 131, "Test Using Larger Than Block-Size Key - Hash Key First",
+                   "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54" },
+    { SHA384, 131, "Test Using Larger Than Block-Size Key - Hash Key First",
+                   "4ece084485813e9088d2c63a041bc5b44f9ef1012a2b588f3cd11f05033ac4c6"
+                   "0c2ef6ab4030fe8296248df163f44952" },
+    { SHA512, 131, "Test Using Larger Than Block-Size Key - Hash Key First",
+                   "80b24263c7c1a3ebb71493c1dd7be8b49b46d1f41b4aeec1121b013783f8f352"
+                   "6b56d037e05f2598bd0fd2215d6a1e5295e64f73f63f0aec8b915a985d786598" },
+};
+
+// RFC 5869 test cases 1, 2 and 4. ikm is 0x0b repeated for cases 1 and 4, salt and info are counting bytes.
+
+typedef struct
+{
+    SHAversion          sha;
+    int                 ikm_len;
+    uint8_t             ikm_first;
+    int                 salt_len;
+    uint8_t             salt_first;
+    int                 info_len;
+    uint8_t             info_first;
+    int                 okm_len;
+    const char *        okm;
+
+}   sha_hkdf_vector_t;
+
+static const sha_hkdf_vector_t  kSHA_HKDFVectors[] =
+{
+    { SHA256, 22, 0x0b, 13, 0x00, 10, 0xf0, 42,
+      "3cb25f25faacd57a90434f64d0362f2a2d2d0a90cf1a5a4c5db02d56ecc4c5bf34007208d5b887185865" },
+    { SHA256, 80, 0x00, 80, 0x60, 80, 0xb0, 82,
+      "b11e398dc80327a1c8e7f78c596a49344f012eda2d4efad8a050cc4c19afa97c59045a99cac7827271cb41c65e590e09"
+      "da3275600c2f09b8367793a9aca3db71cc30c58179ec3e87c14c01d5c1f3434f1d87" },
+    { SHA1,   11, 0x0b, 13, 0x00, 10, 0xf0, 42,
+      "085a01ea1b10f36933068b56efa5ad81a4f14b822f5b091568a9cdd4f155fda2c22e422478d305f3f896" },
+};
+
+static uint8_t      gSHA_BenchBuf[ kSHA_BenchBufSize + 4 ];
+
+//===========================================================================================================================
+//  sha_hex_equal
+//===========================================================================================================================
+
+static int sha_hex_equal( const uint8_t *inData, const char *inHex, int inLen )
+{
+    unsigned int        byte;
+    int                 i;
+
+    if( (int) strlen( inHex ) != ( inLen * 2 ) ) return( 0 );
+    for( i = 0; i < inLen; ++i )
+    {
+        if( sscanf( &inHex[ i * 2 ], "%2x", &byte ) != 1 ) return( 0 );
+        if( inData[ i ] != byte ) return( 0 );
+    }
+    return( 1 );
+}
+
+//===========================================================================================================================
+//  sha_fill
+//
+//  Writes the test case pattern: inLen bytes of inFirst, or counting from inFirst for the RFC 5869 style inputs.
+//===========================================================================================================================
+
+static void sha_fill( uint8_t *inBuf, int inLen, uint8_t inFirst, int inCount )
+{
+    int         i;
+
+    for( i = 0; i < inLen; ++i ) inBuf[ i ] = inCount ? (uint8_t)( inFirst + i ) : inFirst;
+}
+
+//===========================================================================================================================
+//  sha_vector_test
+//===========================================================================================================================
+
+static OSStatus sha_vector_test( void )
+{
+    OSStatus            err = kNoErr;
+    USHAContext         ctx;
+    uint8_t             digest[ USHAMaxHashSize ];
+    const sha_vector_t *v;
+    size_t              i;
+    int                 j;
+
+    for( i = 0; i < sizeof( kSHA_Vectors ) / sizeof( kSHA_Vectors[ 0 ] ); ++i )
+    {
+        v = &kSHA_Vectors[ i ];
+        err = USHAReset( &ctx, v->sha );
+        require_noerr( err, exit );
+        for( j = 0; j < v->repeat; ++j )
+        {
+            err = USHAInput( &ctx, (const uint8_t *) v->message, strlen( v->message ) );
+            require_noerr( err, exit );
+        }
+        err = USHAResult( &ctx, digest );
+        require_noerr( err, exit );
+        require_action( sha_hex_equal( digest, v->digest, USHAHashSize( v->sha ) ), exit, err = kMismatchErr );
+    }
+
+    // One million 'a' again, in large inputs that are hashed in place.
+
+    memset( gSHA_BenchBuf, 'a', kSHA_BenchBufSize );
+    for( i = 2; i < sizeof( kSHA_Vectors ) / sizeof( kSHA_Vectors[ 0 ] ); i += 3 )
+    {
+        v = &kSHA_Vectors[ i ];
+        err = USHAReset( &ctx, v->sha );
+        require_noerr( err, exit );
+        for( j = 0; j < v->repeat; j += kSHA_BenchBufSize - 1 )
+        {
+            err = USHAInput( &ctx, &gSHA_BenchBuf[ j & 1 ], Min( kSHA_BenchBufSize - 1, v->repeat - j ) );
+            require_noerr( err, exit );
+        }
+        err = USHAResult( &ctx, digest );
+        require_noerr( err, exit );
+        require_action( sha_hex_equal( digest, v->digest, USHAHashSize( v->sha ) ), exit, err = kMismatchErr );
+    }
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  sha_split_test
+//
+//  Every length and alignment in one input is the same as one byte at a time, which only goes through Message_Block,
+//  and the same as inputs of every size that start at any point of a block.
+//===========================================================================================================================
+
+static OSStatus sha_split_test( void )
+{
+    OSStatus            err = kNoErr;
+    USHAContext         ctx;
+    uint8_t             ref[ USHAMaxHashSize ], digest[ USHAMaxHashSize ];
+    int                 sha, off, len, chunk, i, n;
+
+    for( i = 0; i < kSHA_BenchBufSize; ++i ) gSHA_BenchBuf[ i ] = (uint8_t)( i * 7 + ( i >> 8 ) );
+    for( sha = SHA1; sha <= SHA512; ++sha )
+    {
+        for( off = 0; off < 4; ++off )
+        {
+            for( len = 0; len <= 300; ++len )
+            {
+                err = USHAReset( &ctx, (SHAversion) sha );
+                require_noerr( err, exit );
+                for( i = 0; i < len; ++i )
+                {
+                    err = USHAInput( &ctx, &gSHA_BenchBuf[ off + i ], 1 );
+                    require_noerr( err, exit );
+                }
+                err = USHAResult( &ctx, ref );
+                require_noerr( err, exit );
+
+                err = USHAReset( &ctx, (SHAversion) sha );
+                require_noerr( err, exit );
+                err = USHAInput( &ctx, &gSHA_BenchBuf[ off ], len );
+                require_noerr( err, exit );
+                err = USHAResult( &ctx, digest );
+                require_noerr( err, exit );
+                require_action( memcmp( digest, ref, USHAHashSize( (SHAversion) sha ) ) == 0, exit, err = kMismatchErr );
+
+                chunk = 1 + ( len % 131 );
+                err = USHAReset( &ctx, (SHAversion) sha );
+                require_noerr( err, exit );
+                for( i = 0; i < len; i += n )
+                {
+                    n = Min( chunk, len - i );
+                    err = USHAInput( &ctx, &gSHA_BenchBuf[ off + i ], n );
+                    require_noerr( err, exit );
+                }
+                err = USHAResult( &ctx, digest );
+                require_noerr( err, exit );
+                require_action( memcmp( digest, ref, USHAHashSize( (SHAversion) sha ) ) == 0, exit, err = kMismatchErr );
+            }
+        }
+    }
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  sha_hmac_test
+//===========================================================================================================================
+
+static OSStatus sha_hmac_test( void )
+{
+    OSStatus                    err = kNoErr;
+    HMACKeyContext              key;
+    HMACContext                 ctx;
+    uint8_t                     keyBuf[ 200 ], ref[ USHAMaxHashSize ], mac[ USHAMaxHashSize ];
+    const sha_hmac_vector_t *   v;
+    const uint8_t *             k;
+    size_t                      i;
+    int                         sha, keyLen, len, kl;
+
+    for( i = 0; i < sizeof( kSHA_HMACVectors ) / sizeof( kSHA_HMACVectors[ 0 ] ); ++i )
+    {
+        v = &kSHA_HMACVectors[ i ];
+        sha_fill( keyBuf, v->key_len, 0xaa, 0 );
+        k  = v->key_len ? keyBuf : (const uint8_t *) "Jefe";
+        kl = v->key_len ? v->key_len : 4;
+
+        err = hmac( v->sha, (const uint8_t *) v->message, strlen( v->message ), k, kl, mac );
+        require_noerr( err, exit );
+        require_action( sha_hex_equal( mac, v->mac, USHAHashSize( v->sha ) ), exit, err = kMismatchErr );
+
+        // Same with the key pads hashed once, for two messages in a row.
+
+        memset( mac, 0, sizeof( mac ) );
+        err = hmacSetKey( &key, v->sha, k, kl );
+        require_noerr( err, exit );
+        for( len = 0; len < 2; ++len )
+        {
+            err = hmacResetWithKey( &ctx, &key ) ||
+                  hmacInput( &ctx, (const uint8_t *) v->message, 5 ) ||
+                  hmacInput( &ctx, (const uint8_t *) v->message + 5, strlen( v->message ) - 5 ) ||
+                  hmacResult( &ctx, mac );
+            require_noerr( err, exit );
+            require_action( sha_hex_equal( mac, v->mac, USHAHashSize( v->sha ) ), exit, err = kMismatchErr );
+        }
+    }
+
+    // Keys of every length up to past the largest block, with one key context used for every message length.
+
+    for( i = 0; i < sizeof( keyBuf ); ++i ) keyBuf[ i ] = (uint8_t)( i * 13 + 5 );
+    for( sha = SHA1; sha <= SHA512; ++sha )
+    {
+        for( keyLen = 0; keyLen <= (int) sizeof( keyBuf ); keyLen += 7 )
+        {
+            err = hmacSetKey( &key, (SHAversion) sha, keyBuf, keyLen );
+            require_noerr( err, exit );
+            for( len = 0; len <= 260; len += 37 )
+            {
+                err = hmac( (SHAversion) sha, gSHA_BenchBuf, len, keyBuf, keyLen, ref );
+                require_noerr( err, exit );
+                err = hmacResetWithKey( &ctx, &key ) ||
+                      hmacInput( &ctx, gSHA_BenchBuf, len ) ||
+                      hmacResult( &ctx, mac );
+                require_noerr( err, exit );
+                require_action( memcmp( mac, ref, USHAHashSize( (SHAversion) sha ) ) == 0, exit, err = kMismatchErr );
+            }
+        }
+    }
+
+    // A finished context is not used again until it is reset.
+
+    err = hmacResetWithKey( &ctx, &key ) || hmacResult( &ctx, mac );
+    require_noerr( err, exit );
+    require_action( hmacInput( &ctx, gSHA_BenchBuf, 1 ) == shaStateError, exit, err = kStateErr );
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  sha_hkdf_test
+//===========================================================================================================================
+
+static OSStatus sha_hkdf_test( void )
+{
+    OSStatus                    err = kNoErr;
+    HKDFContext                 ctx;
+    uint8_t                     ikm[ 80 ], salt[ 80 ], info[ 80 ], prk[ USHAMaxHashSize ], okm[ 82 ];
+    const sha_hkdf_vector_t *   v;
+    size_t                      i;
+
+    for( i = 0; i < sizeof( kSHA_HKDFVectors ) / sizeof( kSHA_HKDFVectors[ 0 ] ); ++i )
+    {
+        v = &kSHA_HKDFVectors[ i ];
+        sha_fill( ikm,  v->ikm_len,  v->ikm_first,  v->ikm_first == 0 );
+        sha_fill( salt, v->salt_len, v->salt_first, 1 );
+        sha_fill( info, v->info_len, v->info_first, 1 );
+
+        err = hkdf( v->sha, salt, v->salt_len, ikm, v->ikm_len, info, v->info_len, okm, v->okm_len );
+        require_noerr( err, exit );
+        require_action( sha_hex_equal( okm, v->okm, v->okm_len ), exit, err = kMismatchErr );
+
+        memset( okm, 0, sizeof( okm ) );
+        err = hkdfReset( &ctx, v->sha, salt, v->salt_len ) ||
+              hkdfInput( &ctx, ikm, 3 ) ||
+              hkdfInput( &ctx, ikm + 3, v->ikm_len - 3 ) ||
+              hkdfResult( &ctx, prk, info, v->info_len, okm, v->okm_len );
+        require_noerr( err, exit );
+        require_action( sha_hex_equal( okm, v->okm, v->okm_len ), exit, err = kMismatchErr );
+    }
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  sha_bench_report
+//===========================================================================================================================
+
+static void sha_bench_report( const char *inMode, size_t inLen, uint64_t inTicks, size_t inCount, const char *inPer )
+{
+    printf( "%-28s %5u bytes: %10.2f %s/%s\n", inMode, (unsigned int) inLen,
+        ( (double) inTicks * kSHA_BenchScale ) / (double) inCount, kSHA_BenchUnit, inPer );
+}
+
+//===========================================================================================================================
+//  sha_bench
+//===========================================================================================================================
+
+OSStatus    sha_bench( int print )
+{
+    static const size_t     kLengths[] = { 64, 256, 1024, kSHA_BenchBufSize };
+    static const struct { SHAversion sha; const char *name, *unaligned; } kHashes[] =
+    {
+        { SHA1,   "SHA-1",   "SHA-1, unaligned" },
+        { SHA256, "SHA-256", "SHA-256, unaligned" },
+        { SHA512, "SHA-512", "SHA-512, unaligned" }
+    };
+    OSStatus                err;
+    USHAContext             sha;
+    HMACKeyContext          key;
+    HMACContext             ctx;
+    uint8_t                 digest[ USHAMaxHashSize ], okm[ 64 ];
+    uint64_t                t;
+    size_t                  i, h, n, loops;
+
+    err = sha_vector_test();
+    require_noerr( err, exit );
+    err = sha_split_test();
+    require_noerr( err, exit );
+    err = sha_hmac_test();
+    require_noerr( err, exit );
+    err = sha_hkdf_test();
+    require_noerr( err, exit );
+    if( !print ) goto exit;
+
+    for( h = 0; h < sizeof( kHashes ) / sizeof( kHashes[ 0 ] ); ++h )
+    {
+        for( i = 0; i < sizeof( kLengths ) / sizeof( kLengths[ 0 ] ); ++i )
+        {
+            loops = ( 1024 * 1024 ) / kLengths[ i ];
+
+            t = sha_bench_ticks();
+            for( n = 0; n < loops; ++n )
+            {
+                USHAReset( &sha, kHashes[ h ].sha );
+                USHAInput( &sha, gSHA_BenchBuf, kLengths[ i ] );
+                USHAResult( &sha, digest );
+            }
+            sha_bench_report( kHashes[ h ].name, kLengths[ i ], sha_bench_ticks() - t, loops * kLengths[ i ], "byte" );
+
+            t = sha_bench_ticks();
+            for( n = 0; n < loops; ++n )
+            {
+                USHAReset( &sha, kHashes[ h ].sha );
+                USHAInput( &sha, &gSHA_BenchBuf[ 1 ], kLengths[ i ] );
+                USHAResult( &sha, digest );
+            }
+            sha_bench_report( kHashes[ h ].unaligned, kLengths[ i ], sha_bench_ticks() - t, loops * kLengths[ i ], "byte" );
+        }
+    }
+
+    // HMAC-SHA256 of short messages, with the key pads hashed for each message or once, and HKDF-SHA256.
+
+    loops = 20000;
+    for( i = 0; i < 3; ++i )
+    {
+        n = ( i == 0 ) ? 32 : ( i == 1 ) ? 64 : 256;
+
+        t = sha_bench_ticks();
+        for( h = 0; h < loops; ++h ) hmac( SHA256, gSHA_BenchBuf, n, gSHA_BenchBuf, 32, digest );
+        sha_bench_report( "HMAC-SHA256, hmac", n, sha_bench_ticks() - t, loops, "msg" );
+
+        hmacSetKey( &key, SHA256, gSHA_BenchBuf, 32 );
+        t = sha_bench_ticks();
+        for( h = 0; h < loops; ++h )
+        {
+            hmacResetWithKey( &ctx, &key );
+            hmacInput( &ctx, gSHA_BenchBuf, n );
+            hmacResult( &ctx, digest );
+        }
+        sha_bench_report( "HMAC-SHA256, key context", n, sha_bench_ticks() - t, loops, "msg" );
+    }
+
+    t = sha_bench_ticks();
+    for( h = 0; h < loops; ++h ) hkdf( SHA256, gSHA_BenchBuf, 32, gSHA_BenchBuf, 32, gSHA_BenchBuf, 16, okm, 64 );
+    sha_bench_report( "HKDF-SHA256, 64 byte okm", 32, sha_bench_ticks() - t, loops, "key" );
+
+exit:
+    printf( "%s: %s\n", __FUNCTION__, !err ? "PASSED" : "FAILED" );
+    return( err );
+}
+
+#if( defined( SHA_BENCH_MAIN ) )
+int main( void )
+{
+    return( sha_bench( 1 ) ? 1 : 0 );
+}
+#endif
@@ -406,6 +406,25 @@ static void uptime_Command(char *pcWriteBuffer, int xWriteBufferLen,int argc, ch
     cmd_printf("UP time %dms\r\n", mico_get_time());
 }
 
+#ifdef MICO_PROFILER_ENABLE
+static void top_Command(char *pcWriteBuffer, int xWriteBufferLen,int argc, char **argv)
+{
+  OSStatus err;
+  int seconds = 1;
+  
+  if (argc == 2 && !strcmp(argv[1], "-j")) {
+    err = mico_profiler_dump(cli_printf);
+  } else {
+    if (argc == 2)
+      seconds = atoi(argv[1]);
+    err = (seconds >= 0) ? mico_profiler_top(cli_printf, seconds * 1000) : kParamErr;
+  }
+  
+  if (err != kNoErr)
+    cmd_printf("Usage: top [seconds | -j], 0 for the usage since boot. Error %d\r\n", err);
+}
+#endif
+
 static void ota_Command(char *pcWriteBuffer, int xWriteBufferLen,int argc, char **argv)
 {
 extern void tftp_ota(void);
@@ -501,6 +520,9 @@ static const struct cli_command built_ins[] = {
   {"sockshow", "Show all sockets", socket_show_Command}, 
   // os
   {"tasklist", "list all thread name status", task_Command}, 
+#ifdef MICO_PROFILER_ENABLE
+  {"top", "CPU, switches and stack of threads: top [seconds | -j]", top_Command},
+#endif
   
   // others
   {"memshow", "print memory information", memory_show_Command}, 
@@ -597,8 +619,33 @@ static void micodebug_Command(char *pcWriteBuffer, int xWriteBufferLen,int argc,
   }
 }
 
-static const struct cli_command user_clis[1] = {
+#if MICO_LOG_DEFERRED && !defined(MICO_DISABLE_STDIO)
+static void log_Command(char *pcWriteBuffer, int xWriteBufferLen,int argc, char **argv)
+{
+  mico_log_stats_t stats;
+  
+  if (argc == 1) {
+    mico_log_get_stats(&stats);
+    cmd_printf("Log records: %u written, %u dropped, ring %u/%u bytes, high water %u, level %d\r\n",
+               stats.written, stats.dropped, stats.used, stats.size, stats.high_water, mico_log_get_level(NULL));
+    return;
+  }
+  
+  if (argc == 2 && !strcasecmp(argv[1], "flush")) {
+    mico_log_drain(NULL, NULL, 0);
+  } else if (argc == 3 && mico_log_set_level(argv[1], atoi(argv[2])) == kNoErr) {
+    cmd_printf("Log level of %s is %d\r\n", argv[1], atoi(argv[2]));
+  } else {
+    cmd_printf("Usage: log [flush | <module|*> <level 0-5>]\r\n");
+  }
+}
+#endif
+
+static const struct cli_command user_clis[] = {
   {"micodebug", "micodebug on/off", micodebug_Command},
+#if MICO_LOG_DEFERRED && !defined(MICO_DISABLE_STDIO)
+  {"log", "log [flush | <module|*> <level>]", log_Command},
+#endif
 };
 #endif
 
@@ -631,7 +678,7 @@ int cli_init(void)
                               }
   
 #if (DEBUG)
-  cli_register_commands(user_clis, 1);
+  cli_register_commands(user_clis, sizeof(user_clis) / sizeof(struct cli_command));
 #endif
   
   ret = mico_rtos_create_thread(NULL, MICO_DEFAULT_WORKER_PRIORITY, "cli", cli_main, 4096, 0);
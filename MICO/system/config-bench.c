@@ -0,0 +1,1083 @@
+/**
+******************************************************************************
+* @file    config-bench.c
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   Config server tests with a loopback client, and the memory per
+*          connection and keep-alive requests per second.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+/* Built on the host only: config_server.c is included below and runs on pthreads, its listener is bound to an
+ * ephemeral port of 127.0.0.1 and the bench is the client. Build it once without and once with
+ * -DMICO_CONFIG_SERVER_MULTIPLEX. MICO/system/host holds the stub platform headers and maps the MICO socket calls
+ * to the ones of the host:
+ *
+ *   J=libraries/utilities/json_c
+ *   cc -O2 -pthread -DDEBUG=0 -DCONFIG_BENCH_MAIN [-DMICO_CONFIG_SERVER_MULTIPLEX] -IMICO/system/host -Iinclude \
+ *      -IMICO/system -Ilibraries/utilities -I$J MICO/system/config-bench.c MICO/system/config_server/config_server_menu.c \
+ *      libraries/utilities/HTTPUtils.c libraries/utilities/SocketUtils.c libraries/utilities/StringUtils.c \
+ *      libraries/utilities/URLUtils.c libraries/utilities/CheckSumUtils.c $J/arraylist.c $J/debug.c $J/json_arena.c $J/json_object.c $J/json_sax.c \
+ *      $J/json_tokener.c $J/json_util.c $J/linkhash.c $J/printbuf.c -o config-bench && ./config-bench
+ *
+ * The memory of a connection is the heap the server holds for an idle keep-alive client, counted through the glibc
+ * malloc (not with a sanitizer), plus the stack of its thread or its slot in config_clients[]. The heap is the one of
+ * the host, with 64-bit pointers. The thread control blocks and semaphores of the RTOS are not counted.
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+
+// <netinet/in.h> defines them as macros when optimizing, Common.h defines them again
+#undef htons
+#undef ntohs
+#undef htonl
+#undef ntohl
+
+#include "MICO.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if( defined( CONFIG_BENCH_MAIN ) )
+
+// The report is built in its arena as on the target, json_object is larger with 64-bit pointers
+#define MICO_CONFIG_SERVER_REPORT_ARENA_SIZE    ( 2 * 6144 )
+
+#include "config_server/config_server.c"
+
+#if( defined( __GLIBC__ ) )
+    #include <malloc.h>
+#endif
+
+// config_server.c above calls the MICO ones, the bench implements them with the host ones
+
+#undef bind
+#undef accept
+#undef inet_ntoa
+#undef select
+
+#ifdef MICO_CONFIG_SERVER_MULTIPLEX
+    #define kConfig_BenchMode           "multiplexed"
+#else
+    #define kConfig_BenchMode           "thread per client"
+#endif
+
+#define kConfig_BenchThreads            ( MICO_CONFIG_SERVER_MAX_CLIENTS + 4 )
+#define kConfig_BenchSemaphores         ( MAX_TCP_CLIENT_PER_SERVER + 4 )
+#define kConfig_BenchBufferSize         8192
+#define kConfig_BenchTimeout            5000    // ms, a client waiting longer fails the test
+#define kConfig_BenchSeconds            1       // Length of the throughput loop for each number of clients
+
+static int                  gConfig_BenchPort;
+static system_context_t     gConfig_BenchContext;
+static long                 gConfig_BenchHeap;      // Heap bytes in use
+static long                 gConfig_BenchStack;     // Stack bytes of the running threads
+static long                 gConfig_BenchRunning;   // Running threads
+static long                 gConfig_BenchWaiting;   // Threads blocked in select()
+static long                 gConfig_BenchUpdates;   // mico_system_context_update calls
+static long                 gConfig_BenchResets;    // mico_system_power_perform( eState_Software_Reset ) calls
+static pthread_mutex_t      gConfig_BenchLock = PTHREAD_MUTEX_INITIALIZER;
+
+#if( defined( __GLIBC__ ) && !defined( __SANITIZE_ADDRESS__ ) )
+    #define kConfig_BenchCounted        1
+
+    extern void *   __libc_malloc( size_t size );
+    extern void *   __libc_calloc( size_t count, size_t size );
+    extern void *   __libc_realloc( void *ptr, size_t size );
+    extern void     __libc_free( void *ptr );
+
+    static void config_bench_count( long inBytes )
+    {
+        __atomic_add_fetch( &gConfig_BenchHeap, inBytes, __ATOMIC_RELAXED );
+    }
+
+    void * malloc( size_t size )
+    {
+        void * const    ptr = __libc_malloc( size );
+
+        if( ptr ) config_bench_count( (long) malloc_usable_size( ptr ) );
+        return( ptr );
+    }
+
+    void * calloc( size_t count, size_t size )
+    {
+        void * const    ptr = __libc_calloc( count, size );
+
+        if( ptr ) config_bench_count( (long) malloc_usable_size( ptr ) );
+        return( ptr );
+    }
+
+    void * realloc( void *ptr, size_t size )
+    {
+        long const      old = ptr ? (long) malloc_usable_size( ptr ) : 0;
+        void * const    newPtr = __libc_realloc( ptr, size );
+
+        if( newPtr )            config_bench_count( (long) malloc_usable_size( newPtr ) - old );
+        else if( size == 0 )    config_bench_count( -old );
+        return( newPtr );
+    }
+
+    void free( void *ptr )
+    {
+        if( ptr ) config_bench_count( -(long) malloc_usable_size( ptr ) );
+        __libc_free( ptr );
+    }
+#else
+    #define kConfig_BenchCounted        0
+#endif
+
+//===========================================================================================================================
+//  RTOS on the host
+//===========================================================================================================================
+
+// Threads run on pthreads. The thread functions of the config server return right after deleting themselves, so
+// mico_rtos_delete_thread( NULL ) only releases the thread's stack from the count.
+
+typedef struct
+{
+    int                         used;
+    mico_thread_function_t      function;
+    void *                      arg;
+    uint32_t                    stackSize;
+} config_bench_thread_t;
+
+typedef struct
+{
+    int                         used;
+    int                         fds[ 2 ];   // A byte in the socket pair is a count, fds[ 0 ] is the event fd
+} config_bench_semaphore_t;
+
+static config_bench_thread_t        gConfig_BenchThreadTable[ kConfig_BenchThreads ];
+static config_bench_semaphore_t     gConfig_BenchSemaphoreTable[ kConfig_BenchSemaphores ];
+static pthread_mutex_t              gConfig_BenchMutexTable[ 2 ] = { PTHREAD_MUTEX_INITIALIZER, PTHREAD_MUTEX_INITIALIZER };
+static int                          gConfig_BenchMutexes;
+static __thread config_bench_thread_t * gConfig_BenchSelf;
+
+static void * config_bench_thread( void *inThread )
+{
+    gConfig_BenchSelf = (config_bench_thread_t *) inThread;
+    gConfig_BenchSelf->function( gConfig_BenchSelf->arg );
+    return( NULL );
+}
+
+OSStatus mico_rtos_create_thread( mico_thread_t* thread, uint8_t priority, const char* name, mico_thread_function_t function, uint32_t stack_size, void* arg )
+{
+    OSStatus                    err = kNoResourcesErr;
+    config_bench_thread_t *     self = NULL;
+    pthread_attr_t              attr;
+    pthread_t                   tid;
+    int                         i;
+
+    (void) priority;
+    (void) name;
+
+    pthread_mutex_lock( &gConfig_BenchLock );
+    for( i = 0; i < kConfig_BenchThreads; ++i )
+    {
+        if( gConfig_BenchThreadTable[ i ].used ) continue;
+        self = &gConfig_BenchThreadTable[ i ];
+        self->used = 1;
+        self->function = function;
+        self->arg = arg;
+        self->stackSize = stack_size;
+        gConfig_BenchStack += stack_size;
+        gConfig_BenchRunning++;
+        break;
+    }
+    pthread_mutex_unlock( &gConfig_BenchLock );
+    require( self, exit );
+
+    pthread_attr_init( &attr );
+    pthread_attr_setdetachstate( &attr, PTHREAD_CREATE_DETACHED );
+    if( pthread_create( &tid, &attr, config_bench_thread, self ) != 0 )
+    {
+        gConfig_BenchSelf = self;
+        mico_rtos_delete_thread( NULL );
+        gConfig_BenchSelf = NULL;
+    }
+    else
+    {
+        if( thread ) *thread = self;
+        err = kNoErr;
+    }
+    pthread_attr_destroy( &attr );
+
+exit:
+    return( err );
+}
+
+OSStatus mico_rtos_delete_thread( mico_thread_t* thread )
+{
+    config_bench_thread_t * const   self = gConfig_BenchSelf;
+
+    if( thread || !self ) return( kParamErr );
+    pthread_mutex_lock( &gConfig_BenchLock );
+    gConfig_BenchStack -= self->stackSize;
+    gConfig_BenchRunning--;
+    self->used = 0;
+    pthread_mutex_unlock( &gConfig_BenchLock );
+    return( kNoErr );
+}
+
+OSStatus mico_rtos_init_semaphore( mico_semaphore_t* semaphore, int count )
+{
+    OSStatus    err = kNoResourcesErr;
+    int         i;
+
+    (void) count;
+    pthread_mutex_lock( &gConfig_BenchLock );
+    for( i = 0; i < kConfig_BenchSemaphores; ++i )
+    {
+        if( gConfig_BenchSemaphoreTable[ i ].used ) continue;
+        if( socketpair( AF_UNIX, SOCK_STREAM, 0, gConfig_BenchSemaphoreTable[ i ].fds ) != 0 ) break;
+        gConfig_BenchSemaphoreTable[ i ].used = 1;
+        *semaphore = &gConfig_BenchSemaphoreTable[ i ];
+        err = kNoErr;
+        break;
+    }
+    pthread_mutex_unlock( &gConfig_BenchLock );
+    return( err );
+}
+
+OSStatus mico_rtos_set_semaphore( mico_semaphore_t* semaphore )
+{
+    config_bench_semaphore_t * const    sem = (config_bench_semaphore_t *) *semaphore;
+
+    return( ( write( sem->fds[ 1 ], "", 1 ) == 1 ) ? kNoErr : kUnknownErr );
+}
+
+OSStatus mico_rtos_get_semaphore( mico_semaphore_t* semaphore, uint32_t timeout_ms )
+{
+    config_bench_semaphore_t * const    sem = (config_bench_semaphore_t *) *semaphore;
+    struct pollfd                       pfd;
+    char                                c;
+
+    pfd.fd = sem->fds[ 0 ];
+    pfd.events = POLLIN;
+    if( poll( &pfd, 1, ( timeout_ms == MICO_WAIT_FOREVER ) ? -1 : (int) timeout_ms ) != 1 ) return( kTimeoutErr );
+    return( ( read( sem->fds[ 0 ], &c, 1 ) == 1 ) ? kNoErr : kUnknownErr );
+}
+
+OSStatus mico_rtos_deinit_semaphore( mico_semaphore_t* semaphore )
+{
+    config_bench_semaphore_t * const    sem = (config_bench_semaphore_t *) *semaphore;
+
+    pthread_mutex_lock( &gConfig_BenchLock );
+    close( sem->fds[ 0 ] );
+    close( sem->fds[ 1 ] );
+    sem->used = 0;
+    pthread_mutex_unlock( &gConfig_BenchLock );
+    return( kNoErr );
+}
+
+int mico_create_event_fd( mico_event handle )
+{
+    return( ( (config_bench_semaphore_t *) handle )->fds[ 0 ] );
+}
+
+int mico_delete_event_fd( int fd )
+{
+    (void) fd;
+    return( 0 );
+}
+
+OSStatus mico_rtos_init_mutex( mico_mutex_t* mutex )
+{
+    if( gConfig_BenchMutexes == sizeof( gConfig_BenchMutexTable ) / sizeof( gConfig_BenchMutexTable[ 0 ] ) ) return( kNoResourcesErr );
+    *mutex = &gConfig_BenchMutexTable[ gConfig_BenchMutexes++ ];
+    return( kNoErr );
+}
+
+OSStatus mico_rtos_lock_mutex( mico_mutex_t* mutex )
+{
+    return( pthread_mutex_lock( (pthread_mutex_t *) *mutex ) ? kUnknownErr : kNoErr );
+}
+
+OSStatus mico_rtos_unlock_mutex( mico_mutex_t* mutex )
+{
+    return( pthread_mutex_unlock( (pthread_mutex_t *) *mutex ) ? kUnknownErr : kNoErr );
+}
+
+uint32_t mico_get_time( void )
+{
+    struct timespec     ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return( (uint32_t)( ts.tv_sec * 1000 + ts.tv_nsec / 1000000 ) );
+}
+
+void mico_thread_msleep( uint32_t milliseconds )
+{
+    struct timespec     ts;
+
+    ts.tv_sec = milliseconds / 1000;
+    ts.tv_nsec = ( milliseconds % 1000 ) * 1000000;
+    nanosleep( &ts, NULL );
+}
+
+//===========================================================================================================================
+//  Sockets, flash and system on the host
+//===========================================================================================================================
+
+// The listener asks for MICO_CONFIG_SERVER_PORT on any address, it gets an ephemeral port of 127.0.0.1.
+
+int config_bench_bind( int sockfd, const struct sockaddr_t *addr, int addrlen )
+{
+    struct sockaddr_in  sin;
+    socklen_t           len = sizeof( sin );
+
+    (void) addr;
+    (void) addrlen;
+    memset( &sin, 0, sizeof( sin ) );
+    sin.sin_family = AF_INET;
+    sin.sin_addr.s_addr = hton32( INADDR_LOOPBACK );
+    if( bind( sockfd, (struct sockaddr *) &sin, sizeof( sin ) ) != 0 ) return( -1 );
+    if( getsockname( sockfd, (struct sockaddr *) &sin, &len ) != 0 ) return( -1 );
+    __atomic_store_n( &gConfig_BenchPort, ntoh16( sin.sin_port ), __ATOMIC_RELEASE );
+    return( 0 );
+}
+
+int config_bench_accept( int sockfd, struct sockaddr_t *addr, int *addrlen )
+{
+    struct sockaddr_in  sin;
+    socklen_t           len = sizeof( sin );
+    int                 fd;
+
+    fd = accept( sockfd, (struct sockaddr *) &sin, &len );
+    if( fd < 0 ) return( fd );
+    memset( addr, 0, sizeof( *addr ) );
+    addr->s_ip = ntoh32( sin.sin_addr.s_addr );
+    addr->s_port = ntoh16( sin.sin_port );
+    *addrlen = sizeof( *addr );
+    return( fd );
+}
+
+char * config_bench_inet_ntoa( char *s, uint32_t x )
+{
+    sprintf( s, "%u.%u.%u.%u", (unsigned int)( ( x >> 24 ) & 0xFF ), (unsigned int)( ( x >> 16 ) & 0xFF ),
+             (unsigned int)( ( x >> 8 ) & 0xFF ), (unsigned int)( x & 0xFF ) );
+    return( s );
+}
+
+// MICO's select() ignores nfds, the thread per client server passes 1
+
+int config_bench_select( int nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds, struct timeval *timeout )
+{
+    int     fd, n;
+
+    (void) nfds;
+    for( nfds = 0, fd = 0; fd < FD_SETSIZE; ++fd )
+    {
+        if( ( readfds   && FD_ISSET( fd, readfds   ) ) ||
+            ( writefds  && FD_ISSET( fd, writefds  ) ) ||
+            ( exceptfds && FD_ISSET( fd, exceptfds ) ) ) nfds = fd + 1;
+    }
+    __atomic_add_fetch( &gConfig_BenchWaiting, 1, __ATOMIC_SEQ_CST );
+    n = select( nfds, readfds, writefds, exceptfds, timeout );
+    __atomic_sub_fetch( &gConfig_BenchWaiting, 1, __ATOMIC_SEQ_CST );
+    return( n );
+}
+
+micoMemInfo_t* MicoGetMemoryInfo( void )
+{
+    static micoMemInfo_t    info;
+
+    info.allocted_memory = (int) __atomic_load_n( &gConfig_BenchHeap, __ATOMIC_RELAXED );
+    return( &info );
+}
+
+mico_logic_partition_t* MicoFlashGetInfo( mico_partition_t inPartition )
+{
+    static mico_logic_partition_t   none = { MICO_FLASH_NONE, "NONE", 0, 0, 0 };
+
+    (void) inPartition;
+    return( &none );
+}
+
+OSStatus MicoFlashErase( mico_partition_t inPartition, uint32_t off_set, uint32_t size )
+{
+    (void) inPartition;
+    (void) off_set;
+    (void) size;
+    return( kUnsupportedErr );
+}
+
+OSStatus MicoFlashWrite( mico_partition_t inPartition, volatile uint32_t* off_set, uint8_t* inBuffer, uint32_t inBufferLength )
+{
+    (void) inPartition;
+    (void) off_set;
+    (void) inBuffer;
+    (void) inBufferLength;
+    return( kUnsupportedErr );
+}
+
+OSStatus mico_system_context_update( mico_Context_t* const in_context )
+{
+    (void) in_context;
+    __atomic_add_fetch( &gConfig_BenchUpdates, 1, __ATOMIC_RELAXED );
+    return( kNoErr );
+}
+
+OSStatus mico_system_power_perform( mico_Context_t* const in_context, mico_system_state_t new_state )
+{
+    (void) in_context;
+    if( new_state == eState_Software_Reset ) __atomic_add_fetch( &gConfig_BenchResets, 1, __ATOMIC_RELAXED );
+    return( kNoErr );
+}
+
+OSStatus ConfigIncommingJsonMessageUAP( const uint8_t *input, size_t size )
+{
+    (void) input;
+    (void) size;
+    return( kUnsupportedErr );
+}
+
+OSStatus micoWlanSuspendSoftAP( void )
+{
+    return( kNoErr );
+}
+
+void mico_system_delegate_config_recv_ssid( char *ssid, char *key )
+{
+    (void) ssid;
+    (void) key;
+}
+
+void system_connect_wifi_normal( system_context_t * const inContext )
+{
+    (void) inContext;
+}
+
+//===========================================================================================================================
+//  Client
+//===========================================================================================================================
+
+typedef struct
+{
+    int         fd;
+    size_t      len;                            // Bytes received and not returned yet
+    char        buf[ kConfig_BenchBufferSize ];
+} config_bench_client_t;
+
+static config_bench_client_t    gConfig_BenchClients[ MICO_CONFIG_SERVER_MAX_CLIENTS + 1 ];
+
+// Condition polled every millisecond, false after inMs
+
+#define config_bench_wait( COND, MS ) \
+    do { uint32_t config_bench_t0_ = mico_get_time(); \
+         while( !( COND ) && mico_get_time() - config_bench_t0_ < (MS) ) mico_thread_msleep( 1 ); } while( 0 )
+
+static OSStatus config_bench_connect( config_bench_client_t *inClient )
+{
+    OSStatus            err = kNoErr;
+    struct sockaddr_in  sin;
+    struct timeval      tv;
+    int                 one = 1;
+
+    inClient->len = 0;
+    inClient->fd = socket( AF_INET, SOCK_STREAM, 0 );
+    require_action( inClient->fd >= 0, exit, err = kNoResourcesErr );
+    setsockopt( inClient->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof( one ) );
+    tv.tv_sec = kConfig_BenchTimeout / 1000;
+    tv.tv_usec = 0;
+    setsockopt( inClient->fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof( tv ) );
+
+    memset( &sin, 0, sizeof( sin ) );
+    sin.sin_family = AF_INET;
+    sin.sin_port = hton16( (uint16_t) gConfig_BenchPort );
+    sin.sin_addr.s_addr = hton32( INADDR_LOOPBACK );
+    require_action( connect( inClient->fd, (struct sockaddr *) &sin, sizeof( sin ) ) == 0, exit, err = kConnectionErr );
+
+exit:
+    return( err );
+}
+
+static void config_bench_disconnect( config_bench_client_t *inClient )
+{
+    if( inClient->fd >= 0 ) close( inClient->fd );
+    inClient->fd = -1;
+}
+
+static OSStatus config_bench_send( config_bench_client_t *inClient, const char *inData, size_t inLen )
+{
+    ssize_t     n;
+
+    for( ; inLen > 0; inData += n, inLen -= (size_t) n )
+    {
+        n = write( inClient->fd, inData, inLen );
+        if( n <= 0 ) return( kWriteErr );
+    }
+    return( kNoErr );
+}
+
+static OSStatus config_bench_get( config_bench_client_t *inClient )
+{
+    static const char   kRequest[] = "GET /config-read HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n";
+
+    return( config_bench_send( inClient, kRequest, sizeof( kRequest ) - 1 ) );
+}
+
+static OSStatus config_bench_post( config_bench_client_t *inClient, const char *inJSON )
+{
+    char    request[ 512 ];
+    int     n;
+
+    n = snprintf( request, sizeof( request ), "POST /config-write HTTP/1.1\r\nContent-Type: application/json\r\n"
+                  "Content-Length: %u\r\n\r\n%s", (unsigned int) strlen( inJSON ), inJSON );
+    if( n < 0 || n >= (int) sizeof( request ) ) return( kSizeErr );
+    return( config_bench_send( inClient, request, (size_t) n ) );
+}
+
+// Next response on the connection: the status code and its body, NUL terminated in outBody when it is not NULL
+
+static OSStatus config_bench_response( config_bench_client_t *inClient, int *outStatus, char *outBody, size_t inBodyMax )
+{
+    OSStatus        err = kNoErr;
+    char *          end = NULL;
+    char *          field;
+    size_t          headerLen, bodyLen = 0;
+    ssize_t         n;
+
+    for( ;; )
+    {
+        if( inClient->len > 0 )
+        {
+            inClient->buf[ inClient->len ] = '\0';
+            end = strstr( inClient->buf, "\r\n\r\n" );
+        }
+        if( end )
+        {
+            headerLen = (size_t)( end + 4 - inClient->buf );
+            field = strstr( inClient->buf, "Content-Length:" );
+            if( field && field < end ) bodyLen = strtoul( field + 15, NULL, 10 );
+            if( inClient->len >= headerLen + bodyLen ) break;
+        }
+        require_action( inClient->len < sizeof( inClient->buf ) - 1, exit, err = kSizeErr );
+        n = read( inClient->fd, inClient->buf + inClient->len, sizeof( inClient->buf ) - 1 - inClient->len );
+        require_action( n != 0, exit, err = kConnectionErr );
+        require_action( n > 0, exit, err = kTimeoutErr );
+        inClient->len += (size_t) n;
+    }
+
+    require_action( strncmp( inClient->buf, "HTTP/1.1 ", 9 ) == 0, exit, err = kMalformedErr );
+    *outStatus = atoi( inClient->buf + 9 );
+    if( outBody )
+    {
+        require_action( bodyLen < inBodyMax, exit, err = kSizeErr );
+        memcpy( outBody, inClient->buf + headerLen, bodyLen );
+        outBody[ bodyLen ] = '\0';
+    }
+    inClient->len -= headerLen + bodyLen;
+    memmove( inClient->buf, inClient->buf + headerLen + bodyLen, inClient->len );
+
+exit:
+    return( err );
+}
+
+// The server closed the connection, without a response
+
+static bool config_bench_closed( config_bench_client_t *inClient )
+{
+    char        c;
+
+    return( inClient->len == 0 && read( inClient->fd, &c, 1 ) <= 0 && errno != EAGAIN );
+}
+
+// The name in the report, the first cell of sector "MICO SYSTEM"
+
+static OSStatus config_bench_report_name( const char *inBody, char *outName, size_t inNameMax )
+{
+    OSStatus        err = kNoErr;
+    json_object *   report, *cell;
+
+    report = json_tokener_parse( inBody );
+    require_action( report, exit, err = kMalformedErr );
+    require_action( strcmp( json_object_get_string( json_object_object_get( report, "N" ) ), MODEL "(000001)" ) == 0,
+                    exit, err = kMismatchErr );
+    cell = json_object_array_get_idx( json_object_object_get( json_object_array_get_idx(
+                json_object_object_get( report, "C" ), 0 ), "C" ), 0 );
+    require_action( cell, exit, err = kMalformedErr );
+    require_action( strcmp( json_object_get_string( json_object_object_get( cell, "N" ) ), "Device Name" ) == 0, exit,
+                    err = kMismatchErr );
+    strncpy( outName, json_object_get_string( json_object_object_get( cell, "C" ) ), inNameMax - 1 );
+    outName[ inNameMax - 1 ] = '\0';
+
+exit:
+    if( report ) json_object_put( report );
+    return( err );
+}
+
+static OSStatus config_bench_read_name( config_bench_client_t *inClient, char *outName, size_t inNameMax )
+{
+    static char     body[ kConfig_BenchBufferSize ];
+    OSStatus        err;
+    int             status;
+
+    err = config_bench_response( inClient, &status, body, sizeof( body ) );
+    require_noerr( err, exit );
+    require_action( status == 200, exit, err = kResponseErr );
+    err = config_bench_report_name( body, outName, inNameMax );
+
+exit:
+    return( err );
+}
+
+// Connect and wait for one /config-read: the listener has a backlog of 0, the next client connects once this one is
+// accepted.
+
+static OSStatus config_bench_open( config_bench_client_t *inClient )
+{
+    OSStatus        err;
+    char            name[ maxNameLen ];
+
+    err = config_bench_connect( inClient );
+    require_noerr( err, exit );
+    err = config_bench_get( inClient );
+    require_noerr( err, exit );
+    err = config_bench_read_name( inClient, name, sizeof( name ) );
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  config_read_test
+//===========================================================================================================================
+
+// /config-read reports the configuration and keeps the connection, an unknown URL closes it.
+
+static OSStatus config_read_test( void )
+{
+    static const char           kUnknown[] = "GET /config-nothing HTTP/1.1\r\n\r\n";
+    OSStatus                    err;
+    config_bench_client_t *     client = &gConfig_BenchClients[ 0 ];
+    char                        name[ maxNameLen ];
+    int                         i;
+
+    err = config_bench_connect( client );
+    require_noerr( err, exit );
+    for( i = 0; i < 3; ++i )
+    {
+        err = config_bench_get( client );
+        require_noerr( err, exit );
+        err = config_bench_read_name( client, name, sizeof( name ) );
+        require_noerr( err, exit );
+        require_action( strcmp( name, gConfig_BenchContext.flashContentInRam.micoSystemConfig.name ) == 0, exit,
+                        err = kMismatchErr );
+    }
+
+    err = config_bench_send( client, kUnknown, sizeof( kUnknown ) - 1 );
+    require_noerr( err, exit );
+    require_action( config_bench_closed( client ), exit, err = kStateErr );
+
+exit:
+    config_bench_disconnect( client );
+    return( err );
+}
+
+//===========================================================================================================================
+//  config_write_test
+//===========================================================================================================================
+
+// /config-write is answered first, then applied and followed by a reset. The next request on the connection sees it.
+
+static OSStatus config_write_test( void )
+{
+    OSStatus                    err;
+    config_bench_client_t *     client = &gConfig_BenchClients[ 0 ];
+    char                        name[ maxNameLen ];
+    long                        updates, resets;
+    int                         status;
+
+    updates = __atomic_load_n( &gConfig_BenchUpdates, __ATOMIC_RELAXED );
+    resets = __atomic_load_n( &gConfig_BenchResets, __ATOMIC_RELAXED );
+
+    err = config_bench_connect( client );
+    require_noerr( err, exit );
+    err = config_bench_post( client, "{\"Device Name\":\"Bench write\",\"DHCP\":false}" );
+    require_noerr( err, exit );
+    err = config_bench_response( client, &status, NULL, 0 );
+    require_noerr( err, exit );
+    require_action( status == 200, exit, err = kResponseErr );
+
+    err = config_bench_get( client );
+    require_noerr( err, exit );
+    err = config_bench_read_name( client, name, sizeof( name ) );
+    require_noerr( err, exit );
+    require_action( strcmp( name, "Bench write" ) == 0, exit, err = kMismatchErr );
+    require_action( gConfig_BenchContext.flashContentInRam.micoSystemConfig.dhcpEnable == false, exit, err = kMismatchErr );
+    require_action( __atomic_load_n( &gConfig_BenchUpdates, __ATOMIC_RELAXED ) == updates + 1, exit, err = kCountErr );
+    require_action( __atomic_load_n( &gConfig_BenchResets, __ATOMIC_RELAXED ) == resets + 1, exit, err = kCountErr );
+
+    // A broken object is answered and not applied
+
+    err = config_bench_post( client, "{\"Device Name\":\"Bench broken\"" );
+    require_noerr( err, exit );
+    err = config_bench_response( client, &status, NULL, 0 );
+    require_noerr( err, exit );
+    require_action( status == 200, exit, err = kResponseErr );
+    require_action( config_bench_closed( client ), exit, err = kStateErr );
+    require_action( strcmp( gConfig_BenchContext.flashContentInRam.micoSystemConfig.name, "Bench write" ) == 0, exit,
+                    err = kMismatchErr );
+
+exit:
+    config_bench_disconnect( client );
+    return( err );
+}
+
+//===========================================================================================================================
+//  config_split_test
+//===========================================================================================================================
+
+// Requests sent in one write are answered in order, and a request sent a byte at a time is answered once complete.
+
+static OSStatus config_split_test( void )
+{
+    static const char           kGet[] = "GET /config-read HTTP/1.1\r\n\r\n";
+    OSStatus                    err;
+    config_bench_client_t *     client = &gConfig_BenchClients[ 0 ];
+    char                        request[ 512 ], name[ maxNameLen ];
+    int                         n, status;
+    size_t                      i;
+
+    err = config_bench_connect( client );
+    require_noerr( err, exit );
+    n = snprintf( request, sizeof( request ), "%sPOST /config-write HTTP/1.1\r\nContent-Length: 28\r\n\r\n"
+                  "{\"Device Name\":\"Bench pipe\"}%s", kGet, kGet );
+    err = config_bench_send( client, request, (size_t) n );
+    require_noerr( err, exit );
+    err = config_bench_read_name( client, name, sizeof( name ) );
+    require_noerr( err, exit );
+    require_action( strcmp( name, "Bench write" ) == 0, exit, err = kMismatchErr );
+    err = config_bench_response( client, &status, NULL, 0 );
+    require_noerr( err, exit );
+    require_action( status == 200, exit, err = kResponseErr );
+    err = config_bench_read_name( client, name, sizeof( name ) );
+    require_noerr( err, exit );
+    require_action( strcmp( name, "Bench pipe" ) == 0, exit, err = kMismatchErr );
+
+    for( i = 0; i < sizeof( kGet ) - 1; ++i )
+    {
+        err = config_bench_send( client, &kGet[ i ], 1 );
+        require_noerr( err, exit );
+        mico_thread_msleep( 1 );
+    }
+    err = config_bench_read_name( client, name, sizeof( name ) );
+    require_noerr( err, exit );
+    require_action( strcmp( name, "Bench pipe" ) == 0, exit, err = kMismatchErr );
+
+exit:
+    config_bench_disconnect( client );
+    return( err );
+}
+
+//===========================================================================================================================
+//  config_stall_test
+//===========================================================================================================================
+
+// A client that stops in the middle of a header or of a chunked body does not hold up the others. The config server
+// takes no chunked body, the connection is closed once it has ended.
+
+static OSStatus config_stall_test( void )
+{
+    static const char           kGet[] = "GET /config-read HTTP/1.1\r\n\r\n";
+    static const char           kChunked[] = "POST /config-write HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+                                             "9\r\n{\"Device \r\n14\r\nName\":\"Bench chunk\"}\r\n0\r\n\r\n";
+    OSStatus                    err;
+    config_bench_client_t *     stalled = &gConfig_BenchClients[ 0 ];
+    config_bench_client_t *     other = &gConfig_BenchClients[ 1 ];
+    char                        name[ maxNameLen ];
+    size_t                      n;
+
+    err = config_bench_open( stalled );
+    require_noerr( err, exit );
+    err = config_bench_open( other );
+    require_noerr( err, exit );
+
+    err = config_bench_send( stalled, kGet, 10 );
+    require_noerr( err, exit );
+    mico_thread_msleep( 20 );
+    err = config_bench_get( other );
+    require_noerr( err, exit );
+    err = config_bench_read_name( other, name, sizeof( name ) );
+    require_noerr( err, exit );
+    err = config_bench_send( stalled, kGet + 10, sizeof( kGet ) - 1 - 10 );
+    require_noerr( err, exit );
+    err = config_bench_read_name( stalled, name, sizeof( name ) );
+    require_noerr( err, exit );
+
+    n = (size_t)( strstr( kChunked, "14\r\n" ) - kChunked );
+    err = config_bench_send( stalled, kChunked, n );
+    require_noerr( err, exit );
+    mico_thread_msleep( 20 );
+    err = config_bench_get( other );
+    require_noerr( err, exit );
+    err = config_bench_read_name( other, name, sizeof( name ) );
+    require_noerr( err, exit );
+    err = config_bench_send( stalled, kChunked + n, sizeof( kChunked ) - 1 - n );
+    require_noerr( err, exit );
+    require_action( config_bench_closed( stalled ), exit, err = kStateErr );
+    require_action( strcmp( gConfig_BenchContext.flashContentInRam.micoSystemConfig.name, "Bench pipe" ) == 0, exit,
+                    err = kMismatchErr );
+
+exit:
+    config_bench_disconnect( stalled );
+    config_bench_disconnect( other );
+    return( err );
+}
+
+//===========================================================================================================================
+//  config_limit_test
+//===========================================================================================================================
+
+// With MICO_CONFIG_SERVER_MULTIPLEX a client beyond the table is closed, its slot is free again once a client leaves.
+// The thread per client server leaves such a client open, it is not tested.
+
+static OSStatus config_limit_test( void )
+{
+    OSStatus                    err = kNoErr;
+#ifdef MICO_CONFIG_SERVER_MULTIPLEX
+    config_bench_client_t *     extra = &gConfig_BenchClients[ MICO_CONFIG_SERVER_MAX_CLIENTS ];
+    char                        name[ maxNameLen ];
+    int                         i;
+
+    for( i = 0; i < MICO_CONFIG_SERVER_MAX_CLIENTS; ++i )
+    {
+        err = config_bench_open( &gConfig_BenchClients[ i ] );
+        require_noerr( err, exit );
+    }
+
+    err = config_bench_connect( extra );
+    require_noerr( err, exit );
+    require_action( config_bench_closed( extra ), exit, err = kStateErr );
+    config_bench_disconnect( extra );
+
+    config_bench_disconnect( &gConfig_BenchClients[ 0 ] );
+    config_bench_wait( config_clients[ 0 ].fd < 0, kConfig_BenchTimeout );
+    err = config_bench_connect( extra );
+    require_noerr( err, exit );
+    err = config_bench_get( extra );
+    require_noerr( err, exit );
+    err = config_bench_read_name( extra, name, sizeof( name ) );
+    require_noerr( err, exit );
+
+exit:
+    for( i = 0; i <= MICO_CONFIG_SERVER_MAX_CLIENTS; ++i ) config_bench_disconnect( &gConfig_BenchClients[ i ] );
+#endif
+    return( err );
+}
+
+//===========================================================================================================================
+//  config_bench_idle
+//===========================================================================================================================
+
+// Every server thread waits in select(), the memory of the requests served is released
+
+static bool config_bench_waiting( void )
+{
+    return( __atomic_load_n( &gConfig_BenchWaiting, __ATOMIC_SEQ_CST ) ==
+            __atomic_load_n( &gConfig_BenchRunning, __ATOMIC_SEQ_CST ) );
+}
+
+// The server has released every client
+
+static bool config_bench_idle( void )
+{
+#ifdef MICO_CONFIG_SERVER_MULTIPLEX
+    int     i;
+
+    for( i = 0; i < MICO_CONFIG_SERVER_MAX_CLIENTS; ++i )
+    {
+        if( config_clients[ i ].fd >= 0 ) return( false );
+    }
+    return( true );
+#else
+    return( __atomic_load_n( &gConfig_BenchRunning, __ATOMIC_RELAXED ) == 1 );
+#endif
+}
+
+//===========================================================================================================================
+//  config_bench_memory
+//===========================================================================================================================
+
+// Heap and stack held for inCount idle keep-alive clients, each after one /config-read. The heap must be back to where
+// it was once they have left, unless inWarmUp.
+
+static OSStatus config_bench_memory( int inCount, int inWarmUp, long *outHeap, long *outStack )
+{
+    OSStatus        err = kNoErr;
+    long            heap, stack;
+    int             i;
+
+    config_bench_wait( config_bench_idle() && config_bench_waiting(), kConfig_BenchTimeout );
+    require_action( config_bench_idle() && config_bench_waiting(), exit, err = kStateErr );
+    heap = __atomic_load_n( &gConfig_BenchHeap, __ATOMIC_RELAXED );
+    stack = __atomic_load_n( &gConfig_BenchStack, __ATOMIC_RELAXED );
+
+    for( i = 0; i < inCount; ++i )
+    {
+        err = config_bench_open( &gConfig_BenchClients[ i ] );
+        require_noerr( err, exit );
+    }
+    config_bench_wait( config_bench_waiting(), kConfig_BenchTimeout );
+    require_action( config_bench_waiting(), exit, err = kStateErr );
+    *outHeap = __atomic_load_n( &gConfig_BenchHeap, __ATOMIC_RELAXED ) - heap;
+    *outStack = __atomic_load_n( &gConfig_BenchStack, __ATOMIC_RELAXED ) - stack;
+
+    for( i = 0; i < inCount; ++i ) config_bench_disconnect( &gConfig_BenchClients[ i ] );
+    config_bench_wait( config_bench_idle() && config_bench_waiting(), kConfig_BenchTimeout );
+    require_action( config_bench_idle() && config_bench_waiting(), exit, err = kStateErr );
+    if( kConfig_BenchCounted && !inWarmUp ) require_action( __atomic_load_n( &gConfig_BenchHeap, __ATOMIC_RELAXED ) == heap,
+                                                         exit, err = kStateErr );
+
+exit:
+    for( i = 0; i < inCount; ++i ) config_bench_disconnect( &gConfig_BenchClients[ i ] );
+    return( err );
+}
+
+//===========================================================================================================================
+//  config_bench_rate
+//===========================================================================================================================
+
+// Keep-alive /config-read requests per second, inCount clients each with one request in flight
+
+static OSStatus config_bench_rate( int inCount, double *outRate )
+{
+    OSStatus            err = kNoErr;
+    struct timespec     t1, t2;
+    double              seconds;
+    long                requests = 0;
+    int                 i, status;
+
+    for( i = 0; i < inCount; ++i )
+    {
+        err = config_bench_open( &gConfig_BenchClients[ i ] );
+        require_noerr( err, exit );
+    }
+
+    clock_gettime( CLOCK_MONOTONIC, &t1 );
+    do
+    {
+        for( i = 0; i < inCount; ++i )
+        {
+            err = config_bench_get( &gConfig_BenchClients[ i ] );
+            require_noerr( err, exit );
+        }
+        for( i = 0; i < inCount; ++i )
+        {
+            err = config_bench_response( &gConfig_BenchClients[ i ], &status, NULL, 0 );
+            require_noerr( err, exit );
+            require_action( status == 200, exit, err = kResponseErr );
+        }
+        requests += inCount;
+        clock_gettime( CLOCK_MONOTONIC, &t2 );
+        seconds = ( t2.tv_sec - t1.tv_sec ) + ( t2.tv_nsec - t1.tv_nsec ) / 1e9;
+    } while( seconds < kConfig_BenchSeconds );
+    *outRate = requests / seconds;
+
+exit:
+    for( i = 0; i < inCount; ++i ) config_bench_disconnect( &gConfig_BenchClients[ i ] );
+    return( err );
+}
+
+//===========================================================================================================================
+//  config_bench
+//===========================================================================================================================
+
+OSStatus    config_bench( int print )
+{
+    OSStatus        err;
+    long            heap = 0, stack = 0, slot;
+    double          rate = 0;
+    int             i;
+
+    for( i = 0; i < (int)( sizeof( gConfig_BenchClients ) / sizeof( gConfig_BenchClients[ 0 ] ) ); ++i ) gConfig_BenchClients[ i ].fd = -1;
+    memset( &gConfig_BenchContext, 0, sizeof( gConfig_BenchContext ) );
+    mico_rtos_init_mutex( &gConfig_BenchContext.flashContentInRam_mutex );
+    strcpy( gConfig_BenchContext.flashContentInRam.micoSystemConfig.name, "Bench" );
+    gConfig_BenchContext.flashContentInRam.micoSystemConfig.dhcpEnable = true;
+    strcpy( gConfig_BenchContext.micoStatus.mac, "C8:93:46:00:00:01" );
+
+    err = config_server_start( &gConfig_BenchContext );
+    require_noerr( err, exit );
+    config_bench_wait( __atomic_load_n( &gConfig_BenchPort, __ATOMIC_ACQUIRE ) != 0, kConfig_BenchTimeout );
+    require_action( gConfig_BenchPort != 0, exit, err = kNotPreparedErr );
+
+    err = config_read_test();
+    require_noerr( err, exit );
+    err = config_write_test();
+    require_noerr( err, exit );
+    err = config_split_test();
+    require_noerr( err, exit );
+    err = config_stall_test();
+    require_noerr( err, exit );
+    err = config_limit_test();
+    require_noerr( err, exit );
+
+    // The first pass leaves the thread stacks in the cache of glibc, their TLS blocks are on the heap
+
+    err = config_bench_memory( MICO_CONFIG_SERVER_MAX_CLIENTS, 1, &heap, &stack );
+    require_noerr( err, exit );
+    err = config_bench_memory( MICO_CONFIG_SERVER_MAX_CLIENTS, 0, &heap, &stack );
+    require_noerr( err, exit );
+    if( !print ) goto exit;
+
+#ifdef MICO_CONFIG_SERVER_MULTIPLEX
+    slot = (long) sizeof( configClient_t );
+#else
+    slot = 0;
+#endif
+    printf( "%s, %d clients\n", kConfig_BenchMode, MICO_CONFIG_SERVER_MAX_CLIENTS );
+    if( kConfig_BenchCounted ) printf( "%-24s %6ld bytes heap + %5ld stack + %4ld slot = %6ld bytes\n", "memory per connection",
+                                       heap / MICO_CONFIG_SERVER_MAX_CLIENTS, stack / MICO_CONFIG_SERVER_MAX_CLIENTS, slot,
+                                       ( heap + stack ) / MICO_CONFIG_SERVER_MAX_CLIENTS + slot );
+    else                       printf( "%-24s %6s bytes heap + %5ld stack + %4ld slot\n", "memory per connection", "?",
+                                       stack / MICO_CONFIG_SERVER_MAX_CLIENTS, slot );
+    for( i = 1; i <= MICO_CONFIG_SERVER_MAX_CLIENTS; ++i )
+    {
+        err = config_bench_rate( i, &rate );
+        require_noerr( err, exit );
+        printf( "%-24s %6d clients: %10.0f requests/s\n", "/config-read keep-alive", i, rate );
+    }
+
+exit:
+    config_server_stop();
+    config_bench_wait( __atomic_load_n( &gConfig_BenchRunning, __ATOMIC_RELAXED ) == 0, kConfig_BenchTimeout );
+    if( !err && __atomic_load_n( &gConfig_BenchRunning, __ATOMIC_RELAXED ) != 0 ) err = kStateErr;
+    printf( "%s: %s\n", __FUNCTION__, !err ? "PASSED" : "FAILED" );
+    return( err );
+}
+
+int main( void )
+{
+    return( config_bench( 1 ) ? 1 : 0 );
+}
+
+#endif // CONFIG_BENCH_MAIN
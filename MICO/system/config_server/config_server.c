@@ -48,17 +48,57 @@
 
 #define kMIMEType_MXCHIP_OTA    "application/ota-stream"
 
+/* Define MICO_CONFIG_SERVER_MULTIPLEX to serve all clients from the listener thread with
+   select(), instead of creating a thread for every client. */
+#ifndef MICO_CONFIG_SERVER_MAX_CLIENTS
+#define MICO_CONFIG_SERVER_MAX_CLIENTS      MAX_TCP_CLIENT_PER_SERVER
+#endif
+
+/* The report is built and printed in one block of this size, it is built on the
+   heap if the application menu does not fit */
+#ifndef MICO_CONFIG_SERVER_REPORT_ARENA_SIZE
+#define MICO_CONFIG_SERVER_REPORT_ARENA_SIZE  6144
+#endif
+
+/* A scalar from /config-write is converted to json_object in a stack block of this
+   size for config_server_delegate_recv, or on the heap if it is longer */
+#ifndef MICO_CONFIG_SERVER_VALUE_ARENA_SIZE
+#define MICO_CONFIG_SERVER_VALUE_ARENA_SIZE   128
+#endif
+
+#define CONFIG_CLIENT_IDLE_TIMEOUT          (60*1000)
+#define CONFIG_CLIENT_HEADER_BUFFER_SIZE    HTTP_HEADER_BUFFER_SIZE
+
 typedef struct _configContext_t{
   uint32_t offset;
   bool     isFlashLocked;
   CRC16_Context crc16_contex;
 } configContext_t;
 
+typedef struct _configWrite_t{
+  mico_Context_t  *context;
+  bool            need_reboot;
+} configWrite_t;
+
+#ifdef MICO_CONFIG_SERVER_MULTIPLEX
+typedef struct _configClient_t{
+  int             fd;
+  HTTPHeader_t    *httpHeader;
+  bool            isReadingBody;
+  uint32_t        lastActiveTime;
+  configContext_t httpContext;
+} configClient_t;
+
+static configClient_t config_clients[ MICO_CONFIG_SERVER_MAX_CLIENTS ];
+#endif
+
 extern OSStatus     ConfigIncommingJsonMessage( const char *input, bool *need_reboot, mico_Context_t * const inContext );
 extern json_object* ConfigCreateReportJsonMessage( mico_Context_t * const inContext );
 
 static void localConfiglistener_thread(void *inContext);
+#ifndef MICO_CONFIG_SERVER_MULTIPLEX
 static void localConfig_thread(void *inFd);
+#endif
 static mico_Context_t *Context;
 static OSStatus _LocalConfigRespondInComingMessage(int fd, HTTPHeader_t* inHeader, mico_Context_t * const inContext);
 static OSStatus onReceivedData(struct _HTTPHeader_t * httpHeader, uint32_t pos, uint8_t * data, size_t len, void * userContext );
@@ -102,7 +142,12 @@ OSStatus config_server_start ( mico_Context_t *in_context )
   close_listener_sem = NULL;
   for (; i < MAX_TCP_CLIENT_PER_SERVER; i++)
     close_client_sem[ i ] = NULL;
+#ifdef MICO_CONFIG_SERVER_MULTIPLEX
+  /* Requests are handled on the listener thread */
+  err = mico_rtos_create_thread( NULL, MICO_APPLICATION_PRIORITY, "Config Server", localConfiglistener_thread, STACK_SIZE_LOCAL_CONFIG_CLIENT_THREAD, (void*)in_context );
+#else
   err = mico_rtos_create_thread( NULL, MICO_APPLICATION_PRIORITY, "Config Server", localConfiglistener_thread, STACK_SIZE_LOCAL_CONFIG_SERVER_THREAD, (void*)in_context );
+#endif
   require_noerr(err, exit);
   
   mico_thread_msleep(200);
@@ -134,6 +179,246 @@ OSStatus config_server_stop( void )
   return err;
 }
 
+#ifdef MICO_CONFIG_SERVER_MULTIPLEX
+
+static void localConfigClientClose( configClient_t *client )
+{
+  config_log("Config Client fd: %d closed", client->fd);
+  SocketClose( &client->fd );
+  client->fd = -1;
+  if( client->httpHeader ){
+    HTTPHeaderClear( client->httpHeader );
+    free( client->httpHeader );
+    client->httpHeader = NULL;
+  }
+}
+
+static OSStatus localConfigClientAccept( configClient_t *client, int fd )
+{
+  OSStatus err = kNoErr;
+
+  memset( client, 0x0, sizeof(configClient_t) );
+  client->fd = fd;
+  client->lastActiveTime = mico_get_time();
+  client->httpHeader = HTTPHeaderCreateWithBuffer( NULL, CONFIG_CLIENT_HEADER_BUFFER_SIZE, onReceivedData, onClearHTTPHeader, &client->httpContext );
+  require_action( client->httpHeader, exit, err = kNoMemoryErr );
+  HTTPHeaderClear( client->httpHeader );
+
+exit:
+  return err;
+}
+
+/* A request left in the buffer after the previous one, it can be processed without reading */
+static bool localConfigClientHasRequest( configClient_t *client )
+{
+  char *end;
+
+  if( client->fd < 0 || client->isReadingBody == true || client->httpHeader->len == 0 )
+    return false;
+  return findHeader( client->httpHeader, &end );
+}
+
+/* Advance the client's request by at most one read, return an error to close the connection */
+static OSStatus localConfigClientProcess( configClient_t *client )
+{
+  OSStatus err = kNoErr;
+  HTTPHeader_t *httpHeader = client->httpHeader;
+
+  client->lastActiveTime = mico_get_time();
+
+  if( client->isReadingBody == false ){
+    err = SocketReadHTTPHeaderOnce( client->fd, httpHeader );
+
+    switch ( err )
+    {
+      case kNoErr:
+        client->isReadingBody = true;
+        /* Wait until the socket is readable again for the rest of the body, chunked data 
+           received with the header is decoded by SocketReadHTTPBodyOnce without a read */
+        if( httpHeader->chunkedData == false && httpHeader->extraDataLen < httpHeader->contentLength )
+          return kNoErr;
+        if( httpHeader->chunkedData == true && httpHeader->extraDataLen == 0 )
+          return kNoErr;
+      break;
+
+      case EWOULDBLOCK:
+          // NO-OP, keep reading
+        return kNoErr;
+
+      case kNoSpaceErr:
+        config_log("ERROR: Cannot fit HTTPHeader.");
+        goto exit;
+
+      case kConnectionErr:
+        // NOTE: kConnectionErr from SocketReadHTTPHeader means it's closed
+        config_log("ERROR: Connection closed.");
+        goto exit;
+
+      default:
+        config_log("ERROR: HTTP Header parse internal error: %d", err);
+        goto exit;
+    }
+  }
+
+  err = SocketReadHTTPBodyOnce( client->fd, httpHeader );
+  if( err == EWOULDBLOCK )
+    return kNoErr;
+
+  if(httpHeader->dataEndedbyClose == true){
+    err = _LocalConfigRespondInComingMessage( client->fd, httpHeader, Context );
+    require_noerr(err, exit);
+    err = kConnectionErr;
+    goto exit;
+  }else{
+    require_noerr(err, exit);
+    err = _LocalConfigRespondInComingMessage( client->fd, httpHeader, Context );
+    require_noerr(err, exit);
+  }
+
+  HTTPHeaderClear( httpHeader );
+  client->isReadingBody = false;
+
+exit:
+  return err;
+}
+
+void localConfiglistener_thread(void *inContext)
+{
+  config_log_trace();
+  OSStatus err = kUnknownErr;
+  int i, j, max_fd;
+  Context = inContext;
+  struct sockaddr_t addr;
+  int sockaddr_t_size;
+  fd_set readfds;
+  struct timeval_t t, *timeout;
+  char ip_address[16];
+  configClient_t *busy_client;
+  uint32_t now, idle;
+
+  int localConfiglistener_fd = -1;
+  int close_listener_fd = -1;
+
+  for( i = 0; i < MICO_CONFIG_SERVER_MAX_CLIENTS; i++ ){
+    config_clients[i].fd = -1;
+    config_clients[i].httpHeader = NULL;
+  }
+
+  mico_rtos_init_semaphore( &close_listener_sem, 1);
+  close_listener_fd = mico_create_event_fd( close_listener_sem );
+
+  /*Establish a TCP server fd that accept the tcp clients connections*/ 
+  localConfiglistener_fd = socket( AF_INET, SOCK_STREAM, IPPROTO_TCP );
+  require_action(IsValidSocket( localConfiglistener_fd ), exit, err = kNoResourcesErr );
+  addr.s_ip = INADDR_ANY;
+  addr.s_port = MICO_CONFIG_SERVER_PORT;
+  err = bind(localConfiglistener_fd, &addr, sizeof(addr));
+  require_noerr( err, exit );
+
+  err = listen(localConfiglistener_fd, 0);
+  require_noerr( err, exit );
+
+  config_log("Config Server established at port: %d, fd: %d, max clients: %d", MICO_CONFIG_SERVER_PORT, localConfiglistener_fd, MICO_CONFIG_SERVER_MAX_CLIENTS);
+  
+  while(1){
+    FD_ZERO(&readfds);
+    FD_SET(localConfiglistener_fd, &readfds);
+    FD_SET(close_listener_fd, &readfds);
+    max_fd = Max( localConfiglistener_fd, close_listener_fd );
+    timeout = NULL;
+    now = mico_get_time();
+
+    /* An OTA upload holds the flash content mutex across reads, other requests wait for it */
+    busy_client = NULL;
+    for( i = 0; i < MICO_CONFIG_SERVER_MAX_CLIENTS; i++ ){
+      if( config_clients[i].fd >= 0 && config_clients[i].httpContext.isFlashLocked == true )
+        busy_client = &config_clients[i];
+    }
+
+    for( i = 0; i < MICO_CONFIG_SERVER_MAX_CLIENTS; i++ ){
+      if( config_clients[i].fd < 0 ) continue;
+      if( busy_client && busy_client != &config_clients[i] ) continue;
+      FD_SET( config_clients[i].fd, &readfds );
+      max_fd = Max( max_fd, config_clients[i].fd );
+
+      /* Wake up for the next request in buffer or the nearest idle timeout */
+      idle = now - config_clients[i].lastActiveTime;
+      idle = ( localConfigClientHasRequest( &config_clients[i] ) || idle >= CONFIG_CLIENT_IDLE_TIMEOUT )? 0 : CONFIG_CLIENT_IDLE_TIMEOUT - idle;
+      if( timeout == NULL || idle < t.tv_sec * 1000 + t.tv_usec / 1000 ){
+        t.tv_sec = idle / 1000;
+        t.tv_usec = ( idle % 1000 ) * 1000;
+        timeout = &t;
+      }
+    }
+
+    require( select(max_fd + 1, &readfds, NULL, NULL, timeout) >= 0, exit );
+
+    /* Check close requests */
+    if(FD_ISSET(close_listener_fd, &readfds)){
+      mico_rtos_get_semaphore( &close_listener_sem, 0 );
+      goto exit;
+    }
+
+    /* Check tcp connection requests */
+    if(FD_ISSET(localConfiglistener_fd, &readfds)){
+      sockaddr_t_size = sizeof(struct sockaddr_t);
+      j = accept(localConfiglistener_fd, &addr, &sockaddr_t_size);
+      if ( IsValidSocket( j ) ) {
+        inet_ntoa(ip_address, addr.s_ip );
+        for( i = 0; i < MICO_CONFIG_SERVER_MAX_CLIENTS; i++ ){
+          if( config_clients[i].fd < 0 ) break;
+        }
+        if( i == MICO_CONFIG_SERVER_MAX_CLIENTS ){
+          config_log("Config Client %s:%d rejected, too many clients", ip_address, addr.s_port);
+          SocketClose(&j);
+        }
+        else if( localConfigClientAccept( &config_clients[i], j ) != kNoErr ){
+          localConfigClientClose( &config_clients[i] );
+        }
+        else{
+          config_log("Config Client %s:%d connected, fd: %d, free memory %d bytes", ip_address, addr.s_port, j, MicoGetMemoryInfo()->free_memory);
+        }
+      }
+    }
+
+    now = mico_get_time();
+    for( i = 0; i < MICO_CONFIG_SERVER_MAX_CLIENTS; i++ ){
+      if( config_clients[i].fd < 0 ) continue;
+      if( busy_client && busy_client != &config_clients[i] ) continue;
+
+      if( FD_ISSET( config_clients[i].fd, &readfds ) || localConfigClientHasRequest( &config_clients[i] ) ){
+        err = localConfigClientProcess( &config_clients[i] );
+        if( err != kNoErr ){
+          config_log("Exit: Client exit with err = %d", err);
+          localConfigClientClose( &config_clients[i] );
+        }
+      }
+      else if( now - config_clients[i].lastActiveTime >= CONFIG_CLIENT_IDLE_TIMEOUT ){
+        config_log("Config Client fd: %d idle timeout", config_clients[i].fd);
+        localConfigClientClose( &config_clients[i] );
+      }
+    }
+  }
+
+exit:
+    for( i = 0; i < MICO_CONFIG_SERVER_MAX_CLIENTS; i++ ){
+      if( config_clients[i].fd >= 0 )
+        localConfigClientClose( &config_clients[i] );
+    }
+    if( close_listener_sem != NULL ){
+      mico_delete_event_fd( close_listener_fd );
+      mico_rtos_deinit_semaphore( &close_listener_sem );
+      close_listener_sem = NULL;
+    };
+    config_log("Exit: Config listener exit with err = %d", err);
+    SocketClose( &localConfiglistener_fd );
+    is_config_server_established = false;
+    mico_rtos_delete_thread(NULL);
+    return;
+}
+
+#else /* MICO_CONFIG_SERVER_MULTIPLEX */
+
 void localConfiglistener_thread(void *inContext)
 {
   config_log_trace();
@@ -242,17 +527,18 @@ void localConfig_thread(void *inFd)
     FD_SET(close_client_fd, &readfds);
     clientFdIsSet = 0;
 
+    /* A request left in the buffer is handled without select(), readfds is only valid after it */
     if(httpHeader->len == 0){
       require(select(1, &readfds, NULL, NULL, &t) >= 0, exit);
       clientFdIsSet = FD_ISSET(clientFd, &readfds);
-    }
 
-    /* Check close requests */
-    if(FD_ISSET(close_client_fd, &readfds)){
-      mico_rtos_get_semaphore( &close_client_sem[close_sem_index], 0 );
-      err = kConnectionErr;
-      goto exit;
-    }    
+      /* Check close requests */
+      if(FD_ISSET(close_client_fd, &readfds)){
+        mico_rtos_get_semaphore( &close_client_sem[close_sem_index], 0 );
+        err = kConnectionErr;
+        goto exit;
+      }
+    }
   
     if(clientFdIsSet||httpHeader->len){
       err = SocketReadHTTPHeader( clientFd, httpHeader );
@@ -317,6 +603,8 @@ exit:
   return;
 }
 
+#endif /* MICO_CONFIG_SERVER_MULTIPLEX */
+
 static OSStatus onReceivedData(struct _HTTPHeader_t * inHeader, uint32_t inPos, uint8_t * inData, size_t inLen, void * inUserContext )
 {
   OSStatus err = kUnknownErr;
@@ -325,7 +613,7 @@ static OSStatus onReceivedData(struct _HTTPHeader_t * inHeader, uint32_t inPos,
   configContext_t *context = (configContext_t *)inUserContext;
   mico_logic_partition_t* ota_partition = MicoFlashGetInfo( MICO_PARTITION_OTA_TEMP );
 
-  err = HTTPGetHeaderField( inHeader->buf, inHeader->len, "Content-Type", NULL, NULL, &value, &valueSize, NULL );
+  err = HTTPHeaderGetField( inHeader, "Content-Type", &value, &valueSize );
   if(err == kNoErr && strnicmpx( value, valueSize, kMIMEType_MXCHIP_OTA ) == 0){
     printf("%d/", inPos);
 
@@ -373,105 +661,273 @@ static void onClearHTTPHeader(struct _HTTPHeader_t * inHeader, void * inUserCont
   }
  }
 
+/* Build the current configuration report in arena, or on the heap if arena is NULL */
+static OSStatus _LocalConfigCreateReport( struct json_arena *arena, json_object **outReport, mico_Context_t * const inContext )
+{
+  OSStatus err = kNoErr;
+  char name[50];
+  json_object *sectors, *sector = NULL;
+
+  mico_rtos_lock_mutex(&inContext->flashContentInRam_mutex);
+  snprintf(name, 50, "%s(%c%c%c%c%c%c)",MODEL, 
+                                        inContext->micoStatus.mac[9],  inContext->micoStatus.mac[10], 
+                                        inContext->micoStatus.mac[12], inContext->micoStatus.mac[13],
+                                        inContext->micoStatus.mac[15], inContext->micoStatus.mac[16]);
+  *outReport = json_object_new_object_in(arena);
+  require_action(*outReport, exit, err = kNoMemoryErr);
+
+  sectors = json_object_new_array_in(arena);
+  require_action( sectors, exit, err = kNoMemoryErr );
+
+  json_object_object_add(*outReport, "T", json_object_new_string_in(arena, "Current Configuration"));
+  json_object_object_add(*outReport, "N", json_object_new_string_in(arena, name));
+  json_object_object_add(*outReport, "C", sectors);
+
+  json_object_object_add(*outReport, "PO", json_object_new_string_in(arena, PROTOCOL));
+  json_object_object_add(*outReport, "HD", json_object_new_string_in(arena, HARDWARE_REVISION));
+  json_object_object_add(*outReport, "FW", json_object_new_string_in(arena, FIRMWARE_REVISION));
+  json_object_object_add(*outReport, "RF", json_object_new_string_in(arena, inContext->micoStatus.rf_version));
+
+  /*Sector 1*/
+  sector = json_object_new_array_in(arena);
+  require_action( sector, exit, err = kNoMemoryErr );
+  err = config_server_create_sector(sectors, "MICO SYSTEM",    sector);
+  require_noerr(err, exit);
+
+    /*name cell*/
+    err = config_server_create_string_cell(sector, "Device Name",    inContext->flashContentInRam.micoSystemConfig.name,               "RW", NULL);
+    require_noerr(err, exit);
+
+    //RF power save switcher cell
+    err = config_server_create_bool_cell(sector, "RF power save",  inContext->flashContentInRam.micoSystemConfig.rfPowerSaveEnable,  "RW");
+    require_noerr(err, exit);
+
+    //MCU power save switcher cell
+    err = config_server_create_bool_cell(sector, "MCU power save", inContext->flashContentInRam.micoSystemConfig.mcuPowerSaveEnable, "RW");
+    require_noerr(err, exit);
+
+    /*SSID cell*/
+    err = config_server_create_string_cell(sector, "Wi-Fi",        inContext->flashContentInRam.micoSystemConfig.ssid,     "RW", NULL);
+    require_noerr(err, exit);
+    /*PASSWORD cell*/
+    err = config_server_create_string_cell(sector, "Password",     inContext->flashContentInRam.micoSystemConfig.user_key, "RW", NULL);
+    require_noerr(err, exit);
+    /*DHCP cell*/
+    err = config_server_create_bool_cell(sector, "DHCP",        inContext->flashContentInRam.micoSystemConfig.dhcpEnable,   "RW");
+    require_noerr(err, exit);
+    /*Local cell*/
+    err = config_server_create_string_cell(sector, "IP address",  inContext->micoStatus.localIp,   "RW", NULL);
+    require_noerr(err, exit);
+    /*Netmask cell*/
+    err = config_server_create_string_cell(sector, "Net Mask",    inContext->micoStatus.netMask,   "RW", NULL);
+    require_noerr(err, exit);
+    /*Gateway cell*/
+    err = config_server_create_string_cell(sector, "Gateway",     inContext->micoStatus.gateWay,   "RW", NULL);
+    require_noerr(err, exit);
+    /*DNS server cell*/
+    err = config_server_create_string_cell(sector, "DNS Server",  inContext->micoStatus.dnsServer, "RW", NULL);
+    require_noerr(err, exit);
+
+  /*Sector 2*/
+  sector = json_object_new_array_in(arena);
+  require_action( sector, exit, err = kNoMemoryErr );
+  err = config_server_create_sector(sectors, "APPLICATION",    sector);
+  require_noerr(err, exit);
+
+  config_server_delegate_report( sector, inContext );
+
+exit:
+  mico_rtos_unlock_mutex(&inContext->flashContentInRam_mutex);
+  return err;
+}
+
+/* /config-write is parsed by json_sax: the keys of sector "MICO SYSTEM" are copied
+   straight to flashContentInRam, other keys go to config_server_delegate_recv */
+#define configWriteContext(sax)   (((configWrite_t *)(sax)->ctx)->context->flashContentInRam.micoSystemConfig)
+
+static int _ConfigWriteName( struct json_sax *sax, const char *key, int key_len, const struct json_sax_value *val )
+{
+  json_sax_copy_string( val, configWriteContext(sax).name, maxNameLen );
+  ((configWrite_t *)sax->ctx)->need_reboot = true;
+  return JSON_SAX_CONTINUE;
+}
+
+static int _ConfigWriteRFPowerSave( struct json_sax *sax, const char *key, int key_len, const struct json_sax_value *val )
+{
+  configWriteContext(sax).rfPowerSaveEnable = json_sax_get_boolean( val );
+  ((configWrite_t *)sax->ctx)->need_reboot = true;
+  return JSON_SAX_CONTINUE;
+}
+
+static int _ConfigWriteMCUPowerSave( struct json_sax *sax, const char *key, int key_len, const struct json_sax_value *val )
+{
+  configWriteContext(sax).mcuPowerSaveEnable = json_sax_get_boolean( val );
+  ((configWrite_t *)sax->ctx)->need_reboot = true;
+  return JSON_SAX_CONTINUE;
+}
+
+static int _ConfigWriteSSID( struct json_sax *sax, const char *key, int key_len, const struct json_sax_value *val )
+{
+  json_sax_copy_string( val, configWriteContext(sax).ssid, maxSsidLen );
+  configWriteContext(sax).channel = 0;
+  memset( configWriteContext(sax).bssid, 0x0, 6 );
+  configWriteContext(sax).security = SECURITY_TYPE_AUTO;
+  memcpy( configWriteContext(sax).key, configWriteContext(sax).user_key, maxKeyLen );
+  configWriteContext(sax).keyLength = configWriteContext(sax).user_keyLength;
+  ((configWrite_t *)sax->ctx)->need_reboot = true;
+  return JSON_SAX_CONTINUE;
+}
+
+static int _ConfigWritePassword( struct json_sax *sax, const char *key, int key_len, const struct json_sax_value *val )
+{
+  configWriteContext(sax).security = SECURITY_TYPE_AUTO;
+  json_sax_copy_string( val, configWriteContext(sax).key, maxKeyLen );
+  json_sax_copy_string( val, configWriteContext(sax).user_key, maxKeyLen );
+  configWriteContext(sax).keyLength = strlen( configWriteContext(sax).key );
+  configWriteContext(sax).user_keyLength = strlen( configWriteContext(sax).key );
+  ((configWrite_t *)sax->ctx)->need_reboot = true;
+  return JSON_SAX_CONTINUE;
+}
+
+static int _ConfigWriteDHCP( struct json_sax *sax, const char *key, int key_len, const struct json_sax_value *val )
+{
+  configWriteContext(sax).dhcpEnable = json_sax_get_boolean( val );
+  ((configWrite_t *)sax->ctx)->need_reboot = true;
+  return JSON_SAX_CONTINUE;
+}
+
+static int _ConfigWriteLocalIp( struct json_sax *sax, const char *key, int key_len, const struct json_sax_value *val )
+{
+  json_sax_copy_string( val, configWriteContext(sax).localIp, maxIpLen );
+  ((configWrite_t *)sax->ctx)->need_reboot = true;
+  return JSON_SAX_CONTINUE;
+}
+
+static int _ConfigWriteNetMask( struct json_sax *sax, const char *key, int key_len, const struct json_sax_value *val )
+{
+  json_sax_copy_string( val, configWriteContext(sax).netMask, maxIpLen );
+  ((configWrite_t *)sax->ctx)->need_reboot = true;
+  return JSON_SAX_CONTINUE;
+}
+
+static int _ConfigWriteGateway( struct json_sax *sax, const char *key, int key_len, const struct json_sax_value *val )
+{
+  json_sax_copy_string( val, configWriteContext(sax).gateWay, maxIpLen );
+  ((configWrite_t *)sax->ctx)->need_reboot = true;
+  return JSON_SAX_CONTINUE;
+}
+
+static int _ConfigWriteDnsServer( struct json_sax *sax, const char *key, int key_len, const struct json_sax_value *val )
+{
+  json_sax_copy_string( val, configWriteContext(sax).dnsServer, maxIpLen );
+  ((configWrite_t *)sax->ctx)->need_reboot = true;
+  return JSON_SAX_CONTINUE;
+}
+
+/* Other keys: the value is converted to json_object for the application, a scalar
+   is built on the stack */
+static int _ConfigWriteDelegate( struct json_sax *sax, const char *key, int key_len, const struct json_sax_value *val )
+{
+  configWrite_t *write = (configWrite_t *)sax->ctx;
+  uint8_t value_arena_buf[ MICO_CONFIG_SERVER_VALUE_ARENA_SIZE ];
+  struct json_arena value_arena;
+  json_object *value = NULL;
+  char name[ 64 ];
+  int ret = JSON_SAX_CONTINUE;
+
+  /* The body must be an object, only its members are sent */
+  if( sax->depth == 0 )
+    return ( val->type == json_type_object )? JSON_SAX_CONTINUE : JSON_SAX_STOP;
+  if( sax->depth > 1 || val->end )
+    return JSON_SAX_CONTINUE;
+
+  if( json_sax_copy_key( key, key_len, name, sizeof(name) ) >= (int)sizeof(name) ){
+    config_log("Key %.*s is too long", key_len, key);
+    return JSON_SAX_SKIP;
+  }
+
+  json_arena_init( &value_arena, value_arena_buf, sizeof(value_arena_buf) );
+  value = json_sax_value_to_object( sax, &value_arena, val );
+  if( value == NULL && val->type != json_type_null )
+    value = json_sax_value_to_object( sax, NULL, val );
+  if( val->type == json_type_object || val->type == json_type_array )
+    ret = JSON_SAX_SKIP;
+
+  config_server_delegate_recv( name, value, &write->need_reboot, write->context );
+  if( value ) json_object_put( value );
+  return ret;
+}
+
+static const struct json_sax_handler config_write_handlers[] = {
+  { "Device Name",    _ConfigWriteName },
+  { "RF power save",  _ConfigWriteRFPowerSave },
+  { "MCU power save", _ConfigWriteMCUPowerSave },
+  { "Wi-Fi",          _ConfigWriteSSID },
+  { "Password",       _ConfigWritePassword },
+  { "DHCP",           _ConfigWriteDHCP },
+  { "IP address",     _ConfigWriteLocalIp },
+  { "Net Mask",       _ConfigWriteNetMask },
+  { "Gateway",        _ConfigWriteGateway },
+  { "DNS Server",     _ConfigWriteDnsServer },
+  { NULL,             NULL }
+};
+
 OSStatus _LocalConfigRespondInComingMessage(int fd, HTTPHeader_t* inHeader, mico_Context_t * const inContext)
 {
   OSStatus err = kUnknownErr;
-  const char *  json_str;
+  const char *  json_str = NULL;
   uint8_t *httpResponse = NULL;
   size_t httpResponseLen = 0;
-  json_object* report = NULL, *config = NULL;
+  SocketIOVec_t httpVec[2];
+  json_object* report = NULL;
+  struct json_arena report_arena;
+  struct json_sax config_sax;
+  configWrite_t config_write;
+  enum json_tokener_error json_err;
+  void *report_arena_buf = NULL;
   bool need_reboot = false;
   uint16_t crc;
   configContext_t *http_context = (configContext_t *)inHeader->userContext;
   mico_logic_partition_t* ota_partition = MicoFlashGetInfo( MICO_PARTITION_OTA_TEMP );
-  char name[50];
-
-  json_object *sectors, *sector = NULL;
 
   config_log_trace();
 
   if(HTTPHeaderMatchURL( inHeader, kCONFIGURLRead ) == kNoErr){    
     //report = ConfigCreateReportJsonMessage( inContext );
 
-    mico_rtos_lock_mutex(&inContext->flashContentInRam_mutex);
-    snprintf(name, 50, "%s(%c%c%c%c%c%c)",MODEL, 
-                                          inContext->micoStatus.mac[9],  inContext->micoStatus.mac[10], 
-                                          inContext->micoStatus.mac[12], inContext->micoStatus.mac[13],
-                                          inContext->micoStatus.mac[15], inContext->micoStatus.mac[16]);
-    report = json_object_new_object();
-    require_action(report, exit, err = kNoMemoryErr);
-
-    sectors = json_object_new_array();
-    require( sectors, exit );
-
-    json_object_object_add(report, "T", json_object_new_string("Current Configuration"));
-    json_object_object_add(report, "N", json_object_new_string(name));
-    json_object_object_add(report, "C", sectors);
-
-    json_object_object_add(report, "PO", json_object_new_string(PROTOCOL));
-    json_object_object_add(report, "HD", json_object_new_string(HARDWARE_REVISION));
-    json_object_object_add(report, "FW", json_object_new_string(FIRMWARE_REVISION));
-    json_object_object_add(report, "RF", json_object_new_string(inContext->micoStatus.rf_version));
-
-    /*Sector 1*/
-    sector = json_object_new_array();
-    require( sector, exit );
-    err = config_server_create_sector(sectors, "MICO SYSTEM",    sector);
-    require_noerr(err, exit);
-
-      /*name cell*/
-      err = config_server_create_string_cell(sector, "Device Name",    inContext->flashContentInRam.micoSystemConfig.name,               "RW", NULL);
-      require_noerr(err, exit);
-
-      //RF power save switcher cell
-      err = config_server_create_bool_cell(sector, "RF power save",  inContext->flashContentInRam.micoSystemConfig.rfPowerSaveEnable,  "RW");
-      require_noerr(err, exit);
-
-      //MCU power save switcher cell
-      err = config_server_create_bool_cell(sector, "MCU power save", inContext->flashContentInRam.micoSystemConfig.mcuPowerSaveEnable, "RW");
-      require_noerr(err, exit);
-
-      /*SSID cell*/
-      err = config_server_create_string_cell(sector, "Wi-Fi",        inContext->flashContentInRam.micoSystemConfig.ssid,     "RW", NULL);
-      require_noerr(err, exit);
-      /*PASSWORD cell*/
-      err = config_server_create_string_cell(sector, "Password",     inContext->flashContentInRam.micoSystemConfig.user_key, "RW", NULL);
-      require_noerr(err, exit);
-      /*DHCP cell*/
-      err = config_server_create_bool_cell(sector, "DHCP",        inContext->flashContentInRam.micoSystemConfig.dhcpEnable,   "RW");
-      require_noerr(err, exit);
-      /*Local cell*/
-      err = config_server_create_string_cell(sector, "IP address",  inContext->micoStatus.localIp,   "RW", NULL);
-      require_noerr(err, exit);
-      /*Netmask cell*/
-      err = config_server_create_string_cell(sector, "Net Mask",    inContext->micoStatus.netMask,   "RW", NULL);
-      require_noerr(err, exit);
-      /*Gateway cell*/
-      err = config_server_create_string_cell(sector, "Gateway",     inContext->micoStatus.gateWay,   "RW", NULL);
-      require_noerr(err, exit);
-      /*DNS server cell*/
-      err = config_server_create_string_cell(sector, "DNS Server",  inContext->micoStatus.dnsServer, "RW", NULL);
-      require_noerr(err, exit);
-
-    /*Sector 2*/
-    sector = json_object_new_array();
-    require( sector, exit );
-    err = config_server_create_sector(sectors, "APPLICATION",    sector);
-    require_noerr(err, exit);
-
-    config_server_delegate_report( sector, inContext );
-
-    mico_rtos_unlock_mutex(&inContext->flashContentInRam_mutex);
-
-    json_str = json_object_to_json_string(report);
+    report_arena_buf = malloc( MICO_CONFIG_SERVER_REPORT_ARENA_SIZE );
+    if( report_arena_buf ){
+      json_arena_init( &report_arena, report_arena_buf, MICO_CONFIG_SERVER_REPORT_ARENA_SIZE );
+      err = _LocalConfigCreateReport( &report_arena, &report, inContext );
+      if( err == kNoErr )
+        json_str = json_object_to_json_string(report);
+      if( err == kNoErr && report_arena.failed ){
+        config_log("Report exceeds %d bytes, build on heap", MICO_CONFIG_SERVER_REPORT_ARENA_SIZE);
+        err = kNoMemoryErr;
+      }
+    }
+    if( !report_arena_buf || err != kNoErr ){
+      if( report ) json_object_put( report );
+      report = NULL;
+      if( report_arena_buf ) free( report_arena_buf );
+      report_arena_buf = NULL;
+      err = _LocalConfigCreateReport( NULL, &report, inContext );
+      require_noerr( err, exit );
+      json_str = json_object_to_json_string(report);
+    }
     require_action( json_str, exit, err = kNoMemoryErr );
     config_log("Send config object=%s", json_str);
     err =  CreateSimpleHTTPMessageNoCopy( kMIMEType_JSON, strlen(json_str), &httpResponse, &httpResponseLen );
     require_noerr( err, exit );
     require( httpResponse, exit );
-    err = SocketSend( fd, httpResponse, httpResponseLen );
-    require_noerr( err, exit );
-    err = SocketSend( fd, (uint8_t *)json_str, strlen(json_str) );
+    httpVec[0].buf = httpResponse;
+    httpVec[0].len = httpResponseLen;
+    httpVec[1].buf = (const uint8_t *)json_str;
+    httpVec[1].len = strlen(json_str);
+    /* Blocking even when one thread serves every client: with SocketSendvOnce, the header,
+       the report and its arena would have to be kept per client until they are sent. A
+       client that stops reading holds the other ones for SOCKET_SEND_TIMEOUT at most. */
+    err = SocketSendv( fd, httpVec, 2 );
     require_noerr( err, exit );
     config_log("Current configuration sent");
     goto exit;
@@ -486,57 +942,23 @@ OSStatus _LocalConfigRespondInComingMessage(int fd, HTTPHeader_t* inHeader, mico
       err = SocketSend( fd, httpResponse, httpResponseLen );
       require_noerr( err, exit );
 
-      config = json_tokener_parse(inHeader->extraDataPtr);
-      require_action(config, exit, err = kUnknownErr);
-      config_log("Recv config object=%s", json_object_to_json_string(config));
+      /* The body is not terminated when the next request came with it */
+      config_log("Recv config object=%.*s", (int)inHeader->contentLength, inHeader->extraDataPtr);
+      memset( &config_write, 0, sizeof(config_write) );
+      config_write.context = inContext;
+
+      /* Nothing is applied from a broken object: check it first, no handler is called */
+      memset( &config_sax, 0, sizeof(config_sax) );
+      json_err = json_sax_parse( &config_sax, inHeader->extraDataPtr, (int)inHeader->contentLength );
+      require_action_string( json_err == json_tokener_success, exit, err = kUnknownErr, json_tokener_errors[json_err] );
+
+      config_sax.handlers = config_write_handlers;
+      config_sax.default_cb = _ConfigWriteDelegate;
+      config_sax.ctx = &config_write;
       mico_rtos_lock_mutex(&inContext->flashContentInRam_mutex);
-      json_object_object_foreach(config, key, val) {
-        if(!strcmp(key, "Device Name")){
-          strncpy(inContext->flashContentInRam.micoSystemConfig.name, json_object_get_string(val), maxNameLen);
-          need_reboot = true;
-        }else if(!strcmp(key, "RF power save")){
-          inContext->flashContentInRam.micoSystemConfig.rfPowerSaveEnable = json_object_get_boolean(val);
-          need_reboot = true;
-        }else if(!strcmp(key, "MCU power save")){
-          inContext->flashContentInRam.micoSystemConfig.mcuPowerSaveEnable = json_object_get_boolean(val);
-          need_reboot = true;
-        }else if(!strcmp(key, "Wi-Fi")){
-          strncpy(inContext->flashContentInRam.micoSystemConfig.ssid, json_object_get_string(val), maxSsidLen);
-          inContext->flashContentInRam.micoSystemConfig.channel = 0;
-          memset(inContext->flashContentInRam.micoSystemConfig.bssid, 0x0, 6);
-          inContext->flashContentInRam.micoSystemConfig.security = SECURITY_TYPE_AUTO;
-          memcpy(inContext->flashContentInRam.micoSystemConfig.key, inContext->flashContentInRam.micoSystemConfig.user_key, maxKeyLen);
-          inContext->flashContentInRam.micoSystemConfig.keyLength = inContext->flashContentInRam.micoSystemConfig.user_keyLength;
-          need_reboot = true;
-        }else if(!strcmp(key, "Password")){
-          inContext->flashContentInRam.micoSystemConfig.security = SECURITY_TYPE_AUTO;
-          strncpy(inContext->flashContentInRam.micoSystemConfig.key, json_object_get_string(val), maxKeyLen);
-          strncpy(inContext->flashContentInRam.micoSystemConfig.user_key, json_object_get_string(val), maxKeyLen);
-          inContext->flashContentInRam.micoSystemConfig.keyLength = strlen(inContext->flashContentInRam.micoSystemConfig.key);
-          inContext->flashContentInRam.micoSystemConfig.user_keyLength = strlen(inContext->flashContentInRam.micoSystemConfig.key);
-          need_reboot = true;
-        }else if(!strcmp(key, "DHCP")){
-          inContext->flashContentInRam.micoSystemConfig.dhcpEnable   = json_object_get_boolean(val);
-          need_reboot = true;
-        }else if(!strcmp(key, "IP address")){
-          strncpy(inContext->flashContentInRam.micoSystemConfig.localIp, json_object_get_string(val), maxIpLen);
-          need_reboot = true;
-        }else if(!strcmp(key, "Net Mask")){
-          strncpy(inContext->flashContentInRam.micoSystemConfig.netMask, json_object_get_string(val), maxIpLen);
-          need_reboot = true;
-        }else if(!strcmp(key, "Gateway")){
-          strncpy(inContext->flashContentInRam.micoSystemConfig.gateWay, json_object_get_string(val), maxIpLen);
-          need_reboot = true;
-        }else if(!strcmp(key, "DNS Server")){
-          strncpy(inContext->flashContentInRam.micoSystemConfig.dnsServer, json_object_get_string(val), maxIpLen);
-          need_reboot = true;
-        }else{
-          config_server_delegate_recv( key, val, &need_reboot, inContext );
-        }
-      }
+      json_sax_parse( &config_sax, inHeader->extraDataPtr, (int)inHeader->contentLength );
       mico_rtos_unlock_mutex(&inContext->flashContentInRam_mutex);
-
-      json_object_put(config);
+      need_reboot = config_write.need_reboot;
 
       inContext->flashContentInRam.micoSystemConfig.configured = allConfigured;
       mico_system_context_update( inContext );
@@ -597,7 +1019,7 @@ OSStatus _LocalConfigRespondInComingMessage(int fd, HTTPHeader_t* inHeader, mico
     err = kConnectionErr;
   if(httpResponse)  free(httpResponse);
   if(report)        json_object_put(report);
-  if(config)        json_object_put(config);
+  if(report_arena_buf) free(report_arena_buf);
 
   return err;
 
@@ -38,15 +38,18 @@
 
 #include "json_c/json.h"
 
+/* Cells are created in the arena of the menu they are added to, see json_arena.h */
+
 OSStatus config_server_create_sector(json_object* sectors, char* const name,  json_object *menus)
 {
   OSStatus err;
   json_object *object;
+  struct json_arena *arena = json_object_get_arena(sectors);
   err = kNoErr;
 
-  object = json_object_new_object();
+  object = json_object_new_object_in(arena);
   require_action(object, exit, err = kNoMemoryErr);
-  json_object_object_add(object, "N", json_object_new_string(name));      
+  json_object_object_add(object, "N", json_object_new_string_in(arena, name));      
   json_object_object_add(object, "C", menus);
   json_object_array_add(sectors, object);
 
@@ -58,13 +61,14 @@ OSStatus config_server_create_string_cell(json_object* menus, char* const name,
 {
   OSStatus err;
   json_object *object;
+  struct json_arena *arena = json_object_get_arena(menus);
   err = kNoErr;
 
-  object = json_object_new_object();
+  object = json_object_new_object_in(arena);
   require_action(object, exit, err = kNoMemoryErr);
-  json_object_object_add(object, "N", json_object_new_string(name));      
-  json_object_object_add(object, "C", json_object_new_string(content));
-  json_object_object_add(object, "P", json_object_new_string(privilege)); 
+  json_object_object_add(object, "N", json_object_new_string_in(arena, name));      
+  json_object_object_add(object, "C", json_object_new_string_in(arena, content));
+  json_object_object_add(object, "P", json_object_new_string_in(arena, privilege)); 
 
   if(secectionArray)
     json_object_object_add(object, "S", secectionArray); 
@@ -80,14 +84,15 @@ OSStatus config_server_create_number_cell(json_object* menus, char* const name,
 {
   OSStatus err;
   json_object *object;
+  struct json_arena *arena = json_object_get_arena(menus);
   err = kNoErr;
 
-  object = json_object_new_object();
+  object = json_object_new_object_in(arena);
   require_action(object, exit, err = kNoMemoryErr);
-  json_object_object_add(object, "N", json_object_new_string(name));      
+  json_object_object_add(object, "N", json_object_new_string_in(arena, name));      
 
-  json_object_object_add(object, "C", json_object_new_int(content));
-  json_object_object_add(object, "P", json_object_new_string(privilege)); 
+  json_object_object_add(object, "C", json_object_new_int_in(arena, content));
+  json_object_object_add(object, "P", json_object_new_string_in(arena, privilege)); 
 
   if(secectionArray)
     json_object_object_add(object, "S", secectionArray); 
@@ -102,14 +107,15 @@ OSStatus config_server_create_float_cell(json_object* menus, char* const name,
 {
   OSStatus err;
   json_object *object;
+  struct json_arena *arena = json_object_get_arena(menus);
   err = kNoErr;
 
-  object = json_object_new_object();
+  object = json_object_new_object_in(arena);
   require_action(object, exit, err = kNoMemoryErr);
-  json_object_object_add(object, "N", json_object_new_string(name));      
+  json_object_object_add(object, "N", json_object_new_string_in(arena, name));      
 
-  json_object_object_add(object, "C", json_object_new_double(content));
-  json_object_object_add(object, "P", json_object_new_string(privilege)); 
+  json_object_object_add(object, "C", json_object_new_double_in(arena, content));
+  json_object_object_add(object, "P", json_object_new_string_in(arena, privilege)); 
 
   if(secectionArray)
     json_object_object_add(object, "S", secectionArray); 
@@ -125,13 +131,14 @@ OSStatus config_server_create_bool_cell(json_object* menus, char* const name,  b
 {
   OSStatus err;
   json_object *object;
+  struct json_arena *arena = json_object_get_arena(menus);
   err = kNoErr;
 
-  object = json_object_new_object();
+  object = json_object_new_object_in(arena);
   require_action(object, exit, err = kNoMemoryErr);
-  json_object_object_add(object, "N", json_object_new_string(name));      
-  json_object_object_add(object, "C", json_object_new_boolean(switcher));
-  json_object_object_add(object, "P", json_object_new_string(privilege)); 
+  json_object_object_add(object, "N", json_object_new_string_in(arena, name));      
+  json_object_object_add(object, "C", json_object_new_boolean_in(arena, switcher));
+  json_object_object_add(object, "P", json_object_new_string_in(arena, privilege)); 
   json_object_array_add(menus, object);
 
 exit:
@@ -142,11 +149,12 @@ OSStatus config_server_create_sub_menu_cell(json_object* menus, char* const name
 {
   OSStatus err;
   json_object *object;
+  struct json_arena *arena = json_object_get_arena(menus);
   err = kNoErr;
 
-  object = json_object_new_object();
+  object = json_object_new_object_in(arena);
   require_action(object, exit, err = kNoMemoryErr);
-  json_object_object_add(object, "N", json_object_new_string(name));
+  json_object_object_add(object, "N", json_object_new_string_in(arena, name));
   json_object_object_add(object, "C", lowerSectors);
   json_object_array_add(menus, object);
 
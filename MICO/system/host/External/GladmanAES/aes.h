@@ -0,0 +1,2 @@
+/* Host builds: AESUtils.h includes the Gladman AES from its place in the WICED tree */
+#include "../../../../security/GladmanAES/aes.h"
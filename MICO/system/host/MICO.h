@@ -0,0 +1,85 @@
+/**
+******************************************************************************
+* @file    MICO.h
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   MICO.h for the host builds of the library benches, e.g.
+*          libraries/protocols/mqtt/mqtt-bench.c: the socket calls are the
+*          ones of the host, struct timeval_t is its struct timeval.
+*          MICO/system/config-bench.c adds the MICO socket address, it and
+*          the properties-bench.c of the MiCOKit demo the system context,
+*          Bootloader/update-bench.c the boot table.
+******************************************************************************
+*/
+
+#ifndef __MICO_H_
+#define __MICO_H_
+
+#include "Common.h"
+#include "Debug.h"
+#include "mico_rtos.h"
+
+#include <errno.h>
+#include <stddef.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+
+#define timeval_t           timeval
+
+/* Not <unistd.h>, its sleep() is not the one of mico_rtos.h */
+ssize_t read( int fd, void *buf, size_t count );
+ssize_t write( int fd, const void *buf, size_t count );
+int close( int fd );
+
+/* The boot table of Bootloader/Update_for_OTA.c */
+#if defined( UPDATE_BENCH_MAIN )
+#include "system.h"
+#endif
+
+/* The system context of the config server and of the MiCOKit app context */
+#if defined( CONFIG_BENCH_MAIN ) || defined( PROPERTIES_BENCH_MAIN )
+#include "mico_system.h"
+#endif
+
+/* config-bench.c runs config_server.c on the host loopback: the MICO socket address
+   and the calls taking it are the bench's, its select() ignores the first argument
+   like the one of MICO */
+#if defined( CONFIG_BENCH_MAIN )
+#include "mico_config.h"
+
+#ifndef IPPROTO_TCP
+#define IPPROTO_TCP                 6
+#endif
+#ifndef INADDR_ANY
+#define INADDR_ANY                  0x0
+#endif
+#define MAX_TCP_CLIENT_PER_SERVER   5
+
+struct sockaddr_t {
+  uint16_t        s_type;
+  uint16_t        s_port;
+  uint32_t        s_ip;
+  uint16_t        s_spares[6];
+};
+
+typedef struct {
+  int num_of_chunks;
+  int total_memory;
+  int allocted_memory;
+  int free_memory;
+} micoMemInfo_t;
+
+#define bind                config_bench_bind
+#define accept              config_bench_accept
+#define inet_ntoa           config_bench_inet_ntoa
+#define select              config_bench_select
+
+int config_bench_bind( int sockfd, const struct sockaddr_t *addr, int addrlen );
+int config_bench_accept( int sockfd, struct sockaddr_t *addr, int *addrlen );
+char *config_bench_inet_ntoa( char *s, uint32_t x );
+int config_bench_select( int nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds, struct timeval *timeout );
+micoMemInfo_t* MicoGetMemoryInfo( void );
+#endif
+
+#endif
@@ -0,0 +1,13 @@
+/**
+******************************************************************************
+* @file    MiCOAppDefine.h
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   The MiCOKit demo includes "MiCOAppDefine.h", which only resolves to
+*          MICOAppDefine.h on the case-insensitive file systems of the target
+*          toolchains.
+******************************************************************************
+*/
+
+#include "MICOAppDefine.h"
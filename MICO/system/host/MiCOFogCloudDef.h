@@ -0,0 +1,13 @@
+/**
+******************************************************************************
+* @file    MiCOFogCloudDef.h
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   The MiCOKit demo includes "MiCOFogCloudDef.h", which only resolves to
+*          MicoFogCloudDef.h on the case-insensitive file systems of the target
+*          toolchains.
+******************************************************************************
+*/
+
+#include "MicoFogCloudDef.h"
@@ -0,0 +1,12 @@
+/**
+******************************************************************************
+* @file    Mico.h
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   The SiteWhere demos include "Mico.h", which only resolves to MICO.h
+*          on the case-insensitive file systems of the target toolchains.
+******************************************************************************
+*/
+
+#include "MICO.h"
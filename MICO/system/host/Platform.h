@@ -0,0 +1,12 @@
+/**
+******************************************************************************
+* @file    Platform.h
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   config_server.c includes "Platform.h", which only resolves to platform.h
+*          on the case-insensitive file systems of the target toolchains.
+******************************************************************************
+*/
+
+#include "platform.h"
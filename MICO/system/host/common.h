@@ -0,0 +1,12 @@
+/**
+******************************************************************************
+* @file    common.h
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   system.h includes "common.h", which only resolves to Common.h on the
+*          case-insensitive file systems of the target toolchains.
+******************************************************************************
+*/
+
+#include "Common.h"
@@ -0,0 +1,12 @@
+/**
+******************************************************************************
+* @file    mico.h
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   config_server_menu.c includes "mico.h", which only resolves to MICO.h
+*          on the case-insensitive file systems of the target toolchains.
+******************************************************************************
+*/
+
+#include "MICO.h"
@@ -0,0 +1,36 @@
+/**
+******************************************************************************
+* @file    mico_config.h
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   Application settings for the host builds, see platform.h.
+******************************************************************************
+*/
+
+#ifndef __MICO_CONFIG_H__
+#define __MICO_CONFIG_H__
+
+#include <stdint.h>
+
+/* profiler-bench.c counts fake cycles and holds its fake PendSV instead of the interrupts */
+#if defined( PROFILER_BENCH_MAIN )
+#define MICO_PROFILER_ENABLE
+#define MICO_PROFILER_CYCLES()      profiler_bench_cycles()
+#define MICO_PROFILER_CYCLES_INIT()
+#define MICO_PROFILER_LOCK()        profiler_bench_lock( 1 )
+#define MICO_PROFILER_UNLOCK()      profiler_bench_lock( 0 )
+uint32_t profiler_bench_cycles( void );
+void profiler_bench_lock( int inLock );
+#endif
+
+/* config-bench.c reports these in /config-read */
+#if defined( CONFIG_BENCH_MAIN )
+#define MODEL                       "MiCO-Bench"
+#define HARDWARE_REVISION           "HOST"
+#define FIRMWARE_REVISION           "MICO_BENCH_1_0"
+#define PROTOCOL                    "com.mxchip.bench"
+#define MICO_CONFIG_SERVER_PORT     8000
+#endif
+
+#endif
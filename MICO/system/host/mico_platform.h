@@ -0,0 +1,18 @@
+/**
+******************************************************************************
+* @file    mico_platform.h
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   The part of mico_platform.h used by system.h in the host builds, only
+*          the flash driver, which kv-bench.c implements in RAM.
+******************************************************************************
+*/
+
+#ifndef __MICOPLATFORM_H__
+#define __MICOPLATFORM_H__
+
+#include "Common.h"
+#include "MicoDrivers/MicoDriverFlash.h"
+
+#endif
@@ -0,0 +1,30 @@
+/**
+******************************************************************************
+* @file    platform.h
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   Empty platform header for the host builds of the benches and tests
+*          next to the sources, e.g. MICO/security/aes-bench.c. Add -IMICO/system/host
+*          before -Iinclude.
+******************************************************************************
+*/
+
+#ifndef __PLATFORM_H__
+#define __PLATFORM_H__
+
+/* The flash drivers of a board, for MicoDriverFlash.h in kv-bench.c */
+typedef enum
+{
+  MICO_FLASH_EMBEDDED,
+  MICO_FLASH_SPI,
+  MICO_FLASH_MAX,
+  MICO_FLASH_NONE,
+} mico_flash_t;
+
+typedef enum
+{
+  MICO_PARTITION_USER_MAX
+} mico_user_partition_t;
+
+#endif
@@ -0,0 +1,14 @@
+/**
+******************************************************************************
+* @file    platform_assert.h
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   Empty platform assert header for the host builds, see platform.h.
+******************************************************************************
+*/
+
+#ifndef __PLATFORM_ASSERT_H__
+#define __PLATFORM_ASSERT_H__
+
+#endif
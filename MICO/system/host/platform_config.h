@@ -0,0 +1,15 @@
+/**
+******************************************************************************
+* @file    platform_config.h
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   Empty board settings for the host builds, config_server_menu.c
+*          includes it but needs none of them.
+******************************************************************************
+*/
+
+#ifndef __PLATFORM_CONFIG_H__
+#define __PLATFORM_CONFIG_H__
+
+#endif
@@ -0,0 +1,439 @@
+/**
+******************************************************************************
+* @file    http_ota.c
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   This file provide a resumable firmware download from an HTTP server
+*          to the OTA storage.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*
+* The body is received by the onReceivedDataCallback of HTTPUtils into one of
+* two blocks, while a writer thread programs the other one and updates the CRC
+* and MD5. So the socket is read while flash is written, and the OTA storage is
+* erased before the request is sent, never during the transfer.
+*
+* The written length and the CRC/MD5 state are saved in the key/value store
+* every HTTP_OTA_SAVE_INTERVAL bytes. After a drop, or a call for the same url
+* and MD5 later, the download continues from there with a Range request. The
+* boot table is marked BOOT_UPGRADE_DOWNLOAD, so the bootloader keeps the
+* partial image in the OTA storage across a reboot.
+*/
+
+#include "MICO.h"
+#include "HTTPUtils.h"
+#include "SocketUtils.h"
+#include "StringUtils.h"
+#include "CheckSumUtils.h"
+
+#define http_ota_log(M, ...) custom_log("HTTP OTA", M, ##__VA_ARGS__)
+#define http_ota_log_trace() custom_log_trace("HTTP OTA")
+
+#define HTTP_OTA_KEY_STATE        ( 0x0300 )  /* Next to the configuration keys in the kv store */
+
+#ifndef HTTP_OTA_BLOCK_SIZE
+#define HTTP_OTA_BLOCK_SIZE       ( 2048 )
+#endif
+
+#ifndef HTTP_OTA_SAVE_INTERVAL
+#define HTTP_OTA_SAVE_INTERVAL    ( 32*1024 )
+#endif
+
+#ifndef HTTP_OTA_RETRY
+#define HTTP_OTA_RETRY            ( 5 )
+#endif
+
+#define HTTP_OTA_RETRY_DELAY      ( 3 )       /* Seconds */
+#define HTTP_OTA_WRITER_STACK     ( 0x300 )
+#define HTTP_OTA_BLOCK_END        ( 0xFF )
+
+/* Saved in the kv store, tells where to resume */
+typedef struct {
+  uint16_t      id;         // CRC16 of url and md5
+  uint16_t      reserved;
+  uint32_t      length;     // Firmware length, 0 if nothing to resume
+  uint32_t      offset;     // Bytes written, and hashed into crc and md5
+  CRC16_Context crc;
+  md5_context   md5;
+} http_ota_state_t;
+
+typedef struct {
+  http_ota_state_t  state;
+  uint32_t          saved;              // state.offset when it was saved
+  OSStatus          write_err;
+
+  uint8_t           *block[2];
+  uint32_t          block_len[2];
+  uint8_t           fill;               // Block being filled from the socket
+  mico_queue_t      full_queue;         // Block index to the writer
+  mico_queue_t      free_queue;         // Block index back to the receiver
+
+  bool              response_checked;
+} http_ota_t;
+
+static void http_ota_save( http_ota_t *ota )
+{
+  mico_kv_item_t item = { HTTP_OTA_KEY_STATE, sizeof( http_ota_state_t ), &ota->state };
+
+  if( mico_kv_write( &item, 1 ) == kNoErr )
+    ota->saved = ota->state.offset;
+}
+
+static void http_ota_writer_thread( void *arg )
+{
+  http_ota_t *ota = arg;
+  uint8_t index;
+  uint32_t offset;
+
+  while( mico_rtos_pop_from_queue( &ota->full_queue, &index, MICO_WAIT_FOREVER ) == kNoErr ){
+    if( index == HTTP_OTA_BLOCK_END )
+      break;
+
+    if( ota->write_err == kNoErr ){
+      offset = ota->state.offset;
+      ota->write_err = MicoFlashWrite( MICO_PARTITION_OTA_TEMP, &offset, ota->block[index], ota->block_len[index] );
+      if( ota->write_err == kNoErr ){
+        CRC16_Update( &ota->state.crc, ota->block[index], ota->block_len[index] );
+        Md5Update( &ota->state.md5, ota->block[index], ota->block_len[index] );
+        ota->state.offset = offset;
+        if( ota->state.offset - ota->saved >= HTTP_OTA_SAVE_INTERVAL )
+          http_ota_save( ota );
+      }
+    }
+    ota->block_len[index] = 0;
+    mico_rtos_push_to_queue( &ota->free_queue, &index, MICO_WAIT_FOREVER );
+  }
+
+  mico_rtos_push_to_queue( &ota->free_queue, &index, MICO_WAIT_FOREVER );
+  mico_rtos_delete_thread( NULL );
+}
+
+/* Hand the block being filled to the writer and take the other one */
+static OSStatus http_ota_swap( http_ota_t *ota )
+{
+  mico_rtos_push_to_queue( &ota->full_queue, &ota->fill, MICO_WAIT_FOREVER );
+  mico_rtos_pop_from_queue( &ota->free_queue, &ota->fill, MICO_WAIT_FOREVER );
+  return ota->write_err;
+}
+
+/* Write the partly filled block and wait for the writer, state is stable after that */
+static OSStatus http_ota_sync( http_ota_t *ota )
+{
+  uint8_t other;
+
+  if( ota->block_len[ota->fill] > 0 )
+    http_ota_swap( ota );
+  mico_rtos_pop_from_queue( &ota->free_queue, &other, MICO_WAIT_FOREVER );
+  mico_rtos_push_to_queue( &ota->free_queue, &other, MICO_WAIT_FOREVER );
+  return ota->write_err;
+}
+
+/* 206 must continue where flash ends, 200 is only right for a download from the start */
+static OSStatus http_ota_check_response( HTTPHeader_t *inHeader, http_ota_t *ota )
+{
+  OSStatus err = kNoErr;
+  unsigned int start, end, total;
+
+  if( inHeader->statusCode == kStatusPartialContent ){
+    require_action( HTTPScanFHeaderValue( HTTPHeaderBuffer( inHeader ), inHeader->len, "Content-Range", "bytes %u-%u/%u", &start, &end, &total ) == 3,
+                    exit, err = kMalformedErr );
+    require_action( start == ota->state.offset && total == ota->state.length, exit, err = kRangeErr );
+  }
+  else if( inHeader->statusCode == kStatusOK ){
+    require_action( ota->state.offset == 0, exit, err = kRangeErr );
+    require_action( inHeader->contentLength > 0, exit, err = kResponseErr );
+    ota->state.length = inHeader->contentLength;
+  }
+  else{
+    http_ota_log("Server response %d", inHeader->statusCode);
+    err = kResponseErr;
+  }
+
+exit:
+  return err;
+}
+
+static OSStatus http_ota_received( struct _HTTPHeader_t * inHeader, uint32_t inPos, uint8_t * inData, size_t inLen, void * inUserContext )
+{
+  http_ota_t *ota = inUserContext;
+  OSStatus err = kNoErr;
+  size_t len;
+
+  if( ota->response_checked == false ){
+    err = http_ota_check_response( inHeader, ota );
+    require_noerr( err, exit );
+    ota->response_checked = true;
+  }
+
+  while( inLen > 0 ){
+    len = Min( inLen, HTTP_OTA_BLOCK_SIZE - ota->block_len[ota->fill] );
+    memcpy( ota->block[ota->fill] + ota->block_len[ota->fill], inData, len );
+    ota->block_len[ota->fill] += len;
+    inData += len;
+    inLen -= len;
+    if( ota->block_len[ota->fill] == HTTP_OTA_BLOCK_SIZE ){
+      err = http_ota_swap( ota );
+      require_noerr( err, exit );
+    }
+  }
+
+exit:
+  return err;
+}
+
+/* Check the saved state against flash, the partial image may have been erased */
+static bool http_ota_can_resume( http_ota_t *ota, uint16_t id )
+{
+  CRC16_Context crc, saved;
+  uint32_t offset = 0, len;
+  uint16_t result, expect;
+
+  if( mico_kv_read( HTTP_OTA_KEY_STATE, &ota->state, sizeof( http_ota_state_t ) ) != kNoErr )
+    return false;
+  if( ota->state.id != id || ota->state.length == 0 || ota->state.offset > ota->state.length ||
+      ota->state.offset > MicoFlashGetInfo( MICO_PARTITION_OTA_TEMP )->partition_length )
+    return false;
+
+  CRC16_Init( &crc );
+  while( offset < ota->state.offset ){
+    len = Min( ota->state.offset - offset, HTTP_OTA_BLOCK_SIZE );
+    if( MicoFlashRead( MICO_PARTITION_OTA_TEMP, &offset, ota->block[0], len ) != kNoErr )
+      return false;
+    CRC16_Update( &crc, ota->block[0], len );
+  }
+  CRC16_Final( &crc, &result );
+  saved = ota->state.crc;
+  CRC16_Final( &saved, &expect );
+  return result == expect;
+}
+
+static OSStatus http_ota_start( http_ota_t *ota, uint16_t id )
+{
+  OSStatus err = kNoErr;
+  mico_Context_t *context = mico_system_context_get( );
+  mico_logic_partition_t *ota_partition = MicoFlashGetInfo( MICO_PARTITION_OTA_TEMP );
+
+  memset( &ota->state, 0x0, sizeof( http_ota_state_t ) );
+  ota->state.id = id;
+  CRC16_Init( &ota->state.crc );
+  InitMd5( &ota->state.md5 );
+
+  /* Keep the partial image over a reboot, unless a new slot is still on trial */
+  if( context && context->flashContentInRam.bootTable.upgrade_type != BOOT_UPGRADE_TRIAL &&
+      context->flashContentInRam.bootTable.upgrade_type != BOOT_UPGRADE_DOWNLOAD ){
+    mico_rtos_lock_mutex( &context->flashContentInRam_mutex );
+    context->flashContentInRam.bootTable.upgrade_type = BOOT_UPGRADE_DOWNLOAD;
+    mico_rtos_unlock_mutex( &context->flashContentInRam_mutex );
+    mico_system_context_update( context );
+  }
+
+  err = MicoFlashErase( MICO_PARTITION_OTA_TEMP, 0x0, ota_partition->partition_length );
+  require_noerr( err, exit );
+  http_ota_save( ota );
+
+exit:
+  return err;
+}
+
+/* One request, from state.offset to the end */
+static OSStatus http_ota_request( http_ota_t *ota, const char *host, const char *host_field, uint16_t port, const char *path )
+{
+  OSStatus err = kNoErr;
+  OSStatus response_err;
+  int fd = -1;
+  char ipstr[16];
+  struct sockaddr_t addr;
+  char *request = NULL;
+  HTTPHeader_t *httpHeader = NULL;
+
+  err = gethostbyname( host, (uint8_t *)ipstr, sizeof(ipstr) );
+  require_noerr( err, exit );
+
+  fd = socket( AF_INET, SOCK_STREAM, IPPROTO_TCP );
+  require_action( IsValidSocket( fd ), exit, err = kNoResourcesErr );
+  addr.s_ip = inet_addr( ipstr );
+  addr.s_port = port;
+  err = connect( fd, &addr, sizeof(addr) );
+  require_noerr( err, exit );
+
+  request = malloc( strlen( path ) + strlen( host_field ) + 96 );
+  require_action( request, exit, err = kNoMemoryErr );
+  sprintf( request, "GET %s HTTP/1.1\r\nHost: %s\r\nRange: bytes=%u-\r\nConnection: close\r\n\r\n",
+           path, host_field, (unsigned int)ota->state.offset );
+  err = SocketSend( fd, (uint8_t *)request, strlen( request ) );
+  require_noerr( err, exit );
+
+  httpHeader = HTTPHeaderCreateWithCallback( http_ota_received, NULL, ota );
+  require_action( httpHeader, exit, err = kNoMemoryErr );
+  ota->response_checked = false;
+
+  /* A response refused by the callback is kept in RAM by HTTPUtils, which can
+     fail first, so check it again for the right error */
+  err = SocketReadHTTPHeader( fd, httpHeader );
+  if( ota->response_checked == false && httpHeader->statusCode != 0 ){
+    response_err = http_ota_check_response( httpHeader, ota );
+    if( response_err != kNoErr ) err = response_err;
+  }
+  require_noerr( err, exit );
+  require_action( httpHeader->isCallbackSupported == true || httpHeader->contentLength == 0, exit, err = kResponseErr );
+
+  err = SocketReadHTTPBody( fd, httpHeader );
+  require_noerr( err, exit );
+  /* A chunked body refused by the callback is dropped without an error */
+  if( ota->response_checked == false ){
+    err = http_ota_check_response( httpHeader, ota );
+    require_noerr( err, exit );
+    require_action( httpHeader->isCallbackSupported == true, exit, err = kResponseErr );
+  }
+
+exit:
+  if( http_ota_sync( ota ) != kNoErr )
+    err = ota->write_err;
+  if( httpHeader ){
+    HTTPHeaderClear( httpHeader );
+    free( httpHeader );
+  }
+  if( request ) free( request );
+  SocketClose( &fd );
+  return err;
+}
+
+OSStatus http_ota( const char *url, const char *md5, uint32_t *outLength, uint16_t *outCrc )
+{
+  OSStatus err = kNoErr;
+  http_ota_t *ota = NULL;
+  URLComponents components;
+  char *host = NULL, *host_field, *path, *colon;
+  uint16_t port = 80;
+  uint16_t id;
+  uint8_t index, md5_16[16];
+  char *md5_32 = NULL;
+  int retry = HTTP_OTA_RETRY;
+  CRC16_Context crc16_contex;
+
+  http_ota_log_trace();
+
+  err = URLParseComponents( url, NULL, &components, NULL );
+  require_noerr( err, exit );
+  require_action( components.hostPtr && components.hostLen, exit, err = kParamErr );
+
+  /* host name, "Host:" field with the port, and path in one block */
+  host = calloc( 2 * ( components.hostLen + 1 ) + strlen( components.pathPtr ? components.pathPtr : "" ) + 2, 1 );
+  require_action( host, exit, err = kNoMemoryErr );
+  memcpy( host, components.hostPtr, components.hostLen );
+  host_field = host + components.hostLen + 1;
+  memcpy( host_field, components.hostPtr, components.hostLen );
+  colon = strchr( host, ':' );
+  if( colon ){
+    *colon = '\0';
+    port = (uint16_t)atoi( colon + 1 );
+  }
+  path = host_field + components.hostLen + 1;
+  strcpy( path, ( components.pathPtr && components.pathLen ) ? components.pathPtr : "/" );
+
+  CRC16_Init( &crc16_contex );
+  CRC16_Update( &crc16_contex, url, strlen( url ) );
+  if( md5 ) CRC16_Update( &crc16_contex, md5, strlen( md5 ) );
+  CRC16_Final( &crc16_contex, &id );
+
+  ota = calloc( 1, sizeof( http_ota_t ) );
+  require_action( ota, exit, err = kNoMemoryErr );
+  ota->block[0] = malloc( HTTP_OTA_BLOCK_SIZE );
+  ota->block[1] = malloc( HTTP_OTA_BLOCK_SIZE );
+  require_action( ota->block[0] && ota->block[1], exit, err = kNoMemoryErr );
+
+  if( http_ota_can_resume( ota, id ) == true ){
+    http_ota_log("Resume from %d/%d", ota->state.offset, ota->state.length);
+    ota->saved = ota->state.offset;
+  }
+  else{
+    err = http_ota_start( ota, id );
+    require_noerr( err, exit );
+  }
+
+  err = mico_rtos_init_queue( &ota->full_queue, "OTA full", sizeof(uint8_t), 2 );
+  require_noerr( err, exit );
+  err = mico_rtos_init_queue( &ota->free_queue, "OTA free", sizeof(uint8_t), 2 );
+  require_noerr( err, exit );
+  index = 1;
+  mico_rtos_push_to_queue( &ota->free_queue, &index, MICO_WAIT_FOREVER );
+  ota->fill = 0;
+
+  err = mico_rtos_create_thread( NULL, MICO_APPLICATION_PRIORITY, "OTA writer", http_ota_writer_thread, HTTP_OTA_WRITER_STACK, ota );
+  require_noerr( err, exit );
+
+  while( ota->state.length == 0 || ota->state.offset < ota->state.length ){
+    err = http_ota_request( ota, host, host_field, port, path );
+    if( err == kNoErr && ota->state.offset == ota->state.length )
+      break;
+
+    http_ota_save( ota );
+    http_ota_log("Download stopped at %d/%d, err=%d", ota->state.offset, ota->state.length, err);
+
+    /* The server ignored the range, start over */
+    if( err == kRangeErr ){
+      err = http_ota_start( ota, id );
+      require_noerr( err, stop );
+    }
+    require_action( err != kResponseErr && ota->write_err == kNoErr, stop, err = ( ota->write_err ) ? ota->write_err : err );
+    require_action( retry-- > 0, stop, err = kTimeoutErr );
+    sleep( HTTP_OTA_RETRY_DELAY );
+  }
+
+  Md5Final( &ota->state.md5, md5_16 );
+  if( md5 && *md5 ){
+    md5_32 = DataToHexString( md5_16, sizeof(md5_16) );
+    require_action( md5_32, stop, err = kNoMemoryErr );
+    require_action( strnicmp( md5_32, md5, 32 ) == 0, stop, err = kChecksumErr; http_ota_log("MD5 error") );
+  }
+
+  if( outLength ) *outLength = ota->state.length;
+  if( outCrc ) CRC16_Final( &ota->state.crc, outCrc );
+  http_ota_log("Download %d bytes done", ota->state.length);
+
+stop:
+  /* Nothing to resume after the image is done or wrong */
+  if( err == kNoErr || err == kChecksumErr ){
+    ota->state.length = 0;
+    http_ota_save( ota );
+  }
+  index = HTTP_OTA_BLOCK_END;
+  mico_rtos_push_to_queue( &ota->full_queue, &index, MICO_WAIT_FOREVER );
+  mico_rtos_pop_from_queue( &ota->free_queue, &index, MICO_WAIT_FOREVER );
+  while( index != HTTP_OTA_BLOCK_END )
+    mico_rtos_pop_from_queue( &ota->free_queue, &index, MICO_WAIT_FOREVER );
+
+exit:
+  if( err != kNoErr ) http_ota_log("Exit with err = %d", err);
+  if( ota ){
+    if( ota->full_queue ) mico_rtos_deinit_queue( &ota->full_queue );
+    if( ota->free_queue ) mico_rtos_deinit_queue( &ota->free_queue );
+    if( ota->block[0] ) free( ota->block[0] );
+    if( ota->block[1] ) free( ota->block[1] );
+    free( ota );
+  }
+  if( md5_32 ) free( md5_32 );
+  if( host ) free( host );
+  return err;
+}
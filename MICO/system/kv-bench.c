@@ -0,0 +1,606 @@
+/**
+******************************************************************************
+* @file    kv-bench.c
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   Key/value store tests on a simulated NOR flash with power failures,
+*          and the erases and time spent per transaction.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+/* Built on the host only: the two parameter partitions are the RAM flash below, which programs like NOR (a write can
+ * only clear bits, an erase sets a whole page to 0xFF) and can lose power after any byte written or during an erase.
+ * MICO/system/host holds the stub platform headers:
+ *
+ *   cc -O2 -DDEBUG=0 -DKV_BENCH_MAIN -IMICO/system/host -Iinclude -IMICO/system -Ilibraries/utilities \
+ *      MICO/system/kv-bench.c MICO/system/mico_system_kv.c libraries/utilities/CheckSumUtils.c -o kv-bench && ./kv-bench
+ *
+ * After a power failure the store is opened again, as on the next boot, and must hold either every item of the
+ * interrupted transaction or none of them.
+ */
+
+#include "Common.h"
+#include "Debug.h"
+#include "mico_rtos.h"
+#include "system.h"
+
+#include <setjmp.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if( defined( KV_BENCH_MAIN ) )
+
+#if( defined( __i386__ ) || defined( __x86_64__ ) )
+    #include <x86intrin.h>
+    #define kv_bench_ticks()        ( (uint64_t) __rdtsc() )
+    #define kKV_BenchUnit           "cycles"
+#else
+    #include <time.h>
+    static uint64_t kv_bench_ticks( void )
+    {
+        struct timespec     ts;
+
+        clock_gettime( CLOCK_MONOTONIC, &ts );
+        return( ( (uint64_t) ts.tv_sec * 1000000000 ) + ts.tv_nsec );
+    }
+    #define kKV_BenchUnit           "ns"
+#endif
+
+#define kKV_BenchPageSize           0x1000
+#define kKV_BenchKeys               24
+#define kKV_BenchValueMax           96
+#define kKV_BenchNoFailure          -1
+
+//===========================================================================================================================
+//  Flash on the host
+//===========================================================================================================================
+
+static uint8_t                  gKV_BenchFlash[ 2 ][ kKV_BenchPageSize ];
+static mico_logic_partition_t   gKV_BenchPartitions[ 2 ] =
+{
+    { MICO_FLASH_SPI, "PARAMETER1", 0x0000, kKV_BenchPageSize, PAR_OPT_READ_EN | PAR_OPT_WRITE_EN },
+    { MICO_FLASH_SPI, "PARAMETER2", 0x1000, kKV_BenchPageSize, PAR_OPT_READ_EN | PAR_OPT_WRITE_EN },
+};
+static unsigned int             gKV_BenchSeed = 1;
+static long                     gKV_BenchErases;
+static long                     gKV_BenchBytes;
+static long                     gKV_BenchFailAfter = kKV_BenchNoFailure; // Bytes or erases left before the power fails
+static jmp_buf                  gKV_BenchPowerFail;
+
+static int kv_bench_page( mico_partition_t inPartition )
+{
+    if( inPartition == MICO_PARTITION_PARAMETER_1 ) return( 0 );
+    if( inPartition == MICO_PARTITION_PARAMETER_2 ) return( 1 );
+    return( -1 );
+}
+
+static bool kv_bench_power_fails( void )
+{
+    if( gKV_BenchFailAfter == kKV_BenchNoFailure ) return( false );
+    return( gKV_BenchFailAfter-- == 0 );
+}
+
+mico_logic_partition_t* MicoFlashGetInfo( mico_partition_t inPartition )
+{
+    int const       page = kv_bench_page( inPartition );
+
+    return( ( page < 0 ) ? NULL : &gKV_BenchPartitions[ page ] );
+}
+
+OSStatus MicoFlashErase( mico_partition_t inPartition, uint32_t off_set, uint32_t size )
+{
+    int const       page = kv_bench_page( inPartition );
+    uint32_t        torn, i;
+
+    if( page < 0 || off_set + size > kKV_BenchPageSize ) return( kParamErr );
+
+    // A torn erase: part of the page is erased, a few bytes at the edge hold random bits.
+
+    if( kv_bench_power_fails() )
+    {
+        torn = rand_r( &gKV_BenchSeed ) % size;
+        memset( &gKV_BenchFlash[ page ][ off_set ], 0xFF, torn );
+        for( i = torn; i < size && i < torn + 8; ++i ) gKV_BenchFlash[ page ][ off_set + i ] |= rand_r( &gKV_BenchSeed );
+        longjmp( gKV_BenchPowerFail, 1 );
+    }
+    memset( &gKV_BenchFlash[ page ][ off_set ], 0xFF, size );
+    gKV_BenchErases++;
+    return( kNoErr );
+}
+
+OSStatus MicoFlashWrite( mico_partition_t inPartition, volatile uint32_t* off_set, uint8_t* inBuffer, uint32_t inBufferLength )
+{
+    int const       page = kv_bench_page( inPartition );
+    uint32_t        i;
+
+    if( page < 0 || *off_set + inBufferLength > kKV_BenchPageSize ) return( kParamErr );
+
+    for( i = 0; i < inBufferLength; ++i )
+    {
+        // A torn write: only some of the bits of the byte are programmed.
+
+        if( kv_bench_power_fails() )
+        {
+            gKV_BenchFlash[ page ][ *off_set + i ] &= inBuffer[ i ] | (uint8_t) rand_r( &gKV_BenchSeed );
+            longjmp( gKV_BenchPowerFail, 1 );
+        }
+        gKV_BenchFlash[ page ][ *off_set + i ] &= inBuffer[ i ];
+        gKV_BenchBytes++;
+    }
+    *off_set += inBufferLength;
+    return( kNoErr );
+}
+
+OSStatus MicoFlashRead( mico_partition_t inPartition, volatile uint32_t* off_set, uint8_t* outBuffer, uint32_t inBufferLength )
+{
+    int const       page = kv_bench_page( inPartition );
+
+    if( page < 0 || *off_set + inBufferLength > kKV_BenchPageSize ) return( kParamErr );
+    memcpy( outBuffer, &gKV_BenchFlash[ page ][ *off_set ], inBufferLength );
+    *off_set += inBufferLength;
+    return( kNoErr );
+}
+
+//===========================================================================================================================
+//  RTOS calls on the host
+//===========================================================================================================================
+
+OSStatus mico_rtos_init_mutex( mico_mutex_t *inMutex )
+{
+    *inMutex = (mico_mutex_t) gKV_BenchFlash;
+    return( kNoErr );
+}
+
+OSStatus mico_rtos_lock_mutex( mico_mutex_t *inMutex )
+{
+    (void) inMutex;
+    return( kNoErr );
+}
+
+OSStatus mico_rtos_unlock_mutex( mico_mutex_t *inMutex )
+{
+    (void) inMutex;
+    return( kNoErr );
+}
+
+//===========================================================================================================================
+//  Model
+//===========================================================================================================================
+
+// What the store must hold: the length of each key, 0 when it was never written, and its value.
+
+typedef struct
+{
+    uint16_t        length[ kKV_BenchKeys ];
+    uint8_t         value[ kKV_BenchKeys ][ kKV_BenchValueMax ];
+
+}   kv_bench_model_t;
+
+static void kv_bench_erase_all( void )
+{
+    memset( gKV_BenchFlash, 0xFF, sizeof( gKV_BenchFlash ) );
+}
+
+static OSStatus kv_bench_open( void )
+{
+    OSStatus        err;
+
+    err = mico_kv_init( MICO_PARTITION_PARAMETER_1, MICO_PARTITION_PARAMETER_2 );
+    if( err == kNotFoundErr ) err = kNoErr; // Empty flash, created on the first write
+    return( err );
+}
+
+static bool kv_bench_holds( const kv_bench_model_t *inModel )
+{
+    uint8_t         value[ kKV_BenchValueMax ];
+    uint16_t        key;
+
+    for( key = 0; key < kKV_BenchKeys; ++key )
+    {
+        if( inModel->length[ key ] == 0 )
+        {
+            if( mico_kv_read( key, value, 1 ) != kNotFoundErr ) return( false );
+            continue;
+        }
+        if( mico_kv_read( key, value, inModel->length[ key ] ) != kNoErr ) return( false );
+        if( memcmp( value, inModel->value[ key ], inModel->length[ key ] ) != 0 ) return( false );
+        if( !mico_kv_match( key, inModel->value[ key ], inModel->length[ key ] ) ) return( false );
+    }
+    return( true );
+}
+
+// A transaction of 1 to 4 distinct keys with new random values, applied to the model.
+
+static uint32_t kv_bench_transaction( kv_bench_model_t *ioModel, mico_kv_item_t *outItems )
+{
+    uint32_t        count = 1 + rand_r( &gKV_BenchSeed ) % 4;
+    uint32_t        i, j;
+    uint16_t        key;
+
+    for( i = 0; i < count; ++i )
+    {
+        do
+        {
+            key = rand_r( &gKV_BenchSeed ) % kKV_BenchKeys;
+            for( j = 0; j < i && outItems[ j ].key != key; ++j );
+        }   while( j < i );
+
+        ioModel->length[ key ] = 1 + rand_r( &gKV_BenchSeed ) % kKV_BenchValueMax;
+        for( j = 0; j < ioModel->length[ key ]; ++j ) ioModel->value[ key ][ j ] = rand_r( &gKV_BenchSeed );
+        outItems[ i ].key = key;
+        outItems[ i ].length = ioModel->length[ key ];
+        outItems[ i ].data = ioModel->value[ key ];
+    }
+    return( count );
+}
+
+//===========================================================================================================================
+//  kv_api_test
+//===========================================================================================================================
+
+static OSStatus kv_api_test( void )
+{
+    OSStatus            err;
+    mico_kv_item_t      items[ MICO_KV_MAX_KEYS + 1 ];
+    uint8_t             value[ 16 ];
+    uint8_t             big[ kKV_BenchPageSize ];
+    uint16_t            key;
+
+    kv_bench_erase_all();
+    require_action( mico_kv_init( MICO_PARTITION_PARAMETER_1, MICO_PARTITION_PARAMETER_2 ) == kNotFoundErr, exit,
+                    err = kStateErr );
+    require_action( mico_kv_init( MICO_PARTITION_PARAMETER_1, MICO_PARTITION_NONE ) == kUnsupportedErr, exit,
+                    err = kStateErr );
+    err = kv_bench_open();
+    require_noerr( err, exit );
+
+    items[ 0 ].key = 7;
+    items[ 0 ].length = 5;
+    items[ 0 ].data = "hello";
+    items[ 1 ].key = 9;
+    items[ 1 ].length = 0;
+    items[ 1 ].data = NULL;
+    err = mico_kv_write( items, 2 );
+    require_noerr( err, exit );
+
+    // Reads need the length written, an empty value is a value.
+
+    require_action( mico_kv_read( 7, value, 5 ) == kNoErr && memcmp( value, "hello", 5 ) == 0, exit, err = kMismatchErr );
+    require_action( mico_kv_read( 7, value, 4 ) == kSizeErr, exit, err = kMismatchErr );
+    require_action( mico_kv_read( 8, value, 5 ) == kNotFoundErr, exit, err = kMismatchErr );
+    require_action( mico_kv_read( 9, value, 0 ) == kNoErr, exit, err = kMismatchErr );
+    require_action( mico_kv_match( 7, "hello", 5 ) && !mico_kv_match( 7, "hellO", 5 ) && !mico_kv_match( 7, "hell", 4 ),
+                    exit, err = kMismatchErr );
+
+    // Bad items change nothing.
+
+    items[ 0 ].key = MICO_KV_KEY_COMMIT;
+    require_action( mico_kv_write( items, 1 ) == kParamErr, exit, err = kMismatchErr );
+    require_action( mico_kv_write( NULL, 1 ) == kParamErr && mico_kv_write( NULL, 0 ) == kNoErr, exit, err = kMismatchErr );
+
+    memset( big, 0x33, sizeof( big ) );
+    items[ 0 ].key = 1;
+    items[ 0 ].length = kKV_BenchPageSize - 0x40;
+    items[ 0 ].data = big;
+    require_action( mico_kv_write( items, 1 ) == kNoSpaceErr, exit, err = kMismatchErr );
+
+    for( key = 0; key <= MICO_KV_MAX_KEYS; ++key )
+    {
+        items[ key ].key = 100 + key;
+        items[ key ].length = 1;
+        items[ key ].data = &big[ key ];
+    }
+    require_action( mico_kv_write( items, MICO_KV_MAX_KEYS + 1 ) == kNoSpaceErr, exit, err = kMismatchErr );
+
+    err = kv_bench_open();
+    require_noerr( err, exit );
+    require_action( mico_kv_read( 7, value, 5 ) == kNoErr && memcmp( value, "hello", 5 ) == 0, exit, err = kMismatchErr );
+    require_action( mico_kv_read( 1, value, 1 ) == kNotFoundErr && mico_kv_read( 100, value, 1 ) == kNotFoundErr, exit,
+                    err = kMismatchErr );
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  kv_compact_test
+//===========================================================================================================================
+
+// Updates fill a page then move the live values to the other one, which is the only erase.
+
+static OSStatus kv_compact_test( int print )
+{
+    OSStatus            err;
+    kv_bench_model_t    model;
+    mico_kv_item_t      items[ 4 ];
+    uint32_t            count;
+    long                erases, bytes;
+    int                 i;
+
+    kv_bench_erase_all();
+    memset( &model, 0, sizeof( model ) );
+    err = kv_bench_open();
+    require_noerr( err, exit );
+
+    erases = gKV_BenchErases;
+    bytes = gKV_BenchBytes;
+    for( i = 0; i < 5000; ++i )
+    {
+        count = kv_bench_transaction( &model, items );
+        err = mico_kv_write( items, count );
+        require_noerr( err, exit );
+        require_action( kv_bench_holds( &model ), exit, err = kMismatchErr );
+        if( ( i % 101 ) == 0 )
+        {
+            err = kv_bench_open();
+            require_noerr( err, exit );
+            require_action( kv_bench_holds( &model ), exit, err = kMismatchErr );
+        }
+    }
+    erases = gKV_BenchErases - erases;
+    bytes = gKV_BenchBytes - bytes;
+    if( print )
+        printf( "5000 transactions: %ld erases, %.1f bytes programmed per transaction\n", erases, (double) bytes / 5000 );
+    require_action( erases > 0 && erases < 5000 / 10, exit, err = kCountErr );
+
+    // The first page is only written by a compaction, both pages are used in turn.
+
+    require_action( gKV_BenchFlash[ 0 ][ MICO_KV_PREAMBLE_SIZE ] != 0xFF && gKV_BenchFlash[ 1 ][ MICO_KV_PREAMBLE_SIZE ] != 0xFF,
+                    exit, err = kStateErr );
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  kv_power_test
+//===========================================================================================================================
+
+// Power fails at a random byte or erase of a transaction, a compaction included. The store opened again holds the old
+// or the new values, and is written again as if nothing happened.
+
+static OSStatus kv_power_test( int print )
+{
+    OSStatus                    err;
+    static kv_bench_model_t     before, after;
+    mico_kv_item_t              items[ 4 ];
+    uint32_t                    count;
+    int                         i;
+    volatile int                old_state = 0, new_state = 0, failed = 0;
+
+    kv_bench_erase_all();
+    memset( &before, 0, sizeof( before ) );
+    err = kv_bench_open();
+    require_noerr( err, exit );
+
+    for( i = 0; i < 20000; ++i )
+    {
+        after = before;
+        count = kv_bench_transaction( &after, items );
+
+        // Most failures in the append of the transaction, some in a compaction which copies up to a page.
+
+        gKV_BenchFailAfter = rand_r( &gKV_BenchSeed ) % ( ( i % 4 ) ? 512 : 2 * kKV_BenchPageSize );
+        if( setjmp( gKV_BenchPowerFail ) == 0 )
+        {
+            err = mico_kv_write( items, count );
+            gKV_BenchFailAfter = kKV_BenchNoFailure;
+            require_noerr( err, exit );
+        }
+        else
+        {
+            failed++;
+        }
+        gKV_BenchFailAfter = kKV_BenchNoFailure;
+
+        err = kv_bench_open();
+        require_noerr( err, exit );
+        if( kv_bench_holds( &after ) )
+        {
+            new_state++;
+            before = after;
+        }
+        else if( kv_bench_holds( &before ) )
+        {
+            old_state++;
+        }
+        else
+        {
+            printf( "transaction %d: neither the old nor the new values\n", i );
+            err = kIntegrityErr;
+            goto exit;
+        }
+    }
+    if( print )
+        printf( "20000 transactions, %d power failures: %d old, %d new values\n", failed, old_state, new_state );
+    require_action( failed > 0 && old_state > 0, exit, err = kCountErr );
+
+exit:
+    gKV_BenchFailAfter = kKV_BenchNoFailure;
+    return( err );
+}
+
+//===========================================================================================================================
+//  kv_preamble_test
+//===========================================================================================================================
+
+// The preamble (the boot table) stays at the start of the first page. Clearing bits programs it in place, anything else
+// moves the log to the second page and rebuilds the first.
+
+static OSStatus kv_preamble_test( void )
+{
+    OSStatus            err;
+    kv_bench_model_t    model;
+    mico_kv_item_t      items[ 4 ];
+    uint8_t             preamble[ MICO_KV_PREAMBLE_SIZE ];
+    uint8_t             check[ MICO_KV_PREAMBLE_SIZE ];
+    uint32_t            count;
+    long                erases;
+    int                 i;
+
+    kv_bench_erase_all();
+    memset( &model, 0, sizeof( model ) );
+    for( i = 0; i < MICO_KV_PREAMBLE_SIZE; ++i ) gKV_BenchFlash[ 0 ][ i ] = 0xA0 + i;
+    err = kv_bench_open();
+    require_noerr( err, exit );
+
+    for( i = 0; i < 400; ++i )
+    {
+        count = kv_bench_transaction( &model, items );
+        err = mico_kv_write( items, count );
+        require_noerr( err, exit );
+    }
+    err = mico_kv_read_preamble( preamble, sizeof( preamble ) );
+    require_noerr( err, exit );
+    for( i = 0; i < MICO_KV_PREAMBLE_SIZE; ++i )
+        require_action( preamble[ i ] == 0xA0 + i && gKV_BenchFlash[ 0 ][ i ] == 0xA0 + i, exit, err = kMismatchErr );
+    require_action( mico_kv_read_preamble( preamble, MICO_KV_PREAMBLE_SIZE + 1 ) == kSizeErr, exit, err = kMismatchErr );
+
+    // In place
+
+    preamble[ 3 ] = 0x00;
+    erases = gKV_BenchErases;
+    err = mico_kv_write_preamble( preamble, 4 );
+    require_noerr( err, exit );
+    require_action( gKV_BenchErases == erases && gKV_BenchFlash[ 0 ][ 3 ] == 0x00, exit, err = kStateErr );
+
+    // Relocated, whichever page is active
+
+    for( i = 0; i < 2; ++i )
+    {
+        preamble[ 3 ] = 0xFF;
+        preamble[ 30 ] = 0x55 + i;
+        erases = gKV_BenchErases;
+        err = mico_kv_write_preamble( preamble, sizeof( preamble ) );
+        require_noerr( err, exit );
+        require_action( gKV_BenchErases > erases && gKV_BenchErases <= erases + 2, exit, err = kCountErr );
+        require_action( memcmp( gKV_BenchFlash[ 0 ], preamble, sizeof( preamble ) ) == 0, exit, err = kMismatchErr );
+        require_action( kv_bench_holds( &model ), exit, err = kMismatchErr );
+
+        err = kv_bench_open();
+        require_noerr( err, exit );
+        require_action( kv_bench_holds( &model ), exit, err = kMismatchErr );
+        err = mico_kv_read_preamble( check, sizeof( check ) );
+        require_action( err == kNoErr && memcmp( check, preamble, sizeof( check ) ) == 0, exit, err = kMismatchErr );
+
+        count = kv_bench_transaction( &model, items );
+        err = mico_kv_write( items, count );
+        require_noerr( err, exit );
+    }
+
+    // A power failure while the preamble moves never loses the values.
+
+    for( i = 0; i < 500; ++i )
+    {
+        preamble[ 30 ] ^= 0xFF;
+        gKV_BenchFailAfter = rand_r( &gKV_BenchSeed ) % ( 3 * kKV_BenchPageSize );
+        if( setjmp( gKV_BenchPowerFail ) == 0 )
+        {
+            err = mico_kv_write_preamble( preamble, sizeof( preamble ) );
+            gKV_BenchFailAfter = kKV_BenchNoFailure;
+            require_noerr( err, exit );
+        }
+        gKV_BenchFailAfter = kKV_BenchNoFailure;
+        err = kv_bench_open();
+        require_noerr( err, exit );
+        require_action( kv_bench_holds( &model ), exit, err = kIntegrityErr );
+    }
+
+exit:
+    gKV_BenchFailAfter = kKV_BenchNoFailure;
+    return( err );
+}
+
+//===========================================================================================================================
+//  kv_bench_report
+//===========================================================================================================================
+
+static void kv_bench_report( const char *inMode, uint64_t inTicks, size_t inCount )
+{
+    printf( "%-40s %10.1f %s/call\n", inMode, (double) inTicks / (double) inCount, kKV_BenchUnit );
+}
+
+//===========================================================================================================================
+//  kv_bench
+//===========================================================================================================================
+
+OSStatus    kv_bench( int print )
+{
+    OSStatus            err;
+    kv_bench_model_t    model;
+    mico_kv_item_t      items[ 4 ];
+    uint8_t             value[ kKV_BenchValueMax ];
+    uint64_t            t;
+    size_t              i, loops;
+    uint32_t            count;
+
+    err = kv_api_test();
+    require_noerr( err, exit );
+    err = kv_compact_test( print );
+    require_noerr( err, exit );
+    err = kv_power_test( print );
+    require_noerr( err, exit );
+    err = kv_preamble_test();
+    require_noerr( err, exit );
+    if( !print ) goto exit;
+
+    // Writes of 1 to 4 items, compactions included, reads of one item, and opening a full page.
+
+    kv_bench_erase_all();
+    memset( &model, 0, sizeof( model ) );
+    kv_bench_open();
+    loops = 20000;
+    t = 0;
+    for( i = 0; i < loops; ++i )
+    {
+        uint64_t        start;
+
+        count = kv_bench_transaction( &model, items );
+        start = kv_bench_ticks();
+        mico_kv_write( items, count );
+        t += kv_bench_ticks() - start;
+    }
+    kv_bench_report( "mico_kv_write", t, loops );
+
+    t = kv_bench_ticks();
+    for( i = 0; i < loops; ++i ) mico_kv_read( i % kKV_BenchKeys, value, model.length[ i % kKV_BenchKeys ] );
+    kv_bench_report( "mico_kv_read", kv_bench_ticks() - t, loops );
+
+    loops = 1000;
+    t = kv_bench_ticks();
+    for( i = 0; i < loops; ++i ) kv_bench_open();
+    kv_bench_report( "mico_kv_init", kv_bench_ticks() - t, loops );
+
+exit:
+    printf( "%s: %s\n", __FUNCTION__, !err ? "PASSED" : "FAILED" );
+    return( err );
+}
+
+int main( void )
+{
+    return( kv_bench( 1 ) ? 1 : 0 );
+}
+
+#endif // KV_BENCH_MAIN
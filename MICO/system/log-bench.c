@@ -0,0 +1,590 @@
+/**
+******************************************************************************
+* @file    log-bench.c
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   Deferred log tests, and the cost of a log call formatted in place or
+*          queued to the log ring.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+/* Built on the host against the real mico_rtos.h, the RTOS calls used by the log are defined below with pthreads.
+ * MICO/system/host holds the stub platform headers:
+ *
+ *   cc -O2 -DDEBUG=1 -DMICO_LOG_DEFERRED=1 -DLOG_BENCH_MAIN -IMICO/system/host -Iinclude -Ilibraries/utilities \
+ *      MICO/system/log-bench.c MICO/system/mico_system_log.c -lpthread -o log-bench && ./log-bench
+ *
+ * On the target log_bench() can be called from a test command before mico_system_init() starts the log thread, as
+ * the tests drain the ring themselves. Results are then in ns from mico_get_time() instead of cycles.
+ */
+
+#include "Common.h"
+#include "Debug.h"
+#include "mico_rtos.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#if( defined( __i386__ ) || defined( __x86_64__ ) )
+    #include <x86intrin.h>
+    #define log_bench_ticks()       ( (uint64_t) __rdtsc() )
+    #define kLog_BenchUnit          "cycles"
+    #define kLog_BenchScale         1
+#elif( defined( LOG_BENCH_MAIN ) )
+    #include <time.h>
+    static uint64_t log_bench_ticks( void )
+    {
+        struct timespec     ts;
+
+        clock_gettime( CLOCK_MONOTONIC, &ts );
+        return( ( (uint64_t) ts.tv_sec * 1000000000 ) + ts.tv_nsec );
+    }
+    #define kLog_BenchUnit          "ns"
+    #define kLog_BenchScale         1
+#else
+    #define log_bench_ticks()       ( (uint64_t) mico_get_time() )
+    #define kLog_BenchUnit          "ns"
+    #define kLog_BenchScale         1000000
+#endif
+
+#define kLog_BenchModule            "TEST"
+#define kLog_BenchFile              "log-bench.c"
+
+#if( MICO_LOG_DEFERRED )
+
+//===========================================================================================================================
+//  RTOS calls on the host
+//===========================================================================================================================
+
+#if( defined( LOG_BENCH_MAIN ) )
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+int                     mico_debug_enabled = 1;
+mico_mutex_t            stdio_tx_mutex;
+static uint32_t         gLog_BenchTime = 1234;
+
+uint32_t mico_get_time( void )
+{
+    return( gLog_BenchTime );
+}
+
+OSStatus mico_rtos_lock_mutex( mico_mutex_t *inMutex )
+{
+    (void) inMutex;
+    return( kNoErr );
+}
+
+OSStatus mico_rtos_unlock_mutex( mico_mutex_t *inMutex )
+{
+    (void) inMutex;
+    return( kNoErr );
+}
+
+OSStatus mico_rtos_create_thread( mico_thread_t *inThread, uint8_t inPriority, const char *inName,
+                                  mico_thread_function_t inFunction, uint32_t inStackSize, void *inArg )
+{
+    (void) inThread; (void) inPriority; (void) inName; (void) inFunction; (void) inStackSize; (void) inArg;
+    return( kUnsupportedErr );
+}
+
+void msleep( uint32_t inMs )
+{
+    struct timespec     ts = { inMs / 1000, ( inMs % 1000 ) * 1000000 };
+
+    nanosleep( &ts, NULL );
+}
+#else
+    #define gLog_BenchTime          mico_get_time()
+#endif
+
+//===========================================================================================================================
+//  Drain helpers
+//===========================================================================================================================
+
+typedef struct
+{
+    char        line[ 512 ];
+    int         len;
+    int         count;
+
+}   log_bench_capture_t;
+
+static void log_bench_capture( const char *inLine, int inLen, void *inArg )
+{
+    log_bench_capture_t * const     capture = (log_bench_capture_t *) inArg;
+
+    memcpy( capture->line, inLine, inLen + 1 );
+    capture->len = inLen;
+    capture->count++;
+}
+
+static void log_bench_discard( const char *inLine, int inLen, void *inArg )
+{
+    (void) inLine; (void) inLen;
+    if( inArg ) ++*( (int *) inArg );
+}
+
+// Drains one record, which must be printed exactly as custom_log printed it: the prefix and printf of the format.
+
+static OSStatus log_bench_expect( int inLine, const char *inFormat, ... )
+{
+    OSStatus                err;
+    log_bench_capture_t     capture;
+    char                    expected[ 512 ];
+    va_list                 args;
+    int                     n;
+
+    n = snprintf( expected, sizeof( expected ), "[%d][%s: %s:%4d] ", (int) gLog_BenchTime, kLog_BenchModule,
+                  kLog_BenchFile, inLine );
+    va_start( args, inFormat );
+    n += vsnprintf( &expected[ n ], sizeof( expected ) - n, inFormat, args );
+    va_end( args );
+    snprintf( &expected[ n ], sizeof( expected ) - n, "\r\n" );
+
+    capture.count = 0;
+    require_action( mico_log_drain( log_bench_capture, &capture, 1 ) == 1, exit, err = kNotFoundErr );
+    require_action( strcmp( capture.line, expected ) == 0 && capture.len == (int) strlen( expected ), exit,
+                    err = kMismatchErr; printf( "got      %sexpected %s", capture.line, expected ) );
+    err = kNoErr;
+
+exit:
+    return( err );
+}
+
+#define log_bench_check( ... )                                                                               \
+    do                                                                                                         \
+    {                                                                                                          \
+        mico_log_write( MICO_LOG_INFO, kLog_BenchModule, __FILE__, __LINE__, __VA_ARGS__ );                   \
+        err = log_bench_expect( __LINE__, __VA_ARGS__ );                                                       \
+        require_noerr( err, exit );                                                                            \
+                                                                                                               \
+    }   while( 0 )
+
+//===========================================================================================================================
+//  log_format_test
+//===========================================================================================================================
+
+static OSStatus log_format_test( void )
+{
+    OSStatus        err;
+    int             n = 0;
+
+    mico_log_drain( log_bench_discard, NULL, 0 );
+
+    log_bench_check( "no arguments" );
+    log_bench_check( "%d %i %u %x %X %o %c %%", -12345, 42, 4000000000u, 0xBEEF, 0xCAFE, 0755, 'Z' );
+    log_bench_check( "[%5d] [%-5d] [%05d] [%+d] [% d] [%#x] [%#o]", 42, 42, 42, 42, 42, 255, 8 );
+    log_bench_check( "%hhd %hhu %hd %hu", 300, 300, 70000, 70000 );
+    log_bench_check( "%ld %lu %lx", -1234567890L, 4234567890UL, 0x7FFFFFFFL );
+    log_bench_check( "%lld %llu %llx", -1234567890123LL, 18446744073709551615ULL, 0x123456789ABCDEFULL );
+    log_bench_check( "%zu %zd %jd %ju %td", (size_t) 123456, (size_t) 7, (intmax_t) -9876543210LL,
+                     (uintmax_t) 9876543210ULL, (ptrdiff_t) -77 );
+    log_bench_check( "%f %.3f %e %E %g %G %10.2f %-10.1f| %a", 3.14159, -2.71828, 12345.678, 0.000123, 1e-10, 1e20,
+                     99.999, 5.55, 1.0 );
+    log_bench_check( "%Lf %.2Le", (long double) 1.5, (long double) -123.456 );
+    log_bench_check( "%p %p", (void *) &n, (void *) NULL );
+    log_bench_check( "[%*d] [%-*d] [%.*f] [%*.*s] [%.*s]", 6, 42, 6, 42, 2, 3.14159, 8, 3, "abcdef", 2, "xyz" );
+    log_bench_check( "[%s] [%10s] [%-10s] [%.3s] [%s]", "hello", "right", "left", "truncated", "" );
+    log_bench_check( "%s %d %s", (char *) NULL, 7, "after null" );
+    log_bench_check( "%d%%%d%%%s", 1, 2, "end" );
+    log_bench_check( "long %s", "string within MICO_LOG_STRING_MAX" );
+
+    // Strings are cut at MICO_LOG_STRING_MAX, 48 bytes by default.
+
+    mico_log_write( MICO_LOG_INFO, kLog_BenchModule, __FILE__, __LINE__, "[%s]",
+                    "0123456789012345678901234567890123456789012345678901234567890123456789" );
+    err = log_bench_expect( __LINE__ - 2, "[%.48s]", "0123456789012345678901234567890123456789012345678901234567890123456789" );
+    require_noerr( err, exit );
+
+    // %n is skipped, never written.
+
+    mico_log_write( MICO_LOG_INFO, kLog_BenchModule, __FILE__, __LINE__, "a%nb %d", &n, 5 );
+    err = log_bench_expect( __LINE__ - 1, "ab %d", 5 );
+    require_noerr( err, exit );
+    require_action( n == 0, exit, err = kMismatchErr );
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  log_truncate_test
+//===========================================================================================================================
+
+static OSStatus log_truncate_test( void )
+{
+    static const char * const       kLong = "abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyz";
+    OSStatus                        err;
+    log_bench_capture_t             capture;
+    int                             i;
+
+    mico_log_drain( log_bench_discard, NULL, 0 );
+
+    // More arguments than a record holds: what fits is printed, followed by "...".
+
+    mico_log_write( MICO_LOG_INFO, kLog_BenchModule, __FILE__, __LINE__, "%s %s %s %s %d %d %d %d %d %d %d %d",
+                    kLong, kLong, kLong, kLong, 1, 2, 3, 4, 5, 6, 7, 8 );
+    capture.count = 0;
+    require_action( mico_log_drain( log_bench_capture, &capture, 0 ) == 1, exit, err = kNotFoundErr );
+    require_action( capture.len > 5 && strcmp( &capture.line[ capture.len - 5 ], "...\r\n" ) == 0, exit,
+                    err = kMismatchErr );
+    require_action( strstr( capture.line, "abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuv" ) != NULL, exit,
+                    err = kMismatchErr );
+
+    // A formatted line longer than MICO_LOG_LINE_MAX is cut, still ending with "\r\n".
+
+    mico_log_write( MICO_LOG_INFO, kLog_BenchModule, __FILE__, __LINE__, "%200d%200d", 1, 2 );
+    require_action( mico_log_drain( log_bench_capture, &capture, 0 ) == 1, exit, err = kNotFoundErr );
+    require_action( capture.len == 255 && capture.line[ 253 ] == '\r' && capture.line[ 254 ] == '\n', exit,
+                    err = kSizeErr );
+    for( i = 0; i < 253; ++i ) require_action( capture.line[ i ] != 0, exit, err = kMismatchErr );
+    err = kNoErr;
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  log_level_test
+//===========================================================================================================================
+
+static OSStatus log_level_test( void )
+{
+    OSStatus        err;
+    int             count, i, evaluated = 0;
+    char            name[ 8 ];
+
+    mico_log_drain( log_bench_discard, NULL, 0 );
+
+    err = mico_log_set_level( "WIFI", MICO_LOG_WARN );
+    require_noerr( err, exit );
+    mico_log_write( MICO_LOG_INFO, "WIFI", __FILE__, __LINE__, "filtered" );
+    mico_log_write( MICO_LOG_WARN, "WIFI", __FILE__, __LINE__, "kept" );
+    mico_log_write( MICO_LOG_TRACE, "HTTP", __FILE__, __LINE__, "kept" );
+    count = 0;
+    mico_log_drain( log_bench_discard, &count, 0 );
+    require_action( count == 2, exit, err = kMismatchErr );
+    require_action( mico_log_get_level( "WIFI" ) == MICO_LOG_WARN && mico_log_get_level( "HTTP" ) == MICO_LOG_TRACE,
+                    exit, err = kMismatchErr );
+
+    // The default level, then every module again.
+
+    err = mico_log_set_level( "*", MICO_LOG_ERR );
+    require_noerr( err, exit );
+    custom_log( kLog_BenchModule, "filtered" );
+    mico_log_write( MICO_LOG_ERR, "WIFI", __FILE__, __LINE__, "kept" );
+    count = 0;
+    mico_log_drain( log_bench_discard, &count, 0 );
+    require_action( count == 1 && mico_log_get_level( "WIFI" ) == MICO_LOG_ERR, exit, err = kMismatchErr );
+
+    for( i = 0; i < 8; ++i )
+    {
+        snprintf( name, sizeof( name ), "M%d", i );
+        err = mico_log_set_level( name, MICO_LOG_INFO );
+        require_noerr( err, exit );
+    }
+    require_action( mico_log_set_level( "M8", MICO_LOG_INFO ) == kNoResourcesErr, exit, err = kMismatchErr );
+    require_action( mico_log_set_level( "M7", MICO_LOG_WARN ) == kNoErr, exit, err = kMismatchErr );
+    require_action( mico_log_set_level( "M1", 6 ) == kParamErr, exit, err = kMismatchErr );
+    require_action( mico_log_set_level( "A_MODULE_NAME_TOO_LONG", 3 ) == kParamErr, exit, err = kMismatchErr );
+
+    err = mico_log_set_level( NULL, MICO_LOG_TRACE );
+    require_noerr( err, exit );
+    require_action( mico_log_get_level( "M7" ) == MICO_LOG_TRACE, exit, err = kMismatchErr );
+    mico_log_drain( log_bench_discard, NULL, 0 ); // The asserts of the levels refused
+
+    // Above MICO_LOG_STRIP_LEVEL the call is compiled out and its arguments are not evaluated.
+
+    custom_log_level( MICO_LOG_STRIP_LEVEL + 1, kLog_BenchModule, "%d", ++evaluated );
+    custom_log( kLog_BenchModule, "%d", ++evaluated );
+    count = 0;
+    mico_log_drain( log_bench_discard, &count, 0 );
+    require_action( evaluated == 1 && count == 1, exit, err = kMismatchErr );
+
+    // micodebug off
+
+    mico_debug_enabled = 0;
+    custom_log( kLog_BenchModule, "%d", ++evaluated );
+    mico_debug_enabled = 1;
+    require_action( mico_log_drain( log_bench_discard, NULL, 0 ) == 0 && evaluated == 1, exit, err = kMismatchErr );
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  log_ring_test
+//===========================================================================================================================
+
+typedef struct
+{
+    int         next[ 8 ];
+    int         count;
+    int         errors;
+
+}   log_bench_order_t;
+
+// Lines end with "<producer> <sequence>", the sequence of each producer must only go up.
+
+static void log_bench_order( const char *inLine, int inLen, void *inArg )
+{
+    log_bench_order_t * const       order = (log_bench_order_t *) inArg;
+    const char *                    p;
+    int                             producer, sequence;
+
+    (void) inLen;
+    if( strstr( inLine, "dropped" ) ) return;
+    p = strstr( inLine, "] " );
+    if( !p || sscanf( p + 2, "%*s %d %d", &producer, &sequence ) != 2 || producer < 0 || producer >= 8 ||
+        sequence < order->next[ producer ] )
+    {
+        order->errors++;
+        return;
+    }
+    order->next[ producer ] = sequence + 1;
+    order->count++;
+}
+
+static OSStatus log_ring_test( void )
+{
+    OSStatus                err;
+    log_bench_order_t       order;
+    mico_log_stats_t        before, after;
+    int                     i, count;
+
+    mico_log_drain( log_bench_discard, NULL, 0 );
+
+    // Fill the ring without draining: the records that do not fit are counted, then reported after the others.
+
+    mico_log_get_stats( &before );
+    for( i = 0; i < 1000; ++i )
+        mico_log_write( MICO_LOG_INFO, kLog_BenchModule, __FILE__, __LINE__, "fill %d %d %s", 0, i, "string" );
+    mico_log_get_stats( &after );
+    require_action( after.dropped > before.dropped && after.written > before.written, exit, err = kStateErr );
+    require_action( after.written - before.written + after.dropped - before.dropped == 1000, exit, err = kCountErr );
+    require_action( after.high_water <= after.size && after.used <= after.size, exit, err = kSizeErr );
+
+    memset( &order, 0, sizeof( order ) );
+    count = mico_log_drain( log_bench_order, &order, 0 );
+    require_action( count == (int)( after.written - before.written ) && order.count == count && order.errors == 0,
+                    exit, err = kCountErr );
+    mico_log_get_stats( &before );
+    require_action( before.used == 0, exit, err = kStateErr );
+
+    // Records of changing sizes, a few drained at a time, wrap around the ring many times.
+
+    memset( &order, 0, sizeof( order ) );
+    for( i = 0; i < 20000; ++i )
+    {
+        mico_log_write( MICO_LOG_INFO, kLog_BenchModule, __FILE__, __LINE__, "wrap %d %d %.*s", 1, i, i % 40,
+                        "0123456789012345678901234567890123456789" );
+        if( ( i % 4 ) == 3 ) mico_log_drain( log_bench_order, &order, 5 );
+    }
+    mico_log_drain( log_bench_order, &order, 0 );
+    require_action( order.count == 20000 && order.errors == 0 && order.next[ 1 ] == 20000, exit, err = kCountErr );
+    mico_log_get_stats( &after );
+    require_action( after.dropped == before.dropped && after.used == 0, exit, err = kCountErr );
+    err = kNoErr;
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  log_thread_test
+//===========================================================================================================================
+
+#if( defined( LOG_BENCH_MAIN ) )
+#define kLog_BenchProducers         4
+#define kLog_BenchRecords           200000
+
+static volatile int         gLog_BenchRunning;
+
+static void * log_bench_producer( void *inArg )
+{
+    int const       producer = (int)(intptr_t) inArg;
+    int             i;
+
+    for( i = 0; i < kLog_BenchRecords; ++i )
+    {
+        mico_log_write( MICO_LOG_INFO, kLog_BenchModule, __FILE__, __LINE__, "thread %d %d %s", producer, i,
+                        ( i & 1 ) ? "odd" : "even record" );
+        if( ( i & 15 ) == 15 ) sched_yield(); // Let the reader keep up, some records are still dropped
+    }
+    return( NULL );
+}
+
+static void * log_bench_consumer( void *inArg )
+{
+    while( gLog_BenchRunning ) mico_log_drain( log_bench_order, inArg, 0 );
+    mico_log_drain( log_bench_order, inArg, 0 );
+    return( NULL );
+}
+
+// Producers on every core against one reader, lines are checked for order and none is lost or printed twice.
+
+static OSStatus log_thread_test( void )
+{
+    OSStatus                err;
+    pthread_t               producers[ kLog_BenchProducers ], consumer;
+    log_bench_order_t       order;
+    mico_log_stats_t        before, after;
+    int                     i;
+
+    mico_log_drain( log_bench_discard, NULL, 0 );
+    mico_log_get_stats( &before );
+    memset( &order, 0, sizeof( order ) );
+
+    gLog_BenchRunning = 1;
+    pthread_create( &consumer, NULL, log_bench_consumer, &order );
+    for( i = 0; i < kLog_BenchProducers; ++i )
+        pthread_create( &producers[ i ], NULL, log_bench_producer, (void *)(intptr_t) i );
+    for( i = 0; i < kLog_BenchProducers; ++i ) pthread_join( producers[ i ], NULL );
+    gLog_BenchRunning = 0;
+    pthread_join( consumer, NULL );
+    mico_log_get_stats( &after );
+
+    printf( "%d threads x %d records: %u printed, %u dropped\n", kLog_BenchProducers, kLog_BenchRecords,
+            (unsigned int)( after.written - before.written ), (unsigned int)( after.dropped - before.dropped ) );
+    require_action( order.errors == 0, exit, err = kOrderErr );
+    require_action( order.count == (int)( after.written - before.written ), exit, err = kCountErr );
+    require_action( after.written - before.written + after.dropped - before.dropped ==
+                    kLog_BenchProducers * kLog_BenchRecords, exit, err = kCountErr );
+    require_action( after.used == 0, exit, err = kStateErr );
+    err = kNoErr;
+
+exit:
+    return( err );
+}
+#endif
+
+//===========================================================================================================================
+//  log_bench_report
+//===========================================================================================================================
+
+static void log_bench_report( const char *inMode, uint64_t inTicks, size_t inCount )
+{
+    printf( "%-40s %10.1f %s/call\n", inMode, ( (double) inTicks * kLog_BenchScale ) / (double) inCount, kLog_BenchUnit );
+}
+
+//===========================================================================================================================
+//  log_bench
+//===========================================================================================================================
+
+OSStatus    log_bench( int print )
+{
+    OSStatus            err;
+    char                line[ 256 ];
+    uint64_t            t;
+    size_t              i, loops, drained;
+    volatile int        sink = 0;
+
+    err = log_format_test();
+    require_noerr( err, exit );
+    err = log_truncate_test();
+    require_noerr( err, exit );
+    err = log_level_test();
+    require_noerr( err, exit );
+    err = log_ring_test();
+    require_noerr( err, exit );
+#if( defined( LOG_BENCH_MAIN ) )
+    err = log_thread_test();
+    require_noerr( err, exit );
+#endif
+    if( !print ) goto exit;
+
+    // A typical call, formatted in place as custom_log did (without the UART), or queued, or filtered out.
+    // Records are drained every 16 calls so the ring never fills.
+
+    loops = 200000;
+    t = log_bench_ticks();
+    for( i = 0; i < loops; ++i )
+    {
+        mico_rtos_lock_mutex( &stdio_tx_mutex );
+        sink += snprintf( line, sizeof( line ), "[%d][%s: %s:%4d] " "Connect to %s:%d, socket %d, retry %d" "\r\n",
+                          (int) mico_get_time(), kLog_BenchModule, SHORT_FILE, __LINE__, "192.168.1.100", 8080,
+                          (int) i, 3 );
+        mico_rtos_unlock_mutex( &stdio_tx_mutex );
+    }
+    log_bench_report( "custom_log formatted in place", log_bench_ticks() - t, loops );
+
+    mico_log_drain( log_bench_discard, NULL, 0 );
+    t = log_bench_ticks();
+    for( i = 0; i < loops; ++i )
+    {
+        custom_log( kLog_BenchModule, "Connect to %s:%d, socket %d, retry %d", "192.168.1.100", 8080, (int) i, 3 );
+        if( ( i & 15 ) == 15 )
+        {
+            // The reader's time is measured on its own below.
+            t = log_bench_ticks() - t;
+            mico_log_drain( log_bench_discard, NULL, 0 );
+            t = log_bench_ticks() - t;
+        }
+    }
+    log_bench_report( "custom_log queued", log_bench_ticks() - t, loops );
+
+    mico_log_set_level( kLog_BenchModule, MICO_LOG_WARN );
+    t = log_bench_ticks();
+    for( i = 0; i < loops; ++i )
+        custom_log( kLog_BenchModule, "Connect to %s:%d, socket %d, retry %d", "192.168.1.100", 8080, (int) i, 3 );
+    log_bench_report( "custom_log filtered by module level", log_bench_ticks() - t, loops );
+    mico_log_set_level( "*", MICO_LOG_TRACE );
+
+    t = log_bench_ticks();
+    for( i = 0; i < loops; ++i )
+        custom_log_level( MICO_LOG_STRIP_LEVEL + 1, kLog_BenchModule, "Connect to %s:%d", "192.168.1.100", (int) i );
+    log_bench_report( "custom_log_level above the strip level", log_bench_ticks() - t, loops );
+
+    drained = 0;
+    t = 0;
+    for( i = 0; i < loops; i += 16 )
+    {
+        uint64_t        start;
+        int             n;
+
+        for( n = 0; n < 16; ++n )
+            custom_log( kLog_BenchModule, "Connect to %s:%d, socket %d, retry %d", "192.168.1.100", 8080, (int) i, 3 );
+        start = log_bench_ticks();
+        drained += mico_log_drain( log_bench_discard, NULL, 0 );
+        t += log_bench_ticks() - start;
+    }
+    log_bench_report( "mico_log_drain, per record", t, drained );
+    (void) sink;
+
+exit:
+    printf( "%s: %s\n", __FUNCTION__, !err ? "PASSED" : "FAILED" );
+    return( err );
+}
+
+#if( defined( LOG_BENCH_MAIN ) )
+int main( void )
+{
+    return( log_bench( 1 ) ? 1 : 0 );
+}
+#endif
+
+#endif // MICO_LOG_DEFERRED
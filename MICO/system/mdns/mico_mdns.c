@@ -17,7 +17,7 @@
 *
 * <h2><center>&copy; COPYRIGHT 2014 MXCHIP Inc.</center></h2>
 ******************************************************************************
-*/ 
+*/
 
 #include "mico_mdns.h"
 #include "StringUtils.h"
@@ -34,6 +34,45 @@ typedef enum{
   RECORD_NORMAL,
 } mdns_record_state_t;
 
+/* Resource records of a service, in the order they are written to a response */
+typedef enum{
+  CACHED_SERVICE_ENUM,    // PTR _services._dns-sd._udp.local. -> service name
+  CACHED_PTR,             // PTR service name -> instance name
+  CACHED_TXT,             // TXT instance name
+  CACHED_SRV,             // SRV instance name -> port, host name
+  CACHED_A,               // A   host name -> IP address
+  CACHED_RECORD_COUNT,
+} mdns_cached_record_index_t;
+
+#define CACHED_RECORD_BIT(index)       (1 << (index))
+#define CACHED_SERVICE_DETAIL_BITS     ( CACHED_RECORD_BIT(CACHED_TXT) | CACHED_RECORD_BIT(CACHED_SRV) | CACHED_RECORD_BIT(CACHED_A) )
+
+/* Wire format of all records of a service, names are encoded but not compressed.
+   Offsets point into buffer, the cache is rebuilt after the record or the IP address is changed */
+typedef struct
+{
+  uint8_t*            buffer;
+  uint16_t            service_name;
+  uint16_t            instance_name;
+  uint16_t            hostname;
+  uint16_t            srv_rdata;
+  uint16_t            txt_rdata;
+  uint16_t            txt_rdata_len;
+  uint16_t            a_rdata;
+  bool                ip_available;
+} dns_sd_record_cache_t;
+
+/* A view of one cached resource record */
+typedef struct
+{
+  const uint8_t*      name;
+  uint16_t            record_type;
+  uint16_t            record_class;
+  const uint8_t*      rdata;        // rdata written as is
+  uint16_t            rdata_len;
+  const uint8_t*      rdata_name;   // Name following rdata that can be compressed, or NULL
+} dns_cached_record_t;
+
 typedef struct
 {
   char*               hostname;
@@ -46,8 +85,22 @@ typedef struct
   uint16_t            port;
   uint8_t             count_down;
   mdns_record_state_t state;
+  dns_sd_record_cache_t cache;
 } dns_sd_service_record_t;
 
+/* Response under construction, names already written are remembered for compression */
+typedef struct
+{
+  dns_message_iterator_t message;
+  uint16_t            answer_count;
+  uint8_t             name_count;
+  struct
+  {
+    const uint8_t*    name;
+    uint16_t          offset;
+  } names[ MDNS_COMPRESSION_NAME_COUNT ];
+} dns_response_t;
+
 #define APP_Available_Offset               0
 #define Support_TLV_Config_Offset          2
 
@@ -56,6 +109,9 @@ typedef struct
 
 
 #define SERVICE_QUERY_NAME             "_services._dns-sd._udp.local."
+#define SERVICE_QUERY_TTL              1500
+
+static const uint8_t service_query_name_encoded[] = "\x09_services\x07_dns-sd\x04_udp\x05local";
 
 //#define mdns_utils_log(M, ...) custom_log("mDNS Utils", M, ##__VA_ARGS__)
 //#define mdns_utils_log_trace() custom_log_trace("mDNS Utils")
@@ -67,21 +123,28 @@ typedef struct
 static dns_sd_service_record_t   available_services[ MAX_RECORD_COUNT ];
 static uint8_t	available_service_count = MAX_RECORD_COUNT;
 
+static dns_response_t response;
+
 static int dns_get_next_question( dns_message_iterator_t* iter, dns_question_t* q, dns_name_t* name );
-static int dns_compare_name_to_string( dns_name_t* name, const char* string );
-static int dns_create_message( dns_message_iterator_t* message, uint16_t size );
-static void dns_write_header( dns_message_iterator_t* iter, uint16_t id, uint16_t flags, uint16_t question_count, uint16_t answer_count, uint16_t authorative_count );
-static void dns_write_record( dns_message_iterator_t* iter, const char* name, uint16_t record_class, uint16_t record_type, uint32_t ttl, uint8_t* rdata );
-static void mdns_send_message(int fd, dns_message_iterator_t* message );
-static void dns_free_message( dns_message_iterator_t* message );
-static void mdns_process_query(int fd, dns_name_t* name, dns_question_t* question, dns_message_iterator_t* source );
-static void dns_write_record( dns_message_iterator_t* iter, const char* name, uint16_t record_class, uint16_t record_type, uint32_t ttl, uint8_t* rdata );
+static int dns_get_next_record( dns_message_iterator_t* iter, dns_record_t* r, dns_name_t* name );
+static int dns_compare_name_to_encoded( dns_name_t* name, const uint8_t* encoded, const uint8_t* end );
+static int dns_compare_encoded_names( const uint8_t* name1, const uint8_t* name2 );
+static uint16_t dns_encoded_name_length( const uint8_t* name );
+static int dns_compare_cached_records( dns_cached_record_t* record1, dns_cached_record_t* record2 );
 static void dns_write_uint16( dns_message_iterator_t* iter, uint16_t data );
 static void dns_write_uint32( dns_message_iterator_t* iter, uint32_t data );
-static void dns_write_bytes( dns_message_iterator_t* iter, uint8_t* data, uint16_t length );
+static void dns_write_bytes( dns_message_iterator_t* iter, const uint8_t* data, uint16_t length );
+static void dns_write_string( dns_message_iterator_t* iter, const char* src );
 static uint16_t dns_read_uint16( dns_message_iterator_t* iter );
+static uint32_t dns_read_uint32( dns_message_iterator_t* iter );
 static void dns_skip_name( dns_message_iterator_t* iter );
-static void dns_write_name( dns_message_iterator_t* iter, const char* src );
+static void mdns_response_begin( dns_response_t* resp, uint16_t id );
+static void mdns_response_add( int fd, dns_response_t* resp, dns_cached_record_t* record, uint32_t ttl );
+static void mdns_response_end( int fd, dns_response_t* resp );
+static void mdns_send_message(int fd, dns_message_iterator_t* message );
+static OSStatus mdns_build_record_cache( dns_sd_service_record_t* record );
+static void mdns_invalidate_record_cache( dns_sd_service_record_t* record );
+static void mdns_get_cached_record( dns_sd_service_record_t* record, int index, dns_cached_record_t* out );
 
 static OSStatus start_bonjour_service(void);
 
@@ -91,114 +154,130 @@ static int update_state_fd = 0;
 static mico_thread_t mfi_bonjour_thread_handler;
 static void _bonjour_thread(void *arg);
 
+static bool is_record_answerable( dns_sd_service_record_t *record )
+{
+  return ( record->state == RECORD_NORMAL || record->state == RECORD_UPDATE );
+}
+
+static uint32_t cached_record_ttl( dns_sd_service_record_t *record, int index )
+{
+  return ( index == CACHED_SERVICE_ENUM )? SERVICE_QUERY_TTL : record->ttl;
+}
+
 void process_dns_questions(int fd, dns_message_iterator_t* iter )
 {
   dns_name_t name;
   dns_question_t question;
-  dns_message_iterator_t response;
-  IPStatusTypedef para;
-  int a = 0;
-  int question_processed;
-  uint32_t myip;
-  
-  memset( &response, 0, sizeof(dns_message_iterator_t) );
-  
+  dns_record_t known_answer;
+  dns_cached_record_t cached, other;
+  uint8_t answers[ MAX_RECORD_COUNT ];
+  uint8_t details[ MAX_RECORD_COUNT ];
+  int a, b, c, r;
+
+  memset( answers, 0x0, sizeof(answers) );
+  memset( details, 0x0, sizeof(details) );
+
+  /* Collect records that answer any of the questions, so they are sent in one response */
   for ( a = 0; a < htons(iter->header->question_count); ++a )
   {
     if (iter->iter > iter->end)
       break;
     if(dns_get_next_question( iter, &question, &name )==0)
       break;
-    question_processed = 0;
-    switch ( question.question_type ){
-    case RR_TYPE_PTR:
-      if ( available_services != NULL ){
-        // Check if its a query for all available services  
-        if ( dns_compare_name_to_string( &name, SERVICE_QUERY_NAME ) ){
-          int b = 0;
-          if(dns_create_message( &response, 512 )) {
-            dns_write_header(&response, iter->header->id, 0x8400, 0, available_service_count, 0 );          
-            for ( b = 0; b < available_service_count; ++b ){
-              dns_write_record( &response, SERVICE_QUERY_NAME, RR_CLASS_IN, RR_TYPE_PTR, 1500, (uint8_t*) available_services[b].service_name );
-            }
-            mdns_send_message(fd, &response );
-            dns_free_message( &response );
-            question_processed = 1;
-          }
-        }
-        // else check if its one of our records
-        else {
-          int b = 0;
-          for ( b = 0; b < available_service_count; ++b ){
-            //printf("UDP multicast test: Recv a SERVICE Detail request: %s.\r\n", name);
-            if ( dns_compare_name_to_string( &name, available_services[b].service_name )){
-              
-              if( available_services[b].state != RECORD_NORMAL )
-                continue;
-
-              micoWlanGetIPStatus(&para, available_services[b].interface);
-              myip = htonl(inet_addr(para.ip));
-              if( myip == 0 || myip == 0xFFFFFFFF) continue;
-              
-              // Send the PTR, TXT, SRV and A records
-              if(dns_create_message( &response, 512 )){
-                dns_write_header( &response, iter->header->id, 0x8400, 0, 4, 0 );
-                //dns_write_record( &response, MFi_SERVICE_QUERY_NAME, RR_CLASS_IN, RR_TYPE_PTR, 1500, (u8*) available_services[b].service_name );
-                dns_write_record( &response, available_services[b].service_name, RR_CLASS_IN, RR_TYPE_PTR, available_services[b].ttl, (uint8_t*) available_services[b].instance_name );
-                dns_write_record( &response, available_services[b].instance_name, RR_CACHE_FLUSH|RR_CLASS_IN, RR_TYPE_TXT, available_services[b].ttl, (uint8_t*) available_services[b].txt_att );
-                dns_write_record( &response, available_services[b].instance_name, RR_CACHE_FLUSH|RR_CLASS_IN, RR_TYPE_SRV, available_services[b].ttl, (uint8_t*) &available_services[b]);
-                dns_write_record( &response, available_services[b].hostname, RR_CACHE_FLUSH|RR_CLASS_IN, RR_TYPE_A, available_services[b].ttl, (uint8_t*) &myip);
-                mdns_send_message(fd, &response );
-                dns_free_message( &response );
-                question_processed = 1;
-              }
-            }
-          }
-        }
+
+    for ( b = 0; b < available_service_count; ++b ){
+      if( is_record_answerable( &available_services[b] ) == false )
+        continue;
+      if( mdns_build_record_cache( &available_services[b] ) != kNoErr )
+        continue;
+
+      for ( r = 0; r < CACHED_RECORD_COUNT; ++r ){
+        mdns_get_cached_record( &available_services[b], r, &cached );
+        if( question.question_type != cached.record_type && question.question_type != RR_QTYPE_ANY )
+          continue;
+        if( dns_compare_name_to_encoded( &name, cached.name, iter->end ) == 0 )
+          continue;
+        answers[b] |= CACHED_RECORD_BIT(r);
+        // Send the TXT, SRV and A records with the service PTR record
+        if( r == CACHED_PTR )
+          details[b] |= CACHED_SERVICE_DETAIL_BITS;
+      }
+
+      /* Nothing is sent for a service without IP address except the service name */
+      if( available_services[b].cache.ip_available == false ){
+        answers[b] &= CACHED_RECORD_BIT(CACHED_SERVICE_ENUM);
+        details[b] = 0;
       }
-      break;
-    }
-    if (!question_processed ){
-      mdns_process_query(fd, &name, &question, iter);
     }
   }
-}
 
-static void mdns_process_query(int fd, dns_name_t* name, 
-                               dns_question_t* question, dns_message_iterator_t* source )
-{
-  dns_message_iterator_t response;
-  IPStatusTypedef para;
-  uint32_t myip;
-  int b = 0;
-  
-  memset( &response, 0, sizeof(dns_message_iterator_t) );
-  
-  switch ( question->question_type )
+  /* Known-answer suppression: skip records the querier already has with at least half of the TTL */
+  for ( a = 0; a < htons(iter->header->answer_count); ++a )
   {
-  case RR_QTYPE_ANY:
-  case RR_TYPE_A:
+    if(dns_get_next_record( iter, &known_answer, &name )==0)
+      break;
+
     for ( b = 0; b < available_service_count; ++b ){
-      if ( dns_compare_name_to_string( name, available_services[b].hostname ) ){				
-
-        micoWlanGetIPStatus(&para, available_services[b].interface);
-        myip = htonl(inet_addr(para.ip));
-        if( myip == 0 || myip == 0xFFFFFFFF) continue;
-
-        if(dns_create_message( &response, 256 )){
-          dns_write_header( &response, source->header->id, 0x8400, 0, 1, 0 );
-          dns_write_record( &response, available_services[b].hostname, RR_CLASS_IN | RR_CACHE_FLUSH, RR_TYPE_A, available_services[b].ttl, (uint8_t *)&myip);
-          mdns_send_message(fd, &response );
-          dns_free_message( &response );
-          return;
+      for ( r = 0; r < CACHED_RECORD_COUNT; ++r ){
+        if( ( ( answers[b] | details[b] ) & CACHED_RECORD_BIT(r) ) == 0 )
+          continue;
+        mdns_get_cached_record( &available_services[b], r, &cached );
+        if( known_answer.record_type != cached.record_type || known_answer.ttl < cached_record_ttl( &available_services[b], r ) / 2 )
+          continue;
+        if( known_answer.rd_length < cached.rdata_len || ( cached.rdata_len && memcmp( known_answer.rdata.iter, cached.rdata, cached.rdata_len ) ) )
+          continue;
+        if( cached.rdata_name ){
+          dns_name_t rdata_name;
+          rdata_name.start_of_name = known_answer.rdata.iter + cached.rdata_len;
+          rdata_name.start_of_packet = (uint8_t*) iter->header;
+          if( dns_compare_name_to_encoded( &rdata_name, cached.rdata_name, known_answer.rdata.end ) == 0 )
+            continue;
         }
+        else if( known_answer.rd_length != cached.rdata_len )
+          continue;
+        if( dns_compare_name_to_encoded( &name, cached.name, iter->end ) == 0 )
+          continue;
+        answers[b] &= ~CACHED_RECORD_BIT(r);
+        details[b] &= ~CACHED_RECORD_BIT(r);
       }
-    }    
-  default:
-   break;;
+    }
+  }
+
+  /* Service details are not needed if the querier already knows the service */
+  for ( b = 0; b < available_service_count; ++b ){
+    if( answers[b] & CACHED_RECORD_BIT(CACHED_PTR) )
+      answers[b] |= details[b];
   }
-}
 
+  /* Services on two interfaces or sharing a host name may have identical records, send them once */
+  for ( b = 0; b < available_service_count; ++b ){
+    for ( r = 0; r < CACHED_RECORD_COUNT; ++r ){
+      if( ( answers[b] & CACHED_RECORD_BIT(r) ) == 0 )
+        continue;
+      mdns_get_cached_record( &available_services[b], r, &cached );
+      for ( c = 0; c < b; ++c ){
+        if( answers[c] & CACHED_RECORD_BIT(r) ){
+          mdns_get_cached_record( &available_services[c], r, &other );
+          if( dns_compare_cached_records( &cached, &other ) ){
+            answers[b] &= ~CACHED_RECORD_BIT(r);
+            break;
+          }
+        }
+      }
+    }
+  }
+
+  mdns_response_begin( &response, iter->header->id );
+  for ( b = 0; b < available_service_count; ++b ){
+    for ( r = 0; r < CACHED_RECORD_COUNT; ++r ){
+      if( ( answers[b] & CACHED_RECORD_BIT(r) ) == 0 )
+        continue;
+      mdns_get_cached_record( &available_services[b], r, &cached );
+      mdns_response_add( fd, &response, &cached, cached_record_ttl( &available_services[b], r ) );
+    }
+  }
+  mdns_response_end( fd, &response );
+}
 
 static int dns_get_next_question( dns_message_iterator_t* iter, dns_question_t* q, dns_name_t* name )
 {
@@ -206,184 +285,242 @@ static int dns_get_next_question( dns_message_iterator_t* iter, dns_question_t*
   name->start_of_name   = (uint8_t*) iter->iter;
   name->start_of_packet = (uint8_t*) iter->header;
   dns_skip_name( iter );
-  if (iter->iter > iter->end)
+  if (iter->iter + 4 > iter->end)
     return 0;
-  
+
   // Read the type and class
   q->question_type  = dns_read_uint16( iter );
   q->question_class = dns_read_uint16( iter );
   return 1;
 }
 
-static int dns_compare_name_to_string( dns_name_t* name, const char* string )
+static int dns_get_next_record( dns_message_iterator_t* iter, dns_record_t* r, dns_name_t* name )
 {
-  uint8_t section_length;
-  int finished = 0;
-  int result   = 1;
-  uint8_t* buffer 	  = name->start_of_name;
-  char *temp;
-  
-  while ( !finished )
+  name->start_of_name   = (uint8_t*) iter->iter;
+  name->start_of_packet = (uint8_t*) iter->header;
+  dns_skip_name( iter );
+  if (iter->iter + 10 > iter->end)
+    return 0;
+
+  r->record_type  = dns_read_uint16( iter );
+  r->record_class = dns_read_uint16( iter );
+  r->ttl          = dns_read_uint32( iter );
+  r->rd_length    = dns_read_uint16( iter );
+  if (iter->iter + r->rd_length > iter->end)
+    return 0;
+
+  r->rdata.header = iter->header;
+  r->rdata.iter   = iter->iter;
+  r->rdata.end    = iter->iter + r->rd_length;
+  iter->iter     += r->rd_length;
+  return 1;
+}
+
+#define dns_tolower(c)  ( ( (c) >= 'A' && (c) <= 'Z' )? (c) + 'a' - 'A' : (c) )
+
+/* Compare a name in a received message, that may be compressed, to an encoded name */
+static int dns_compare_name_to_encoded( dns_name_t* name, const uint8_t* encoded, const uint8_t* end )
+{
+  uint8_t* buffer = name->start_of_name;
+  uint8_t  section_length;
+  int      jumps = 0;
+  int      i;
+
+  while ( 1 )
   {
     // Check if the name is compressed. If so, find the uncompressed version
-    while ( *buffer & 0xC0 )
-    {
-      uint16_t offset = ( *buffer++ ) << 8;
-      offset += *buffer;
-      offset &= 0x3FFF;
-      buffer = name->start_of_packet + offset;
-    }
-    
-    // Compare section
-    section_length = *( buffer++ );
-    temp = malloc(section_length+1);
-    temp[section_length] = 0;
-    memcpy(temp, buffer, section_length );
-    free(temp);
-    if ( strncmp( (char*) buffer, string, section_length ) )
+    while ( buffer < end && ( *buffer & 0xC0 ) == 0xC0 )
     {
-      result	 = 0;
-      finished = 1;
+      if ( buffer + 1 >= end || ++jumps > 16 )
+        return 0;
+      buffer = name->start_of_packet + ( ( ( buffer[0] & 0x3F ) << 8 ) | buffer[1] );
     }
-    string += section_length + 1;
-    buffer += section_length;
-    
-    // Check if we've finished comparing
-    if ( *buffer == 0 || *string == 0 )
+
+    if ( buffer >= end || *buffer != *encoded )
+      return 0;
+    if ( *encoded == 0 )
+      return 1;
+
+    // Compare section, names are case insensitive
+    section_length = *encoded;
+    if ( buffer + 1 + section_length > end )
+      return 0;
+    for ( i = 1; i <= section_length; i++ )
     {
-      finished = 1;
-      // Check if one of the strings has more data
-      if ( *buffer != 0 || *string != 0 )
-      {
-        result = 0;
-      }
+      if ( dns_tolower( buffer[i] ) != dns_tolower( encoded[i] ) )
+        return 0;
     }
+    buffer  += section_length + 1;
+    encoded += section_length + 1;
   }
-  
-  return result;
 }
 
-static int dns_create_message( dns_message_iterator_t* message, uint16_t size )
+static uint16_t dns_encoded_name_length( const uint8_t* name )
 {
-  message->header = (dns_message_header_t*) malloc( size );
-  if ( message->header == NULL )
-  {
-    return 0;
-  }
-  
-  message->iter = (uint8_t *) message->header + sizeof(dns_message_header_t);
-  return 1;
+  const uint8_t* src = name;
+
+  while ( *src != 0 )
+    src += *src + 1;
+  return (uint16_t)( src - name + 1 );
+}
+
+static int dns_compare_encoded_names( const uint8_t* name1, const uint8_t* name2 )
+{
+  uint16_t length = dns_encoded_name_length( name1 );
+
+  return ( length == dns_encoded_name_length( name2 ) && memcmp( name1, name2, length ) == 0 );
 }
 
-static void dns_free_message( dns_message_iterator_t* message )
+static int dns_compare_cached_records( dns_cached_record_t* record1, dns_cached_record_t* record2 )
 {
-  free(message->header);
-  message->header = NULL;
+  if ( record1->record_type != record2->record_type || record1->rdata_len != record2->rdata_len )
+    return 0;
+  if ( record1->rdata_len && memcmp( record1->rdata, record2->rdata, record1->rdata_len ) )
+    return 0;
+  if ( ( record1->rdata_name == NULL ) != ( record2->rdata_name == NULL ) )
+    return 0;
+  if ( record1->rdata_name && !dns_compare_encoded_names( record1->rdata_name, record2->rdata_name ) )
+    return 0;
+  return dns_compare_encoded_names( record1->name, record2->name );
 }
 
 static void dns_write_string( dns_message_iterator_t* iter, const char* src )
 {
   uint8_t* segment_length_pointer;
   uint8_t  segment_length;
-  
-  while ( *src != 0 && *src != 0xC0)
+
+  while ( *src != 0 )
   {
     /* Remember where we need to store the segment length and reset the counter*/
     segment_length_pointer = iter->iter++;
     segment_length = 0;
-    
+
     /* Copy bytes until '.' or end of string*/
-    while ( *src != '.' && *src != 0 && *src != 0xC0)
+    while ( *src != '.' && *src != 0 )
     {
       if (*src == '/')
         src++; // skip '/'
-      
+
       *iter->iter++ = *src++;
       ++segment_length;
     }
-    
+
     /* Store the length of the segment*/
     *segment_length_pointer = segment_length;
-    
+
     /* Check if we stopped because of a '.', if so, skip it*/
     if ( *src == '.' )
     {
       ++src;
     }
-    
-  }
-  
-  if (*src == 0xC0) { // compress name
-    *iter->iter++ = *src++;
-    *iter->iter++ = *src++;
-  } else {
-    /* Add the ending null */
-    *iter->iter++ = 0;
+
   }
+
+  /* Add the ending null */
+  *iter->iter++ = 0;
 }
 
+/* Write an encoded name, the longest suffix written before is replaced by a pointer */
+static void dns_write_compressed_name( dns_response_t* resp, const uint8_t* name )
+{
+  dns_message_iterator_t* iter = &resp->message;
+  uint16_t offset;
+  int i;
+
+  while ( *name != 0 )
+  {
+    for ( i = 0; i < resp->name_count; i++ )
+    {
+      if ( dns_compare_encoded_names( resp->names[i].name, name ) )
+      {
+        dns_write_uint16( iter, 0xC000 | resp->names[i].offset );
+        return;
+      }
+    }
+
+    offset = (uint16_t)( iter->iter - (uint8_t*) iter->header );
+    if ( resp->name_count < MDNS_COMPRESSION_NAME_COUNT && offset < 0x3FFF )
+    {
+      resp->names[resp->name_count].name = name;
+      resp->names[resp->name_count].offset = offset;
+      resp->name_count++;
+    }
+
+    dns_write_bytes( iter, name, *name + 1 );
+    name += *name + 1;
+  }
+
+  *iter->iter++ = 0;
+}
 
-static void dns_write_header( dns_message_iterator_t* iter, uint16_t id, uint16_t flags, uint16_t question_count, uint16_t answer_count, uint16_t authorative_count )
+static void mdns_response_begin( dns_response_t* resp, uint16_t id )
 {
-  memset( iter->header, 0, sizeof(dns_message_header_t) );
-  iter->header->id				= htons(id);
-  iter->header->flags 			= htons(flags);
-  iter->header->question_count	= htons(question_count);
-  iter->header->name_server_count = htons(authorative_count);
-  iter->header->answer_count		= htons(answer_count);
+  dns_message_header_t* header = resp->message.header;
+
+  memset( header, 0, sizeof(dns_message_header_t) );
+  header->id    = id;
+  header->flags = htons(0x8400);
+  resp->message.iter = (uint8_t *) header + sizeof(dns_message_header_t);
+  resp->message.end  = (uint8_t *) header + MDNS_MESSAGE_SIZE;
+  resp->answer_count = 0;
+  resp->name_count   = 0;
 }
 
+static void mdns_response_end( int fd, dns_response_t* resp )
+{
+  if ( resp->answer_count == 0 )
+    return;
+
+  resp->message.header->answer_count = htons(resp->answer_count);
+  mdns_send_message( fd, &resp->message );
+  mdns_response_begin( resp, resp->message.header->id );
+}
 
-static void dns_write_record( dns_message_iterator_t* iter, const char* name, uint16_t record_class, uint16_t record_type, uint32_t ttl, uint8_t* rdata )
+/* Append a record to the response, a full response is sent first to make room */
+static void mdns_response_add( int fd, dns_response_t* resp, dns_cached_record_t* record, uint32_t ttl )
 {
+  dns_message_iterator_t* iter = &resp->message;
   uint8_t* rd_length;
   uint8_t* temp_ptr;
-  
+  uint16_t max_len;
+
+  max_len = dns_encoded_name_length( record->name ) + 10 + record->rdata_len;
+  if ( record->rdata_name )
+    max_len += dns_encoded_name_length( record->rdata_name );
+
+  if ( iter->iter + max_len > iter->end )
+  {
+    mdns_response_end( fd, resp );
+    if ( iter->iter + max_len > iter->end )
+      return;
+  }
+
   /* Write the name, type, class, TTL*/
-  dns_write_name	( iter, name );
-  dns_write_uint16( iter, record_type );
-  dns_write_uint16( iter, record_class );
+  dns_write_compressed_name( resp, record->name );
+  dns_write_uint16( iter, record->record_type );
+  dns_write_uint16( iter, record->record_class );
   dns_write_uint32( iter, ttl );
-  
+
   /* Keep track of where we store the rdata length*/
-  rd_length	= iter->iter;
+  rd_length = iter->iter;
   iter->iter += 2;
-  temp_ptr	= iter->iter;
-  
-  switch ( record_type )
-  {
-  case RR_TYPE_A:
-    dns_write_bytes( iter, rdata, 4 );
-    break;
-    
-  case RR_TYPE_PTR:
-  case RR_TYPE_TXT:
-    dns_write_name( iter, (const char*) rdata );
-    break;
-    
-  case RR_TYPE_SRV:
-    /* Set priority and weight to 0*/
-    dns_write_uint16( iter, 0 );
-    dns_write_uint16( iter, 0 );
-    
-    /* Write the port*/
-    dns_write_uint16( iter, ( (dns_sd_service_record_t*) rdata )->port );
-    
-    /* Write the hostname*/
-    dns_write_string( iter, ( (dns_sd_service_record_t*) rdata )->hostname );
-    break;
-  default:
-    break;
-  }
+  temp_ptr = iter->iter;
+
+  if ( record->rdata_len )
+    dns_write_bytes( iter, record->rdata, record->rdata_len );
+  if ( record->rdata_name )
+    dns_write_compressed_name( resp, record->rdata_name );
+
   // Write the rdata length
   rd_length[0] = ( iter->iter - temp_ptr ) >> 8;
   rd_length[1] = ( iter->iter - temp_ptr ) & 0xFF;
+  resp->answer_count++;
 }
 
 static void mdns_send_message(int fd, dns_message_iterator_t* message )
 {
   struct sockaddr_t addr;
-  
+
   addr.s_ip = inet_addr("224.0.0.251");
   addr.s_port = 5353;
   sendto(fd, message->header, message->iter - (uint8_t*)message->header, 0, &addr, sizeof(addr));
@@ -392,6 +529,118 @@ static void mdns_send_message(int fd, dns_message_iterator_t* message )
   sendto(fd, message->header, message->iter - (uint8_t*)message->header, 0, &addr, sizeof(addr));
 }
 
+static OSStatus mdns_build_record_cache( dns_sd_service_record_t* record )
+{
+  OSStatus err = kNoErr;
+  dns_sd_record_cache_t* cache = &record->cache;
+  dns_message_iterator_t iter;
+  IPStatusTypedef para;
+  uint32_t myip;
+  size_t size;
+
+  if ( cache->buffer )
+    return kNoErr;
+
+  micoWlanGetIPStatus(&para, record->interface);
+  myip = htonl(inet_addr(para.ip));
+  cache->ip_available = ( myip != 0 && myip != 0xFFFFFFFF );
+
+  /* Every string is encoded to at most its length + 2 bytes */
+  size = 2 * strlen( record->service_name ) + strlen( record->instance_name ) + strlen( record->hostname ) + strlen( record->txt_att ) + 10 + 6 + 4;
+  cache->buffer = malloc( size );
+  require_action( cache->buffer, exit, err = kNoMemoryErr );
+
+  iter.header = (dns_message_header_t*) cache->buffer;
+  iter.iter   = cache->buffer;
+
+  // Instance name is followed by the service name: "instance._service._tcp.local."
+  cache->instance_name = iter.iter - cache->buffer;
+  dns_write_string( &iter, record->instance_name );
+  iter.iter--;
+  cache->service_name = iter.iter - cache->buffer;
+  dns_write_string( &iter, record->service_name );
+
+  cache->hostname = iter.iter - cache->buffer;
+  dns_write_string( &iter, record->hostname );
+
+  /* SRV: priority and weight are 0, followed by the port */
+  cache->srv_rdata = iter.iter - cache->buffer;
+  dns_write_uint16( &iter, 0 );
+  dns_write_uint16( &iter, 0 );
+  dns_write_uint16( &iter, record->port );
+
+  cache->txt_rdata = iter.iter - cache->buffer;
+  dns_write_string( &iter, record->txt_att );
+  cache->txt_rdata_len = iter.iter - cache->buffer - cache->txt_rdata;
+
+  cache->a_rdata = iter.iter - cache->buffer;
+  dns_write_bytes( &iter, (uint8_t*) &myip, 4 );
+
+exit:
+  return err;
+}
+
+static void mdns_invalidate_record_cache( dns_sd_service_record_t* record )
+{
+  if ( record->cache.buffer )
+  {
+    free( record->cache.buffer );
+    record->cache.buffer = NULL;
+  }
+}
+
+static void mdns_get_cached_record( dns_sd_service_record_t* record, int index, dns_cached_record_t* out )
+{
+  dns_sd_record_cache_t* cache = &record->cache;
+
+  out->rdata_name = NULL;
+  out->rdata_len  = 0;
+  out->rdata      = NULL;
+
+  switch ( index )
+  {
+  case CACHED_SERVICE_ENUM:
+    out->name         = service_query_name_encoded;
+    out->record_type  = RR_TYPE_PTR;
+    out->record_class = RR_CLASS_IN;
+    out->rdata_name   = cache->buffer + cache->service_name;
+    break;
+
+  case CACHED_PTR:
+    out->name         = cache->buffer + cache->service_name;
+    out->record_type  = RR_TYPE_PTR;
+    out->record_class = RR_CLASS_IN;
+    out->rdata_name   = cache->buffer + cache->instance_name;
+    break;
+
+  case CACHED_TXT:
+    out->name         = cache->buffer + cache->instance_name;
+    out->record_type  = RR_TYPE_TXT;
+    out->record_class = RR_CACHE_FLUSH|RR_CLASS_IN;
+    out->rdata        = cache->buffer + cache->txt_rdata;
+    out->rdata_len    = cache->txt_rdata_len;
+    break;
+
+  case CACHED_SRV:
+    out->name         = cache->buffer + cache->instance_name;
+    out->record_type  = RR_TYPE_SRV;
+    out->record_class = RR_CACHE_FLUSH|RR_CLASS_IN;
+    out->rdata        = cache->buffer + cache->srv_rdata;
+    out->rdata_len    = 6;
+    out->rdata_name   = cache->buffer + cache->hostname;
+    break;
+
+  case CACHED_A:
+  default:
+    out->name         = cache->buffer + cache->hostname;
+    out->record_type  = RR_TYPE_A;
+    out->record_class = RR_CACHE_FLUSH|RR_CLASS_IN;
+    out->rdata        = cache->buffer + cache->a_rdata;
+    out->rdata_len    = 4;
+    break;
+  }
+}
+
 static void dns_write_uint16( dns_message_iterator_t* iter, uint16_t data )
 {
   // We cannot assume the u8 alignment of iter->iter so we can't just typecast and assign
@@ -409,10 +658,10 @@ static void dns_write_uint32( dns_message_iterator_t* iter, uint32_t data )
   iter->iter += 4;
 }
 
-static void dns_write_bytes( dns_message_iterator_t* iter, uint8_t* data, uint16_t length )
+static void dns_write_bytes( dns_message_iterator_t* iter, const uint8_t* data, uint16_t length )
 {
   int a = 0;
-  
+
   for ( a = 0; a < length; ++a )
   {
     iter->iter[a] = data[a];
@@ -427,9 +676,16 @@ static uint16_t dns_read_uint16( dns_message_iterator_t* iter )
   return temp;
 }
 
+static uint32_t dns_read_uint32( dns_message_iterator_t* iter )
+{
+  uint32_t temp = (uint32_t) dns_read_uint16( iter ) << 16;
+  temp += (uint32_t) dns_read_uint16( iter );
+  return temp;
+}
+
 static void dns_skip_name( dns_message_iterator_t* iter )
 {
-  while ( *iter->iter != 0 )
+  while ( iter->iter < iter->end && *iter->iter != 0 )
   {
     // Check if the name is compressed
     if ( *iter->iter & 0xC0 )
@@ -448,11 +704,6 @@ static void dns_skip_name( dns_message_iterator_t* iter )
   ++iter->iter;
 }
 
-static void dns_write_name( dns_message_iterator_t* iter, const char* src )
-{
-  dns_write_string( iter, src );
-}
-
 static bool is_service_match ( dns_sd_service_record_t *record, char *service_name, WiFi_Interface interface )
 {
   if( record->state == RECORD_REMOVED || record->state == RECORD_REMOVE )
@@ -540,13 +791,13 @@ static void _clean_record_resource( dns_sd_service_record_t *record )
     free(record->txt_att);
     record->txt_att = NULL;
   }
+  mdns_invalidate_record_cache( record );
 
 }
 
 
 OSStatus mdns_add_record( mdns_init_t init, WiFi_Interface interface, uint32_t time_to_live )
 {
-  int len;
   OSStatus err = kNoErr;
   uint32_t insert_index = 0xFF;
 
@@ -569,12 +820,7 @@ OSStatus mdns_add_record( mdns_init_t init, WiFi_Interface interface, uint32_t t
   available_services[insert_index].service_name = (char*)__strdup(init.service_name);
   available_services[insert_index].hostname = (char*)__strdup(init.host_name);
 
-  len = strlen(init.instance_name);
-  available_services[insert_index].instance_name = (char*)malloc(len+3);//// 0xc00c+\0
-  memcpy(available_services[insert_index].instance_name, init.instance_name, len);
-  available_services[insert_index].instance_name[len]= 0xc0;
-  available_services[insert_index].instance_name[len+1]= 0x0c;
-  available_services[insert_index].instance_name[len+2]= 0;
+  available_services[insert_index].instance_name = (char*)__strdup(init.instance_name);
   
   available_services[insert_index].txt_att = (char*)__strdup(init.txt_record);
 
@@ -604,8 +850,9 @@ void mdns_update_txt_record( char *service_name, WiFi_Interface interface, char
 
   mico_rtos_lock_mutex( &bonjour_mutex );
 
-  if(available_services[insert_index].txt_att)  free(available_services->txt_att);
+  if(available_services[insert_index].txt_att)  free(available_services[insert_index].txt_att);
   available_services[insert_index].txt_att = (char*)__strdup(txt_record);
+  mdns_invalidate_record_cache( &available_services[insert_index] );
   available_services[insert_index].state = RECORD_UPDATE;
   available_services[insert_index].count_down = 5;
 
@@ -640,6 +887,7 @@ void mdns_suspend_record( char *service_name, WiFi_Interface interface, bool wil
     }
   
     available_services[i].count_down = 5; 
+    mdns_invalidate_record_cache( &available_services[i] );
     insert_index = i;
   }
 
@@ -666,6 +914,7 @@ void mdns_resume_record( char *service_name, WiFi_Interface interface )
   for ( i = 0; i < available_service_count && is_service_match( &available_services[i], service_name, interface ); i++ ){
     available_services[i].state = RECORD_UPDATE;
     available_services[i].count_down = 5; 
+    mdns_invalidate_record_cache( &available_services[i] );
     insert_index = i;
   }
 
@@ -683,6 +932,9 @@ exit:
 void mdns_handler(int fd, uint8_t* pkt, int pkt_len)
 {
   dns_message_iterator_t iter;
+
+  if( pkt_len < (int)sizeof(dns_message_header_t) )
+    return;
   
   iter.header = (dns_message_header_t*) pkt;
   iter.iter   = (uint8_t*) iter.header + sizeof(dns_message_header_t);
@@ -700,38 +952,32 @@ void mdns_handler(int fd, uint8_t* pkt, int pkt_len)
 
 void bonjour_send_record(int record_index)
 {
-  dns_message_iterator_t response;
-  uint32_t myip;
-  IPStatusTypedef para;
-  int ttl  = 0;
+  dns_sd_service_record_t *record = &available_services[record_index];
+  dns_cached_record_t cached;
+  uint32_t ttl = 0;
+  int r;
+
+  if( mdns_build_record_cache( record ) != kNoErr )
+    return;
+
+  mdns_response_begin( &response, 0x0 );
 
   /* Send service and a ttl > 0 for a working record*/
-  if( available_services[record_index].state == RECORD_NORMAL || available_services[record_index].state == RECORD_UPDATE ){
-    ttl = available_services[record_index].ttl;
-    
-    if(dns_create_message( &response, 512 )) {
-      dns_write_header(&response, 0x0, 0x8400, 0, available_service_count, 0 );          
-      dns_write_record( &response, SERVICE_QUERY_NAME, RR_CLASS_IN, RR_TYPE_PTR, 1500, (uint8_t*) available_services[record_index].service_name );
-      mdns_send_message(mDNS_fd, &response );
-      dns_free_message( &response );
-    }
+  if( record->state == RECORD_NORMAL || record->state == RECORD_UPDATE ){
+    ttl = record->ttl;
+    mdns_get_cached_record( record, CACHED_SERVICE_ENUM, &cached );
+    mdns_response_add( mDNS_fd, &response, &cached, SERVICE_QUERY_TTL );
   }
-  micoWlanGetIPStatus(&para, available_services[record_index].interface);
-  myip = htonl(inet_addr(para.ip));
-  if( myip == 0 || myip == 0xFFFFFFFF) return;
 
-
-  if(dns_create_message( &response, 512 )){
+  if( record->cache.ip_available == true ){
     mdns_utils_log( "TTL = %d",  ttl);
-    micoWlanGetIPStatus(&para, available_services[record_index].interface);
-    dns_write_header( &response, 0x0, 0x8400, 0, 4, 0 );
-    dns_write_record( &response, available_services[record_index].service_name, RR_CLASS_IN, RR_TYPE_PTR, ttl, (uint8_t*) available_services[record_index].instance_name );
-    dns_write_record( &response, available_services[record_index].instance_name, RR_CACHE_FLUSH|RR_CLASS_IN, RR_TYPE_TXT, ttl, (uint8_t*) available_services[record_index].txt_att );
-    dns_write_record( &response, available_services[record_index].instance_name, RR_CACHE_FLUSH|RR_CLASS_IN, RR_TYPE_SRV, ttl, (uint8_t*) &available_services[record_index]);
-    dns_write_record( &response, available_services[record_index].hostname, RR_CACHE_FLUSH|RR_CLASS_IN, RR_TYPE_A, ttl, (uint8_t*) &myip);
-    mdns_send_message(mDNS_fd, &response );
-    dns_free_message( &response );
+    for ( r = CACHED_PTR; r < CACHED_RECORD_COUNT; r++ ){
+      mdns_get_cached_record( record, r, &cached );
+      mdns_response_add( mDNS_fd, &response, &cached, ttl );
+    }
   }
+
+  mdns_response_end( mDNS_fd, &response );
 }
 
 void BonjourNotify_WifiStatusHandler( WiFiEvent event, void *arg )
@@ -756,6 +1002,21 @@ void BonjourNotify_WifiStatusHandler( WiFiEvent event, void *arg )
   return;
 }
 
+void BonjourNotify_DHCPCompleteHandler( IPStatusTypedef *pnet, void *arg )
+{
+  int i;
+  UNUSED_PARAMETER(pnet);
+  UNUSED_PARAMETER(arg);
+
+  /* The A records are rebuilt with the new address */
+  mico_rtos_lock_mutex( &bonjour_mutex );
+  for ( i = 0; i < available_service_count; i++ ){
+    if( available_services[i].interface == Station )
+      mdns_invalidate_record_cache( &available_services[i] );
+  }
+  mico_rtos_unlock_mutex( &bonjour_mutex );
+}
+
 void BonjourNotify_SYSWillPoerOffHandler( void *arg )
 {
     UNUSED_PARAMETER(arg);  
@@ -784,6 +1045,9 @@ static OSStatus start_bonjour_service(void)
   
   buf = malloc(1500);
   require_action(buf, exit, err =kNoMemoryErr);
+
+  response.message.header = (dns_message_header_t*) malloc( MDNS_MESSAGE_SIZE );
+  require_action(response.message.header, exit, err =kNoMemoryErr);
   
   mDNS_fd = socket(AF_INET, SOCK_DGRM, IPPROTO_UDP);
   require_action(IsValidSocket( mDNS_fd ), exit, err = kNoResourcesErr );
@@ -796,6 +1060,8 @@ static OSStatus start_bonjour_service(void)
 
   err = mico_system_notify_register( mico_notify_WIFI_STATUS_CHANGED, (void *)BonjourNotify_WifiStatusHandler, NULL );
   require_noerr( err, exit );
+  err = mico_system_notify_register( mico_notify_DHCP_COMPLETED, (void *)BonjourNotify_DHCPCompleteHandler, NULL );
+  require_noerr( err, exit );
   err = mico_system_notify_register( mico_notify_SYS_WILL_POWER_OFF, (void *)BonjourNotify_SYSWillPoerOffHandler, NULL );
   require_noerr( err, exit );
 
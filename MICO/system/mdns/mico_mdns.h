@@ -32,6 +32,11 @@
  **************************************************************************************************************/
 #define MAX_RECORD_COUNT 4
 
+/* Size of a mDNS response, records that do not fit are sent in another response */
+#define MDNS_MESSAGE_SIZE               512
+/* Names remembered for compression while a response is written */
+#define MDNS_COMPRESSION_NAME_COUNT     16
+
 
 #define DNS_MESSAGE_IS_A_RESPONSE           0x8000
 #define DNS_MESSAGE_OPCODE                  0x7800
@@ -84,6 +84,18 @@ OSStatus mico_system_init( mico_Context_t* in_context )
 
   require_action( in_context, exit, err = kNotPreparedErr );
 
+#ifdef MICO_PROFILER_ENABLE
+  /* Count the CPU time and the context switches of each thread */
+  err = mico_profiler_start( );
+  require_noerr( err, exit );
+#endif
+
+#if DEBUG && MICO_LOG_DEFERRED && !defined(MICO_DISABLE_STDIO)
+  /* Print the logs queued by custom_log */
+  err = mico_log_start( );
+  require_noerr( err, exit );
+#endif
+
   /* Initialize power management daemen */
   err = mico_system_power_daemon_start( in_context );
   require_noerr( err, exit ); 
@@ -0,0 +1,589 @@
+/**
+******************************************************************************
+* @file    mico_system_kv.c
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   This file provide a log-structured key/value store on the two
+*          parameter partitions, used to save configuration data without
+*          erasing flash on every update.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+/* Page layout, one page per partition:
+ *
+ *   0x00              preamble, MICO_KV_PREAMBLE_SIZE bytes. On the first page
+ *                     this is the boot table read by the bootloader, it is
+ *                     never part of the log.
+ *   KV_HEADER_OFFSET  page header: magic, sequence and crc. Written last when a
+ *                     page is compacted, a page is valid only after that.
+ *   KV_LOG_OFFSET     records: key, length, transaction id, crc, data, padded
+ *                     to 4 bytes. A write appends the changed records followed
+ *                     by a commit record carrying the same transaction id, only
+ *                     committed records are loaded into the RAM index.
+ *
+ * New records are appended to the valid page with the highest sequence. When
+ * it is full, the live records are merged with the new ones into the other
+ * page, which is the only time a sector is erased. The old page is left intact
+ * until the next compaction, so a power failure at any point leaves either the
+ * old or the new state readable.
+ */
+
+#include <stddef.h>
+
+#include "Common.h"
+#include "Debug.h"
+#include "mico_rtos.h"
+#include "system.h"
+#include "CheckSumUtils.h"
+
+//#define kv_log(M, ...) custom_log("MiCO KV", M, ##__VA_ARGS__)
+
+#define kv_log(M, ...)
+
+#define KV_MAGIC_NUMBER     (0x3156534B) /* "KSV1" */
+#define KV_HEADER_OFFSET    ( MICO_KV_PREAMBLE_SIZE )
+#define KV_LOG_OFFSET       ( KV_HEADER_OFFSET + sizeof( kv_page_header_t ) )
+#define KV_RECORD_SIZE(len) ( ( sizeof( kv_record_header_t ) + (len) + 3 ) & ~0x3UL )
+#define KV_COPY_BUFFER_SIZE ( 32 )
+
+typedef struct {
+  uint32_t magic;
+  uint32_t sequence;
+  uint16_t crc;
+  uint16_t reserved;
+} kv_page_header_t;
+
+typedef struct {
+  uint16_t key;
+  uint16_t length;
+  uint16_t txn;
+  uint16_t crc;
+} kv_record_header_t;
+
+typedef struct {
+  uint16_t key;
+  uint16_t length;
+  uint32_t offset;
+} kv_index_t;
+
+typedef struct {
+  mico_partition_t  partition[2];
+  uint32_t          page_size;
+  int               active;       /* -1: no valid page */
+  uint32_t          sequence;
+  uint32_t          write_offset;
+  uint16_t          txn;
+  uint32_t          index_count;
+  kv_index_t        index[MICO_KV_MAX_KEYS];
+  uint8_t           preamble[MICO_KV_PREAMBLE_SIZE];
+  mico_mutex_t      mutex;
+} kv_store_t;
+
+static kv_store_t kv;
+
+/* Scratch index, pending records while scanning and the new index while compacting */
+static kv_index_t kv_scratch[MICO_KV_MAX_KEYS];
+static uint16_t   kv_scratch_txn[MICO_KV_MAX_KEYS];
+
+static uint16_t kv_page_header_crc( const kv_page_header_t *header )
+{
+  CRC16_Context crc_context;
+  uint16_t crc;
+
+  CRC16_Init( &crc_context );
+  CRC16_Update( &crc_context, header, offsetof( kv_page_header_t, crc ) );
+  CRC16_Final( &crc_context, &crc );
+  return crc;
+}
+
+static kv_index_t *kv_index_find( uint16_t key )
+{
+  uint32_t i;
+
+  for( i = 0; i < kv.index_count; i++ ){
+    if( kv.index[i].key == key )
+      return &kv.index[i];
+  }
+  return NULL;
+}
+
+static bool kv_item_find( const mico_kv_item_t *items, uint32_t count, uint16_t key )
+{
+  uint32_t i;
+
+  for( i = 0; i < count; i++ ){
+    if( items[i].key == key )
+      return true;
+  }
+  return false;
+}
+
+static OSStatus kv_read( int page, uint32_t offset, void *data, uint32_t length )
+{
+  return MicoFlashRead( kv.partition[page], &offset, (uint8_t *)data, length );
+}
+
+static OSStatus kv_write( int page, uint32_t offset, const void *data, uint32_t length )
+{
+  return MicoFlashWrite( kv.partition[page], &offset, (uint8_t *)data, length );
+}
+
+/* Check the crc of a record whose header has been read, data is read from flash */
+static bool kv_record_is_valid( int page, uint32_t offset, const kv_record_header_t *header )
+{
+  CRC16_Context crc_context;
+  uint8_t buffer[KV_COPY_BUFFER_SIZE];
+  uint32_t data_offset = offset + sizeof( kv_record_header_t );
+  uint32_t left = header->length;
+  uint32_t length;
+  uint16_t crc;
+
+  CRC16_Init( &crc_context );
+  CRC16_Update( &crc_context, header, offsetof( kv_record_header_t, crc ) );
+  while( left ){
+    length = Min( left, sizeof( buffer ) );
+    if( kv_read( page, data_offset, buffer, length ) != kNoErr )
+      return false;
+    CRC16_Update( &crc_context, buffer, length );
+    data_offset += length;
+    left -= length;
+  }
+  CRC16_Final( &crc_context, &crc );
+  return ( crc == header->crc );
+}
+
+static OSStatus kv_append( int page, uint32_t *offset, uint16_t key, uint16_t txn, const void *data, uint16_t length )
+{
+  OSStatus err = kNoErr;
+  CRC16_Context crc_context;
+  kv_record_header_t header;
+
+  header.key = key;
+  header.length = length;
+  header.txn = txn;
+
+  CRC16_Init( &crc_context );
+  CRC16_Update( &crc_context, &header, offsetof( kv_record_header_t, crc ) );
+  CRC16_Update( &crc_context, data, length );
+  CRC16_Final( &crc_context, &header.crc );
+
+  /* Header goes first: an erased header always marks the end of the log */
+  err = kv_write( page, *offset, &header, sizeof( header ) );
+  require_noerr( err, exit );
+  if( length ){
+    err = kv_write( page, *offset + sizeof( header ), data, length );
+    require_noerr( err, exit );
+  }
+  *offset += KV_RECORD_SIZE( length );
+
+exit:
+  return err;
+}
+
+/* Copy a committed record into the page being compacted. That page is not valid
+   before its header is written, so the record header can go last here. */
+static OSStatus kv_copy( int page, uint32_t *offset, const kv_index_t *entry, uint16_t txn )
+{
+  OSStatus err = kNoErr;
+  CRC16_Context crc_context;
+  kv_record_header_t header;
+  uint8_t buffer[KV_COPY_BUFFER_SIZE];
+  uint32_t src = entry->offset + sizeof( kv_record_header_t );
+  uint32_t dst = *offset + sizeof( kv_record_header_t );
+  uint32_t left = entry->length;
+  uint32_t length;
+
+  header.key = entry->key;
+  header.length = entry->length;
+  header.txn = txn;
+
+  CRC16_Init( &crc_context );
+  CRC16_Update( &crc_context, &header, offsetof( kv_record_header_t, crc ) );
+  while( left ){
+    length = Min( left, sizeof( buffer ) );
+    err = kv_read( kv.active, src, buffer, length );
+    require_noerr( err, exit );
+    err = kv_write( page, dst, buffer, length );
+    require_noerr( err, exit );
+    CRC16_Update( &crc_context, buffer, length );
+    src += length;
+    dst += length;
+    left -= length;
+  }
+  CRC16_Final( &crc_context, &header.crc );
+
+  err = kv_write( page, *offset, &header, sizeof( header ) );
+  require_noerr( err, exit );
+  *offset += KV_RECORD_SIZE( entry->length );
+
+exit:
+  return err;
+}
+
+static void kv_index_update( const mico_kv_item_t *item, uint32_t offset )
+{
+  kv_index_t *entry = kv_index_find( item->key );
+
+  if( entry == NULL )
+    entry = &kv.index[kv.index_count++];
+  entry->key = item->key;
+  entry->length = item->length;
+  entry->offset = offset;
+}
+
+/* Merge live records and items into the other page, then make it the active page */
+static OSStatus kv_compact( const mico_kv_item_t *items, uint32_t count )
+{
+  OSStatus err = kNoErr;
+  kv_page_header_t header;
+  kv_index_t *index = kv_scratch;
+  uint32_t index_count = 0;
+  uint32_t offset = KV_LOG_OFFSET;
+  uint32_t i;
+  int target = ( kv.active == 0 ) ? 1 : 0;
+  uint16_t txn = kv.txn + 1;
+
+  /* An empty store starts on the second page, the first may still hold legacy data */
+  if( kv.active < 0 ) target = 1;
+
+  kv_log( "Compact to page %d", target );
+
+  err = MicoFlashErase( kv.partition[target], 0x0, kv.page_size );
+  require_noerr( err, exit );
+
+  if( target == 0 ){
+    err = kv_write( target, 0x0, kv.preamble, MICO_KV_PREAMBLE_SIZE );
+    require_noerr( err, exit );
+  }
+
+  for( i = 0; i < kv.index_count; i++ ){
+    if( kv_item_find( items, count, kv.index[i].key ) == true )
+      continue;
+    index[index_count] = kv.index[i];
+    index[index_count++].offset = offset;
+    err = kv_copy( target, &offset, &kv.index[i], txn );
+    require_noerr( err, exit );
+  }
+
+  for( i = 0; i < count; i++ ){
+    index[index_count].key = items[i].key;
+    index[index_count].length = items[i].length;
+    index[index_count++].offset = offset;
+    err = kv_append( target, &offset, items[i].key, txn, items[i].data, items[i].length );
+    require_noerr( err, exit );
+  }
+
+  err = kv_append( target, &offset, MICO_KV_KEY_COMMIT, txn, NULL, 0 );
+  require_noerr( err, exit );
+
+  header.magic = KV_MAGIC_NUMBER;
+  header.sequence = kv.sequence + 1;
+  header.reserved = 0xFFFF;
+  header.crc = kv_page_header_crc( &header );
+  err = kv_write( target, KV_HEADER_OFFSET, &header, sizeof( header ) );
+  require_noerr( err, exit );
+
+  kv.active = target;
+  kv.sequence = header.sequence;
+  kv.write_offset = offset;
+  kv.txn = txn;
+  kv.index_count = index_count;
+  memcpy( kv.index, index, sizeof( kv_index_t ) * index_count );
+
+exit:
+  return err;
+}
+
+/* Rebuild the RAM index from the log of the active page */
+static OSStatus kv_scan( void )
+{
+  OSStatus err = kNoErr;
+  kv_record_header_t header;
+  uint32_t offset = KV_LOG_OFFSET;
+  uint32_t pending_count = 0;
+  uint32_t i, j;
+
+  kv.index_count = 0;
+  kv.txn = 0;
+
+  while( offset + sizeof( kv_record_header_t ) <= kv.page_size ){
+    err = kv_read( kv.active, offset, &header, sizeof( header ) );
+    require_noerr( err, exit );
+
+    if( header.key == MICO_KV_KEY_NONE && header.length == 0xFFFF &&
+        header.txn == 0xFFFF && header.crc == 0xFFFF )
+      break;
+
+    /* A torn record can only be the last one written, nothing valid follows it.
+       Mark the page full so that the next write compacts it. */
+    if( header.length > kv.page_size - offset - sizeof( kv_record_header_t ) ||
+        kv_record_is_valid( kv.active, offset, &header ) == false ){
+      kv_log( "Broken record at 0x%x", offset );
+      offset = kv.page_size;
+      break;
+    }
+
+    kv.txn = header.txn;
+
+    if( header.key == MICO_KV_KEY_COMMIT ){
+      for( i = 0; i < pending_count; i++ ){
+        if( kv_scratch_txn[i] != header.txn )
+          continue;
+        for( j = 0; j < kv.index_count; j++ ){
+          if( kv.index[j].key == kv_scratch[i].key )
+            break;
+        }
+        kv.index[j] = kv_scratch[i];
+        if( j == kv.index_count ) kv.index_count++;
+      }
+      pending_count = 0;
+    }
+    else if( pending_count < MICO_KV_MAX_KEYS ){
+      kv_scratch[pending_count].key = header.key;
+      kv_scratch[pending_count].length = header.length;
+      kv_scratch[pending_count].offset = offset;
+      kv_scratch_txn[pending_count++] = header.txn;
+    }
+
+    offset += KV_RECORD_SIZE( header.length );
+  }
+
+  kv.write_offset = Min( offset, kv.page_size );
+
+exit:
+  return err;
+}
+
+OSStatus mico_kv_init( mico_partition_t page_1, mico_partition_t page_2 )
+{
+  OSStatus err = kNoErr;
+  kv_page_header_t header[2];
+  bool valid[2];
+  mico_logic_partition_t *partition;
+  int i;
+
+  if( kv.mutex == NULL )
+    mico_rtos_init_mutex( &kv.mutex );
+  mico_rtos_lock_mutex( &kv.mutex );
+
+  kv.partition[0] = page_1;
+  kv.partition[1] = page_2;
+  kv.active = -1;
+  kv.sequence = 0;
+  kv.write_offset = 0;
+  kv.txn = 0;
+  kv.index_count = 0;
+
+  partition = MicoFlashGetInfo( page_1 );
+  require_action( partition && partition->partition_owner != MICO_FLASH_NONE, exit, err = kUnsupportedErr );
+  kv.page_size = partition->partition_length;
+  partition = MicoFlashGetInfo( page_2 );
+  require_action( partition && partition->partition_owner != MICO_FLASH_NONE, exit, err = kUnsupportedErr );
+  kv.page_size = Min( kv.page_size, partition->partition_length );
+  require_action( kv.page_size > KV_LOG_OFFSET + KV_RECORD_SIZE( 0 ), exit, err = kSizeErr );
+
+  err = kv_read( 0, 0x0, kv.preamble, MICO_KV_PREAMBLE_SIZE );
+  require_noerr( err, exit );
+
+  for( i = 0; i < 2; i++ ){
+    err = kv_read( i, KV_HEADER_OFFSET, &header[i], sizeof( kv_page_header_t ) );
+    require_noerr( err, exit );
+    valid[i] = ( header[i].magic == KV_MAGIC_NUMBER && header[i].sequence != 0xFFFFFFFF &&
+                 header[i].crc == kv_page_header_crc( &header[i] ) );
+  }
+
+  if( valid[0] == true && ( valid[1] == false || header[0].sequence > header[1].sequence ) )
+    kv.active = 0;
+  else if( valid[1] == true )
+    kv.active = 1;
+
+  require_action_quiet( kv.active >= 0, exit, err = kNotFoundErr );
+
+  kv.sequence = header[kv.active].sequence;
+  err = kv_scan( );
+  require_noerr( err, exit );
+
+  kv_log( "Page %d active, seq %d, %d keys, %d bytes used", kv.active, kv.sequence,
+          kv.index_count, kv.write_offset );
+
+exit:
+  mico_rtos_unlock_mutex( &kv.mutex );
+  return err;
+}
+
+OSStatus mico_kv_read( uint16_t key, void *data, uint16_t length )
+{
+  OSStatus err = kNoErr;
+  kv_index_t *entry;
+
+  mico_rtos_lock_mutex( &kv.mutex );
+  entry = kv_index_find( key );
+  require_action_quiet( entry, exit, err = kNotFoundErr );
+  require_action( entry->length == length, exit, err = kSizeErr );
+
+  err = kv_read( kv.active, entry->offset + sizeof( kv_record_header_t ), data, length );
+
+exit:
+  mico_rtos_unlock_mutex( &kv.mutex );
+  return err;
+}
+
+bool mico_kv_match( uint16_t key, const void *data, uint16_t length )
+{
+  uint8_t buffer[KV_COPY_BUFFER_SIZE];
+  kv_index_t *entry;
+  uint32_t offset, left, size;
+  bool match = false;
+
+  mico_rtos_lock_mutex( &kv.mutex );
+  entry = kv_index_find( key );
+  require_quiet( entry && entry->length == length, exit );
+
+  offset = entry->offset + sizeof( kv_record_header_t );
+  for( left = length; left; left -= size ){
+    size = Min( left, sizeof( buffer ) );
+    require_noerr_quiet( kv_read( kv.active, offset, buffer, size ), exit );
+    require_quiet( memcmp( buffer, (const uint8_t *)data + length - left, size ) == 0, exit );
+    offset += size;
+  }
+  match = true;
+
+exit:
+  mico_rtos_unlock_mutex( &kv.mutex );
+  return match;
+}
+
+OSStatus mico_kv_write( const mico_kv_item_t *items, uint32_t count )
+{
+  OSStatus err = kNoErr;
+  uint32_t need = KV_RECORD_SIZE( 0 );
+  uint32_t live = KV_RECORD_SIZE( 0 );
+  uint32_t new_keys = 0;
+  uint32_t offset, i;
+  uint16_t txn;
+
+  require_action( items || count == 0, exit_unlocked, err = kParamErr );
+  if( count == 0 ) return kNoErr;
+
+  mico_rtos_lock_mutex( &kv.mutex );
+  require_action( kv.page_size, exit, err = kNotPreparedErr );
+
+  for( i = 0; i < count; i++ ){
+    require_action( items[i].key < MICO_KV_KEY_COMMIT, exit, err = kParamErr );
+    need += KV_RECORD_SIZE( items[i].length );
+    if( kv_index_find( items[i].key ) == NULL ) new_keys++;
+  }
+  require_action( kv.index_count + new_keys <= MICO_KV_MAX_KEYS, exit, err = kNoSpaceErr );
+
+  /* Page is full (or not there yet), garbage collect into the other page */
+  if( kv.active < 0 || kv.write_offset + need > kv.page_size ){
+    for( i = 0; i < kv.index_count; i++ ){
+      if( kv_item_find( items, count, kv.index[i].key ) == false )
+        live += KV_RECORD_SIZE( kv.index[i].length );
+    }
+    require_action( KV_LOG_OFFSET + live + need - KV_RECORD_SIZE( 0 ) <= kv.page_size, exit, err = kNoSpaceErr );
+    err = kv_compact( items, count );
+    goto exit;
+  }
+
+  txn = kv.txn + 1;
+  offset = kv.write_offset;
+  for( i = 0; i < count; i++ ){
+    err = kv_append( kv.active, &offset, items[i].key, txn, items[i].data, items[i].length );
+    require_noerr( err, write_exit );
+  }
+  err = kv_append( kv.active, &offset, MICO_KV_KEY_COMMIT, txn, NULL, 0 );
+  require_noerr( err, write_exit );
+
+  /* Committed, update the index */
+  offset = kv.write_offset;
+  for( i = 0; i < count; i++ ){
+    kv_index_update( &items[i], offset );
+    offset += KV_RECORD_SIZE( items[i].length );
+  }
+  offset += KV_RECORD_SIZE( 0 );
+
+write_exit:
+  /* A failed write may have left a partial record, compact on next write */
+  kv.write_offset = ( err == kNoErr ) ? offset : kv.page_size;
+  kv.txn = txn;
+
+exit:
+  mico_rtos_unlock_mutex( &kv.mutex );
+exit_unlocked:
+  return err;
+}
+
+OSStatus mico_kv_read_preamble( void *data, uint32_t length )
+{
+  OSStatus err = kNoErr;
+  require_action( length <= MICO_KV_PREAMBLE_SIZE, exit, err = kSizeErr );
+  memcpy( data, kv.preamble, length );
+exit:
+  return err;
+}
+
+OSStatus mico_kv_write_preamble( const void *data, uint32_t length )
+{
+  OSStatus err = kNoErr;
+  const uint8_t *p = data;
+  uint32_t first, last, i;
+  bool programmable = true;
+
+  require_action( length <= MICO_KV_PREAMBLE_SIZE, exit_unlocked, err = kSizeErr );
+
+  mico_rtos_lock_mutex( &kv.mutex );
+  require_action( kv.page_size, exit, err = kNotPreparedErr );
+
+  for( first = 0; first < length && p[first] == kv.preamble[first]; first++ );
+  require_quiet( first < length, exit );
+  for( last = length - 1; p[last] == kv.preamble[last]; last-- );
+
+  for( i = first; i <= last; i++ ){
+    if( ( kv.preamble[i] & p[i] ) != p[i] )
+      programmable = false;
+  }
+  memcpy( kv.preamble, p, length );
+
+  /* Only clears bits, program it in place */
+  if( programmable == true ){
+    err = kv_write( 0, first, &kv.preamble[first], last - first + 1 );
+    goto exit;
+  }
+
+  /* Needs an erase, rebuild the first page with the new preamble. Unless the
+     live log is on the second page, move it there first. */
+  kv_log( "Preamble relocate" );
+  if( kv.active != 1 ){
+    err = kv_compact( NULL, 0 );
+    require_noerr( err, exit );
+  }
+  err = kv_compact( NULL, 0 );
+
+exit:
+  mico_rtos_unlock_mutex( &kv.mutex );
+exit_unlocked:
+  return err;
+}
@@ -0,0 +1,654 @@
+/**
+******************************************************************************
+* @file    mico_system_log.c
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   Deferred log: custom_log queues binary records, a low priority
+*          thread formats and prints them. Enabled by MICO_LOG_DEFERRED.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+/* A log call copies the format pointer and its arguments into a record, no
+ * formatting and no mutex, and the record is queued in a ring shared by all the
+ * threads and interrupts:
+ *
+ *   tag      record size | level << 16, written last. 0 until the record is
+ *            complete, a level of 0 is a pad record skipping the end of the ring.
+ *   time, module, format, file, line
+ *   payload  the arguments in the format order, packed with their own size.
+ *            Strings are copied, up to MICO_LOG_STRING_MAX bytes, as a length
+ *            byte followed by the characters.
+ *
+ * Writers claim space by moving the head with a compare and swap, so a writer
+ * interrupted by another one never blocks it. The reader formats the complete
+ * records from the tail, clears them and moves the tail. A record that does not
+ * fit in the ring is dropped and counted, the next drain prints the count.
+ *
+ * The format must stay valid until the record is printed: a string literal, as
+ * it is in every custom_log call. Wide strings (%ls) are not copied.
+ */
+
+#include "Common.h"
+#include "Debug.h"
+#include "mico_rtos.h"
+#include "RingBufferUtils.h"
+#include <stdarg.h>
+#include <stddef.h>
+
+#if DEBUG && MICO_LOG_DEFERRED && !defined(MICO_DISABLE_STDIO) && !defined(NO_MICO_RTOS)
+
+#ifndef MICO_LOG_RING_SIZE
+#define MICO_LOG_RING_SIZE        (4096)    /* Power of 2 */
+#endif
+
+#ifndef MICO_LOG_RECORD_MAX
+#define MICO_LOG_RECORD_MAX       (128)     /* Record header and arguments */
+#endif
+
+#ifndef MICO_LOG_STRING_MAX
+#define MICO_LOG_STRING_MAX       (48)      /* Longer %s arguments are cut */
+#endif
+
+#ifndef MICO_LOG_MODULE_MAX
+#define MICO_LOG_MODULE_MAX       (8)       /* Modules with their own level */
+#endif
+
+#ifndef MICO_LOG_LINE_MAX
+#define MICO_LOG_LINE_MAX         (256)     /* Formatted line */
+#endif
+
+#ifndef MICO_LOG_DRAIN_INTERVAL
+#define MICO_LOG_DRAIN_INTERVAL   (20)      /* ms */
+#endif
+
+#ifndef STACK_SIZE_MICO_LOG_THREAD
+#define STACK_SIZE_MICO_LOG_THREAD  (0x400)
+#endif
+
+#define MICO_LOG_THREAD_PRIORITY  (MICO_APPLICATION_PRIORITY + 1)
+
+#if ( MICO_LOG_RING_SIZE & ( MICO_LOG_RING_SIZE - 1 ) ) || ( MICO_LOG_RING_SIZE > 0x8000 )
+#error "MICO_LOG_RING_SIZE must be a power of 2, up to 32K"
+#endif
+
+#if ( MICO_LOG_RECORD_MAX > MICO_LOG_RING_SIZE ) || ( MICO_LOG_STRING_MAX > 255 )
+#error "MICO_LOG_RECORD_MAX or MICO_LOG_STRING_MAX too large"
+#endif
+
+#define LOG_ALIGN(size)     ( ( (size) + sizeof(uintptr_t) - 1 ) & ~( sizeof(uintptr_t) - 1 ) )
+#define LOG_RING_MASK       ( MICO_LOG_RING_SIZE - 1 )
+#define LOG_TAG(size, level) ( (uint32_t)(size) | ( (uint32_t)(level) << 16 ) )
+
+typedef struct {
+  volatile uint32_t tag;
+  uint32_t          time;
+  const char*       module;
+  const char*       format;
+  const char*       file;
+  int32_t           line;
+} log_record_t;
+
+/* Storage of each conversion argument */
+enum {
+  LOG_ARG_NONE,       /* %%, or an invalid conversion printed as it is */
+  LOG_ARG_INT,
+  LOG_ARG_LONG,
+  LOG_ARG_LLONG,
+  LOG_ARG_SIZE,
+  LOG_ARG_INTMAX,
+  LOG_ARG_PTRDIFF,
+  LOG_ARG_DOUBLE,
+  LOG_ARG_LDOUBLE,
+  LOG_ARG_PTR,
+  LOG_ARG_STRING,
+  LOG_ARG_SKIP,       /* %n and %ls, the pointer is not kept */
+};
+
+typedef struct {
+  const char* start;      /* '%' */
+  const char* type;       /* Length modifier and conversion */
+  const char* end;
+  int         precision;  /* -1 if none, -2 if '*' */
+  uint8_t     stars;      /* '*' width and precision arguments */
+  uint8_t     kind;
+} log_spec_t;
+
+typedef struct {
+  char    name[16];
+  int     level;
+} log_module_t;
+
+static uintptr_t log_ring[ MICO_LOG_RING_SIZE / sizeof(uintptr_t) ];
+static volatile uint32_t log_head;
+static volatile uint32_t log_tail;
+static volatile uint32_t log_written;
+static volatile uint32_t log_dropped;
+static volatile uint32_t log_high_water;
+static volatile uint32_t log_draining;
+static uint32_t log_dropped_reported;
+
+static volatile int log_default_level = MICO_LOG_TRACE;
+static log_module_t log_modules[ MICO_LOG_MODULE_MAX ];
+static volatile int log_module_count;
+
+static mico_thread_t log_thread_handler = NULL;
+
+/* Compare and swap, from any thread or interrupt */
+#if defined ( __ICCARM__ )
+#include <intrinsics.h>
+static bool log_cas( volatile uint32_t* p, uint32_t old_value, uint32_t new_value )
+{
+  if ( __LDREX( (unsigned long *)p ) != old_value )
+  {
+    __CLREX( );
+    return false;
+  }
+  return __STREX( new_value, (unsigned long *)p ) == 0;
+}
+#elif defined ( __CC_ARM ) //KEIL
+static bool log_cas( volatile uint32_t* p, uint32_t old_value, uint32_t new_value )
+{
+  if ( __ldrex( p ) != old_value )
+  {
+    __clrex( );
+    return false;
+  }
+  return __strex( new_value, p ) == 0;
+}
+#elif defined ( __GNUC__ ) && !defined ( __ARM_ARCH_6M__ )
+static bool log_cas( volatile uint32_t* p, uint32_t old_value, uint32_t new_value )
+{
+  return __sync_bool_compare_and_swap( p, old_value, new_value );
+}
+#else
+/* No exclusive access, not safe from an interrupt */
+static bool log_cas( volatile uint32_t* p, uint32_t old_value, uint32_t new_value )
+{
+  bool swapped = false;
+  mico_rtos_suspend_all_thread( );
+  if ( *p == old_value )
+  {
+    *p = new_value;
+    swapped = true;
+  }
+  mico_rtos_resume_all_thread( );
+  return swapped;
+}
+#endif
+
+static void log_add( volatile uint32_t* p, uint32_t value )
+{
+  uint32_t old_value;
+  do {
+    old_value = *p;
+  } while ( !log_cas( p, old_value, old_value + value ) );
+}
+
+/* Parse the conversion starting at the '%' at p, return the text after it */
+static const char* log_parse_spec( const char* p, log_spec_t* spec )
+{
+  char length = 0;
+
+  spec->start = p++;
+  spec->precision = -1;
+  spec->stars = 0;
+
+  while ( *p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0' ) p++;
+  if ( *p == '*' )
+  {
+    spec->stars++;
+    p++;
+  }
+  else while ( *p >= '0' && *p <= '9' ) p++;
+
+  if ( *p == '.' )
+  {
+    p++;
+    spec->precision = 0;
+    if ( *p == '*' )
+    {
+      spec->stars++;
+      spec->precision = -2;
+      p++;
+    }
+    else while ( *p >= '0' && *p <= '9' )
+    {
+      if ( spec->precision < MICO_LOG_STRING_MAX ) spec->precision = spec->precision * 10 + *p - '0';
+      p++;
+    }
+  }
+
+  spec->type = p;
+  switch ( *p )
+  {
+    case 'h':
+      p++;
+      if ( *p == 'h' ) p++;
+      break;
+    case 'l':
+      p++;
+      length = 'l';
+      if ( *p == 'l' )
+      {
+        p++;
+        length = 'q';
+      }
+      break;
+    case 'z': case 'j': case 't': case 'L':
+      length = *p++;
+      break;
+  }
+
+  switch ( *p )
+  {
+    case 'd': case 'i': case 'u': case 'o': case 'x': case 'X':
+      switch ( length )
+      {
+        case 'l': spec->kind = LOG_ARG_LONG;    break;
+        case 'q': spec->kind = LOG_ARG_LLONG;   break;
+        case 'z': spec->kind = LOG_ARG_SIZE;    break;
+        case 'j': spec->kind = LOG_ARG_INTMAX;  break;
+        case 't': spec->kind = LOG_ARG_PTRDIFF; break;
+        default:  spec->kind = LOG_ARG_INT;     break;
+      }
+      break;
+    case 'c':
+      spec->kind = LOG_ARG_INT;
+      break;
+    case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+      spec->kind = ( length == 'L' ) ? LOG_ARG_LDOUBLE : LOG_ARG_DOUBLE;
+      break;
+    case 'p':
+      spec->kind = LOG_ARG_PTR;
+      break;
+    case 's':
+      spec->kind = ( length == 'l' ) ? LOG_ARG_SKIP : LOG_ARG_STRING;
+      break;
+    case 'n':
+      spec->kind = LOG_ARG_SKIP;
+      break;
+    default:
+      spec->kind = LOG_ARG_NONE;
+      spec->stars = 0;
+      break;
+  }
+  if ( *p != 0 ) p++;
+  spec->end = p;
+  return p;
+}
+
+static int log_module_level( const char* module )
+{
+  int i, count = log_module_count;
+
+  for ( i = 0; i < count && module != NULL; i++ )
+  {
+    if ( strcmp( log_modules[i].name, module ) == 0 )
+      return log_modules[i].level;
+  }
+  return log_default_level;
+}
+
+#define LOG_PUT(T, V) do { T value_ = (V);\
+                           if ( arg + sizeof(T) > end ) goto full;\
+                           memcpy( arg, &value_, sizeof(T) );\
+                           arg += sizeof(T); } while(0)
+
+void mico_log_write( int level, const char* module, const char* file, int line, const char* format, ... )
+{
+  uintptr_t buffer[ MICO_LOG_RECORD_MAX / sizeof(uintptr_t) ];
+  log_record_t* record = (log_record_t*)buffer;
+  uint8_t* arg = (uint8_t*)( record + 1 );
+  uint8_t* end = (uint8_t*)buffer + sizeof(buffer);
+  const char* p = format;
+  const char* s;
+  log_spec_t spec;
+  uint32_t head, tail, offset, pad, size, used;
+  int i, star;
+  va_list ap;
+
+  if ( level > log_module_level( module ) ) return;
+
+  va_start( ap, format );
+  while ( ( p = strchr( p, '%' ) ) != NULL )
+  {
+    p = log_parse_spec( p, &spec );
+    for ( i = 0; i < spec.stars; i++ )
+    {
+      star = va_arg( ap, int );
+      if ( i == spec.stars - 1 && spec.precision == -2 )
+        spec.precision = ( star >= 0 ) ? star : -1;
+      LOG_PUT( int, star );
+    }
+
+    switch ( spec.kind )
+    {
+      case LOG_ARG_INT:     LOG_PUT( int, va_arg( ap, int ) );                     break;
+      case LOG_ARG_LONG:    LOG_PUT( long, va_arg( ap, long ) );                   break;
+      case LOG_ARG_LLONG:   LOG_PUT( long long, va_arg( ap, long long ) );         break;
+      case LOG_ARG_SIZE:    LOG_PUT( size_t, va_arg( ap, size_t ) );               break;
+      case LOG_ARG_INTMAX:  LOG_PUT( intmax_t, va_arg( ap, intmax_t ) );           break;
+      case LOG_ARG_PTRDIFF: LOG_PUT( ptrdiff_t, va_arg( ap, ptrdiff_t ) );         break;
+      case LOG_ARG_DOUBLE:  LOG_PUT( double, va_arg( ap, double ) );               break;
+      case LOG_ARG_LDOUBLE: LOG_PUT( long double, va_arg( ap, long double ) );     break;
+      case LOG_ARG_PTR:     LOG_PUT( void*, va_arg( ap, void* ) );                 break;
+      case LOG_ARG_SKIP:    (void)va_arg( ap, void* );                             break;
+      case LOG_ARG_STRING:
+        s = va_arg( ap, const char* );
+        if ( s == NULL ) s = "(null)";
+        if ( arg >= end ) goto full;
+        size = ( spec.precision >= 0 && spec.precision < MICO_LOG_STRING_MAX ) ? spec.precision : MICO_LOG_STRING_MAX;
+        if ( size > end - arg - 1 ) size = end - arg - 1;
+        for ( i = 0; i < (int)size && s[i] != 0; i++ ) arg[ 1 + i ] = s[i];
+        arg[0] = i;
+        arg += 1 + i;
+        break;
+      default:
+        break;
+    }
+  }
+full:
+  va_end( ap );
+
+  record->time = mico_get_time( );
+  record->module = module;
+  record->format = format;
+  record->file = file;
+  record->line = line;
+  size = LOG_ALIGN( arg - (uint8_t*)buffer );
+
+  /* Claim the space, with a pad record if it would wrap */
+  do {
+    tail = log_tail; /* Before the head, the tail never passes it */
+    head = log_head;
+    offset = head & LOG_RING_MASK;
+    pad = ( offset + size > MICO_LOG_RING_SIZE ) ? MICO_LOG_RING_SIZE - offset : 0;
+    used = head + pad + size - tail;
+    if ( used > MICO_LOG_RING_SIZE )
+    {
+      log_add( &log_dropped, 1 );
+      return;
+    }
+  } while ( !log_cas( &log_head, head, head + pad + size ) );
+
+  if ( pad != 0 )
+  {
+    ( (log_record_t*)( (uint8_t*)log_ring + offset ) )->tag = LOG_TAG( pad, 0 );
+    offset = 0;
+  }
+  memcpy( (uint8_t*)log_ring + offset + sizeof(uint32_t), (uint8_t*)buffer + sizeof(uint32_t), size - sizeof(uint32_t) );
+  RING_BUFFER_MEMORY_BARRIER( );
+  ( (log_record_t*)( (uint8_t*)log_ring + offset ) )->tag = LOG_TAG( size, level );
+
+  log_add( &log_written, 1 );
+  if ( used > log_high_water ) log_high_water = used;
+}
+
+static const char* log_short_file( const char* file )
+{
+  const char* p = strrchr( file, '\\' );
+
+  if ( p == NULL ) p = strrchr( file, '/' );
+  return ( p != NULL ) ? p + 1 : file;
+}
+
+#define LOG_GET(T, V) do { if ( arg + sizeof(T) > end ) goto truncated;\
+                           memcpy( &(V), arg, sizeof(T) );\
+                           arg += sizeof(T); } while(0)
+
+#define LOG_PRINT(T) do { T value_;\
+                          LOG_GET( T, value_ );\
+                          if ( stars == 0 ) r = snprintf( line + n, limit - n, fmt, value_ );\
+                          else if ( stars == 1 ) r = snprintf( line + n, limit - n, fmt, star[0], value_ );\
+                          else r = snprintf( line + n, limit - n, fmt, star[0], star[1], value_ ); } while(0)
+
+/* Format a record as custom_log would have printed it, return the length */
+static int log_format( const log_record_t* record, char* line, int size )
+{
+  const uint8_t* arg = (const uint8_t*)( record + 1 );
+  const uint8_t* end = (const uint8_t*)record + ( record->tag & 0xFFFF );
+  const char* p = record->format;
+  const char* q;
+  char fmt[24];
+  char string[ MICO_LOG_STRING_MAX + 1 ];
+  int limit = size - 2;
+  int n, r, i, stars, star[2];
+  log_spec_t spec;
+
+  n = snprintf( line, limit, "[%d][%s: %s:%4d] ", (int)record->time, record->module,
+                log_short_file( record->file ), (int)record->line );
+  if ( n < 0 || n > limit - 1 ) n = ( n < 0 ) ? 0 : limit - 1;
+
+  while ( *p != 0 && n < limit - 1 )
+  {
+    if ( *p != '%' )
+    {
+      q = strchr( p, '%' );
+      r = ( q != NULL ) ? (int)( q - p ) : (int)strlen( p );
+      if ( r > limit - 1 - n ) r = limit - 1 - n;
+      memcpy( line + n, p, r );
+      n += r;
+      p += r;
+      continue;
+    }
+
+    p = log_parse_spec( p, &spec );
+    for ( i = 0; i < spec.stars; i++ ) LOG_GET( int, star[i] );
+
+    stars = spec.stars;
+    if ( spec.end - spec.start < (int)sizeof(fmt) )
+    {
+      memcpy( fmt, spec.start, spec.end - spec.start );
+      fmt[ spec.end - spec.start ] = 0;
+    }
+    else
+    {
+      /* Too long, keep the length modifier and the conversion only */
+      fmt[0] = '%';
+      memcpy( fmt + 1, spec.type, spec.end - spec.type );
+      fmt[ 1 + spec.end - spec.type ] = 0;
+      stars = 0;
+    }
+
+    r = 0;
+    switch ( spec.kind )
+    {
+      case LOG_ARG_INT:     LOG_PRINT( int );         break;
+      case LOG_ARG_LONG:    LOG_PRINT( long );        break;
+      case LOG_ARG_LLONG:   LOG_PRINT( long long );   break;
+      case LOG_ARG_SIZE:    LOG_PRINT( size_t );      break;
+      case LOG_ARG_INTMAX:  LOG_PRINT( intmax_t );    break;
+      case LOG_ARG_PTRDIFF: LOG_PRINT( ptrdiff_t );   break;
+      case LOG_ARG_DOUBLE:  LOG_PRINT( double );      break;
+      case LOG_ARG_LDOUBLE: LOG_PRINT( long double ); break;
+      case LOG_ARG_PTR:     LOG_PRINT( void* );       break;
+      case LOG_ARG_SKIP:                              break;
+      case LOG_ARG_STRING:
+      {
+        const char* value_ = string;
+        if ( arg >= end || arg + 1 + arg[0] > end ) goto truncated;
+        memcpy( string, arg + 1, arg[0] );
+        string[ arg[0] ] = 0;
+        arg += 1 + arg[0];
+        if ( stars == 0 ) r = snprintf( line + n, limit - n, fmt, value_ );
+        else if ( stars == 1 ) r = snprintf( line + n, limit - n, fmt, star[0], value_ );
+        else r = snprintf( line + n, limit - n, fmt, star[0], star[1], value_ );
+        break;
+      }
+      default:
+        if ( *spec.type == '%' )
+          line[ n ] = '%', r = 1;
+        else
+        {
+          r = Min( spec.end - spec.start, limit - 1 - n );
+          memcpy( line + n, spec.start, r );
+        }
+        break;
+    }
+    if ( r > 0 ) n += ( r < limit - 1 - n ) ? r : limit - 1 - n;
+  }
+  goto exit;
+
+truncated:
+  /* The record was full, the arguments left were not saved */
+  r = snprintf( line + n, limit - n, "..." );
+  if ( r > 0 ) n += ( r < limit - 1 - n ) ? r : limit - 1 - n;
+
+exit:
+  line[ n++ ] = '\r';
+  line[ n++ ] = '\n';
+  line[ n ] = 0;
+  return n;
+}
+
+static void log_output_stdio( const char* line, int len, void* arg )
+{
+  UNUSED_PARAMETER( len );
+  UNUSED_PARAMETER( arg );
+  mico_rtos_lock_mutex( &stdio_tx_mutex );
+  printf( "%s", line );
+  mico_rtos_unlock_mutex( &stdio_tx_mutex );
+}
+
+int mico_log_drain( mico_log_output_t output, void* arg, int max_records )
+{
+  char line[ MICO_LOG_LINE_MAX ];
+  log_record_t* record;
+  uint32_t tail, tag, dropped;
+  int count = 0, len;
+
+  /* One reader at a time, the log thread or the "log flush" command */
+  if ( !log_cas( &log_draining, 0, 1 ) ) return 0;
+  if ( output == NULL ) output = log_output_stdio;
+
+  tail = log_tail;
+  while ( tail != log_head && ( max_records == 0 || count < max_records ) )
+  {
+    record = (log_record_t*)( (uint8_t*)log_ring + ( tail & LOG_RING_MASK ) );
+    tag = record->tag;
+    if ( tag == 0 ) break; /* Claimed, not written yet */
+    RING_BUFFER_MEMORY_BARRIER( );
+
+    if ( ( tag >> 16 ) != 0 )
+    {
+      len = log_format( record, line, sizeof(line) );
+      output( line, len, arg );
+      count++;
+    }
+
+    /* A later record can start anywhere in this one, its tag must read 0 */
+    memset( record, 0, tag & 0xFFFF );
+    RING_BUFFER_MEMORY_BARRIER( );
+    tail += tag & 0xFFFF;
+    log_tail = tail;
+  }
+
+  dropped = log_dropped;
+  if ( dropped != log_dropped_reported )
+  {
+    len = snprintf( line, sizeof(line), "[%d][LOG] %u records dropped\r\n", (int)mico_get_time( ),
+                    (unsigned)( dropped - log_dropped_reported ) );
+    output( line, len, arg );
+    log_dropped_reported = dropped;
+  }
+
+  RING_BUFFER_MEMORY_BARRIER( );
+  log_draining = 0;
+  return count;
+}
+
+OSStatus mico_log_set_level( const char* module, int level )
+{
+  OSStatus err = kNoErr;
+  int i, count = log_module_count;
+
+  require_action( level >= MICO_LOG_OFF && level <= MICO_LOG_TRACE, exit, err = kParamErr );
+
+  if ( module == NULL || strcmp( module, "*" ) == 0 )
+  {
+    log_module_count = 0;
+    log_default_level = level;
+    goto exit;
+  }
+
+  require_action( strlen( module ) < sizeof(log_modules[0].name), exit, err = kParamErr );
+  for ( i = 0; i < count; i++ )
+  {
+    if ( strcmp( log_modules[i].name, module ) == 0 )
+    {
+      log_modules[i].level = level;
+      goto exit;
+    }
+  }
+
+  require_action( count < MICO_LOG_MODULE_MAX, exit, err = kNoResourcesErr );
+  strcpy( log_modules[count].name, module );
+  log_modules[count].level = level;
+  RING_BUFFER_MEMORY_BARRIER( );
+  log_module_count = count + 1;
+
+exit:
+  return err;
+}
+
+int mico_log_get_level( const char* module )
+{
+  return log_module_level( module );
+}
+
+void mico_log_get_stats( mico_log_stats_t* stats )
+{
+  stats->written = log_written;
+  stats->dropped = log_dropped;
+  stats->used = log_head - log_tail;
+  stats->high_water = log_high_water;
+  stats->size = MICO_LOG_RING_SIZE;
+}
+
+static void mico_log_thread( void* arg )
+{
+  UNUSED_PARAMETER( arg );
+
+  while ( 1 )
+  {
+    mico_log_drain( NULL, NULL, 0 );
+    mico_thread_msleep( MICO_LOG_DRAIN_INTERVAL );
+  }
+}
+
+OSStatus mico_log_start( void )
+{
+  OSStatus err = kNoErr;
+
+  require( log_thread_handler == NULL, exit );
+  err = mico_rtos_create_thread( &log_thread_handler, MICO_LOG_THREAD_PRIORITY, "Log", mico_log_thread,
+                                 STACK_SIZE_MICO_LOG_THREAD, NULL );
+  require_noerr( err, exit );
+
+exit:
+  return err;
+}
+
+#endif /* DEBUG && MICO_LOG_DEFERRED */
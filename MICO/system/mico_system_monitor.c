@@ -38,10 +38,17 @@
 #define MAXIMUM_NUMBER_OF_SYSTEM_MONITORS    (5)
 #endif
 
+#ifdef MICO_PROFILER_ENABLE
+/* The threads profile is printed on a missed update */
+#undef STACK_SIZE_mico_system_MONITOR_THREAD
+#define STACK_SIZE_mico_system_MONITOR_THREAD   0x600
+#endif
+
 #define APPLICATION_WATCHDOG_TIMEOUT_SECONDS  5 /**< Monitor point defined by mico system
                                                      5 seconds to reload. */
 
 static mico_system_monitor_t* system_monitors[MAXIMUM_NUMBER_OF_SYSTEM_MONITORS];
+static bool slot_confirmed = false;
 void mico_system_monitor_thread_main( void* arg );
 
 OSStatus MICOStartSystemMonitor ( void )
@@ -56,6 +63,22 @@ exit:
   return err;
 }
 
+/* A slot booted on trial has run without a monitor failure, keep it. Clearing
+   BOOT_UPGRADE_TRIAL to BOOT_UPGRADE_CONFIRMED only clears bits, no erase needed. */
+static void system_monitor_confirm_slot( void )
+{
+  mico_Context_t *context = mico_system_context_get( );
+
+  slot_confirmed = true;
+  if( context == NULL || context->flashContentInRam.bootTable.upgrade_type != BOOT_UPGRADE_TRIAL )
+    return;
+
+  mico_rtos_lock_mutex( &context->flashContentInRam_mutex );
+  context->flashContentInRam.bootTable.upgrade_type = BOOT_UPGRADE_CONFIRMED;
+  mico_rtos_unlock_mutex( &context->flashContentInRam_mutex );
+  mico_system_context_update( context );
+}
+
 void mico_system_monitor_thread_main( void* arg )
 {
   (void)arg;
@@ -72,12 +95,20 @@ void mico_system_monitor_thread_main( void* arg )
         if ((current_time - system_monitors[a]->last_update) > system_monitors[a]->longest_permitted_delay)
         {
           /* A system monitor update period has been missed */
+#ifdef MICO_PROFILER_ENABLE
+          mico_profiler_top( printf, 0 );
+#endif
           while(1);
         }
       }
     }
     
     MicoWdgReload();
+    if ( slot_confirmed == false && current_time >= BOOT_TRIAL_CONFIRM_TIME )
+    {
+      system_monitor_confirm_slot();
+      MicoWdgReload();
+    }
     mico_thread_msleep(DEFAULT_SYSTEM_MONITOR_PERIOD);
   }
 }
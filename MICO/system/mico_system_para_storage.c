@@ -37,14 +37,23 @@
 /* Update seed number every time*/
 static int32_t seedNum = 0;
 
-#define SYS_CONFIG_OFFSET   ( sizeof( boot_table_t ) )
 #define SYS_CONFIG_SIZE     ( sizeof( mico_sys_config_t ) )
 
+/* Layout used by older firmware, only read to migrate into the key/value store */
+#define SYS_CONFIG_OFFSET   ( sizeof( boot_table_t ) )
+
 #define USER_CONFIG_OFFSET  ( 0x400 )
 
 #define CRC_OFFSET    ( 0xE00 )
 #define CRC_SIZE      ( 2 )
 
+/* Configuration is saved in chunks, an update only appends the changed ones */
+#define PARA_CHUNK_SIZE         ( 128 )
+#define PARA_CHUNK_NUM(size)    ( ( (size) + PARA_CHUNK_SIZE - 1 ) / PARA_CHUNK_SIZE )
+
+#define PARA_KEY_SYS_CONFIG     ( 0x0100 )
+#define PARA_KEY_USER_CONFIG    ( 0x0200 )
+
 //#define para_log(M, ...) custom_log("MiCO Settting", M, ##__VA_ARGS__)
 
 #define para_log(M, ...)
@@ -65,62 +74,117 @@ static bool is_crc_match( uint16_t crc_1, uint16_t crc_2)
   return true;
 }
 
+static uint32_t para_add_changed_chunks( mico_kv_item_t *items, uint16_t key, const uint8_t *data, uint32_t size )
+{
+  uint32_t count = 0;
+  uint32_t offset;
+  uint16_t length;
+
+  for( offset = 0; offset < size; offset += PARA_CHUNK_SIZE, key++ ){
+    length = Min( size - offset, PARA_CHUNK_SIZE );
+    if( mico_kv_match( key, data + offset, length ) == true )
+      continue;
+    items[count].key = key;
+    items[count].length = length;
+    items[count].data = data + offset;
+    count++;
+  }
+  return count;
+}
+
+static OSStatus para_read_chunks( uint16_t key, uint8_t *data, uint32_t size )
+{
+  OSStatus err = kNoErr;
+  uint32_t offset;
+
+  for( offset = 0; offset < size; offset += PARA_CHUNK_SIZE, key++ ){
+    err = mico_kv_read( key, data + offset, Min( size - offset, PARA_CHUNK_SIZE ) );
+    require_noerr_quiet( err, exit );
+  }
+
+exit:
+  return err;
+}
+
 static OSStatus internal_update_config( mico_Context_t * const inContext )
 {
   OSStatus err = kNoErr;
-  uint32_t para_offset;
-  CRC16_Context crc_context;
-  uint16_t crc_result;
-  
-  uint16_t crc_readback;;
+  mico_kv_item_t *items = NULL;
+  uint32_t count;
 
   para_log("Flash write!");
 
-  CRC16_Init( &crc_context );
-  CRC16_Update( &crc_context, &inContext->flashContentInRam.micoSystemConfig, SYS_CONFIG_SIZE );
-  CRC16_Update( &crc_context, inContext->user_config_data, inContext->user_config_data_size );
+  items = malloc( sizeof( mico_kv_item_t ) * ( PARA_CHUNK_NUM( SYS_CONFIG_SIZE ) + PARA_CHUNK_NUM( inContext->user_config_data_size ) ) );
+  require_action( items, exit, err = kNoMemoryErr );
 
-  CRC16_Final( &crc_context, &crc_result );
+  count = para_add_changed_chunks( items, PARA_KEY_SYS_CONFIG, (uint8_t *)&inContext->flashContentInRam.micoSystemConfig, SYS_CONFIG_SIZE );
+  count += para_add_changed_chunks( &items[count], PARA_KEY_USER_CONFIG, inContext->user_config_data, inContext->user_config_data_size );
+  para_log("%d chunks changed", count);
 
-  err = MicoFlashErase( MICO_PARTITION_PARAMETER_1, 0x0, sizeof(flash_content_t) );
+  err = mico_kv_write( items, count );
   require_noerr(err, exit);
 
-  para_offset = 0x0;
-  err = MicoFlashWrite( MICO_PARTITION_PARAMETER_1, &para_offset, (uint8_t *)&inContext->flashContentInRam, sizeof(flash_content_t));
+  /* Boot table stays at the head of PARAMETER_1, where the bootloader reads it */
+  err = mico_kv_write_preamble( &inContext->flashContentInRam.bootTable, sizeof( boot_table_t ) );
   require_noerr(err, exit);
 
-  para_offset = USER_CONFIG_OFFSET;
-  err = MicoFlashWrite( MICO_PARTITION_PARAMETER_1, &para_offset, inContext->user_config_data, inContext->user_config_data_size );
-  require_noerr(err, exit);
+exit:
+  if( items != NULL ) free( items );
+  return err;
+}
 
-  para_offset = CRC_OFFSET;
-  err = MicoFlashWrite( MICO_PARTITION_PARAMETER_1, &para_offset, (uint8_t *)&crc_result, CRC_SIZE );
-  require_noerr(err, exit);
-  
-  /* Read back*/
-  para_offset = CRC_OFFSET;
-  err = MicoFlashRead( MICO_PARTITION_PARAMETER_1, &para_offset, (uint8_t *)&crc_readback, CRC_SIZE );
-  para_log( "crc_readback = %d", crc_readback);
-  if( crc_readback == 0x0)
-    return kWriteErr;
-  
+static OSStatus internal_read_config( mico_Context_t * const inContext )
+{
+  OSStatus err = kNoErr;
 
-  /* Write backup data*/
-  err = MicoFlashErase( MICO_PARTITION_PARAMETER_2, 0x0, sizeof(flash_content_t) );
+  err = mico_kv_read_preamble( &inContext->flashContentInRam.bootTable, sizeof( boot_table_t ) );
   require_noerr(err, exit);
 
-  para_offset = 0x0;
-  err = MicoFlashWrite( MICO_PARTITION_PARAMETER_2, &para_offset, (uint8_t *)&inContext->flashContentInRam, sizeof(flash_content_t));
-  require_noerr(err, exit);
+  err = para_read_chunks( PARA_KEY_SYS_CONFIG, (uint8_t *)&inContext->flashContentInRam.micoSystemConfig, SYS_CONFIG_SIZE );
+  require_noerr_quiet(err, exit);
 
-  para_offset = USER_CONFIG_OFFSET;
-  err = MicoFlashWrite( MICO_PARTITION_PARAMETER_2, &para_offset, inContext->user_config_data, inContext->user_config_data_size );
-  require_noerr(err, exit);
+  err = para_read_chunks( PARA_KEY_USER_CONFIG, inContext->user_config_data, inContext->user_config_data_size );
+  require_noerr_quiet(err, exit);
+
+exit:
+  return err;
+}
+
+/* Read the main, then the backup copy written by older firmware */
+static OSStatus internal_read_legacy_config( mico_Context_t * const inContext )
+{
+  OSStatus err = kNoErr;
+  const mico_partition_t partition[2] = { MICO_PARTITION_PARAMETER_1, MICO_PARTITION_PARAMETER_2 };
+  uint32_t para_offset;
+  CRC16_Context crc_context;
+  uint16_t crc_result, crc_target;
+  int i;
 
-  para_offset = CRC_OFFSET;
-  err = MicoFlashWrite( MICO_PARTITION_PARAMETER_2, &para_offset, (uint8_t *)&crc_result, CRC_SIZE );
+  err = mico_kv_read_preamble( &inContext->flashContentInRam.bootTable, sizeof( boot_table_t ) );
   require_noerr(err, exit);
 
+  for( i = 0; i < 2; i++ ){
+    para_offset = SYS_CONFIG_OFFSET;
+    err = MicoFlashRead( partition[i], &para_offset, (uint8_t *)&inContext->flashContentInRam.micoSystemConfig, SYS_CONFIG_SIZE );
+    require_noerr(err, exit);
+    para_offset = USER_CONFIG_OFFSET;
+    err = MicoFlashRead( partition[i], &para_offset, (uint8_t *)inContext->user_config_data, inContext->user_config_data_size );
+    require_noerr(err, exit);
+    para_offset = CRC_OFFSET;
+    err = MicoFlashRead( partition[i], &para_offset, (uint8_t *)&crc_target, CRC_SIZE );
+    require_noerr(err, exit);
+
+    CRC16_Init( &crc_context );
+    CRC16_Update( &crc_context, (uint8_t *)&inContext->flashContentInRam.micoSystemConfig, SYS_CONFIG_SIZE );
+    CRC16_Update( &crc_context, inContext->user_config_data, inContext->user_config_data_size );
+    CRC16_Final( &crc_context, &crc_result );
+    para_log( "Legacy partition %d, crc_result = %d, crc_target = %d", i, crc_result, crc_target);
+
+    if( is_crc_match( crc_result, crc_target ) == true )
+      goto exit;
+  }
+  err = kIntegrityErr;
+
 exit:
   return err;
 }
@@ -131,7 +195,8 @@ OSStatus mico_system_context_restore( mico_Context_t * const inContext )
   require_action( inContext, exit, err = kNotPreparedErr );
 
   /*wlan configration is not need to change to a default state, use easylink to do that*/
-  memset(&inContext->flashContentInRam, 0x0, sizeof(inContext->flashContentInRam));
+  /*Boot table is kept, it tells the bootloader which application slot to boot*/
+  memset(&inContext->flashContentInRam.micoSystemConfig, 0x0, sizeof(inContext->flashContentInRam.micoSystemConfig));
   sprintf(inContext->flashContentInRam.micoSystemConfig.name, DEFAULT_NAME);
   inContext->flashContentInRam.micoSystemConfig.configured = unConfigured;
   inContext->flashContentInRam.micoSystemConfig.easyLinkByPass = EASYLINK_BYPASS_NO;
@@ -177,113 +242,24 @@ exit:
 
 OSStatus MICOReadConfiguration(mico_Context_t *inContext)
 {
-  uint32_t para_offset = 0x0;
-  //uint32_t config_offset = CONFIG_OFFSET;
-  uint32_t crc_offset = CRC_OFFSET;
-  CRC16_Context crc_context;
-  uint16_t crc_result, crc_target;
-  uint16_t crc_backup_result, crc_backup_target;
-  mico_logic_partition_t *partition; 
-  uint8_t *sys_backup_data = NULL;
-  uint8_t *user_backup_data = NULL;
-
   OSStatus err = kNoErr;
 
-  sys_backup_data = malloc( SYS_CONFIG_SIZE );
-  require_action( sys_backup_data, exit, err = kNoMemoryErr );
-
-  user_backup_data = malloc( inContext->user_config_data_size );
-  require_action( user_backup_data, exit, err = kNoMemoryErr );
-
-
-  /* Load data and crc from main partition */
-  para_offset = 0x0;
-  err = MicoFlashRead( MICO_PARTITION_PARAMETER_1, &para_offset, (uint8_t *)&inContext->flashContentInRam, sizeof( flash_content_t ) );
-  para_offset = USER_CONFIG_OFFSET;
-  err = MicoFlashRead( MICO_PARTITION_PARAMETER_1, &para_offset, (uint8_t *)inContext->user_config_data, inContext->user_config_data_size );
-
-  CRC16_Init( &crc_context );
-  CRC16_Update( &crc_context, (uint8_t *)&inContext->flashContentInRam.micoSystemConfig, SYS_CONFIG_SIZE );
-  CRC16_Update( &crc_context, inContext->user_config_data, inContext->user_config_data_size );
-  CRC16_Final( &crc_context, &crc_result );
-  para_log( "crc_result = %d", crc_result);
-
-  crc_offset = CRC_OFFSET;
-  err = MicoFlashRead( MICO_PARTITION_PARAMETER_1, &crc_offset, (uint8_t *)&crc_target, CRC_SIZE );
-  para_log( "crc_target = %d", crc_target);
-
-  /* Load data and crc from backup partition */
-  para_offset = SYS_CONFIG_OFFSET;
-  err = MicoFlashRead( MICO_PARTITION_PARAMETER_2, &para_offset, sys_backup_data, SYS_CONFIG_SIZE );
-  para_offset = USER_CONFIG_OFFSET;
-  err = MicoFlashRead( MICO_PARTITION_PARAMETER_2, &para_offset, user_backup_data, inContext->user_config_data_size );
-
-  CRC16_Init( &crc_context );
-  CRC16_Update( &crc_context, sys_backup_data,  SYS_CONFIG_SIZE );
-  CRC16_Update( &crc_context, user_backup_data, inContext->user_config_data_size );
-  CRC16_Final( &crc_context, &crc_backup_result );
-  para_log( "crc_backup_result = %d", crc_backup_result);
+  err = mico_kv_init( MICO_PARTITION_PARAMETER_1, MICO_PARTITION_PARAMETER_2 );
+  if( err == kNotFoundErr ){
+    para_log("No key/value store, migrate config!");
+    err = internal_read_legacy_config( inContext );
+    if( err == kNoErr )
+      err = internal_update_config( inContext );
+  }
+  else{
+    require_noerr(err, exit);
+    err = internal_read_config( inContext );
+  }
 
-  crc_offset = CRC_OFFSET;
-  err = MicoFlashRead( MICO_PARTITION_PARAMETER_2, &crc_offset, (uint8_t *)&crc_backup_target, CRC_SIZE );  
-  para_log( "crc_backup_target = %d", crc_backup_target);
-  
-  /* Data collapsed at main partition */
-  if( is_crc_match( crc_result, crc_target ) == false ){
-    /* Data collapsed at main partition and backup partition both, restore to default */
-    if( is_crc_match( crc_backup_result, crc_backup_target ) == false ){
-      para_log("Config failed on both partition, restore to default settings!");
-      err = mico_system_context_restore( inContext );
-      require_noerr(err, exit);
-    }
-    /* main collapsed, backup correct, copy data from back up to main */
-    else {
-      para_log("Config failed on main, recover!");
-
-      memset(&inContext->flashContentInRam, 0x0, sizeof(inContext->flashContentInRam));
-      memcpy( (uint8_t *)&inContext->flashContentInRam.micoSystemConfig, sys_backup_data, SYS_CONFIG_SIZE);
-
-      partition = MicoFlashGetInfo( MICO_PARTITION_PARAMETER_1 );
-
-      err = MicoFlashErase( MICO_PARTITION_PARAMETER_1 ,0x0, partition->partition_length );
-      require_noerr(err, exit);
-
-      para_offset = 0x0;
-      err = MicoFlashWrite( MICO_PARTITION_PARAMETER_1, &para_offset, (uint8_t *)&inContext->flashContentInRam, sizeof(flash_content_t) );
-      require_noerr(err, exit);
-
-      para_offset = USER_CONFIG_OFFSET;
-      err = MicoFlashWrite( MICO_PARTITION_PARAMETER_1, &para_offset, inContext->user_config_data, inContext->user_config_data_size );
-      require_noerr(err, exit);
-
-      crc_offset = CRC_OFFSET;
-      err = MicoFlashWrite( MICO_PARTITION_PARAMETER_1, &crc_offset, (uint8_t *)&crc_backup_result, CRC_SIZE );
-      require_noerr(err, exit);
-    }
-  }   
-  /* main correct */
-  else { 
-      /* main correct , backup collapsed, or main!=backup, copy data from main to back up */
-    if( is_crc_match( crc_result, crc_backup_result ) == false || is_crc_match( crc_backup_result, crc_backup_target ) == false ){
-      para_log("Config failed on backup, recover!");
-
-      partition = MicoFlashGetInfo( MICO_PARTITION_PARAMETER_2 );
-
-      err = MicoFlashErase( MICO_PARTITION_PARAMETER_2 ,0x0, partition->partition_length );
-      require_noerr(err, exit);
-  
-      para_offset = 0x0;
-      err = MicoFlashWrite( MICO_PARTITION_PARAMETER_2, &para_offset, (uint8_t *)&inContext->flashContentInRam, sizeof(flash_content_t) );
-      require_noerr(err, exit);
-
-      para_offset = USER_CONFIG_OFFSET;
-      err = MicoFlashWrite( MICO_PARTITION_PARAMETER_2, &para_offset, inContext->user_config_data, inContext->user_config_data_size );
-      require_noerr(err, exit);
-
-      crc_offset = CRC_OFFSET;
-      err = MicoFlashWrite( MICO_PARTITION_PARAMETER_2, &crc_offset, (uint8_t *)&crc_target, CRC_SIZE );
-      require_noerr(err, exit);
-    }
+  if( err != kNoErr ){
+    para_log("Config read failed, restore to default settings!");
+    err = mico_system_context_restore( inContext );
+    require_noerr(err, exit);
   }
 
   para_log(" Config read, seed = %d!", inContext->flashContentInRam.micoSystemConfig.seed);
@@ -310,8 +286,6 @@ OSStatus MICOReadConfiguration(mico_Context_t *inContext)
   }
 
 exit: 
-  if( sys_backup_data!= NULL) free( sys_backup_data );
-  if( user_backup_data!= NULL) free( user_backup_data );
   return err;
 }
 
@@ -0,0 +1,492 @@
+/**
+******************************************************************************
+* @file    mico_system_profiler.c
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   Thread profiler: CPU cycles and context switches of each thread,
+*          counted at every context switch, and stack high-water marks.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+/* The kernel in the MICO library has no trace hooks, so the startup code's weak
+ * PendSV_Handler is replaced by one calling mico_profiler_switch_out() before
+ * the kernel's handler. At that point pxCurrentTCB is the thread leaving the
+ * CPU: the DWT cycles since the last switch are added to it, in a small hash
+ * table of MICO_PROFILER_THREAD_MAX threads. The cost is a fixed number of
+ * cycles per switch, itself counted and reported as the profiler overhead.
+ * Interrupts are accounted to the thread they interrupted.
+ *
+ * The library only exports the kernel's text thread list, vTaskList(): names,
+ * states, priorities and stack high-water marks are read from it, and cannot be
+ * matched to the thread handles, so the CPU usage is shown per handle. Neither
+ * does it tell which threads were deleted: when threads do not fit in the table,
+ * the slots of the threads without a switch since the last snapshot are given
+ * back, their cycles are then reported as retired.
+ *
+ * The MX1101 startup code points the PendSV vector to the kernel directly, there
+ * the cycles and switches stay at 0 while the stack marks still work.
+ */
+
+#include "Common.h"
+#include "Debug.h"
+#include "mico_rtos.h"
+#include "mico_config.h"
+
+#ifdef MICO_PROFILER_ENABLE
+
+#ifndef MICO_PROFILER_THREAD_MAX
+#define MICO_PROFILER_THREAD_MAX    (32)    /* Power of 2 */
+#endif
+
+#ifndef MICO_PROFILER_STACK_WARNING
+#define MICO_PROFILER_STACK_WARNING (128)   /* Threads with less free stack are flagged, bytes */
+#endif
+
+#define PROFILER_MASK               ( MICO_PROFILER_THREAD_MAX - 1 )
+#define PROFILER_HOME(tcb)          ( ( (uintptr_t)(tcb) >> 4 ) & PROFILER_MASK )
+#define PROFILER_LIST_LINE          (64)    /* "%-32s %c\t%u\t%u\t%u\r\n", names of 15 characters at most */
+
+#if ( MICO_PROFILER_THREAD_MAX & PROFILER_MASK )
+#error "MICO_PROFILER_THREAD_MAX must be a power of 2"
+#endif
+
+/* Cortex-M3/M4 cycle counter */
+#ifndef MICO_PROFILER_CYCLES
+#define DWT_CTRL                    ( *(volatile uint32_t *)0xE0001000 )
+#define DWT_CYCCNT                  ( *(volatile uint32_t *)0xE0001004 )
+#define CoreDebug_DEMCR             ( *(volatile uint32_t *)0xE000EDFC )
+#define MICO_PROFILER_CYCLES()      ( DWT_CYCCNT )
+#define MICO_PROFILER_CYCLES_INIT() do { CoreDebug_DEMCR |= ( 1UL << 24 ); DWT_CTRL |= 1UL; } while(0)
+#endif
+
+/* Holds PendSV, and so mico_profiler_switch_out(), while a thread reads or changes the table */
+#ifndef MICO_PROFILER_LOCK
+#include "mico_platform.h"
+#define MICO_PROFILER_LOCK()        DISABLE_INTERRUPTS
+#define MICO_PROFILER_UNLOCK()      ENABLE_INTERRUPTS
+#endif
+
+/* Exported by the kernel in the MICO library */
+extern void * volatile pxCurrentTCB;
+unsigned long uxTaskGetNumberOfTasks( void );
+void vTaskList( signed char *pcWriteBuffer );
+
+typedef struct
+{
+  void*       tcb;
+  uint32_t    switches;
+  uint32_t    since;      /* profiler_switches when the slot was taken */
+  uint32_t    mark;       /* switches at the last snapshot */
+  uint64_t    cycles;
+} profiler_slot_t;
+
+static profiler_slot_t profiler_slots[ MICO_PROFILER_THREAD_MAX ];
+static uint64_t profiler_cycles;
+static uint64_t profiler_overhead;
+static uint64_t profiler_untracked;
+static uint64_t profiler_untracked_mark;
+static uint64_t profiler_retired;
+static uint32_t profiler_switches;
+static uint32_t profiler_last;
+static uint32_t profiler_start_time;
+static volatile bool profiler_running = false;
+
+static profiler_slot_t* profiler_slot( void* tcb )
+{
+  uint32_t i, index = PROFILER_HOME( tcb );
+  profiler_slot_t* slot;
+
+  for ( i = 0; i < MICO_PROFILER_THREAD_MAX; i++ )
+  {
+    slot = &profiler_slots[ ( index + i ) & PROFILER_MASK ];
+    if ( slot->tcb == tcb ) return slot;
+    if ( slot->tcb == NULL )
+    {
+      slot->tcb = tcb;
+      slot->since = profiler_switches;
+      return slot;
+    }
+  }
+  return NULL;
+}
+
+/* Remove a slot, moving back the following ones that would not be found anymore. The table may be full. */
+static void profiler_slot_remove( uint32_t i )
+{
+  uint32_t j = i, home, k;
+
+  for ( k = 0; k < PROFILER_MASK; k++ )
+  {
+    j = ( j + 1 ) & PROFILER_MASK;
+    if ( profiler_slots[j].tcb == NULL ) break;
+    home = PROFILER_HOME( profiler_slots[j].tcb );
+    if ( ( ( j - home ) & PROFILER_MASK ) >= ( ( j - i ) & PROFILER_MASK ) )
+    {
+      profiler_slots[i] = profiler_slots[j];
+      i = j;
+    }
+  }
+  memset( &profiler_slots[i], 0, sizeof(profiler_slot_t) );
+}
+
+/* Add the cycles since the last switch to the running thread */
+static profiler_slot_t* profiler_account( uint32_t now )
+{
+  uint32_t delta = now - profiler_last;
+  profiler_slot_t* slot = profiler_slot( pxCurrentTCB );
+
+  profiler_cycles += delta;
+  if ( slot != NULL ) slot->cycles += delta;
+  else profiler_untracked += delta;
+  profiler_last = now;
+  return slot;
+}
+
+/* Called by PendSV_Handler, before the kernel switches out pxCurrentTCB */
+void mico_profiler_switch_out( void )
+{
+  uint32_t now;
+  profiler_slot_t* slot;
+
+  if ( profiler_running == false ) return;
+
+  now = MICO_PROFILER_CYCLES( );
+  slot = profiler_account( now );
+  if ( slot != NULL ) slot->switches++;
+  profiler_switches++;
+  profiler_overhead += MICO_PROFILER_CYCLES( ) - now;
+}
+
+/* r0-r3 and r12 are saved by the exception entry, r4-r11 by the C calling convention,
+   and lr keeps the exception return value the kernel's handler needs */
+#if defined ( __ICCARM__ )
+__stackless void PendSV_Handler( void )
+{
+  asm( "push {r0, lr}                 \n"
+       "bl   mico_profiler_switch_out \n"
+       "pop  {r0, lr}                 \n"
+       "b    xPortPendSVHandler       \n" );
+}
+#elif defined ( __CC_ARM ) //KEIL
+__asm void PendSV_Handler( void )
+{
+  extern mico_profiler_switch_out;
+  extern xPortPendSVHandler;
+  PRESERVE8
+
+  push {r0, lr}
+  bl   mico_profiler_switch_out
+  pop  {r0, lr}
+  b    xPortPendSVHandler
+}
+#elif defined ( __GNUC__ ) && defined ( __arm__ )
+__attribute__(( naked )) void PendSV_Handler( void )
+{
+  __asm volatile ( "push {r0, lr}                 \n"
+                   "bl   mico_profiler_switch_out \n"
+                   "pop  {r0, lr}                 \n"
+                   "b    xPortPendSVHandler       \n" );
+}
+#endif
+
+OSStatus mico_profiler_start( void )
+{
+  MICO_PROFILER_LOCK( );
+  MICO_PROFILER_CYCLES_INIT( );
+  memset( profiler_slots, 0, sizeof(profiler_slots) );
+  profiler_cycles = profiler_overhead = profiler_untracked = profiler_untracked_mark = profiler_retired = 0;
+  profiler_switches = 0;
+  profiler_start_time = mico_get_time( );
+  profiler_last = MICO_PROFILER_CYCLES( );
+  profiler_running = true;
+  MICO_PROFILER_UNLOCK( );
+  return kNoErr;
+}
+
+int mico_profiler_snapshot( mico_thread_stats_t* threads, int max_threads, mico_profiler_summary_t* summary )
+{
+  profiler_slot_t* slot;
+  uint32_t start = MICO_PROFILER_CYCLES( ), i;
+  int n = 0, count = 0;
+
+  MICO_PROFILER_LOCK( );
+
+  /* This thread is accounted up to now */
+  if ( profiler_running == true ) profiler_account( MICO_PROFILER_CYCLES( ) );
+
+  /* Some threads did not fit: give back the slots of those which did not run since the last snapshot,
+     deleted or waiting. They are counted again from their next switch. */
+  if ( profiler_untracked != profiler_untracked_mark )
+  {
+    for ( i = 0; i < MICO_PROFILER_THREAD_MAX; )
+    {
+      slot = &profiler_slots[i];
+      if ( slot->tcb != NULL && slot->tcb != pxCurrentTCB && slot->switches == slot->mark )
+      {
+        profiler_retired += slot->cycles;
+        profiler_slot_remove( i ); /* A following slot may have moved to i */
+        continue;
+      }
+      i++;
+    }
+    profiler_untracked_mark = profiler_untracked;
+  }
+
+  for ( i = 0; i < MICO_PROFILER_THREAD_MAX; i++ )
+  {
+    slot = &profiler_slots[i];
+    if ( slot->tcb == NULL ) continue;
+    slot->mark = slot->switches;
+    count++;
+    if ( threads != NULL && n < max_threads )
+    {
+      threads[n].thread = slot->tcb;
+      threads[n].since = slot->since;
+      threads[n].switches = slot->switches;
+      threads[n].cycles = slot->cycles;
+      n++;
+    }
+  }
+
+  if ( summary != NULL )
+  {
+    summary->time = mico_get_time( );
+    summary->switches = profiler_switches;
+    summary->cycles = profiler_cycles;
+    summary->overhead = profiler_overhead;
+    summary->untracked = profiler_untracked;
+    summary->retired = profiler_retired;
+    summary->thread_count = count;
+  }
+  MICO_PROFILER_UNLOCK( );
+
+  if ( summary != NULL ) summary->snapshot_cycles = MICO_PROFILER_CYCLES( ) - start;
+  return n;
+}
+
+int mico_profiler_stacks( mico_thread_stack_t* stacks, int max_stacks )
+{
+  char *list = NULL, *line, *end, *tab, *p;
+  unsigned long count;
+  int n = 0;
+  size_t len;
+
+  /* The kernel has no thread created meanwhile, as long as the scheduler is suspended */
+  while ( 1 )
+  {
+    count = uxTaskGetNumberOfTasks( ) + 4;
+    list = malloc( count * PROFILER_LIST_LINE + 3 );
+    require_action( list, exit, n = kNoMemoryErr );
+
+    mico_rtos_suspend_all_thread( );
+    if ( uxTaskGetNumberOfTasks( ) <= count ) break;
+    mico_rtos_resume_all_thread( );
+    free( list );
+  }
+  vTaskList( (signed char*)list );
+  mico_rtos_resume_all_thread( );
+
+  /* "\r\n", then "name padded to 32 state\tpriority\tstack free in words\tnumber\r\n" for each thread */
+  for ( line = list; *line != 0 && n < max_stacks; line = end )
+  {
+    end = strchr( line, '\n' );
+    end = ( end != NULL ) ? end + 1 : line + strlen( line );
+    tab = memchr( line, '\t', end - line );
+    if ( tab == NULL || tab - line < 2 ) continue;
+
+    for ( p = tab - 2; p > line && p[-1] == ' '; p-- );
+    len = Min( (size_t)( p - line ), sizeof(stacks[n].name) - 1 );
+    memcpy( stacks[n].name, line, len );
+    stacks[n].name[ len ] = 0;
+    stacks[n].state = tab[-1];
+    stacks[n].priority = (uint8_t)strtoul( tab, &p, 10 );
+    stacks[n].stack_free = strtoul( p, &p, 10 ) * sizeof(uint32_t);
+    n++;
+  }
+
+exit:
+  if ( list != NULL ) free( list );
+  return n;
+}
+
+/* "12.3%" */
+static char* profiler_percent( char* buffer, uint64_t part, uint64_t whole )
+{
+  uint32_t permille = ( whole != 0 ) ? (uint32_t)( part * 1000 / whole ) : 0;
+
+  if ( permille > 1000 ) permille = 1000;
+  sprintf( buffer, "%u.%u%%", (unsigned)( permille / 10 ), (unsigned)( permille % 10 ) );
+  return buffer;
+}
+
+/* printf may lack %llu */
+static char* profiler_u64( char* buffer, uint64_t value )
+{
+  char digits[ 21 ];
+  int i = sizeof(digits) - 1;
+
+  digits[ i ] = 0;
+  do {
+    digits[ --i ] = '0' + value % 10;
+    value /= 10;
+  } while ( value != 0 );
+  strcpy( buffer, &digits[ i ] );
+  return buffer;
+}
+
+OSStatus mico_profiler_top( mico_profiler_printf_t print, uint32_t interval_ms )
+{
+  OSStatus err = kNoErr;
+  mico_thread_stats_t* before = NULL;
+  mico_thread_stats_t* after = NULL;
+  mico_thread_stack_t* stacks = NULL;
+  mico_thread_stats_t swap;
+  mico_thread_stack_t swap_stack;
+  mico_profiler_summary_t first, last;
+  uint64_t cycles, per_ms;
+  uint32_t time;
+  char cpu[ 12 ], overhead[ 12 ];
+  int n = 0, m, s, i, j;
+
+  before = calloc( 2 * MICO_PROFILER_THREAD_MAX, sizeof(mico_thread_stats_t) );
+  require_action( before, exit, err = kNoMemoryErr );
+  after = before + MICO_PROFILER_THREAD_MAX;
+  stacks = calloc( MICO_PROFILER_THREAD_MAX, sizeof(mico_thread_stack_t) );
+  require_action( stacks, exit, err = kNoMemoryErr );
+
+  memset( &first, 0, sizeof(first) );
+  first.time = profiler_start_time;
+  if ( interval_ms != 0 )
+  {
+    n = mico_profiler_snapshot( before, MICO_PROFILER_THREAD_MAX, &first );
+    mico_thread_msleep( interval_ms );
+  }
+  m = mico_profiler_snapshot( after, MICO_PROFILER_THREAD_MAX, &last );
+
+  /* Counts over the interval, the busiest first. A slot given back and taken again restarts from 0. */
+  for ( i = 0; i < m; i++ )
+  {
+    for ( j = 0; j < n && ( before[j].thread != after[i].thread || before[j].since != after[i].since ); j++ );
+    if ( j < n )
+    {
+      after[i].cycles -= before[j].cycles;
+      after[i].switches -= before[j].switches;
+    }
+    for ( j = i; j > 0 && after[j].cycles > after[j - 1].cycles; j-- )
+    {
+      swap = after[j];
+      after[j] = after[j - 1];
+      after[j - 1] = swap;
+    }
+  }
+
+  s = mico_profiler_stacks( stacks, MICO_PROFILER_THREAD_MAX );
+  require_action( s >= 0, exit, err = s );
+
+  /* The closest to overflow first */
+  for ( i = 1; i < s; i++ )
+  {
+    for ( j = i; j > 0 && stacks[j].stack_free < stacks[j - 1].stack_free; j-- )
+    {
+      swap_stack = stacks[j];
+      stacks[j] = stacks[j - 1];
+      stacks[j - 1] = swap_stack;
+    }
+  }
+
+  cycles = last.cycles - first.cycles;
+  time = last.time - first.time;
+  if ( time == 0 ) time = 1;
+  per_ms = cycles / time;
+  if ( per_ms == 0 ) per_ms = 1;
+
+  print( "%d threads, %u ms, %u switches/s, profiler %s, snapshot %u us\r\n",
+         s, (unsigned)time, (unsigned)( (uint64_t)( last.switches - first.switches ) * 1000 / time ),
+         profiler_percent( overhead, last.overhead - first.overhead, cycles ),
+         (unsigned)( (uint64_t)last.snapshot_cycles * 1000 / per_ms ) );
+  print( "%-16s %6s %6s\r\n", "Thread", "CPU", "Sw/s" );
+  for ( i = 0; i < m; i++ )
+  {
+    print( "0x%08x%6s %6s %6u\r\n", (unsigned)(uintptr_t)after[i].thread, "",
+           profiler_percent( cpu, after[i].cycles, cycles ), (unsigned)( (uint64_t)after[i].switches * 1000 / time ) );
+  }
+  if ( last.untracked != first.untracked )
+    print( "%-16s %6s\r\n", "(untracked)", profiler_percent( cpu, last.untracked - first.untracked, cycles ) );
+
+  print( "%-16s %2s %4s %10s\r\n", "Name", "St", "Prio", "Stack free" );
+  for ( i = 0; i < s; i++ )
+  {
+    print( "%-16s %2c %4u %10u%s\r\n", stacks[i].name, stacks[i].state, (unsigned)stacks[i].priority,
+           (unsigned)stacks[i].stack_free, ( stacks[i].stack_free < MICO_PROFILER_STACK_WARNING ) ? " !" : "" );
+  }
+
+exit:
+  if ( before != NULL ) free( before );
+  if ( stacks != NULL ) free( stacks );
+  return err;
+}
+
+OSStatus mico_profiler_dump( mico_profiler_printf_t print )
+{
+  OSStatus err = kNoErr;
+  mico_thread_stats_t* threads = NULL;
+  mico_thread_stack_t* stacks = NULL;
+  mico_profiler_summary_t summary;
+  char cycles[ 21 ], overhead[ 21 ], untracked[ 21 ], retired[ 21 ];
+  int n, s, i;
+
+  threads = calloc( MICO_PROFILER_THREAD_MAX, sizeof(mico_thread_stats_t) );
+  require_action( threads, exit, err = kNoMemoryErr );
+  stacks = calloc( MICO_PROFILER_THREAD_MAX, sizeof(mico_thread_stack_t) );
+  require_action( stacks, exit, err = kNoMemoryErr );
+
+  n = mico_profiler_snapshot( threads, MICO_PROFILER_THREAD_MAX, &summary );
+  s = mico_profiler_stacks( stacks, MICO_PROFILER_THREAD_MAX );
+  require_action( s >= 0, exit, err = s );
+
+  print( "{\"time\":%u,\"cycles\":%s,\"overhead\":%s,\"untracked\":%s,\"retired\":%s,\"switches\":%u,\"snapshot\":%u,\"threads\":[",
+         (unsigned)summary.time, profiler_u64( cycles, summary.cycles ), profiler_u64( overhead, summary.overhead ),
+         profiler_u64( untracked, summary.untracked ), profiler_u64( retired, summary.retired ),
+         (unsigned)summary.switches, (unsigned)summary.snapshot_cycles );
+  for ( i = 0; i < n; i++ )
+  {
+    print( "%s{\"handle\":\"0x%08x\",\"cycles\":%s,\"switches\":%u}", ( i != 0 ) ? "," : "",
+           (unsigned)(uintptr_t)threads[i].thread, profiler_u64( cycles, threads[i].cycles ), (unsigned)threads[i].switches );
+  }
+  print( "],\"stacks\":[" );
+  for ( i = 0; i < s; i++ )
+  {
+    print( "%s{\"name\":\"%s\",\"state\":\"%c\",\"priority\":%u,\"stack_free\":%u}", ( i != 0 ) ? "," : "",
+           stacks[i].name, stacks[i].state, (unsigned)stacks[i].priority, (unsigned)stacks[i].stack_free );
+  }
+  print( "]}\r\n" );
+
+exit:
+  if ( threads != NULL ) free( threads );
+  if ( stacks != NULL ) free( stacks );
+  return err;
+}
+
+#endif /* MICO_PROFILER_ENABLE */
@@ -0,0 +1,520 @@
+/**
+******************************************************************************
+* @file    profiler-bench.c
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   Thread profiler tests on simulated context switches, and the cost
+*          of the switch hook and of a snapshot.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+/* Built on the host only: the kernel is replaced by the fake threads below, which call the PendSV hook
+ * mico_profiler_switch_out() as the scheduler would, and may preempt a snapshot unless it holds the lock. The
+ * mico_config.h of MICO/system/host counts fake cycles instead of DWT_CYCCNT:
+ *
+ *   cc -O2 -DDEBUG=0 -DPROFILER_BENCH_MAIN -IMICO/system/host -Iinclude MICO/system/profiler-bench.c \
+ *      MICO/system/mico_system_profiler.c -o profiler-bench && ./profiler-bench
+ */
+
+#include "Common.h"
+#include "Debug.h"
+#include "mico_rtos.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+
+#if( defined( PROFILER_BENCH_MAIN ) )
+
+#if( defined( __i386__ ) || defined( __x86_64__ ) )
+    #include <x86intrin.h>
+    #define profiler_bench_ticks()  ( (uint64_t) __rdtsc() )
+    #define kProfiler_BenchUnit     "cycles"
+#else
+    #include <time.h>
+    static uint64_t profiler_bench_ticks( void )
+    {
+        struct timespec     ts;
+
+        clock_gettime( CLOCK_MONOTONIC, &ts );
+        return( ( (uint64_t) ts.tv_sec * 1000000000 ) + ts.tv_nsec );
+    }
+    #define kProfiler_BenchUnit     "ns"
+#endif
+
+void mico_profiler_switch_out( void );
+
+//===========================================================================================================================
+//  Simulated kernel
+//===========================================================================================================================
+
+#define kProfiler_BenchThreads      40
+
+typedef struct
+{
+    char            name[ 16 ];
+    int             alive;
+    unsigned        priority;
+    unsigned        stack_high_water;   // Words
+    uint64_t        cycles;             // Expected
+    uint32_t        switches;           // Expected
+
+}   profiler_bench_thread_t;
+
+// TCBs 512 bytes apart share a hash slot: the threads collide by groups of 4, whose chains overlap.
+
+static uint8_t                  gProfiler_BenchTCBs[ 5 * 512 ] __attribute__(( aligned( 512 ) ));
+static profiler_bench_thread_t  gProfiler_BenchThreads[ kProfiler_BenchThreads ];
+static uint32_t                 gProfiler_BenchCycles;
+static int                      gProfiler_BenchRealCycles;
+static uint32_t                 gProfiler_BenchTime;
+static int                      gProfiler_BenchCurrent;
+static int                      gProfiler_BenchLocked;
+static int                      gProfiler_BenchLocks;
+static int                      gProfiler_BenchPreempt;
+static int                      gProfiler_BenchPending;
+static int                      gProfiler_BenchSwitching;
+void * volatile                 pxCurrentTCB;
+
+static void profiler_bench_preempt( void );
+
+static void * profiler_bench_tcb( int inThread )
+{
+    return( &gProfiler_BenchTCBs[ ( inThread % 4 ) * 512 + ( inThread / 4 ) * 80 ] );
+}
+
+// With gProfiler_BenchPreempt, PendSV comes at every cycle count read outside the hook: at once, or at the unlock.
+
+uint32_t profiler_bench_cycles( void )
+{
+    uint32_t        now = gProfiler_BenchRealCycles ? (uint32_t) profiler_bench_ticks() : gProfiler_BenchCycles;
+
+    if( gProfiler_BenchPreempt && !gProfiler_BenchSwitching )
+    {
+        if( gProfiler_BenchLocked ) gProfiler_BenchPending = 1;
+        else                        profiler_bench_preempt();
+    }
+    return( now );
+}
+
+void profiler_bench_lock( int inLock )
+{
+    require( gProfiler_BenchLocked != inLock, exit );
+    gProfiler_BenchLocked = inLock;
+    gProfiler_BenchLocks += inLock;
+    if( !inLock && gProfiler_BenchPending )
+    {
+        gProfiler_BenchPending = 0;
+        profiler_bench_preempt();
+    }
+
+exit:
+    return;
+}
+
+uint32_t mico_get_time( void )
+{
+    return( gProfiler_BenchTime );
+}
+
+unsigned long uxTaskGetNumberOfTasks( void )
+{
+    unsigned long       count = 0;
+    int                 i;
+
+    for( i = 0; i < kProfiler_BenchThreads; ++i ) count += gProfiler_BenchThreads[ i ].alive;
+    return( count );
+}
+
+// Same format as the kernel of the MICO library.
+
+void vTaskList( signed char *inBuffer )
+{
+    char *      p = (char *) inBuffer;
+    int         i;
+
+    p += sprintf( p, "\r\n" );
+    for( i = 0; i < kProfiler_BenchThreads; ++i )
+    {
+        if( !gProfiler_BenchThreads[ i ].alive ) continue;
+        p += sprintf( p, "%-32s %c\t%u\t%u\t%u\r\n", gProfiler_BenchThreads[ i ].name,
+                      ( i == gProfiler_BenchCurrent ) ? 'R' : 'B', gProfiler_BenchThreads[ i ].priority,
+                      gProfiler_BenchThreads[ i ].stack_high_water, i + 1 );
+    }
+}
+
+void vTaskSuspendAll( void )
+{
+}
+
+long xTaskResumeAll( void )
+{
+    return( 0 );
+}
+
+// Runs the current thread for inCycles then switches to inNext, as PendSV would.
+
+static void profiler_bench_run( int inNext, uint32_t inCycles )
+{
+    gProfiler_BenchCycles += inCycles;
+    gProfiler_BenchThreads[ gProfiler_BenchCurrent ].cycles += inCycles;
+    gProfiler_BenchThreads[ gProfiler_BenchCurrent ].switches++;
+    pxCurrentTCB = profiler_bench_tcb( gProfiler_BenchCurrent );
+    gProfiler_BenchSwitching = 1;
+    mico_profiler_switch_out();
+    gProfiler_BenchSwitching = 0;
+    gProfiler_BenchCurrent = inNext;
+    pxCurrentTCB = profiler_bench_tcb( inNext );
+}
+
+// Another thread runs, then the one preempted again.
+
+static void profiler_bench_preempt( void )
+{
+    int     current = gProfiler_BenchCurrent;
+
+    profiler_bench_run( ( current + 1 ) % 8, 100 );
+    profiler_bench_run( current, 300 );
+}
+
+// mico_profiler_top() sleeps between its snapshots: "busy" runs 3/4 of the time, "IDLE" the rest.
+
+static int      gProfiler_BenchBusy = -1;
+static int      gProfiler_BenchIdle = -1;
+
+void msleep( uint32_t inMs )
+{
+    uint32_t        i;
+
+    for( i = 0; i < inMs; ++i )
+    {
+        profiler_bench_run( gProfiler_BenchIdle, 75000 );
+        profiler_bench_run( gProfiler_BenchCurrent == gProfiler_BenchIdle ? gProfiler_BenchBusy : 0, 25000 );
+        gProfiler_BenchTime++;
+    }
+}
+
+static void profiler_bench_reset( int inCount )
+{
+    int     i;
+
+    memset( gProfiler_BenchThreads, 0, sizeof( gProfiler_BenchThreads ) );
+    for( i = 0; i < inCount; ++i )
+    {
+        snprintf( gProfiler_BenchThreads[ i ].name, sizeof( gProfiler_BenchThreads[ i ].name ), "thread %d", i );
+        gProfiler_BenchThreads[ i ].alive = 1;
+        gProfiler_BenchThreads[ i ].priority = i % 10;
+        gProfiler_BenchThreads[ i ].stack_high_water = 16 + i;
+    }
+    gProfiler_BenchCurrent = 0;
+    pxCurrentTCB = profiler_bench_tcb( 0 );
+    gProfiler_BenchRealCycles = 0;
+    mico_profiler_start();
+}
+
+//===========================================================================================================================
+//  profiler_bench_compare
+//===========================================================================================================================
+
+// The threads from inFirst to inLast must be counted exactly, the one running has no switch-out yet but its cycles.
+// Whatever the table holds, every cycle is in a thread, untracked or retired.
+
+static OSStatus profiler_bench_compare( int inFirst, int inLast )
+{
+    OSStatus                    err;
+    mico_thread_stats_t         threads[ kProfiler_BenchThreads ];
+    mico_profiler_summary_t     summary;
+    uint64_t                    cycles = 0;
+    int                         i, j, k, n, found = 0;
+
+    n = mico_profiler_snapshot( threads, kProfiler_BenchThreads, &summary );
+    require_action( n == summary.thread_count && n <= 32 && !gProfiler_BenchLocked, exit, err = kCountErr );
+    for( i = 0; i < n; ++i )
+    {
+        for( j = 0; j < kProfiler_BenchThreads && threads[ i ].thread != profiler_bench_tcb( j ); ++j );
+        require_action( j < kProfiler_BenchThreads, exit, err = kNotFoundErr );
+        for( k = 0; k < i; ++k ) require_action( threads[ k ].thread != threads[ i ].thread, exit, err = kDuplicateErr );
+        if( j >= inFirst && j < inLast )
+        {
+            require_action( threads[ i ].cycles == gProfiler_BenchThreads[ j ].cycles &&
+                            threads[ i ].switches == gProfiler_BenchThreads[ j ].switches, exit, err = kMismatchErr );
+            ++found;
+        }
+        cycles += threads[ i ].cycles;
+    }
+    require_action( found == inLast - inFirst, exit, err = kNotFoundErr );
+    require_action( cycles + summary.untracked + summary.retired == summary.cycles, exit, err = kRangeErr );
+    err = kNoErr;
+
+exit:
+    return( err );
+}
+//===========================================================================================================================
+//  profiler_account_test
+//===========================================================================================================================
+
+static OSStatus profiler_account_test( void )
+{
+    OSStatus                    err;
+    mico_thread_stats_t         threads[ kProfiler_BenchThreads ];
+    mico_profiler_summary_t     summary;
+    uint64_t                    expected, untracked, before[ kProfiler_BenchThreads ];
+    int                         i, j, n, next, count = 24;
+
+    // Random schedule over 24 threads, with collisions in the hash table.
+
+    srand( 1 );
+    profiler_bench_reset( count );
+    for( i = 0; i < 200000; ++i )
+    {
+        do next = rand() % count; while( next == gProfiler_BenchCurrent );
+        profiler_bench_run( next, 1 + rand() % 100000 );
+    }
+    err = profiler_bench_compare( 0, count );
+    require_noerr( err, exit );
+
+    // PendSV coming in the middle of snapshots: held until the unlock, the counts stay exact.
+
+    for( i = 0; i < 1000; ++i )
+    {
+        do next = rand() % count; while( next == gProfiler_BenchCurrent );
+        profiler_bench_run( next, 1 + rand() % 100000 );
+        gProfiler_BenchPreempt = 1;
+        mico_profiler_snapshot( threads, kProfiler_BenchThreads, &summary );
+        gProfiler_BenchPreempt = 0;
+        err = profiler_bench_compare( 0, count );
+        require_noerr( err, exit );
+    }
+    require_action( gProfiler_BenchLocks > 1000 && !gProfiler_BenchPending, exit, err = kStateErr );
+
+    // More threads than MICO_PROFILER_THREAD_MAX: the cycles of those not tracked are still in the total.
+
+    profiler_bench_reset( kProfiler_BenchThreads );
+    expected = 0;
+    for( i = 0; i < 100000; ++i )
+    {
+        profiler_bench_run( ( i + 1 ) % kProfiler_BenchThreads, 1000 );
+        expected += 1000;
+    }
+    err = profiler_bench_compare( 0, 32 );
+    require_noerr( err, exit );
+    mico_profiler_snapshot( NULL, 0, &summary );
+    require_action( summary.cycles == expected && summary.switches == 100000 && summary.untracked == 8 * 2500 * 1000 &&
+                    summary.retired == 0, exit, err = kMismatchErr );
+
+    // Threads 0 to 15 deleted, 32 to 39 still untracked: their slots are given back at the next snapshot, in the middle
+    // of collision chains, the others must still be found.
+
+    profiler_bench_run( 16, 1000 );
+    mico_profiler_snapshot( NULL, 0, &summary );
+    for( i = 0; i < 16; ++i ) gProfiler_BenchThreads[ i ].alive = 0;
+    for( i = 0; i < 2400; ++i ) profiler_bench_run( 16 + ( i + 1 ) % 24, 1000 );
+    err = profiler_bench_compare( 16, 32 );
+    require_noerr( err, exit );
+    mico_profiler_snapshot( NULL, 0, &summary );
+    for( i = 0, expected = 0; i < 16; ++i ) expected += gProfiler_BenchThreads[ i ].cycles;
+    require_action( summary.retired == expected && summary.thread_count == 16, exit, err = kMismatchErr );
+
+    // Threads 32 to 39 are counted from their next switch, nothing is untracked anymore.
+
+    for( i = 32; i < 40; ++i ) before[ i ] = gProfiler_BenchThreads[ i ].cycles;
+    untracked = summary.untracked;
+    for( i = 0; i < 2400; ++i ) profiler_bench_run( 16 + ( i + 1 ) % 24, 1000 );
+    n = mico_profiler_snapshot( threads, kProfiler_BenchThreads, &summary );
+    require_action( n == 24 && summary.untracked == untracked, exit, err = kCountErr );
+    for( i = 0; i < n; ++i )
+    {
+        for( j = 32; j < 40 && threads[ i ].thread != profiler_bench_tcb( j ); ++j );
+        if( j == 40 ) continue;
+        require_action( threads[ i ].since != 0 && threads[ i ].cycles == gProfiler_BenchThreads[ j ].cycles - before[ j ],
+                        exit, err = kMismatchErr );
+    }
+    err = profiler_bench_compare( 16, 32 );
+    require_noerr( err, exit );
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  profiler_print_test
+//===========================================================================================================================
+
+static char     gProfiler_BenchOutput[ 8192 ];
+static size_t   gProfiler_BenchOutputLen;
+
+static int profiler_bench_print( const char *inFormat, ... )
+{
+    va_list     args;
+    int         n;
+
+    va_start( args, inFormat );
+    n = vsnprintf( &gProfiler_BenchOutput[ gProfiler_BenchOutputLen ],
+                   sizeof( gProfiler_BenchOutput ) - gProfiler_BenchOutputLen, inFormat, args );
+    va_end( args );
+    if( n > 0 ) gProfiler_BenchOutputLen += n;
+    return( n );
+}
+
+static OSStatus profiler_print_test( void )
+{
+    OSStatus                err;
+    const char *            p;
+    char                    expected[ 128 ];
+    mico_thread_stack_t     stacks[ 8 ];
+    int                     n;
+
+    profiler_bench_reset( 6 );
+    strcpy( gProfiler_BenchThreads[ 1 ].name, "UART Recv" );
+    strcpy( gProfiler_BenchThreads[ 2 ].name, "mico_config_srv" );
+    strcpy( gProfiler_BenchThreads[ 4 ].name, "IDLE" );
+    strcpy( gProfiler_BenchThreads[ 5 ].name, "busy" );
+    gProfiler_BenchThreads[ 2 ].stack_high_water = 1000;
+    gProfiler_BenchThreads[ 5 ].stack_high_water = 10;
+    gProfiler_BenchIdle = 4;
+    gProfiler_BenchBusy = 5;
+    profiler_bench_run( 5, 1000 );
+
+    // The kernel's thread list, names with spaces or of 15 characters.
+
+    n = mico_profiler_stacks( stacks, 8 );
+    require_action( n == 6, exit, err = kCountErr );
+    require_action( strcmp( stacks[ 1 ].name, "UART Recv" ) == 0 && stacks[ 1 ].state == 'B' && stacks[ 1 ].priority == 1 &&
+                    stacks[ 1 ].stack_free == 17 * 4, exit, err = kMismatchErr );
+    require_action( strcmp( stacks[ 2 ].name, "mico_config_srv" ) == 0 && stacks[ 2 ].stack_free == 4000, exit,
+                    err = kMismatchErr );
+    require_action( strcmp( stacks[ 5 ].name, "busy" ) == 0 && stacks[ 5 ].state == 'R', exit, err = kMismatchErr );
+    require_action( mico_profiler_stacks( stacks, 2 ) == 2, exit, err = kSizeErr );
+
+    gProfiler_BenchOutputLen = 0;
+    err = mico_profiler_top( profiler_bench_print, 1000 );
+    require_noerr( err, exit );
+    printf( "%s", gProfiler_BenchOutput );
+
+    // Over the interval, busy runs 75% of the time and switches out 1000 times a second. Its stack is the lowest.
+
+    require_action( strncmp( gProfiler_BenchOutput, "6 threads, 1000 ms, 2000 switches/s, profiler 0.0%", 50 ) == 0, exit,
+                    err = kMismatchErr );
+    p = strstr( gProfiler_BenchOutput, "Sw/s\r\n" );
+    snprintf( expected, sizeof( expected ), "0x%08x        75.0%%   1000\r\n", (unsigned)(uintptr_t) profiler_bench_tcb( 5 ) );
+    require_action( p && strncmp( p + 6, expected, strlen( expected ) ) == 0, exit, err = kOrderErr );
+    p = strstr( gProfiler_BenchOutput, "Stack free\r\n" );
+    require_action( p && strncmp( p + 12, "busy              R    5         40 !\r\n", 39 ) == 0, exit, err = kOrderErr );
+    require_action( strstr( p, "mico_config_srv   B    2       4000\r\n" ) && strstr( p, "UART Recv" ), exit,
+                    err = kMismatchErr );
+
+    // The JSON counters are cumulated, 64-bit.
+
+    gProfiler_BenchOutputLen = 0;
+    err = mico_profiler_dump( profiler_bench_print );
+    require_noerr( err, exit );
+    require_action( strncmp( gProfiler_BenchOutput, "{\"time\":1000,\"cycles\":100001000,", 32 ) == 0, exit,
+                    err = kMismatchErr );
+    snprintf( expected, sizeof( expected ), "{\"handle\":\"0x%08x\",\"cycles\":75000000,\"switches\":1000}",
+              (unsigned)(uintptr_t) profiler_bench_tcb( 5 ) );
+    require_action( strstr( gProfiler_BenchOutput, expected ) &&
+                    strstr( gProfiler_BenchOutput, "{\"name\":\"busy\",\"state\":\"R\",\"priority\":5,\"stack_free\":40}" ),
+                    exit, err = kMismatchErr );
+    require_action( strcmp( &gProfiler_BenchOutput[ gProfiler_BenchOutputLen - 4 ], "]}\r\n" ) == 0, exit,
+                    err = kMismatchErr );
+
+    // Beyond 32 bits
+
+    profiler_bench_run( 4, 0xFFFFFFFFu );
+    profiler_bench_run( 5, 0xFFFFFFFFu );
+    profiler_bench_run( 4, 0xFFFFFFFFu );
+    profiler_bench_run( 5, 0xFFFFFFFFu );
+    snprintf( expected, sizeof( expected ), "\"cycles\":%llu,\"switches\":1002}",
+              (unsigned long long) gProfiler_BenchThreads[ 5 ].cycles );
+    gProfiler_BenchOutputLen = 0;
+    err = mico_profiler_dump( profiler_bench_print );
+    require_noerr( err, exit );
+    require_action( gProfiler_BenchThreads[ 5 ].cycles > 0xFFFFFFFFu && strstr( gProfiler_BenchOutput, expected ), exit,
+                    err = kMismatchErr );
+
+exit:
+    if( err ) printf( "%s", gProfiler_BenchOutput );
+    return( err );
+}
+
+//===========================================================================================================================
+//  profiler_bench
+//===========================================================================================================================
+
+int main( void )
+{
+    static const int            kCounts[] = { 2, 8, 32 };
+    OSStatus                    err;
+    mico_profiler_summary_t     summary;
+    uint64_t                    t;
+    int                         i, k, n, loops = 1000000;
+
+    err = profiler_account_test();
+    require_noerr( err, exit );
+    err = profiler_print_test();
+    require_noerr( err, exit );
+
+    // Cost of the hook per context switch, cycling over a number of threads, as timed around the calls and as
+    // the hook reports it to itself.
+
+    for( k = 0; k < (int)( sizeof( kCounts ) / sizeof( kCounts[ 0 ] ) ); ++k )
+    {
+        n = kCounts[ k ];
+        profiler_bench_reset( n );
+        gProfiler_BenchRealCycles = 1;
+        mico_profiler_start();
+        t = profiler_bench_ticks();
+        for( i = 0; i < loops; ++i )
+        {
+            pxCurrentTCB = profiler_bench_tcb( i % n );
+            mico_profiler_switch_out();
+        }
+        t = profiler_bench_ticks() - t;
+        mico_profiler_snapshot( NULL, 0, &summary );
+        printf( "switch hook, %2d threads: %6.1f %s/switch, %6.1f counted as overhead\n", n, (double) t / loops,
+                kProfiler_BenchUnit, (double) summary.overhead / loops );
+    }
+
+    profiler_bench_reset( 32 );
+    gProfiler_BenchRealCycles = 1;
+    t = profiler_bench_ticks();
+    for( i = 0; i < 10000; ++i ) mico_profiler_snapshot( NULL, 0, &summary );
+    printf( "snapshot, 32 threads:     %6.0f %s, PendSV held\n", (double)( profiler_bench_ticks() - t ) / 10000,
+            kProfiler_BenchUnit );
+
+    {
+        mico_thread_stack_t     stacks[ 32 ];
+
+        t = profiler_bench_ticks();
+        for( i = 0; i < 10000; ++i ) mico_profiler_stacks( stacks, 32 );
+        printf( "thread list, 32 threads:  %6.0f %s, without the stack scans of the kernel\n",
+                (double)( profiler_bench_ticks() - t ) / 10000, kProfiler_BenchUnit );
+    }
+
+exit:
+    printf( "profiler_bench: %s\n", !err ? "PASSED" : "FAILED" );
+    return( err ? 1 : 0 );
+}
+
+#endif // PROFILER_BENCH_MAIN
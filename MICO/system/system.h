@@ -34,6 +34,7 @@
 #include "common.h"
 #include "mico_rtos.h"
 #include "mico_wlan.h"
+#include "mico_platform.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -92,11 +93,32 @@ typedef struct  _boot_table_t {
   uint32_t length; // file real length
   uint8_t version[8];
   uint8_t type; // B:bootloader, P:boot_table, A:application, D: 8782 driver
-  uint8_t upgrade_type; //u:upgrade, 
+  uint8_t upgrade_type; //u:upgrade,
   uint16_t crc;
-  uint8_t reserved[4];
+  uint8_t slot; // Application slot booted, BOOT_SLOT_A or BOOT_SLOT_B
+  uint8_t trial; // Trial boots left, the bootloader clears one bit on every boot
+  uint8_t reserved[2];
 }boot_table_t;
 
+/* boot_table_t.upgrade_type */
+#define BOOT_UPGRADE            'U'   /**< Image at start_address is new, copied or booted on trial */
+#define BOOT_UPGRADE_TRIAL      'T'   /**< slot is booted on trial, rolled back when trial runs out */
+#define BOOT_UPGRADE_CONFIRMED  0x00  /**< slot is confirmed, cleared from BOOT_UPGRADE_TRIAL in place */
+#define BOOT_UPGRADE_DOWNLOAD   'P'   /**< OTA storage holds a partial download, kept to resume it */
+
+/* Application slots. Slot B is the OTA storage partition, only used on boards where
+   it is on the embedded flash and the application is linked to run from there */
+#define BOOT_SLOT_A             'A'   /**< MICO_PARTITION_APPLICATION */
+#define BOOT_SLOT_B             'B'   /**< MICO_PARTITION_OTA_TEMP */
+
+#ifndef BOOT_TRIAL_BOOTS
+#define BOOT_TRIAL_BOOTS        (3)   /**< Boots a new slot has to be confirmed in, 8 at most */
+#endif
+
+#ifndef BOOT_TRIAL_CONFIRM_TIME
+#define BOOT_TRIAL_CONFIRM_TIME (60*1000) /**< Time without system monitor failure to confirm a slot */
+#endif
+
 typedef struct _mico_sys_config_t
 {
   /*Device identification*/
@@ -200,6 +222,34 @@ OSStatus MICOReadConfiguration          ( system_context_t * const inContext );
 
 void mico_mfg_test( system_context_t * const inContext );
 
+/* Log-structured key/value store on MICO_PARTITION_PARAMETER_1/_2, see mico_system_kv.c */
+#define MICO_KV_PREAMBLE_SIZE   (0x20)  /**< Bytes at offset 0 of the first page kept out of the log (boot table) */
+
+#ifndef MICO_KV_MAX_KEYS
+#define MICO_KV_MAX_KEYS        (48)    /**< Size of the RAM index */
+#endif
+
+#define MICO_KV_KEY_COMMIT      (0xFFFE)
+#define MICO_KV_KEY_NONE        (0xFFFF)
+
+typedef struct _mico_kv_item_t {
+  uint16_t    key;
+  uint16_t    length;
+  const void *data;
+} mico_kv_item_t;
+
+OSStatus mico_kv_init           ( mico_partition_t page_1, mico_partition_t page_2 );
+
+OSStatus mico_kv_read           ( uint16_t key, void *data, uint16_t length );
+
+bool     mico_kv_match          ( uint16_t key, const void *data, uint16_t length );
+
+OSStatus mico_kv_write          ( const mico_kv_item_t *items, uint32_t count );
+
+OSStatus mico_kv_read_preamble  ( void *data, uint32_t length );
+
+OSStatus mico_kv_write_preamble ( const void *data, uint32_t length );
+
 
 #ifdef __cplusplus
 } /*extern "C" */
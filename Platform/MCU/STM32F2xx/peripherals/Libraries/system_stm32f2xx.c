@@ -137,8 +137,10 @@
 /*!< Uncomment the following line if you need to relocate your vector Table in
      Internal SRAM. */
 /* #define VECT_TAB_SRAM */
+#ifndef VECT_TAB_OFFSET
 #define VECT_TAB_OFFSET  0xC200 /*!< Vector Table base offset field. 
                                    This value must be a multiple of 0x200. */
+#endif
 		
 
   /* PLL_VCO = (HSE_VALUE or HSI_VALUE / PLL_M) * PLL_N */
@@ -234,7 +236,7 @@ void SystemInit(void)
 	NVIC_SetVectorTable(NVIC_VectTab_RAM, 0x0); 
 #else  /* VECT_TAB_FLASH  */
 	/* Set the Vector Table base location at 0x08000000 */ 
-	NVIC_SetVectorTable(NVIC_VectTab_FLASH, 0xc200);  
+	NVIC_SetVectorTable(NVIC_VectTab_FLASH, VECT_TAB_OFFSET);  
 #endif
 }
 
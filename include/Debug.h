@@ -32,22 +32,95 @@
 
 #define YesOrNo(x) (x ? "YES" : "NO")
 
+// ==== LOG LEVELS ====
+#define MICO_LOG_OFF    0
+#define MICO_LOG_ERR    1   // debug_print_assert, require_* failures
+#define MICO_LOG_WARN   2
+#define MICO_LOG_INFO   3   // custom_log
+#define MICO_LOG_DEBUG  4
+#define MICO_LOG_TRACE  5   // custom_log_trace
+
+// Logs above this level are compiled out, their arguments are not evaluated
+#ifndef MICO_LOG_STRIP_LEVEL
+    #define MICO_LOG_STRIP_LEVEL    MICO_LOG_TRACE
+#endif
+
+// Define MICO_LOG_DEFERRED to 1 with DEBUG to queue the logs as binary records, see mico_system_log.c.
+// They are formatted and printed by a low priority thread, or by the "log" command.
+#ifndef MICO_LOG_DEFERRED
+    #define MICO_LOG_DEFERRED       0
+#endif
+
 #if DEBUG
 #ifndef MICO_DISABLE_STDIO
 #ifndef NO_MICO_RTOS
    extern int mico_debug_enabled;
    extern mico_mutex_t stdio_tx_mutex;
 
-    #define custom_log(N, M, ...) do {if (mico_debug_enabled==0)break;\
-                                      mico_rtos_lock_mutex( &stdio_tx_mutex );\
-                                      printf("[%d][%s: %s:%4d] " M "\r\n", mico_get_time(), N, SHORT_FILE, __LINE__, ##__VA_ARGS__);\
-                                      mico_rtos_unlock_mutex( &stdio_tx_mutex );}while(0==1)
+#if MICO_LOG_DEFERRED
+    #define custom_log_level(L, N, M, ...) do {if ((L) > MICO_LOG_STRIP_LEVEL || mico_debug_enabled==0)break;\
+                                               mico_log_write(L, N, __FILE__, __LINE__, M, ##__VA_ARGS__);}while(0==1)
+
+    #define custom_log(N, M, ...) custom_log_level(MICO_LOG_INFO, N, M, ##__VA_ARGS__)
+
+    #define debug_print_assert(A,B,C,D,E,F) do {if (MICO_LOG_ERR > MICO_LOG_STRIP_LEVEL || mico_debug_enabled==0)break;\
+                                                 mico_log_write(MICO_LOG_ERR, "MICO", D, E, "%s() **ASSERT** %s", F, (C!=NULL) ? C : "" );}while(0==1)
+    #if TRACE
+        #define custom_log_trace(N) custom_log_level(MICO_LOG_TRACE, N, "[TRACE] %s()", __PRETTY_FUNCTION__)
+    #else  // !TRACE
+        #define custom_log_trace(N)
+    #endif // TRACE
+
+    /**
+      * @brief  Queue a log record: the format and the arguments are copied, strings included,
+      *         and formatted later by mico_log_drain(). It never blocks and can be called from
+      *         an interrupt. The record is dropped and counted if the ring is full.
+      * @param  level: MICO_LOG_ERR to MICO_LOG_TRACE, checked against the module level.
+      * @param  format: A printf format that stays valid, a string literal.
+      */
+    void mico_log_write( int level, const char *module, const char *file, int line, const char *format, ... );
+
+    typedef void (*mico_log_output_t)( const char *line, int len, void *arg );
+
+    /**
+      * @brief  Format and print the records queued, in order.
+      * @param  output: Called with each line, NULL to printf it.
+      * @param  max_records: 0 for all the records queued.
+      * @retval The number of records printed.
+      */
+    int mico_log_drain( mico_log_output_t output, void *arg, int max_records );
+
+    /* Set the level of a module, by the name given to custom_log, or of all modules if module is
+       NULL or "*". The modules levels are forgotten when the default level is set. */
+    OSStatus mico_log_set_level( const char *module, int level );
+    int mico_log_get_level( const char *module );
+
+    typedef struct
+    {
+        uint32_t    written;        // Records queued
+        uint32_t    dropped;        // Records lost because the ring was full
+        uint32_t    used;           // Bytes in the ring
+        uint32_t    high_water;     // Most bytes ever in the ring
+        uint32_t    size;           // MICO_LOG_RING_SIZE
+    } mico_log_stats_t;
+
+    void mico_log_get_stats( mico_log_stats_t *stats );
+
+    /* Start the thread that prints the records */
+    OSStatus mico_log_start( void );
+#else  // !MICO_LOG_DEFERRED
+    #define custom_log_level(L, N, M, ...) do {if ((L) > MICO_LOG_STRIP_LEVEL || mico_debug_enabled==0)break;\
+                                               mico_rtos_lock_mutex( &stdio_tx_mutex );\
+                                               printf("[%d][%s: %s:%4d] " M "\r\n", mico_get_time(), N, SHORT_FILE, __LINE__, ##__VA_ARGS__);\
+                                               mico_rtos_unlock_mutex( &stdio_tx_mutex );}while(0==1)
+
+    #define custom_log(N, M, ...) custom_log_level(MICO_LOG_INFO, N, M, ##__VA_ARGS__)
                                         
-    #define debug_print_assert(A,B,C,D,E,F) do {if (mico_debug_enabled==0)break;\
+    #define debug_print_assert(A,B,C,D,E,F) do {if (MICO_LOG_ERR > MICO_LOG_STRIP_LEVEL || mico_debug_enabled==0)break;\
                                                      mico_rtos_lock_mutex( &stdio_tx_mutex );\
                                                      printf("[%d][MICO:%s:%s:%4d] **ASSERT** %s""\r\n", mico_get_time(), D, F, E, (C!=NULL) ? C : "" );\
                                                      mico_rtos_unlock_mutex( &stdio_tx_mutex );}while(0==1)
-    #if TRACE
+    #if TRACE && ( MICO_LOG_TRACE <= MICO_LOG_STRIP_LEVEL )
         #define custom_log_trace(N) do {if (mico_debug_enabled==0)break;\
                                         mico_rtos_lock_mutex( &stdio_tx_mutex );\
                                         printf("[%s: [TRACE] %s] %s()\r\n", N, SHORT_FILE, __PRETTY_FUNCTION__);\
@@ -55,17 +128,23 @@
     #else  // !TRACE
         #define custom_log_trace(N)
     #endif // TRACE  
+#endif // MICO_LOG_DEFERRED
 #else // NO_MICO_RTOS  
-    #define custom_log(N, M, ...) do {printf("[%s: %s:%4d] " M "\r\n",  N, SHORT_FILE, __LINE__, ##__VA_ARGS__);}while(0==1)
+    #define custom_log_level(L, N, M, ...) do {if ((L) > MICO_LOG_STRIP_LEVEL)break;\
+                                               printf("[%s: %s:%4d] " M "\r\n",  N, SHORT_FILE, __LINE__, ##__VA_ARGS__);}while(0==1)
+
+    #define custom_log(N, M, ...) custom_log_level(MICO_LOG_INFO, N, M, ##__VA_ARGS__)
                                         
     #define debug_print_assert(A,B,C,D,E,F) do {printf("[MICO:%s:%s:%4d] **ASSERT** %s""\r\n", D, F, E, (C!=NULL) ? C : "" );}while(0==1)
-    #if TRACE
+    #if TRACE && ( MICO_LOG_TRACE <= MICO_LOG_STRIP_LEVEL )
         #define custom_log_trace(N) do {printf("[%s: [TRACE] %s] %s()\r\n", N, SHORT_FILE, __PRETTY_FUNCTION__);}while(0==1)
     #else  // !TRACE
         #define custom_log_trace(N)
     #endif // TRACE  
 #endif                                         
 #else
+    #define custom_log_level(L, N, M, ...)
+
     #define custom_log(N, M, ...)
 
     #define custom_log_trace(N)
@@ -74,6 +153,8 @@
 #endif   //MICO_DISABLE_STDIO                                      
 #else // DEBUG = 0
     // IF !DEBUG, make the logs NO-OP
+    #define custom_log_level(L, N, M, ...)
+
     #define custom_log(N, M, ...)
 
     #define custom_log_trace(N)
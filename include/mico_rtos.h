@@ -512,6 +512,100 @@ int UnSetTimer(void (*psysTimerHandler)(void));
 int mico_create_event_fd(mico_event handle);
 int mico_delete_event_fd(int fd);
 
+/**
+  * @}
+  */
+
+
+/** @defgroup MICO_RTOS_PROFILER MICO RTOS Thread Profiler Functions
+  * @brief    Per-thread CPU time, context switches and stack high-water marks.
+  *           Built with MICO_PROFILER_ENABLE, see mico_system_profiler.c.
+  * @{
+  */
+
+/** @brief CPU usage of a thread, cumulated since @ref mico_profiler_start */
+typedef struct
+{
+    mico_thread_t   thread;         /**< Thread handle, as set by mico_rtos_create_thread */
+    uint32_t        since;          /**< Total switches when the thread was first counted */
+    uint32_t        switches;       /**< Context switches out of the thread */
+    uint64_t        cycles;         /**< CPU cycles run by the thread, its interrupts included */
+} mico_thread_stats_t;
+
+/** @brief A thread of the kernel's thread list */
+typedef struct
+{
+    char            name[16];       /**< Thread name */
+    char            state;          /**< 'R' ready or running, 'B' blocked, 'S' suspended, 'D' deleted */
+    uint8_t         priority;       /**< Current priority, MICO_APPLICATION_PRIORITY is 7 */
+    uint32_t        stack_free;     /**< Least free stack ever, in bytes: the stack high-water mark */
+} mico_thread_stack_t;
+
+/** @brief Totals of a profiler snapshot */
+typedef struct
+{
+    uint32_t        time;           /**< mico_get_time() at the snapshot */
+    uint32_t        switches;       /**< Context switches of all the threads */
+    uint64_t        cycles;         /**< CPU cycles since @ref mico_profiler_start */
+    uint64_t        overhead;       /**< Cycles spent counting the context switches */
+    uint64_t        untracked;      /**< Cycles of the threads that did not fit in the table */
+    uint64_t        retired;        /**< Cycles of the threads whose slot was given back */
+    uint32_t        snapshot_cycles;/**< Cycles of the snapshot itself */
+    int             thread_count;   /**< Threads counted, some may not fit in the array */
+} mico_profiler_summary_t;
+
+typedef int (*mico_profiler_printf_t)( const char* format, ... );
+
+/**
+  * @brief    Start counting the CPU cycles and the context switches of every thread
+  *
+  * @return   kNoErr        : on success.
+  */
+OSStatus mico_profiler_start( void );
+
+/**
+  * @brief    Read the CPU usage of the threads counted, the context switches are held meanwhile
+  *
+  * @param    threads     : array filled with the threads, NULL to get the summary only
+  * @param    max_threads : size of the array
+  * @param    summary     : filled with the totals, may be NULL
+  *
+  * @return   The number of threads written to the array
+  */
+int mico_profiler_snapshot( mico_thread_stats_t* threads, int max_threads, mico_profiler_summary_t* summary );
+
+/**
+  * @brief    Read the names, states, priorities and stack high-water marks of the threads alive
+  *
+  * @param    stacks      : array filled with the threads
+  * @param    max_stacks  : size of the array
+  *
+  * @return   The number of threads written to the array, kNoMemoryErr if it failed
+  */
+int mico_profiler_stacks( mico_thread_stack_t* stacks, int max_stacks );
+
+/**
+  * @brief    Print the CPU usage of each thread over an interval, the busiest first,
+  *           then the stack high-water marks, the closest to overflow first
+  *
+  * @param    print       : printf, cli_printf...
+  * @param    interval_ms : 0 for the usage since @ref mico_profiler_start
+  *
+  * @return   kNoErr        : on success.
+  * @return   kNoMemoryErr  : if the snapshots could not be allocated
+  */
+OSStatus mico_profiler_top( mico_profiler_printf_t print, uint32_t interval_ms );
+
+/**
+  * @brief    Print the cumulated statistics as one line of JSON, to be diffed by a host tool
+  *
+  * @param    print       : printf, cli_printf...
+  *
+  * @return   kNoErr        : on success.
+  * @return   kNoMemoryErr  : if the snapshot could not be allocated
+  */
+OSStatus mico_profiler_dump( mico_profiler_printf_t print );
+
 /**
   * @}
   */
@@ -506,6 +506,28 @@ void mdns_update_txt_record( char *service_name, WiFi_Interface interface, char
   */
 void tftp_ota(void);
 
+/** @} */
+/*****************************************************************************/
+/** \defgroup http_ota Firmware Download From a HTTP Server
+  * @brief Download firmware to MICO_PARTITION_OTA_TEMP, flash is written while
+  *        the next block is received, an interrupted download is resumed by a
+  *        Range request, even after reboot.
+  * @{
+  */
+/*****************************************************************************/
+
+/**
+  * @brief  Download a firmware to MICO_PARTITION_OTA_TEMP
+  * @note   The boot table is not written, the caller fills it with outLength
+  *         and outCrc and calls mico_system_context_update( ) to upgrade.
+  * @param  url: "http://host[:port]/path" of the firmware.
+  * @param  md5: MD5 of the firmware in hex string, NULL or "" to skip the check.
+  * @param  outLength: Length of the firmware downloaded.
+  * @param  outCrc: CRC16 of the firmware downloaded.
+  * @retval kNoErr is returned on success, otherwise, kXXXErr is returned.
+  */
+OSStatus http_ota( const char *url, const char *md5, uint32_t *outLength, uint16_t *outCrc );
+
 /** @} */
 
 /** @} */
@@ -0,0 +1,942 @@
+/**
+******************************************************************************
+* @file    mqtt-bench.c
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   MQTT client tests against a stand-in broker on a local socket pair,
+*          and the cost of a publish.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+/* Built on the host only, with the real SocketUtils.c: the client talks to the broker below through a non-blocking
+ * AF_UNIX socket pair, and time only moves when a test says so. MICO/system/host holds the stub platform headers and
+ * a MICO.h for the host sockets:
+ *
+ *   cc -O2 -DDEBUG=1 -DMQTT_BENCH_MAIN -IMICO/system/host -Iinclude -Ilibraries/utilities -Ilibraries/protocols/mqtt \
+ *      libraries/protocols/mqtt/mqtt-bench.c libraries/protocols/mqtt/mqtt_client.c libraries/utilities/SocketUtils.c \
+ *      -o mqtt-bench && ./mqtt-bench
+ */
+
+#include "MICO.h"
+#include "SocketUtils.h"
+#include "mqtt_client.h"
+
+#include <stdio.h>
+
+#if( defined( MQTT_BENCH_MAIN ) )
+
+#include <fcntl.h>
+
+#if( defined( __i386__ ) || defined( __x86_64__ ) )
+    #include <x86intrin.h>
+    #define mqtt_bench_ticks()      ( (uint64_t) __rdtsc() )
+    #define kMQTT_BenchUnit         "cycles"
+#else
+    #include <time.h>
+    static uint64_t mqtt_bench_ticks( void )
+    {
+        struct timespec     ts;
+
+        clock_gettime( CLOCK_MONOTONIC, &ts );
+        return( ( (uint64_t) ts.tv_sec * 1000000000 ) + ts.tv_nsec );
+    }
+    #define kMQTT_BenchUnit         "ns"
+#endif
+
+#define kMQTT_BenchPacketMax        32768
+#define kMQTT_BenchQueueMax         128
+#define kMQTT_BenchStreamCount      64
+#define kMQTT_BenchStreamSize       1500
+
+//===========================================================================================================================
+//  RTOS calls on the host
+//===========================================================================================================================
+
+int                     mico_debug_enabled = 1;
+mico_mutex_t            stdio_tx_mutex;
+static uint32_t         gMQTT_BenchTime = 1000;
+
+uint32_t mico_get_time( void )
+{
+    return( gMQTT_BenchTime );
+}
+
+OSStatus mico_rtos_lock_mutex( mico_mutex_t *inMutex )
+{
+    (void) inMutex;
+    return( kNoErr );
+}
+
+OSStatus mico_rtos_unlock_mutex( mico_mutex_t *inMutex )
+{
+    (void) inMutex;
+    return( kNoErr );
+}
+
+int mico_delete_event_fd( int fd )
+{
+    (void) fd;
+    return( 0 );
+}
+
+//===========================================================================================================================
+//  Broker
+//===========================================================================================================================
+
+// The broker end of the socket pair. Bytes read are split into packets, kept in order until a test pops them.
+
+typedef struct
+{
+    uint8_t         header;
+    uint32_t        len;
+    uint8_t         body[ kMQTT_BenchPacketMax ];
+
+}   mqtt_bench_packet_t;
+
+static int                      gMQTT_BenchBrokerFd = -1;
+static uint8_t                  gMQTT_BenchRx[ 2 * kMQTT_BenchPacketMax ];
+static size_t                   gMQTT_BenchRxLen;
+static mqtt_bench_packet_t      gMQTT_BenchQueue[ kMQTT_BenchQueueMax ];
+static int                      gMQTT_BenchQueueHead;
+static int                      gMQTT_BenchQueueCount;            // Packets queued, popped ones included
+static int                      gMQTT_BenchReads;
+
+static void mqtt_bench_send( const void *inData, size_t inLen )
+{
+    const uint8_t *     p = (const uint8_t *) inData;
+    ssize_t             n;
+
+    while( inLen )
+    {
+        n = write( gMQTT_BenchBrokerFd, p, inLen );
+        if( n <= 0 ) continue;
+        p += n;
+        inLen -= n;
+    }
+}
+
+// PUBACK, PUBREC, PUBREL, PUBCOMP and UNSUBACK, with a packet id only.
+
+static void mqtt_bench_send_ack( uint8_t inHeader, uint16_t inPacketID )
+{
+    uint8_t const       ack[ 4 ] = { inHeader, 2, inPacketID >> 8, inPacketID & 0xFF };
+
+    mqtt_bench_send( ack, sizeof( ack ) );
+}
+
+// Reads what the socket holds, at most inMax bytes in one read if not 0, and queues the complete packets.
+
+static OSStatus mqtt_bench_broker_read( size_t inMax )
+{
+    OSStatus                err = kNoErr;
+    mqtt_bench_packet_t *   packet;
+    size_t                  want;
+    ssize_t                 n;
+    uint32_t                len;
+    int                     used;
+
+    for( ;; )
+    {
+        want = sizeof( gMQTT_BenchRx ) - gMQTT_BenchRxLen;
+        if( inMax && want > inMax ) want = inMax;
+        n = read( gMQTT_BenchBrokerFd, &gMQTT_BenchRx[ gMQTT_BenchRxLen ], want );
+        if( n <= 0 ) break;
+        gMQTT_BenchReads++;
+        gMQTT_BenchRxLen += n;
+        if( inMax || gMQTT_BenchRxLen == sizeof( gMQTT_BenchRx ) ) break;
+    }
+
+    while( gMQTT_BenchRxLen >= 2 )
+    {
+        used = mqtt_rem_len_decode( &gMQTT_BenchRx[ 1 ], gMQTT_BenchRxLen - 1, &len );
+        require_action( used >= 0 && len <= kMQTT_BenchPacketMax, exit, err = kMalformedErr );
+        if( used == 0 || 1 + used + len > gMQTT_BenchRxLen ) break;
+        require_action( gMQTT_BenchQueueCount < kMQTT_BenchQueueMax, exit, err = kNoSpaceErr );
+
+        packet = &gMQTT_BenchQueue[ gMQTT_BenchQueueCount++ ];
+        packet->header = gMQTT_BenchRx[ 0 ];
+        packet->len = len;
+        memcpy( packet->body, &gMQTT_BenchRx[ 1 + used ], len );
+        gMQTT_BenchRxLen -= 1 + used + len;
+        memmove( gMQTT_BenchRx, &gMQTT_BenchRx[ 1 + used + len ], gMQTT_BenchRxLen );
+    }
+
+exit:
+    return( err );
+}
+
+// The queue starts over once every packet is popped.
+
+static mqtt_bench_packet_t * mqtt_bench_broker_pop( void )
+{
+    if( gMQTT_BenchQueueHead == gMQTT_BenchQueueCount )
+    {
+        gMQTT_BenchQueueHead = 0;
+        gMQTT_BenchQueueCount = 0;
+        return( NULL );
+    }
+    return( &gMQTT_BenchQueue[ gMQTT_BenchQueueHead++ ] );
+}
+
+static int mqtt_bench_broker_queued( void )
+{
+    return( gMQTT_BenchQueueCount - gMQTT_BenchQueueHead );
+}
+
+static uint16_t mqtt_bench_ack_id( const mqtt_bench_packet_t *inPacket )
+{
+    return( ( inPacket->body[ 0 ] << 8 ) | inPacket->body[ 1 ] );
+}
+
+static uint16_t mqtt_bench_publish_id( const mqtt_bench_packet_t *inPacket )
+{
+    uint16_t const      topic_len = ( inPacket->body[ 0 ] << 8 ) | inPacket->body[ 1 ];
+
+    return( ( inPacket->body[ 2 + topic_len ] << 8 ) | inPacket->body[ 3 + topic_len ] );
+}
+
+//===========================================================================================================================
+//  Client
+//===========================================================================================================================
+
+static mqtt_client_t    gMQTT_BenchClient;
+static uint8_t          gMQTT_BenchTxBuf[ 1024 ];
+static uint8_t          gMQTT_BenchRxBuf[ 512 ];
+static int              gMQTT_BenchClientFd = -1;
+
+static int              gMQTT_BenchConnected;
+static int              gMQTT_BenchMessages;
+static int              gMQTT_BenchPublished;
+static int              gMQTT_BenchPublishErrors;
+static int              gMQTT_BenchSubscribed;
+static void *           gMQTT_BenchPublishedArg;
+static char             gMQTT_BenchTopic[ 64 ];
+static uint8_t          gMQTT_BenchPayload[ 64 ];
+static uint32_t         gMQTT_BenchPayloadLen;
+
+static void mqtt_bench_connected( mqtt_client_t *client, uint8_t return_code, bool session_present )
+{
+    (void) client; (void) session_present;
+    gMQTT_BenchConnected = return_code;
+}
+
+static void mqtt_bench_message( mqtt_client_t *client, const char *topic, uint16_t topic_len,
+                                const uint8_t *payload, uint32_t len, uint8_t qos, bool retain )
+{
+    (void) client; (void) qos; (void) retain;
+    gMQTT_BenchMessages++;
+    memcpy( gMQTT_BenchTopic, topic, Min( topic_len, sizeof( gMQTT_BenchTopic ) - 1 ) );
+    gMQTT_BenchTopic[ Min( topic_len, sizeof( gMQTT_BenchTopic ) - 1 ) ] = '\0';
+    gMQTT_BenchPayloadLen = len;
+    memcpy( gMQTT_BenchPayload, payload, Min( len, sizeof( gMQTT_BenchPayload ) ) );
+}
+
+static void mqtt_bench_published( mqtt_client_t *client, uint16_t packet_id, void *arg, OSStatus err )
+{
+    (void) client; (void) packet_id;
+    gMQTT_BenchPublished++;
+    gMQTT_BenchPublishedArg = arg;
+    if( err ) gMQTT_BenchPublishErrors++;
+}
+
+static void mqtt_bench_subscribed( mqtt_client_t *client, uint16_t packet_id, uint8_t return_code )
+{
+    (void) client; (void) packet_id;
+    gMQTT_BenchSubscribed = return_code;
+}
+
+// A new socket pair, and a client set up on it but not connected. inBufferSize shrinks the socket buffers.
+
+static OSStatus mqtt_bench_setup( uint16_t inKeepAlive, int inBufferSize )
+{
+    OSStatus                    err;
+    mqtt_client_config_t        config;
+    int                         fds[ 2 ];
+
+    if( gMQTT_BenchClientFd >= 0 ) close( gMQTT_BenchClientFd );
+    if( gMQTT_BenchBrokerFd >= 0 ) close( gMQTT_BenchBrokerFd );
+    err = socketpair( AF_UNIX, SOCK_STREAM, 0, fds );
+    require_noerr( err, exit );
+    gMQTT_BenchClientFd = fds[ 0 ];
+    gMQTT_BenchBrokerFd = fds[ 1 ];
+    if( inBufferSize )
+    {
+        setsockopt( gMQTT_BenchClientFd, SOL_SOCKET, SO_SNDBUF, &inBufferSize, sizeof( inBufferSize ) );
+        setsockopt( gMQTT_BenchBrokerFd, SOL_SOCKET, SO_RCVBUF, &inBufferSize, sizeof( inBufferSize ) );
+    }
+    fcntl( gMQTT_BenchClientFd, F_SETFL, O_NONBLOCK );
+    fcntl( gMQTT_BenchBrokerFd, F_SETFL, O_NONBLOCK );
+    gMQTT_BenchRxLen = 0;
+    gMQTT_BenchQueueHead = 0;
+    gMQTT_BenchQueueCount = 0;
+    gMQTT_BenchConnected = -1;
+    gMQTT_BenchSubscribed = -1;
+    gMQTT_BenchMessages = 0;
+    gMQTT_BenchPublished = 0;
+    gMQTT_BenchPublishErrors = 0;
+
+    memset( &config, 0, sizeof( config ) );
+    config.client_id = "dev1";
+    config.username = "u";
+    config.password = "pw";
+    config.keep_alive = inKeepAlive;
+    config.clean_session = true;
+    config.will_topic = "w";
+    config.will_msg = (const uint8_t *) "bye";
+    config.will_len = 3;
+    config.will_qos = 1;
+    config.tx_buf = gMQTT_BenchTxBuf;
+    config.tx_size = sizeof( gMQTT_BenchTxBuf );
+    config.rx_buf = gMQTT_BenchRxBuf;
+    config.rx_size = sizeof( gMQTT_BenchRxBuf );
+    config.callbacks.connected = mqtt_bench_connected;
+    config.callbacks.message = mqtt_bench_message;
+    config.callbacks.published = mqtt_bench_published;
+    config.callbacks.subscribed = mqtt_bench_subscribed;
+    err = mqtt_client_init( &gMQTT_BenchClient, &config );
+
+exit:
+    return( err );
+}
+
+// CONNECT with every flag set, accepted by the broker.
+
+static OSStatus mqtt_bench_connect( void )
+{
+    OSStatus                err;
+    mqtt_bench_packet_t *   packet;
+    uint8_t const           connack[ 4 ] = { 0x20, 2, 0, 0 };
+
+    err = mqtt_client_connect( &gMQTT_BenchClient, gMQTT_BenchClientFd );
+    require_noerr( err, exit );
+    err = mqtt_bench_broker_read( 0 );
+    require_noerr( err, exit );
+    packet = mqtt_bench_broker_pop();
+    require_action( packet && packet->header == 0x10, exit, err = kMalformedErr );
+    require_action( memcmp( packet->body, "\0\4MQTT\4", 7 ) == 0 && packet->body[ 7 ] == 0xCE &&
+                    packet->body[ 9 ] == ( gMQTT_BenchClient.config.keep_alive & 0xFF ), exit, err = kMalformedErr );
+
+    mqtt_bench_send( connack, sizeof( connack ) );
+    err = mqtt_client_process( &gMQTT_BenchClient );
+    require_noerr( err, exit );
+    require_action( gMQTT_BenchConnected == 0 && gMQTT_BenchClient.state == MQTT_STATE_CONNECTED, exit, err = kStateErr );
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  mqtt_rem_len_test
+//===========================================================================================================================
+
+static OSStatus mqtt_rem_len_test( void )
+{
+    static const uint32_t   kValues[]   = { 0, 127, 128, 16383, 16384, 2097151, 2097152, MQTT_REM_LEN_MAX };
+    static const int        kSizes[]    = { 1, 1,   2,   2,     3,     3,       4,       4 };
+    uint8_t const           malformed[ 5 ] = { 0xFF, 0xFF, 0xFF, 0xFF, 0x01 };
+    OSStatus                err = kNoErr;
+    uint8_t                 buf[ 4 ];
+    uint32_t                len;
+    int                     i;
+
+    for( i = 0; i < (int)( sizeof( kValues ) / sizeof( kValues[ 0 ] ) ); ++i )
+    {
+        require_action( mqtt_rem_len_encode( buf, kValues[ i ] ) == kSizes[ i ], exit, err = kSizeErr );
+        require_action( mqtt_rem_len_decode( buf, kSizes[ i ], &len ) == kSizes[ i ] && len == kValues[ i ], exit,
+                        err = kMismatchErr );
+        require_action( mqtt_rem_len_decode( buf, kSizes[ i ] - 1, &len ) == 0, exit, err = kMismatchErr );
+    }
+    require_action( mqtt_rem_len_encode( buf, MQTT_REM_LEN_MAX + 1 ) == 0, exit, err = kRangeErr );
+    require_action( mqtt_rem_len_decode( malformed, sizeof( malformed ), &len ) == -1, exit, err = kMalformedErr );
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  mqtt_coalesce_test
+//===========================================================================================================================
+
+// Short QoS 0 publishes are copied to the tx buffer and reach the broker in one write.
+
+static OSStatus mqtt_coalesce_test( void )
+{
+    OSStatus                err;
+    mqtt_bench_packet_t *   packet;
+    int                     i;
+
+    err = mqtt_bench_setup( 0, 0 );
+    require_noerr( err, exit );
+    err = mqtt_bench_connect();
+    require_noerr( err, exit );
+
+    for( i = 0; i < 10; ++i )
+    {
+        err = mqtt_client_publish( &gMQTT_BenchClient, "s/t", (const uint8_t *) "0123456789", 10, 0, false, NULL, NULL );
+        require_noerr( err, exit );
+    }
+    require_action( gMQTT_BenchPublished == 10 && gMQTT_BenchClient.tx_vec_count == 1, exit, err = kCountErr );
+    err = mqtt_client_process( &gMQTT_BenchClient );
+    require_noerr( err, exit );
+    require_action( !mqtt_client_want_write( &gMQTT_BenchClient ), exit, err = kStateErr );
+
+    gMQTT_BenchReads = 0;
+    err = mqtt_bench_broker_read( 0 );
+    require_noerr( err, exit );
+    require_action( mqtt_bench_broker_queued() == 10 && gMQTT_BenchReads == 1, exit, err = kCountErr );
+    for( i = 0; i < 10; ++i )
+    {
+        packet = mqtt_bench_broker_pop();
+        require_action( packet->header == 0x30 && packet->len == 2 + 3 + 10 &&
+                        memcmp( &packet->body[ 5 ], "0123456789", 10 ) == 0, exit, err = kMismatchErr );
+    }
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  mqtt_qos1_test
+//===========================================================================================================================
+
+// A long payload is sent from the caller's buffer, and again with DUP when the PUBACK does not come in time.
+
+static OSStatus mqtt_qos1_test( void )
+{
+    static uint8_t          payload[ 30000 ];
+    OSStatus                err;
+    mqtt_bench_packet_t *   packet;
+    uint16_t                id;
+    int                     i, zero_copy = 0;
+
+    err = mqtt_bench_setup( 0, 0 );
+    require_noerr( err, exit );
+    err = mqtt_bench_connect();
+    require_noerr( err, exit );
+
+    for( i = 0; i < (int) sizeof( payload ); ++i ) payload[ i ] = (uint8_t)( i * 7 );
+    err = mqtt_client_publish( &gMQTT_BenchClient, "big/topic", payload, sizeof( payload ), 1, false, (void *) payload, &id );
+    require_noerr( err, exit );
+    require_action( id != 0, exit, err = kValueErr );
+    for( i = 0; i < gMQTT_BenchClient.tx_vec_count; ++i )
+        if( gMQTT_BenchClient.tx_vec[ i ].buf == payload ) zero_copy = 1;
+    require_action( zero_copy, exit, err = kMismatchErr );
+
+    for( i = 0; i < 100 && ( mqtt_client_want_write( &gMQTT_BenchClient ) || mqtt_bench_broker_queued() == 0 ); ++i )
+    {
+        err = mqtt_client_process( &gMQTT_BenchClient );
+        require_noerr( err, exit );
+        err = mqtt_bench_broker_read( 0 );
+        require_noerr( err, exit );
+    }
+    packet = mqtt_bench_broker_pop();
+    require_action( packet && packet->header == 0x32 && packet->len == 2 + 9 + 2 + sizeof( payload ) &&
+                    memcmp( &packet->body[ 13 ], payload, sizeof( payload ) ) == 0 && mqtt_bench_publish_id( packet ) == id,
+                    exit, err = kMismatchErr );
+
+    // The PUBACK is lost
+
+    gMQTT_BenchTime += MQTT_CLIENT_RETRY_MS - 1;
+    err = mqtt_client_process( &gMQTT_BenchClient );
+    require_noerr( err, exit );
+    err = mqtt_bench_broker_read( 0 );
+    require_noerr( err, exit );
+    require_action( mqtt_bench_broker_queued() == 0, exit, err = kUnexpectedErr );
+
+    gMQTT_BenchTime += 1;
+    for( i = 0; i < 100 && ( i == 0 || mqtt_client_want_write( &gMQTT_BenchClient ) ); ++i )
+    {
+        err = mqtt_client_process( &gMQTT_BenchClient );
+        require_noerr( err, exit );
+        err = mqtt_bench_broker_read( 0 );
+        require_noerr( err, exit );
+    }
+    packet = mqtt_bench_broker_pop();
+    require_action( packet && packet->header == 0x3A && mqtt_bench_publish_id( packet ) == id &&
+                    memcmp( &packet->body[ 13 ], payload, sizeof( payload ) ) == 0, exit, err = kMismatchErr );
+    require_action( gMQTT_BenchPublished == 0, exit, err = kStateErr );
+
+    // Acknowledged once, a second PUBACK is ignored
+
+    mqtt_bench_send_ack( 0x40, id );
+    err = mqtt_client_process( &gMQTT_BenchClient );
+    require_noerr( err, exit );
+    require_action( gMQTT_BenchPublished == 1 && gMQTT_BenchPublishedArg == payload, exit, err = kStateErr );
+    mqtt_bench_send_ack( 0x40, id );
+    err = mqtt_client_process( &gMQTT_BenchClient );
+    require_noerr( err, exit );
+    require_action( gMQTT_BenchPublished == 1, exit, err = kDuplicateErr );
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  mqtt_qos2_test
+//===========================================================================================================================
+
+// QoS 2 both ways: a lost PUBCOMP gets the PUBREL again, a message received twice before its PUBREL is delivered once.
+
+static OSStatus mqtt_qos2_test( void )
+{
+    OSStatus                err;
+    mqtt_bench_packet_t *   packet;
+    uint8_t                 publish[] = { 0x34, 2 + 5 + 2 + 3, 0, 5, 'c', 'm', 'd', '/', 'a', 0, 7, 'o', 'n', '!' };
+    uint8_t                 suback[ 5 ] = { 0x90, 3, 0, 0, 1 };
+    uint16_t                id;
+
+    err = mqtt_bench_setup( 0, 0 );
+    require_noerr( err, exit );
+    err = mqtt_bench_connect();
+    require_noerr( err, exit );
+
+    err = mqtt_client_publish( &gMQTT_BenchClient, "q2", (const uint8_t *) "hello", 5, 2, true, NULL, &id );
+    require_noerr( err, exit );
+    err = mqtt_client_process( &gMQTT_BenchClient );
+    require_noerr( err, exit );
+    err = mqtt_bench_broker_read( 0 );
+    require_noerr( err, exit );
+    packet = mqtt_bench_broker_pop();
+    require_action( packet && packet->header == 0x35 && mqtt_bench_publish_id( packet ) == id, exit, err = kMismatchErr );
+
+    mqtt_bench_send_ack( 0x50, id );
+    err = mqtt_client_process( &gMQTT_BenchClient );
+    require_noerr( err, exit );
+    err = mqtt_bench_broker_read( 0 );
+    require_noerr( err, exit );
+    packet = mqtt_bench_broker_pop();
+    require_action( packet && packet->header == 0x62 && packet->len == 2 && mqtt_bench_ack_id( packet ) == id, exit,
+                    err = kMismatchErr );
+
+    gMQTT_BenchTime += MQTT_CLIENT_RETRY_MS;
+    err = mqtt_client_process( &gMQTT_BenchClient );
+    require_noerr( err, exit );
+    err = mqtt_bench_broker_read( 0 );
+    require_noerr( err, exit );
+    packet = mqtt_bench_broker_pop();
+    require_action( packet && packet->header == 0x62 && gMQTT_BenchPublished == 0, exit, err = kMismatchErr );
+    mqtt_bench_send_ack( 0x70, id );
+    err = mqtt_client_process( &gMQTT_BenchClient );
+    require_noerr( err, exit );
+    require_action( gMQTT_BenchPublished == 1 && gMQTT_BenchPublishErrors == 0, exit, err = kStateErr );
+
+    // Incoming, after a SUBSCRIBE
+
+    err = mqtt_client_subscribe( &gMQTT_BenchClient, "cmd/#", 2, &id );
+    require_noerr( err, exit );
+    err = mqtt_client_process( &gMQTT_BenchClient );
+    require_noerr( err, exit );
+    err = mqtt_bench_broker_read( 0 );
+    require_noerr( err, exit );
+    packet = mqtt_bench_broker_pop();
+    require_action( packet && packet->header == 0x82 && packet->len == 2 + 2 + 5 + 1 && packet->body[ 9 ] == 2, exit,
+                    err = kMismatchErr );
+    suback[ 2 ] = id >> 8;
+    suback[ 3 ] = id & 0xFF;
+    mqtt_bench_send( suback, sizeof( suback ) );
+    err = mqtt_client_process( &gMQTT_BenchClient );
+    require_noerr( err, exit );
+    require_action( gMQTT_BenchSubscribed == 1, exit, err = kStateErr );
+
+    mqtt_bench_send( publish, sizeof( publish ) );
+    err = mqtt_client_process( &gMQTT_BenchClient );
+    require_noerr( err, exit );
+    publish[ 0 ] |= 0x08;
+    mqtt_bench_send( publish, sizeof( publish ) );
+    err = mqtt_client_process( &gMQTT_BenchClient );
+    require_noerr( err, exit );
+    require_action( gMQTT_BenchMessages == 1 && strcmp( gMQTT_BenchTopic, "cmd/a" ) == 0 && gMQTT_BenchPayloadLen == 3 &&
+                    memcmp( gMQTT_BenchPayload, "on!", 3 ) == 0, exit, err = kMismatchErr );
+    err = mqtt_bench_broker_read( 0 );
+    require_noerr( err, exit );
+    packet = mqtt_bench_broker_pop();
+    require_action( packet && packet->header == 0x50, exit, err = kMismatchErr );
+    packet = mqtt_bench_broker_pop();
+    require_action( packet && packet->header == 0x50, exit, err = kMismatchErr );
+
+    mqtt_bench_send_ack( 0x62, 7 );
+    err = mqtt_client_process( &gMQTT_BenchClient );
+    require_noerr( err, exit );
+    err = mqtt_bench_broker_read( 0 );
+    require_noerr( err, exit );
+    packet = mqtt_bench_broker_pop();
+    require_action( packet && packet->header == 0x70, exit, err = kMismatchErr );
+
+    // After the PUBREL the same id is a new message
+
+    publish[ 0 ] = 0x34;
+    mqtt_bench_send( publish, sizeof( publish ) );
+    err = mqtt_client_process( &gMQTT_BenchClient );
+    require_noerr( err, exit );
+    require_action( gMQTT_BenchMessages == 2, exit, err = kCountErr );
+
+    err = mqtt_client_unsubscribe( &gMQTT_BenchClient, "cmd/#", &id );
+    require_noerr( err, exit );
+    err = mqtt_client_process( &gMQTT_BenchClient );
+    require_noerr( err, exit );
+    err = mqtt_bench_broker_read( 0 );
+    require_noerr( err, exit );
+    packet = mqtt_bench_broker_pop();
+    require_action( packet && packet->header == 0x50, exit, err = kMismatchErr );
+    packet = mqtt_bench_broker_pop();
+    require_action( packet && packet->header == 0xA2, exit, err = kMismatchErr );
+    gMQTT_BenchSubscribed = -1;
+    mqtt_bench_send_ack( 0xB0, id );
+    err = mqtt_client_process( &gMQTT_BenchClient );
+    require_noerr( err, exit );
+    require_action( gMQTT_BenchSubscribed == 0, exit, err = kStateErr );
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  mqtt_oversize_test
+//===========================================================================================================================
+
+// A packet bigger than rx_buf is skipped, the next one is read.
+
+static OSStatus mqtt_oversize_test( void )
+{
+    static uint8_t          huge[ 2000 ];
+    uint8_t const           small[] = { 0x30, 2 + 1 + 2, 0, 1, 'y', 'o', 'k' };
+    OSStatus                err;
+    int                     n, i;
+
+    err = mqtt_bench_setup( 0, 0 );
+    require_noerr( err, exit );
+    err = mqtt_bench_connect();
+    require_noerr( err, exit );
+
+    huge[ 0 ] = 0x30;
+    n = mqtt_rem_len_encode( &huge[ 1 ], sizeof( huge ) - 3 );
+    huge[ 1 + n ] = 0;
+    huge[ 2 + n ] = 1;
+    huge[ 3 + n ] = 'x';
+    mqtt_bench_send( huge, 1 + n + sizeof( huge ) - 3 );
+    mqtt_bench_send( small, sizeof( small ) );
+    for( i = 0; i < 10; ++i )
+    {
+        err = mqtt_client_process( &gMQTT_BenchClient );
+        require_noerr( err, exit );
+    }
+    require_action( gMQTT_BenchMessages == 1 && strcmp( gMQTT_BenchTopic, "y" ) == 0, exit, err = kMismatchErr );
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  mqtt_timeout_test
+//===========================================================================================================================
+
+static OSStatus mqtt_timeout_test( void )
+{
+    OSStatus                err;
+    mqtt_bench_packet_t *   packet;
+    uint8_t const           pingresp[ 2 ] = { 0xD0, 0 };
+    uint8_t const           refused[ 4 ] = { 0x20, 2, 0, 5 };
+    int                     i;
+
+    // Keep alive, then a PINGRESP that never comes
+
+    err = mqtt_bench_setup( 30, 0 );
+    require_noerr( err, exit );
+    err = mqtt_bench_connect();
+    require_noerr( err, exit );
+    gMQTT_BenchTime += 30000;
+    err = mqtt_client_process( &gMQTT_BenchClient );
+    require_noerr( err, exit );
+    err = mqtt_bench_broker_read( 0 );
+    require_noerr( err, exit );
+    packet = mqtt_bench_broker_pop();
+    require_action( packet && packet->header == 0xC0, exit, err = kMismatchErr );
+    mqtt_bench_send( pingresp, sizeof( pingresp ) );
+    err = mqtt_client_process( &gMQTT_BenchClient );
+    require_noerr( err, exit );
+    require_action( !gMQTT_BenchClient.ping_outstanding, exit, err = kStateErr );
+
+    gMQTT_BenchTime += 30000;
+    err = mqtt_client_process( &gMQTT_BenchClient );
+    require_noerr( err, exit );
+    gMQTT_BenchTime += MQTT_CLIENT_RESPONSE_TIMEOUT;
+    require_action( mqtt_client_process( &gMQTT_BenchClient ) == kTimeoutErr, exit, err = kStateErr );
+
+    // Retransmits run out
+
+    err = mqtt_bench_setup( 0, 0 );
+    require_noerr( err, exit );
+    err = mqtt_bench_connect();
+    require_noerr( err, exit );
+    err = mqtt_client_publish( &gMQTT_BenchClient, "t", (const uint8_t *) "x", 1, 1, false, NULL, NULL );
+    require_noerr( err, exit );
+    for( i = 0; i < 1000 && err == kNoErr; ++i )
+    {
+        gMQTT_BenchTime += 1000;
+        err = mqtt_client_process( &gMQTT_BenchClient );
+        mqtt_bench_broker_read( 0 );
+    }
+    require_action( err == kTimeoutErr && mqtt_bench_broker_queued() == 1 + MQTT_CLIENT_RETRY_MAX, exit, err = kCountErr );
+
+    // Refused, and closed by the broker
+
+    err = mqtt_bench_setup( 0, 0 );
+    require_noerr( err, exit );
+    err = mqtt_client_connect( &gMQTT_BenchClient, gMQTT_BenchClientFd );
+    require_noerr( err, exit );
+    mqtt_bench_send( refused, sizeof( refused ) );
+    require_action( mqtt_client_process( &gMQTT_BenchClient ) == kAuthenticationErr, exit, err = kStateErr );
+
+    err = mqtt_bench_setup( 0, 0 );
+    require_noerr( err, exit );
+    err = mqtt_bench_connect();
+    require_noerr( err, exit );
+    close( gMQTT_BenchBrokerFd );
+    gMQTT_BenchBrokerFd = -1;
+    require_action( mqtt_client_process( &gMQTT_BenchClient ) == kConnectionErr, exit, err = kStateErr );
+    err = kNoErr;
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  mqtt_offline_test
+//===========================================================================================================================
+
+// QoS 1 and 2 messages published while disconnected are sent after the CONNACK, QoS 0 ones are refused.
+
+static OSStatus mqtt_offline_test( void )
+{
+    OSStatus                err;
+    mqtt_bench_packet_t *   packet;
+    uint16_t                id;
+
+    err = mqtt_bench_setup( 0, 0 );
+    require_noerr( err, exit );
+    require_action( mqtt_client_publish( &gMQTT_BenchClient, "t", (const uint8_t *) "x", 1, 0, false, NULL, NULL ) ==
+                    kStateErr, exit, err = kStateErr );
+    err = mqtt_client_publish( &gMQTT_BenchClient, "off/line", (const uint8_t *) "queued", 6, 1, false, NULL, &id );
+    require_noerr( err, exit );
+
+    err = mqtt_bench_connect();
+    require_noerr( err, exit );
+    err = mqtt_bench_broker_read( 0 );
+    require_noerr( err, exit );
+    packet = mqtt_bench_broker_pop();
+    require_action( packet && packet->header == 0x32 && mqtt_bench_publish_id( packet ) == id, exit, err = kMismatchErr );
+    mqtt_bench_send_ack( 0x40, id );
+    err = mqtt_client_process( &gMQTT_BenchClient );
+    require_noerr( err, exit );
+    require_action( gMQTT_BenchPublished == 1, exit, err = kStateErr );
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  mqtt_stream_test
+//===========================================================================================================================
+
+// Messages of every QoS through a 4 KB socket buffer and a broker reading 700 bytes at a time: the tx queue and the
+// inflight window fill up, every message arrives once, in order and intact.
+
+static OSStatus mqtt_stream_test( int print )
+{
+    static uint8_t          payloads[ kMQTT_BenchStreamCount ][ kMQTT_BenchStreamSize ];
+    static char             topics[ kMQTT_BenchStreamCount ][ 24 ];
+    OSStatus                err;
+    mqtt_bench_packet_t *   packet;
+    uint16_t                ids[ kMQTT_BenchStreamCount ];
+    uint16_t                topic_len;
+    uint32_t                offset, len;
+    uint8_t                 qos;
+    int                     i, k, step, next = 0, received = 0, would_block = 0, window_full = 0;
+
+    err = mqtt_bench_setup( 0, 4096 );
+    require_noerr( err, exit );
+    err = mqtt_bench_connect();
+    require_noerr( err, exit );
+
+    for( i = 0; i < kMQTT_BenchStreamCount; ++i )
+    {
+        for( k = 0; k < kMQTT_BenchStreamSize; ++k ) payloads[ i ][ k ] = (uint8_t)( i + k );
+        snprintf( topics[ i ], sizeof( topics[ i ] ), ( i % 2 ) ? "s/%d" : "a/very/long/topic/%d", i );
+    }
+
+    for( step = 0; step < 200000 && received < kMQTT_BenchStreamCount; ++step )
+    {
+        if( next < kMQTT_BenchStreamCount )
+        {
+            err = mqtt_client_publish( &gMQTT_BenchClient, topics[ next ], payloads[ next ],
+                                       ( next % 4 == 0 ) ? 20 : kMQTT_BenchStreamSize, next % 3, false, NULL, &ids[ next ] );
+            if( err == kNoErr )                 next++;
+            else if( err == kWouldBlockErr )    would_block++;
+            else if( err == kNoResourcesErr )   window_full++;
+            else                                goto exit;
+        }
+        err = mqtt_client_process( &gMQTT_BenchClient );
+        require_noerr( err, exit );
+        if( step % 3 == 0 )
+        {
+            err = mqtt_bench_broker_read( 700 );
+            require_noerr( err, exit );
+        }
+
+        while( ( packet = mqtt_bench_broker_pop() ) != NULL )
+        {
+            if( packet->header == 0x62 )
+            {
+                mqtt_bench_send_ack( 0x70, mqtt_bench_ack_id( packet ) );
+                continue;
+            }
+            qos = ( packet->header >> 1 ) & 3;
+            topic_len = ( packet->body[ 0 ] << 8 ) | packet->body[ 1 ];
+            offset = 2 + topic_len + ( qos ? 2 : 0 );
+            len = ( received % 4 == 0 ) ? 20 : kMQTT_BenchStreamSize;
+            require_action( ( packet->header >> 4 ) == MQTT_PUBLISH && qos == received % 3, exit, err = kOrderErr );
+            require_action( topic_len == strlen( topics[ received ] ) &&
+                            memcmp( &packet->body[ 2 ], topics[ received ], topic_len ) == 0, exit, err = kOrderErr );
+            require_action( packet->len - offset == len && memcmp( &packet->body[ offset ], payloads[ received ], len ) == 0,
+                            exit, err = kMismatchErr );
+            if( qos == 1 ) mqtt_bench_send_ack( 0x40, mqtt_bench_publish_id( packet ) );
+            if( qos == 2 ) mqtt_bench_send_ack( 0x50, mqtt_bench_publish_id( packet ) );
+            received++;
+        }
+    }
+    require_action( received == kMQTT_BenchStreamCount, exit, err = kCountErr );
+
+    // The last PUBRELs and PUBCOMPs
+
+    for( i = 0; i < 50; ++i )
+    {
+        err = mqtt_client_process( &gMQTT_BenchClient );
+        require_noerr( err, exit );
+        err = mqtt_bench_broker_read( 0 );
+        require_noerr( err, exit );
+        while( ( packet = mqtt_bench_broker_pop() ) != NULL )
+        {
+            require_action( packet->header == 0x62, exit, err = kMismatchErr );
+            mqtt_bench_send_ack( 0x70, mqtt_bench_ack_id( packet ) );
+        }
+    }
+    require_action( gMQTT_BenchPublished == kMQTT_BenchStreamCount && gMQTT_BenchPublishErrors == 0, exit, err = kCountErr );
+    for( i = 0; i < MQTT_CLIENT_INFLIGHT_MAX; ++i )
+        require_action( gMQTT_BenchClient.inflight[ i ].state == 0, exit, err = kStateErr );
+    if( print )
+        printf( "%d messages in order, %d would block, %d window full\n", kMQTT_BenchStreamCount, would_block, window_full );
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  mqtt_bench_report
+//===========================================================================================================================
+
+static void mqtt_bench_report( const char *inMode, uint64_t inTicks, size_t inCount )
+{
+    printf( "%-40s %10.1f %s/call\n", inMode, (double) inTicks / (double) inCount, kMQTT_BenchUnit );
+}
+
+//===========================================================================================================================
+//  mqtt_bench
+//===========================================================================================================================
+
+OSStatus    mqtt_bench( int print )
+{
+    static uint8_t          payload[ kMQTT_BenchStreamSize ];
+    OSStatus                err;
+    mqtt_bench_packet_t *   packet;
+    uint64_t                t;
+    size_t                  i, loops;
+    uint16_t                id;
+
+    err = mqtt_rem_len_test();
+    require_noerr( err, exit );
+    err = mqtt_coalesce_test();
+    require_noerr( err, exit );
+    err = mqtt_qos1_test();
+    require_noerr( err, exit );
+    err = mqtt_qos2_test();
+    require_noerr( err, exit );
+    err = mqtt_oversize_test();
+    require_noerr( err, exit );
+    err = mqtt_timeout_test();
+    require_noerr( err, exit );
+    err = mqtt_offline_test();
+    require_noerr( err, exit );
+    err = mqtt_stream_test( print );
+    require_noerr( err, exit );
+    if( !print ) goto exit;
+
+    // Short QoS 0 publishes, coalesced and sent every 16 calls, the broker's reads included.
+
+    err = mqtt_bench_setup( 0, 0 );
+    require_noerr( err, exit );
+    err = mqtt_bench_connect();
+    require_noerr( err, exit );
+    loops = 200000;
+    gMQTT_BenchReads = 0;
+    t = mqtt_bench_ticks();
+    for( i = 0; i < loops; ++i )
+    {
+        mqtt_client_publish( &gMQTT_BenchClient, "s/t", (const uint8_t *) "0123456789", 10, 0, false, NULL, NULL );
+        if( ( i & 15 ) == 15 )
+        {
+            mqtt_client_process( &gMQTT_BenchClient );
+            mqtt_bench_broker_read( 0 );
+            gMQTT_BenchQueueHead = 0;
+            gMQTT_BenchQueueCount = 0;
+        }
+    }
+    mqtt_bench_report( "QoS 0 publish, 10 bytes", mqtt_bench_ticks() - t, loops );
+    printf( "%-40s %10.1f publishes/write\n", "", (double) loops / (double) gMQTT_BenchReads );
+
+    // QoS 1 round trips of a payload sent from the caller's buffer
+
+    loops = 20000;
+    t = mqtt_bench_ticks();
+    for( i = 0; i < loops; ++i )
+    {
+        mqtt_client_publish( &gMQTT_BenchClient, "s/t", payload, sizeof( payload ), 1, false, NULL, &id );
+        mqtt_client_process( &gMQTT_BenchClient );
+        mqtt_bench_broker_read( 0 );
+        while( ( packet = mqtt_bench_broker_pop() ) != NULL ) mqtt_bench_send_ack( 0x40, mqtt_bench_publish_id( packet ) );
+        mqtt_client_process( &gMQTT_BenchClient );
+    }
+    mqtt_bench_report( "QoS 1 publish and PUBACK, 1500 bytes", mqtt_bench_ticks() - t, loops );
+
+exit:
+    printf( "%s: %s\n", __FUNCTION__, !err ? "PASSED" : "FAILED" );
+    return( err );
+}
+
+int main( void )
+{
+    return( mqtt_bench( 1 ) ? 1 : 0 );
+}
+
+#endif // MQTT_BENCH_MAIN
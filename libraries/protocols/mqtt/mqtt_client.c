@@ -0,0 +1,900 @@
+/**
+******************************************************************************
+* @file    mqtt_client.c
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   This file provide a non-blocking MQTT 3.1.1 client with an inflight
+*          window for QoS 1 and 2 messages.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+#include "MICO.h"
+#include "SocketUtils.h"
+#include "mqtt_client.h"
+
+#define mqtt_client_log(M, ...) custom_log("MQTT", M, ##__VA_ARGS__)
+
+#define MQTT_FLAG_DUP           0x08
+#define MQTT_FLAG_RETAIN        0x01
+
+#define MQTT_CONNECT_CLEAN      0x02
+#define MQTT_CONNECT_WILL       0x04
+#define MQTT_CONNECT_WILL_RETAIN 0x20
+#define MQTT_CONNECT_PASSWORD   0x40
+#define MQTT_CONNECT_USERNAME   0x80
+
+/* Inflight slot state: free, or the packet type it waits for. A QoS 0 publish
+   waits for MQTT_PUBLISH, it is done when its caller buffers are sent. */
+#define MQTT_INFLIGHT_FREE      0
+
+#define MQTT_HEADER_MAX         5       // Type and remaining length
+
+
+int mqtt_rem_len_encode( uint8_t *buf, uint32_t len )
+{
+  int n = 0;
+
+  if ( len > MQTT_REM_LEN_MAX )
+    return 0;
+
+  do {
+    buf[n] = len & 0x7F;
+    len >>= 7;
+    if ( len )
+      buf[n] |= 0x80;
+    n++;
+  } while ( len );
+
+  return n;
+}
+
+int mqtt_rem_len_decode( const uint8_t *buf, size_t avail, uint32_t *len )
+{
+  uint32_t value = 0;
+  int n;
+
+  for ( n = 0; n < 4; n++ ) {
+    if ( (size_t)n >= avail )
+      return 0;
+    value |= (uint32_t)( buf[n] & 0x7F ) << ( 7 * n );
+    if ( ( buf[n] & 0x80 ) == 0 ) {
+      *len = value;
+      return n + 1;
+    }
+  }
+  return -1;
+}
+
+/*******************************************************************************
+ *                                 tx queue
+ ******************************************************************************/
+
+/* Room for a packet of owned bytes and ext caller buffers, an owned part can
+   be needed around each caller buffer */
+static bool _mqtt_tx_room( mqtt_client_t *client, size_t owned, int ext )
+{
+  return ( client->tx_len + owned <= client->config.tx_size ) &&
+         ( client->tx_vec_count + 2 * ext + 1 <= MQTT_CLIENT_TX_VEC_MAX );
+}
+
+/* Copy to the tx buffer, coalesced with the last buffer queued if it is owned */
+static void _mqtt_tx_add( mqtt_client_t *client, const void *data, size_t len )
+{
+  uint8_t *dst = client->config.tx_buf + client->tx_len;
+  int last = client->tx_vec_count - 1;
+
+  if ( len == 0 )
+    return;
+
+  memcpy( dst, data, len );
+  client->tx_len += len;
+
+  if ( last >= 0 && client->tx_vec_slot[last] == -1 &&
+       client->tx_vec[last].buf + client->tx_vec[last].len == dst ) {
+    client->tx_vec[last].len += len;
+    return;
+  }
+  client->tx_vec[client->tx_vec_count].buf = dst;
+  client->tx_vec[client->tx_vec_count].len = len;
+  client->tx_vec_slot[client->tx_vec_count] = -1;
+  client->tx_vec_count++;
+}
+
+/* Queue a caller buffer of an inflight message */
+static void _mqtt_tx_add_ref( mqtt_client_t *client, const void *data, size_t len, int slot )
+{
+  if ( len == 0 )
+    return;
+
+  client->tx_vec[client->tx_vec_count].buf = data;
+  client->tx_vec[client->tx_vec_count].len = len;
+  client->tx_vec_slot[client->tx_vec_count] = slot;
+  client->tx_vec_count++;
+  client->inflight[slot].queued++;
+}
+
+/* Small data goes to the tx buffer, bigger is sent from the caller buffer */
+static void _mqtt_tx_add_data( mqtt_client_t *client, const void *data, size_t len, int slot )
+{
+  if ( len <= MQTT_CLIENT_COPY_MAX )
+    _mqtt_tx_add( client, data, len );
+  else
+    _mqtt_tx_add_ref( client, data, len, slot );
+}
+
+/* Fixed header of a packet */
+static void _mqtt_tx_add_header( mqtt_client_t *client, uint8_t type_flags, uint32_t rem_len )
+{
+  uint8_t header[MQTT_HEADER_MAX];
+  int n;
+
+  header[0] = type_flags;
+  n = mqtt_rem_len_encode( header + 1, rem_len );
+  _mqtt_tx_add( client, header, 1 + n );
+}
+
+static void _mqtt_tx_add_u16( mqtt_client_t *client, uint16_t value )
+{
+  uint8_t data[2];
+
+  data[0] = value >> 8;
+  data[1] = value & 0xFF;
+  _mqtt_tx_add( client, data, 2 );
+}
+
+/* Free a publish slot, its buffers are given back to the caller */
+static void _mqtt_inflight_done( mqtt_client_t *client, int slot, OSStatus err )
+{
+  mqtt_inflight_t *s = &client->inflight[slot];
+
+  s->state = MQTT_INFLIGHT_FREE;
+  if ( client->config.callbacks.published )
+    client->config.callbacks.published( client, s->packet_id, s->arg, err );
+}
+
+/* QoS 0 messages with all buffers sent are done */
+static void _mqtt_tx_complete( mqtt_client_t *client, OSStatus err )
+{
+  int i;
+
+  for ( i = 0; i < MQTT_CLIENT_INFLIGHT_MAX; i++ ) {
+    if ( client->inflight[i].state == MQTT_PUBLISH && client->inflight[i].queued == 0 &&
+         !client->inflight[i].pending )
+      _mqtt_inflight_done( client, i, err );
+  }
+}
+
+/* Remove the buffers sent, and move the owned bytes left to the front */
+static void _mqtt_tx_drain( mqtt_client_t *client )
+{
+  int i = 0, j;
+  size_t shift;
+
+  while ( i < client->tx_vec_count && client->tx_sent >= client->tx_vec[i].len ) {
+    client->tx_sent -= client->tx_vec[i].len;
+    if ( client->tx_vec_slot[i] >= 0 )
+      client->inflight[(int)client->tx_vec_slot[i]].queued--;
+    i++;
+  }
+  if ( i > 0 ) {
+    client->tx_vec_count -= i;
+    memmove( client->tx_vec, client->tx_vec + i, client->tx_vec_count * sizeof(SocketIOVec_t) );
+    memmove( client->tx_vec_slot, client->tx_vec_slot + i, client->tx_vec_count );
+  }
+
+  for ( j = 0; j < client->tx_vec_count && client->tx_vec_slot[j] != -1; j++ );
+  if ( j == client->tx_vec_count ) {
+    client->tx_len = 0;
+  }
+  else {
+    shift = client->tx_vec[j].buf - client->config.tx_buf;
+    if ( shift ) {
+      memmove( client->config.tx_buf, client->tx_vec[j].buf, client->tx_len - shift );
+      client->tx_len -= shift;
+      for ( ; j < client->tx_vec_count; j++ ) {
+        if ( client->tx_vec_slot[j] == -1 )
+          client->tx_vec[j].buf -= shift;
+      }
+    }
+  }
+
+  if ( i > 0 )
+    _mqtt_tx_complete( client, kNoErr );
+}
+
+static OSStatus _mqtt_tx_flush( mqtt_client_t *client )
+{
+  OSStatus err;
+  size_t sent = client->tx_sent;
+
+  if ( client->tx_vec_count == 0 )
+    return kNoErr;
+
+  err = SocketSendvOnce( client->fd, client->tx_vec, client->tx_vec_count, &client->tx_sent );
+  if ( client->tx_sent != sent )
+    client->last_tx_ms = mico_get_time( );
+  if ( err == EWOULDBLOCK )
+    err = kNoErr;
+  else if ( err != kNoErr )
+    err = kWriteErr;
+
+  _mqtt_tx_drain( client );
+  return err;
+}
+
+/* Drop the tx queue, QoS 0 messages in it are dropped */
+static void _mqtt_tx_reset( mqtt_client_t *client )
+{
+  int i;
+
+  client->tx_vec_count = 0;
+  client->tx_len = 0;
+  client->tx_sent = 0;
+  for ( i = 0; i < MQTT_CLIENT_INFLIGHT_MAX; i++ ) {
+    client->inflight[i].queued = 0;
+    if ( client->inflight[i].state == MQTT_PUBLISH )
+      client->inflight[i].pending = false;
+  }
+  _mqtt_tx_complete( client, kConnectionErr );
+}
+
+/*******************************************************************************
+ *                              inflight window
+ ******************************************************************************/
+
+static int _mqtt_inflight_find( mqtt_client_t *client, uint16_t packet_id, uint8_t state )
+{
+  int i;
+
+  for ( i = 0; i < MQTT_CLIENT_INFLIGHT_MAX; i++ ) {
+    if ( client->inflight[i].state != MQTT_INFLIGHT_FREE && client->inflight[i].packet_id == packet_id &&
+         ( state == MQTT_INFLIGHT_FREE || client->inflight[i].state == state ) )
+      return i;
+  }
+  return -1;
+}
+
+static int _mqtt_inflight_alloc( mqtt_client_t *client, uint8_t state )
+{
+  int i;
+
+  for ( i = 0; i < MQTT_CLIENT_INFLIGHT_MAX; i++ ) {
+    if ( client->inflight[i].state == MQTT_INFLIGHT_FREE ) {
+      memset( &client->inflight[i], 0, sizeof(mqtt_inflight_t) );
+      client->inflight[i].state = state;
+      client->inflight[i].pending = true;
+      return i;
+    }
+  }
+  return -1;
+}
+
+static uint16_t _mqtt_next_packet_id( mqtt_client_t *client )
+{
+  do {
+    if ( ++client->next_id == 0 )
+      client->next_id = 1;
+  } while ( _mqtt_inflight_find( client, client->next_id, MQTT_INFLIGHT_FREE ) >= 0 );
+
+  return client->next_id;
+}
+
+/* Queue the packet of an inflight slot, kWouldBlockErr if the tx queue is full */
+static OSStatus _mqtt_inflight_send( mqtt_client_t *client, int slot )
+{
+  mqtt_inflight_t *s = &client->inflight[slot];
+  uint16_t topic_len = 0;
+  size_t owned = MQTT_HEADER_MAX + 2 + 2 + 1;
+  int ext = 0;
+
+  if ( s->state != MQTT_PUBCOMP ) {
+    topic_len = strlen( s->topic );
+    if ( topic_len > MQTT_CLIENT_COPY_MAX )
+      ext++;
+    else
+      owned += topic_len;
+  }
+  if ( s->state == MQTT_PUBLISH || s->state == MQTT_PUBACK || s->state == MQTT_PUBREC ) {
+    if ( s->len > MQTT_CLIENT_COPY_MAX )
+      ext++;
+    else
+      owned += s->len;
+  }
+  if ( !_mqtt_tx_room( client, owned, ext ) )
+    return kWouldBlockErr;
+
+  switch ( s->state ) {
+    case MQTT_PUBLISH:
+    case MQTT_PUBACK:
+    case MQTT_PUBREC:
+      _mqtt_tx_add_header( client, ( MQTT_PUBLISH << 4 ) | s->header,
+                           2 + topic_len + ( ( s->state == MQTT_PUBLISH ) ? 0 : 2 ) + s->len );
+      _mqtt_tx_add_u16( client, topic_len );
+      _mqtt_tx_add_data( client, s->topic, topic_len, slot );
+      if ( s->state != MQTT_PUBLISH ) {
+        _mqtt_tx_add_u16( client, s->packet_id );
+        s->header |= MQTT_FLAG_DUP;  // Sent again with DUP
+      }
+      _mqtt_tx_add_data( client, s->payload, s->len, slot );
+      break;
+    case MQTT_PUBCOMP:
+      _mqtt_tx_add_header( client, ( MQTT_PUBREL << 4 ) | 0x02, 2 );
+      _mqtt_tx_add_u16( client, s->packet_id );
+      break;
+    case MQTT_SUBACK:
+      _mqtt_tx_add_header( client, ( MQTT_SUBSCRIBE << 4 ) | 0x02, 2 + 2 + topic_len + 1 );
+      _mqtt_tx_add_u16( client, s->packet_id );
+      _mqtt_tx_add_u16( client, topic_len );
+      _mqtt_tx_add_data( client, s->topic, topic_len, slot );
+      _mqtt_tx_add( client, &s->header, 1 );
+      break;
+    case MQTT_UNSUBACK:
+      _mqtt_tx_add_header( client, ( MQTT_UNSUBSCRIBE << 4 ) | 0x02, 2 + 2 + topic_len );
+      _mqtt_tx_add_u16( client, s->packet_id );
+      _mqtt_tx_add_u16( client, topic_len );
+      _mqtt_tx_add_data( client, s->topic, topic_len, slot );
+      break;
+    default:
+      break;
+  }
+
+  s->pending = false;
+  s->sent_ms = mico_get_time( );
+  return kNoErr;
+}
+
+/* Send the slots pending, and again the ones not acknowledged in time */
+static OSStatus _mqtt_inflight_retry( mqtt_client_t *client )
+{
+  mqtt_inflight_t *s;
+  uint32_t now = mico_get_time( );
+  int i;
+
+  for ( i = 0; i < MQTT_CLIENT_INFLIGHT_MAX; i++ ) {
+    s = &client->inflight[i];
+    if ( s->state == MQTT_INFLIGHT_FREE || s->queued > 0 )
+      continue;
+
+    if ( !s->pending && s->state != MQTT_PUBLISH &&
+         now - s->sent_ms >= ( (uint32_t)MQTT_CLIENT_RETRY_MS << s->retries ) ) {
+      if ( s->retries >= MQTT_CLIENT_RETRY_MAX ) {
+        mqtt_client_log("No answer to packet %d", s->packet_id);
+        return kTimeoutErr;
+      }
+      s->retries++;
+      s->pending = true;
+    }
+
+    if ( s->pending && _mqtt_inflight_send( client, i ) != kNoErr )
+      break;
+  }
+  return kNoErr;
+}
+
+/*******************************************************************************
+ *                               rx packets
+ ******************************************************************************/
+
+static OSStatus _mqtt_rx_connack( mqtt_client_t *client, const uint8_t *p, uint32_t len )
+{
+  bool session_present;
+  int i;
+
+  if ( len != 2 || client->state != MQTT_STATE_CONNECTING )
+    return kMalformedErr;
+
+  session_present = ( p[0] & 0x01 ) && p[1] == 0;
+  if ( client->config.callbacks.connected )
+    client->config.callbacks.connected( client, p[1], session_present );
+  if ( p[1] != 0 ) {
+    mqtt_client_log("Connection refused, return code %d", p[1]);
+    return ( p[1] == 4 || p[1] == 5 ) ? kAuthenticationErr : kConnectionErr;
+  }
+
+  client->state = MQTT_STATE_CONNECTED;
+  if ( !session_present )
+    memset( client->qos2_rx, 0, sizeof(client->qos2_rx) );
+
+  // Send the inflight window again, a new session has lost PUBREL state
+  for ( i = 0; i < MQTT_CLIENT_INFLIGHT_MAX; i++ ) {
+    if ( client->inflight[i].state == MQTT_INFLIGHT_FREE )
+      continue;
+    if ( !session_present && client->inflight[i].state == MQTT_PUBCOMP )
+      client->inflight[i].state = MQTT_PUBREC;
+    client->inflight[i].pending = true;
+    client->inflight[i].retries = 0;
+  }
+  return kNoErr;
+}
+
+static OSStatus _mqtt_rx_publish( mqtt_client_t *client, uint8_t flags, const uint8_t *p, uint32_t len )
+{
+  uint8_t qos = ( flags >> 1 ) & 0x03;
+  uint16_t topic_len, packet_id = 0;
+  uint32_t header_len;
+  bool deliver = true;
+  int i, free_i = -1;
+
+  if ( len < 2 || qos > 2 )
+    return kMalformedErr;
+  topic_len = ( p[0] << 8 ) | p[1];
+  header_len = 2 + topic_len + ( qos ? 2 : 0 );
+  if ( header_len > len )
+    return kMalformedErr;
+  if ( qos ) {
+    packet_id = ( p[2 + topic_len] << 8 ) | p[2 + topic_len + 1];
+    if ( !_mqtt_tx_room( client, 4, 0 ) )
+      return kWouldBlockErr;  // Handled when the ack can be queued
+  }
+
+  // A QoS 2 message is delivered once, until its PUBREL
+  if ( qos == 2 ) {
+    for ( i = 0; i < MQTT_CLIENT_QOS2_RX_MAX; i++ ) {
+      if ( client->qos2_rx[i] == packet_id )
+        deliver = false;
+      else if ( client->qos2_rx[i] == 0 && free_i < 0 )
+        free_i = i;
+    }
+    if ( deliver && free_i >= 0 )
+      client->qos2_rx[free_i] = packet_id;
+    else if ( deliver ) {
+      mqtt_client_log("QoS 2 table full, packet %d can be delivered twice", packet_id);
+    }
+  }
+
+  if ( deliver && client->config.callbacks.message )
+    client->config.callbacks.message( client, (const char *)p + 2, topic_len, p + header_len,
+                                      len - header_len, qos, flags & MQTT_FLAG_RETAIN );
+
+  if ( qos ) {
+    _mqtt_tx_add_header( client, ( ( qos == 1 ) ? MQTT_PUBACK : MQTT_PUBREC ) << 4, 2 );
+    _mqtt_tx_add_u16( client, packet_id );
+  }
+  return kNoErr;
+}
+
+static OSStatus _mqtt_rx_ack( mqtt_client_t *client, uint8_t type, const uint8_t *p, uint32_t len )
+{
+  uint16_t packet_id;
+  int slot, i;
+
+  if ( len < 2 )
+    return kMalformedErr;
+  packet_id = ( p[0] << 8 ) | p[1];
+
+  switch ( type ) {
+    case MQTT_PUBACK:
+    case MQTT_PUBCOMP:
+      slot = _mqtt_inflight_find( client, packet_id, type );
+      if ( slot >= 0 && client->inflight[slot].queued == 0 )
+        _mqtt_inflight_done( client, slot, kNoErr );
+      break;
+    case MQTT_PUBREC:
+      if ( !_mqtt_tx_room( client, 4, 0 ) )
+        return kWouldBlockErr;
+      slot = _mqtt_inflight_find( client, packet_id, MQTT_PUBREC );
+      if ( slot >= 0 ) {
+        client->inflight[slot].state = MQTT_PUBCOMP;
+        client->inflight[slot].retries = 0;
+        client->inflight[slot].pending = true;
+        _mqtt_inflight_send( client, slot );
+      }
+      else {
+        _mqtt_tx_add_header( client, ( MQTT_PUBREL << 4 ) | 0x02, 2 );
+        _mqtt_tx_add_u16( client, packet_id );
+      }
+      break;
+    case MQTT_PUBREL:
+      if ( !_mqtt_tx_room( client, 4, 0 ) )
+        return kWouldBlockErr;
+      for ( i = 0; i < MQTT_CLIENT_QOS2_RX_MAX; i++ ) {
+        if ( client->qos2_rx[i] == packet_id )
+          client->qos2_rx[i] = 0;
+      }
+      _mqtt_tx_add_header( client, MQTT_PUBCOMP << 4, 2 );
+      _mqtt_tx_add_u16( client, packet_id );
+      break;
+    case MQTT_SUBACK:
+    case MQTT_UNSUBACK:
+      slot = _mqtt_inflight_find( client, packet_id, type );
+      if ( slot >= 0 && client->inflight[slot].queued == 0 ) {
+        client->inflight[slot].state = MQTT_INFLIGHT_FREE;
+        if ( client->config.callbacks.subscribed )
+          client->config.callbacks.subscribed( client, packet_id, ( type == MQTT_SUBACK && len > 2 ) ? p[2] : 0 );
+      }
+      break;
+    default:
+      break;
+  }
+  return kNoErr;
+}
+
+static OSStatus _mqtt_rx_packet( mqtt_client_t *client, uint8_t header, const uint8_t *p, uint32_t len )
+{
+  uint8_t type = header >> 4;
+
+  if ( client->state == MQTT_STATE_CONNECTING && type != MQTT_CONNACK )
+    return kMalformedErr;
+
+  switch ( type ) {
+    case MQTT_CONNACK:
+      return _mqtt_rx_connack( client, p, len );
+    case MQTT_PUBLISH:
+      return _mqtt_rx_publish( client, header & 0x0F, p, len );
+    case MQTT_PUBACK:
+    case MQTT_PUBREC:
+    case MQTT_PUBREL:
+    case MQTT_PUBCOMP:
+    case MQTT_SUBACK:
+    case MQTT_UNSUBACK:
+      return _mqtt_rx_ack( client, type, p, len );
+    case MQTT_PINGRESP:
+      client->ping_outstanding = false;
+      return kNoErr;
+    default:
+      return kMalformedErr;
+  }
+}
+
+/* Handle the complete packets in the rx buffer */
+static OSStatus _mqtt_rx_handle( mqtt_client_t *client )
+{
+  OSStatus err = kNoErr;
+  uint8_t *buf = client->config.rx_buf;
+  uint32_t rem_len, total, skip;
+  int n;
+
+  while ( client->rx_len > 0 ) {
+    // Bytes of a packet too big
+    if ( client->rx_skip ) {
+      skip = ( client->rx_skip < client->rx_len ) ? client->rx_skip : client->rx_len;
+      memmove( buf, buf + skip, client->rx_len - skip );
+      client->rx_len -= skip;
+      client->rx_skip -= skip;
+      continue;
+    }
+
+    n = mqtt_rem_len_decode( buf + 1, client->rx_len - 1, &rem_len );
+    require_action( n >= 0, exit, err = kMalformedErr );
+    if ( n == 0 )
+      break;
+    total = 1 + n + rem_len;
+
+    if ( total > client->config.rx_size ) {
+      mqtt_client_log("Packet type %d of %u bytes dropped", buf[0] >> 4, (unsigned int)total);
+      client->rx_skip = total;
+      continue;
+    }
+    if ( total > client->rx_len )
+      break;
+
+    err = _mqtt_rx_packet( client, buf[0], buf + 1 + n, rem_len );
+    require_noerr_quiet( err, exit );
+
+    memmove( buf, buf + total, client->rx_len - total );
+    client->rx_len -= total;
+  }
+
+exit:
+  return err;
+}
+
+static OSStatus _mqtt_rx_read( mqtt_client_t *client )
+{
+  OSStatus err;
+  fd_set readfds;
+  struct timeval_t t;
+  int n;
+
+  // Packets left when the tx queue was full
+  err = _mqtt_rx_handle( client );
+  require_noerr_quiet( err, exit );
+  require_quiet( client->rx_len < client->config.rx_size, exit );
+
+  FD_ZERO( &readfds );
+  FD_SET( client->fd, &readfds );
+  t.tv_sec = 0;
+  t.tv_usec = 0;
+  require_quiet( select( client->fd + 1, &readfds, NULL, NULL, &t ) > 0, exit );
+
+  n = recv( client->fd, client->config.rx_buf + client->rx_len, client->config.rx_size - client->rx_len, 0 );
+  require_action_quiet( n != 0, exit, err = kConnectionErr );
+  require_action_quiet( n > 0, exit, err = kReadErr );
+  client->rx_len += n;
+
+  err = _mqtt_rx_handle( client );
+
+exit:
+  if ( err == kWouldBlockErr )
+    err = kNoErr;
+  return err;
+}
+
+/*******************************************************************************
+ *                                 client
+ ******************************************************************************/
+
+OSStatus mqtt_client_init( mqtt_client_t *client, const mqtt_client_config_t *config )
+{
+  OSStatus err = kParamErr;
+
+  require( client && config, exit );
+  require( config->client_id, exit );
+  require( config->tx_buf && config->rx_buf && config->rx_size > MQTT_HEADER_MAX, exit );
+
+  memset( client, 0, sizeof(mqtt_client_t) );
+  client->config = *config;
+  client->state = MQTT_STATE_DISCONNECTED;
+  client->fd = -1;
+  err = kNoErr;
+
+exit:
+  return err;
+}
+
+static void _mqtt_add_string( uint8_t **p, const void *s, uint16_t len )
+{
+  (*p)[0] = len >> 8;
+  (*p)[1] = len & 0xFF;
+  memcpy( *p + 2, s, len );
+  *p += 2 + len;
+}
+
+OSStatus mqtt_client_connect( mqtt_client_t *client, int fd )
+{
+  OSStatus err = kParamErr;
+  const mqtt_client_config_t *c;
+  uint16_t id_len, user_len = 0, pass_len = 0, will_topic_len = 0;
+  uint32_t rem_len;
+  uint8_t flags = 0;
+  uint8_t *p;
+
+  require( client && fd >= 0, exit );
+  c = &client->config;
+
+  _mqtt_tx_reset( client );
+  client->fd = fd;
+  client->rx_len = 0;
+  client->rx_skip = 0;
+  client->ping_outstanding = false;
+
+  id_len = strlen( c->client_id );
+  rem_len = 10 + 2 + id_len;
+  if ( c->clean_session )
+    flags |= MQTT_CONNECT_CLEAN;
+  if ( c->will_topic ) {
+    will_topic_len = strlen( c->will_topic );
+    rem_len += 2 + will_topic_len + 2 + c->will_len;
+    flags |= MQTT_CONNECT_WILL | ( ( c->will_qos & 0x03 ) << 3 ) | ( c->will_retain ? MQTT_CONNECT_WILL_RETAIN : 0 );
+  }
+  if ( c->username ) {
+    user_len = strlen( c->username );
+    rem_len += 2 + user_len;
+    flags |= MQTT_CONNECT_USERNAME;
+  }
+  if ( c->password ) {
+    pass_len = strlen( c->password );
+    rem_len += 2 + pass_len;
+    flags |= MQTT_CONNECT_PASSWORD;
+  }
+  require_action( MQTT_HEADER_MAX + rem_len <= c->tx_size, exit, err = kSizeErr );
+
+  // Built in the tx buffer, then queued as one owned buffer
+  p = c->tx_buf;
+  *p++ = MQTT_CONNECT << 4;
+  p += mqtt_rem_len_encode( p, rem_len );
+  _mqtt_add_string( &p, "MQTT", 4 );
+  *p++ = 4;  // Protocol level 3.1.1
+  *p++ = flags;
+  *p++ = c->keep_alive >> 8;
+  *p++ = c->keep_alive & 0xFF;
+  _mqtt_add_string( &p, c->client_id, id_len );
+  if ( c->will_topic ) {
+    _mqtt_add_string( &p, c->will_topic, will_topic_len );
+    _mqtt_add_string( &p, c->will_msg, c->will_len );
+  }
+  if ( c->username )
+    _mqtt_add_string( &p, c->username, user_len );
+  if ( c->password )
+    _mqtt_add_string( &p, c->password, pass_len );
+
+  client->tx_vec[0].buf = c->tx_buf;
+  client->tx_vec[0].len = p - c->tx_buf;
+  client->tx_vec_slot[0] = -1;
+  client->tx_vec_count = 1;
+  client->tx_len = p - c->tx_buf;
+
+  client->state = MQTT_STATE_CONNECTING;
+  client->last_rx_ms = mico_get_time( );
+  client->last_tx_ms = client->last_rx_ms;
+  err = _mqtt_tx_flush( client );
+
+exit:
+  return err;
+}
+
+OSStatus mqtt_client_disconnect( mqtt_client_t *client )
+{
+  OSStatus err = kStateErr;
+
+  require( client && client->state != MQTT_STATE_DISCONNECTED, exit );
+  require_action( _mqtt_tx_room( client, 2, 0 ), exit, err = kWouldBlockErr );
+
+  _mqtt_tx_add_header( client, MQTT_DISCONNECT << 4, 0 );
+  err = _mqtt_tx_flush( client );
+  client->state = MQTT_STATE_DISCONNECTED;
+
+exit:
+  return err;
+}
+
+void mqtt_client_close( mqtt_client_t *client )
+{
+  if ( client == NULL )
+    return;
+
+  _mqtt_tx_reset( client );
+  client->rx_len = 0;
+  client->rx_skip = 0;
+  client->state = MQTT_STATE_DISCONNECTED;
+  client->fd = -1;
+}
+
+OSStatus mqtt_client_publish( mqtt_client_t *client, const char *topic, const uint8_t *payload,
+                              uint32_t len, uint8_t qos, bool retain, void *arg, uint16_t *packet_id )
+{
+  OSStatus err = kParamErr;
+  mqtt_inflight_t *s;
+  uint16_t topic_len;
+  int slot;
+
+  require( client && topic && ( payload || len == 0 ) && qos <= 2, exit );
+  topic_len = strlen( topic );
+  require( topic_len > 0 && 2 + topic_len + 2 + len <= MQTT_REM_LEN_MAX, exit );
+  require_action( qos > 0 || client->state == MQTT_STATE_CONNECTED, exit, err = kStateErr );
+  if ( packet_id )
+    *packet_id = 0;
+
+  // A short QoS 0 message is copied, its buffers are free at once
+  if ( qos == 0 && topic_len <= MQTT_CLIENT_COPY_MAX && len <= MQTT_CLIENT_COPY_MAX &&
+       _mqtt_tx_room( client, MQTT_HEADER_MAX + 2 + topic_len + len, 0 ) ) {
+    _mqtt_tx_add_header( client, ( MQTT_PUBLISH << 4 ) | ( retain ? MQTT_FLAG_RETAIN : 0 ), 2 + topic_len + len );
+    _mqtt_tx_add_u16( client, topic_len );
+    _mqtt_tx_add( client, topic, topic_len );
+    _mqtt_tx_add( client, payload, len );
+    if ( client->config.callbacks.published )
+      client->config.callbacks.published( client, 0, arg, kNoErr );
+    err = kNoErr;
+    goto exit;
+  }
+
+  slot = _mqtt_inflight_alloc( client, ( qos == 0 ) ? MQTT_PUBLISH : ( ( qos == 1 ) ? MQTT_PUBACK : MQTT_PUBREC ) );
+  require_action_quiet( slot >= 0, exit, err = kNoResourcesErr );
+  s = &client->inflight[slot];
+  s->header = ( qos << 1 ) | ( retain ? MQTT_FLAG_RETAIN : 0 );
+  s->topic = topic;
+  s->payload = payload;
+  s->len = len;
+  s->arg = arg;
+  if ( qos ) {
+    s->packet_id = _mqtt_next_packet_id( client );
+    if ( packet_id )
+      *packet_id = s->packet_id;
+  }
+
+  err = kNoErr;
+  if ( client->state == MQTT_STATE_CONNECTED && _mqtt_inflight_send( client, slot ) != kNoErr ) {
+    if ( qos == 0 ) {
+      s->state = MQTT_INFLIGHT_FREE;
+      err = kWouldBlockErr;
+    }
+  }
+
+exit:
+  return err;
+}
+
+static OSStatus _mqtt_client_subscribe( mqtt_client_t *client, uint8_t state, const char *topic,
+                                        uint8_t qos, uint16_t *packet_id )
+{
+  OSStatus err = kParamErr;
+  mqtt_inflight_t *s;
+  int slot;
+
+  require( client && topic && topic[0] != '\0' && qos <= 2, exit );
+
+  slot = _mqtt_inflight_alloc( client, state );
+  require_action_quiet( slot >= 0, exit, err = kNoResourcesErr );
+  s = &client->inflight[slot];
+  s->header = qos;
+  s->topic = topic;
+  s->packet_id = _mqtt_next_packet_id( client );
+  if ( packet_id )
+    *packet_id = s->packet_id;
+
+  if ( client->state == MQTT_STATE_CONNECTED )
+    _mqtt_inflight_send( client, slot );
+  err = kNoErr;
+
+exit:
+  return err;
+}
+
+OSStatus mqtt_client_subscribe( mqtt_client_t *client, const char *topic, uint8_t qos, uint16_t *packet_id )
+{
+  return _mqtt_client_subscribe( client, MQTT_SUBACK, topic, qos, packet_id );
+}
+
+OSStatus mqtt_client_unsubscribe( mqtt_client_t *client, const char *topic, uint16_t *packet_id )
+{
+  return _mqtt_client_subscribe( client, MQTT_UNSUBACK, topic, 0, packet_id );
+}
+
+OSStatus mqtt_client_process( mqtt_client_t *client )
+{
+  OSStatus err = kStateErr;
+  uint32_t now;
+
+  require( client && client->state != MQTT_STATE_DISCONNECTED, exit );
+
+  err = _mqtt_tx_flush( client );
+  require_noerr( err, exit );
+
+  err = _mqtt_rx_read( client );
+  require_noerr_quiet( err, exit );
+
+  now = mico_get_time( );
+  if ( client->state == MQTT_STATE_CONNECTING ) {
+    require_action( now - client->last_rx_ms < MQTT_CLIENT_RESPONSE_TIMEOUT, exit, err = kTimeoutErr );
+  }
+  else {
+    err = _mqtt_inflight_retry( client );
+    require_noerr( err, exit );
+
+    if ( client->config.keep_alive ) {
+      if ( client->ping_outstanding ) {
+        require_action( now - client->ping_ms < MQTT_CLIENT_RESPONSE_TIMEOUT, exit, err = kTimeoutErr );
+      }
+      else if ( now - client->last_tx_ms >= client->config.keep_alive * 1000UL && _mqtt_tx_room( client, 2, 0 ) ) {
+        _mqtt_tx_add_header( client, MQTT_PINGREQ << 4, 0 );
+        client->ping_outstanding = true;
+        client->ping_ms = now;
+      }
+    }
+  }
+
+  err = _mqtt_tx_flush( client );
+
+exit:
+  if ( client && err != kNoErr ) {
+    mqtt_client_log("Connection ended, err = %d", err);
+  }
+  return err;
+}
+
+bool mqtt_client_want_write( mqtt_client_t *client )
+{
+  return client && client->tx_vec_count > 0;
+}
@@ -0,0 +1,229 @@
+/**
+******************************************************************************
+* @file    mqtt_client.h
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   MQTT 3.1.1 client header files.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+/* The client never blocks: it is given a connected TCP socket in non-block mode
+ * (SO_BLOCKMODE) and is run by mqtt_client_process() from the application's
+ * select() loop. Packets are queued in the tx buffer and sent with one
+ * SocketSendvOnce() per call, so small packets go out in the same segment.
+ * Topics and payloads are sent from the caller buffers, short ones are copied
+ * into the tx buffer instead so they can be coalesced.
+ *
+ * QoS 1 and 2 messages, subscribes and unsubscribes wait in the inflight window
+ * until acknowledged, and are sent again if no answer comes in time, or after
+ * a reconnect.
+ */
+
+#pragma once
+
+#include "Common.h"
+#include "SocketUtils.h"
+
+#ifndef MQTT_CLIENT_INFLIGHT_MAX
+#define MQTT_CLIENT_INFLIGHT_MAX      8      // Messages waiting to be sent or acknowledged
+#endif
+
+#ifndef MQTT_CLIENT_TX_VEC_MAX
+#define MQTT_CLIENT_TX_VEC_MAX        16     // Buffers in the tx queue
+#endif
+
+#ifndef MQTT_CLIENT_COPY_MAX
+#define MQTT_CLIENT_COPY_MAX          64     // Topics and payloads up to this size are copied to the tx buffer
+#endif
+
+#ifndef MQTT_CLIENT_QOS2_RX_MAX
+#define MQTT_CLIENT_QOS2_RX_MAX       4      // QoS 2 messages received and waiting for PUBREL
+#endif
+
+#ifndef MQTT_CLIENT_RETRY_MS
+#define MQTT_CLIENT_RETRY_MS          5000   // First retransmit, doubled for each retry
+#endif
+
+#ifndef MQTT_CLIENT_RETRY_MAX
+#define MQTT_CLIENT_RETRY_MAX         4      // Retries before the connection is given up
+#endif
+
+#ifndef MQTT_CLIENT_RESPONSE_TIMEOUT
+#define MQTT_CLIENT_RESPONSE_TIMEOUT  10000  // CONNACK and PINGRESP timeout
+#endif
+
+#define MQTT_REM_LEN_MAX              268435455
+
+// Packet types
+#define MQTT_CONNECT                  1
+#define MQTT_CONNACK                  2
+#define MQTT_PUBLISH                  3
+#define MQTT_PUBACK                   4
+#define MQTT_PUBREC                   5
+#define MQTT_PUBREL                   6
+#define MQTT_PUBCOMP                  7
+#define MQTT_SUBSCRIBE                8
+#define MQTT_SUBACK                   9
+#define MQTT_UNSUBSCRIBE              10
+#define MQTT_UNSUBACK                 11
+#define MQTT_PINGREQ                  12
+#define MQTT_PINGRESP                 13
+#define MQTT_DISCONNECT               14
+
+typedef enum {
+  MQTT_STATE_DISCONNECTED = 0,
+  MQTT_STATE_CONNECTING,      // CONNECT sent, waiting for CONNACK
+  MQTT_STATE_CONNECTED,
+} mqtt_client_state_t;
+
+typedef struct _mqtt_client_t mqtt_client_t;
+
+typedef struct {
+  // CONNACK received, return_code 0 if accepted
+  void (*connected)( mqtt_client_t *client, uint8_t return_code, bool session_present );
+  // A message received, topic and payload are in the rx buffer
+  void (*message)( mqtt_client_t *client, const char *topic, uint16_t topic_len,
+                   const uint8_t *payload, uint32_t len, uint8_t qos, bool retain );
+  // The buffers of a publish are not used anymore: the message is sent for QoS 0,
+  // acknowledged for QoS 1 and 2. err is not kNoErr if it is dropped.
+  void (*published)( mqtt_client_t *client, uint16_t packet_id, void *arg, OSStatus err );
+  // SUBACK or UNSUBACK received, return_code is the granted QoS or 0x80 for a SUBACK
+  void (*subscribed)( mqtt_client_t *client, uint16_t packet_id, uint8_t return_code );
+} mqtt_client_callbacks_t;
+
+typedef struct {
+  const char *client_id;
+  const char *username;            // NULL if not used
+  const char *password;            // NULL if not used
+  uint16_t   keep_alive;           // Seconds, 0 to disable
+  bool       clean_session;
+  const char *will_topic;          // NULL if no will
+  const uint8_t *will_msg;
+  uint16_t   will_len;
+  uint8_t    will_qos;
+  bool       will_retain;
+
+  uint8_t    *tx_buf;              // Queued packets, holds the CONNECT packet at least
+  size_t     tx_size;
+  uint8_t    *rx_buf;              // Holds the largest packet received, bigger ones are dropped
+  size_t     rx_size;
+
+  mqtt_client_callbacks_t callbacks;
+  void       *ctx;                 // User context
+} mqtt_client_config_t;
+
+typedef struct {
+  uint8_t    state;                // Free, or the packet it waits for
+  uint8_t    header;               // PUBLISH flags, or SUBSCRIBE QoS
+  uint8_t    queued;               // Caller buffers of this message in the tx queue
+  uint8_t    retries;
+  bool       pending;              // To be sent, or sent again
+  uint16_t   packet_id;
+  uint32_t   sent_ms;
+  const char *topic;
+  const uint8_t *payload;
+  uint32_t   len;
+  void       *arg;
+} mqtt_inflight_t;
+
+struct _mqtt_client_t {
+  mqtt_client_config_t config;
+  mqtt_client_state_t state;
+  int        fd;
+  uint16_t   next_id;
+
+  // tx queue, tx_vec point into tx_buf or to caller buffers
+  SocketIOVec_t tx_vec[MQTT_CLIENT_TX_VEC_MAX];
+  int8_t     tx_vec_slot[MQTT_CLIENT_TX_VEC_MAX];  // Inflight slot of a caller buffer, or -1
+  int        tx_vec_count;
+  size_t     tx_len;
+  size_t     tx_sent;
+  uint32_t   last_tx_ms;
+
+  size_t     rx_len;
+  uint32_t   rx_skip;              // Bytes of a dropped packet still to be read
+  uint32_t   last_rx_ms;
+  bool       ping_outstanding;
+  uint32_t   ping_ms;
+
+  mqtt_inflight_t inflight[MQTT_CLIENT_INFLIGHT_MAX];
+  uint16_t   qos2_rx[MQTT_CLIENT_QOS2_RX_MAX];      // Packet ids, 0 if free
+};
+
+/**
+  * @brief  Encode the remaining length of a fixed header.
+  * @param  buf: 4 bytes at least.
+  * @param  len: 0 to MQTT_REM_LEN_MAX.
+  * @retval Bytes written, 1 to 4, or 0 if len is too big.
+  */
+int mqtt_rem_len_encode( uint8_t *buf, uint32_t len );
+
+/**
+  * @brief  Decode the remaining length of a fixed header, after its first byte.
+  * @param  buf: The bytes received.
+  * @param  avail: Number of bytes in buf.
+  * @param  len: The remaining length.
+  * @retval Bytes used, 1 to 4, 0 if more bytes are needed, or -1 if malformed.
+  */
+int mqtt_rem_len_decode( const uint8_t *buf, size_t avail, uint32_t *len );
+
+/* Set up the client, config is copied, its strings and buffers are used as given */
+OSStatus mqtt_client_init( mqtt_client_t *client, const mqtt_client_config_t *config );
+
+/* Start a session on a connected socket in non-block mode: CONNECT is queued.
+   Messages in the inflight window are sent again after CONNACK. */
+OSStatus mqtt_client_connect( mqtt_client_t *client, int fd );
+
+/* Queue DISCONNECT and try to send it. The socket is not closed. */
+OSStatus mqtt_client_disconnect( mqtt_client_t *client );
+
+/* Forget the socket after it is closed. QoS 0 messages not sent are dropped. */
+void mqtt_client_close( mqtt_client_t *client );
+
+/**
+  * @brief  Publish a message. topic and payload must not change until published()
+  *         is called for it, that can be before this function returns.
+  *         A QoS 1 or 2 message can be published while disconnected.
+  * @param  packet_id: The packet id, 0 for QoS 0, can be NULL.
+  * @retval kNoErr, kNoResourcesErr if the inflight window is full, kWouldBlockErr
+  *         if the tx queue is full: call mqtt_client_process() and try again.
+  */
+OSStatus mqtt_client_publish( mqtt_client_t *client, const char *topic, const uint8_t *payload,
+                              uint32_t len, uint8_t qos, bool retain, void *arg, uint16_t *packet_id );
+
+/* Subscribe or unsubscribe a topic, it must not change until subscribed() is called */
+OSStatus mqtt_client_subscribe( mqtt_client_t *client, const char *topic, uint8_t qos, uint16_t *packet_id );
+OSStatus mqtt_client_unsubscribe( mqtt_client_t *client, const char *topic, uint16_t *packet_id );
+
+/**
+  * @brief  Read and handle the packets received, send queued packets, retransmit
+  *         and keep alive. Call it when the socket is readable, or writable if
+  *         mqtt_client_want_write(), and at least every second.
+  * @retval kNoErr, or the error that ends the connection: close the socket.
+  */
+OSStatus mqtt_client_process( mqtt_client_t *client );
+
+/* There are queued bytes, wait for the socket to be writable as well */
+bool mqtt_client_want_write( mqtt_client_t *client );
@@ -0,0 +1,545 @@
+/**
+******************************************************************************
+* @file    sitewhere-bench.c
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   Batched SiteWhere measurements and in place command decoding, tested
+*          against the nanopb encoders and decoders, and the time of each.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+/* Built on the host, MICO/system/host holds the stub platform headers:
+ *
+ *   S=libraries/protocols/sitewhere
+ *   cc -O2 -DDEBUG=0 -DSITEWHERE_BENCH_MAIN -IMICO/system/host -Iinclude -Ilibraries/utilities -I$S \
+ *      $S/sitewhere-bench.c $S/sitewhere.c $S/sitewhere-arduino.pb.c $S/pb_encode.c $S/pb_decode.c \
+ *      $S/double_conversion.c -lm -o sitewhere-bench && ./sitewhere-bench
+ *
+ * On the target sitewhere_bench() can be called from a test command, results are then in ns from mico_get_time()
+ * instead of cycles.
+ */
+
+#include "Common.h"
+#include "Debug.h"
+#include "sitewhere.h"
+#include "pb_encode.h"
+#include "pb_decode.h"
+#include "double_conversion.h"
+
+#include <math.h>
+#include <stdio.h>
+
+#if( defined( __i386__ ) || defined( __x86_64__ ) )
+    #include <x86intrin.h>
+    #define sitewhere_bench_ticks()     ( (uint64_t) __rdtsc() )
+    #define kSW_BenchUnit               "cycles"
+    #define kSW_BenchScale              1
+#elif( defined( SITEWHERE_BENCH_MAIN ) )
+    #include <time.h>
+    static uint64_t sitewhere_bench_ticks( void )
+    {
+        struct timespec     ts;
+
+        clock_gettime( CLOCK_MONOTONIC, &ts );
+        return( ( (uint64_t) ts.tv_sec * 1000000000 ) + ts.tv_nsec );
+    }
+    #define kSW_BenchUnit               "ns"
+    #define kSW_BenchScale              1
+#else
+    #define sitewhere_bench_ticks()     ( (uint64_t) mico_get_time() )
+    #define kSW_BenchUnit               "ns"
+    #define kSW_BenchScale              1000000
+#endif
+
+#define kSW_BenchHardwareId         "MiCOKit-3288_000000"
+#define kSW_BenchBufSize            2048
+#define kSW_BenchHugeSize           ( 40 * 1024 )   // Over 16383 bytes, the message length takes 3 bytes
+#define kSW_BenchLoops              20000
+
+static char *               kSW_BenchNames[] = { "humidity", "temperature", "infrared", "light", "pressure" };
+static uint8_t              gSW_BenchBuf[ kSW_BenchBufSize ];
+static uint8_t              gSW_BenchRef[ kSW_BenchBufSize ];
+static uint8_t              gSW_BenchHuge[ kSW_BenchHugeSize ];
+static float                gSW_BenchValues[ 200 ];
+static uint32_t             gSW_BenchSeed = 1;
+static int                  gSW_BenchState;
+static char                 gSW_BenchOriginator[ 64 ];
+
+static uint32_t sitewhere_bench_rand( void )
+{
+    gSW_BenchSeed = gSW_BenchSeed * 1103515245 + 12345;
+    return( gSW_BenchSeed >> 8 );
+}
+
+//===========================================================================================================================
+//  sitewhere_bench_reference
+//
+//  sw_measurement() with its structs zeroed: the nanopb encoding of the same header and DeviceMeasurements.
+//===========================================================================================================================
+
+static unsigned int sitewhere_bench_reference( device_func *inCmd, uint8_t inCount, int64_t inDate, uint8_t *inBuf,
+                                               size_t inLen, char *inOriginator )
+{
+    pb_ostream_t                    stream = pb_ostream_from_buffer( inBuf, inLen );
+    SiteWhere_Header                header;
+    SiteWhere_DeviceMeasurements    measurements;
+    int                             i;
+
+    memset( &header, 0, sizeof( header ) );
+    header.command = SiteWhere_Command_DEVICEMEASUREMENT;
+    if( inOriginator )
+    {
+        header.has_originator = true;
+        strcpy( header.originator, inOriginator );
+    }
+    if( !pb_encode_delimited( &stream, SiteWhere_Header_fields, &header ) ) return( 0 );
+
+    memset( &measurements, 0, sizeof( measurements ) );
+    strcpy( measurements.hardwareId, kSW_BenchHardwareId );
+    for( i = 0; i < inCount; ++i )
+    {
+        strcpy( measurements.measurement[ i ].measurementId, inCmd[ i ].engine.temp );
+        measurements.measurement[ i ].measurementValue = float_to_double( inCmd[ i ].engine.value );
+    }
+    measurements.measurement_count = inCount;
+    if( inDate )
+    {
+        measurements.has_eventDate = true;
+        measurements.eventDate = inDate;
+    }
+    if( !pb_encode_delimited( &stream, SiteWhere_DeviceMeasurements_fields, &measurements ) ) return( 0 );
+    return( stream.bytes_written );
+}
+
+//===========================================================================================================================
+//  sitewhere_bench_read
+//
+//  Reads a batch back with sw_read_field(), checks each value against inValues if not NULL. Returns the number of
+//  measurements, -1 if the message is malformed.
+//===========================================================================================================================
+
+static int sitewhere_bench_read( const uint8_t *inBuf, size_t inLen, const float *inValues, int64_t *outDate )
+{
+    sw_header_t     header;
+    sw_reader_t     reader;
+    sw_field_t      field, sub;
+    float           value;
+    int             got, n = 0;
+
+    *outDate = 0;
+    if( !sw_decode_header( inBuf, inLen, &header ) ) return( -1 );
+    if( header.command != SiteWhere_Command_DEVICEMEASUREMENT || header.body.end != inBuf + inLen ) return( -1 );
+
+    while( sw_read_field( &header.body, &field ) )
+    {
+        if( field.tag == 2 )
+        {
+            reader.pos = field.data;
+            reader.end = field.data + field.size;
+            value = 0;
+            got = 0;
+            while( sw_read_field( &reader, &sub ) )
+            {
+                if( sub.tag == 1 ) got |= 1;
+                if( sub.tag == 2 ) { value = double_to_float( sub.value ); got |= 2; }
+            }
+            if( got != 3 || reader.pos != reader.end ) return( -1 );
+            if( inValues && !( value == inValues[ n ] || ( isnan( value ) && isnan( inValues[ n ] ) ) ) ) return( -1 );
+            ++n;
+        }
+        else if( field.tag == 3 )
+        {
+            *outDate = (int64_t) field.value;
+        }
+    }
+    return( ( header.body.pos == header.body.end ) ? n : -1 );
+}
+
+//===========================================================================================================================
+//  sitewhere_nanopb_test
+//
+//  Up to the 5 measurements of SiteWhere_DeviceMeasurements, a batch is byte for byte the nanopb message: with and
+//  without originator and event date, with zero, denormals, Inf and NaN that go through float_to_double().
+//===========================================================================================================================
+
+static OSStatus sitewhere_nanopb_test( void )
+{
+    static const float      kSpecial[] = { 0.0f, -0.0f, 1e-40f, -1e-45f, INFINITY, -INFINITY, NAN, 3.4e38f, -1.5f, 1e-38f };
+    OSStatus                err = kNoErr;
+    sw_measurements_t       batch;
+    device_func             cmd[ 5 ];
+    union { float f; uint32_t u; } value;
+    char *                  originator;
+    int64_t                 date;
+    unsigned int            len, ref;
+    int                     i, n, count;
+
+    for( i = 0; i < kSW_BenchLoops; ++i )
+    {
+        count = 1 + sitewhere_bench_rand() % 5;
+        originator = ( sitewhere_bench_rand() & 1 ) ? "orig-12345" : NULL;
+        date = ( sitewhere_bench_rand() & 1 ) ? ( (int64_t) sitewhere_bench_rand() << 20 ) : 0;
+
+        require_action( sw_measurements_begin( &batch, kSW_BenchHardwareId, gSW_BenchBuf, sizeof( gSW_BenchBuf ), originator ),
+            exit, err = kSizeErr );
+        for( n = 0; n < count; ++n )
+        {
+            value.u = sitewhere_bench_rand() ^ ( sitewhere_bench_rand() << 16 );
+            if( sitewhere_bench_rand() % 4 == 0 ) value.f = kSpecial[ sitewhere_bench_rand() % 10 ];
+            cmd[ n ].engine.temp = kSW_BenchNames[ sitewhere_bench_rand() % 5 ];
+            cmd[ n ].engine.value = value.f;
+            require_action( sw_measurements_add( &batch, cmd[ n ].engine.temp, value.f ), exit, err = kSizeErr );
+        }
+        len = sw_measurements_end( &batch, date );
+        ref = sitewhere_bench_reference( cmd, (uint8_t) count, date, gSW_BenchRef, sizeof( gSW_BenchRef ), originator );
+        require_action( len != 0 && len == ref, exit, err = kSizeErr );
+        require_action( memcmp( gSW_BenchBuf, gSW_BenchRef, len ) == 0, exit, err = kMismatchErr );
+    }
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  sitewhere_batch_test
+//
+//  More measurements than the struct holds, a buffer that fills up keeps what was added, a buffer too small for the
+//  header, and a message long enough for a 3 byte length.
+//===========================================================================================================================
+
+static OSStatus sitewhere_batch_test( void )
+{
+    OSStatus                err = kNoErr;
+    sw_measurements_t       batch;
+    uint8_t                 small[ 300 ];
+    unsigned int            len;
+    int64_t                 date;
+    size_t                  size;
+    int                     i, added;
+
+    require_action( sw_measurements_begin( &batch, "dev", gSW_BenchBuf, sizeof( gSW_BenchBuf ), NULL ), exit, err = kSizeErr );
+    for( i = 0; i < 60; ++i )
+    {
+        gSW_BenchValues[ i ] = i * 1.25f;
+        require_action( sw_measurements_add( &batch, kSW_BenchNames[ i % 5 ], gSW_BenchValues[ i ] ), exit, err = kSizeErr );
+    }
+    len = sw_measurements_end( &batch, 1234567 );
+    require_action( sitewhere_bench_read( gSW_BenchBuf, len, gSW_BenchValues, &date ) == 60, exit, err = kMismatchErr );
+    require_action( date == 1234567, exit, err = kMismatchErr );
+
+    // Full buffer: add fails, the message ends with what fit
+
+    require_action( sw_measurements_begin( &batch, "dev", small, sizeof( small ), "o" ), exit, err = kSizeErr );
+    for( added = 0; added < 200; ++added )
+    {
+        gSW_BenchValues[ added ] = (float) added;
+        if( !sw_measurements_add( &batch, kSW_BenchNames[ added % 5 ], gSW_BenchValues[ added ] ) ) break;
+    }
+    require_action( added > 0 && added < 200 && added == (int) batch.count, exit, err = kSizeErr );
+    len = sw_measurements_end( &batch, 0 );
+    require_action( len > 0 && len <= sizeof( small ), exit, err = kSizeErr );
+    require_action( sitewhere_bench_read( small, len, gSW_BenchValues, &date ) == added, exit, err = kMismatchErr );
+
+    // Header and hardware id take 30 bytes
+
+    for( size = 0; size < 40; ++size )
+    {
+        require_action( !sw_measurements_begin( &batch, kSW_BenchHardwareId, gSW_BenchBuf, size, "orig" ) || size >= 30,
+            exit, err = kSizeErr );
+    }
+
+    require_action( sw_measurements_begin( &batch, "dev", gSW_BenchHuge, sizeof( gSW_BenchHuge ), NULL ), exit, err = kSizeErr );
+    for( added = 0; sw_measurements_add( &batch, "temperature", (float) added ); ++added ) {}
+    len = sw_measurements_end( &batch, 0 );
+    require_action( len > 16383, exit, err = kSizeErr );
+    require_action( sitewhere_bench_read( gSW_BenchHuge, len, NULL, &date ) == added, exit, err = kMismatchErr );
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  sitewhere_reader_test
+//
+//  A field of each wire type, then every truncation: a field not whole is not returned and pos stays before it. Headers
+//  without a command are rejected.
+//===========================================================================================================================
+
+static OSStatus sitewhere_reader_test( void )
+{
+    static const uint8_t    kFields[] = { 0x08, 0x96, 0x01,                                         // 1: varint 150
+                                          0x11, 0x08, 0x07, 0x06, 0x05, 0x04, 0x03, 0x02, 0x01,     // 2: fixed64
+                                          0x1D, 0x04, 0x03, 0x02, 0x01,                             // 3: fixed32
+                                          0x22, 0x03, 'a', 'b', 'c' };                              // 4: "abc"
+    static const size_t     kEnds[] = { 3, 12, 17, 22 };
+    static const uint8_t    kNoCommand[] = { 0x04, 0x12, 0x02, 'a', 'b', 0x00 };
+    static const uint8_t    kCommand[] = { 0x06, 0x08, 0x01, 0x12, 0x02, 'a', 'b' };
+    OSStatus                err = kNoErr;
+    sw_reader_t             reader;
+    sw_field_t              field[ 4 ];
+    sw_header_t             header;
+    uint8_t *               copy = NULL;
+    size_t                  n, i;
+
+    reader.pos = kFields;
+    reader.end = kFields + sizeof( kFields );
+    for( i = 0; i < 4; ++i ) require_action( sw_read_field( &reader, &field[ i ] ), exit, err = kMalformedErr );
+    require_action( !sw_read_field( &reader, &field[ 0 ] ) && reader.pos == reader.end, exit, err = kMalformedErr );
+    require_action( field[ 0 ].tag == 1 && field[ 0 ].wireType == PB_WT_VARINT && field[ 0 ].value == 150, exit, err = kMismatchErr );
+    require_action( field[ 1 ].tag == 2 && field[ 1 ].value == 0x0102030405060708ULL, exit, err = kMismatchErr );
+    require_action( field[ 2 ].tag == 3 && field[ 2 ].value == 0x01020304, exit, err = kMismatchErr );
+    require_action( field[ 3 ].tag == 4 && field[ 3 ].size == 3 && memcmp( field[ 3 ].data, "abc", 3 ) == 0, exit,
+        err = kMismatchErr );
+
+    // Each truncation in its own allocation, so reads past its end are caught
+
+    for( n = 0; n < sizeof( kFields ); ++n )
+    {
+        copy = malloc( n ? n : 1 );
+        require_action( copy, exit, err = kNoMemoryErr );
+        memcpy( copy, kFields, n );
+        reader.pos = copy;
+        reader.end = copy + n;
+        for( i = 0; sw_read_field( &reader, &field[ 0 ] ); ++i ) {}
+        require_action( i < 4 && kEnds[ i ] > n && reader.pos == copy + ( i ? kEnds[ i - 1 ] : 0 ), exit, err = kMalformedErr );
+        free( copy );
+        copy = NULL;
+    }
+
+    require_action( !sw_decode_header( kNoCommand, sizeof( kNoCommand ), &header ), exit, err = kMalformedErr );
+    require_action( sw_decode_header( kCommand, sizeof( kCommand ), &header ), exit, err = kMalformedErr );
+    require_action( header.command == 1 && header.originatorSize == 2 && header.body.pos == header.body.end, exit,
+        err = kMismatchErr );
+
+exit:
+    if( copy ) free( copy );
+    return( err );
+}
+
+//===========================================================================================================================
+//  sitewhere_dispatch_test
+//
+//  A registration ack encoded by nanopb reaches its handler, with the originator in place. Every truncation of it and
+//  random payloads are rejected without reading outside the payload, run it under ASan to see that.
+//===========================================================================================================================
+
+static void sitewhere_bench_ack( const sw_header_t *inHeader, sw_reader_t *inBody )
+{
+    sw_field_t      field;
+
+    gSW_BenchState = 0;
+    while( sw_read_field( inBody, &field ) )
+    {
+        if( field.tag == Device_RegistrationAck_state_tag ) gSW_BenchState = (int) field.value;
+    }
+    memcpy( gSW_BenchOriginator, inHeader->originator, inHeader->originatorSize );
+    gSW_BenchOriginator[ inHeader->originatorSize ] = '\0';
+}
+
+static const sw_command_t   kSW_BenchCommands[] = { { Device_Command_REGISTER_ACK, sitewhere_bench_ack } };
+static const sw_command_t   kSW_BenchUnordered[] = { { 7, NULL }, { Device_Command_REGISTER_ACK, sitewhere_bench_ack } };
+
+static size_t sitewhere_bench_encode_ack( uint8_t *inBuf, size_t inLen )
+{
+    pb_ostream_t                stream = pb_ostream_from_buffer( inBuf, inLen );
+    Device_Header               header;
+    Device_RegistrationAck      ack;
+
+    memset( &header, 0, sizeof( header ) );
+    header.command = Device_Command_REGISTER_ACK;
+    header.has_originator = true;
+    strcpy( header.originator, "abc123" );
+    memset( &ack, 0, sizeof( ack ) );
+    ack.state = Device_RegistrationAckState_ALREADY_REGISTERED;
+    ack.has_errorMessage = true;
+    strcpy( ack.errorMessage, "none" );
+    if( !pb_encode_delimited( &stream, Device_Header_fields, &header ) ) return( 0 );
+    if( !pb_encode_delimited( &stream, Device_RegistrationAck_fields, &ack ) ) return( 0 );
+    return( stream.bytes_written );
+}
+
+static OSStatus sitewhere_dispatch_test( void )
+{
+    OSStatus        err = kNoErr;
+    sw_header_t     header;
+    uint8_t *       copy = NULL;
+    size_t          len, n, i;
+
+    len = sitewhere_bench_encode_ack( gSW_BenchRef, sizeof( gSW_BenchRef ) );
+    require_action( len, exit, err = kSizeErr );
+
+    gSW_BenchState = -1;
+    require_action( sw_dispatch( gSW_BenchRef, len, kSW_BenchCommands, 1 ), exit, err = kNotHandledErr );
+    require_action( gSW_BenchState == Device_RegistrationAckState_ALREADY_REGISTERED, exit, err = kMismatchErr );
+    require_action( strcmp( gSW_BenchOriginator, "abc123" ) == 0, exit, err = kMismatchErr );
+    gSW_BenchState = -1;
+    require_action( sw_dispatch( gSW_BenchRef, len, kSW_BenchUnordered, 2 ), exit, err = kNotHandledErr );
+    require_action( gSW_BenchState == Device_RegistrationAckState_ALREADY_REGISTERED, exit, err = kMismatchErr );
+    require_action( !sw_dispatch( gSW_BenchRef, len, kSW_BenchUnordered, 1 ), exit, err = kMismatchErr );
+    require_action( sw_decode_header( gSW_BenchRef, len, &header ), exit, err = kMalformedErr );
+    require_action( header.present == ( ( 1 << 1 ) | ( 1 << 2 ) ), exit, err = kMismatchErr );
+
+    // Each truncation in its own allocation, so reads past its end are caught
+
+    for( n = 0; n < len; ++n )
+    {
+        copy = malloc( n ? n : 1 );
+        require_action( copy, exit, err = kNoMemoryErr );
+        memcpy( copy, gSW_BenchRef, n );
+        require_action( !sw_decode_header( copy, n, &header ) || header.body.end <= copy + n, exit, err = kMalformedErr );
+        sw_dispatch( copy, n, kSW_BenchCommands, 1 );
+        free( copy );
+        copy = NULL;
+    }
+
+    for( i = 0; i < 200000; ++i )
+    {
+        n = sitewhere_bench_rand() % 64;
+        copy = malloc( n ? n : 1 );
+        require_action( copy, exit, err = kNoMemoryErr );
+        for( len = 0; len < n; ++len ) copy[ len ] = (uint8_t) sitewhere_bench_rand();
+        sw_dispatch( copy, n, kSW_BenchCommands, 1 );
+        free( copy );
+        copy = NULL;
+    }
+
+exit:
+    if( copy ) free( copy );
+    return( err );
+}
+
+//===========================================================================================================================
+//  sitewhere_bench_report
+//===========================================================================================================================
+
+static void sitewhere_bench_report( const char *inMode, unsigned int inBytes, uint64_t inTicks, size_t inCount )
+{
+    printf( "%-40s %5u bytes: %10.2f %s\n", inMode, inBytes, ( (double) inTicks * kSW_BenchScale ) / (double) inCount,
+        kSW_BenchUnit );
+}
+
+//===========================================================================================================================
+//  sitewhere_bench
+//===========================================================================================================================
+
+OSStatus    sitewhere_bench( int print )
+{
+    OSStatus                err;
+    sw_measurements_t       batch;
+    device_func             cmd[ 5 ];
+    Device_Header           header;
+    Device_RegistrationAck  ack;
+    pb_istream_t            stream;
+    uint64_t                t;
+    unsigned int            bytes = 0;
+    size_t                  len;
+    int                     i, n;
+    volatile unsigned int   sink = 0;
+
+    err = sitewhere_nanopb_test();
+    require_noerr( err, exit );
+    err = sitewhere_batch_test();
+    require_noerr( err, exit );
+    err = sitewhere_reader_test();
+    require_noerr( err, exit );
+    err = sitewhere_dispatch_test();
+    require_noerr( err, exit );
+    if( !print ) goto exit;
+
+    for( i = 0; i < 5; ++i )
+    {
+        cmd[ i ].engine.temp = kSW_BenchNames[ i ];
+        cmd[ i ].engine.value = 20.5f + i;
+    }
+
+    // 5 measurements, the most sw_measurement() sends in a message
+
+    t = sitewhere_bench_ticks();
+    for( i = 0; i < kSW_BenchLoops; ++i )
+    {
+        cmd[ 0 ].engine.value = (float) i;
+        sink += bytes = sw_measurement( kSW_BenchHardwareId, cmd, 5, 0, gSW_BenchRef, sizeof( gSW_BenchRef ), NULL );
+    }
+    sitewhere_bench_report( "5 measurements, sw_measurement", bytes, sitewhere_bench_ticks() - t, kSW_BenchLoops );
+
+    t = sitewhere_bench_ticks();
+    for( i = 0; i < kSW_BenchLoops; ++i )
+    {
+        sw_measurements_begin( &batch, kSW_BenchHardwareId, gSW_BenchBuf, sizeof( gSW_BenchBuf ), NULL );
+        for( n = 0; n < 5; ++n ) sw_measurements_add( &batch, kSW_BenchNames[ n ], n ? cmd[ n ].engine.value : (float) i );
+        sink += bytes = sw_measurements_end( &batch, 0 );
+    }
+    sitewhere_bench_report( "5 measurements, batch", bytes, sitewhere_bench_ticks() - t, kSW_BenchLoops );
+
+    // 50 measurements: 10 messages or one batch
+
+    t = sitewhere_bench_ticks();
+    for( i = 0; i < kSW_BenchLoops / 10; ++i )
+    {
+        bytes = 0;
+        for( n = 0; n < 10; ++n ) bytes += sw_measurement( kSW_BenchHardwareId, cmd, 5, 0, gSW_BenchRef, sizeof( gSW_BenchRef ), NULL );
+        sink += bytes;
+    }
+    sitewhere_bench_report( "50 measurements, 10 x sw_measurement", bytes, sitewhere_bench_ticks() - t, kSW_BenchLoops / 10 );
+
+    t = sitewhere_bench_ticks();
+    for( i = 0; i < kSW_BenchLoops / 10; ++i )
+    {
+        sw_measurements_begin( &batch, kSW_BenchHardwareId, gSW_BenchBuf, sizeof( gSW_BenchBuf ), NULL );
+        for( n = 0; n < 50; ++n ) sw_measurements_add( &batch, kSW_BenchNames[ n % 5 ], cmd[ n % 5 ].engine.value );
+        sink += bytes = sw_measurements_end( &batch, 0 );
+    }
+    sitewhere_bench_report( "50 measurements, batch", bytes, sitewhere_bench_ticks() - t, kSW_BenchLoops / 10 );
+
+    // A registration ack decoded into the nanopb structs, or read in place
+
+    len = sitewhere_bench_encode_ack( gSW_BenchRef, sizeof( gSW_BenchRef ) );
+    t = sitewhere_bench_ticks();
+    for( i = 0; i < kSW_BenchLoops; ++i )
+    {
+        stream = pb_istream_from_buffer( gSW_BenchRef, len );
+        if( pb_decode_delimited( &stream, Device_Header_fields, &header ) &&
+            pb_decode_delimited( &stream, Device_RegistrationAck_fields, &ack ) ) sink += ack.state;
+    }
+    sitewhere_bench_report( "registration ack, pb_decode_delimited", (unsigned int) len, sitewhere_bench_ticks() - t,
+        kSW_BenchLoops );
+    printf( "  %u bytes of structs on the stack\n", (unsigned int)( sizeof( header ) + sizeof( ack ) ) );
+
+    t = sitewhere_bench_ticks();
+    for( i = 0; i < kSW_BenchLoops; ++i ) sink += sw_dispatch( gSW_BenchRef, len, kSW_BenchCommands, 1 );
+    sitewhere_bench_report( "registration ack, sw_dispatch", (unsigned int) len, sitewhere_bench_ticks() - t, kSW_BenchLoops );
+    (void) sink;
+
+exit:
+    printf( "%s: %s\n", __FUNCTION__, !err ? "PASSED" : "FAILED" );
+    return( err );
+}
+
+#if( defined( SITEWHERE_BENCH_MAIN ) )
+int main( void )
+{
+    return( sitewhere_bench( 1 ) ? 1 : 0 );
+}
+#endif
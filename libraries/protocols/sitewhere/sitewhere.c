@@ -0,0 +1,458 @@
+#include "sitewhere.h"
+#include "sitewhere-arduino.pb.h"
+#include "pb_encode.h"
+#include "double_conversion.h"
+
+// Signals end of stream.
+uint8_t zero = 0;
+
+unsigned int sw_register(char* hardwareId, char* specificationToken, uint8_t* buffer, size_t length, char* originator) {
+	pb_ostream_t stream = pb_ostream_from_buffer(buffer, length);
+
+	SiteWhere_Header header;
+	header.command = SiteWhere_Command_REGISTER;
+	if (originator != NULL) {
+		header.has_originator = true;
+		strcpy(header.originator, originator);
+	}
+	if (!pb_encode_delimited(&stream, SiteWhere_Header_fields, &header)) {
+		return 0;
+	}
+
+	SiteWhere_RegisterDevice registerDevice;
+	strcpy(registerDevice.hardwareId, hardwareId);
+	strcpy(registerDevice.specificationToken, specificationToken);
+	if (!pb_encode_delimited(&stream, SiteWhere_RegisterDevice_fields, &registerDevice)) {
+		return 0;
+	}
+
+	return stream.bytes_written;
+}
+
+unsigned int sw_acknowledge(char* hardwareId, char* message, uint8_t* buffer, size_t length, char* originator) {
+	pb_ostream_t stream = pb_ostream_from_buffer(buffer, length);
+
+	SiteWhere_Header header;
+	header.command = SiteWhere_Command_ACKNOWLEDGE;
+	if (originator != NULL) {
+		header.has_originator = true;
+		strcpy(header.originator, originator);
+	}
+	if (!pb_encode_delimited(&stream, SiteWhere_Header_fields, &header)) {
+		return 0;
+	}
+
+	SiteWhere_Acknowledge ack;
+	strcpy(ack.hardwareId, hardwareId);
+	if (message != NULL) {
+		ack.has_message = true;
+		strcpy(ack.message, message);
+	}
+	if (!pb_encode_delimited(&stream, SiteWhere_Acknowledge_fields, &ack)) {
+		return 0;
+	}
+
+	return stream.bytes_written;
+}
+
+unsigned int sw_measurement(char* hardwareId,device_func *cmd,uint8_t count, int64_t eventDate,uint8_t* buffer, size_t length, char* originator)
+{
+	pb_ostream_t stream = pb_ostream_from_buffer(buffer, length);
+
+	SiteWhere_Header header;
+	memset(&header, 0, sizeof(header));
+	header.command = SiteWhere_Command_DEVICEMEASUREMENT;
+	if (originator != NULL) {
+		header.has_originator = true;
+		strcpy(header.originator, originator);
+	}
+	if (!pb_encode_delimited(&stream, SiteWhere_Header_fields, &header)) {
+		return 0;
+	}
+
+	SiteWhere_DeviceMeasurements measurements;
+	memset(&measurements, 0, sizeof(measurements));
+	strcpy(measurements.hardwareId, hardwareId);
+
+	SiteWhere_Measurement measurement;
+
+        for(uint8_t i=0;i<count;i++)
+        {
+            strcpy(measurement.measurementId, cmd[i].engine.temp);
+            measurement.measurementValue = float_to_double(cmd[i].engine.value);
+            measurements.measurement[i] = measurement;
+        }
+        measurements.measurement_count = count;
+
+	if (eventDate != 0) {
+		measurements.has_eventDate = true;
+		measurements.eventDate = eventDate;
+	}
+	if (!pb_encode_delimited(&stream, SiteWhere_DeviceMeasurements_fields, &measurements)) {
+		return 0;
+	}
+
+	return stream.bytes_written;
+}
+
+unsigned int sw_location(char* hardwareId, float lat, float lon, float ele, int64_t eventDate,
+		uint8_t* buffer, size_t length, char* originator) {
+	pb_ostream_t stream = pb_ostream_from_buffer(buffer, length);
+
+	SiteWhere_Header header;
+	header.command = SiteWhere_Command_DEVICELOCATION;
+	if (originator != NULL) {
+		header.has_originator = true;
+		strcpy(header.originator, originator);
+	}
+	if (!pb_encode_delimited(&stream, SiteWhere_Header_fields, &header)) {
+		return 0;
+	}
+
+	SiteWhere_DeviceLocation location;
+	strcpy(location.hardwareId, hardwareId);
+	location.latitude = float_to_double(lat);
+	location.longitude = float_to_double(lon);
+	location.elevation = float_to_double(ele);
+	location.has_elevation = true;
+
+	if (eventDate != 0) {
+		location.has_eventDate = true;
+		location.eventDate = eventDate;
+	}
+	if (!pb_encode_delimited(&stream, SiteWhere_DeviceLocation_fields, &location)) {
+		return 0;
+	}
+
+	return stream.bytes_written;
+}
+//sw_alert(hardwareId, "arduino.alive", "The Arduino is alive!", NULL, buffer, sizeof(buffer), NULL))
+unsigned int sw_alert(char* hardwareId, char* alertType, char* alertMessage, int64_t eventDate,
+		uint8_t* buffer, size_t length, char* originator) {
+	pb_ostream_t stream = pb_ostream_from_buffer(buffer, length);
+
+	SiteWhere_Header header;
+	header.command = SiteWhere_Command_DEVICEALERT;
+	if (originator != NULL) {
+		header.has_originator = true;
+		strcpy(header.originator, originator);
+	}
+	if (!pb_encode_delimited(&stream, SiteWhere_Header_fields, &header)) {
+		return 0;
+	}
+
+	SiteWhere_DeviceAlert alert;
+	strcpy(alert.hardwareId, hardwareId);
+	strcpy(alert.alertType, alertType);
+	strcpy(alert.alertMessage, alertMessage);
+	if (eventDate != 0) {
+		alert.has_eventDate = true;
+		alert.eventDate = eventDate;
+	}
+	if (!pb_encode_delimited(&stream, SiteWhere_DeviceAlert_fields, &alert)) {
+		return 0;
+	}
+
+	return stream.bytes_written;
+}
+
+/* Batched measurements are written without nanopb: the field descriptors are not walked
+ * for each value, and the count is not limited to the measurement array of the struct. */
+
+/* Room kept for the DeviceMeasurements length, up to 2097151 bytes */
+#define SW_PREFIX_MAX 3
+
+/* Measurement tags as in SiteWhere_Measurement_fields, which is what is sent today.
+ * The SiteWhere_Measurement_*_tag macros follow the .proto and are one higher. */
+#define SW_MEASUREMENT_ID_TAG		1
+#define SW_MEASUREMENT_VALUE_TAG	2
+
+static size_t sw_varint_size(uint64_t value) {
+	size_t size = 1;
+	while (value >>= 7) {
+		size++;
+	}
+	return size;
+}
+
+static bool sw_put_varint(sw_measurements_t* batch, uint64_t value) {
+	do {
+		if (batch->pos >= batch->length) {
+			batch->overflow = true;
+			return false;
+		}
+		batch->buffer[batch->pos++] = (value > 0x7F) ? ((value & 0x7F) | 0x80) : value;
+		value >>= 7;
+	} while (value);
+	return true;
+}
+
+static bool sw_put_string(sw_measurements_t* batch, uint32_t tag, const char* value, size_t size) {
+	if (!sw_put_varint(batch, (tag << 3) | PB_WT_STRING) || !sw_put_varint(batch, size)) {
+		return false;
+	}
+	if (batch->length - batch->pos < size) {
+		batch->overflow = true;
+		return false;
+	}
+	memcpy(batch->buffer + batch->pos, value, size);
+	batch->pos += size;
+	return true;
+}
+
+static bool sw_put_fixed64(sw_measurements_t* batch, uint32_t tag, uint64_t value) {
+	int i;
+	if (!sw_put_varint(batch, (tag << 3) | PB_WT_64BIT)) {
+		return false;
+	}
+	if (batch->length - batch->pos < 8) {
+		batch->overflow = true;
+		return false;
+	}
+	for (i = 0; i < 8; i++) {
+		batch->buffer[batch->pos++] = value & 0xFF;
+		value >>= 8;
+	}
+	return true;
+}
+
+/* float_to_double() without its branches for normal numbers */
+static uint64_t sw_float_to_double(float value) {
+	union {
+		float f;
+		uint32_t i;
+	} in;
+	uint32_t exponent;
+
+	in.f = value;
+	exponent = (in.i >> 23) & 0xFF;
+	if (exponent == 0 || exponent == 0xFF) {
+		return float_to_double(value);
+	}
+	return ((uint64_t)(in.i >> 31) << 63) | ((uint64_t)(exponent - 127 + 1023) << 52)
+			| ((uint64_t)(in.i & 0x7FFFFF) << 29);
+}
+
+bool sw_measurements_begin(sw_measurements_t* batch, char* hardwareId, uint8_t* buffer, size_t length,
+		char* originator) {
+	size_t originatorSize = (originator != NULL) ? strlen(originator) : 0;
+	size_t headerSize = 2;
+
+	memset(batch, 0, sizeof(sw_measurements_t));
+	batch->buffer = buffer;
+	batch->length = length;
+
+	// Header: command, originator
+	if (originator != NULL) {
+		headerSize += 1 + sw_varint_size(originatorSize) + originatorSize;
+	}
+	if (!sw_put_varint(batch, headerSize)
+			|| !sw_put_varint(batch, (SiteWhere_Header_command_tag << 3) | PB_WT_VARINT)
+			|| !sw_put_varint(batch, SiteWhere_Command_DEVICEMEASUREMENT)) {
+		return false;
+	}
+	if (originator != NULL && !sw_put_string(batch, SiteWhere_Header_originator_tag, originator, originatorSize)) {
+		return false;
+	}
+
+	// DeviceMeasurements, its length is written by sw_measurements_end()
+	batch->start = batch->pos;
+	if (batch->length - batch->pos < SW_PREFIX_MAX) {
+		batch->overflow = true;
+		return false;
+	}
+	batch->pos += SW_PREFIX_MAX;
+	return sw_put_string(batch, SiteWhere_DeviceMeasurements_hardwareId_tag, hardwareId, strlen(hardwareId));
+}
+
+bool sw_measurements_add(sw_measurements_t* batch, const char* measurementId, float value) {
+	size_t idSize = strlen(measurementId);
+	size_t pos = batch->pos;
+
+	if (batch->overflow) {
+		return false;
+	}
+	if (!sw_put_varint(batch, (SiteWhere_DeviceMeasurements_measurement_tag << 3) | PB_WT_STRING)
+			|| !sw_put_varint(batch, 1 + sw_varint_size(idSize) + idSize + 1 + 8)
+			|| !sw_put_string(batch, SW_MEASUREMENT_ID_TAG, measurementId, idSize)
+			|| !sw_put_fixed64(batch, SW_MEASUREMENT_VALUE_TAG, sw_float_to_double(value))) {
+		// The measurements added so far can still be sent
+		batch->pos = pos;
+		batch->overflow = false;
+		return false;
+	}
+	batch->count++;
+	return true;
+}
+
+unsigned int sw_measurements_end(sw_measurements_t* batch, int64_t eventDate) {
+	size_t size, prefix;
+	uint8_t* message;
+
+	if (eventDate != 0) {
+		sw_put_fixed64(batch, SiteWhere_DeviceMeasurements_eventDate_tag, eventDate);
+	}
+	if (batch->overflow) {
+		return 0;
+	}
+
+	size = batch->pos - batch->start - SW_PREFIX_MAX;
+	prefix = sw_varint_size(size);
+	if (prefix > SW_PREFIX_MAX) {
+		return 0;
+	}
+	message = batch->buffer + batch->start;
+	memmove(message + prefix, message + SW_PREFIX_MAX, size);
+	batch->pos = batch->start;
+	sw_put_varint(batch, size);
+	batch->pos += size;
+	return batch->pos;
+}
+
+/* Messages received are read in place, strings are not copied out of the payload. */
+
+static bool sw_get_varint(sw_reader_t* reader, uint64_t* value) {
+	uint64_t result = 0;
+	unsigned int shift;
+
+	for (shift = 0; shift < 64 && reader->pos < reader->end; shift += 7) {
+		uint8_t byte = *reader->pos++;
+		result |= (uint64_t)(byte & 0x7F) << shift;
+		if (!(byte & 0x80)) {
+			*value = result;
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool sw_get_delimited(sw_reader_t* reader, sw_reader_t* message) {
+	uint64_t size;
+
+	if (!sw_get_varint(reader, &size) || size > (uint64_t)(reader->end - reader->pos)) {
+		return false;
+	}
+	message->pos = reader->pos;
+	message->end = reader->pos + size;
+	reader->pos = message->end;
+	return true;
+}
+
+bool sw_read_field(sw_reader_t* reader, sw_field_t* field) {
+	const uint8_t* start = reader->pos;
+	uint64_t key;
+	size_t size = 0;
+	int i;
+
+	if (reader->pos >= reader->end || !sw_get_varint(reader, &key)) {
+		goto error;
+	}
+	field->tag = key >> 3;
+	field->wireType = (pb_wire_type_t)(key & 0x07);
+	field->value = 0;
+	field->data = NULL;
+	field->size = 0;
+
+	switch (field->wireType) {
+	case PB_WT_VARINT:
+		if (!sw_get_varint(reader, &field->value)) {
+			goto error;
+		}
+		return true;
+	case PB_WT_64BIT:
+		size = 8;
+		break;
+	case PB_WT_32BIT:
+		size = 4;
+		break;
+	case PB_WT_STRING: {
+		sw_reader_t data;
+		if (!sw_get_delimited(reader, &data)) {
+			goto error;
+		}
+		field->data = data.pos;
+		field->size = data.end - data.pos;
+		return true;
+	}
+	default:
+		goto error;
+	}
+
+	// Fixed32 and fixed64 are little-endian
+	if ((size_t)(reader->end - reader->pos) < size) {
+		goto error;
+	}
+	for (i = size - 1; i >= 0; i--) {
+		field->value = (field->value << 8) | reader->pos[i];
+	}
+	reader->pos += size;
+	return true;
+
+error:
+	// pos is left before a malformed field, it is at end after the last one
+	reader->pos = start;
+	return false;
+}
+
+bool sw_decode_header(const uint8_t* payload, size_t length, sw_header_t* header) {
+	sw_reader_t reader, fields;
+	sw_field_t field;
+
+	memset(header, 0, sizeof(sw_header_t));
+	reader.pos = payload;
+	reader.end = payload + length;
+	if (!sw_get_delimited(&reader, &fields)) {
+		return false;
+	}
+
+	while (sw_read_field(&fields, &field)) {
+		if (field.tag < 32) {
+			header->present |= (uint32_t)1 << field.tag;
+		}
+		if (field.tag == Device_Header_command_tag && field.wireType == PB_WT_VARINT) {
+			header->command = field.value;
+		} else if (field.wireType != PB_WT_STRING) {
+			continue;
+		} else if (field.tag == Device_Header_originator_tag) {
+			header->originator = (const char*)field.data;
+			header->originatorSize = field.size;
+		} else if (field.tag == Device_Header_nestedPath_tag) {
+			header->nestedPath = (const char*)field.data;
+			header->nestedPathSize = field.size;
+		} else if (field.tag == Device_Header_nestedSpec_tag) {
+			header->nestedSpec = (const char*)field.data;
+			header->nestedSpecSize = field.size;
+		}
+	}
+	if (fields.pos != fields.end || !(header->present & ((uint32_t)1 << Device_Header_command_tag))) {
+		return false;
+	}
+
+	// A command can come without a message after its header
+	if (reader.pos == reader.end) {
+		header->body = reader;
+		return true;
+	}
+	return sw_get_delimited(&reader, &header->body);
+}
+
+bool sw_dispatch(const uint8_t* payload, size_t length, const sw_command_t* commands, unsigned int count) {
+	sw_header_t header;
+	unsigned int i;
+
+	if (!sw_decode_header(payload, length, &header)) {
+		return false;
+	}
+
+	// Tables are usually in command order, from 1
+	i = header.command - 1;
+	if (i >= count || commands[i].command != header.command) {
+		for (i = 0; i < count && commands[i].command != header.command; i++)
+			;
+	}
+	if (i == count) {
+		return false;
+	}
+	commands[i].handler(&header, &header.body);
+	return true;
+}
@@ -0,0 +1,105 @@
+/**
+ * sitewhere.h - Library for interacting with SiteWhere using Google Protocol Buffers.
+ * See https://developers.google.com/protocol-buffers/ for details on protocol buffers.
+ * The lightweight C implementation was generated with nanopb (http://code.google.com/p/nanopb/).
+ *
+ * Copyright 2013-2014 Reveal Technologies LLC.
+ */
+#ifndef sitewhere_h
+#define sitewhere_h
+#include "sitewhere-arduino.pb.h"
+#include "Mico.h"
+//#include "Arduino.h"//weiruan
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Create an encoded registration message for sending to SiteWhere */
+unsigned int sw_register(char* hardwareId, char* specificationToken, uint8_t* buffer, size_t length,
+		char* originator);
+
+/** Create an encoded acknowledgement message for sending to SiteWhere */
+unsigned int sw_acknowledge(char* hardwareId, char* message, uint8_t* buffer, size_t length, char* originator);
+
+/** Create an encoded measurement message for sending to SiteWhere */
+unsigned int sw_measurement(char* hardwareId,device_func *cmd,uint8_t count, int64_t eventDate,uint8_t* buffer, size_t length, char* originator);
+
+/** Create an encoded location message for sending to SiteWhere */
+unsigned int sw_location(char* hardwareId, float lat, float lon, float elevation, int64_t eventDate,
+		uint8_t* buffer, size_t length, char* originator);
+
+/** Create an encoded alert message for sending to SiteWhere */
+unsigned int sw_alert(char* hardwareId, char* type, char* message, int64_t eventDate,
+		uint8_t* buffer, size_t length, char* originator);
+
+/** Measurements batched in one DeviceMeasurements message, written straight into the buffer */
+typedef struct {
+	uint8_t* buffer;
+	size_t length;
+	size_t start;		/* Length prefix of the DeviceMeasurements message */
+	size_t pos;
+	unsigned int count;
+	bool overflow;
+} sw_measurements_t;
+
+/** Start a batch: the header and hardware id are encoded, originator can be NULL */
+bool sw_measurements_begin(sw_measurements_t* batch, char* hardwareId, uint8_t* buffer, size_t length,
+		char* originator);
+
+/** Add a measurement to a batch, false if the buffer is full */
+bool sw_measurements_add(sw_measurements_t* batch, const char* measurementId, float value);
+
+/** End a batch, eventDate is 0 if not sent. Returns the message length, 0 if it did not fit. */
+unsigned int sw_measurements_end(sw_measurements_t* batch, int64_t eventDate);
+
+/** Reads the fields of an encoded message in place */
+typedef struct {
+	const uint8_t* pos;
+	const uint8_t* end;
+} sw_reader_t;
+
+/** A field read by sw_read_field(), strings and sub-messages point into the message */
+typedef struct {
+	uint32_t tag;
+	pb_wire_type_t wireType;
+	uint64_t value;			/* Varint, fixed32 or fixed64 */
+	const uint8_t* data;	/* Length-delimited */
+	size_t size;
+} sw_field_t;
+
+/** Read the next field, false at the end of the message or if it is malformed */
+bool sw_read_field(sw_reader_t* reader, sw_field_t* field);
+
+/** Header of a message received, its strings are not NUL-terminated */
+typedef struct {
+	uint32_t command;
+	uint32_t present;		/* Bit n set if field n was received */
+	const char* originator;
+	size_t originatorSize;
+	const char* nestedPath;
+	size_t nestedPathSize;
+	const char* nestedSpec;
+	size_t nestedSpecSize;
+	sw_reader_t body;		/* The message that follows the header */
+} sw_header_t;
+
+/** Decode the delimited header of a payload, and find the delimited message after it */
+bool sw_decode_header(const uint8_t* payload, size_t length, sw_header_t* header);
+
+/** Handler of a command, the body is read with sw_read_field() */
+typedef void (*sw_command_handler_t)(const sw_header_t* header, sw_reader_t* body);
+
+typedef struct {
+	uint32_t command;
+	sw_command_handler_t handler;
+} sw_command_t;
+
+/** Decode the header and call the handler of its command, false if there is none */
+bool sw_dispatch(const uint8_t* payload, size_t length, const sw_command_t* commands, unsigned int count);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif
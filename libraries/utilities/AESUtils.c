@@ -38,6 +38,11 @@ void AES_cbc_encrypt(const unsigned char *in, unsigned char *out,
 
 #define aes_log(M, ...) custom_log("AES", M, ##__VA_ARGS__)
 
+// Counter blocks encrypted per pass of AES_CTR_Update, the key material is on the stack.
+#if( !defined( AES_CTR_BULK_BLOCKS ) )
+    #define AES_CTR_BULK_BLOCKS     4
+#endif
+
 //===========================================================================================================================
 //  AES_CTR_Init
 //===========================================================================================================================
@@ -91,6 +96,76 @@ static inline void AES_CTR_Increment( uint8_t *inCounter )
     }
 }
 
+//===========================================================================================================================
+//  AES_CTR_Keystream
+//
+//  Encrypts the next inBlocks counter values into inKey and increments the counter past them. The counters are encrypted
+//  in one call when the backend takes several blocks, so its setup is paid once per bulk pass instead of per block.
+//===========================================================================================================================
+
+static OSStatus AES_CTR_Keystream( AES_CTR_Context *inContext, uint8_t *inKey, size_t inBlocks )
+{
+    OSStatus        err;
+    uint8_t *       ptr;
+    size_t          i;
+    
+#if( AES_UTILS_USE_COMMON_CRYPTO || AES_UTILS_USE_GLADMAN_AES )
+    for( ptr = inKey, i = 0; i < inBlocks; ++i, ptr += kAES_CTR_Size )
+    {
+        memcpy( ptr, inContext->ctr, kAES_CTR_Size );
+        AES_CTR_Increment( inContext->ctr );
+    }
+    #if( AES_UTILS_USE_COMMON_CRYPTO )
+        err = CCCryptorUpdate( inContext->cryptor, inKey, inBlocks * kAES_CTR_Size, inKey, inBlocks * kAES_CTR_Size, &i );
+        require_noerr( err, exit );
+        require_action( i == inBlocks * kAES_CTR_Size, exit, err = kSizeErr );
+    #else
+        aes_ecb_encrypt( inKey, inKey, (int)( inBlocks * kAES_CTR_Size ), &inContext->ctx );
+    #endif
+#else
+    for( ptr = inKey, i = 0; i < inBlocks; ++i, ptr += kAES_CTR_Size )
+    {
+        #if( AES_UTILS_USE_MICO_AES )
+            AesEncryptDirect( &inContext->ctx, ptr, inContext->ctr );
+        #elif( AES_UTILS_USE_USSL )
+            aes_crypt_ecb( &inContext->ctx, AES_ENCRYPT, inContext->ctr, ptr );
+        #else
+            AES_encrypt( inContext->ctr, ptr, &inContext->key );
+        #endif
+        AES_CTR_Increment( inContext->ctr );
+    }
+#endif
+    err = kNoErr;
+    
+#if( AES_UTILS_USE_COMMON_CRYPTO )
+exit:
+#endif
+    return( err );
+}
+
+//===========================================================================================================================
+//  AES_CTR_XOR
+//
+//  inKey must be 4 byte aligned. Whole words are used when inSrc and inDst are aligned as well.
+//===========================================================================================================================
+
+static inline void AES_CTR_XOR( uint8_t *inDst, const uint8_t *inSrc, const uint8_t *inKey, size_t inLen )
+{
+    size_t      i = 0;
+    
+    if( ( ( (uintptr_t) inDst | (uintptr_t) inSrc ) & 3 ) == 0 )
+    {
+        for( ; ( i + 4 ) <= inLen; i += 4 )
+        {
+            *( (uint32_t *)( inDst + i ) ) = *( (const uint32_t *)( inSrc + i ) ) ^ *( (const uint32_t *)( inKey + i ) );
+        }
+    }
+    for( ; i < inLen; ++i )
+    {
+        inDst[ i ] = inSrc[ i ] ^ inKey[ i ];
+    }
+}
+
 //===========================================================================================================================
 //  AES_CTR_Update
 //===========================================================================================================================
@@ -103,6 +178,8 @@ OSStatus    AES_CTR_Update( AES_CTR_Context *inContext, const void *inSrc, size_
     uint8_t *           buf;
     size_t              used;
     size_t              i;
+    size_t              n;
+    uint32_t            key[ ( AES_CTR_BULK_BLOCKS * kAES_CTR_Size ) / 4 ]; // uint32_t so it's word aligned.
     
     // inSrc and inDst may be the same, but otherwise, the buffers must not overlap.
     
@@ -125,52 +202,28 @@ OSStatus    AES_CTR_Update( AES_CTR_Context *inContext, const void *inSrc, size_
     }
     inContext->used = used;
     
-    // Process whole blocks.
+    // Process whole blocks, up to AES_CTR_BULK_BLOCKS of key material at a time.
     
     while( inLen >= kAES_CTR_Size )
     {
-        #if( AES_UTILS_USE_COMMON_CRYPTO )
-            err = CCCryptorUpdate( inContext->cryptor, inContext->ctr, kAES_CTR_Size, buf, kAES_CTR_Size, &i );
-            require_noerr( err, exit );
-            require_action( i == kAES_CTR_Size, exit, err = kSizeErr );
-        #elif( AES_UTILS_USE_GLADMAN_AES )
-            aes_ecb_encrypt( inContext->ctr, buf, kAES_CTR_Size, &inContext->ctx );
-        #elif( AES_UTILS_USE_MICO_AES )
-            AesEncryptDirect( &inContext->ctx, buf, inContext->ctr );
-        #elif( AES_UTILS_USE_USSL )
-            aes_crypt_ecb( &inContext->ctx, AES_ENCRYPT, inContext->ctr, buf );
-        #else
-            AES_encrypt( inContext->ctr, buf, &inContext->key );
-        #endif
-        AES_CTR_Increment( inContext->ctr );
+        n = inLen / kAES_CTR_Size;
+        if( n > AES_CTR_BULK_BLOCKS ) n = AES_CTR_BULK_BLOCKS;
+        err = AES_CTR_Keystream( inContext, (uint8_t *) key, n );
+        require_noerr( err, exit );
         
-        for( i = 0; i < kAES_CTR_Size; ++i )
-        {
-            dst[ i ] = src[ i ] ^ buf[ i ];
-        }
-        src   += kAES_CTR_Size;
-        dst   += kAES_CTR_Size;
-        inLen -= kAES_CTR_Size;
+        n *= kAES_CTR_Size;
+        AES_CTR_XOR( dst, src, (const uint8_t *) key, n );
+        src   += n;
+        dst   += n;
+        inLen -= n;
     }
     
     // Process any trailing sub-block bytes. Extra key material is buffered for next time.
     
     if( inLen > 0 )
     {
-        #if( AES_UTILS_USE_COMMON_CRYPTO )
-            err = CCCryptorUpdate( inContext->cryptor, inContext->ctr, kAES_CTR_Size, buf, kAES_CTR_Size, &i );
-            require_noerr( err, exit );
-            require_action( i == kAES_CTR_Size, exit, err = kSizeErr );
-        #elif( AES_UTILS_USE_GLADMAN_AES )
-            aes_ecb_encrypt( inContext->ctr, buf, kAES_CTR_Size, &inContext->ctx );
-        #elif( AES_UTILS_USE_MICO_AES )
-            AesEncryptDirect( &inContext->ctx, buf, inContext->ctr );
-        #elif( AES_UTILS_USE_USSL )
-            aes_crypt_ecb( &inContext->ctx, AES_ENCRYPT, inContext->ctr, buf );
-        #else
-            AES_encrypt( inContext->ctr, buf, &inContext->key );
-        #endif
-        AES_CTR_Increment( inContext->ctr );
+        err = AES_CTR_Keystream( inContext, buf, 1 );
+        require_noerr( err, exit );
         
         for( i = 0; i < inLen; ++i )
         {
@@ -186,9 +239,7 @@ OSStatus    AES_CTR_Update( AES_CTR_Context *inContext, const void *inSrc, size_
     }
     err = kNoErr;
     
-#if( AES_UTILS_USE_COMMON_CRYPTO )
 exit:
-#endif
     return( err );
 }
 
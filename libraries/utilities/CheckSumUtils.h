@@ -25,6 +25,21 @@
 
 #include "Common.h"
 
+/* CRC16 engine selection, trades flash for speed:
+ *   0 - bitwise shift register, no table
+ *   1 - byte-wise table lookup, 512 bytes flash (default)
+ *   4 - slice-by-4, 2KB flash
+ *   8 - slice-by-8, 4KB flash
+ * Every engine keeps the plain CRC so far in CRC16_Context, a context saved under one
+ * setting (http_ota keeps it in the KV store to resume) stays valid under the others. */
+#ifndef CRC16_TABLE_SLICES
+#define CRC16_TABLE_SLICES    1
+#endif
+
+#if (CRC16_TABLE_SLICES != 0) && (CRC16_TABLE_SLICES != 1) && (CRC16_TABLE_SLICES != 4) && (CRC16_TABLE_SLICES != 8)
+#error "CRC16_TABLE_SLICES must be 0, 1, 4 or 8"
+#endif
+
 typedef struct
 {
   uint16_t crc;
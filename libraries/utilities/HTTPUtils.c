@@ -35,6 +35,26 @@
 
 #define READ_LENGTH 1500
 
+// States of the incremental search for the empty line that ends the header, see findHeader
+#define kHTTPScanNone    0
+#define kHTTPScanLF      1
+#define kHTTPScanLFCR    2
+
+// States of the chunked transfer decoder, see _HTTPChunkDecode
+typedef enum
+{
+  kChunkStateSize,          // Hex digits of the chunk size.
+  kChunkStateExtension,     // Chunk extension after ';', ignored.
+  kChunkStateSizeLF,        // LF after the chunk size line.
+  kChunkStateData,          // Chunk data.
+  kChunkStateDataCR,        // CR after the chunk data.
+  kChunkStateDataLF,        // LF after the chunk data.
+  kChunkStateTrailer,       // Start of a trailer line after the last chunk.
+  kChunkStateTrailerLine,   // Trailer header field, ignored.
+  kChunkStateTrailerLF,     // LF of the empty line that ends the trailer.
+  kChunkStateDone
+} HTTPChunkState_t;
+
 OSStatus onReceivedDataCallbackDefault(struct _HTTPHeader_t * httpHeader, uint32_t pos, uint8_t * data, size_t len, void * userContext )
 {
   UNUSED_PARAMETER(httpHeader);
@@ -45,7 +65,14 @@ OSStatus onReceivedDataCallbackDefault(struct _HTTPHeader_t * httpHeader, uint32
   return kUnsupportedErr;
 }
 
-int SocketReadHTTPHeader( int inSock, HTTPHeader_t *inHeader )
+/* Headers allocated by prebuilt libraries only have the members up to onClearCallback, 
+   their start line and headers are always in buf */
+static size_t _HTTPHeaderBufferSize( HTTPHeader_t *inHeader )
+{
+  return inHeader->isExtended ? inHeader->headerBufSize : sizeof( inHeader->buf );
+}
+
+static int _SocketReadHTTPHeader( int inSock, HTTPHeader_t *inHeader, bool inReadOnce )
 {
   int        err =0;
   char *          buf;
@@ -54,14 +81,19 @@ int SocketReadHTTPHeader( int inSock, HTTPHeader_t *inHeader )
   char *          end;
   size_t          len;
   ssize_t         n;
+  bool            readDone = false;
   
-  buf = inHeader->buf;
+  buf = HTTPHeaderBuffer( inHeader );
   dst = buf + inHeader->len;
-  lim = buf + sizeof( inHeader->buf );
+  lim = buf + _HTTPHeaderBufferSize( inHeader );
   for( ;; )
   {
     if(findHeader( inHeader,  &end ))
       break ;
+    require_action( dst < lim, exit, err = kNoSpaceErr );
+    if( inReadOnce && readDone )
+      return EWOULDBLOCK;
+    readDone = true;
     n = read( inSock, dst, (size_t)( lim - dst ) );
     if(      n  > 0 ) len = (size_t) n;
     else  { err = kConnectionErr; goto exit; }
@@ -80,6 +112,10 @@ int SocketReadHTTPHeader( int inSock, HTTPHeader_t *inHeader )
 
   /* For chunked extra data without content length */
   if(inHeader->chunkedData == true){
+    if(inHeader->isExtended){
+      memset(&inHeader->chunkDecoder, 0, sizeof(HTTPChunkDecoder_t));
+      inHeader->chunkDecoder.state = kChunkStateSize;
+    }
     inHeader->chunkedDataBufferLen = (inHeader->extraDataLen > READ_LENGTH)? inHeader->extraDataLen:READ_LENGTH;
     inHeader->chunkedDataBufferPtr = calloc(inHeader->chunkedDataBufferLen, sizeof(uint8_t)); //Make extra data buffer larger than chunk length
     require_action(inHeader->chunkedDataBufferPtr, exit, err = kNoMemoryErr);
@@ -94,13 +130,17 @@ int SocketReadHTTPHeader( int inSock, HTTPHeader_t *inHeader )
     size_t copyDataLen = (inHeader->contentLength >= inHeader->extraDataLen)? inHeader->extraDataLen : inHeader->contentLength;
     if(inHeader->onReceivedDataCallback && (inHeader->onReceivedDataCallback)(inHeader, 0, (uint8_t *)end, copyDataLen, inHeader->userContext)==kNoErr){
       inHeader->isCallbackSupported = true;
-      inHeader->extraDataPtr = calloc(READ_LENGTH, sizeof(uint8_t));
+      inHeader->extraDataPtr = calloc(Max(READ_LENGTH, inHeader->extraDataLen), sizeof(uint8_t));
       require_action(inHeader->extraDataPtr, exit, err = kNoMemoryErr);
+      /* Keep received data, it may contain the head of the next http package */
+      memcpy((uint8_t *)inHeader->extraDataPtr, end, inHeader->extraDataLen);
     }else{
       inHeader->isCallbackSupported = false;
-      inHeader->extraDataPtr = calloc(inHeader->contentLength , sizeof(uint8_t));
+      /* One more byte keeps the body null terminated for string parsers, data beyond the body
+         is the head of the next http package, picked up by HTTPHeaderClear */
+      inHeader->extraDataPtr = calloc(Max(inHeader->contentLength, inHeader->extraDataLen) + 1, sizeof(uint8_t));
       require_action(inHeader->extraDataPtr, exit, err = kNoMemoryErr);
-      memcpy((uint8_t *)inHeader->extraDataPtr, end, copyDataLen);
+      memcpy((uint8_t *)inHeader->extraDataPtr, end, inHeader->extraDataLen);
     }
     err = kNoErr;
   } /* Extra data without content length, data is ended by conntection close */
@@ -120,197 +160,290 @@ exit:
   return err;
 }
 
+int SocketReadHTTPHeader( int inSock, HTTPHeader_t *inHeader )
+{
+  return _SocketReadHTTPHeader( inSock, inHeader, false );
+}
+
+int SocketReadHTTPHeaderOnce( int inSock, HTTPHeader_t *inHeader )
+{
+  return _SocketReadHTTPHeader( inSock, inHeader, true );
+}
+
 
 bool findHeader ( HTTPHeader_t *inHeader,  char **  outHeaderEnd)
 {
-  char *dst = inHeader->buf + inHeader->len;
-  char *buf = (char *)inHeader->buf;
-  char *src = (char *)inHeader->buf;
-  size_t          len;
+  char *buf = HTTPHeaderBuffer( inHeader );
+  char *dst = buf + inHeader->len;
+  char *src = buf;
+  uint8_t state = kHTTPScanNone;
   
   // Check for interleaved binary data (4 byte header that begins with $). See RFC 2326 section 10.12.
   if( ( ( dst - buf ) >= 4 ) && ( buf[ 0 ] == '$' ) )
   {
     *outHeaderEnd = buf + 4;
-    return true;
+    goto found;
   }
   
   // Find an empty line (separates the header and body). The HTTP spec defines it as CRLFCRLF, but some
   // use LFLF or weird combos like CRLFLF so this handles CRLFCRLF, LFLF, and CRLFLF (but not CRCR).
-  *outHeaderEnd = dst;
-  for( ;; )
+  // The search resumes where the previous call stopped, so every byte is scanned only once no matter
+  // how many reads it takes to receive the header. Headers without the scan members are searched from the start.
+  if( inHeader->isExtended )
   {
-    while( ( src < *outHeaderEnd ) && ( *src != '\n' ) ) ++src;
-    if( src >= *outHeaderEnd ) break;
-    
-    len = (size_t)( *outHeaderEnd - src );
-    if( ( len >= 3 ) && ( src[ 1 ] == '\r' ) && ( src[ 2 ] == '\n' ) ) // CRLFCRLF or LFCRLF.
+    if( inHeader->scanPos > inHeader->len )
     {
-      *outHeaderEnd = src + 3;
-      return true;
+      inHeader->scanPos = 0;
+      inHeader->scanState = kHTTPScanNone;
     }
-    else if( ( len >= 2 ) && ( src[ 1 ] == '\n' ) ) // LFLF or CRLFLF.
+    src = buf + inHeader->scanPos;
+    state = inHeader->scanState;
+  }
+  
+  for( ; src < dst; ++src )
+  {
+    if( *src == '\n' )
     {
-      *outHeaderEnd = src + 2;
-      return true;
+      if( state != kHTTPScanNone ) // LFLF, CRLFLF, LFCRLF or CRLFCRLF.
+      {
+        *outHeaderEnd = src + 1;
+        goto found;
+      }
+      state = kHTTPScanLF;
     }
-    else if( len <= 1 )
+    else if( ( *src == '\r' ) && ( state == kHTTPScanLF ) )
     {
-      break;
+      state = kHTTPScanLFCR;
     }
-    ++src;
+    else
+    {
+      state = kHTTPScanNone;
+    }
+  }
+  
+  if( inHeader->isExtended )
+  {
+    inHeader->scanPos = (size_t)( src - buf );
+    inHeader->scanState = state;
   }
   return false;
+  
+found:
+  if( inHeader->isExtended )
+  {
+    inHeader->scanPos = 0;
+    inHeader->scanState = kHTTPScanNone;
+  }
+  return true;
 }
 
-OSStatus SocketReadHTTPBody( int inSock, HTTPHeader_t *inHeader )
+//===========================================================================================================================
+//  Chunked transfer decoder
+//
+//  Decodes "Transfer-Encoding: chunked" data byte by byte, the state is kept between reads so a chunk size line, chunk 
+//  data or trailer can be split at any position. Chunk data is delivered to onReceivedDataCallback straight from the 
+//  read buffer, the buffer is reused from its head by the next read.
+//===========================================================================================================================
+
+static OSStatus _HTTPChunkDecode( HTTPHeader_t *inHeader, HTTPChunkDecoder_t *inDecoder, const char *inData, size_t inLen, size_t *outUsed )
 {
-  OSStatus err = kParamErr;
-  ssize_t readResult;
-  int selectResult;
-  fd_set readSet;
-  size_t    lastChunkLen, chunckheaderLen; 
-  char *nextPackagePtr;
-  struct timeval_t t;
-  size_t          readLength;
-  uint32_t pos = 0;
-  t.tv_sec = 5;
-  t.tv_usec = 0;
-  
-  require( inHeader, exit );
-  err = kNotReadableErr;
+  OSStatus            err = kNoErr;
+  const char *        src = inData;
+  const char *        end = inData + inLen;
+  size_t              len;
+  char                c;
   
-  FD_ZERO( &readSet );
-  FD_SET( inSock, &readSet );
-
-  /* Chunked data without content length */
-  if( inHeader->chunkedData == true ){
-    do{
-      /* Find Chunk data length */
-      while ( findChunkedDataLength( inHeader->chunkedDataBufferPtr, inHeader->extraDataLen, &inHeader->extraDataPtr ,"%llu", &inHeader->contentLength ) == false){
-        require_action(inHeader->extraDataLen < inHeader->chunkedDataBufferLen, exit, err=kMalformedErr );
-
-        selectResult = select( inSock + 1, &readSet, NULL, NULL, NULL );
-        require_action( selectResult >= 1, exit, err = kNotReadableErr );
-
-        readResult = read( inSock, inHeader->chunkedDataBufferPtr + inHeader->extraDataLen, (size_t)( inHeader->chunkedDataBufferLen - inHeader->extraDataLen ) );
-
-        if( readResult  > 0 ) inHeader->extraDataLen += readResult;
-        else { err = kConnectionErr; goto exit; }
+  while( ( src < end ) && ( inDecoder->state != kChunkStateDone ) )
+  {
+    if( inDecoder->state == kChunkStateData )
+    {
+      len = (size_t) Min( inDecoder->remaining, (uint64_t)( end - src ) );
+      /* As for bodies with content length, the first data decides if the application takes the body, 
+         only an error after that stops the transfer. A body it doesn't take is dropped. */
+      if( inDecoder->pos == 0 )
+        inHeader->isCallbackSupported = (inHeader->onReceivedDataCallback)(inHeader, 0, (uint8_t *)src, len, inHeader->userContext) == kNoErr;
+      else if( inHeader->isCallbackSupported == true ){
+        err = (inHeader->onReceivedDataCallback)(inHeader, inDecoder->pos, (uint8_t *)src, len, inHeader->userContext);
+        require_noerr( err, exit );
       }
+      inDecoder->pos += len;
+      inDecoder->remaining -= len;
+      src += len;
+      if( inDecoder->remaining == 0 ) inDecoder->state = kChunkStateDataCR;
+      continue;
+    }
+    
+    c = *src++;
+    switch( inDecoder->state )
+    {
+      case kChunkStateSize:
+        if( isxdigit_safe( c ) )
+        {
+          require_action( inDecoder->remaining <= ( UINT64_MAX >> 4 ), exit, err = kMalformedErr );
+          inDecoder->remaining = ( inDecoder->remaining << 4 ) | (uint64_t)( isdigit_safe( c ) ? ( c - '0' ) : ( tolower_safe( c ) - 'a' + 10 ) );
+          ++inDecoder->digits;
+          break;
+        }
+        require_action( inDecoder->digits > 0, exit, err = kMalformedErr );
+        if( ( c == ';' ) || ( c == ' ' ) || ( c == '\t' ) ) inDecoder->state = kChunkStateExtension;
+        else if( c == '\r' )                                 inDecoder->state = kChunkStateSizeLF;
+        else if( c == '\n' )                                 goto sizeLineDone;
+        else { err = kMalformedErr; goto exit; }
+        break;
+      
+      case kChunkStateExtension:
+        if( c == '\n' ) goto sizeLineDone;
+        break;
+      
+      case kChunkStateSizeLF:
+        require_action( c == '\n', exit, err = kMalformedErr );
+      sizeLineDone:
+        inHeader->contentLength = inDecoder->remaining;
+        inDecoder->state = ( inDecoder->remaining == 0 ) ? kChunkStateTrailer : kChunkStateData;
+        break;
+      
+      case kChunkStateDataCR:
+        if( c == '\r' )       inDecoder->state = kChunkStateDataLF;
+        else if( c == '\n' )  goto nextChunk;
+        else { err = kMalformedErr; goto exit; }
+        break;
+      
+      case kChunkStateDataLF:
+        require_action( c == '\n', exit, err = kMalformedErr );
+      nextChunk:
+        inDecoder->digits = 0;
+        inDecoder->state = kChunkStateSize;
+        break;
+      
+      case kChunkStateTrailer:
+        if( c == '\r' )       inDecoder->state = kChunkStateTrailerLF;
+        else if( c == '\n' )  inDecoder->state = kChunkStateDone;
+        else                  inDecoder->state = kChunkStateTrailerLine;
+        break;
+      
+      case kChunkStateTrailerLine:
+        if( c == '\n' ) inDecoder->state = kChunkStateTrailer;
+        break;
+      
+      case kChunkStateTrailerLF:
+        require_action( c == '\n', exit, err = kMalformedErr );
+        inDecoder->state = kChunkStateDone;
+        break;
+      
+      default:
+        break;
+    }
+  }
+  
+exit:
+  *outUsed = (size_t)( src - inData );
+  return err;
+}
 
-      chunckheaderLen = inHeader->extraDataPtr - inHeader->chunkedDataBufferPtr;
-
-      /* Check the last chunk */
-      if(inHeader->contentLength == 0){ 
-        while( findCRLF( inHeader->extraDataPtr, inHeader->extraDataLen - chunckheaderLen, &nextPackagePtr ) == false){ //find CRLF
-          selectResult = select( inSock + 1, &readSet, NULL, NULL, NULL );
-          require_action( selectResult >= 1, exit, err = kNotReadableErr );
-
-          readResult = read( inSock,
-                            (uint8_t *)( inHeader->extraDataPtr + inHeader->extraDataLen - chunckheaderLen ),
-                            256 - inHeader->extraDataLen ); //Assume chunk trailer length is less than 256 (256 is the min chunk buffer, maybe dangerous
+/* Read the body with content length once, the socket should be readable */
+static OSStatus _SocketReadHTTPContent( int inSock, HTTPHeader_t *inHeader )
+{
+  ssize_t readResult;
+  size_t  readLength;
+
+  if(inHeader->isCallbackSupported == true){
+    /* We has extra data, and we give these data to application by onReceivedDataCallback function */
+    readLength = inHeader->contentLength - inHeader->extraDataLen > READ_LENGTH? READ_LENGTH:inHeader->contentLength - inHeader->extraDataLen;
+    readResult = read( inSock,
+                      (uint8_t*)( inHeader->extraDataPtr),
+                      readLength );
+    
+    if( readResult  > 0 ) inHeader->extraDataLen += readResult;
+    else return kConnectionErr;
+    /* The application can stop the transfer by returning an error */
+    return (inHeader->onReceivedDataCallback)(inHeader, inHeader->extraDataLen - readResult, (uint8_t *)inHeader->extraDataPtr, readResult, inHeader->userContext);
+  }else{
+    /* We has extra data and we has a predefined buffer to store the total extra data return when all data has received*/
+    readResult = read( inSock,
+                      (uint8_t*)( inHeader->extraDataPtr + inHeader->extraDataLen ),
+                      ( inHeader->contentLength - inHeader->extraDataLen ) );
+    
+    if( readResult  > 0 ) inHeader->extraDataLen += readResult;
+    else return kConnectionErr;
+  }
+  return kNoErr;
+}
 
-          if( readResult  > 0 ) inHeader->extraDataLen += readResult;
-          else { err = kConnectionErr; goto exit; }
-          (inHeader->onReceivedDataCallback)(inHeader, inHeader->extraDataLen - readResult, (uint8_t *)inHeader->extraDataPtr, readResult, inHeader->userContext);
-        }
+/* Decode the chunked data left in the buffer, then read and decode until the last chunk. With inReadOnce, 
+   read() is called at most once and only if nothing was left in the buffer */
+static OSStatus _SocketReadHTTPChunks( int inSock, HTTPHeader_t *inHeader, HTTPChunkDecoder_t *inDecoder, bool inReadOnce )
+{
+  OSStatus err = kNoErr;
+  ssize_t readResult;
+  int selectResult;
+  fd_set readSet;
+  struct timeval_t t;
+  size_t readLength = inHeader->extraDataLen; /* Data received but not decoded yet */
+  size_t used;
+  bool readDone = ( readLength > 0 );
 
-        err = kNoErr;
-        goto exit;
-      } 
-      else{ // Read chunk data
-        /* Chunk package already exist, callback, move to buffer's head */
-        if( inHeader->extraDataLen >= inHeader->contentLength + chunckheaderLen + 2 ){
-          require_action( *(inHeader->extraDataPtr + inHeader->contentLength ) == '\r' &&
-                          *(inHeader->extraDataPtr + inHeader->contentLength + 1 ) == '\n', 
-                          exit, err = kMalformedErr);
-
-          (inHeader->onReceivedDataCallback)(inHeader,  pos, 
-                                                        (uint8_t *)inHeader->extraDataPtr, 
-                                                        inHeader->contentLength, 
-                                                        inHeader->userContext);
-          pos+=inHeader->contentLength;
-
-          /* Move next chunk to chunked data buffer header point */
-          lastChunkLen = inHeader->extraDataPtr - inHeader->chunkedDataBufferPtr + inHeader->contentLength;
-          if(inHeader->contentLength) lastChunkLen += 2;  //Last chunck data has a CRLF tail
-          memmove( inHeader->chunkedDataBufferPtr, inHeader->chunkedDataBufferPtr + lastChunkLen, inHeader->chunkedDataBufferLen - lastChunkLen  );
-          inHeader->extraDataLen -= lastChunkLen;
-        }
-        /* Chunck exist without the last LF, generate callback abd recv LF */
-        /* Callback , read LF */
-        else if(inHeader->extraDataLen == inHeader->contentLength + chunckheaderLen +1){ //recv CR 
+  for( ;; ){
+    err = _HTTPChunkDecode( inHeader, inDecoder, inHeader->chunkedDataBufferPtr, readLength, &used );
+    require_noerr( err, exit );
 
-          require_action( *(inHeader->chunkedDataBufferPtr + inHeader->extraDataLen - 1) == '\r' ,
-                          exit, err = kMalformedErr);
+    /* Data beyond the last chunk belongs to the next http package, it is picked up by HTTPHeaderClear */
+    if( inDecoder->state == kChunkStateDone ){
+      inHeader->extraDataPtr = inHeader->chunkedDataBufferPtr + used;
+      inHeader->extraDataLen = readLength;
+      break;
+    }
 
-          (inHeader->onReceivedDataCallback)(inHeader,  pos, 
-                                                        (uint8_t *)inHeader->extraDataPtr, 
-                                                        inHeader->extraDataLen - chunckheaderLen-1, 
-                                                        inHeader->userContext);
-          pos+=inHeader->extraDataLen - chunckheaderLen-1;
-          selectResult = select( inSock + 1, &readSet, NULL, NULL, NULL );
-          require_action( selectResult >= 1, exit, err = kNotReadableErr );
+    /* Everything in the buffer is consumed, read the next block to the buffer head */
+    inHeader->extraDataLen = 0;
+    if( inReadOnce && readDone )
+      return EWOULDBLOCK;
+
+    if( inReadOnce == false ){
+      FD_ZERO( &readSet );
+      FD_SET( inSock, &readSet );
+      t.tv_sec = 5;
+      t.tv_usec = 0;
+      selectResult = select( inSock + 1, &readSet, NULL, NULL, &t );
+      require_action( selectResult != 0, exit, err = kTimeoutErr );
+      require_action( selectResult >= 1, exit, err = kNotReadableErr );
+    }
 
-          readResult = read( inSock, (uint8_t *)inHeader->extraDataPtr, 1);
+    readResult = read( inSock, inHeader->chunkedDataBufferPtr, inHeader->chunkedDataBufferLen );
+    require_action( readResult > 0, exit, err = kConnectionErr );
+    readLength = (size_t) readResult;
+    readDone = true;
+  }
 
-          if( readResult  > 0 ) {}
-          else { err = kConnectionErr; goto exit; }
+exit:
+  return err;
+}
 
-          require_action( *(inHeader->extraDataPtr) == '\n', exit, err = kMalformedErr);
-          inHeader->extraDataLen = 0;
-        }
-        else{
-          /* Callback , read , callback , read CRLF */
-          (inHeader->onReceivedDataCallback)(inHeader, pos, 
-                                                       (uint8_t *)inHeader->extraDataPtr, 
-                                                       inHeader->extraDataLen - chunckheaderLen, 
-                                                       inHeader->userContext);
-          pos += inHeader->extraDataLen - chunckheaderLen;
-
-          while ( inHeader->extraDataLen < inHeader->contentLength + chunckheaderLen  ){
-            selectResult = select( inSock + 1, &readSet, NULL, NULL, NULL );
-            require_action( selectResult >= 1, exit, err = kNotReadableErr );
-
-            if( inHeader->contentLength - (inHeader->extraDataLen - chunckheaderLen) > inHeader->chunkedDataBufferLen - chunckheaderLen)
-              //Data needed is greater than valid buffer size
-              readLength = inHeader->chunkedDataBufferLen - chunckheaderLen; 
-            else
-              //Data needed is less than valid buffer size
-              readLength = inHeader->contentLength - (inHeader->extraDataLen - chunckheaderLen) ; 
-
-            readResult = read( inSock, (uint8_t *)inHeader->extraDataPtr, readLength);
-            
-            if( readResult  > 0 ) inHeader->extraDataLen += readResult;
-            else { err = kConnectionErr; goto exit; }
-
-            (inHeader->onReceivedDataCallback)(inHeader, pos, 
-                                                         (uint8_t *)inHeader->extraDataPtr, 
-                                                         readResult, 
-                                                         inHeader->userContext);
-            pos += readResult;
-          } 
-
-          selectResult = select( inSock + 1, &readSet, NULL, NULL, NULL );
-          require_action( selectResult >= 1, exit, err = kNotReadableErr );
-
-          readResult = read( inSock, (uint8_t *)inHeader->extraDataPtr, 2);
-
-          if( readResult  > 0 ) {}
-          else { err = kConnectionErr; goto exit; }
-
-
-          require_action( *(inHeader->extraDataPtr) == '\r' &&
-                          *(inHeader->extraDataPtr+1 ) == '\n', 
-                          exit, err = kMalformedErr);
-
-          inHeader->extraDataLen = 0;
-        }
-      }
-    }while(inHeader->contentLength != 0);
+OSStatus SocketReadHTTPBody( int inSock, HTTPHeader_t *inHeader )
+{
+  OSStatus err = kParamErr;
+  int selectResult;
+  fd_set readSet;
+  struct timeval_t t;
+  HTTPChunkDecoder_t decoder;
+  
+  require( inHeader, exit );
+  err = kNotReadableErr;
+  
+  /* Chunked data without content length, headers allocated by prebuilt libraries have no decoder */
+  if( inHeader->chunkedData == true ){
+    if( inHeader->isExtended == false ){
+      memset( &decoder, 0, sizeof( decoder ) );
+      decoder.state = kChunkStateSize;
+    }
+    err = _SocketReadHTTPChunks( inSock, inHeader, inHeader->isExtended ? &inHeader->chunkDecoder : &decoder, false );
+    goto exit;
   }
 
+  FD_ZERO( &readSet );
+  FD_SET( inSock, &readSet );
+  t.tv_sec = 5;
+  t.tv_usec = 0;
+
   /* We has extra data but total length is not clear, store them to 1500 bytes buffer 
      return when connection is disconnected by remote server */
   // if( inHeader->dataEndedbyClose == true){ 
@@ -336,30 +469,51 @@ OSStatus SocketReadHTTPBody( int inSock, HTTPHeader_t *inHeader )
     selectResult = select( inSock + 1, &readSet, NULL, NULL, &t );
     require_action( selectResult >= 1, exit, err = kNotReadableErr );
 
-    if(inHeader->isCallbackSupported == true){
-      /* We has extra data, and we give these data to application by onReceivedDataCallback function */
-      readLength = inHeader->contentLength - inHeader->extraDataLen > READ_LENGTH? READ_LENGTH:inHeader->contentLength - inHeader->extraDataLen;
-      readResult = read( inSock,
-                        (uint8_t*)( inHeader->extraDataPtr),
-                        readLength );
-      
-      if( readResult  > 0 ) inHeader->extraDataLen += readResult;
-      else { err = kConnectionErr; goto exit; }      
-      (inHeader->onReceivedDataCallback)(inHeader, inHeader->extraDataLen - readResult, (uint8_t *)inHeader->extraDataPtr, readResult, inHeader->userContext);
-    }else{
-      /* We has extra data and we has a predefined buffer to store the total extra data return when all data has received*/
-      readResult = read( inSock,
-                        (uint8_t*)( inHeader->extraDataPtr + inHeader->extraDataLen ),
-                        ( inHeader->contentLength - inHeader->extraDataLen ) );
-      
-      if( readResult  > 0 ) inHeader->extraDataLen += readResult;
-      else { err = kConnectionErr; goto exit; }
-    }
+    err = _SocketReadHTTPContent( inSock, inHeader );
+    require_noerr( err, exit );
   }
   err = kNoErr;
   
 exit:
-  if(err != kNoErr) inHeader->len = 0;
+  if(err != kNoErr && inHeader) {
+    inHeader->len = 0;
+    if(inHeader->chunkedData == true){ /* Nothing is left for the next http package */
+      inHeader->extraDataPtr = inHeader->chunkedDataBufferPtr;
+      inHeader->extraDataLen = 0;
+    }
+  }
+  return err;
+}
+
+OSStatus SocketReadHTTPBodyOnce( int inSock, HTTPHeader_t *inHeader )
+{
+  OSStatus err = kParamErr;
+
+  require( inHeader, exit );
+
+  if( inHeader->chunkedData == true ){
+    /* Headers allocated by prebuilt libraries have no room for the decoder state */
+    if( inHeader->isExtended == false )
+      return SocketReadHTTPBody( inSock, inHeader );
+    err = _SocketReadHTTPChunks( inSock, inHeader, &inHeader->chunkDecoder, true );
+    goto exit;
+  }
+
+  if( inHeader->extraDataLen < inHeader->contentLength ){
+    err = _SocketReadHTTPContent( inSock, inHeader );
+    require_noerr( err, exit );
+  }
+
+  err = ( inHeader->extraDataLen < inHeader->contentLength )? EWOULDBLOCK : kNoErr;
+
+exit:
+  if(err != kNoErr && err != EWOULDBLOCK && inHeader) {
+    inHeader->len = 0;
+    if(inHeader->chunkedData == true){ /* Nothing is left for the next http package */
+      inHeader->extraDataPtr = inHeader->chunkedDataBufferPtr;
+      inHeader->extraDataLen = 0;
+    }
+  }
   return err;
 }
 
@@ -379,8 +533,10 @@ OSStatus HTTPHeaderParse( HTTPHeader_t *ioHeader )
   const char *        value;
   size_t              valueSize;
   int                 x;
+  HTTPHeaderField_t   field;
+  const char *        lineEnd;
   
-  require_action( ioHeader->len < sizeof( ioHeader->buf ), exit, err = kParamErr );
+  require_action( ioHeader->len < _HTTPHeaderBufferSize( ioHeader ), exit, err = kParamErr );
   
   // Reset fields up-front to good defaults to simplify handling of unused fields later.
   
@@ -397,11 +553,12 @@ OSStatus HTTPHeaderParse( HTTPHeader_t *ioHeader )
   ioHeader->channelID         = 0;
   ioHeader->contentLength     = 0;
   ioHeader->persistent        = false;
+  if( ioHeader->isExtended ) ioHeader->fieldCount = 0;
   
   // Check for a 4-byte interleaved binary data header (see RFC 2326 section 10.12). It has the following format:
   //
   //      '$' <1:channelID> <2:dataSize in network byte order> ... followed by dataSize bytes of binary data.
-  src = ioHeader->buf;
+  src = HTTPHeaderBuffer( ioHeader );
   if( ( ioHeader->len == 4 ) && ( src[ 0 ] == '$' ) )
   {
     const uint8_t *     usrc;
@@ -481,17 +638,58 @@ OSStatus HTTPHeaderParse( HTTPHeader_t *ioHeader )
   // There should at least be a blank line after the start line so make sure there's more data.
   require_action( ptr < end, exit, err = kMalformedErr );
   
+  // Index the header fields in a single pass, so later lookups don't have to rescan the header buffer.
+  if( ( ptr < end ) && ( ptr[ -1 ] == '\r' ) && ( *ptr == '\n' ) ) ++ptr;
+  field.namePtr = NULL;
+  while( ioHeader->isExtended && ( ptr < end ) )
+  {
+    src = ptr;
+    while( ( ptr < end ) && ( ( c = *ptr ) != '\r' ) && ( c != '\n' ) ) ++ptr;
+    lineEnd = ptr;
+    if( ( ptr < end ) && ( *ptr == '\r' ) ) ++ptr;
+    if( ( ptr < end ) && ( *ptr == '\n' ) ) ++ptr;
+    
+    // A continuation line extends the value of the current field.
+    if( ( lineEnd > src ) && ( ( ( c = *src ) == ' ' ) || ( c == '\t' ) ) )
+    {
+      if( field.namePtr ) field.valueLen = (size_t)( lineEnd - field.valuePtr );
+      continue;
+    }
+    
+    if( field.namePtr )
+    {
+      if( ioHeader->fieldCount < HTTP_HEADER_MAX_FIELDS ) ioHeader->fields[ ioHeader->fieldCount ] = field;
+      ++ioHeader->fieldCount;
+      field.namePtr = NULL;
+    }
+    
+    // The empty line ends the header.
+    if( lineEnd == src ) break;
+    
+    for( value = src; ( value < lineEnd ) && ( *value != ':' ); ++value ) {}
+    if( value >= lineEnd ) continue;
+    field.namePtr  = src;
+    field.nameLen  = (size_t)( value - src );
+    for( ++value; ( value < lineEnd ) && ( ( ( c = *value ) == ' ' ) || ( c == '\t' ) ); ++value ) {}
+    field.valuePtr = value;
+    field.valueLen = (size_t)( lineEnd - value );
+  }
+  
   // Determine persistence. Note: HTTP 1.0 defaults to non-persistent if a Connection header field is not present.
-  err = HTTPGetHeaderField( ioHeader->buf, ioHeader->len, "Connection", NULL, NULL, &value, &valueSize, NULL );
+  err = HTTPHeaderGetField( ioHeader, "Connection", &value, &valueSize );
   if( err )   ioHeader->persistent = (Boolean)( strnicmpx( ioHeader->protocolPtr, ioHeader->protocolLen, "HTTP/1.0" ) != 0 );
   else        ioHeader->persistent = (Boolean)( strnicmpx( value, valueSize, "close" ) != 0 );
 
-  err = HTTPGetHeaderField( ioHeader->buf, ioHeader->len, "Transfer-Encoding", NULL, NULL, &value, &valueSize, NULL );
+  err = HTTPHeaderGetField( ioHeader, "Transfer-Encoding", &value, &valueSize );
   if( err )   ioHeader->chunkedData = false;
   else        ioHeader->chunkedData = (Boolean)( strnicmpx( value, valueSize, kTransferrEncodingType_CHUNKED ) == 0 );
   
   // Content-Length is such a common field that we get it here during general parsing.
-  HTTPScanFHeaderValue( ioHeader->buf, ioHeader->len, "Content-Length", "%llu", &ioHeader->contentLength );
+  if( HTTPHeaderGetField( ioHeader, "Content-Length", &value, &valueSize ) == kNoErr )
+  {
+    for( ptr = value; ( ptr < value + valueSize ) && ( ( c = *ptr ) >= '0' ) && ( c <= '9' ); ++ptr )
+      ioHeader->contentLength = ( ioHeader->contentLength * 10 ) + (uint64_t)( c - '0' );
+  }
 
   err = kNoErr;
   
@@ -643,6 +841,41 @@ OSStatus HTTPGetHeaderField( const char *inHeaderPtr,
   return kNotFoundErr;
 }
 
+//===========================================================================================================================
+//  HTTPHeaderGetField
+//
+//  Looks up a header field in the index built by HTTPHeaderParse. The value points into the header buffer, no copy is made.
+//===========================================================================================================================
+
+OSStatus HTTPHeaderGetField( HTTPHeader_t *inHeader, const char *inName, const char **outValuePtr, size_t *outValueLen )
+{
+  size_t              nameLen;
+  size_t              i;
+  HTTPHeaderField_t * field;
+  
+  // Headers without the index are always rescanned.
+  if( !inHeader->isExtended )
+    return HTTPGetHeaderField( inHeader->buf, inHeader->len, inName, NULL, NULL, outValuePtr, outValueLen, NULL );
+  
+  nameLen = strlen( inName );
+  for( i = 0; ( i < inHeader->fieldCount ) && ( i < HTTP_HEADER_MAX_FIELDS ); ++i )
+  {
+    field = &inHeader->fields[ i ];
+    if( ( field->nameLen == nameLen ) && ( strnicmp( field->namePtr, inName, nameLen ) == 0 ) )
+    {
+      if( outValuePtr ) *outValuePtr = field->valuePtr;
+      if( outValueLen ) *outValueLen = field->valueLen;
+      return kNoErr;
+    }
+  }
+  
+  // Not every field fits in the index, the rest can only be found by a rescan.
+  if( inHeader->fieldCount > HTTP_HEADER_MAX_FIELDS )
+    return HTTPGetHeaderField( inHeader->headerBuf, inHeader->len, inName, NULL, NULL, outValuePtr, outValueLen, NULL );
+  
+  return kNotFoundErr;
+}
+
 int HTTPScanFHeaderValue( const char *inHeaderPtr, size_t inHeaderLen, const char *inName, const char *inFormat, ... )
 {
   int                 n;
@@ -684,42 +917,56 @@ char* HTTPHeaderMatchPartialURL( HTTPHeader_t *inHeader, const char *url )
 
 HTTPHeader_t * HTTPHeaderCreate( void )
 {
-  HTTPHeader_t *httpHeader;
-  httpHeader = calloc(1, sizeof(HTTPHeader_t));
-  httpHeader->onReceivedDataCallback = onReceivedDataCallbackDefault;
-  return httpHeader;
+  return HTTPHeaderCreateWithBuffer( NULL, HTTP_HEADER_BUFFER_SIZE, onReceivedDataCallbackDefault, NULL, NULL );
 }
 
 HTTPHeader_t * HTTPHeaderCreateWithCallback( onReceivedDataCallback inRecvFunc, onClearCallback onClearFunc, void * context )
+{
+  return HTTPHeaderCreateWithBuffer( NULL, HTTP_HEADER_BUFFER_SIZE, inRecvFunc, onClearFunc, context );
+}
+
+HTTPHeader_t * HTTPHeaderCreateWithBuffer( char *buf, size_t bufSize, onReceivedDataCallback inRecvFunc, onClearCallback onClearFunc, void * context )
 {
   HTTPHeader_t *httpHeader;
-  httpHeader = HTTPHeaderCreate();
+  
+  /* A larger header buffer is allocated in the same block, so the header is still released by a single free() */
+  if( buf || bufSize <= sizeof( httpHeader->buf ) )
+    httpHeader = calloc(1, sizeof(HTTPHeader_t));
+  else
+    httpHeader = calloc(1, sizeof(HTTPHeader_t) + bufSize);
+  require( httpHeader, exit );
+  httpHeader->isExtended = true;
+  if( buf )
+    httpHeader->headerBuf = buf;
+  else if( bufSize <= sizeof( httpHeader->buf ) )
+    httpHeader->headerBuf = httpHeader->buf;
+  else
+    httpHeader->headerBuf = (char *)( httpHeader + 1 );
+  httpHeader->headerBufSize = bufSize;
   httpHeader->userContext = context;
   httpHeader->onReceivedDataCallback = inRecvFunc;
   httpHeader->onClearCallback = onClearFunc;
+  
+exit:
   return httpHeader;
 }
 
 void HTTPHeaderClear( HTTPHeader_t *inHeader )
 {
-  char *nextPackagePtr;
   size_t chunckheaderLen = inHeader->extraDataPtr - inHeader->chunkedDataBufferPtr;
+  char *buf = HTTPHeaderBuffer( inHeader );
+  size_t bufSize = _HTTPHeaderBufferSize( inHeader );
 
   if(inHeader->onClearCallback)
     (inHeader->onClearCallback)(inHeader, inHeader->userContext);
 
   if(inHeader->chunkedData && (uint32_t *)inHeader->chunkedDataBufferPtr){ //chunk data
-    /* Possible to read the header of the next http package */
-    if(findCRLF( inHeader->extraDataPtr, inHeader->extraDataLen - chunckheaderLen, &nextPackagePtr ) ){
-      if( nextPackagePtr <= inHeader->chunkedDataBufferPtr + inHeader->extraDataLen ){ //We get some data belongs to next http package
-        inHeader->len = inHeader->extraDataLen - (nextPackagePtr - inHeader->chunkedDataBufferPtr);
-        if(inHeader->len > 512)
-          inHeader->len = 0;
-        else
-          memcpy(inHeader->buf, nextPackagePtr, inHeader->len);
-      } else
-        inHeader->len = 0;
-    }
+    /* Data after the last chunk belongs to the next http package */
+    inHeader->len = inHeader->extraDataLen - chunckheaderLen;
+    if(inHeader->len > bufSize)
+      inHeader->len = 0;
+    else
+      memcpy(buf, inHeader->extraDataPtr, inHeader->len);
 
     inHeader->extraDataLen = 0;
     free((uint32_t *)inHeader->chunkedDataBufferPtr);
@@ -731,8 +978,14 @@ void HTTPHeaderClear( HTTPHeader_t *inHeader )
     /* We get some data belongs to next http package, this only could happen two or more
       packages are received by SocketReadHTTPHeader */ 
     if( inHeader->extraDataLen > inHeader->contentLength ){ 
+      size_t headerLen = inHeader->len;
       inHeader->len = inHeader->extraDataLen - inHeader->contentLength;
-      memcpy(inHeader->buf, inHeader->extraDataPtr + inHeader->contentLength, inHeader->len);
+      if(inHeader->len > bufSize)
+        inHeader->len = 0;
+      else if((uint32_t *)inHeader->extraDataPtr)
+        memcpy(buf, inHeader->extraDataPtr + inHeader->contentLength, inHeader->len);
+      else /* No body buffer, the next package is still in header buffer right after this header */
+        memmove(buf, buf + headerLen, inHeader->len);
     } else
       inHeader->len = 0;
 
@@ -745,7 +998,11 @@ void HTTPHeaderClear( HTTPHeader_t *inHeader )
   }
 
   inHeader->isCallbackSupported = false;
-
+  if( inHeader->isExtended ){
+    inHeader->scanPos = 0;
+    inHeader->scanState = kHTTPScanNone;
+    inHeader->fieldCount = 0;
+  }
 }
 
 OSStatus CreateSimpleHTTPOKMessage( uint8_t **outMessage, size_t *outMessageSize )
@@ -85,7 +85,38 @@
 
 #define OTA_Data_Length_per_read        1024
 
+/* Default size of the buffer holding the start line and all headers, a larger
+   buffer can be assigned per header by HTTPHeaderCreateWithBuffer */
+#ifndef HTTP_HEADER_BUFFER_SIZE
+#define HTTP_HEADER_BUFFER_SIZE         512
+#endif
+
+/* Header fields indexed by HTTPHeaderParse, fields beyond this number are still 
+   reachable by HTTPHeaderGetField through a rescan of the header buffer */
+#ifndef HTTP_HEADER_MAX_FIELDS
+#define HTTP_HEADER_MAX_FIELDS          12
+#endif
+
+typedef struct _HTTPHeaderField_t
+{
+    const char *        namePtr;            //! Field name, points into the header buffer.
+    size_t              nameLen;            //! Number of bytes in the field name.
+    const char *        valuePtr;           //! Field value without leading whitespace, points into the header buffer.
+    size_t              valueLen;           //! Number of bytes in the field value, continuation lines included.
+} HTTPHeaderField_t;
 
+typedef struct _HTTPChunkDecoder_t
+{
+    uint8_t             state;              //! Decoder state, private use only
+    size_t              digits;             //! Number of hex digits parsed in the current size line.
+    uint64_t            remaining;          //! Bytes left in the current chunk, or the size being parsed.
+    uint32_t            pos;                //! Position of the next chunk data byte in the body.
+} HTTPChunkDecoder_t;
+
+/* Members up to onClearCallback keep the layout that prebuilt libraries (e.g. MFi_WAC) are 
+   compiled against, these libraries allocate HTTPHeader_t by themselves. Members after 
+   onClearCallback only exist in headers created by HTTPHeaderCreate..., and isExtended, 
+   which takes the padding after isCallbackSupported, tells them apart. */
 typedef struct _HTTPHeader_t
 {
     char                buf[ 512 ];        //! Buffer holding the start line and all headers.
@@ -118,13 +149,24 @@ typedef struct _HTTPHeader_t
 
     void *              userContext;
     bool                isCallbackSupported;
+    bool                isExtended;         //! true=Members after onClearCallback exist, private use only
     OSStatus            (*onReceivedDataCallback) ( struct _HTTPHeader_t * , uint32_t, uint8_t *, size_t, void * ); 
     void                (*onClearCallback) ( struct _HTTPHeader_t * httpHeader, void * userContext );
 
-
+    char *              headerBuf;          //! Buffer holding the start line and all headers, buf or a larger one.
+    size_t              headerBufSize;      //! Size of the buffer holding the start line and all headers.
+    size_t              scanPos;            //! Offset where the search for the end of header resumes, private use only
+    uint8_t             scanState;          //! Line ending state at scanPos, private use only
+    HTTPHeaderField_t   fields[ HTTP_HEADER_MAX_FIELDS ]; //! Header fields indexed by HTTPHeaderParse.
+    size_t              fieldCount;         //! Number of header fields found, may exceed HTTP_HEADER_MAX_FIELDS.
+    HTTPChunkDecoder_t  chunkDecoder;       //! Chunked body decoder, kept between SocketReadHTTPBodyOnce calls.
 
 } HTTPHeader_t;
 
+/* Start line and all headers of any HTTPHeader_t, use it instead of buf for headers 
+   created by HTTPHeaderCreateWithBuffer */
+#define HTTPHeaderBuffer( HEADER )      ( (HEADER)->isExtended ? (HEADER)->headerBuf : (HEADER)->buf )
+
 typedef OSStatus (*onReceivedDataCallback) ( struct _HTTPHeader_t * httpHeader, uint32_t pos, uint8_t * data, size_t len, void * userContext );
 
 typedef void (*onClearCallback) ( struct _HTTPHeader_t * httpHeader, void * userContext );
@@ -143,6 +185,13 @@ int SocketReadHTTPHeader( int inSock, HTTPHeader_t *inHeader );
 
 int SocketReadHTTPBody( int inSock, HTTPHeader_t *inHeader );
 
+/* Same as SocketReadHTTPHeader and SocketReadHTTPBody, but read() is called at most once, for
+   servers that select() on many sockets. Return EWOULDBLOCK until the header or body is complete.
+   Chunked data received with the header is decoded without a read. */
+int SocketReadHTTPHeaderOnce( int inSock, HTTPHeader_t *inHeader );
+
+int SocketReadHTTPBodyOnce( int inSock, HTTPHeader_t *inHeader );
+
 int HTTPHeaderParse( HTTPHeader_t *ioHeader );
 
 int HTTPHeaderMatchMethod( HTTPHeader_t *inHeader, const char *method );
@@ -161,10 +210,17 @@ int HTTPGetHeaderField( const char *inHeaderPtr,
                              size_t     *outValueLen, 
                              const char **outNext );
 
+OSStatus HTTPHeaderGetField( HTTPHeader_t *inHeader, const char *inName, const char **outValuePtr, size_t *outValueLen );
+
 HTTPHeader_t * HTTPHeaderCreate( void );
 
 HTTPHeader_t * HTTPHeaderCreateWithCallback( onReceivedDataCallback , onClearCallback , void * context );
 
+/* Use a caller supplied header buffer, or allocate a buffer of bufSize bytes
+   together with the header if buf is NULL, buf inside the header is used if 
+   bufSize fits in it. Release the header by free(). */
+HTTPHeader_t * HTTPHeaderCreateWithBuffer( char *buf, size_t bufSize, onReceivedDataCallback , onClearCallback , void * context );
+
 void HTTPHeaderClear( HTTPHeader_t *inHeader );
 
 int CreateSimpleHTTPOKMessage( uint8_t **outMessage, size_t *outMessageSize );
@@ -43,14 +43,14 @@ OSStatus ring_buffer_deinit( ring_buffer_t* ring_buffer )
 
 uint32_t ring_buffer_free_space( ring_buffer_t* ring_buffer )
 {
-  uint32_t tail_to_end = ring_buffer->size - ring_buffer->tail;
-  return ((tail_to_end + ring_buffer->head) % ring_buffer->size);
+  uint32_t free_space = ring_buffer->size - ring_buffer->tail + ring_buffer->head;
+  return ( free_space >= ring_buffer->size ) ? free_space - ring_buffer->size : free_space;
 }
 
 uint32_t ring_buffer_used_space( ring_buffer_t* ring_buffer )
 {
-  uint32_t head_to_end = ring_buffer->size - ring_buffer->head;
-  return ((head_to_end + ring_buffer->tail) % ring_buffer->size);
+  uint32_t used_space = ring_buffer->size - ring_buffer->head + ring_buffer->tail;
+  return ( used_space >= ring_buffer->size ) ? used_space - ring_buffer->size : used_space;
 }
 
 uint8_t ring_buffer_get_data( ring_buffer_t* ring_buffer, uint8_t** data, uint32_t* contiguous_bytes )
@@ -59,22 +59,24 @@ uint8_t ring_buffer_get_data( ring_buffer_t* ring_buffer, uint8_t** data, uint32
   
   *data = &(ring_buffer->buffer[ring_buffer->head]);
   
-  *contiguous_bytes = MIN(head_to_end, (head_to_end + ring_buffer->tail) % ring_buffer->size);
+  *contiguous_bytes = MIN(head_to_end, ring_buffer_used_space( ring_buffer ));
   return 0;
 }
 
 uint8_t ring_buffer_consume( ring_buffer_t* ring_buffer, uint32_t bytes_consumed )
 {
-  ring_buffer->head = (ring_buffer->head + bytes_consumed) % ring_buffer->size;
+  uint32_t head = ring_buffer->head + bytes_consumed;
+  ring_buffer->head = ( head >= ring_buffer->size ) ? head - ring_buffer->size : head;
   return 0;
 }
 
 uint32_t ring_buffer_write( ring_buffer_t* ring_buffer, const uint8_t* data, uint32_t data_length )
 {
   uint32_t tail_to_end = ring_buffer->size - ring_buffer->tail;
+  uint32_t tail;
   
   /* Calculate the maximum amount we can copy */
-  uint32_t amount_to_copy = MIN(data_length, (ring_buffer->tail == ring_buffer->head) ? ring_buffer->size : (tail_to_end + ring_buffer->head) % ring_buffer->size);
+  uint32_t amount_to_copy = MIN(data_length, (ring_buffer->tail == ring_buffer->head) ? ring_buffer->size : ring_buffer_free_space( ring_buffer ));
   
   /* Copy as much as we can until we fall off the end of the buffer */
   memcpy(&ring_buffer->buffer[ring_buffer->tail], data, MIN(amount_to_copy, tail_to_end));
@@ -86,7 +88,110 @@ uint32_t ring_buffer_write( ring_buffer_t* ring_buffer, const uint8_t* data, uin
   }
   
   /* Update the tail */
-  ring_buffer->tail = (ring_buffer->tail + amount_to_copy) % ring_buffer->size;
+  tail = ring_buffer->tail + amount_to_copy;
+  ring_buffer->tail = ( tail >= ring_buffer->size ) ? tail - ring_buffer->size : tail;
+  
+  return amount_to_copy;
+}
+
+OSStatus ring_buffer_spsc_init( ring_buffer_spsc_t* ring_buffer, uint8_t* buffer, uint32_t size )
+{
+  OSStatus err = kNoErr;
+  
+  /* Indexes are masked instead of divided, size must be a power of two */
+  require_action( buffer && size && ( size & ( size - 1 ) ) == 0 && size <= 0x80000000UL, exit, err = kParamErr );
+  
+  ring_buffer->buffer = buffer;
+  ring_buffer->mask   = size - 1;
+  ring_buffer->head   = 0;
+  ring_buffer->tail   = 0;
+  
+exit:
+  return err;
+}
+
+uint32_t ring_buffer_spsc_free_space( ring_buffer_spsc_t* ring_buffer )
+{
+  return ring_buffer->mask + 1 - ( ring_buffer->tail - ring_buffer->head );
+}
+
+uint32_t ring_buffer_spsc_used_space( ring_buffer_spsc_t* ring_buffer )
+{
+  return ring_buffer->tail - ring_buffer->head;
+}
+
+static uint32_t _ring_buffer_spsc_regions( ring_buffer_spsc_t* ring_buffer, uint32_t index, uint32_t length, ring_buffer_region_t regions[2] )
+{
+  uint32_t offset = index & ring_buffer->mask;
+  uint32_t offset_to_end = ring_buffer->mask + 1 - offset;
+  
+  regions[0].data   = &ring_buffer->buffer[offset];
+  regions[0].length = MIN( length, offset_to_end );
+  regions[1].data   = ring_buffer->buffer;
+  regions[1].length = length - regions[0].length;
+  return length;
+}
+
+uint32_t ring_buffer_spsc_reserve( ring_buffer_spsc_t* ring_buffer, ring_buffer_region_t regions[2] )
+{
+  uint32_t tail = ring_buffer->tail;
+  uint32_t head = ring_buffer->head;
+  
+  /* Consumer must have finished reading the released space before it is overwritten */
+  RING_BUFFER_MEMORY_BARRIER();
+  return _ring_buffer_spsc_regions( ring_buffer, tail, ring_buffer->mask + 1 - ( tail - head ), regions );
+}
+
+void ring_buffer_spsc_commit( ring_buffer_spsc_t* ring_buffer, uint32_t bytes_written )
+{
+  /* Data must be visible before the consumer sees the new tail */
+  RING_BUFFER_MEMORY_BARRIER();
+  ring_buffer->tail = ring_buffer->tail + bytes_written;
+}
+
+uint32_t ring_buffer_spsc_write( ring_buffer_spsc_t* ring_buffer, const uint8_t* data, uint32_t data_length )
+{
+  ring_buffer_region_t regions[2];
+  uint32_t amount_to_copy = MIN( data_length, ring_buffer_spsc_reserve( ring_buffer, regions ) );
+  
+  memcpy( regions[0].data, data, MIN( amount_to_copy, regions[0].length ) );
+  if ( amount_to_copy > regions[0].length )
+  {
+    memcpy( regions[1].data, data + regions[0].length, amount_to_copy - regions[0].length );
+  }
+  ring_buffer_spsc_commit( ring_buffer, amount_to_copy );
+  
+  return amount_to_copy;
+}
+
+uint32_t ring_buffer_spsc_peek( ring_buffer_spsc_t* ring_buffer, ring_buffer_region_t regions[2] )
+{
+  uint32_t head = ring_buffer->head;
+  uint32_t tail = ring_buffer->tail;
+  
+  /* Data written before the tail update must not be read ahead of it */
+  RING_BUFFER_MEMORY_BARRIER();
+  return _ring_buffer_spsc_regions( ring_buffer, head, tail - head, regions );
+}
+
+void ring_buffer_spsc_consume( ring_buffer_spsc_t* ring_buffer, uint32_t bytes_consumed )
+{
+  /* Reading must be complete before the producer may reuse the space */
+  RING_BUFFER_MEMORY_BARRIER();
+  ring_buffer->head = ring_buffer->head + bytes_consumed;
+}
+
+uint32_t ring_buffer_spsc_read( ring_buffer_spsc_t* ring_buffer, uint8_t* data, uint32_t data_length )
+{
+  ring_buffer_region_t regions[2];
+  uint32_t amount_to_copy = MIN( data_length, ring_buffer_spsc_peek( ring_buffer, regions ) );
+  
+  memcpy( data, regions[0].data, MIN( amount_to_copy, regions[0].length ) );
+  if ( amount_to_copy > regions[0].length )
+  {
+    memcpy( data + regions[0].length, regions[1].data, amount_to_copy - regions[0].length );
+  }
+  ring_buffer_spsc_consume( ring_buffer, amount_to_copy );
   
   return amount_to_copy;
 }
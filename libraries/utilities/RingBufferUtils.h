@@ -33,10 +33,42 @@ typedef struct
   uint8_t*  buffer;
 } ring_buffer_t;
 
+/* Lock-free ring buffer for one producer and one consumer, e.g. a UART DMA/interrupt
+ * and a thread. Size must be a power of two. head and tail are free running indexes, 
+ * head is only written by the consumer and tail only by the producer. */
+typedef struct
+{
+  uint32_t            mask;
+  volatile uint32_t   head;
+  volatile uint32_t   tail;
+  uint8_t*            buffer;
+} ring_buffer_spsc_t;
+
+/* A contiguous part of a ring buffer, data in a ring may wrap and occupy two regions */
+typedef struct
+{
+  uint8_t*  data;
+  uint32_t  length;
+} ring_buffer_region_t;
+
 #ifndef MIN
 #define MIN(x,y)  ((x) < (y) ? (x) : (y))
 #endif /* ifndef MIN */
 
+/* Data memory barrier, orders buffer access against head/tail updates */
+#if defined ( __ICCARM__ )
+#include <intrinsics.h>
+#define RING_BUFFER_MEMORY_BARRIER()    __DMB()
+#elif defined ( __CC_ARM ) //KEIL
+#define RING_BUFFER_MEMORY_BARRIER()    __dmb( 0xF )
+#elif defined ( __GNUC__ ) && defined ( __arm__ )
+#define RING_BUFFER_MEMORY_BARRIER()    __asm volatile ( "dmb" ::: "memory" )
+#elif defined ( __GNUC__ )
+#define RING_BUFFER_MEMORY_BARRIER()    __sync_synchronize()
+#else
+#define RING_BUFFER_MEMORY_BARRIER()
+#endif
+
 OSStatus ring_buffer_init( ring_buffer_t* ring_buffer, uint8_t* buffer, uint32_t size );
 
 OSStatus ring_buffer_deinit( ring_buffer_t* ring_buffer );
@@ -51,6 +83,28 @@ uint8_t ring_buffer_consume( ring_buffer_t* ring_buffer, uint32_t bytes_consumed
 
 uint32_t ring_buffer_write( ring_buffer_t* ring_buffer, const uint8_t* data, uint32_t data_length );
 
+OSStatus ring_buffer_spsc_init( ring_buffer_spsc_t* ring_buffer, uint8_t* buffer, uint32_t size );
+
+uint32_t ring_buffer_spsc_free_space( ring_buffer_spsc_t* ring_buffer );
+
+uint32_t ring_buffer_spsc_used_space( ring_buffer_spsc_t* ring_buffer );
+
+/* Producer side: get up to two free regions to fill in place (e.g. by DMA), then
+ * publish the bytes written with ring_buffer_spsc_commit. Returns total free bytes. */
+uint32_t ring_buffer_spsc_reserve( ring_buffer_spsc_t* ring_buffer, ring_buffer_region_t regions[2] );
+
+void ring_buffer_spsc_commit( ring_buffer_spsc_t* ring_buffer, uint32_t bytes_written );
+
+uint32_t ring_buffer_spsc_write( ring_buffer_spsc_t* ring_buffer, const uint8_t* data, uint32_t data_length );
+
+/* Consumer side: get up to two regions of received data without copying, then
+ * release them with ring_buffer_spsc_consume. Returns total used bytes. */
+uint32_t ring_buffer_spsc_peek( ring_buffer_spsc_t* ring_buffer, ring_buffer_region_t regions[2] );
+
+void ring_buffer_spsc_consume( ring_buffer_spsc_t* ring_buffer, uint32_t bytes_consumed );
+
+uint32_t ring_buffer_spsc_read( ring_buffer_spsc_t* ring_buffer, uint8_t* data, uint32_t data_length );
+
 #endif // __RingBufferUtils_h__
 
 
@@ -26,52 +26,102 @@
 #define socket_utils_log(M, ...) custom_log("SocketUtils", M, ##__VA_ARGS__)
 #define socket_utils_log_trace() custom_log_trace("SocketUtils")
 
-OSStatus SocketSend( int fd, const uint8_t *inBuf, size_t inBufLen )
+static OSStatus _SocketSendv( int fd, const SocketIOVec_t *inVec, int inVecCount, size_t *ioSent, struct timeval_t *timeout )
 {
     socket_utils_log_trace();
     OSStatus err = kParamErr;
     ssize_t writeResult;
     int selectResult;
-    size_t numWritten;
     fd_set writeSet;
     struct timeval_t t;
+    size_t skip = *ioSent;
+    int i, opt;
+    socklen_t optLen;
 
     require( fd>=0, exit );
-    require( inBuf, exit );
-    require( inBufLen, exit );
+    require( inVec || inVecCount == 0, exit );
 
     err = kNotWritableErr;
 
-    FD_ZERO( &writeSet );
-    FD_SET( fd, &writeSet );
-
-    t.tv_sec = 5;
-    t.tv_usec = 0;
-    numWritten = 0;
-    do
+    for( i = 0; i < inVecCount; i++ )
     {
-        selectResult = select( fd + 1, NULL, &writeSet, NULL,  &t );
-        require( selectResult >= 1, exit );
+        /* Skip bytes sent before */
+        if( skip >= inVec[i].len ){
+            skip -= inVec[i].len;
+            continue;
+        }
 
-        writeResult = write( fd, (void *)( inBuf + numWritten ), ( inBufLen - numWritten ) );
-        require( writeResult > 0, exit );
+        do
+        {
+            FD_ZERO( &writeSet );
+            FD_SET( fd, &writeSet );
+            t = *timeout;
+            selectResult = select( fd + 1, NULL, &writeSet, NULL,  &t );
+            if( selectResult < 1 && timeout->tv_sec == 0 && timeout->tv_usec == 0 ){
+                err = EWOULDBLOCK;
+                goto exit;
+            }
+            require( selectResult >= 1, exit );
+
+            writeResult = write( fd, (void *)( inVec[i].buf + skip ), ( inVec[i].len - skip ) );
+            if( writeResult <= 0 && timeout->tv_sec == 0 && timeout->tv_usec == 0 ){
+                optLen = sizeof(opt);
+                getsockopt( fd, SOL_SOCKET, SO_ERROR, &opt, &optLen );
+                /* Socket buffer is full */
+                if( opt == EWOULDBLOCK || opt == EAGAIN || opt == ENOMEM )
+                    err = EWOULDBLOCK;
+                goto exit;
+            }
+            require( writeResult > 0, exit );
+
+            skip += writeResult;
+            *ioSent += writeResult;
+        } while( skip < inVec[i].len );
+
+        skip = 0;
+    }
 
-        numWritten += writeResult;
+    err = kNoErr;
 
-        //socket_utils_log("Wrote %zu / %zu bytes", numWritten, inBufLen);
+exit:
+    return err;
+}
 
-    } while( numWritten < inBufLen );
+OSStatus SocketSend( int fd, const uint8_t *inBuf, size_t inBufLen )
+{
+    OSStatus err = kParamErr;
+    SocketIOVec_t vec;
 
-    require_action( numWritten == inBufLen,
-                    exit,
-                    socket_utils_log("ERROR: Did not write all the bytes in the buffer. BufLen: %zu, Bytes Written: %zu", inBufLen, numWritten ); err = kUnderrunErr );
+    require( inBuf, exit );
+    require( inBufLen, exit );
 
-    err = kNoErr;
+    vec.buf = inBuf;
+    vec.len = inBufLen;
+    err = SocketSendv( fd, &vec, 1 );
 
 exit:
     return err;
 }
 
+OSStatus SocketSendv( int fd, const SocketIOVec_t *inVec, int inVecCount )
+{
+    struct timeval_t t;
+    size_t numWritten = 0;
+
+    t.tv_sec = SOCKET_SEND_TIMEOUT;
+    t.tv_usec = 0;
+    return _SocketSendv( fd, inVec, inVecCount, &numWritten, &t );
+}
+
+OSStatus SocketSendvOnce( int fd, const SocketIOVec_t *inVec, int inVecCount, size_t *ioSent )
+{
+    struct timeval_t t;
+
+    t.tv_sec = 0;
+    t.tv_usec = 0;
+    return _SocketSendv( fd, inVec, inVecCount, ioSent, &t );
+}
+
 void SocketClose(int* fd)
 {
     int tempFd = *fd;
@@ -24,8 +24,27 @@
 
 #include "Common.h"
 
+#ifndef SOCKET_SEND_TIMEOUT
+#define SOCKET_SEND_TIMEOUT   5   // Seconds SocketSend and SocketSendv wait for the socket to be writable
+#endif
+
+/* One buffer of a scatter/gather send */
+typedef struct _SocketIOVec_t {
+  const uint8_t *buf;
+  size_t        len;
+} SocketIOVec_t;
+
 OSStatus SocketSend( int fd, const uint8_t *inBuf, size_t inBufLen );
 
+/* Send all buffers in order as one stream, without copying them together */
+OSStatus SocketSendv( int fd, const SocketIOVec_t *inVec, int inVecCount );
+
+/* Send as much as the socket takes without blocking. *ioSent is the number of bytes 
+   already sent, start with 0 and keep it between calls. Returns EWOULDBLOCK when there 
+   are bytes left, call again when the socket is writable. The socket should be set to
+   non-block mode (SO_BLOCKMODE) so a write is never blocked. */
+OSStatus SocketSendvOnce( int fd, const SocketIOVec_t *inVec, int inVecCount, size_t *ioSent );
+
 void SocketClose(int* fd);
 
 void SocketCloseForOSEvent(int* fd);
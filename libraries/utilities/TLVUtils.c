@@ -55,3 +55,85 @@ OSStatus TLVGetNext( const uint8_t *    inSrc,
     return( kNoErr );
 }
 
+OSStatus TLVGetNextJoined( const uint8_t *    inSrc, 
+                           const uint8_t *    inEnd, 
+                           uint8_t *          outID, 
+                           uint8_t *          outBuf, 
+                           size_t             inBufSize, 
+                           size_t *           outLen, 
+                           const uint8_t **   outNext )
+{
+    OSStatus            err;
+    uint8_t             id;
+    uint8_t             nextID;
+    const uint8_t *     ptr;
+    size_t              len;
+    size_t              total;
+    const uint8_t *     next;
+
+    err = TLVGetNext( inSrc, inEnd, &id, &ptr, &len, &next );
+    if( err != kNoErr )
+        return( err );
+
+    total = 0;
+    for( ;; )
+    {
+        if( outBuf )
+        {
+            if( len > ( inBufSize - total ) )
+                return( kNoSpaceErr );
+            memcpy( outBuf + total, ptr, len );
+        }
+        total += len;
+
+        // a full item followed by one of the same ID is continued by it
+        if( ( len != 255 ) || ( next >= inEnd ) || ( next[ 0 ] != id ) )
+            break;
+        err = TLVGetNext( next, inEnd, &nextID, &ptr, &len, &next );
+        if( err != kNoErr )
+            return( kUnderrunErr );
+    }
+
+    *outID  = id;
+    *outLen = total;
+    if( outNext )
+        *outNext = next;
+
+    return( kNoErr );
+}
+
+OSStatus TLVAdd( uint8_t **         ioPtr, 
+                 const uint8_t *    inEnd, 
+                 uint8_t            inID, 
+                 const void *       inData, 
+                 size_t             inLen )
+{
+    uint8_t *           dst;
+    const uint8_t *     src;
+    size_t              len;
+    size_t              need;
+
+    // each 255 bytes, and the last part even if empty, take a 2 bytes header,
+    // inLen is checked first so need does not wrap
+    if( ( *ioPtr > inEnd ) || ( inLen > (size_t)( inEnd - *ioPtr ) ) )
+        return( kNoSpaceErr );
+    need = inLen + 2 * ( ( inLen / 255 ) + 1 );
+    if( need > (size_t)( inEnd - *ioPtr ) )
+        return( kNoSpaceErr );
+
+    dst = *ioPtr;
+    src = (const uint8_t *) inData;
+    do
+    {
+        len = ( inLen > 255 ) ? 255 : inLen;
+        *dst++ = inID;
+        *dst++ = (uint8_t) len;
+        memcpy( dst, src, len );
+        dst   += len;
+        src   += len;
+        inLen -= len;
+    } while( ( len == 255 ) || ( inLen > 0 ) );
+
+    *ioPtr = dst;
+    return( kNoErr );
+}
@@ -35,5 +35,28 @@ OSStatus TLVGetNext(
         size_t *            outLen, 
         const uint8_t **    outNext );
 
+// Like TLVGetNext, for a value split by TLVAdd: outLen is the length of the
+// joined value, which is copied to outBuf if it is not NULL. kNoSpaceErr if
+// it is longer than inBufSize.
+OSStatus TLVGetNextJoined( 
+        const uint8_t *     inSrc, 
+        const uint8_t *     inEnd, 
+        uint8_t *           outID, 
+        uint8_t *           outBuf, 
+        size_t              inBufSize, 
+        size_t *            outLen, 
+        const uint8_t **    outNext );
+
+// Append an item at *ioPtr and move *ioPtr after it. A value longer than 255
+// bytes is split into items of the same ID, all but the last 255 bytes long.
+// inEnd is the end of the buffer: kNoSpaceErr and nothing is written if the
+// item does not fit before it.
+OSStatus TLVAdd( 
+        uint8_t **          ioPtr, 
+        const uint8_t *     inEnd, 
+        uint8_t             inID, 
+        const void *        inData, 
+        size_t              inLen );
+
 #endif // __TLVUtils_h__
 
@@ -0,0 +1,269 @@
+/**
+******************************************************************************
+* @file    crc-bench.c
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   CRC16 engine tests against the original bitwise shift register, and the cost of
+*          a byte for each engine.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+/* Built on the host, once per engine of CheckSumUtils.h, MICO/system/host holds the stub platform headers:
+ *
+ *   for s in 0 1 4 8; do
+ *     cc -O2 -DDEBUG=0 -DCRC_BENCH_MAIN -DCRC16_TABLE_SLICES=$s -IMICO/system/host -Iinclude -Ilibraries/utilities \
+ *        libraries/utilities/crc-bench.c libraries/utilities/CheckSumUtils.c -o crc-bench && ./crc-bench
+ *   done
+ *
+ * On the target crc_bench() can be called from a test command, results are then in ns from mico_get_time()
+ * instead of cycles.
+ */
+
+#include "Common.h"
+#include "Debug.h"
+#include "CheckSumUtils.h"
+
+#include <stdio.h>
+
+#if( defined( __i386__ ) || defined( __x86_64__ ) )
+    #include <x86intrin.h>
+    #define crc_bench_ticks()       ( (uint64_t) __rdtsc() )
+    #define kCRC_BenchUnit          "cycles"
+    #define kCRC_BenchScale         1
+#elif( defined( CRC_BENCH_MAIN ) )
+    #include <time.h>
+    static uint64_t crc_bench_ticks( void )
+    {
+        struct timespec     ts;
+
+        clock_gettime( CLOCK_MONOTONIC, &ts );
+        return( ( (uint64_t) ts.tv_sec * 1000000000 ) + ts.tv_nsec );
+    }
+    #define kCRC_BenchUnit          "ns"
+    #define kCRC_BenchScale         1
+#else
+    #define crc_bench_ticks()       ( (uint64_t) mico_get_time() )
+    #define kCRC_BenchUnit          "ns"
+    #define kCRC_BenchScale         1000000
+#endif
+
+#define kCRC_BenchBufSize           8192
+#define kCRC_BenchImageSize         ( 400 * 1024 )  // An OTA image, checked kCRC_BenchBufSize bytes at a time
+
+static uint8_t      gCRC_BenchBuf[ kCRC_BenchBufSize + 8 ];
+
+//===========================================================================================================================
+//  crc_bench_reference
+//
+//  The CRC as computed before the table engines: every byte through the shift register of the old UpdateCRC16, then two
+//  zero bytes.
+//===========================================================================================================================
+
+static uint16_t crc_bench_update( uint16_t inCRC, uint8_t inByte )
+{
+    uint32_t        crc = inCRC;
+    uint32_t        in  = inByte | 0x100;
+
+    do
+    {
+        crc <<= 1;
+        in  <<= 1;
+        if( in & 0x100 ) ++crc;
+        if( crc & 0x10000 ) crc ^= 0x1021;
+    }   while( !( in & 0x10000 ) );
+
+    return( (uint16_t)( crc & 0xFFFF ) );
+}
+
+static uint16_t crc_bench_reference( const uint8_t *inData, size_t inLen )
+{
+    uint16_t        crc = 0;
+    size_t          i;
+
+    for( i = 0; i < inLen; ++i ) crc = crc_bench_update( crc, inData[ i ] );
+    crc = crc_bench_update( crc, 0 );
+    crc = crc_bench_update( crc, 0 );
+    return( crc );
+}
+
+static uint16_t crc_bench_crc16( const uint8_t *inData, size_t inLen )
+{
+    CRC16_Context       ctx;
+    uint16_t            crc;
+
+    CRC16_Init( &ctx );
+    CRC16_Update( &ctx, inData, inLen );
+    CRC16_Final( &ctx, &crc );
+    return( crc );
+}
+
+//===========================================================================================================================
+//  crc_vector_test
+//===========================================================================================================================
+
+static OSStatus crc_vector_test( void )
+{
+    OSStatus        err = kNoErr;
+    CRC16_Context   ctx;
+
+    require_action( crc_bench_reference( (const uint8_t *) "123456789", 9 ) == 0x31C3, exit, err = kMismatchErr );
+    require_action( crc_bench_crc16( (const uint8_t *) "123456789", 9 ) == 0x31C3, exit, err = kMismatchErr );
+    require_action( crc_bench_crc16( gCRC_BenchBuf, 0 ) == 0x0000, exit, err = kMismatchErr );
+
+    // The context is saved by http_ota to resume a download, it must hold the same value with every engine.
+
+    CRC16_Init( &ctx );
+    CRC16_Update( &ctx, "123456789", 9 );
+    require_action( ctx.crc == 0x31C3, exit, err = kMismatchErr );
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  crc_split_test
+//
+//  Every length and alignment, in one update and split at every point, is the same as the bitwise reference: the slice
+//  loops, the byte loop after them, and a context carried between updates.
+//===========================================================================================================================
+
+static OSStatus crc_split_test( void )
+{
+    OSStatus            err = kNoErr;
+    CRC16_Context       ctx;
+    uint16_t            ref, crc;
+    size_t              off, len, split, i, n;
+    uint32_t            seed = 1;
+
+    for( i = 0; i < sizeof( gCRC_BenchBuf ); ++i ) gCRC_BenchBuf[ i ] = (uint8_t)( i * 7 + ( i >> 8 ) );
+
+    for( off = 0; off < 8; ++off )
+    {
+        for( len = 0; len <= 300; ++len )
+        {
+            ref = crc_bench_reference( &gCRC_BenchBuf[ off ], len );
+            require_action( crc_bench_crc16( &gCRC_BenchBuf[ off ], len ) == ref, exit, err = kMismatchErr );
+            if( len > 40 ) continue;
+
+            for( split = 0; split <= len; ++split )
+            {
+                CRC16_Init( &ctx );
+                CRC16_Update( &ctx, &gCRC_BenchBuf[ off ], split );
+                CRC16_Update( &ctx, &gCRC_BenchBuf[ off + split ], len - split );
+                CRC16_Final( &ctx, &crc );
+                require_action( crc == ref, exit, err = kMismatchErr );
+            }
+        }
+    }
+
+    // Whole buffer in random pieces, as an OTA image arrives from the socket
+
+    ref = crc_bench_reference( gCRC_BenchBuf, kCRC_BenchBufSize );
+    for( i = 0; i < 200; ++i )
+    {
+        CRC16_Init( &ctx );
+        for( off = 0; off < kCRC_BenchBufSize; off += n )
+        {
+            seed = seed * 1103515245 + 12345;
+            n = Min( 1 + ( seed >> 16 ) % 1500, kCRC_BenchBufSize - off );
+            CRC16_Update( &ctx, &gCRC_BenchBuf[ off ], n );
+        }
+        CRC16_Final( &ctx, &crc );
+        require_action( crc == ref, exit, err = kMismatchErr );
+    }
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  crc_bench_report
+//===========================================================================================================================
+
+static void crc_bench_report( const char *inMode, size_t inLen, uint64_t inTicks, size_t inCount )
+{
+    printf( "%-28s %6u bytes: %10.2f %s/byte\n", inMode, (unsigned int) inLen,
+        ( (double) inTicks * kCRC_BenchScale ) / (double) inCount, kCRC_BenchUnit );
+}
+
+//===========================================================================================================================
+//  crc_bench
+//===========================================================================================================================
+
+OSStatus    crc_bench( int print )
+{
+    static const size_t     kLengths[] = { 16, 64, 256, 1024, kCRC_BenchBufSize };
+    OSStatus                err;
+    CRC16_Context           ctx;
+    char                    mode[ 32 ];
+    uint64_t                t;
+    size_t                  i, n, loops;
+    volatile uint16_t       sink = 0;
+
+    err = crc_vector_test();
+    require_noerr( err, exit );
+    err = crc_split_test();
+    require_noerr( err, exit );
+    if( !print ) goto exit;
+
+    snprintf( mode, sizeof( mode ), "CRC16_Update, %d slices", CRC16_TABLE_SLICES );
+    for( i = 0; i < sizeof( kLengths ) / sizeof( kLengths[ 0 ] ); ++i )
+    {
+        loops = ( 1024 * 1024 ) / kLengths[ i ];
+
+        t = crc_bench_ticks();
+        for( n = 0; n < loops; ++n ) sink += crc_bench_reference( gCRC_BenchBuf, kLengths[ i ] );
+        crc_bench_report( "Shift register, bitwise", kLengths[ i ], crc_bench_ticks() - t, loops * kLengths[ i ] );
+
+        t = crc_bench_ticks();
+        for( n = 0; n < loops; ++n ) sink += crc_bench_crc16( gCRC_BenchBuf, kLengths[ i ] );
+        crc_bench_report( mode, kLengths[ i ], crc_bench_ticks() - t, loops * kLengths[ i ] );
+
+        t = crc_bench_ticks();
+        for( n = 0; n < loops; ++n ) sink += crc_bench_crc16( &gCRC_BenchBuf[ 1 ], kLengths[ i ] );
+        crc_bench_report( "  unaligned", kLengths[ i ], crc_bench_ticks() - t, loops * kLengths[ i ] );
+    }
+
+    // The check of a whole OTA image
+
+    t = crc_bench_ticks();
+    CRC16_Init( &ctx );
+    for( n = 0; n < kCRC_BenchImageSize; n += kCRC_BenchBufSize ) CRC16_Update( &ctx, gCRC_BenchBuf, kCRC_BenchBufSize );
+    CRC16_Final( &ctx, (uint16_t *) &sink );
+    t = crc_bench_ticks() - t;
+    printf( "%-28s %6u bytes: %10.2f %s\n", mode, kCRC_BenchImageSize, (double) t * kCRC_BenchScale, kCRC_BenchUnit );
+    (void) sink;
+
+exit:
+    printf( "%s: %s\n", __FUNCTION__, !err ? "PASSED" : "FAILED" );
+    return( err );
+}
+
+#if( defined( CRC_BENCH_MAIN ) )
+int main( void )
+{
+    return( crc_bench( 1 ) ? 1 : 0 );
+}
+#endif
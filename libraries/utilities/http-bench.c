@@ -0,0 +1,606 @@
+/**
+******************************************************************************
+* @file    http-bench.c
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   Chunked HTTP body tests with the message split at any point, and
+*          the cost of decoding a byte.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+/* Built on the host only. The socket is the read() and select() below, which hand out a message in the pieces a test
+ * asks for: a first read of any size, then fixed or random sizes. MICO/system/host holds the stub platform headers and
+ * a MICO.h for the host:
+ *
+ *   cc -O2 -DDEBUG=1 -DHTTP_BENCH_MAIN -IMICO/system/host -Iinclude -Ilibraries/utilities libraries/utilities/http-bench.c \
+ *      libraries/utilities/HTTPUtils.c libraries/utilities/StringUtils.c libraries/utilities/URLUtils.c \
+ *      -o http-bench && ./http-bench
+ */
+
+#include "MICO.h"
+#include "HTTPUtils.h"
+
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#if( defined( HTTP_BENCH_MAIN ) )
+
+#if( defined( __i386__ ) || defined( __x86_64__ ) )
+    #include <x86intrin.h>
+    #define http_bench_ticks()      ( (uint64_t) __rdtsc() )
+    #define kHTTP_BenchUnit         "cycles"
+#else
+    #include <time.h>
+    static uint64_t http_bench_ticks( void )
+    {
+        struct timespec     ts;
+
+        clock_gettime( CLOCK_MONOTONIC, &ts );
+        return( ( (uint64_t) ts.tv_sec * 1000000000 ) + ts.tv_nsec );
+    }
+    #define kHTTP_BenchUnit         "ns"
+#endif
+
+#define kHTTP_BenchBodyMax          ( 400 * 1024 )
+#define kHTTP_BenchMessageMax       ( 2 * kHTTP_BenchBodyMax )
+
+//===========================================================================================================================
+//  RTOS calls on the host
+//===========================================================================================================================
+
+int                     mico_debug_enabled = 1;
+mico_mutex_t            stdio_tx_mutex;
+
+uint32_t mico_get_time( void )
+{
+    return( 0 );
+}
+
+OSStatus mico_rtos_lock_mutex( mico_mutex_t *inMutex )
+{
+    (void) inMutex;
+    return( kNoErr );
+}
+
+OSStatus mico_rtos_unlock_mutex( mico_mutex_t *inMutex )
+{
+    (void) inMutex;
+    return( kNoErr );
+}
+
+//===========================================================================================================================
+//  Socket
+//===========================================================================================================================
+
+static char             gHTTP_BenchMessage[ kHTTP_BenchMessageMax ];
+static size_t           gHTTP_BenchMessageLen;
+static size_t           gHTTP_BenchPos;             // Next byte read() hands out
+static size_t           gHTTP_BenchAvail;           // Bytes received so far, read() never goes past them
+static size_t           gHTTP_BenchFirst;           // Size of the first read, 0 for the same as the others
+static size_t           gHTTP_BenchStep;            // Size of the next reads
+static bool             gHTTP_BenchRandom;          // 1 to gHTTP_BenchStep bytes per read
+static bool             gHTTP_BenchClosed;          // The peer closed after the last byte
+static int              gHTTP_BenchReads;
+static int              gHTTP_BenchEmptyReads;      // read() with no data, it would have blocked
+static unsigned int     gHTTP_BenchSeed = 1;
+
+ssize_t read( int fd, void *buf, size_t count )
+{
+    size_t      n;
+
+    (void) fd;
+    gHTTP_BenchReads++;
+    if( gHTTP_BenchPos >= gHTTP_BenchAvail )
+    {
+        if( gHTTP_BenchClosed ) return( 0 );
+        gHTTP_BenchEmptyReads++;
+        errno = EWOULDBLOCK;
+        return( -1 );
+    }
+    if( gHTTP_BenchPos == 0 && gHTTP_BenchFirst )   n = gHTTP_BenchFirst;
+    else if( gHTTP_BenchRandom )                    n = 1 + rand_r( &gHTTP_BenchSeed ) % gHTTP_BenchStep;
+    else                                            n = gHTTP_BenchStep;
+    n = Min( n, Min( count, gHTTP_BenchAvail - gHTTP_BenchPos ) );
+    memcpy( buf, &gHTTP_BenchMessage[ gHTTP_BenchPos ], n );
+    gHTTP_BenchPos += n;
+    return( (ssize_t) n );
+}
+
+// Readable while there is data or the peer has closed, a time out at once otherwise.
+
+int select( int nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds, struct timeval *timeout )
+{
+    (void) nfds; (void) readfds; (void) writefds; (void) exceptfds; (void) timeout;
+    return( ( gHTTP_BenchPos < gHTTP_BenchAvail || gHTTP_BenchClosed ) ? 1 : 0 );
+}
+
+static void http_bench_feed( size_t inFirst, size_t inStep, bool inRandom )
+{
+    gHTTP_BenchPos = 0;
+    gHTTP_BenchAvail = gHTTP_BenchMessageLen;
+    gHTTP_BenchFirst = inFirst;
+    gHTTP_BenchStep = inStep;
+    gHTTP_BenchRandom = inRandom;
+    gHTTP_BenchClosed = false;
+    gHTTP_BenchReads = 0;
+    gHTTP_BenchEmptyReads = 0;
+}
+
+//===========================================================================================================================
+//  Messages
+//===========================================================================================================================
+
+static uint8_t          gHTTP_BenchBody[ kHTTP_BenchBodyMax ];
+static uint8_t          gHTTP_BenchGot[ kHTTP_BenchBodyMax ];
+static size_t           gHTTP_BenchGotLen;
+static int              gHTTP_BenchCalls;
+static OSStatus         gHTTP_BenchCallbackErr;     // Returned from the second call on
+static OSStatus         gHTTP_BenchFirstErr;        // Returned from the first call
+
+// Data must come in order, each call right after the previous one.
+
+static OSStatus http_bench_received( struct _HTTPHeader_t *inHeader, uint32_t inPos, uint8_t *inData, size_t inLen, void *inContext )
+{
+    (void) inHeader; (void) inContext;
+    if( inPos != gHTTP_BenchGotLen || inPos + inLen > sizeof( gHTTP_BenchGot ) ) return( kOrderErr );
+    memcpy( &gHTTP_BenchGot[ inPos ], inData, inLen );
+    gHTTP_BenchGotLen = inPos + inLen;
+    return( ( gHTTP_BenchCalls++ == 0 ) ? gHTTP_BenchFirstErr : gHTTP_BenchCallbackErr );
+}
+
+// A chunked response of inBodyLen bytes of gHTTP_BenchBody in chunks of 1 to inChunkMax bytes, with size lines in both
+// cases, extensions, an optional long trailer, then a pipelined request for /next.
+
+static void http_bench_message( const char *inStartLine, size_t inBodyLen, size_t inChunkMax, bool inTrailer )
+{
+    size_t      off, n;
+    int         len;
+
+    len = sprintf( gHTTP_BenchMessage, "%s\r\nTransfer-Encoding: chunked\r\n\r\n", inStartLine );
+    for( off = 0; off < inBodyLen; off += n )
+    {
+        n = 1 + rand_r( &gHTTP_BenchSeed ) % inChunkMax;
+        n = Min( n, inBodyLen - off );
+        switch( rand_r( &gHTTP_BenchSeed ) % 3 )
+        {
+            case 0:  len += sprintf( &gHTTP_BenchMessage[ len ], "%zx\r\n", n ); break;
+            case 1:  len += sprintf( &gHTTP_BenchMessage[ len ], "%04zX;name=value\r\n", n ); break;
+            default: len += sprintf( &gHTTP_BenchMessage[ len ], "%zx \r\n", n ); break;
+        }
+        memcpy( &gHTTP_BenchMessage[ len ], &gHTTP_BenchBody[ off ], n );
+        len += n;
+        len += sprintf( &gHTTP_BenchMessage[ len ], "\r\n" );
+    }
+    len += sprintf( &gHTTP_BenchMessage[ len ], "0\r\n" );
+    if( inTrailer ) len += sprintf( &gHTTP_BenchMessage[ len ], "X-Trailer: %0600d\r\nX-Other: 1\r\n", 7 );
+    len += sprintf( &gHTTP_BenchMessage[ len ], "\r\nGET /next HTTP/1.1\r\n\r\n" );
+    gHTTP_BenchMessageLen = len;
+}
+
+static void http_bench_reset_callback( void )
+{
+    gHTTP_BenchGotLen = 0;
+    gHTTP_BenchCalls = 0;
+    gHTTP_BenchCallbackErr = kNoErr;
+    gHTTP_BenchFirstErr = kNoErr;
+}
+
+// Reads the response with the blocking calls, checks the body, then reads the pipelined request.
+
+static OSStatus http_bench_read( HTTPHeader_t *inHeader, size_t inBodyLen )
+{
+    OSStatus        err;
+
+    http_bench_reset_callback();
+    err = SocketReadHTTPHeader( 0, inHeader );
+    require_noerr( err, exit );
+    err = SocketReadHTTPBody( 0, inHeader );
+    require_noerr( err, exit );
+    require_action( gHTTP_BenchGotLen == inBodyLen && memcmp( gHTTP_BenchGot, gHTTP_BenchBody, inBodyLen ) == 0, exit,
+                    err = kMismatchErr );
+
+    HTTPHeaderClear( inHeader );
+    err = SocketReadHTTPHeader( 0, inHeader );
+    require_noerr( err, exit );
+    require_action( HTTPHeaderMatchURL( inHeader, "/next" ) == kNoErr, exit, err = kMismatchErr );
+
+exit:
+    HTTPHeaderClear( inHeader );
+    return( err );
+}
+
+//===========================================================================================================================
+//  http_split_test
+//===========================================================================================================================
+
+// A small message split in two at every byte, then in every fixed read size, then large bodies in random pieces.
+
+static OSStatus http_split_test( void )
+{
+    OSStatus            err = kNoErr;
+    HTTPHeader_t *      header;
+    size_t              i, len;
+
+    for( i = 0; i < sizeof( gHTTP_BenchBody ); ++i ) gHTTP_BenchBody[ i ] = (uint8_t) rand_r( &gHTTP_BenchSeed );
+    header = HTTPHeaderCreateWithCallback( http_bench_received, NULL, NULL );
+    require_action( header, exit, err = kNoMemoryErr );
+
+    http_bench_message( "HTTP/1.1 200 OK", 40, 7, true );
+    for( i = 1; i < gHTTP_BenchMessageLen; ++i )
+    {
+        http_bench_feed( i, gHTTP_BenchMessageLen, false );
+        err = http_bench_read( header, 40 );
+        require_noerr( err, exit );
+    }
+    for( i = 1; i <= 64; ++i )
+    {
+        http_bench_feed( 0, i, false );
+        err = http_bench_read( header, 40 );
+        require_noerr( err, exit );
+    }
+
+    for( i = 0; i < 300; ++i )
+    {
+        len = rand_r( &gHTTP_BenchSeed ) % ( ( i < 100 ) ? 50 : 150000 );
+        http_bench_message( "HTTP/1.1 200 OK", len, ( i < 100 ) ? 3 : 5000, i & 1 );
+        http_bench_feed( 0, 1 + rand_r( &gHTTP_BenchSeed ) % ( ( i % 2 ) ? 7 : 3000 ), ( i % 4 ) != 0 );
+        err = http_bench_read( header, len );
+        require_noerr( err, exit );
+    }
+
+exit:
+    if( header ) free( header );
+    return( err );
+}
+
+//===========================================================================================================================
+//  http_once_test
+//===========================================================================================================================
+
+// The select() loop of a server: data comes in pieces, each call reads at most once and never when nothing came.
+
+static OSStatus http_once_test( void )
+{
+    OSStatus            err = kNoErr;
+    HTTPHeader_t *      header;
+    size_t              len;
+    bool                body;
+    int                 i;
+
+    header = HTTPHeaderCreateWithBuffer( NULL, 512, http_bench_received, NULL, NULL );
+    require_action( header, exit, err = kNoMemoryErr );
+
+    for( i = 0; i < 2000; ++i )
+    {
+        len = rand_r( &gHTTP_BenchSeed ) % ( ( i % 2 ) ? 100 : 100000 );
+        http_bench_message( "POST /config-write HTTP/1.1", len, 3000, i & 1 );
+        http_bench_feed( 0, gHTTP_BenchMessageLen, false );
+        http_bench_reset_callback();
+        gHTTP_BenchAvail = 0;
+        body = false;
+
+        for( ;; )
+        {
+            // One more segment arrives, the socket is readable
+            if( gHTTP_BenchAvail < gHTTP_BenchMessageLen )
+            {
+                gHTTP_BenchAvail += 1 + rand_r( &gHTTP_BenchSeed ) % ( ( i & 2 ) ? 5 : 4000 );
+                gHTTP_BenchAvail = Min( gHTTP_BenchAvail, gHTTP_BenchMessageLen );
+            }
+            if( !body )
+            {
+                err = SocketReadHTTPHeaderOnce( 0, header );
+                if( err == EWOULDBLOCK ) continue;
+                require_noerr( err, exit );
+                body = true;
+                if( header->extraDataLen == 0 ) continue;
+            }
+            gHTTP_BenchReads = 0;
+            err = SocketReadHTTPBodyOnce( 0, header );
+            require_action( gHTTP_BenchReads <= 1, exit, err = kCountErr );
+            if( err == EWOULDBLOCK ) continue;
+            require_noerr( err, exit );
+            break;
+        }
+        require_action( gHTTP_BenchEmptyReads == 0, exit, err = kStateErr );
+        require_action( gHTTP_BenchGotLen == len && memcmp( gHTTP_BenchGot, gHTTP_BenchBody, len ) == 0, exit,
+                        err = kMismatchErr );
+
+        HTTPHeaderClear( header );
+        gHTTP_BenchAvail = gHTTP_BenchMessageLen;
+        err = SocketReadHTTPHeader( 0, header );
+        require_noerr( err, exit );
+        require_action( HTTPHeaderMatchURL( header, "/next" ) == kNoErr, exit, err = kMismatchErr );
+        HTTPHeaderClear( header );
+    }
+
+exit:
+    if( header ) free( header );
+    return( err );
+}
+
+//===========================================================================================================================
+//  http_error_test
+//===========================================================================================================================
+
+typedef struct
+{
+    const char *    body;       // After the header
+    bool            closed;     // The peer closes after it
+    OSStatus        err;
+
+}   http_bench_error_t;
+
+static const http_bench_error_t     kHTTP_BenchErrors[] =
+{
+    { "5\r\nhelloXX\r\n0\r\n\r\n",              false,  kMalformedErr },    // No CRLF after the data
+    { "5\r\nhelloA5\r\nhello\r\n0\r\n\r\n",     false,  kMalformedErr },
+    { "5\r\nhello\rX",                          false,  kMalformedErr },
+    { "G\r\n",                                  false,  kMalformedErr },    // Not a size
+    { ";ext\r\n",                               false,  kMalformedErr },
+    { "5\rX",                                   false,  kMalformedErr },
+    { "10000000000000000\r\n",                  false,  kMalformedErr },    // More than 64 bits
+    { "0\r\n\rX",                               false,  kMalformedErr },
+    { "5\r\nhel",                               false,  kTimeoutErr },      // Nothing more comes
+    { "5\r\nhel",                               true,   kConnectionErr },
+    { "0\r\nX-Trailer: 1\r\n",                  true,   kConnectionErr },
+};
+
+// Each error ends the body, nothing is left for a next request.
+
+static OSStatus http_error_test( void )
+{
+    OSStatus            err = kNoErr;
+    HTTPHeader_t *      header;
+    size_t              i, first;
+
+    header = HTTPHeaderCreateWithCallback( http_bench_received, NULL, NULL );
+    require_action( header, exit, err = kNoMemoryErr );
+
+    for( i = 0; i < sizeof( kHTTP_BenchErrors ) / sizeof( kHTTP_BenchErrors[ 0 ] ); ++i )
+    {
+        for( first = 1; first < 60; first += 3 )
+        {
+            gHTTP_BenchMessageLen = sprintf( gHTTP_BenchMessage, "HTTP/1.1 200 OK\r\nTransfer-Encoding: chunked\r\n\r\n%s",
+                                             kHTTP_BenchErrors[ i ].body );
+            http_bench_feed( first, 3, false );
+            gHTTP_BenchClosed = kHTTP_BenchErrors[ i ].closed;
+            http_bench_reset_callback();
+            err = SocketReadHTTPHeader( 0, header );
+            require_noerr( err, exit );
+            err = SocketReadHTTPBody( 0, header );
+            require_action( err == kHTTP_BenchErrors[ i ].err, exit, printf( "case %u: %d\n", (unsigned int) i, (int) err );
+                            err = kMismatchErr );
+            require_action( header->len == 0 && header->extraDataLen == 0, exit, err = kStateErr );
+            HTTPHeaderClear( header );
+            require_action( header->len == 0, exit, err = kStateErr );
+        }
+    }
+    err = kNoErr;
+
+exit:
+    if( header ) free( header );
+    return( err );
+}
+
+//===========================================================================================================================
+//  http_callback_test
+//===========================================================================================================================
+
+// A body the application does not take at its first data is read to its end and dropped, the next request is read.
+// An error after the first data stops the body.
+
+static OSStatus http_callback_test( void )
+{
+    OSStatus            err = kNoErr;
+    HTTPHeader_t *      header;
+
+    header = HTTPHeaderCreateWithCallback( http_bench_received, NULL, NULL );
+    require_action( header, exit, err = kNoMemoryErr );
+    http_bench_message( "POST /config-write HTTP/1.1", 3000, 100, false );
+
+    http_bench_feed( 0, 7, false );
+    http_bench_reset_callback();
+    gHTTP_BenchFirstErr = kUnsupportedErr;
+    err = SocketReadHTTPHeader( 0, header );
+    require_noerr( err, exit );
+    err = SocketReadHTTPBody( 0, header );
+    require_noerr( err, exit );
+    require_action( header->isCallbackSupported == false && gHTTP_BenchCalls == 1, exit, err = kStateErr );
+    HTTPHeaderClear( header );
+    err = SocketReadHTTPHeader( 0, header );
+    require_noerr( err, exit );
+    require_action( HTTPHeaderMatchURL( header, "/next" ) == kNoErr, exit, err = kMismatchErr );
+    HTTPHeaderClear( header );
+
+    http_bench_feed( 0, 7, false );
+    http_bench_reset_callback();
+    gHTTP_BenchCallbackErr = kWriteErr;
+    err = SocketReadHTTPHeader( 0, header );
+    require_noerr( err, exit );
+    err = SocketReadHTTPBody( 0, header );
+    require_action( err == kWriteErr && header->isCallbackSupported == true && gHTTP_BenchCalls == 2, exit,
+                    err = kStateErr );
+    HTTPHeaderClear( header );
+    err = kNoErr;
+
+exit:
+    if( header ) free( header );
+    return( err );
+}
+
+//===========================================================================================================================
+//  http_legacy_test
+//===========================================================================================================================
+
+// Headers allocated by the prebuilt libraries are the HTTPHeader_t of their headers, which ends at onClearCallback:
+// no room for the decoder state, the blocking decoder keeps it on the stack and SocketReadHTTPBodyOnce reads the
+// whole body.
+
+typedef struct
+{
+    char                buf[ 512 ];
+    size_t              len;
+    char *              extraDataPtr;
+    char *              otaDataPtr;
+    size_t              extraDataLen;
+    const char *        methodPtr;
+    size_t              methodLen;
+    const char *        urlPtr;
+    size_t              urlLen;
+    URLComponents       url;
+    const char *        protocolPtr;
+    size_t              protocolLen;
+    int                 statusCode;
+    const char *        reasonPhrasePtr;
+    size_t              reasonPhraseLen;
+    uint8_t             channelID;
+    uint64_t            contentLength;
+    bool                persistent;
+    int                 firstErr;
+    bool                dataEndedbyClose;
+    bool                chunkedData;
+    char *              chunkedDataBufferPtr;
+    size_t              chunkedDataBufferLen;
+    void *              userContext;
+    bool                isCallbackSupported;
+    onReceivedDataCallback  onReceivedDataCallback;
+    onClearCallback     onClearCallback;
+
+}   http_bench_legacy_header_t;
+
+typedef char http_bench_legacy_size_check[ ( sizeof( http_bench_legacy_header_t ) == offsetof( HTTPHeader_t, headerBuf ) ) ? 1 : -1 ];
+typedef char http_bench_legacy_callback_check[ ( offsetof( http_bench_legacy_header_t, onReceivedDataCallback ) ==
+    offsetof( HTTPHeader_t, onReceivedDataCallback ) ) ? 1 : -1 ];
+
+static OSStatus http_legacy_test( void )
+{
+    OSStatus                        err = kNoErr;
+    http_bench_legacy_header_t *    legacy;
+    HTTPHeader_t *                  header;
+    int                             i;
+
+    legacy = (http_bench_legacy_header_t *) calloc( 1, sizeof( http_bench_legacy_header_t ) );
+    require_action( legacy, exit, err = kNoMemoryErr );
+    legacy->onReceivedDataCallback = http_bench_received;
+    header = (HTTPHeader_t *) legacy;
+    HTTPHeaderClear( header );
+
+    for( i = 0; i < 50; ++i )
+    {
+        http_bench_message( "HTTP/1.1 200 OK", 1 + rand_r( &gHTTP_BenchSeed ) % 20000, 700, i & 1 );
+        http_bench_feed( 0, 1 + i * 37, true );
+        http_bench_reset_callback();
+        err = SocketReadHTTPHeader( 0, header );
+        require_noerr( err, exit );
+        err = ( i & 1 ) ? SocketReadHTTPBody( 0, header ) : SocketReadHTTPBodyOnce( 0, header );
+        require_noerr( err, exit );
+        require_action( memcmp( gHTTP_BenchGot, gHTTP_BenchBody, gHTTP_BenchGotLen ) == 0, exit, err = kMismatchErr );
+        HTTPHeaderClear( header );
+        err = SocketReadHTTPHeader( 0, header );
+        require_noerr( err, exit );
+        require_action( HTTPHeaderMatchURL( header, "/next" ) == kNoErr, exit, err = kMismatchErr );
+        HTTPHeaderClear( header );
+    }
+
+exit:
+    if( legacy ) free( legacy );
+    return( err );
+}
+
+//===========================================================================================================================
+//  http_bench_report
+//===========================================================================================================================
+
+static void http_bench_report( const char *inMode, size_t inLen, uint64_t inTicks, size_t inCount )
+{
+    printf( "%-36s %6u bytes: %10.2f %s/byte\n", inMode, (unsigned int) inLen, (double) inTicks / (double) inCount,
+            kHTTP_BenchUnit );
+}
+
+//===========================================================================================================================
+//  http_bench
+//===========================================================================================================================
+
+OSStatus    http_bench( int print )
+{
+    static const size_t     kChunks[] = { 64, 1024, 16384 };
+    OSStatus                err;
+    HTTPHeader_t *          header = NULL;
+    char                    mode[ 40 ];
+    uint64_t                t;
+    size_t                  i;
+    int                     n, loops;
+
+    err = http_split_test();
+    require_noerr( err, exit );
+    err = http_once_test();
+    require_noerr( err, exit );
+    err = http_error_test();
+    require_noerr( err, exit );
+    err = http_callback_test();
+    require_noerr( err, exit );
+    err = http_legacy_test();
+    require_noerr( err, exit );
+    if( !print ) goto exit;
+
+    // A 400 KB OTA image in 1460 byte reads, for chunks of each size
+
+    header = HTTPHeaderCreateWithCallback( http_bench_received, NULL, NULL );
+    require_action( header, exit, err = kNoMemoryErr );
+    loops = 20;
+    for( i = 0; i < sizeof( kChunks ) / sizeof( kChunks[ 0 ] ); ++i )
+    {
+        http_bench_message( "HTTP/1.1 200 OK", kHTTP_BenchBodyMax, 2 * kChunks[ i ], false );
+        t = 0;
+        for( n = 0; n < loops; ++n )
+        {
+            uint64_t        start;
+
+            http_bench_feed( 0, 1460, false );
+            http_bench_reset_callback();
+            SocketReadHTTPHeader( 0, header );
+            start = http_bench_ticks();
+            SocketReadHTTPBody( 0, header );
+            t += http_bench_ticks() - start;
+            HTTPHeaderClear( header );
+        }
+        snprintf( mode, sizeof( mode ), "chunked body, ~%u byte chunks", (unsigned int) kChunks[ i ] );
+        http_bench_report( mode, kHTTP_BenchBodyMax, t, (size_t) loops * kHTTP_BenchBodyMax );
+    }
+
+exit:
+    if( header ) free( header );
+    printf( "%s: %s\n", __FUNCTION__, !err ? "PASSED" : "FAILED" );
+    return( err );
+}
+
+int main( void )
+{
+    return( http_bench( 1 ) ? 1 : 0 );
+}
+
+#endif // HTTP_BENCH_MAIN
@@ -0,0 +1,458 @@
+/**
+******************************************************************************
+* @file    arena-bench.c
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   json_arena tests with the config server report, and the heap
+*          allocations and time it takes to build and print one.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+/* Built on the host only. Heap calls are counted through the glibc malloc, they are not counted with a sanitizer, which
+ * has its own. MICO/system/host holds the stub platform headers:
+ *
+ *   J=libraries/utilities/json_c
+ *   cc -O2 -DDEBUG=0 -DJSON_ARENA_BENCH_MAIN -IMICO/system/host -Iinclude -Ilibraries/utilities -I$J $J/arena-bench.c \
+ *      $J/arraylist.c $J/debug.c $J/json_arena.c $J/json_object.c $J/json_tokener.c $J/json_util.c $J/linkhash.c \
+ *      $J/printbuf.c libraries/utilities/StringUtils.c -o arena-bench && ./arena-bench
+ */
+
+#include "Common.h"
+#include "Debug.h"
+#include "json.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if( defined( JSON_ARENA_BENCH_MAIN ) )
+
+#include <time.h>
+
+#define kJSON_ArenaBenchSize        16384
+#define kJSON_ArenaBenchLoops       20000
+
+//===========================================================================================================================
+//  Heap calls
+//===========================================================================================================================
+
+static long         gJSON_ArenaBenchAllocs;     // malloc, calloc and realloc calls
+static long         gJSON_ArenaBenchLive;       // Blocks not freed
+static long         gJSON_ArenaBenchPeak;
+static int          gJSON_ArenaBenchCounting;
+
+#if( defined( __GLIBC__ ) && !defined( __SANITIZE_ADDRESS__ ) )
+    #define kJSON_ArenaBenchCounted     1
+
+    extern void *   __libc_malloc( size_t size );
+    extern void *   __libc_calloc( size_t count, size_t size );
+    extern void *   __libc_realloc( void *ptr, size_t size );
+    extern void     __libc_free( void *ptr );
+
+    static void json_arena_bench_count( void *inOld, size_t inSize )
+    {
+        if( !gJSON_ArenaBenchCounting ) return;
+        gJSON_ArenaBenchAllocs++;
+        if( !inOld && inSize ) gJSON_ArenaBenchLive++;
+        if( gJSON_ArenaBenchLive > gJSON_ArenaBenchPeak ) gJSON_ArenaBenchPeak = gJSON_ArenaBenchLive;
+    }
+
+    void * malloc( size_t size )
+    {
+        json_arena_bench_count( NULL, 1 );
+        return( __libc_malloc( size ) );
+    }
+
+    void * calloc( size_t count, size_t size )
+    {
+        json_arena_bench_count( NULL, 1 );
+        return( __libc_calloc( count, size ) );
+    }
+
+    void * realloc( void *ptr, size_t size )
+    {
+        json_arena_bench_count( ptr, 1 );
+        return( __libc_realloc( ptr, size ) );
+    }
+
+    void free( void *ptr )
+    {
+        if( gJSON_ArenaBenchCounting && ptr ) gJSON_ArenaBenchLive--;
+        __libc_free( ptr );
+    }
+#else
+    #define kJSON_ArenaBenchCounted     0
+#endif
+
+static void json_arena_bench_count_start( void )
+{
+    gJSON_ArenaBenchAllocs = 0;
+    gJSON_ArenaBenchLive = 0;
+    gJSON_ArenaBenchPeak = 0;
+    gJSON_ArenaBenchCounting = 1;
+}
+
+//===========================================================================================================================
+//  Report
+//===========================================================================================================================
+
+// The /config-read report, built as _LocalConfigCreateReport and the config_server_create_* cells do: containers and
+// cells are checked, values are not, a missing one is added as null and arena->failed tells.
+
+static OSStatus json_arena_bench_cell( json_object *inMenus, const char *inName, json_object *inContent, const char *inPrivilege )
+{
+    OSStatus                err = kNoErr;
+    struct json_arena *     arena = json_object_get_arena( inMenus );
+    json_object *           object;
+
+    object = json_object_new_object_in( arena );
+    require_action( object, exit, err = kNoMemoryErr; json_object_put( inContent ) );
+    json_object_object_add( object, "N", json_object_new_string_in( arena, inName ) );
+    json_object_object_add( object, "C", inContent );
+    json_object_object_add( object, "P", json_object_new_string_in( arena, inPrivilege ) );
+    json_object_array_add( inMenus, object );
+
+exit:
+    return( err );
+}
+
+static OSStatus json_arena_bench_sector( json_object *inSectors, const char *inName, json_object **outMenus )
+{
+    OSStatus                err = kNoErr;
+    struct json_arena *     arena = json_object_get_arena( inSectors );
+    json_object *           object;
+
+    *outMenus = json_object_new_array_in( arena );
+    require_action( *outMenus, exit, err = kNoMemoryErr );
+    object = json_object_new_object_in( arena );
+    require_action( object, exit, err = kNoMemoryErr; json_object_put( *outMenus ) );
+    json_object_object_add( object, "N", json_object_new_string_in( arena, inName ) );
+    json_object_object_add( object, "C", *outMenus );
+    json_object_array_add( inSectors, object );
+
+exit:
+    return( err );
+}
+
+static OSStatus json_arena_bench_report( struct json_arena *inArena, json_object **outReport )
+{
+    OSStatus        err;
+    json_object *   sectors;
+    json_object *   menus;
+
+    *outReport = json_object_new_object_in( inArena );
+    require_action( *outReport, exit, err = kNoMemoryErr );
+    sectors = json_object_new_array_in( inArena );
+    require_action( sectors, exit, err = kNoMemoryErr );
+    json_object_object_add( *outReport, "T", json_object_new_string_in( inArena, "Current Configuration" ) );
+    json_object_object_add( *outReport, "N", json_object_new_string_in( inArena, "MiCOKit-3288(A1B2C3)" ) );
+    json_object_object_add( *outReport, "C", sectors );
+    json_object_object_add( *outReport, "PO", json_object_new_string_in( inArena, "com.mxchip.micokit" ) );
+    json_object_object_add( *outReport, "HD", json_object_new_string_in( inArena, "3288" ) );
+    json_object_object_add( *outReport, "FW", json_object_new_string_in( inArena, "MiCOKit_3288@v2.2.0" ) );
+    json_object_object_add( *outReport, "RF", json_object_new_string_in( inArena, "31-03-0016" ) );
+
+    err = json_arena_bench_sector( sectors, "MICO SYSTEM", &menus );
+    require_noerr( err, exit );
+    err = json_arena_bench_cell( menus, "Device Name", json_object_new_string_in( inArena, "MiCOKit 3288" ), "RW" );
+    require_noerr( err, exit );
+    err = json_arena_bench_cell( menus, "RF power save", json_object_new_boolean_in( inArena, 0 ), "RW" );
+    require_noerr( err, exit );
+    err = json_arena_bench_cell( menus, "MCU power save", json_object_new_boolean_in( inArena, 0 ), "RW" );
+    require_noerr( err, exit );
+    err = json_arena_bench_cell( menus, "Wi-Fi", json_object_new_string_in( inArena, "MXCHIP-Office" ), "RW" );
+    require_noerr( err, exit );
+    err = json_arena_bench_cell( menus, "Password", json_object_new_string_in( inArena, "12345678" ), "RW" );
+    require_noerr( err, exit );
+    err = json_arena_bench_cell( menus, "DHCP", json_object_new_boolean_in( inArena, 1 ), "RW" );
+    require_noerr( err, exit );
+    err = json_arena_bench_cell( menus, "IP address", json_object_new_string_in( inArena, "192.168.1.105" ), "RW" );
+    require_noerr( err, exit );
+    err = json_arena_bench_cell( menus, "Net Mask", json_object_new_string_in( inArena, "255.255.255.0" ), "RW" );
+    require_noerr( err, exit );
+    err = json_arena_bench_cell( menus, "Gateway", json_object_new_string_in( inArena, "192.168.1.1" ), "RW" );
+    require_noerr( err, exit );
+    err = json_arena_bench_cell( menus, "DNS Server", json_object_new_string_in( inArena, "192.168.1.1" ), "RW" );
+    require_noerr( err, exit );
+
+    // An application sector as a FogCloud demo reports it
+
+    err = json_arena_bench_sector( sectors, "APPLICATION", &menus );
+    require_noerr( err, exit );
+    err = json_arena_bench_cell( menus, "Firmware", json_object_new_string_in( inArena, "v2.2.0" ), "RO" );
+    require_noerr( err, exit );
+    err = json_arena_bench_cell( menus, "Device ID", json_object_new_string_in( inArena, "5c4d1f6e-86c0-11e4-8b3d-f23c9150064b" ), "RO" );
+    require_noerr( err, exit );
+    err = json_arena_bench_cell( menus, "Product ID", json_object_new_string_in( inArena, "d64f517c" ), "RO" );
+    require_noerr( err, exit );
+    err = json_arena_bench_cell( menus, "Baurdrate", json_object_new_int_in( inArena, 115200 ), "RW" );
+    require_noerr( err, exit );
+    err = json_arena_bench_cell( menus, "Temperature", json_object_new_double_in( inArena, 24.5 ), "RO" );
+    require_noerr( err, exit );
+    err = json_arena_bench_cell( menus, "Activated", json_object_new_boolean_in( inArena, 1 ), "RO" );
+    require_noerr( err, exit );
+
+exit:
+    return( err );
+}
+
+static char         gJSON_ArenaBenchHeapJSON[ 4096 ];
+
+//===========================================================================================================================
+//  json_arena_output_test
+//===========================================================================================================================
+
+// The report in an arena prints the same as on the heap, with no heap call.
+
+static OSStatus json_arena_output_test( void )
+{
+    OSStatus            err;
+    struct json_arena   arena;
+    json_object *       report = NULL;
+    const char *        json;
+    void *              buf;
+
+    buf = malloc( kJSON_ArenaBenchSize );
+    require_action( buf, exit, err = kNoMemoryErr );
+
+    err = json_arena_bench_report( NULL, &report );
+    require_noerr( err, exit );
+    json = json_object_to_json_string( report );
+    require_action( json && strlen( json ) < sizeof( gJSON_ArenaBenchHeapJSON ), exit, err = kSizeErr );
+    strcpy( gJSON_ArenaBenchHeapJSON, json );
+    json_object_put( report );
+    report = NULL;
+
+    json_arena_init( &arena, buf, kJSON_ArenaBenchSize );
+    json_arena_bench_count_start();
+    err = json_arena_bench_report( &arena, &report );
+    json = json_object_to_json_string( report );
+    json_object_put( report );
+    gJSON_ArenaBenchCounting = 0;
+    report = NULL;
+    require_noerr( err, exit );
+    require_action( !arena.failed && json && strcmp( json, gJSON_ArenaBenchHeapJSON ) == 0, exit, err = kMismatchErr );
+    require_action( gJSON_ArenaBenchAllocs == 0, exit, err = kStateErr );
+
+    // Reset and built again at the same place
+
+    json_arena_reset( &arena );
+    err = json_arena_bench_report( &arena, &report );
+    require_noerr( err, exit );
+    json = json_object_to_json_string( report );
+    require_action( json && strcmp( json, gJSON_ArenaBenchHeapJSON ) == 0, exit, err = kMismatchErr );
+    require_action( (void *) report == (void *) arena.buf, exit, err = kMismatchErr );
+
+exit:
+    if( report ) json_object_put( report );
+    if( buf ) free( buf );
+    return( err );
+}
+
+//===========================================================================================================================
+//  json_arena_full_test
+//===========================================================================================================================
+
+// Every arena too small for the report: building stops or leaves nulls, arena->failed is set, nothing is written past
+// the block and the heap report still prints the same. An arena just large enough prints the same report.
+
+static OSStatus json_arena_full_test( void )
+{
+    OSStatus            err = kNoErr;
+    struct json_arena   arena;
+    json_object *       report;
+    const char *        json;
+    size_t              need, size;
+    char *              buf = NULL;
+
+    buf = malloc( kJSON_ArenaBenchSize );
+    require_action( buf, exit, err = kNoMemoryErr );
+    json_arena_init( &arena, buf, kJSON_ArenaBenchSize );
+    err = json_arena_bench_report( &arena, &report );
+    require_noerr( err, exit );
+    require_action( json_object_to_json_string( report ), exit, err = kNoMemoryErr );
+    need = arena.used;
+    free( buf );
+    buf = NULL;
+
+    for( size = 0; size <= need; size += ( size < 256 ) ? 1 : 8 )
+    {
+        // A block of exactly size bytes, aligned, so a sanitizer sees any write past it
+
+        buf = malloc( size ? size : 1 );
+        require_action( buf, exit, err = kNoMemoryErr );
+        json_arena_init( &arena, buf, size );
+        err = json_arena_bench_report( &arena, &report );
+        json = ( err == kNoErr ) ? json_object_to_json_string( report ) : NULL;
+        if( size < need )
+        {
+            require_action( arena.failed && arena.used <= size, exit, err = kStateErr );
+        }
+        else
+        {
+            require_action( !arena.failed && json && strcmp( json, gJSON_ArenaBenchHeapJSON ) == 0, exit, err = kMismatchErr );
+        }
+        if( report ) json_object_put( report );
+        free( buf );
+        buf = NULL;
+    }
+
+    err = json_arena_bench_report( NULL, &report );
+    require_noerr( err, exit );
+    json = json_object_to_json_string( report );
+    require_action( json && strcmp( json, gJSON_ArenaBenchHeapJSON ) == 0, exit, err = kMismatchErr );
+    json_object_put( report );
+
+exit:
+    if( buf ) free( buf );
+    return( err );
+}
+
+//===========================================================================================================================
+//  json_arena_mixed_test
+//===========================================================================================================================
+
+// Heap objects added to an arena tree, and replaced by key, are freed by json_object_put() on the tree.
+
+static OSStatus json_arena_mixed_test( void )
+{
+    OSStatus            err = kNoErr;
+    struct json_arena   arena;
+    json_object *       report = NULL;
+    json_object *       heap;
+    char *              buf;
+    int                 i;
+
+    buf = malloc( kJSON_ArenaBenchSize );
+    require_action( buf, exit, err = kNoMemoryErr );
+    json_arena_init( &arena, buf, kJSON_ArenaBenchSize );
+    err = json_arena_bench_report( &arena, &report );
+    require_noerr( err, exit );
+
+    json_arena_bench_count_start();
+    for( i = 0; i < 50; ++i )
+    {
+        heap = json_object_new_array();
+        require_action( heap, exit, err = kNoMemoryErr );
+        json_object_array_add( heap, json_object_new_string( "heap" ) );
+        json_object_object_add( report, ( i & 1 ) ? "X" : "Y", heap );
+        json_object_object_add( report, "T", json_object_new_int( i ) );
+    }
+    require_action( json_object_to_json_string( report ), exit, err = kNoMemoryErr );
+    require_action( !arena.failed, exit, err = kNoMemoryErr );
+    json_object_put( report );
+    report = NULL;
+    require_action( !kJSON_ArenaBenchCounted || gJSON_ArenaBenchLive == 0, exit,
+                    printf( "%ld heap blocks left\n", gJSON_ArenaBenchLive ); err = kStateErr );
+
+exit:
+    gJSON_ArenaBenchCounting = 0;
+    if( report ) json_object_put( report );
+    if( buf ) free( buf );
+    return( err );
+}
+
+//===========================================================================================================================
+//  json_arena_bench_report_time
+//===========================================================================================================================
+
+// Builds, prints and releases the report kJSON_ArenaBenchLoops times, the result in us per report.
+
+static double json_arena_bench_time( struct json_arena *inArena, void *inBuf )
+{
+    struct timespec     t1, t2;
+    json_object *       report;
+    int                 i;
+
+    clock_gettime( CLOCK_MONOTONIC, &t1 );
+    for( i = 0; i < kJSON_ArenaBenchLoops; ++i )
+    {
+        if( inArena ) json_arena_init( inArena, inBuf, kJSON_ArenaBenchSize );
+        json_arena_bench_report( inArena, &report );
+        json_object_to_json_string( report );
+        json_object_put( report );
+    }
+    clock_gettime( CLOCK_MONOTONIC, &t2 );
+    return( ( ( t2.tv_sec - t1.tv_sec ) * 1e9 + ( t2.tv_nsec - t1.tv_nsec ) ) / kJSON_ArenaBenchLoops / 1000.0 );
+}
+
+//===========================================================================================================================
+//  json_arena_bench
+//===========================================================================================================================
+
+OSStatus    json_arena_bench( int print )
+{
+    OSStatus                err;
+    struct json_arena       arena;
+    json_object *           report;
+    void *                  buf = NULL;
+    double                  us;
+
+    err = json_arena_output_test();
+    require_noerr( err, exit );
+    err = json_arena_full_test();
+    require_noerr( err, exit );
+    err = json_arena_mixed_test();
+    require_noerr( err, exit );
+    if( !print ) goto exit;
+
+    buf = malloc( kJSON_ArenaBenchSize );
+    require_action( buf, exit, err = kNoMemoryErr );
+    printf( "config report, %u bytes JSON\n", (unsigned int) strlen( gJSON_ArenaBenchHeapJSON ) );
+
+    json_arena_bench_count_start();
+    json_arena_bench_report( NULL, &report );
+    json_object_to_json_string( report );
+    json_object_put( report );
+    gJSON_ArenaBenchCounting = 0;
+    us = json_arena_bench_time( NULL, NULL );
+    if( kJSON_ArenaBenchCounted )
+        printf( "%-8s %5ld allocations, %5ld live at peak, %8.2f us\n", "heap", gJSON_ArenaBenchAllocs, gJSON_ArenaBenchPeak, us );
+    else
+        printf( "%-8s %8.2f us\n", "heap", us );
+
+    json_arena_init( &arena, buf, kJSON_ArenaBenchSize );
+    json_arena_bench_count_start();
+    json_arena_bench_report( &arena, &report );
+    json_object_to_json_string( report );
+    json_object_put( report );
+    gJSON_ArenaBenchCounting = 0;
+    us = json_arena_bench_time( &arena, buf );
+    if( kJSON_ArenaBenchCounted )
+        printf( "%-8s %5ld allocations, %5u bytes used,   %8.2f us\n", "arena", gJSON_ArenaBenchAllocs, (unsigned int) arena.used, us );
+    else
+        printf( "%-8s %5u bytes used, %8.2f us\n", "arena", (unsigned int) arena.used, us );
+
+exit:
+    if( buf ) free( buf );
+    printf( "%s: %s\n", __FUNCTION__, !err ? "PASSED" : "FAILED" );
+    return( err );
+}
+
+int main( void )
+{
+    return( json_arena_bench( 1 ) ? 1 : 0 );
+}
+
+#endif // JSON_ARENA_BENCH_MAIN
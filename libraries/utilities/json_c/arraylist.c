@@ -25,16 +25,23 @@
 
 struct array_list*
 array_list_new(array_list_free_fn *free_fn)
+{
+  return array_list_new_in(NULL, free_fn);
+}
+
+struct array_list*
+array_list_new_in(struct json_arena *arena, array_list_free_fn *free_fn)
 {
   struct array_list *arr;
 
-  arr = (struct array_list*)calloc(1, sizeof(struct array_list));
+  arr = (struct array_list*)json_arena_calloc(arena, sizeof(struct array_list));
   if(!arr) return NULL;
   arr->size = ARRAY_LIST_DEFAULT_SIZE;
   arr->length = 0;
   arr->free_fn = free_fn;
-  if(!(arr->array = (void**)calloc(sizeof(void*), arr->size))) {
-    free(arr);
+  arr->arena = arena;
+  if(!(arr->array = (void**)json_arena_calloc(arena, sizeof(void*) * arr->size))) {
+    json_arena_free(arena, arr);
     return NULL;
   }
   return arr;
@@ -46,8 +53,8 @@ array_list_free(struct array_list *arr)
   int i;
   for(i = 0; i < arr->length; i++)
     if(arr->array[i]) arr->free_fn(arr->array[i]);
-  free(arr->array);
-  free(arr);
+  json_arena_free(arr->arena, arr->array);
+  json_arena_free(arr->arena, arr);
 }
 
 void*
@@ -63,9 +70,12 @@ static int array_list_expand_internal(struct array_list *arr, int max)
   int new_size;
 
   if(max < arr->size) return 0;
-  //new_size = json_max(arr->size << 1, max);
-  new_size = json_max(arr->size + 1, max);
-  if(!(t = realloc(arr->array, new_size*sizeof(void*)))) return -1;
+  /* Grow by one on the heap to save RAM, an arena can not reuse the
+     old array so it doubles */
+  if(arr->arena) new_size = json_max(arr->size << 1, max + 1);
+  else new_size = json_max(arr->size + 1, max);
+  if(!(t = json_arena_realloc(arr->arena, arr->array, arr->size*sizeof(void*),
+			      new_size*sizeof(void*)))) return -1;
   arr->array = (void**)t;
   (void)memset(arr->array + arr->size, 0, (new_size-arr->size)*sizeof(void*));
   arr->size = new_size;
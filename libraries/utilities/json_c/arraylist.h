@@ -12,6 +12,8 @@
 #ifndef _arraylist_h_
 #define _arraylist_h_
 
+#include "json_arena.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -26,11 +28,16 @@ struct array_list
   int length;
   int size;
   array_list_free_fn *free_fn;
+  struct json_arena *arena;
 };
 
 extern struct array_list*
 array_list_new(array_list_free_fn *free_fn);
 
+/* An array_list allocated from arena, or from the heap if arena is NULL */
+extern struct array_list*
+array_list_new_in(struct json_arena *arena, array_list_free_fn *free_fn);
+
 extern void
 array_list_free(struct array_list *al);
 
@@ -18,11 +18,13 @@ extern "C" {
 
 #include "bits.h"
 #include "debug.h"
+#include "json_arena.h"
 #include "linkhash.h"
 #include "arraylist.h"
 #include "json_util.h"
 #include "json_object.h"
 #include "json_tokener.h"
+#include "json_sax.h"
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,92 @@
+/*
+ * $Id: json_arena.c,v 1.0 2026/10/17 mxchip Exp $
+ *
+ * Copyright (c) 2014 MXCHIP Inc.
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT license. See COPYING for details.
+ *
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "json_arena.h"
+
+#define JSON_ARENA_ROUND(x) (((x) + JSON_ARENA_ALIGN - 1) & ~(size_t)(JSON_ARENA_ALIGN - 1))
+
+void json_arena_init(struct json_arena *arena, void *buf, size_t size)
+{
+  size_t pad = JSON_ARENA_ROUND((size_t)buf) - (size_t)buf;
+
+  if(pad > size) pad = size;
+  arena->buf = (char*)buf + pad;
+  arena->size = size - pad;
+  json_arena_reset(arena);
+}
+
+void json_arena_reset(struct json_arena *arena)
+{
+  arena->used = 0;
+  arena->last = 0;
+  arena->failed = 0;
+}
+
+void* json_arena_calloc(struct json_arena *arena, size_t size)
+{
+  void *p;
+
+  if(!arena) return calloc(size, 1);
+
+  size = JSON_ARENA_ROUND(size);
+  if(size > arena->size - arena->used) {
+    arena->failed = 1;
+    return NULL;
+  }
+  p = arena->buf + arena->used;
+  memset(p, 0, size);
+  arena->last = arena->used;
+  arena->used += size;
+  return p;
+}
+
+void* json_arena_realloc(struct json_arena *arena, void *ptr,
+			 size_t old_size, size_t size)
+{
+  void *p;
+
+  if(!arena) return realloc(ptr, size);
+  if(!ptr) return json_arena_calloc(arena, size);
+
+  if((char*)ptr == arena->buf + arena->last) {
+    /* Last allocation, grow or shrink in place */
+    if(JSON_ARENA_ROUND(size) > arena->size - arena->last) {
+      arena->failed = 1;
+      return NULL;
+    }
+    arena->used = arena->last + JSON_ARENA_ROUND(size);
+    return ptr;
+  }
+
+  if(!(p = json_arena_calloc(arena, size))) return NULL;
+  memcpy(p, ptr, old_size < size ? old_size : size);
+  return p;
+}
+
+void json_arena_free(struct json_arena *arena, void *ptr)
+{
+  if(!arena) free(ptr);
+}
+
+char* json_arena_strdup(struct json_arena *arena, const char *s)
+{
+  size_t len = strlen(s) + 1;
+  char *p;
+
+  p = arena ? (char*)json_arena_calloc(arena, len) : (char*)malloc(len);
+  if(!p) return NULL;
+  memcpy(p, s, len);
+  return p;
+}
@@ -0,0 +1,81 @@
+/*
+ * $Id: json_arena.h,v 1.0 2026/10/17 mxchip Exp $
+ *
+ * Copyright (c) 2014 MXCHIP Inc.
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT license. See COPYING for details.
+ *
+ */
+
+#ifndef _json_arena_h_
+#define _json_arena_h_
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A json_arena hands out memory from one caller supplied block. Objects
+ * created by the json_object_new_*_in() functions, their keys, hash tables,
+ * arrays and the printbuf used by json_object_to_json_string() all come
+ * from the arena of the object they belong to, so building and printing a
+ * document makes no heap allocation.
+ *
+ * Nothing is freed one by one: json_object_put() on an arena object only
+ * releases the heap objects added to it. The whole document is released at
+ * once with json_arena_reset(), or by dropping the block.
+ *
+ * Every json_arena_* function takes a NULL arena to mean the heap.
+ */
+
+#define JSON_ARENA_ALIGN 8
+
+struct json_arena
+{
+  char *buf;
+  size_t size;
+  size_t used;
+  /* Offset of the last allocation, it can grow in place */
+  size_t last;
+  /* Set when an allocation did not fit, check it once the document is built */
+  int failed;
+};
+
+/**
+ * Use size bytes at buf as an arena
+ */
+extern void json_arena_init(struct json_arena *arena, void *buf, size_t size);
+
+/**
+ * Release everything allocated from the arena and clear the failed flag
+ */
+extern void json_arena_reset(struct json_arena *arena);
+
+/**
+ * Zeroed memory, or NULL and arena->failed is set if it does not fit
+ */
+extern void* json_arena_calloc(struct json_arena *arena, size_t size);
+
+/**
+ * Resize ptr, the last allocation grows in place. old_size is the size
+ * ptr was allocated with, the heap ignores it.
+ */
+extern void* json_arena_realloc(struct json_arena *arena, void *ptr,
+				size_t old_size, size_t size);
+
+/**
+ * Free ptr if it comes from the heap, arena memory is released by
+ * json_arena_reset()
+ */
+extern void json_arena_free(struct json_arena *arena, void *ptr);
+
+extern char* json_arena_strdup(struct json_arena *arena, const char *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
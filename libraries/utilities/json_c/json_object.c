@@ -37,7 +37,8 @@ const char *json_number_chars = "0123456789.+-eE";
 const char *json_hex_chars = "0123456789abcdef";
 
 static void json_object_generic_delete(struct json_object* jso);
-static struct json_object* json_object_new(enum json_type o_type);
+static struct json_object* json_object_new(struct json_arena *arena,
+					   enum json_type o_type);
 
 
 /* ref count debugging */
@@ -144,16 +145,18 @@ static void json_object_generic_delete(struct json_object* jso)
   lh_table_delete(json_object_table, jso);
 #endif /* REFCOUNT_DEBUG */
   printbuf_free(jso->_pb);
-  free(jso);
+  json_arena_free(jso->_arena, jso);
 }
 
-static struct json_object* json_object_new(enum json_type o_type)
+static struct json_object* json_object_new(struct json_arena *arena,
+					   enum json_type o_type)
 {
   struct json_object *jso;
 
-  jso = (struct json_object*)calloc(sizeof(struct json_object), 1);
+  jso = (struct json_object*)json_arena_calloc(arena, sizeof(struct json_object));
   if(!jso) return NULL;
   jso->o_type = o_type;
+  jso->_arena = arena;
   jso->_ref_count = 1;
   jso->_delete = &json_object_generic_delete;
 #ifdef REFCOUNT_DEBUG
@@ -176,13 +179,19 @@ enum json_type json_object_get_type(struct json_object *jso)
   return jso->o_type;
 }
 
+struct json_arena* json_object_get_arena(struct json_object *jso)
+{
+  if(!jso) return NULL;
+  return jso->_arena;
+}
+
 /* json_object_to_json_string */
 
 const char* json_object_to_json_string(struct json_object *jso)
 {
   if(!jso) return "null";
   if(!jso->_pb) {
-    if(!(jso->_pb = printbuf_new())) return NULL;
+    if(!(jso->_pb = printbuf_new_in(jso->_arena))) return NULL;
   } else {
     printbuf_reset(jso->_pb);
   }
@@ -195,7 +204,7 @@ struct printbuf * json_object_to_json_string_ex(struct json_object *jso)
   struct printbuf *_pb;
   if(!jso) return NULL;
 
-  if(!(_pb = printbuf_new())) return NULL;
+  if(!(_pb = printbuf_new_in(jso->_arena))) return NULL;
 
   if(jso->_to_json_string(jso, _pb) < 0) return NULL;
   return _pb;
@@ -232,6 +241,12 @@ static void json_object_lh_entry_free(struct lh_entry *ent)
   json_object_put((struct json_object*)ent->v);
 }
 
+/* Keys of an arena object are in the arena, the values can be heap objects */
+static void json_object_lh_arena_entry_free(struct lh_entry *ent)
+{
+  json_object_put((struct json_object*)ent->v);
+}
+
 static void json_object_object_delete(struct json_object* jso)
 {
   lh_table_free(jso->o.c_object);
@@ -240,12 +255,23 @@ static void json_object_object_delete(struct json_object* jso)
 
 struct json_object* json_object_new_object(void)
 {
-  struct json_object *jso = json_object_new(json_type_object);
+  return json_object_new_object_in(NULL);
+}
+
+struct json_object* json_object_new_object_in(struct json_arena *arena)
+{
+  struct json_object *jso = json_object_new(arena, json_type_object);
   if(!jso) return NULL;
   jso->_delete = &json_object_object_delete;
   jso->_to_json_string = &json_object_object_to_json_string;
-  jso->o.c_object = lh_kchar_table_new(JSON_OBJECT_DEF_HASH_ENTRIES,
-					NULL, &json_object_lh_entry_free);
+  jso->o.c_object = lh_kchar_table_new_in(arena,
+					  arena ? JSON_OBJECT_ARENA_HASH_ENTRIES : JSON_OBJECT_DEF_HASH_ENTRIES, NULL,
+					  arena ? &json_object_lh_arena_entry_free
+						: &json_object_lh_entry_free);
+  if(!jso->o.c_object) {
+    json_arena_free(arena, jso);
+    return NULL;
+  }
   return jso;
 }
 
@@ -263,8 +289,14 @@ struct lh_table* json_object_get_object(struct json_object *jso)
 void json_object_object_add(struct json_object* jso, const char *key,
 			    struct json_object *val)
 {
+  char *k;
+
   lh_table_delete(jso->o.c_object, key);
-  lh_table_insert(jso->o.c_object, strdup(key), val);
+  k = json_arena_strdup(jso->_arena, key);
+  if(!k || lh_table_insert(jso->o.c_object, k, val)) {
+    json_arena_free(jso->_arena, k);
+    json_object_put(val);
+  }
 }
 
 struct json_object* json_object_object_get(struct json_object* jso, const char *key)
@@ -290,7 +322,12 @@ static int json_object_boolean_to_json_string(struct json_object* jso,
 
 struct json_object* json_object_new_boolean(boolean b)
 {
-  struct json_object *jso = json_object_new(json_type_boolean);
+  return json_object_new_boolean_in(NULL, b);
+}
+
+struct json_object* json_object_new_boolean_in(struct json_arena *arena, boolean b)
+{
+  struct json_object *jso = json_object_new(arena, json_type_boolean);
   if(!jso) return NULL;
   jso->_to_json_string = &json_object_boolean_to_json_string;
   jso->o.c_boolean = b;
@@ -325,7 +362,12 @@ static int json_object_int_to_json_string(struct json_object* jso,
 
 struct json_object* json_object_new_int(int32_t i)
 {
-  struct json_object *jso = json_object_new(json_type_int);
+  return json_object_new_int_in(NULL, i);
+}
+
+struct json_object* json_object_new_int_in(struct json_arena *arena, int32_t i)
+{
+  struct json_object *jso = json_object_new(arena, json_type_int);
   if(!jso) return NULL;
   jso->_to_json_string = &json_object_int_to_json_string;
   jso->o.c_int64 = i;
@@ -370,7 +412,12 @@ int32_t json_object_get_int(struct json_object *jso)
 
 struct json_object* json_object_new_int64(int64_t i)
 {
-  struct json_object *jso = json_object_new(json_type_int);
+  return json_object_new_int64_in(NULL, i);
+}
+
+struct json_object* json_object_new_int64_in(struct json_arena *arena, int64_t i)
+{
+  struct json_object *jso = json_object_new(arena, json_type_int);
   if(!jso) return NULL;
   jso->_to_json_string = &json_object_int_to_json_string;
   jso->o.c_int64 = i;
@@ -407,7 +454,12 @@ static int json_object_double_to_json_string(struct json_object* jso,
 
 struct json_object* json_object_new_double(double d)
 {
-  struct json_object *jso = json_object_new(json_type_double);
+  return json_object_new_double_in(NULL, d);
+}
+
+struct json_object* json_object_new_double_in(struct json_arena *arena, double d)
+{
+  struct json_object *jso = json_object_new(arena, json_type_double);
   if(!jso) return NULL;
   jso->_to_json_string = &json_object_double_to_json_string;
   jso->o.c_double = d;
@@ -447,28 +499,46 @@ static int json_object_string_to_json_string(struct json_object* jso,
 
 static void json_object_string_delete(struct json_object* jso)
 {
-  free(jso->o.c_string.str);
+  json_arena_free(jso->_arena, jso->o.c_string.str);
   json_object_generic_delete(jso);
 }
 
 struct json_object* json_object_new_string(const char *s)
 {
-  struct json_object *jso = json_object_new(json_type_string);
+  return json_object_new_string_in(NULL, s);
+}
+
+struct json_object* json_object_new_string_in(struct json_arena *arena, const char *s)
+{
+  struct json_object *jso = json_object_new(arena, json_type_string);
   if(!jso) return NULL;
   jso->_delete = &json_object_string_delete;
   jso->_to_json_string = &json_object_string_to_json_string;
-  jso->o.c_string.str = strdup(s);
+  jso->o.c_string.str = json_arena_strdup(arena, s);
+  if(!jso->o.c_string.str) {
+    json_arena_free(arena, jso);
+    return NULL;
+  }
   jso->o.c_string.len = strlen(s);
   return jso;
 }
 
 struct json_object* json_object_new_string_len(const char *s, int len)
 {
-  struct json_object *jso = json_object_new(json_type_string);
+  return json_object_new_string_len_in(NULL, s, len);
+}
+
+struct json_object* json_object_new_string_len_in(struct json_arena *arena, const char *s, int len)
+{
+  struct json_object *jso = json_object_new(arena, json_type_string);
   if(!jso) return NULL;
   jso->_delete = &json_object_string_delete;
   jso->_to_json_string = &json_object_string_to_json_string;
-  jso->o.c_string.str = malloc(len);
+  jso->o.c_string.str = (char*)json_arena_calloc(arena, len + 1);
+  if(!jso->o.c_string.str) {
+    json_arena_free(arena, jso);
+    return NULL;
+  }
   memcpy(jso->o.c_string.str, (void *)s, len);
   jso->o.c_string.len = len;
   return jso;
@@ -528,11 +598,20 @@ static void json_object_array_delete(struct json_object* jso)
 
 struct json_object* json_object_new_array(void)
 {
-  struct json_object *jso = json_object_new(json_type_array);
+  return json_object_new_array_in(NULL);
+}
+
+struct json_object* json_object_new_array_in(struct json_arena *arena)
+{
+  struct json_object *jso = json_object_new(arena, json_type_array);
   if(!jso) return NULL;
   jso->_delete = &json_object_array_delete;
   jso->_to_json_string = &json_object_array_to_json_string;
-  jso->o.c_array = array_list_new(&json_object_array_entry_free);
+  jso->o.c_array = array_list_new_in(arena, &json_object_array_entry_free);
+  if(!jso->o.c_array) {
+    json_arena_free(arena, jso);
+    return NULL;
+  }
   return jso;
 }
 
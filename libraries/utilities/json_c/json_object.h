@@ -21,6 +21,8 @@ extern "C" {
 
 
 #define JSON_OBJECT_DEF_HASH_ENTRIES 1 //default is 16
+/* Tables in an arena can not be reused when they grow, start with room for a cell */
+#define JSON_OBJECT_ARENA_HASH_ENTRIES 4
 
 #undef FALSE
 #define FALSE ((boolean)0)
@@ -52,6 +54,7 @@ typedef struct array_list array_list;
 typedef struct json_object json_object;
 typedef struct json_object_iter json_object_iter;
 typedef struct json_tokener json_tokener;
+typedef struct json_arena json_arena;
 
 /* supported object types */
 
@@ -114,6 +117,12 @@ extern enum json_type json_object_get_type(struct json_object *obj);
  */
 extern const char* json_object_to_json_string(struct json_object *obj);
 
+/** Get the arena a json_object was created in
+ * @param obj the json_object instance
+ * @returns the arena, or NULL for a heap object
+ */
+extern struct json_arena* json_object_get_arena(struct json_object *obj);
+
 
 /* object type methods */
 
@@ -122,6 +131,17 @@ extern const char* json_object_to_json_string(struct json_object *obj);
  */
 extern struct json_object* json_object_new_object(void);
 
+/** Create a new empty object in an arena
+ *
+ * The keys added to it and the string returned by json_object_to_json_string
+ * are allocated from the same arena. The json_object_new_*_in functions
+ * return NULL and set arena->failed when the arena is full.
+ *
+ * @param arena the arena, or NULL for the heap
+ * @returns a json_object of type json_type_object
+ */
+extern struct json_object* json_object_new_object_in(struct json_arena *arena);
+
 /** Get the hashtable of a json_object of type json_type_object
  * @param obj the json_object instance
  * @returns a linkhash
@@ -190,6 +210,7 @@ extern void json_object_object_del(struct json_object* obj, const char *key);
  * @returns a json_object of type json_type_array
  */
 extern struct json_object* json_object_new_array(void);
+extern struct json_object* json_object_new_array_in(struct json_arena *arena);
 
 /** Get the arraylist of a json_object of type json_type_array
  * @param obj the json_object instance
@@ -248,6 +269,7 @@ extern struct json_object* json_object_array_get_idx(struct json_object *obj,
  * @returns a json_object of type json_type_boolean
  */
 extern struct json_object* json_object_new_boolean(boolean b);
+extern struct json_object* json_object_new_boolean_in(struct json_arena *arena, boolean b);
 
 /** Get the boolean value of a json_object
  *
@@ -272,6 +294,7 @@ extern boolean json_object_get_boolean(struct json_object *obj);
  * @returns a json_object of type json_type_int
  */
 extern struct json_object* json_object_new_int(int32_t i);
+extern struct json_object* json_object_new_int_in(struct json_arena *arena, int32_t i);
 
 
 /** Create a new empty json_object of type json_type_int
@@ -279,6 +302,7 @@ extern struct json_object* json_object_new_int(int32_t i);
  * @returns a json_object of type json_type_int
  */
 extern struct json_object* json_object_new_int64(int64_t i);
+extern struct json_object* json_object_new_int64_in(struct json_arena *arena, int64_t i);
 
 
 /** Get the int value of a json_object
@@ -315,6 +339,7 @@ extern int64_t json_object_get_int64(struct json_object *obj);
  * @returns a json_object of type json_type_double
  */
 extern struct json_object* json_object_new_double(double d);
+extern struct json_object* json_object_new_double_in(struct json_arena *arena, double d);
 
 /** Get the double value of a json_object
  *
@@ -341,6 +366,10 @@ extern struct json_object* json_object_new_string(const char *s);
 
 extern struct json_object* json_object_new_string_len(const char *s, int len);
 
+extern struct json_object* json_object_new_string_in(struct json_arena *arena, const char *s);
+extern struct json_object* json_object_new_string_len_in(struct json_arena *arena,
+							 const char *s, int len);
+
 /** Get the string value of a json_object
  *
  * If the passed object is not of type json_type_string then the JSON
@@ -0,0 +1,455 @@
+/*
+ * $Id: json_sax.c,v 1.0 2026/10/17 mxchip Exp $
+ *
+ * Copyright (c) 2014 MXCHIP Inc.
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT license. See COPYING for details.
+ *
+ */
+
+#include "config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bits.h"
+#include "json_inttypes.h"
+#include "json_object.h"
+#include "json_object_private.h"
+#include "json_tokener.h"
+#include "json_util.h"
+#include "json_sax.h"
+
+/* Longest number, the same limit as the stack buffer of sprintbuf */
+#define JSON_SAX_NUMBER_MAX 32
+
+#define IS_HIGH_SURROGATE(uc) (((uc) & 0xFC00) == 0xD800)
+#define IS_LOW_SURROGATE(uc)  (((uc) & 0xFC00) == 0xDC00)
+#define DECODE_SURROGATE_PAIR(hi,lo) ((((hi) & 0x3FF) << 10) + ((lo) & 0x3FF) + 0x10000)
+#define UCS_REPLACEMENT_CHAR  0xFFFD
+
+static const char* json_sax_skip_ws(const char *p, const char *end)
+{
+  while(p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r')) p++;
+  return p;
+}
+
+static int json_sax_hex4(const char *p, const char *end)
+{
+  int i, v = 0;
+
+  if(end - p < 4) return -1;
+  for(i = 0; i < 4; i++) {
+    v <<= 4;
+    if(p[i] >= '0' && p[i] <= '9') v |= p[i] - '0';
+    else if(p[i] >= 'a' && p[i] <= 'f') v |= p[i] - 'a' + 10;
+    else if(p[i] >= 'A' && p[i] <= 'F') v |= p[i] - 'A' + 10;
+    else return -1;
+  }
+  return v;
+}
+
+/* The path of a value is the keys of the open levels below the top, then its key */
+static int json_sax_match_key(const char **path, const char *key, int key_len)
+{
+  if(!key) return 1;  /* In an array */
+  if(**path == '\0') return 0;
+  if(strncmp(*path, key, key_len) != 0) return 0;
+  if((*path)[key_len] != '/' && (*path)[key_len] != '\0') return 0;
+  *path += key_len;
+  if(**path == '/') (*path)++;
+  return 1;
+}
+
+static int json_sax_path_match(struct json_sax *sax, const char *path,
+			       const char *key, int key_len)
+{
+  int i;
+
+  for(i = 1; i < sax->depth; i++)
+    if(!json_sax_match_key(&path, sax->stack[i].key, sax->stack[i].key_len)) return 0;
+  if(!json_sax_match_key(&path, key, key_len)) return 0;
+  return *path == '\0';
+}
+
+static int json_sax_emit(struct json_sax *sax, const char *key, int key_len,
+			 const struct json_sax_value *val)
+{
+  const struct json_sax_handler *h;
+
+  if(sax->handlers) {
+    for(h = sax->handlers; h->path; h++)
+      if(json_sax_path_match(sax, h->path, key, key_len))
+	return h->cb(sax, key, key_len, val);
+  }
+  if(sax->default_cb) return sax->default_cb(sax, key, key_len, val);
+  return JSON_SAX_CONTINUE;
+}
+
+/* Move *p past a string, *p is after the opening quote */
+static enum json_tokener_error json_sax_scan_string(const char **p, const char *end)
+{
+  const char *s = *p;
+
+  while(s < end && *s != '"') {
+    if(*s == '\\') {
+      if(++s == end) break;
+      if(*s == 'u') {
+	if(json_sax_hex4(s + 1, end) < 0) return json_tokener_error_parse_string;
+	s += 4;
+      }
+    }
+    s++;
+  }
+  if(s >= end) return json_tokener_error_parse_eof;
+  *p = s;
+  return json_tokener_success;
+}
+
+/* Move *p past the object or array starting at *p, its content is not checked */
+static enum json_tokener_error json_sax_skip(const char **p, const char *end)
+{
+  const char *s = *p;
+  int nest = 0;
+
+  while(s < end) {
+    if(*s == '"') {
+      s++;
+      if(json_sax_scan_string(&s, end) != json_tokener_success)
+	return json_tokener_error_parse_eof;
+    } else if(*s == '{' || *s == '[') {
+      nest++;
+    } else if(*s == '}' || *s == ']') {
+      if(--nest == 0) {
+	*p = s + 1;
+	return json_tokener_success;
+      }
+    }
+    s++;
+  }
+  return json_tokener_error_parse_eof;
+}
+
+static enum json_tokener_error json_sax_scalar(const char **p, const char *end,
+					       struct json_sax_value *val)
+{
+  const char *s = *p;
+  char buf[JSON_SAX_NUMBER_MAX];
+  int len, is_double = 0;
+  enum json_tokener_error err;
+
+  if(*s == '"') {
+    val->type = json_type_string;
+    val->str = ++s;
+    err = json_sax_scan_string(&s, end);
+    if(err != json_tokener_success) return err;
+    val->len = s - val->str;
+    *p = s + 1;
+    return json_tokener_success;
+  }
+
+  if(*s == 't' || *s == 'f') {
+    val->type = json_type_boolean;
+    val->c_boolean = (*s == 't');
+    len = val->c_boolean ? 4 : 5;
+    if(end - s < len || strncmp(s, val->c_boolean ? "true" : "false", len) != 0)
+      return json_tokener_error_parse_boolean;
+    val->len = len;
+    *p = s + len;
+    return json_tokener_success;
+  }
+
+  if(*s == 'n') {
+    val->type = json_type_null;
+    if(end - s < 4 || strncmp(s, "null", 4) != 0) return json_tokener_error_parse_null;
+    val->len = 4;
+    *p = s + 4;
+    return json_tokener_success;
+  }
+
+  if(*s == '-' || (*s >= '0' && *s <= '9')) {
+    while(s < end && *s && strchr(json_number_chars, *s)) {
+      if(*s == '.' || *s == 'e' || *s == 'E') is_double = 1;
+      s++;
+    }
+    len = s - *p;
+    if(len >= JSON_SAX_NUMBER_MAX) return json_tokener_error_parse_number;
+    memcpy(buf, *p, len);
+    buf[len] = '\0';
+    if(!is_double && json_parse_int64(buf, &val->c_int64) == 0) {
+      val->type = json_type_int;
+    } else if(is_double && sscanf(buf, "%lf", &val->c_double) == 1) {
+      val->type = json_type_double;
+    } else {
+      return json_tokener_error_parse_number;
+    }
+    val->len = len;
+    *p = s;
+    return json_tokener_success;
+  }
+
+  return json_tokener_error_parse_unexpected;
+}
+
+enum json_tokener_error json_sax_parse(struct json_sax *sax, const char *str, int len)
+{
+  const char *p = str, *end, *key = NULL;
+  int key_len = 0, ret;
+  struct json_sax_value val;
+  struct json_sax_level *level = NULL;
+  enum json_tokener_error err = json_tokener_success;
+
+  if(len < 0) len = strlen(str);
+  end = str + len;
+  sax->end = end;
+  sax->depth = 0;
+
+value:
+  p = json_sax_skip_ws(p, end);
+  if(p == end) { err = json_tokener_error_parse_eof; goto out; }
+  memset(&val, 0, sizeof(val));
+  val.str = p;
+  if(*p == '{' || *p == '[') {
+    val.type = (*p == '{') ? json_type_object : json_type_array;
+    val.len = 1;
+    ret = json_sax_emit(sax, key, key_len, &val);
+    if(ret == JSON_SAX_STOP) goto out;
+    if(ret == JSON_SAX_SKIP) {
+      err = json_sax_skip(&p, end);
+      if(err != json_tokener_success) goto out;
+      goto next;
+    }
+    if(sax->depth == JSON_SAX_MAX_DEPTH) { err = json_tokener_error_depth; goto out; }
+    level = &sax->stack[sax->depth++];
+    level->key = key;
+    level->key_len = key_len;
+    level->index = 0;
+    level->type = *p++;
+    p = json_sax_skip_ws(p, end);
+    if(p < end && *p == (level->type == '{' ? '}' : ']')) { p++; goto close; }
+    goto member;
+  }
+  err = json_sax_scalar(&p, end, &val);
+  if(err != json_tokener_success) goto out;
+  if(json_sax_emit(sax, key, key_len, &val) == JSON_SAX_STOP) goto out;
+
+next:
+  if(sax->depth == 0) goto out;
+  level = &sax->stack[sax->depth - 1];
+  level->index++;
+  p = json_sax_skip_ws(p, end);
+  if(p == end) { err = json_tokener_error_parse_eof; goto out; }
+  if(*p == (level->type == '{' ? '}' : ']')) { p++; goto close; }
+  if(*p != ',') {
+    err = (level->type == '{') ? json_tokener_error_parse_object_value_sep
+			       : json_tokener_error_parse_array;
+    goto out;
+  }
+  p++;
+
+member:
+  if(level->type == '[') {
+    key = NULL;
+    key_len = 0;
+    goto value;
+  }
+  p = json_sax_skip_ws(p, end);
+  if(p == end) { err = json_tokener_error_parse_eof; goto out; }
+  if(*p != '"') { err = json_tokener_error_parse_object_key_name; goto out; }
+  key = ++p;
+  err = json_sax_scan_string(&p, end);
+  if(err != json_tokener_success) goto out;
+  key_len = p - key;
+  p = json_sax_skip_ws(p + 1, end);
+  if(p == end || *p != ':') { err = json_tokener_error_parse_object_key_sep; goto out; }
+  p++;
+  goto value;
+
+close:
+  level = &sax->stack[--sax->depth];
+  memset(&val, 0, sizeof(val));
+  val.type = (level->type == '{') ? json_type_object : json_type_array;
+  val.end = 1;
+  val.str = p - 1;
+  val.len = 1;
+  if(json_sax_emit(sax, level->key, level->key_len, &val) == JSON_SAX_STOP) goto out;
+  goto next;
+
+out:
+  sax->char_offset = p - str;
+  return err;
+}
+
+static void json_sax_put(char *buf, int size, int *n, unsigned int c)
+{
+  if(*n < size) buf[*n] = (char)c;
+  (*n)++;
+}
+
+static void json_sax_put_utf8(char *buf, int size, int *n, unsigned int uc)
+{
+  if(uc < 0x80) {
+    json_sax_put(buf, size, n, uc);
+  } else if(uc < 0x800) {
+    json_sax_put(buf, size, n, 0xc0 | (uc >> 6));
+    json_sax_put(buf, size, n, 0x80 | (uc & 0x3f));
+  } else if(uc < 0x10000) {
+    json_sax_put(buf, size, n, 0xe0 | (uc >> 12));
+    json_sax_put(buf, size, n, 0x80 | ((uc >> 6) & 0x3f));
+    json_sax_put(buf, size, n, 0x80 | (uc & 0x3f));
+  } else {
+    json_sax_put(buf, size, n, 0xf0 | ((uc >> 18) & 0x07));
+    json_sax_put(buf, size, n, 0x80 | ((uc >> 12) & 0x3f));
+    json_sax_put(buf, size, n, 0x80 | ((uc >> 6) & 0x3f));
+    json_sax_put(buf, size, n, 0x80 | (uc & 0x3f));
+  }
+}
+
+int json_sax_copy_string(const struct json_sax_value *val, char *buf, int size)
+{
+  const char *s = val->str, *end = val->str + val->len;
+  int n = 0, lo;
+  unsigned int uc;
+
+  while(s < end) {
+    if(val->type != json_type_string || *s != '\\' || s + 1 == end) {
+      json_sax_put(buf, size, &n, (unsigned char)*s++);
+      continue;
+    }
+    s++;
+    switch(*s++) {
+    case 'b': json_sax_put(buf, size, &n, '\b'); break;
+    case 'f': json_sax_put(buf, size, &n, '\f'); break;
+    case 'n': json_sax_put(buf, size, &n, '\n'); break;
+    case 'r': json_sax_put(buf, size, &n, '\r'); break;
+    case 't': json_sax_put(buf, size, &n, '\t'); break;
+    case 'u':
+      /* Checked by the parser */
+      uc = json_sax_hex4(s, end);
+      s += 4;
+      if(IS_HIGH_SURROGATE(uc)) {
+	if(end - s >= 6 && s[0] == '\\' && s[1] == 'u' &&
+	   (lo = json_sax_hex4(s + 2, end)) >= 0 && IS_LOW_SURROGATE(lo)) {
+	  uc = DECODE_SURROGATE_PAIR(uc, lo);
+	  s += 6;
+	} else {
+	  uc = UCS_REPLACEMENT_CHAR;
+	}
+      } else if(IS_LOW_SURROGATE(uc)) {
+	uc = UCS_REPLACEMENT_CHAR;
+      }
+      json_sax_put_utf8(buf, size, &n, uc);
+      break;
+    default:
+      /* '"', '\\' and '/' */
+      json_sax_put(buf, size, &n, (unsigned char)s[-1]);
+      break;
+    }
+  }
+  if(n < size) memset(buf + n, 0, size - n);
+  return n;
+}
+
+int json_sax_copy_key(const char *key, int key_len, char *buf, int size)
+{
+  struct json_sax_value val;
+
+  memset(&val, 0, sizeof(val));
+  val.type = json_type_string;
+  val.str = key;
+  val.len = key_len;
+  return json_sax_copy_string(&val, buf, size);
+}
+
+boolean json_sax_get_boolean(const struct json_sax_value *val)
+{
+  switch(val->type) {
+  case json_type_boolean:
+    return val->c_boolean;
+  case json_type_int:
+    return (val->c_int64 != 0);
+  case json_type_double:
+    return (val->c_double != 0);
+  case json_type_string:
+    return (val->len != 0);
+  default:
+    return FALSE;
+  }
+}
+
+int32_t json_sax_get_int(const struct json_sax_value *val)
+{
+  char buf[JSON_SAX_NUMBER_MAX];
+  int64_t cint64 = val->c_int64;
+
+  switch(val->type) {
+  case json_type_string:
+    if(json_sax_copy_string(val, buf, sizeof(buf)) >= (int)sizeof(buf)) return 0;
+    if(json_parse_int64(buf, &cint64) != 0) return 0;
+    /* Fall through */
+  case json_type_int:
+    if(cint64 <= INT32_MIN) return INT32_MIN;
+    else if(cint64 >= INT32_MAX) return INT32_MAX;
+    else return (int32_t)cint64;
+  case json_type_double:
+    return (int32_t)val->c_double;
+  case json_type_boolean:
+    return val->c_boolean;
+  default:
+    return 0;
+  }
+}
+
+double json_sax_get_double(const struct json_sax_value *val)
+{
+  char buf[JSON_SAX_NUMBER_MAX];
+  double cdouble;
+
+  switch(val->type) {
+  case json_type_double:
+    return val->c_double;
+  case json_type_int:
+    return val->c_int64;
+  case json_type_boolean:
+    return val->c_boolean;
+  case json_type_string:
+    if(json_sax_copy_string(val, buf, sizeof(buf)) >= (int)sizeof(buf)) return 0.0;
+    if(sscanf(buf, "%lf", &cdouble) == 1) return cdouble;
+    /* Fall through */
+  default:
+    return 0.0;
+  }
+}
+
+struct json_object* json_sax_value_to_object(struct json_sax *sax,
+					     struct json_arena *arena,
+					     const struct json_sax_value *val)
+{
+  struct json_tokener *tok;
+  struct json_object *jso;
+
+  switch(val->type) {
+  case json_type_object:
+  case json_type_array:
+    if(val->end || !(tok = json_tokener_new())) return NULL;
+    jso = json_tokener_parse_ex(tok, val->str, sax->end - val->str);
+    json_tokener_free(tok);
+    return jso;
+  case json_type_boolean:
+    return json_object_new_boolean_in(arena, val->c_boolean);
+  case json_type_int:
+    return json_object_new_int64_in(arena, val->c_int64);
+  case json_type_double:
+    return json_object_new_double_in(arena, val->c_double);
+  case json_type_string:
+    /* The decoded string is never longer than the escaped one */
+    jso = json_object_new_string_len_in(arena, val->str, val->len);
+    if(!jso) return NULL;
+    jso->o.c_string.len = json_sax_copy_string(val, jso->o.c_string.str, val->len);
+    return jso;
+  default:
+    return NULL;
+  }
+}
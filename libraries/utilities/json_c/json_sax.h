@@ -0,0 +1,128 @@
+/*
+ * $Id: json_sax.h,v 1.0 2026/10/17 mxchip Exp $
+ *
+ * Copyright (c) 2014 MXCHIP Inc.
+ *
+ * This library is free software; you can redistribute it and/or modify
+ * it under the terms of the MIT license. See COPYING for details.
+ *
+ */
+
+#ifndef _json_sax_h_
+#define _json_sax_h_
+
+#include "json_object.h"
+#include "json_tokener.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * A callback parser: no json_object is created and nothing is allocated.
+ * Every value in the input is reported to a handler as it is read, with the
+ * keys leading to it. Strings and keys point into the input, escapes are
+ * decoded only when json_sax_copy_string() is called.
+ *
+ * Handlers are looked up by path, the keys from the top level object
+ * joined with '/', for example "services/type". Array elements have the
+ * path of their array. Values with no matching handler go to default_cb.
+ */
+
+#define JSON_SAX_MAX_DEPTH 8
+
+/* Handler return values */
+#define JSON_SAX_CONTINUE 0
+#define JSON_SAX_SKIP     1  /* On an object or array begin: skip its content */
+#define JSON_SAX_STOP     2  /* Stop parsing, json_sax_parse() returns success */
+
+struct json_sax_value
+{
+  /* json_type_object and json_type_array are reported twice, at begin and end */
+  enum json_type type;
+  int end;
+  /* The token in the input: a string without its quotes and escapes not
+     decoded, a number or literal as written, or the '{' or '[' of a begin */
+  const char *str;
+  int len;
+  boolean c_boolean;
+  int64_t c_int64;
+  double c_double;
+};
+
+struct json_sax;
+
+/**
+ * @param sax the parser, sax->ctx is the user context
+ * @param key the key of the value, NULL in an array or at the top level
+ * @param val the value
+ * @returns JSON_SAX_CONTINUE, JSON_SAX_SKIP or JSON_SAX_STOP
+ */
+typedef int (json_sax_cb)(struct json_sax *sax, const char *key, int key_len,
+			  const struct json_sax_value *val);
+
+struct json_sax_handler
+{
+  const char *path;
+  json_sax_cb *cb;
+};
+
+struct json_sax_level
+{
+  const char *key;  /* Key of the object or array in its parent */
+  int key_len;
+  int index;        /* Values read so far */
+  char type;        /* '{' or '[' */
+};
+
+struct json_sax
+{
+  const struct json_sax_handler *handlers;  /* Ends with a NULL path, can be NULL */
+  json_sax_cb *default_cb;                  /* Can be NULL */
+  void *ctx;
+
+  const char *end;  /* End of the input */
+  int char_offset;  /* Where parsing stopped */
+  int depth;        /* Open objects and arrays */
+  struct json_sax_level stack[JSON_SAX_MAX_DEPTH];
+};
+
+/**
+ * Parse one JSON value in str, len is -1 if str ends with a '\0'.
+ * @returns json_tokener_success or the error, sax->char_offset is where it was found
+ */
+extern enum json_tokener_error json_sax_parse(struct json_sax *sax,
+					      const char *str, int len);
+
+/**
+ * Copy a string value to buf like strncpy: decoded, padded with '\0' up to
+ * size, not terminated if it does not fit. Other values are copied as written.
+ * @returns the length of the decoded string, can be more than size
+ */
+extern int json_sax_copy_string(const struct json_sax_value *val, char *buf, int size);
+
+/* Copy a key given to a handler, the same as json_sax_copy_string */
+extern int json_sax_copy_key(const char *key, int key_len, char *buf, int size);
+
+/* Value conversions, the same as json_object_get_boolean, _int and _double */
+extern boolean json_sax_get_boolean(const struct json_sax_value *val);
+extern int32_t json_sax_get_int(const struct json_sax_value *val);
+extern double json_sax_get_double(const struct json_sax_value *val);
+
+/**
+ * A json_object for a value, for APIs that take a json_object. The begin of an
+ * object or array is parsed by json_tokener on the heap, the handler should
+ * return JSON_SAX_SKIP then.
+ * @param sax the parser given to the handler
+ * @param arena where to create a scalar, or NULL for the heap
+ * @returns NULL for null, or if out of memory
+ */
+extern struct json_object* json_sax_value_to_object(struct json_sax *sax,
+						    struct json_arena *arena,
+						    const struct json_sax_value *val);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -55,20 +55,28 @@ int lh_char_equal(const void *k1, const void *k2)
 	return (strcmp((const char*)k1, (const char*)k2) == 0);
 }
 
-struct lh_table* lh_table_new(int size, const char *name,
-			      lh_entry_free_fn *free_fn,
-			      lh_hash_fn *hash_fn,
-			      lh_equal_fn *equal_fn)
+static struct lh_table* lh_table_new_in(struct json_arena *arena,
+				       int size, const char *name,
+				       lh_entry_free_fn *free_fn,
+				       lh_hash_fn *hash_fn,
+				       lh_equal_fn *equal_fn)
 {
 	int i;
 	struct lh_table *t;
 
-	t = (struct lh_table*)calloc(1, sizeof(struct lh_table));
-	if(!t) lh_abort("lh_table_new: calloc failed 1, size = %d\n", sizeof(struct lh_table));
+	t = (struct lh_table*)json_arena_calloc(arena, sizeof(struct lh_table));
+	if(!t) {
+		if(arena) return NULL;
+		lh_abort("lh_table_new: calloc failed 1, size = %d\n", sizeof(struct lh_table));
+	}
 	t->count = 0;
 	t->size = size;
-	t->table = (struct lh_entry*)calloc(size, sizeof(struct lh_entry));
-	if(!t->table) lh_abort("lh_table_new: calloc failed 2, size = %d\n", sizeof(struct lh_table));
+	t->arena = arena;
+	t->table = (struct lh_entry*)json_arena_calloc(arena, size * sizeof(struct lh_entry));
+	if(!t->table) {
+		if(arena) return NULL;
+		lh_abort("lh_table_new: calloc failed 2, size = %d\n", sizeof(struct lh_table));
+	}
 	t->free_fn = free_fn;
 	t->hash_fn = hash_fn;
 	t->equal_fn = equal_fn;
@@ -76,35 +84,56 @@ struct lh_table* lh_table_new(int size, const char *name,
 	return t;
 }
 
+struct lh_table* lh_table_new(int size, const char *name,
+			      lh_entry_free_fn *free_fn,
+			      lh_hash_fn *hash_fn,
+			      lh_equal_fn *equal_fn)
+{
+	return lh_table_new_in(NULL, size, name, free_fn, hash_fn, equal_fn);
+}
+
 struct lh_table* lh_kchar_table_new(int size, const char *name,
 				    lh_entry_free_fn *free_fn)
 {
 	return lh_table_new(size, name, free_fn, lh_char_hash, lh_char_equal);
 }
 
+struct lh_table* lh_kchar_table_new_in(struct json_arena *arena,
+				       int size, const char *name,
+				       lh_entry_free_fn *free_fn)
+{
+	return lh_table_new_in(arena, size, name, free_fn, lh_char_hash, lh_char_equal);
+}
+
 struct lh_table* lh_kptr_table_new(int size, const char *name,
 				   lh_entry_free_fn *free_fn)
 {
 	return lh_table_new(size, name, free_fn, lh_ptr_hash, lh_ptr_equal);
 }
 
-void lh_table_resize(struct lh_table *t, int new_size)
+int lh_table_resize(struct lh_table *t, int new_size)
 {
-	struct lh_table *new_t;
-	struct lh_entry *ent;
-
-	new_t = lh_table_new(new_size, NULL, NULL, t->hash_fn, t->equal_fn);
-	ent = t->head;
+	int i;
+	struct lh_entry *old_table = t->table;
+	struct lh_entry *ent = t->head;
+
+	/* Insert the entries again into a new array, the links in the old
+	   array stay valid until it is freed */
+	t->table = (struct lh_entry*)json_arena_calloc(t->arena, new_size * sizeof(struct lh_entry));
+	if(!t->table) {
+		t->table = old_table;
+		return -1;
+	}
+	for(i = 0; i < new_size; i++) t->table[i].k = LH_EMPTY;
+	t->size = new_size;
+	t->count = 0;
+	t->head = t->tail = NULL;
 	while(ent) {
-		lh_table_insert(new_t, ent->k, ent->v);
+		lh_table_insert(t, ent->k, ent->v);
 		ent = ent->next;
 	}
-	free(t->table);
-	t->table = new_t->table;
-	t->size = new_size;
-	t->head = new_t->head;
-	t->tail = new_t->tail;
-	free(new_t);
+	json_arena_free(t->arena, old_table);
+	return 0;
 }
 
 void lh_table_free(struct lh_table *t)
@@ -115,17 +144,25 @@ void lh_table_free(struct lh_table *t)
 			t->free_fn(c);
 		}
 	}
-	free(t->table);
-	free(t);
+	json_arena_free(t->arena, t->table);
+	json_arena_free(t->arena, t);
 }
 
 
 int lh_table_insert(struct lh_table *t, void *k, const void *v)
 {
 	unsigned long h, n;
+	int new_size;
 
 	//if(t->count > t->size * 0.66) lh_table_resize(t, t->size * 2); 
-	if(t->count >= t->size) lh_table_resize(t, t->size + 1); 
+	if(t->count >= t->size) {
+		/* Grow by one on the heap to save RAM, an arena can not reuse
+		   the old table so it doubles. size is an unsigned char. */
+		if(t->size == UCHAR_MAX) return -1;
+		new_size = t->arena ? t->size * 2 : t->size + 1;
+		if(new_size > UCHAR_MAX) new_size = UCHAR_MAX;
+		if(lh_table_resize(t, new_size)) return -1;
+	}
 
 	h = t->hash_fn(k);
 	n = h % t->size;
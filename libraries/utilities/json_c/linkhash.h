@@ -12,6 +12,8 @@
 #ifndef _linkhash_h_
 #define _linkhash_h_
 
+#include "json_arena.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -100,6 +102,11 @@ struct lh_table {
 	lh_entry_free_fn *free_fn;
 	lh_hash_fn *hash_fn;
 	lh_equal_fn *equal_fn;
+
+	/**
+	 * Where the table is allocated, NULL for the heap.
+	 */
+	struct json_arena *arena;
 };
 
 
@@ -160,6 +167,15 @@ extern struct lh_table* lh_table_new(int size, const char *name,
 extern struct lh_table* lh_kchar_table_new(int size, const char *name,
 					   lh_entry_free_fn *free_fn);
 
+/**
+ * Same as lh_kchar_table_new, the table is allocated from arena.
+ * @param arena the arena, or NULL for the heap.
+ * @return the table, or NULL if it does not fit in the arena.
+ */
+extern struct lh_table* lh_kchar_table_new_in(struct json_arena *arena,
+					      int size, const char *name,
+					      lh_entry_free_fn *free_fn);
+
 
 /**
  * Convenience function to create a new linkhash
@@ -187,6 +203,7 @@ extern void lh_table_free(struct lh_table *t);
  * @param t the table to insert into.
  * @param k a pointer to the key to insert.
  * @param v a pointer to the value to insert.
+ * @return 0, or -1 if the table is full and can not grow.
  */
 extern int lh_table_insert(struct lh_table *t, void *k, const void *v);
 
@@ -233,7 +250,7 @@ extern int lh_table_delete(struct lh_table *t, const void *k);
 
 
 void lh_abort(const char *msg, ...);
-void lh_table_resize(struct lh_table *t, int new_size);
+int lh_table_resize(struct lh_table *t, int new_size);
 
 #ifdef __cplusplus
 }
@@ -30,15 +30,21 @@
 #include "printbuf.h"
 
 struct printbuf* printbuf_new(void)
+{
+  return printbuf_new_in(NULL);
+}
+
+struct printbuf* printbuf_new_in(struct json_arena *arena)
 {
   struct printbuf *p;
 
-  p = (struct printbuf*)calloc(1, sizeof(struct printbuf));
+  p = (struct printbuf*)json_arena_calloc(arena, sizeof(struct printbuf));
   if(!p) return NULL;
   p->size = 4;
   p->bpos = 0;
-  if(!(p->buf = (char*)malloc(p->size))) {
-    free(p);
+  p->arena = arena;
+  if(!(p->buf = (char*)json_arena_calloc(arena, p->size))) {
+    json_arena_free(arena, p);
     return NULL;
   }
   return p;
@@ -55,7 +61,7 @@ int printbuf_memappend(struct printbuf *p, const char *buf, int size)
 	     "bpos=%d wrsize=%d old_size=%d new_size=%d\n",
 	     p->bpos, size, p->size, new_size);
 #endif /* PRINTBUF_DEBUG */
-    if(!(t = (char*)realloc(p->buf, new_size))) return -1;
+    if(!(t = (char*)json_arena_realloc(p->arena, p->buf, p->size, new_size))) return -1;
     p->size = new_size;
     p->buf = t;
   }
@@ -143,8 +149,8 @@ void printbuf_reset(struct printbuf *p)
 void printbuf_free(struct printbuf *p)
 {
   if(p) {
-    free(p->buf);
-    free(p);
+    json_arena_free(p->arena, p->buf);
+    json_arena_free(p->arena, p);
   }
 }
 
@@ -0,0 +1,637 @@
+/**
+******************************************************************************
+* @file    sax-bench.c
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   json_sax tests against json_tokener, and the heap allocations and
+*          time to apply a /config-write body and a property write with each.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+/* Built on the host only. Heap calls are counted through the glibc malloc, they are not counted with a sanitizer, which
+ * has its own. MICO/system/host holds the stub platform headers:
+ *
+ *   J=libraries/utilities/json_c
+ *   cc -O2 -DDEBUG=0 -DJSON_SAX_BENCH_MAIN -IMICO/system/host -Iinclude -Ilibraries/utilities -I$J $J/sax-bench.c \
+ *      $J/arraylist.c $J/debug.c $J/json_arena.c $J/json_object.c $J/json_sax.c $J/json_tokener.c $J/json_util.c \
+ *      $J/linkhash.c $J/printbuf.c libraries/utilities/StringUtils.c -o sax-bench && ./sax-bench
+ */
+
+#include "Common.h"
+#include "Debug.h"
+#include "json.h"
+#include "json_sax.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if( defined( JSON_SAX_BENCH_MAIN ) )
+
+#include <time.h>
+
+#define kJSON_SaxBenchDocs          20000
+#define kJSON_SaxBenchLoops         200000
+
+//===========================================================================================================================
+//  Heap calls
+//===========================================================================================================================
+
+static long         gJSON_SaxBenchAllocs;       // malloc, calloc and realloc calls
+static long         gJSON_SaxBenchLive;         // Blocks not freed
+static long         gJSON_SaxBenchPeak;
+static int          gJSON_SaxBenchCounting;
+
+#if( defined( __GLIBC__ ) && !defined( __SANITIZE_ADDRESS__ ) )
+    #define kJSON_SaxBenchCounted       1
+
+    extern void *   __libc_malloc( size_t size );
+    extern void *   __libc_calloc( size_t count, size_t size );
+    extern void *   __libc_realloc( void *ptr, size_t size );
+    extern void     __libc_free( void *ptr );
+
+    static void json_sax_bench_count( void *inOld )
+    {
+        if( !gJSON_SaxBenchCounting ) return;
+        gJSON_SaxBenchAllocs++;
+        if( !inOld ) gJSON_SaxBenchLive++;
+        if( gJSON_SaxBenchLive > gJSON_SaxBenchPeak ) gJSON_SaxBenchPeak = gJSON_SaxBenchLive;
+    }
+
+    void * malloc( size_t size )
+    {
+        json_sax_bench_count( NULL );
+        return( __libc_malloc( size ) );
+    }
+
+    void * calloc( size_t count, size_t size )
+    {
+        json_sax_bench_count( NULL );
+        return( __libc_calloc( count, size ) );
+    }
+
+    void * realloc( void *ptr, size_t size )
+    {
+        json_sax_bench_count( ptr );
+        return( __libc_realloc( ptr, size ) );
+    }
+
+    void free( void *ptr )
+    {
+        if( gJSON_SaxBenchCounting && ptr ) gJSON_SaxBenchLive--;
+        __libc_free( ptr );
+    }
+#else
+    #define kJSON_SaxBenchCounted       0
+#endif
+
+static void json_sax_bench_count_start( void )
+{
+    gJSON_SaxBenchAllocs = 0;
+    gJSON_SaxBenchLive = 0;
+    gJSON_SaxBenchPeak = 0;
+    gJSON_SaxBenchCounting = 1;
+}
+
+//===========================================================================================================================
+//  json_sax_event_test
+//===========================================================================================================================
+
+// A tree rebuilt from the events of json_sax, to compare with the one json_tokener builds.
+
+typedef struct
+{
+    json_object *   stack[ JSON_SAX_MAX_DEPTH + 1 ];
+    int             top;
+    json_object *   root;
+
+}   json_sax_bench_tree_t;
+
+static void json_sax_bench_attach( json_sax_bench_tree_t *inTree, const char *inKey, int inKeyLen, json_object *inObj )
+{
+    json_object *       parent;
+    char                key[ 256 ];
+    int                 len;
+
+    if( inTree->top == 0 ) { inTree->root = inObj; return; }
+    parent = inTree->stack[ inTree->top - 1 ];
+    if( json_object_is_type( parent, json_type_array ) )
+    {
+        json_object_array_add( parent, inObj );
+        return;
+    }
+    len = json_sax_copy_key( inKey, inKeyLen, key, sizeof( key ) - 1 );
+    key[ Min( len, (int) sizeof( key ) - 1 ) ] = '\0';
+    json_object_object_add( parent, key, inObj );
+}
+
+static int json_sax_bench_tree_cb( struct json_sax *sax, const char *key, int key_len, const struct json_sax_value *val )
+{
+    json_sax_bench_tree_t *     tree = (json_sax_bench_tree_t *) sax->ctx;
+    json_object *               obj;
+
+    if( val->type == json_type_object || val->type == json_type_array )
+    {
+        if( val->end ) { tree->top--; return( JSON_SAX_CONTINUE ); }
+        obj = ( val->type == json_type_object ) ? json_object_new_object() : json_object_new_array();
+        json_sax_bench_attach( tree, key, key_len, obj );
+        tree->stack[ tree->top++ ] = obj;
+        return( JSON_SAX_CONTINUE );
+    }
+    json_sax_bench_attach( tree, key, key_len, json_sax_value_to_object( sax, NULL, val ) );
+    return( JSON_SAX_CONTINUE );
+}
+
+// Both parsers accept doc and print the same tree, or json_sax rejects it. inStrict: json_sax must reject it.
+
+static OSStatus json_sax_bench_compare( const char *inDoc, bool inStrict )
+{
+    OSStatus                    err = kNoErr;
+    json_sax_bench_tree_t       tree;
+    struct json_sax             sax;
+    enum json_tokener_error     saxErr;
+    json_object *               dom;
+    const char *                a;
+    const char *                b;
+
+    memset( &tree, 0, sizeof( tree ) );
+    memset( &sax, 0, sizeof( sax ) );
+    sax.default_cb = json_sax_bench_tree_cb;
+    sax.ctx = &tree;
+    saxErr = json_sax_parse( &sax, inDoc, -1 );
+    dom = json_tokener_parse( inDoc );
+
+    if( inStrict )
+    {
+        require_action( saxErr != json_tokener_success, exit, err = kMalformedErr );
+    }
+    else if( saxErr == json_tokener_success )
+    {
+        require_action( strspn( inDoc + sax.char_offset, " \t\r\n" ) == strlen( inDoc + sax.char_offset ), exit,
+                        err = kSizeErr );
+        a = dom ? json_object_to_json_string( dom ) : "null";
+        b = tree.root ? json_object_to_json_string( tree.root ) : "null";
+        require_action( strcmp( a, b ) == 0, exit, printf( "%s\n  json_tokener %s\n  json_sax     %s\n", inDoc, a, b );
+                        err = kMismatchErr );
+    }
+    else
+    {
+        // Rejected by json_sax only where it is stricter than json_tokener
+        require_action( !dom, exit, printf( "%s: json_sax error %d at %d\n", inDoc, saxErr, sax.char_offset );
+                        err = kMalformedErr );
+    }
+
+exit:
+    if( dom ) json_object_put( dom );
+    if( tree.root ) json_object_put( tree.root );
+    return( err );
+}
+
+static unsigned int     gJSON_SaxBenchSeed = 1;
+
+// A random document with every value type, escapes, surrogate pairs and white space, up to 7 levels deep
+
+static char * json_sax_bench_document( char *p, int inDepth )
+{
+    static const char * const   kStrings[] = { "abc", "a\\\"b", "\\u00e9t\\u00e9", "\\ud83d\\ude00", "x\\/y\\n\\t", "", "sp ace" };
+    int                         i, n;
+
+    switch( rand_r( &gJSON_SaxBenchSeed ) % ( ( inDepth > 5 ) ? 5 : 7 ) )
+    {
+        case 0: p += sprintf( p, "%d", (int)( rand_r( &gJSON_SaxBenchSeed ) % 2000 ) - 1000 ); break;
+        case 1: p += sprintf( p, "%d.%de%d", rand_r( &gJSON_SaxBenchSeed ) % 100, rand_r( &gJSON_SaxBenchSeed ) % 100,
+                              rand_r( &gJSON_SaxBenchSeed ) % 5 ); break;
+        case 2: p += sprintf( p, ( rand_r( &gJSON_SaxBenchSeed ) & 1 ) ? "true" : "false" ); break;
+        case 3: p += sprintf( p, "null" ); break;
+        case 4: p += sprintf( p, "\"%s\"", kStrings[ rand_r( &gJSON_SaxBenchSeed ) % 7 ] ); break;
+        case 5:
+            n = rand_r( &gJSON_SaxBenchSeed ) % 4;
+            *p++ = '[';
+            for( i = 0; i < n; ++i )
+            {
+                if( i ) *p++ = ',';
+                if( rand_r( &gJSON_SaxBenchSeed ) & 1 ) *p++ = ' ';
+                p = json_sax_bench_document( p, inDepth + 1 );
+            }
+            *p++ = ']';
+            break;
+        default:
+            n = rand_r( &gJSON_SaxBenchSeed ) % 4;
+            *p++ = '{';
+            for( i = 0; i < n; ++i )
+            {
+                if( i ) *p++ = ',';
+                p += sprintf( p, " \"k%d\" : ", i );
+                p = json_sax_bench_document( p, inDepth + 1 );
+            }
+            *p++ = '}';
+            break;
+    }
+    *p = '\0';
+    return( p );
+}
+
+static OSStatus json_sax_event_test( void )
+{
+    static const char * const   kDocs[] =
+    {
+        "{}", "[]", "1", "\"s\"", "null", "{\"a\":[1,2,{\"b\":null}],\"c\":-1.5e3}", " { \"x\" : true , \"y\":false } ",
+        "[[[[[[[[1]]]]]]]]", "{\"a\":\"\\u00e9\\\\\\/\"}", "[-0,0.5,1e2,-2e-2]", "{\"a\":tru}", "{\"a\":\"abc", "[1 2]",
+    };
+    static const char * const   kStrict[] =
+    {
+        "{\"a\":1,}", "[1,]", "[[[[[[[[[1]]]]]]]]]", "{\"n\":12345678901234567890123456789012345}", "{\"a\" 1}",
+    };
+    static char                 doc[ 1 << 16 ];
+    OSStatus                    err = kNoErr;
+    json_sax_bench_tree_t       tree;
+    struct json_sax             sax;
+    size_t                      i;
+
+    for( i = 0; i < sizeof( kDocs ) / sizeof( kDocs[ 0 ] ); ++i )
+    {
+        err = json_sax_bench_compare( kDocs[ i ], false );
+        require_noerr( err, exit );
+    }
+    for( i = 0; i < sizeof( kStrict ) / sizeof( kStrict[ 0 ] ); ++i )
+    {
+        err = json_sax_bench_compare( kStrict[ i ], true );
+        require_noerr( err, exit );
+    }
+
+    // One value is parsed, char_offset is where it ends
+
+    memset( &tree, 0, sizeof( tree ) );
+    memset( &sax, 0, sizeof( sax ) );
+    sax.default_cb = json_sax_bench_tree_cb;
+    sax.ctx = &tree;
+    require_action( json_sax_parse( &sax, "[1] x", -1 ) == json_tokener_success && sax.char_offset == 3, exit,
+                    err = kSizeErr );
+    require_action( tree.root && json_object_array_length( tree.root ) == 1, exit, err = kMismatchErr );
+    json_object_put( tree.root );
+
+    for( i = 0; i < kJSON_SaxBenchDocs; ++i )
+    {
+        json_sax_bench_document( doc, 0 );
+        err = json_sax_bench_compare( doc, false );
+        require_noerr( err, exit );
+    }
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  json_sax_handler_test
+//===========================================================================================================================
+
+static int      gJSON_SaxBenchHits[ 5 ];
+
+static int json_sax_bench_name( struct json_sax *sax, const char *key, int key_len, const struct json_sax_value *val )
+{
+    static const char   kPadded[ 16 ] = "Tom \"T\" ";
+    char                buf[ 16 ];
+
+    (void) sax; (void) key; (void) key_len;
+    // Exactly fills the buffer, not terminated, or padded with '\0' as strncpy does
+    memset( buf, 'x', sizeof( buf ) );
+    if( json_sax_copy_string( val, buf, 8 ) == 8 && memcmp( buf, "Tom \"T\" xxxxxxxx", 16 ) == 0 &&
+        json_sax_copy_string( val, buf, 16 ) == 8 && memcmp( buf, kPadded, 16 ) == 0 ) gJSON_SaxBenchHits[ 0 ]++;
+    return( JSON_SAX_CONTINUE );
+}
+
+static int json_sax_bench_deep( struct json_sax *sax, const char *key, int key_len, const struct json_sax_value *val )
+{
+    (void) key; (void) key_len;
+    gJSON_SaxBenchHits[ 1 ] += ( sax->depth == 3 && json_sax_get_int( val ) == 7 ) ? 1 : 100;
+    return( JSON_SAX_CONTINUE );
+}
+
+static int json_sax_bench_skip( struct json_sax *sax, const char *key, int key_len, const struct json_sax_value *val )
+{
+    (void) sax; (void) key; (void) key_len; (void) val;
+    gJSON_SaxBenchHits[ 2 ]++;
+    return( JSON_SAX_SKIP );
+}
+
+static int json_sax_bench_stop( struct json_sax *sax, const char *key, int key_len, const struct json_sax_value *val )
+{
+    (void) sax; (void) key; (void) key_len; (void) val;
+    gJSON_SaxBenchHits[ 3 ]++;
+    return( JSON_SAX_STOP );
+}
+
+static int json_sax_bench_other( struct json_sax *sax, const char *key, int key_len, const struct json_sax_value *val )
+{
+    (void) sax; (void) key; (void) key_len; (void) val;
+    gJSON_SaxBenchHits[ 4 ]++;
+    return( JSON_SAX_CONTINUE );
+}
+
+// Handlers by path: a value, a path three levels deep but not the same keys under "", an object skipped with a "}"
+// inside, then a stop. Values with no handler go to default_cb.
+
+static OSStatus json_sax_handler_test( void )
+{
+    static const struct json_sax_handler    kHandlers[] =
+    {
+        { "Name",   json_sax_bench_name },
+        { "a/b/c",  json_sax_bench_deep },
+        { "big",    json_sax_bench_skip },
+        { "end",    json_sax_bench_stop },
+        { NULL,     NULL },
+    };
+    static const char       kDoc[] = "{\"Name\":\"Tom \\\"T\\\" \",\"a\":{\"b\":{\"c\":7},\"c\":1},\"big\":{\"x\":[1,2,\"}\"]},"
+                                     "\"z\":[1,2],\"\":{\"a\":{\"b\":{\"c\":8}}},\"end\":0,\"after\":1}";
+    OSStatus                err = kNoErr;
+    struct json_sax         sax;
+
+    memset( &sax, 0, sizeof( sax ) );
+    sax.handlers = kHandlers;
+    sax.default_cb = json_sax_bench_other;
+    require_action( json_sax_parse( &sax, kDoc, -1 ) == json_tokener_success, exit, err = kMalformedErr );
+    require_action( gJSON_SaxBenchHits[ 0 ] == 1 && gJSON_SaxBenchHits[ 1 ] == 1 && gJSON_SaxBenchHits[ 2 ] == 1 &&
+                    gJSON_SaxBenchHits[ 3 ] == 1, exit, err = kMismatchErr );
+
+    // Root begin, a begin and end, a/b begin and end, a/c, z begin, 1, 2 and z end, then the 7 events of "". Nothing after
+    // the stop, not even the root end.
+    require_action( gJSON_SaxBenchHits[ 4 ] == 17, exit, printf( "default_cb %d\n", gJSON_SaxBenchHits[ 4 ] ); err = kMismatchErr );
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  Config write
+//===========================================================================================================================
+
+// A /config-write body applied as config_server.c did with json_tokener, and as it does now with handlers.
+
+static const char       kJSON_SaxBenchConfig[] =
+    "{\"Device Name\":\"MiCOKit-3288 Living room\",\"RF power save\":false,\"MCU power save\":true,"
+    "\"Wi-Fi\":\"MXCHIP_OFFICE\",\"Password\":\"12345678abc\",\"DHCP\":false,\"IP address\":\"192.168.1.100\","
+    "\"Net Mask\":\"255.255.255.0\",\"Gateway\":\"192.168.1.1\",\"DNS Server\":\"8.8.8.8\",\"Custom\":\"x\"}";
+
+typedef struct
+{
+    char        name[ 64 ];
+    char        ssid[ 33 ];
+    char        key[ 65 ];
+    char        ip[ 16 ];
+    char        mask[ 16 ];
+    char        gw[ 16 ];
+    char        dns[ 16 ];
+    int         rf, mcu, dhcp;
+    long        other;      // Keys for the application
+
+}   json_sax_bench_config_t;
+
+static json_sax_bench_config_t      gJSON_SaxBenchConfig;
+
+static void json_sax_bench_dom_config( void )
+{
+    json_sax_bench_config_t *   c = &gJSON_SaxBenchConfig;
+    json_object *               config;
+
+    config = json_tokener_parse( kJSON_SaxBenchConfig );
+    if( !config ) return;
+    json_object_object_foreach( config, key, val )
+    {
+        if(      !strcmp( key, "Device Name" ) )    strncpy( c->name, json_object_get_string( val ), sizeof( c->name ) );
+        else if( !strcmp( key, "RF power save" ) )  c->rf = json_object_get_boolean( val );
+        else if( !strcmp( key, "MCU power save" ) ) c->mcu = json_object_get_boolean( val );
+        else if( !strcmp( key, "Wi-Fi" ) )          strncpy( c->ssid, json_object_get_string( val ), sizeof( c->ssid ) - 1 );
+        else if( !strcmp( key, "Password" ) )       strncpy( c->key, json_object_get_string( val ), sizeof( c->key ) - 1 );
+        else if( !strcmp( key, "DHCP" ) )           c->dhcp = json_object_get_boolean( val );
+        else if( !strcmp( key, "IP address" ) )     strncpy( c->ip, json_object_get_string( val ), sizeof( c->ip ) );
+        else if( !strcmp( key, "Net Mask" ) )       strncpy( c->mask, json_object_get_string( val ), sizeof( c->mask ) );
+        else if( !strcmp( key, "Gateway" ) )        strncpy( c->gw, json_object_get_string( val ), sizeof( c->gw ) );
+        else if( !strcmp( key, "DNS Server" ) )     strncpy( c->dns, json_object_get_string( val ), sizeof( c->dns ) );
+        else                                        c->other += json_object_get_type( val );
+    }
+    json_object_put( config );
+}
+
+#define json_sax_bench_config_handler( NAME, STATEMENT )                                                                    \
+    static int NAME( struct json_sax *sax, const char *key, int key_len, const struct json_sax_value *val )                 \
+    {                                                                                                                       \
+        json_sax_bench_config_t *   c = &gJSON_SaxBenchConfig;                                                              \
+        (void) sax; (void) key; (void) key_len;                                                                             \
+        STATEMENT;                                                                                                          \
+        return( JSON_SAX_CONTINUE );                                                                                        \
+    }
+
+json_sax_bench_config_handler( json_sax_bench_name_cb,  json_sax_copy_string( val, c->name, sizeof( c->name ) ) )
+json_sax_bench_config_handler( json_sax_bench_rf_cb,    c->rf = json_sax_get_boolean( val ) )
+json_sax_bench_config_handler( json_sax_bench_mcu_cb,   c->mcu = json_sax_get_boolean( val ) )
+json_sax_bench_config_handler( json_sax_bench_ssid_cb,  json_sax_copy_string( val, c->ssid, sizeof( c->ssid ) - 1 ) )
+json_sax_bench_config_handler( json_sax_bench_key_cb,   json_sax_copy_string( val, c->key, sizeof( c->key ) - 1 ) )
+json_sax_bench_config_handler( json_sax_bench_dhcp_cb,  c->dhcp = json_sax_get_boolean( val ) )
+json_sax_bench_config_handler( json_sax_bench_ip_cb,    json_sax_copy_string( val, c->ip, sizeof( c->ip ) ) )
+json_sax_bench_config_handler( json_sax_bench_mask_cb,  json_sax_copy_string( val, c->mask, sizeof( c->mask ) ) )
+json_sax_bench_config_handler( json_sax_bench_gw_cb,    json_sax_copy_string( val, c->gw, sizeof( c->gw ) ) )
+json_sax_bench_config_handler( json_sax_bench_dns_cb,   json_sax_copy_string( val, c->dns, sizeof( c->dns ) ) )
+json_sax_bench_config_handler( json_sax_bench_other_cb, if( sax->depth == 1 ) c->other += val->type )
+
+static const struct json_sax_handler    kJSON_SaxBenchConfigHandlers[] =
+{
+    { "Device Name",    json_sax_bench_name_cb },
+    { "RF power save",  json_sax_bench_rf_cb },
+    { "MCU power save", json_sax_bench_mcu_cb },
+    { "Wi-Fi",          json_sax_bench_ssid_cb },
+    { "Password",       json_sax_bench_key_cb },
+    { "DHCP",           json_sax_bench_dhcp_cb },
+    { "IP address",     json_sax_bench_ip_cb },
+    { "Net Mask",       json_sax_bench_mask_cb },
+    { "Gateway",        json_sax_bench_gw_cb },
+    { "DNS Server",     json_sax_bench_dns_cb },
+    { NULL,             NULL },
+};
+
+static void json_sax_bench_sax_config( void )
+{
+    struct json_sax     sax;
+
+    memset( &sax, 0, sizeof( sax ) );
+    sax.handlers = kJSON_SaxBenchConfigHandlers;
+    sax.default_cb = json_sax_bench_other_cb;
+    json_sax_parse( &sax, kJSON_SaxBenchConfig, -1 );
+}
+
+//===========================================================================================================================
+//  Property write
+//===========================================================================================================================
+
+// A fogcloud /write message: every value goes to the property setter as a json_object, from the tree or made in a small
+// arena for each value.
+
+static const char       kJSON_SaxBenchProperties[] =
+    "{\"1\":1,\"3\":\"on\",\"5\":true,\"7\":25.5,\"9\":\"Hello from the cloud\",\"11\":100,\"13\":false,\"15\":-3}";
+
+static unsigned long    gJSON_SaxBenchPropertySum;
+
+static void json_sax_bench_set_property( int inIid, json_object *inValue )
+{
+    unsigned long   sum = (unsigned long) inIid;
+
+    switch( json_object_get_type( inValue ) )
+    {
+        case json_type_int:     sum += json_object_get_int( inValue ); break;
+        case json_type_double:  sum += (long)( json_object_get_double( inValue ) * 10 ); break;
+        case json_type_boolean: sum += json_object_get_boolean( inValue ); break;
+        case json_type_string:  sum += json_object_get_string_len( inValue ) + json_object_get_string( inValue )[ 0 ]; break;
+        default: break;
+    }
+    gJSON_SaxBenchPropertySum = gJSON_SaxBenchPropertySum * 31 + sum;
+}
+
+static void json_sax_bench_dom_properties( void )
+{
+    json_object *       properties;
+
+    properties = json_tokener_parse( kJSON_SaxBenchProperties );
+    if( !properties ) return;
+    json_object_object_foreach( properties, key, val ) json_sax_bench_set_property( atoi( key ), val );
+    json_object_put( properties );
+}
+
+static int json_sax_bench_property_cb( struct json_sax *sax, const char *key, int key_len, const struct json_sax_value *val )
+{
+    uint8_t             buf[ 256 ];
+    struct json_arena   arena;
+    json_object *       obj;
+
+    (void) key_len;
+    if( sax->depth == 0 ) return( JSON_SAX_CONTINUE );
+    if( sax->depth != 1 ) return( JSON_SAX_SKIP );
+    json_arena_init( &arena, buf, sizeof( buf ) );
+    obj = json_sax_value_to_object( sax, &arena, val );
+    if( obj ) json_sax_bench_set_property( atoi( key ), obj );
+    return( JSON_SAX_CONTINUE );
+}
+
+static void json_sax_bench_sax_properties( void )
+{
+    struct json_sax     sax;
+
+    memset( &sax, 0, sizeof( sax ) );
+    sax.default_cb = json_sax_bench_property_cb;
+    json_sax_parse( &sax, kJSON_SaxBenchProperties, -1 );
+}
+
+//===========================================================================================================================
+//  json_sax_apply_test
+//===========================================================================================================================
+
+// Both ways give the same configuration and properties, json_sax with no heap call.
+
+static OSStatus json_sax_apply_test( void )
+{
+    OSStatus                    err = kNoErr;
+    json_sax_bench_config_t     dom;
+    unsigned long               sum;
+
+    memset( &gJSON_SaxBenchConfig, 0, sizeof( gJSON_SaxBenchConfig ) );
+    json_sax_bench_dom_config();
+    dom = gJSON_SaxBenchConfig;
+    require_action( strcmp( dom.name, "MiCOKit-3288 Living room" ) == 0 && dom.mcu == 1 && dom.other != 0, exit,
+                    err = kMismatchErr );
+
+    memset( &gJSON_SaxBenchConfig, 0, sizeof( gJSON_SaxBenchConfig ) );
+    json_sax_bench_count_start();
+    json_sax_bench_sax_config();
+    gJSON_SaxBenchCounting = 0;
+    require_action( memcmp( &dom, &gJSON_SaxBenchConfig, sizeof( dom ) ) == 0, exit, err = kMismatchErr );
+    require_action( gJSON_SaxBenchAllocs == 0, exit, err = kStateErr );
+
+    gJSON_SaxBenchPropertySum = 0;
+    json_sax_bench_dom_properties();
+    sum = gJSON_SaxBenchPropertySum;
+    gJSON_SaxBenchPropertySum = 0;
+    json_sax_bench_count_start();
+    json_sax_bench_sax_properties();
+    gJSON_SaxBenchCounting = 0;
+    require_action( sum != 0 && sum == gJSON_SaxBenchPropertySum, exit, err = kMismatchErr );
+    require_action( gJSON_SaxBenchAllocs == 0, exit, err = kStateErr );
+
+exit:
+    gJSON_SaxBenchCounting = 0;
+    return( err );
+}
+
+//===========================================================================================================================
+//  json_sax_bench_run
+//===========================================================================================================================
+
+static void json_sax_bench_run( const char *inMode, void (*inFunction)( void ) )
+{
+    struct timespec     t1, t2;
+    long                i;
+
+    json_sax_bench_count_start();
+    inFunction();
+    gJSON_SaxBenchCounting = 0;
+
+    clock_gettime( CLOCK_MONOTONIC, &t1 );
+    for( i = 0; i < kJSON_SaxBenchLoops; ++i ) inFunction();
+    clock_gettime( CLOCK_MONOTONIC, &t2 );
+
+    if( kJSON_SaxBenchCounted ) printf( "%-28s %4ld allocations, %8.2f us\n", inMode, gJSON_SaxBenchAllocs,
+                                        ( ( t2.tv_sec - t1.tv_sec ) * 1e9 + ( t2.tv_nsec - t1.tv_nsec ) ) / kJSON_SaxBenchLoops / 1000.0 );
+    else                        printf( "%-28s %8.2f us\n", inMode,
+                                        ( ( t2.tv_sec - t1.tv_sec ) * 1e9 + ( t2.tv_nsec - t1.tv_nsec ) ) / kJSON_SaxBenchLoops / 1000.0 );
+}
+
+//===========================================================================================================================
+//  json_sax_bench
+//===========================================================================================================================
+
+OSStatus    json_sax_bench( int print )
+{
+    OSStatus        err;
+
+    err = json_sax_event_test();
+    require_noerr( err, exit );
+    err = json_sax_handler_test();
+    require_noerr( err, exit );
+    err = json_sax_apply_test();
+    require_noerr( err, exit );
+    if( !print ) goto exit;
+
+    json_sax_bench_run( "config-write, json_tokener", json_sax_bench_dom_config );
+    json_sax_bench_run( "config-write, json_sax", json_sax_bench_sax_config );
+    json_sax_bench_run( "property write, json_tokener", json_sax_bench_dom_properties );
+    json_sax_bench_run( "property write, json_sax", json_sax_bench_sax_properties );
+
+exit:
+    printf( "%s: %s\n", __FUNCTION__, !err ? "PASSED" : "FAILED" );
+    return( err );
+}
+
+int main( void )
+{
+    return( json_sax_bench( 1 ) ? 1 : 0 );
+}
+
+#endif // JSON_SAX_BENCH_MAIN
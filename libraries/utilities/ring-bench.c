@@ -0,0 +1,440 @@
+/**
+******************************************************************************
+* @file    ring-bench.c
+* @author  agent
+* @version V1.0.0
+* @date    17-Oct-2026
+* @brief   Ring buffer tests: the SPSC ring with a producer and a consumer
+*          thread, ring_buffer_t against its modulo version, and the cost of
+*          a byte through each.
+******************************************************************************
+*
+*  The MIT License
+*  Copyright (c) 2014 MXCHIP Inc.
+*
+*  Permission is hereby granted, free of charge, to any person obtaining a copy
+*  of this software and associated documentation files (the "Software"), to deal
+*  in the Software without restriction, including without limitation the rights
+*  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+*  copies of the Software, and to permit persons to whom the Software is furnished
+*  to do so, subject to the following conditions:
+*
+*  The above copyright notice and this permission notice shall be included in
+*  all copies or substantial portions of the Software.
+*
+*  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+*  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+*  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+*  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+*  WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR
+*  IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+******************************************************************************
+*/
+
+/* Built on the host only, the producer and the consumer are pthreads. MICO/system/host holds the stub platform
+ * headers:
+ *
+ *   cc -O2 -pthread -DDEBUG=0 -DRING_BENCH_MAIN -IMICO/system/host -Iinclude -Ilibraries/utilities \
+ *      libraries/utilities/ring-bench.c libraries/utilities/RingBufferUtils.c -o ring-bench && ./ring-bench
+ */
+
+#include "Common.h"
+#include "Debug.h"
+#include "RingBufferUtils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#if( defined( RING_BENCH_MAIN ) )
+
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+
+#if( defined( __i386__ ) || defined( __x86_64__ ) )
+    #include <x86intrin.h>
+    #define ring_bench_ticks()      ( (uint64_t) __rdtsc() )
+    #define kRing_BenchUnit         "cycles"
+#else
+    static uint64_t ring_bench_ticks( void )
+    {
+        struct timespec     ts;
+
+        clock_gettime( CLOCK_MONOTONIC, &ts );
+        return( ( (uint64_t) ts.tv_sec * 1000000000 ) + ts.tv_nsec );
+    }
+    #define kRing_BenchUnit         "ns"
+#endif
+
+#define kRing_BenchStressBytes      ( 16 * 1024 * 1024 )
+#define kRing_BenchStart            0xFFFFF000UL        // Indexes wrap past 2^32 early in a run
+
+// Byte n of the stream, a pattern that does not repeat within any ring size used here
+
+#define ring_bench_byte( N )        ( (uint8_t)( (uint8_t)( N ) * 7 + ( (N) >> 8 ) + ( (N) >> 16 ) ) )
+
+static uint8_t      gRing_BenchMem[ 4096 ];
+
+//===========================================================================================================================
+//  ring_init_test
+//===========================================================================================================================
+
+static OSStatus ring_init_test( void )
+{
+    OSStatus                err = kNoErr;
+    ring_buffer_spsc_t      ring;
+
+    require_action( ring_buffer_spsc_init( &ring, gRing_BenchMem, 3000 ) == kParamErr, exit, err = kResponseErr );
+    require_action( ring_buffer_spsc_init( &ring, gRing_BenchMem, 0 ) == kParamErr, exit, err = kResponseErr );
+    require_action( ring_buffer_spsc_init( &ring, NULL, 16 ) == kParamErr, exit, err = kResponseErr );
+    err = ring_buffer_spsc_init( &ring, gRing_BenchMem, 1 );
+    require_noerr( err, exit );
+    err = ring_buffer_spsc_init( &ring, gRing_BenchMem, sizeof( gRing_BenchMem ) );
+    require_noerr( err, exit );
+    require_action( ring_buffer_spsc_free_space( &ring ) == sizeof( gRing_BenchMem ), exit, err = kSizeErr );
+    require_action( ring_buffer_spsc_used_space( &ring ) == 0, exit, err = kSizeErr );
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  ring_region_test
+//===========================================================================================================================
+
+// One thread, every fill level and start offset of a 16 byte ring: the regions returned by reserve and peek cover
+// exactly the free and used space, the second one only when it wraps.
+
+static OSStatus ring_region_test( void )
+{
+    OSStatus                err = kNoErr;
+    ring_buffer_spsc_t      ring;
+    ring_buffer_region_t    regions[ 2 ];
+    uint8_t                 buf[ 16 ];
+    uint32_t                start, fill, n, i;
+
+    for( start = 0; start < 32; ++start )
+    {
+        for( fill = 0; fill <= 16; ++fill )
+        {
+            ring_buffer_spsc_init( &ring, gRing_BenchMem, 16 );
+            ring.head = ring.tail = (uint32_t)( kRing_BenchStart + 0xFF0 + start );
+            memset( buf, 0, sizeof( buf ) );
+
+            n = ring_buffer_spsc_reserve( &ring, regions );
+            require_action( n == 16 && regions[ 0 ].length + regions[ 1 ].length == 16, exit, err = kSizeErr );
+            require_action( regions[ 0 ].data == &gRing_BenchMem[ ring.tail & 15 ], exit, err = kMismatchErr );
+            for( i = 0; i < fill; ++i )
+            {
+                *( ( i < regions[ 0 ].length ) ? &regions[ 0 ].data[ i ] : &regions[ 1 ].data[ i - regions[ 0 ].length ] ) =
+                    ring_bench_byte( i );
+            }
+            ring_buffer_spsc_commit( &ring, fill );
+            require_action( ring_buffer_spsc_used_space( &ring ) == fill, exit, err = kSizeErr );
+            require_action( ring_buffer_spsc_free_space( &ring ) == 16 - fill, exit, err = kSizeErr );
+
+            n = ring_buffer_spsc_reserve( &ring, regions );
+            require_action( n == 16 - fill && regions[ 0 ].length + regions[ 1 ].length == n, exit, err = kSizeErr );
+            require_action( regions[ 1 ].length == 0 || regions[ 1 ].data == gRing_BenchMem, exit, err = kMismatchErr );
+            require_action( ring_buffer_spsc_write( &ring, buf, sizeof( buf ) ) == 16 - fill, exit, err = kSizeErr );
+            ring_buffer_spsc_consume( &ring, 0 );
+
+            n = ring_buffer_spsc_peek( &ring, regions );
+            require_action( n == 16 && regions[ 0 ].length + regions[ 1 ].length == 16, exit, err = kSizeErr );
+            for( i = 0; i < fill; ++i )
+            {
+                require_action( ( ( i < regions[ 0 ].length ) ? regions[ 0 ].data[ i ] : regions[ 1 ].data[ i - regions[ 0 ].length ] )
+                                == ring_bench_byte( i ), exit, err = kMismatchErr );
+            }
+            require_action( ring_buffer_spsc_read( &ring, buf, fill ) == fill, exit, err = kSizeErr );
+            for( i = 0; i < fill; ++i ) require_action( buf[ i ] == ring_bench_byte( i ), exit, err = kMismatchErr );
+            ring_buffer_spsc_consume( &ring, 16 - fill );
+            require_action( ring_buffer_spsc_used_space( &ring ) == 0, exit, err = kSizeErr );
+            require_action( ring_buffer_spsc_read( &ring, buf, sizeof( buf ) ) == 0, exit, err = kSizeErr );
+        }
+    }
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  ring_stress_test
+//===========================================================================================================================
+
+typedef struct
+{
+    ring_buffer_spsc_t      ring;
+    uint32_t                total;
+    uint32_t                maxChunk;
+    volatile int            failed;         // Set by either thread, the other one stops
+    uint32_t                badAt;
+    uint32_t                stalls;         // Consumer found nothing to read
+
+}   ring_bench_stress_t;
+
+// The producer fills part of the reserved space in place, as a DMA transfer would.
+
+static void * ring_bench_producer( void *inArg )
+{
+    ring_bench_stress_t *       ctx = (ring_bench_stress_t *) inArg;
+    ring_buffer_region_t        regions[ 2 ];
+    unsigned int                seed = 5;
+    uint32_t                    seq = 0, n, i;
+
+    while( seq < ctx->total && !ctx->failed )
+    {
+        n = ring_buffer_spsc_reserve( &ctx->ring, regions );
+        if( n == 0 ) { sched_yield(); continue; }
+        n = Min( n, ctx->total - seq );
+        n = 1 + rand_r( &seed ) % Min( n, ctx->maxChunk );
+        for( i = 0; i < n; ++i )
+        {
+            *( ( i < regions[ 0 ].length ) ? &regions[ 0 ].data[ i ] : &regions[ 1 ].data[ i - regions[ 0 ].length ] ) =
+                ring_bench_byte( seq + i );
+        }
+        ring_buffer_spsc_commit( &ctx->ring, n );
+        seq += n;
+    }
+    return( NULL );
+}
+
+// The consumer takes the data in place or copies it out, in turns.
+
+static void * ring_bench_consumer( void *inArg )
+{
+    ring_bench_stress_t *       ctx = (ring_bench_stress_t *) inArg;
+    ring_buffer_region_t        regions[ 2 ];
+    uint8_t                     buf[ 700 ];
+    unsigned int                seed = 1;
+    uint32_t                    seq = 0, n, i;
+    uint8_t                     c;
+
+    while( seq < ctx->total && !ctx->failed )
+    {
+        if( seq & 1 )
+        {
+            n = ring_buffer_spsc_read( &ctx->ring, buf, 1 + rand_r( &seed ) % sizeof( buf ) );
+            for( i = 0; i < n; ++i )
+            {
+                if( buf[ i ] != ring_bench_byte( seq + i ) ) goto failed;
+            }
+        }
+        else
+        {
+            n = ring_buffer_spsc_peek( &ctx->ring, regions );
+            n = Min( n, ctx->total - seq );
+            for( i = 0; i < n; ++i )
+            {
+                c = ( i < regions[ 0 ].length ) ? regions[ 0 ].data[ i ] : regions[ 1 ].data[ i - regions[ 0 ].length ];
+                if( c != ring_bench_byte( seq + i ) ) goto failed;
+            }
+            ring_buffer_spsc_consume( &ctx->ring, n );
+        }
+        if( n == 0 ) { ctx->stalls++; sched_yield(); }
+        seq += n;
+    }
+    return( NULL );
+
+failed:
+    ctx->badAt = seq + i;
+    ctx->failed = 1;
+    return( NULL );
+}
+
+static OSStatus ring_bench_stress( uint32_t inSize, uint32_t inMaxChunk, uint32_t inTotal, double *outSeconds )
+{
+    OSStatus                    err;
+    ring_bench_stress_t         ctx;
+    pthread_t                   producer, consumer;
+    struct timespec             t1, t2;
+
+    memset( &ctx, 0, sizeof( ctx ) );
+    err = ring_buffer_spsc_init( &ctx.ring, gRing_BenchMem, inSize );
+    require_noerr( err, exit );
+    ctx.ring.head = ctx.ring.tail = kRing_BenchStart;
+    ctx.total = inTotal;
+    ctx.maxChunk = inMaxChunk;
+
+    clock_gettime( CLOCK_MONOTONIC, &t1 );
+    require_action( pthread_create( &producer, NULL, ring_bench_producer, &ctx ) == 0, exit, err = kUnknownErr );
+    if( pthread_create( &consumer, NULL, ring_bench_consumer, &ctx ) != 0 )
+    {
+        ctx.failed = 1;
+        pthread_join( producer, NULL );
+        err = kUnknownErr;
+        goto exit;
+    }
+    pthread_join( producer, NULL );
+    pthread_join( consumer, NULL );
+    clock_gettime( CLOCK_MONOTONIC, &t2 );
+    if( outSeconds ) *outSeconds = ( t2.tv_sec - t1.tv_sec ) + ( t2.tv_nsec - t1.tv_nsec ) / 1e9;
+
+    require_action( !ctx.failed, exit, printf( "ring %u: byte %u is wrong\n", (unsigned int) inSize, (unsigned int) ctx.badAt );
+                    err = kMismatchErr );
+    require_action( ring_buffer_spsc_used_space( &ctx.ring ) == 0, exit, err = kSizeErr );
+    require_action( ctx.ring.tail == (uint32_t)( kRing_BenchStart + inTotal ), exit, err = kSizeErr );
+
+exit:
+    return( err );
+}
+
+// Every byte arrives once and in order, with rings from one byte to full size and chunks up to the ring size.
+
+static OSStatus ring_stress_test( void )
+{
+    static const uint32_t   kSizes[] = { 1, 16, 256, 4096 };
+    OSStatus                err = kNoErr;
+    size_t                  i;
+
+    for( i = 0; i < sizeof( kSizes ) / sizeof( kSizes[ 0 ] ); ++i )
+    {
+        err = ring_bench_stress( kSizes[ i ], kSizes[ i ], ( kSizes[ i ] < 256 ) ? 1024 * 1024 : kRing_BenchStressBytes, NULL );
+        require_noerr( err, exit );
+    }
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  ring_legacy_test
+//===========================================================================================================================
+
+// ring_buffer_t as it was with %, the compare-and-subtract version must give the same indexes and results.
+
+static uint32_t ring_bench_modulo_write( ring_buffer_t *ring, const uint8_t *data, uint32_t data_length )
+{
+    uint32_t tail_to_end = ring->size - ring->tail;
+    uint32_t amount_to_copy = MIN( data_length, ( ring->tail == ring->head ) ? ring->size : ( tail_to_end + ring->head ) % ring->size );
+
+    memcpy( &ring->buffer[ ring->tail ], data, MIN( amount_to_copy, tail_to_end ) );
+    if( tail_to_end < amount_to_copy ) memcpy( ring->buffer, data + tail_to_end, amount_to_copy - tail_to_end );
+    ring->tail = ( ring->tail + amount_to_copy ) % ring->size;
+    return( amount_to_copy );
+}
+
+static OSStatus ring_legacy_test( void )
+{
+    OSStatus            err = kNoErr;
+    ring_buffer_t       ring, model;
+    uint8_t             mem[ 2 ][ 37 ], data[ 40 ], *ptr;
+    uint32_t            size, n, m, contiguous, i;
+    unsigned int        seed = 3;
+
+    memset( mem, 0, sizeof( mem ) );
+    for( i = 0; i < sizeof( data ); ++i ) data[ i ] = (uint8_t) i;
+    for( size = 1; size <= sizeof( mem[ 0 ] ); ++size )
+    {
+        ring_buffer_init( &ring, mem[ 0 ], size );
+        ring_buffer_init( &model, mem[ 1 ], size );
+        for( i = 0; i < 2000; ++i )
+        {
+            n = rand_r( &seed ) % ( size + 3 );
+            if( rand_r( &seed ) & 1 )
+            {
+                m = ring_bench_modulo_write( &model, data, n );
+                require_action( ring_buffer_write( &ring, data, n ) == m, exit, err = kSizeErr );
+            }
+            else
+            {
+                n = Min( n, ( size - model.head + model.tail ) % size );
+                model.head = ( model.head + n ) % size;
+                ring_buffer_consume( &ring, n );
+            }
+            require_action( ring.head == model.head && ring.tail == model.tail, exit, err = kMismatchErr );
+            require_action( memcmp( mem[ 0 ], mem[ 1 ], size ) == 0, exit, err = kMismatchErr );
+            require_action( ring_buffer_used_space( &ring ) == ( size - model.head + model.tail ) % size, exit, err = kSizeErr );
+            require_action( ring_buffer_free_space( &ring ) == ( size - model.tail + model.head ) % size, exit, err = kSizeErr );
+            ring_buffer_get_data( &ring, &ptr, &contiguous );
+            require_action( ptr == &mem[ 0 ][ model.head ], exit, err = kMismatchErr );
+            require_action( contiguous == MIN( size - model.head, ( size - model.head + model.tail ) % size ), exit,
+                            err = kSizeErr );
+        }
+    }
+
+exit:
+    return( err );
+}
+
+//===========================================================================================================================
+//  ring_bench_report
+//===========================================================================================================================
+
+static void ring_bench_report( const char *inMode, size_t inLen, uint64_t inTicks, size_t inCount )
+{
+    printf( "%-32s %5u bytes: %10.2f %s/byte\n", inMode, (unsigned int) inLen, (double) inTicks / (double) inCount,
+            kRing_BenchUnit );
+}
+
+//===========================================================================================================================
+//  ring_bench
+//===========================================================================================================================
+
+OSStatus    ring_bench( int print )
+{
+    static const uint32_t   kLengths[] = { 1, 16, 64, 512 };
+    OSStatus                err;
+    ring_buffer_t           ring;
+    ring_buffer_spsc_t      spsc;
+    uint8_t                 buf[ 512 ], *ptr;
+    uint32_t                contiguous;
+    double                  seconds;
+    uint64_t                t;
+    size_t                  i, n, loops;
+
+    err = ring_init_test();
+    require_noerr( err, exit );
+    err = ring_region_test();
+    require_noerr( err, exit );
+    err = ring_stress_test();
+    require_noerr( err, exit );
+    err = ring_legacy_test();
+    require_noerr( err, exit );
+    if( !print ) goto exit;
+
+    // One thread writes then reads back a block, the ring never fills
+
+    memset( buf, 0x5A, sizeof( buf ) );
+    for( i = 0; i < sizeof( kLengths ) / sizeof( kLengths[ 0 ] ); ++i )
+    {
+        loops = ( 4 * 1024 * 1024 ) / kLengths[ i ];
+
+        ring_buffer_init( &ring, gRing_BenchMem, sizeof( gRing_BenchMem ) - 1 );
+        t = ring_bench_ticks();
+        for( n = 0; n < loops; ++n )
+        {
+            ring_buffer_write( &ring, buf, kLengths[ i ] );
+            ring_buffer_get_data( &ring, &ptr, &contiguous );
+            ring_buffer_consume( &ring, ring_buffer_used_space( &ring ) );
+        }
+        ring_bench_report( "ring_buffer_t write/consume", kLengths[ i ], ring_bench_ticks() - t, loops * kLengths[ i ] );
+
+        ring_buffer_spsc_init( &spsc, gRing_BenchMem, sizeof( gRing_BenchMem ) );
+        t = ring_bench_ticks();
+        for( n = 0; n < loops; ++n )
+        {
+            ring_buffer_spsc_write( &spsc, buf, kLengths[ i ] );
+            ring_buffer_spsc_read( &spsc, buf, kLengths[ i ] );
+        }
+        ring_bench_report( "ring_buffer_spsc write/read", kLengths[ i ], ring_bench_ticks() - t, loops * kLengths[ i ] );
+    }
+
+    // Two threads, the rate at which a byte gets through
+
+    err = ring_bench_stress( sizeof( gRing_BenchMem ), 512, 4 * kRing_BenchStressBytes, &seconds );
+    require_noerr( err, exit );
+    printf( "%-32s %5u bytes: %10.1f MB/s\n", "ring_buffer_spsc, two threads", (unsigned int) sizeof( gRing_BenchMem ),
+            4 * kRing_BenchStressBytes / seconds / 1e6 );
+
+exit:
+    printf( "%s: %s\n", __FUNCTION__, !err ? "PASSED" : "FAILED" );
+    return( err );
+}
+
+int main( void )
+{
+    return( ring_bench( 1 ) ? 1 : 0 );
+}
+
+#endif // RING_BENCH_MAIN